@@ -0,0 +1,96 @@
+#include <engine/search.hpp>
+
+#include <fmt/core.h>
+#include <fmt/color.h>
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+//
+// times the search to a fixed depth over a few positions, with 1, 2, 4, ... threads up to --threads
+//	the speedup is time to depth against a single thread, Lazy SMP threads don't split the tree
+//	so it comes from the shared transposition table and a higher total node rate
+//	chess_bench --depth n --threads n
+//
+namespace
+{
+	const std::vector<std::string_view> positions = {
+		Chess::Position::START_FEN,
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	};
+
+	struct Totals
+	{
+		uint64_t nodes = 0;
+		double seconds = 0.0;
+	};
+
+	Totals run_positions(int depth, int num_threads)
+	{
+		Totals totals;
+		for (const std::string_view fen : positions)
+		{
+			// a fresh table per position, so a run doesn't profit from the one before
+			Search search;
+			SearchLimits limits;
+			limits.time = std::chrono::milliseconds(0);
+			limits.max_depth = depth;
+			limits.num_threads = num_threads;
+			const SearchResult result = search.run(Chess::Position::from_fen(fen), limits);
+			totals.nodes += result.info.nodes;
+			totals.seconds += result.info.seconds;
+			fmt::print("  {:<72} {:>5} {:>6} {:>11} {:>8.3f}s\n", fen, result.best_move.to_uci(), result.info.score, result.info.nodes, result.info.seconds);
+		}
+
+		return totals;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	try {
+		int depth = 10;
+		int max_threads = int(std::max(1u, std::thread::hardware_concurrency()));
+		for (int i = 1; i + 1 < argc; i += 2)
+		{
+			const std::string_view flag = argv[i];
+			if (flag == "--depth")
+			{
+				depth = std::stoi(argv[i + 1]);
+			} else if (flag == "--threads")
+			{
+				max_threads = std::stoi(argv[i + 1]);
+			} else
+			{
+				throw std::runtime_error(fmt::format("unknown flag {}", flag));
+			}
+		}
+		if (depth < 1 || max_threads < 1)
+		{
+			throw std::runtime_error("depth and threads must be at least 1");
+		}
+
+		double single_thread_seconds = 0.0;
+		for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+		{
+			fmt::print("{} threads, depth {}\n", num_threads, depth);
+			const Totals totals = run_positions(depth, num_threads);
+			if (num_threads == 1)
+			{
+				single_thread_seconds = totals.seconds;
+			}
+			fmt::print(fg(fmt::color::green), "{} threads: {} nodes in {:.3f}s, {:.2f} Mnps, {:.2f}x time to depth\n",
+				num_threads, totals.nodes, totals.seconds, double(totals.nodes) / totals.seconds * 1e-6, single_thread_seconds / totals.seconds);
+		}
+
+		return EXIT_SUCCESS;
+	} catch (const std::exception& e) {
+		fmt::print(fg(fmt::color::red), "Exception Thrown!: {}\n", e.what());
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,116 @@
+#include <bitboard/perft.hpp>
+
+#include <fmt/core.h>
+#include <fmt/color.h>
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+//
+// checks the bitboard move generator against published perft counts and reports its speed
+//	chess_perft                       runs every reference position up to --max-depth (5 by default)
+//	chess_perft --fen "<fen>" --depth n  prints the count below each move of a position, for comparing with another engine
+//
+namespace
+{
+	struct Reference
+	{
+		std::string_view name;
+		std::string_view fen;
+		// nodes at depth 1, 2, ...
+		std::vector<uint64_t> counts;
+	};
+
+	// from the chessprogramming wiki perft results page, they cover castling, en passant, promotions, pins and checks
+	const std::vector<Reference> references = {
+		{ "start", Chess::Position::START_FEN, { 20, 400, 8902, 197281, 4865609, 119060324 } },
+		{ "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", { 48, 2039, 97862, 4085603, 193690690 } },
+		{ "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", { 14, 191, 2812, 43238, 674624, 11030083 } },
+		{ "position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", { 6, 264, 9467, 422333, 15833292 } },
+		{ "position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", { 6, 264, 9467, 422333, 15833292 } },
+		{ "position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", { 44, 1486, 62379, 2103487, 89941194 } },
+		{ "position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", { 46, 2079, 89890, 3894594, 164075551 } },
+	};
+
+	double get_seconds_since(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	int run_references(int max_depth)
+	{
+		int num_failed = 0;
+		uint64_t total_nodes = 0;
+		double total_seconds = 0.0;
+		for (const Reference& reference : references)
+		{
+			Chess::Position position = Chess::Position::from_fen(reference.fen);
+			const int depth = std::min(max_depth, int(reference.counts.size()));
+			const auto start = std::chrono::steady_clock::now();
+			const uint64_t nodes = Chess::perft(position, depth);
+			const double seconds = get_seconds_since(start);
+			total_nodes += nodes;
+			total_seconds += seconds;
+
+			const uint64_t expected = reference.counts[depth - 1];
+			const bool passed = nodes == expected && position.to_fen() == Chess::Position::from_fen(reference.fen).to_fen();
+			num_failed += !passed;
+			fmt::print(passed ? fg(fmt::color::green) : fg(fmt::color::red),
+				"{:<20} depth {} nodes {:>11} expected {:>11} {:>8.3f}s {:>7.2f} Mnps\n",
+				reference.name, depth, nodes, expected, seconds, double(nodes) / seconds * 1e-6);
+		}
+		fmt::print("total {} nodes in {:.3f}s, {:.2f} Mnps\n", total_nodes, total_seconds, double(total_nodes) / total_seconds * 1e-6);
+
+		return num_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	int run_divide(std::string_view fen, int depth)
+	{
+		Chess::Position position = Chess::Position::from_fen(fen);
+		const auto start = std::chrono::steady_clock::now();
+		uint64_t total = 0;
+		for (const auto& [move, nodes] : Chess::perft_divide(position, depth))
+		{
+			fmt::print("{}: {}\n", move.to_uci(), nodes);
+			total += nodes;
+		}
+		const double seconds = get_seconds_since(start);
+		fmt::print("nodes {} in {:.3f}s, {:.2f} Mnps\n", total, seconds, double(total) / seconds * 1e-6);
+
+		return EXIT_SUCCESS;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	try {
+		std::string fen;
+		int depth = 5;
+		for (int i = 1; i + 1 < argc; i += 2)
+		{
+			const std::string_view flag = argv[i];
+			if (flag == "--fen")
+			{
+				fen = argv[i + 1];
+			} else if (flag == "--depth" || flag == "--max-depth")
+			{
+				depth = std::stoi(argv[i + 1]);
+			} else
+			{
+				throw std::runtime_error(fmt::format("unknown flag {}", flag));
+			}
+		}
+		if (depth < 1)
+		{
+			throw std::runtime_error("depth must be at least 1");
+		}
+
+		return fen.empty() ? run_references(depth) : run_divide(fen, depth);
+	} catch (const std::exception& e) {
+		fmt::print(fg(fmt::color::red), "Exception Thrown!: {}\n", e.what());
+		return EXIT_FAILURE;
+	}
+}
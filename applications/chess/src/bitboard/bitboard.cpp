@@ -0,0 +1,196 @@
+#include "bitboard.hpp"
+
+#include <array>
+#include <stdexcept>
+
+
+namespace
+{
+	using namespace Chess;
+
+	constexpr std::array<std::pair<int, int>, 4> ROOK_DIRECTIONS = { { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } } };
+	constexpr std::array<std::pair<int, int>, 4> BISHOP_DIRECTIONS = { { { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } } };
+
+	bool is_on_board(int file, int rank)
+	{
+		return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+	}
+
+	Bitboard get_step_attacks(Square square, const std::pair<int, int>* steps, size_t num_steps)
+	{
+		Bitboard attacks = 0;
+		for (size_t i = 0; i < num_steps; i++)
+		{
+			const int file = file_of(square) + steps[i].first;
+			const int rank = rank_of(square) + steps[i].second;
+			if (is_on_board(file, rank))
+			{
+				attacks |= square_bb(make_square(file, rank));
+			}
+		}
+
+		return attacks;
+	}
+
+	// deterministic so the magics, and with them any attack table bug, are the same on every run
+	class XorShift
+	{
+	public:
+		uint64_t next()
+		{
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			return state * 2685821657736338717ull;
+		}
+		// few bits set, these make good magic candidates
+		uint64_t next_sparse() { return next() & next() & next(); }
+
+	private:
+		uint64_t state = 1070372;
+	};
+
+	// finds a magic for every square that maps each blocker subset of its mask to the right attacks without collisions
+	void init_magics(PieceType type, Magic* magics, std::vector<Bitboard>& table)
+	{
+		Bitboard masks[64];
+		size_t table_size = 0;
+		for (Square square = 0; square < 64; square++)
+		{
+			// blockers on the last square of a ray don't change the attacks
+			const Bitboard edges = ((RANK_1 | RANK_8) & ~(RANK_1 << (8 * rank_of(square)))) | ((FILE_A | FILE_H) & ~(FILE_A << file_of(square)));
+			masks[square] = get_sliding_attacks_slow(type, square, 0) & ~edges;
+			table_size += size_t(1) << popcount(masks[square]);
+		}
+		// sized up front, the magics point into it
+		table.assign(table_size, 0);
+
+		XorShift rng;
+		std::vector<Bitboard> occupancies;
+		std::vector<Bitboard> references;
+		std::vector<uint32_t> epochs;
+		uint32_t epoch = 0;
+		size_t offset = 0;
+		for (Square square = 0; square < 64; square++)
+		{
+			Magic& magic = magics[square];
+			magic.mask = masks[square];
+			magic.shift = 64 - popcount(magic.mask);
+			magic.attacks = table.data() + offset;
+			const size_t size = size_t(1) << popcount(magic.mask);
+
+			// every subset of the mask, by the carry rippler trick
+			occupancies.clear();
+			references.clear();
+			Bitboard subset = 0;
+			do
+			{
+				occupancies.push_back(subset);
+				references.push_back(get_sliding_attacks_slow(type, square, subset));
+				subset = (subset - magic.mask) & magic.mask;
+			} while (subset != 0);
+
+			epochs.assign(size, 0);
+			epoch = 0;
+			Bitboard* attacks = table.data() + offset;
+			for (bool found = false; !found;)
+			{
+				do
+				{
+					magic.magic = rng.next_sparse();
+				} while (popcount((magic.mask * magic.magic) >> 56) < 6);
+
+				// two subsets may share an entry only if their attacks are the same
+				epoch++;
+				found = true;
+				for (size_t i = 0; i < occupancies.size() && found; i++)
+				{
+					const size_t index = magic.get_index(occupancies[i]);
+					if (epochs[index] != epoch)
+					{
+						epochs[index] = epoch;
+						attacks[index] = references[i];
+					} else if (attacks[index] != references[i])
+					{
+						found = false;
+					}
+				}
+			}
+			offset += size;
+		}
+	}
+}
+
+namespace Chess
+{
+	const AttackTables attack_tables;
+
+	Bitboard get_sliding_attacks_slow(PieceType type, Square square, Bitboard occupied)
+	{
+		if (type != ROOK && type != BISHOP && type != QUEEN)
+		{
+			throw std::runtime_error("Chess::get_sliding_attacks_slow: not a sliding piece");
+		}
+
+		Bitboard attacks = 0;
+		auto walk = [&](const std::array<std::pair<int, int>, 4>& directions)
+		{
+			for (const auto& [file_step, rank_step] : directions)
+			{
+				int file = file_of(square) + file_step;
+				int rank = rank_of(square) + rank_step;
+				for (; is_on_board(file, rank); file += file_step, rank += rank_step)
+				{
+					attacks |= square_bb(make_square(file, rank));
+					if (occupied & square_bb(make_square(file, rank)))
+					{
+						break;
+					}
+				}
+			}
+		};
+		if (type != BISHOP) walk(ROOK_DIRECTIONS);
+		if (type != ROOK) walk(BISHOP_DIRECTIONS);
+
+		return attacks;
+	}
+
+	AttackTables::AttackTables()
+	{
+		static constexpr std::pair<int, int> knight_steps[] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+		static constexpr std::pair<int, int> king_steps[] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+		static constexpr std::pair<int, int> white_pawn_steps[] = { { -1, 1 }, { 1, 1 } };
+		static constexpr std::pair<int, int> black_pawn_steps[] = { { -1, -1 }, { 1, -1 } };
+		for (Square square = 0; square < 64; square++)
+		{
+			knight[square] = get_step_attacks(square, knight_steps, std::size(knight_steps));
+			king[square] = get_step_attacks(square, king_steps, std::size(king_steps));
+			pawn[WHITE][square] = get_step_attacks(square, white_pawn_steps, std::size(white_pawn_steps));
+			pawn[BLACK][square] = get_step_attacks(square, black_pawn_steps, std::size(black_pawn_steps));
+		}
+
+		init_magics(ROOK, rook, rook_table);
+		init_magics(BISHOP, bishop, bishop_table);
+
+		for (Square from = 0; from < 64; from++)
+		{
+			for (Square to = 0; to < 64; to++)
+			{
+				between[from][to] = 0;
+				line[from][to] = 0;
+				if (from == to)
+				{
+					continue;
+				}
+				for (const PieceType type : { ROOK, BISHOP })
+				{
+					if (get_sliding_attacks_slow(type, from, 0) & square_bb(to))
+					{
+						between[from][to] = get_sliding_attacks_slow(type, from, square_bb(to)) & get_sliding_attacks_slow(type, to, square_bb(from));
+						line[from][to] = (get_sliding_attacks_slow(type, from, 0) & get_sliding_attacks_slow(type, to, 0)) | square_bb(from) | square_bb(to);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <vector>
+
+
+//
+// 64 bit sets of squares and the precomputed attack tables the move generator is built on
+//	square 0 is a1, 7 is h1 and 63 is h8, so bit n is set when square n is in the set
+//	sliding attacks use magic bitboards, the blockers on a piece's rays are hashed into a table of
+//	precomputed attack sets with a multiply and a shift instead of walking the rays square by square
+//
+namespace Chess
+{
+	using Bitboard = uint64_t;
+	using Square = int;
+
+	enum Color
+	{
+		WHITE,
+		BLACK,
+	};
+
+	enum PieceType
+	{
+		PAWN,
+		KNIGHT,
+		BISHOP,
+		ROOK,
+		QUEEN,
+		KING,
+		NO_PIECE_TYPE,
+	};
+
+	constexpr Square NO_SQUARE = 64;
+
+	constexpr Bitboard FILE_A = 0x0101010101010101ull;
+	constexpr Bitboard FILE_H = FILE_A << 7;
+	constexpr Bitboard RANK_1 = 0xffull;
+	constexpr Bitboard RANK_2 = RANK_1 << 8;
+	constexpr Bitboard RANK_4 = RANK_1 << 24;
+	constexpr Bitboard RANK_5 = RANK_1 << 32;
+	constexpr Bitboard RANK_7 = RANK_1 << 48;
+	constexpr Bitboard RANK_8 = RANK_1 << 56;
+	constexpr Bitboard ALL_SQUARES = ~Bitboard(0);
+
+	constexpr Color operator~(Color color) { return Color(color ^ 1); }
+	constexpr int file_of(Square square) { return square & 7; }
+	constexpr int rank_of(Square square) { return square >> 3; }
+	constexpr Square make_square(int file, int rank) { return rank * 8 + file; }
+	constexpr Bitboard square_bb(Square square) { return Bitboard(1) << square; }
+
+	inline Square get_lsb(Bitboard bitboard) { return std::countr_zero(bitboard); }
+	inline Square pop_lsb(Bitboard& bitboard)
+	{
+		const Square square = get_lsb(bitboard);
+		bitboard &= bitboard - 1;
+		return square;
+	}
+	inline int popcount(Bitboard bitboard) { return std::popcount(bitboard); }
+	inline bool has_several(Bitboard bitboard) { return (bitboard & (bitboard - 1)) != 0; }
+
+	// every square shifted one step, squares that would wrap around to the other side of the board are dropped
+	constexpr Bitboard shift_north(Bitboard bitboard) { return bitboard << 8; }
+	constexpr Bitboard shift_south(Bitboard bitboard) { return bitboard >> 8; }
+	constexpr Bitboard shift_forward(Color color, Bitboard bitboard) { return color == WHITE ? shift_north(bitboard) : shift_south(bitboard); }
+
+	struct Magic
+	{
+		// the squares on the piece's rays whose occupancy changes its attacks, board edges excluded
+		Bitboard mask;
+		Bitboard magic;
+		const Bitboard* attacks;
+		int shift;
+
+		size_t get_index(Bitboard occupied) const { return size_t(((occupied & mask) * magic) >> shift); }
+	};
+
+	struct AttackTables
+	{
+		AttackTables();
+
+		Bitboard pawn[2][64];
+		Bitboard knight[64];
+		Bitboard king[64];
+		// squares strictly between two squares on a shared line, empty when they don't share one
+		Bitboard between[64][64];
+		// the whole line through two squares, empty when they don't share one
+		Bitboard line[64][64];
+		Magic rook[64];
+		Magic bishop[64];
+
+	private:
+		std::vector<Bitboard> rook_table;
+		std::vector<Bitboard> bishop_table;
+	};
+
+	// built before main, nothing should generate moves during static initialisation
+	extern const AttackTables attack_tables;
+
+	inline Bitboard get_pawn_attacks(Color color, Square square) { return attack_tables.pawn[color][square]; }
+	inline Bitboard get_knight_attacks(Square square) { return attack_tables.knight[square]; }
+	inline Bitboard get_king_attacks(Square square) { return attack_tables.king[square]; }
+	inline Bitboard get_rook_attacks(Square square, Bitboard occupied)
+	{
+		const Magic& magic = attack_tables.rook[square];
+		return magic.attacks[magic.get_index(occupied)];
+	}
+	inline Bitboard get_bishop_attacks(Square square, Bitboard occupied)
+	{
+		const Magic& magic = attack_tables.bishop[square];
+		return magic.attacks[magic.get_index(occupied)];
+	}
+	inline Bitboard get_queen_attacks(Square square, Bitboard occupied) { return get_rook_attacks(square, occupied) | get_bishop_attacks(square, occupied); }
+	inline Bitboard get_between(Square from, Square to) { return attack_tables.between[from][to]; }
+	inline Bitboard get_line(Square from, Square to) { return attack_tables.line[from][to]; }
+
+	// attacks found by walking the rays, slow but obviously right, the magic tables are built from it
+	Bitboard get_sliding_attacks_slow(PieceType type, Square square, Bitboard occupied);
+}
@@ -0,0 +1,44 @@
+#include "perft.hpp"
+
+
+namespace Chess
+{
+	uint64_t perft(Position& position, int depth)
+	{
+		if (depth <= 0)
+		{
+			return 1;
+		}
+
+		MoveList moves;
+		position.generate_legal_moves(moves);
+		// the moves are all legal, the last ply doesn't have to be played
+		if (depth == 1)
+		{
+			return moves.size();
+		}
+
+		uint64_t nodes = 0;
+		for (const Move move : moves)
+		{
+			position.make_move(move);
+			nodes += perft(position, depth - 1);
+			position.unmake_move();
+		}
+		return nodes;
+	}
+
+	std::vector<std::pair<Move, uint64_t>> perft_divide(Position& position, int depth)
+	{
+		MoveList moves;
+		position.generate_legal_moves(moves);
+		std::vector<std::pair<Move, uint64_t>> counts;
+		for (const Move move : moves)
+		{
+			position.make_move(move);
+			counts.emplace_back(move, perft(position, depth - 1));
+			position.unmake_move();
+		}
+		return counts;
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "position.hpp"
+
+#include <vector>
+#include <utility>
+
+
+//
+// perft counts the leaf nodes of the legal move tree to a fixed depth,
+//	comparing the counts with published ones is the standard way to validate a move generator
+//
+namespace Chess
+{
+	uint64_t perft(Position& position, int depth);
+	// the count below each root move, for narrowing a wrong total down to the move generating it
+	std::vector<std::pair<Move, uint64_t>> perft_divide(Position& position, int depth);
+}
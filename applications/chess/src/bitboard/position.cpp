@@ -0,0 +1,621 @@
+#include "position.hpp"
+
+#include <stdexcept>
+
+
+namespace
+{
+	using namespace Chess;
+
+	constexpr std::string_view PIECE_CHARACTERS = "PNBRQKpnbrqk";
+
+	// random keys xor-ed together into a position's key, one per piece on a square, castling rights, en passant file and side
+	struct ZobristKeys
+	{
+		ZobristKeys()
+		{
+			// splitmix64 with a fixed seed so keys, and hash collisions, are reproducible
+			uint64_t state = 0x9e3779b97f4a7c15ull;
+			auto next = [&]()
+			{
+				uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+				return z ^ (z >> 31);
+			};
+			for (auto& piece_keys : pieces)
+			{
+				for (uint64_t& square_key : piece_keys)
+				{
+					square_key = next();
+				}
+			}
+			for (uint64_t& castling_key : castling)
+			{
+				castling_key = next();
+			}
+			for (uint64_t& file_key : en_passant)
+			{
+				file_key = next();
+			}
+			side = next();
+		}
+
+		uint64_t pieces[12][64];
+		uint64_t castling[16];
+		uint64_t en_passant[8];
+		uint64_t side;
+	};
+
+	const ZobristKeys zobrist;
+
+	// castling rights that survive a move from or to each square, moving a king or rook or capturing a rook loses them
+	constexpr std::array<uint8_t, 64> get_castling_masks()
+	{
+		std::array<uint8_t, 64> masks{};
+		for (uint8_t& mask : masks)
+		{
+			mask = 15;
+		}
+		masks[make_square(4, 0)] &= ~(Position::WHITE_KING_SIDE | Position::WHITE_QUEEN_SIDE);
+		masks[make_square(7, 0)] &= ~Position::WHITE_KING_SIDE;
+		masks[make_square(0, 0)] &= ~Position::WHITE_QUEEN_SIDE;
+		masks[make_square(4, 7)] &= ~(Position::BLACK_KING_SIDE | Position::BLACK_QUEEN_SIDE);
+		masks[make_square(7, 7)] &= ~Position::BLACK_KING_SIDE;
+		masks[make_square(0, 7)] &= ~Position::BLACK_QUEEN_SIDE;
+		return masks;
+	}
+	constexpr std::array<uint8_t, 64> CASTLING_MASKS = get_castling_masks();
+
+	Square parse_square(std::string_view text)
+	{
+		if (text.size() != 2 || text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8')
+		{
+			return NO_SQUARE;
+		}
+		return make_square(text[0] - 'a', text[1] - '1');
+	}
+
+	std::string square_to_string(Square square)
+	{
+		return { char('a' + file_of(square)), char('1' + rank_of(square)) };
+	}
+}
+
+namespace Chess
+{
+	std::string Move::to_uci() const
+	{
+		if (is_null())
+		{
+			return "0000";
+		}
+		std::string uci = square_to_string(get_from()) + square_to_string(get_to());
+		if (is_promotion())
+		{
+			uci += "nbrq"[get_promotion_type() - KNIGHT];
+		}
+		return uci;
+	}
+
+	Position::Position()
+	{
+		board.fill(EMPTY);
+	}
+
+	Position Position::from_fen(std::string_view fen)
+	{
+		Position position;
+		std::vector<std::string_view> fields;
+		for (size_t start = 0; start < fen.size();)
+		{
+			const size_t end = std::min(fen.find(' ', start), fen.size());
+			if (end > start)
+			{
+				fields.push_back(fen.substr(start, end - start));
+			}
+			start = end + 1;
+		}
+		if (fields.size() < 4)
+		{
+			throw std::runtime_error("Position::from_fen: expected at least 4 fields");
+		}
+
+		int file = 0;
+		int rank = 7;
+		for (const char c : fields[0])
+		{
+			if (c == '/')
+			{
+				file = 0;
+				rank--;
+			} else if (c >= '1' && c <= '8')
+			{
+				file += c - '0';
+			} else
+			{
+				const size_t piece = PIECE_CHARACTERS.find(c);
+				if (piece == std::string_view::npos || file > 7 || rank < 0)
+				{
+					throw std::runtime_error("Position::from_fen: bad piece placement");
+				}
+				position.put_piece(make_square(file, rank), uint8_t(piece));
+				file++;
+			}
+		}
+		if (popcount(position.pieces[WHITE][KING]) != 1 || popcount(position.pieces[BLACK][KING]) != 1)
+		{
+			throw std::runtime_error("Position::from_fen: each side needs exactly one king");
+		}
+
+		if (fields[1] != "w" && fields[1] != "b")
+		{
+			throw std::runtime_error("Position::from_fen: side to move must be w or b");
+		}
+		position.side = fields[1] == "w" ? WHITE : BLACK;
+		if (position.side == BLACK)
+		{
+			position.key ^= zobrist.side;
+		}
+
+		for (const char c : fields[2])
+		{
+			switch (c)
+			{
+			case 'K': position.castling_rights |= WHITE_KING_SIDE; break;
+			case 'Q': position.castling_rights |= WHITE_QUEEN_SIDE; break;
+			case 'k': position.castling_rights |= BLACK_KING_SIDE; break;
+			case 'q': position.castling_rights |= BLACK_QUEEN_SIDE; break;
+			case '-': break;
+			default: throw std::runtime_error("Position::from_fen: bad castling rights");
+			}
+		}
+		position.key ^= zobrist.castling[position.castling_rights];
+
+		if (fields[3] != "-")
+		{
+			position.en_passant = parse_square(fields[3]);
+			if (position.en_passant == NO_SQUARE)
+			{
+				throw std::runtime_error("Position::from_fen: bad en passant square");
+			}
+			position.key ^= zobrist.en_passant[file_of(position.en_passant)];
+		}
+		position.halfmove_clock = fields.size() > 4 ? std::stoi(std::string(fields[4])) : 0;
+		position.fullmove_number = fields.size() > 5 ? std::stoi(std::string(fields[5])) : 1;
+		position.update_checkers();
+
+		return position;
+	}
+
+	std::string Position::to_fen() const
+	{
+		std::string fen;
+		for (int rank = 7; rank >= 0; rank--)
+		{
+			int empty = 0;
+			for (int file = 0; file < 8; file++)
+			{
+				const uint8_t piece = board[make_square(file, rank)];
+				if (piece == EMPTY)
+				{
+					empty++;
+					continue;
+				}
+				if (empty > 0)
+				{
+					fen += char('0' + empty);
+					empty = 0;
+				}
+				fen += PIECE_CHARACTERS[piece];
+			}
+			if (empty > 0)
+			{
+				fen += char('0' + empty);
+			}
+			if (rank > 0)
+			{
+				fen += '/';
+			}
+		}
+
+		fen += side == WHITE ? " w " : " b ";
+		if (castling_rights == 0)
+		{
+			fen += '-';
+		}
+		if (castling_rights & WHITE_KING_SIDE) fen += 'K';
+		if (castling_rights & WHITE_QUEEN_SIDE) fen += 'Q';
+		if (castling_rights & BLACK_KING_SIDE) fen += 'k';
+		if (castling_rights & BLACK_QUEEN_SIDE) fen += 'q';
+		fen += ' ';
+		fen += en_passant == NO_SQUARE ? "-" : square_to_string(en_passant);
+		fen += ' ' + std::to_string(halfmove_clock) + ' ' + std::to_string(fullmove_number);
+
+		return fen;
+	}
+
+	void Position::put_piece(Square square, uint8_t piece)
+	{
+		const Color color = Color(piece / 6);
+		pieces[color][piece % 6] |= square_bb(square);
+		colors[color] |= square_bb(square);
+		occupied |= square_bb(square);
+		board[square] = piece;
+		key ^= zobrist.pieces[piece][square];
+	}
+
+	void Position::remove_piece(Square square)
+	{
+		const uint8_t piece = board[square];
+		const Color color = Color(piece / 6);
+		pieces[color][piece % 6] ^= square_bb(square);
+		colors[color] ^= square_bb(square);
+		occupied ^= square_bb(square);
+		board[square] = EMPTY;
+		key ^= zobrist.pieces[piece][square];
+	}
+
+	void Position::move_piece(Square from, Square to)
+	{
+		const uint8_t piece = board[from];
+		const Color color = Color(piece / 6);
+		const Bitboard from_to = square_bb(from) | square_bb(to);
+		pieces[color][piece % 6] ^= from_to;
+		colors[color] ^= from_to;
+		occupied ^= from_to;
+		board[from] = EMPTY;
+		board[to] = piece;
+		key ^= zobrist.pieces[piece][from] ^ zobrist.pieces[piece][to];
+	}
+
+	void Position::update_checkers()
+	{
+		checkers = get_attackers(get_lsb(pieces[side][KING]), occupied) & colors[~side];
+	}
+
+	Bitboard Position::get_attackers(Square square, Bitboard occupancy) const
+	{
+		const Bitboard rooks = pieces[WHITE][ROOK] | pieces[BLACK][ROOK] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN];
+		const Bitboard bishops = pieces[WHITE][BISHOP] | pieces[BLACK][BISHOP] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN];
+		return (get_pawn_attacks(BLACK, square) & pieces[WHITE][PAWN]) |
+			(get_pawn_attacks(WHITE, square) & pieces[BLACK][PAWN]) |
+			(get_knight_attacks(square) & (pieces[WHITE][KNIGHT] | pieces[BLACK][KNIGHT])) |
+			(get_king_attacks(square) & (pieces[WHITE][KING] | pieces[BLACK][KING])) |
+			(get_rook_attacks(square, occupancy) & rooks) |
+			(get_bishop_attacks(square, occupancy) & bishops);
+	}
+
+	void Position::make_move(Move move)
+	{
+		const Square from = move.get_from();
+		const Square to = move.get_to();
+		const uint16_t flags = move.get_flags();
+		const uint8_t piece = board[from];
+		history.push_back(Undo{ move, EMPTY, castling_rights, en_passant, halfmove_clock, key, checkers });
+		Undo& undo = history.back();
+
+		halfmove_clock++;
+		if (en_passant != NO_SQUARE)
+		{
+			key ^= zobrist.en_passant[file_of(en_passant)];
+			en_passant = NO_SQUARE;
+		}
+
+		if (move.is_capture())
+		{
+			// the pawn taken en passant is behind the square moved to
+			const Square captured_square = flags == Move::EN_PASSANT ? to ^ 8 : to;
+			undo.captured = board[captured_square];
+			remove_piece(captured_square);
+			halfmove_clock = 0;
+		}
+		move_piece(from, to);
+
+		if (piece % 6 == PAWN)
+		{
+			halfmove_clock = 0;
+			if (flags == Move::DOUBLE_PUSH)
+			{
+				en_passant = (from + to) / 2;
+				key ^= zobrist.en_passant[file_of(en_passant)];
+			} else if (move.is_promotion())
+			{
+				remove_piece(to);
+				put_piece(to, make_piece(side, move.get_promotion_type()));
+			}
+		} else if (flags == Move::KING_CASTLE)
+		{
+			move_piece(to + 1, to - 1);
+		} else if (flags == Move::QUEEN_CASTLE)
+		{
+			move_piece(to - 2, to + 1);
+		}
+
+		key ^= zobrist.castling[castling_rights];
+		castling_rights &= CASTLING_MASKS[from] & CASTLING_MASKS[to];
+		key ^= zobrist.castling[castling_rights];
+
+		if (side == BLACK)
+		{
+			fullmove_number++;
+		}
+		side = ~side;
+		key ^= zobrist.side;
+		update_checkers();
+	}
+
+	void Position::unmake_move()
+	{
+		const Undo undo = history.back();
+		history.pop_back();
+		const Move move = undo.move;
+		const Square from = move.get_from();
+		const Square to = move.get_to();
+		const uint16_t flags = move.get_flags();
+
+		side = ~side;
+		if (side == BLACK)
+		{
+			fullmove_number--;
+		}
+
+		if (move.is_promotion())
+		{
+			remove_piece(to);
+			put_piece(to, make_piece(side, PAWN));
+		} else if (flags == Move::KING_CASTLE)
+		{
+			move_piece(to - 1, to + 1);
+		} else if (flags == Move::QUEEN_CASTLE)
+		{
+			move_piece(to + 1, to - 2);
+		}
+		move_piece(to, from);
+		if (move.is_capture())
+		{
+			put_piece(flags == Move::EN_PASSANT ? to ^ 8 : to, undo.captured);
+		}
+
+		castling_rights = undo.castling_rights;
+		en_passant = undo.en_passant;
+		halfmove_clock = undo.halfmove_clock;
+		key = undo.key;
+		checkers = undo.checkers;
+	}
+
+	void Position::make_null_move()
+	{
+		history.push_back(Undo{ Move(), EMPTY, castling_rights, en_passant, halfmove_clock, key, checkers });
+		if (en_passant != NO_SQUARE)
+		{
+			key ^= zobrist.en_passant[file_of(en_passant)];
+			en_passant = NO_SQUARE;
+		}
+		halfmove_clock++;
+		side = ~side;
+		key ^= zobrist.side;
+		update_checkers();
+	}
+
+	void Position::unmake_null_move()
+	{
+		const Undo undo = history.back();
+		history.pop_back();
+		side = ~side;
+		en_passant = undo.en_passant;
+		halfmove_clock = undo.halfmove_clock;
+		key = undo.key;
+		checkers = undo.checkers;
+	}
+
+	bool Position::is_repetition() const
+	{
+		// only positions with the same side to move since the last capture or pawn move can repeat
+		const size_t reach = std::min(size_t(halfmove_clock), history.size());
+		for (size_t plies = 2; plies <= reach; plies += 2)
+		{
+			if (history[history.size() - plies].key == key)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Bitboard Position::get_pinned(Square king) const
+	{
+		// enemy sliders lined up with the king with exactly one piece between them, if it's ours it's pinned
+		const Color them = ~side;
+		const Bitboard snipers =
+			(get_rook_attacks(king, 0) & (pieces[them][ROOK] | pieces[them][QUEEN])) |
+			(get_bishop_attacks(king, 0) & (pieces[them][BISHOP] | pieces[them][QUEEN]));
+		Bitboard pinned = 0;
+		for (Bitboard remaining = snipers; remaining;)
+		{
+			const Bitboard blockers = get_between(king, pop_lsb(remaining)) & occupied;
+			if (blockers && !has_several(blockers))
+			{
+				pinned |= blockers & colors[side];
+			}
+		}
+		return pinned;
+	}
+
+	void Position::add_pawn_moves(MoveList& moves, Bitboard target_mask, Bitboard pinned, Square king) const
+	{
+		const Color us = side;
+		const Color them = ~side;
+		const Bitboard pawns = pieces[us][PAWN];
+		const Bitboard empty = ~occupied;
+		const Bitboard promotion_rank = us == WHITE ? RANK_8 : RANK_1;
+		const int forward = us == WHITE ? 8 : -8;
+
+		// a pinned pawn may only move along the line through it and the king
+		auto is_allowed = [&](Square from, Square to)
+		{
+			return !(pinned & square_bb(from)) || (get_line(king, from) & square_bb(to));
+		};
+		auto add = [&](Square from, Square to, uint16_t flags)
+		{
+			if (!is_allowed(from, to))
+			{
+				return;
+			}
+			if (square_bb(to) & promotion_rank)
+			{
+				const uint16_t promotion = flags == Move::CAPTURE ? Move::PROMOTION_CAPTURE : Move::PROMOTION;
+				for (uint16_t type = 0; type < 4; type++)
+				{
+					moves.push_back(Move(from, to, promotion | type));
+				}
+			} else
+			{
+				moves.push_back(Move(from, to, flags));
+			}
+		};
+
+		const Bitboard single = shift_forward(us, pawns) & empty;
+		const Bitboard double_rank = us == WHITE ? RANK_4 : RANK_5;
+		for (Bitboard pushes = single & target_mask; pushes;)
+		{
+			const Square to = pop_lsb(pushes);
+			add(to - forward, to, Move::QUIET);
+		}
+		for (Bitboard pushes = shift_forward(us, single) & empty & double_rank & target_mask; pushes;)
+		{
+			const Square to = pop_lsb(pushes);
+			add(to - 2 * forward, to, Move::DOUBLE_PUSH);
+		}
+
+		// captures towards the a and h files, the shifts drop pawns that would wrap around the board
+		const Bitboard enemies = colors[them] & target_mask;
+		const Bitboard left = shift_forward(us, pawns & ~FILE_A) >> 1;
+		const Bitboard right = shift_forward(us, pawns & ~FILE_H) << 1;
+		for (Bitboard captures = left & enemies; captures;)
+		{
+			const Square to = pop_lsb(captures);
+			add(to - forward + 1, to, Move::CAPTURE);
+		}
+		for (Bitboard captures = right & enemies; captures;)
+		{
+			const Square to = pop_lsb(captures);
+			add(to - forward - 1, to, Move::CAPTURE);
+		}
+
+		if (en_passant != NO_SQUARE)
+		{
+			// rare enough to check the position after the capture directly, it removes two pieces from one rank
+			// which the pin test can't see, and it can resolve a check by a pawn without landing on its square
+			const Square captured = en_passant - forward;
+			const Bitboard enemy_rooks = pieces[them][ROOK] | pieces[them][QUEEN];
+			const Bitboard enemy_bishops = pieces[them][BISHOP] | pieces[them][QUEEN];
+			for (Bitboard attackers = get_pawn_attacks(them, en_passant) & pawns; attackers;)
+			{
+				const Square from = pop_lsb(attackers);
+				const Bitboard after = (occupied ^ square_bb(from) ^ square_bb(captured)) | square_bb(en_passant);
+				const Bitboard checks =
+					(get_rook_attacks(king, after) & enemy_rooks) |
+					(get_bishop_attacks(king, after) & enemy_bishops) |
+					(get_knight_attacks(king) & pieces[them][KNIGHT]) |
+					(get_pawn_attacks(us, king) & pieces[them][PAWN] & ~square_bb(captured));
+				if (!checks)
+				{
+					moves.push_back(Move(from, en_passant, Move::EN_PASSANT));
+				}
+			}
+		}
+	}
+
+	void Position::generate_legal_moves(MoveList& moves) const
+	{
+		moves.clear();
+		const Color us = side;
+		const Color them = ~side;
+		const Square king = get_lsb(pieces[us][KING]);
+		const Bitboard own = colors[us];
+
+		// the king may not step along the ray of a slider checking it, so it's taken off the board for the test
+		const Bitboard without_king = occupied ^ square_bb(king);
+		for (Bitboard targets = get_king_attacks(king) & ~own; targets;)
+		{
+			const Square to = pop_lsb(targets);
+			if (!(get_attackers(to, without_king) & colors[them]))
+			{
+				moves.push_back(Move(king, to, (colors[them] & square_bb(to)) ? Move::CAPTURE : Move::QUIET));
+			}
+		}
+		if (has_several(checkers))
+		{
+			// only the king can answer a double check
+			return;
+		}
+
+		// in check, other pieces must capture the checker or block its ray
+		const Bitboard target_mask = checkers ? get_between(king, get_lsb(checkers)) | checkers : ALL_SQUARES;
+		const Bitboard pinned = get_pinned(king);
+		add_pawn_moves(moves, target_mask, pinned, king);
+
+		for (const PieceType type : { KNIGHT, BISHOP, ROOK, QUEEN })
+		{
+			// a pinned knight can never move
+			Bitboard movers = pieces[us][type];
+			if (type == KNIGHT)
+			{
+				movers &= ~pinned;
+			}
+			while (movers)
+			{
+				const Square from = pop_lsb(movers);
+				Bitboard targets = ~own & target_mask;
+				switch (type)
+				{
+				case KNIGHT: targets &= get_knight_attacks(from); break;
+				case BISHOP: targets &= get_bishop_attacks(from, occupied); break;
+				case ROOK: targets &= get_rook_attacks(from, occupied); break;
+				default: targets &= get_queen_attacks(from, occupied); break;
+				}
+				if (pinned & square_bb(from))
+				{
+					targets &= get_line(king, from);
+				}
+				while (targets)
+				{
+					const Square to = pop_lsb(targets);
+					moves.push_back(Move(from, to, (colors[them] & square_bb(to)) ? Move::CAPTURE : Move::QUIET));
+				}
+			}
+		}
+
+		if (checkers)
+		{
+			return;
+		}
+		// the squares between king and rook must be empty, and those the king crosses unattacked
+		const uint8_t king_side = us == WHITE ? WHITE_KING_SIDE : BLACK_KING_SIDE;
+		const uint8_t queen_side = us == WHITE ? WHITE_QUEEN_SIDE : BLACK_QUEEN_SIDE;
+		auto is_safe = [&](Square square) { return !is_square_attacked(square, them); };
+		if ((castling_rights & king_side) && !(occupied & (square_bb(king + 1) | square_bb(king + 2))) && is_safe(king + 1) && is_safe(king + 2))
+		{
+			moves.push_back(Move(king, king + 2, Move::KING_CASTLE));
+		}
+		if ((castling_rights & queen_side) && !(occupied & (square_bb(king - 1) | square_bb(king - 2) | square_bb(king - 3))) && is_safe(king - 1) && is_safe(king - 2))
+		{
+			moves.push_back(Move(king, king - 2, Move::QUEEN_CASTLE));
+		}
+	}
+
+	Move Position::parse_uci(std::string_view uci) const
+	{
+		MoveList moves;
+		generate_legal_moves(moves);
+		for (const Move move : moves)
+		{
+			if (move.to_uci() == uci)
+			{
+				return move;
+			}
+		}
+		return Move();
+	}
+}
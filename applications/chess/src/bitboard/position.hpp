@@ -0,0 +1,171 @@
+#pragma once
+
+#include "bitboard.hpp"
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace Chess
+{
+	// from, to and a 4 bit flag packed in 16 bits
+	class Move
+	{
+	public:
+		enum Flag : uint16_t
+		{
+			QUIET = 0,
+			DOUBLE_PUSH = 1,
+			KING_CASTLE = 2,
+			QUEEN_CASTLE = 3,
+			CAPTURE = 4,
+			EN_PASSANT = 5,
+			// the low 2 bits pick knight, bishop, rook or queen
+			PROMOTION = 8,
+			PROMOTION_CAPTURE = 12,
+		};
+
+		constexpr Move() = default;
+		constexpr Move(Square from, Square to, uint16_t flags = QUIET) :
+			data(uint16_t(from | (to << 6) | (flags << 12)))
+		{}
+
+		static constexpr Move from_data(uint16_t data)
+		{
+			Move move;
+			move.data = data;
+			return move;
+		}
+
+		constexpr Square get_from() const { return data & 63; }
+		constexpr Square get_to() const { return (data >> 6) & 63; }
+		constexpr uint16_t get_flags() const { return data >> 12; }
+		constexpr bool is_capture() const { return (get_flags() & CAPTURE) != 0; }
+		constexpr bool is_promotion() const { return (get_flags() & PROMOTION) != 0; }
+		constexpr bool is_castle() const { return get_flags() == KING_CASTLE || get_flags() == QUEEN_CASTLE; }
+		constexpr PieceType get_promotion_type() const { return PieceType(KNIGHT + (get_flags() & 3)); }
+		constexpr bool is_null() const { return data == 0; }
+		constexpr uint16_t get_data() const { return data; }
+
+		constexpr bool operator==(const Move& other) const { return data == other.data; }
+
+		// long algebraic as UCI uses it, e.g. e2e4 or e7e8q
+		std::string to_uci() const;
+
+	private:
+		uint16_t data = 0;
+	};
+
+	// no legal position has more than 218 moves
+	class MoveList
+	{
+	public:
+		void push_back(Move move) { moves[count++] = move; }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+		void clear() { count = 0; }
+		Move& operator[](size_t i) { return moves[i]; }
+		const Move& operator[](size_t i) const { return moves[i]; }
+		Move* begin() { return moves.data(); }
+		Move* end() { return moves.data() + count; }
+		const Move* begin() const { return moves.data(); }
+		const Move* end() const { return moves.data() + count; }
+
+	private:
+		std::array<Move, 256> moves;
+		size_t count = 0;
+	};
+
+	//
+	// a chess position as one bitboard per side and piece type plus a square to piece table,
+	//	moves are made and unmade in place, the state they destroy is kept on a stack inside the position
+	//	the zobrist key is updated incrementally so searches can hash positions for free
+	//
+	class Position
+	{
+	public:
+		static constexpr std::string_view START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+		enum CastlingRight : uint8_t
+		{
+			WHITE_KING_SIDE = 1,
+			WHITE_QUEEN_SIDE = 2,
+			BLACK_KING_SIDE = 4,
+			BLACK_QUEEN_SIDE = 8,
+		};
+
+		Position();
+		static Position from_fen(std::string_view fen);
+		std::string to_fen() const;
+
+		// the move must be legal in this position
+		void make_move(Move move);
+		void unmake_move();
+		// passes the turn, searches use it to test whether the side to move is doing well even without a move
+		void make_null_move();
+		void unmake_null_move();
+
+		void generate_legal_moves(MoveList& moves) const;
+		// a legal move matching the UCI string, a null move when there is none
+		Move parse_uci(std::string_view uci) const;
+
+		bool is_in_check() const { return checkers != 0; }
+		bool is_square_attacked(Square square, Color by) const { return (get_attackers(square, occupied) & colors[by]) != 0; }
+		// pieces of either side attacking the square with the given occupancy
+		Bitboard get_attackers(Square square, Bitboard occupancy) const;
+
+		Color get_side() const { return side; }
+		uint64_t get_key() const { return key; }
+		Bitboard get_pieces(Color color, PieceType type) const { return pieces[color][type]; }
+		Bitboard get_pieces(Color color) const { return colors[color]; }
+		Bitboard get_occupied() const { return occupied; }
+		PieceType get_piece_type(Square square) const { return board[square] == EMPTY ? NO_PIECE_TYPE : PieceType(board[square] % 6); }
+		Color get_piece_color(Square square) const { return Color(board[square] / 6); }
+		uint8_t get_castling_rights() const { return castling_rights; }
+		Square get_en_passant() const { return en_passant; }
+		int get_halfmove_clock() const { return halfmove_clock; }
+		int get_fullmove_number() const { return fullmove_number; }
+		size_t get_ply() const { return history.size(); }
+		// moves made since the start or the last irreversible move, for repetition detection
+		bool is_repetition() const;
+
+	private:
+		static constexpr uint8_t EMPTY = 12;
+
+		struct Undo
+		{
+			Move move;
+			uint8_t captured;
+			uint8_t castling_rights;
+			Square en_passant;
+			int halfmove_clock;
+			uint64_t key;
+			Bitboard checkers;
+		};
+
+		static uint8_t make_piece(Color color, PieceType type) { return uint8_t(color * 6 + type); }
+
+		void put_piece(Square square, uint8_t piece);
+		void remove_piece(Square square);
+		void move_piece(Square from, Square to);
+		void update_checkers();
+		Bitboard get_pinned(Square king) const;
+		void add_pawn_moves(MoveList& moves, Bitboard target_mask, Bitboard pinned, Square king) const;
+
+		Bitboard pieces[2][6] = {};
+		Bitboard colors[2] = {};
+		Bitboard occupied = 0;
+		std::array<uint8_t, 64> board;
+		Color side = WHITE;
+		uint8_t castling_rights = 0;
+		Square en_passant = NO_SQUARE;
+		int halfmove_clock = 0;
+		int fullmove_number = 1;
+		uint64_t key = 0;
+		// enemy pieces giving check to the side to move
+		Bitboard checkers = 0;
+		std::vector<Undo> history;
+	};
+}
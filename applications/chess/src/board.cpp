@@ -95,4 +95,31 @@ Board::Board(GameEngineT& engine)
 		piece.move_to_tile(get_tile(val.second.second, val.second.first));
 		piece.side = i < mapping.size()/2 ? Piece::Side::WHITE : Piece::Side::BLACK;
 	}
-}
\ No newline at end of file
+}
+
+void Board::play_move(GameEngineT& engine, Chess::Move move)
+{
+	Tile* from = get_tile(move.get_from());
+	Tile* to = get_tile(move.get_to());
+	if (move.is_capture())
+	{
+		// the pawn taken en passant is not on the tile moved to
+		Tile* captured = move.get_flags() == Chess::Move::EN_PASSANT ? get_tile(move.get_to() ^ 8) : to;
+		engine.delete_object(captured->piece->get_id());
+		captured->piece = nullptr;
+	}
+	from->piece->move_to_tile(to);
+	if (move.get_flags() == Chess::Move::KING_CASTLE)
+	{
+		get_tile(move.get_to() + 1)->piece->move_to_tile(get_tile(move.get_to() - 1));
+	} else if (move.get_flags() == Chess::Move::QUEEN_CASTLE)
+	{
+		get_tile(move.get_to() - 2)->piece->move_to_tile(get_tile(move.get_to() + 1));
+	} else if (move.is_promotion())
+	{
+		// the pawn model stays, only the type changes
+		static constexpr int promotion_types[] = { Piece::KNIGHT, Piece::BISHOP, Piece::ROOK, Piece::QUEEN };
+		to->piece->type = promotion_types[move.get_promotion_type() - Chess::KNIGHT];
+	}
+	position.make_move(move);
+}
@@ -2,6 +2,7 @@
 
 #include "chess_engine.hpp"
 #include "pieces.hpp"
+#include "bitboard/position.hpp"
 
 #include <objects/object.hpp>
 #include <maths.hpp>
@@ -48,8 +49,16 @@ public:
 			throw std::runtime_error("Board::get_tile: err out of bounds!");
 		return tiles[y*size+x];
 	}
+	// the models have the king on x = 3, so files run from h at x = 0 to a at x = 7
+	Tile* get_tile(Chess::Square square) { return get_tile(7 - Chess::file_of(square), Chess::rank_of(square)); }
+	static Chess::Square get_square(const Tile* tile) { return Chess::make_square(7 - tile->pos.first, tile->pos.second); }
+
+	// moves the models for a legal move, including the rook of a castle and a pawn taken en passant, and plays it on the position
+	void play_move(GameEngineT& engine, Chess::Move move);
 
 	std::vector<Tile*> tiles;
+	// the rules side of the game, legal moves come from here and every move made on the board is played on it too
+	Chess::Position position = Chess::Position::from_fen(Chess::Position::START_FEN);
 
 private:
 	// std::vector<Piece&> pieces;
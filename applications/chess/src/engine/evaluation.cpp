@@ -0,0 +1,132 @@
+#include "evaluation.hpp"
+
+#include <algorithm>
+
+
+namespace
+{
+	using namespace Chess;
+
+	// from white's side with a8 first, as the tables are usually written, black reads them mirrored
+	// values from the simplified evaluation function by Tomasz Michniewski
+	constexpr int PIECE_SQUARE_TABLES[6][64] = {
+		{
+			  0,  0,  0,  0,  0,  0,  0,  0,
+			 50, 50, 50, 50, 50, 50, 50, 50,
+			 10, 10, 20, 30, 30, 20, 10, 10,
+			  5,  5, 10, 25, 25, 10,  5,  5,
+			  0,  0,  0, 20, 20,  0,  0,  0,
+			  5, -5,-10,  0,  0,-10, -5,  5,
+			  5, 10, 10,-20,-20, 10, 10,  5,
+			  0,  0,  0,  0,  0,  0,  0,  0,
+		},
+		{
+			-50,-40,-30,-30,-30,-30,-40,-50,
+			-40,-20,  0,  0,  0,  0,-20,-40,
+			-30,  0, 10, 15, 15, 10,  0,-30,
+			-30,  5, 15, 20, 20, 15,  5,-30,
+			-30,  0, 15, 20, 20, 15,  0,-30,
+			-30,  5, 10, 15, 15, 10,  5,-30,
+			-40,-20,  0,  5,  5,  0,-20,-40,
+			-50,-40,-30,-30,-30,-30,-40,-50,
+		},
+		{
+			-20,-10,-10,-10,-10,-10,-10,-20,
+			-10,  0,  0,  0,  0,  0,  0,-10,
+			-10,  0,  5, 10, 10,  5,  0,-10,
+			-10,  5,  5, 10, 10,  5,  5,-10,
+			-10,  0, 10, 10, 10, 10,  0,-10,
+			-10, 10, 10, 10, 10, 10, 10,-10,
+			-10,  5,  0,  0,  0,  0,  5,-10,
+			-20,-10,-10,-10,-10,-10,-10,-20,
+		},
+		{
+			  0,  0,  0,  0,  0,  0,  0,  0,
+			  5, 10, 10, 10, 10, 10, 10,  5,
+			 -5,  0,  0,  0,  0,  0,  0, -5,
+			 -5,  0,  0,  0,  0,  0,  0, -5,
+			 -5,  0,  0,  0,  0,  0,  0, -5,
+			 -5,  0,  0,  0,  0,  0,  0, -5,
+			 -5,  0,  0,  0,  0,  0,  0, -5,
+			  0,  0,  0,  5,  5,  0,  0,  0,
+		},
+		{
+			-20,-10,-10, -5, -5,-10,-10,-20,
+			-10,  0,  0,  0,  0,  0,  0,-10,
+			-10,  0,  5,  5,  5,  5,  0,-10,
+			 -5,  0,  5,  5,  5,  5,  0, -5,
+			  0,  0,  5,  5,  5,  5,  0, -5,
+			-10,  5,  5,  5,  5,  5,  0,-10,
+			-10,  0,  5,  0,  0,  0,  0,-10,
+			-20,-10,-10, -5, -5,-10,-10,-20,
+		},
+		{
+			-30,-40,-40,-50,-50,-40,-40,-30,
+			-30,-40,-40,-50,-50,-40,-40,-30,
+			-30,-40,-40,-50,-50,-40,-40,-30,
+			-30,-40,-40,-50,-50,-40,-40,-30,
+			-20,-30,-30,-40,-40,-30,-30,-20,
+			-10,-20,-20,-20,-20,-20,-20,-10,
+			 20, 20,  0,  0,  0,  0, 20, 20,
+			 20, 30, 10,  0,  0, 10, 30, 20,
+		},
+	};
+
+	// the king walks to the centre once the queens and most pieces are gone
+	constexpr int KING_ENDGAME_TABLE[64] = {
+		-50,-40,-30,-20,-20,-30,-40,-50,
+		-30,-20,-10,  0,  0,-10,-20,-30,
+		-30,-10, 20, 30, 30, 20,-10,-30,
+		-30,-10, 30, 40, 40, 30,-10,-30,
+		-30,-10, 30, 40, 40, 30,-10,-30,
+		-30,-10, 20, 30, 30, 20,-10,-30,
+		-30,-30,  0,  0,  0,  0,-30,-30,
+		-50,-30,-30,-30,-30,-30,-30,-50,
+	};
+
+	// knights and bishops count 1, rooks 2 and queens 4, 24 is the full starting set
+	constexpr int PHASE_WEIGHTS[] = { 0, 1, 1, 2, 4, 0 };
+	constexpr int MAX_PHASE = 24;
+
+	int get_table_index(Color color, Square square)
+	{
+		// the tables start at a8, white's a8 is black's a1
+		return color == WHITE ? square ^ 56 : square;
+	}
+}
+
+namespace Chess
+{
+	int evaluate(const Position& position)
+	{
+		int phase = 0;
+		int score = 0;
+		int king_middlegame = 0;
+		int king_endgame = 0;
+		for (const Color color : { WHITE, BLACK })
+		{
+			const int sign = color == WHITE ? 1 : -1;
+			for (int type = PAWN; type <= KING; type++)
+			{
+				for (Bitboard pieces = position.get_pieces(color, PieceType(type)); pieces;)
+				{
+					const int index = get_table_index(color, pop_lsb(pieces));
+					phase += PHASE_WEIGHTS[type];
+					if (type == KING)
+					{
+						king_middlegame += sign * PIECE_SQUARE_TABLES[KING][index];
+						king_endgame += sign * KING_ENDGAME_TABLE[index];
+					} else
+					{
+						score += sign * (PIECE_VALUES[type] + PIECE_SQUARE_TABLES[type][index]);
+					}
+				}
+			}
+		}
+
+		phase = std::min(phase, MAX_PHASE);
+		score += (king_middlegame * phase + king_endgame * (MAX_PHASE - phase)) / MAX_PHASE;
+
+		return position.get_side() == WHITE ? score : -score;
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <bitboard/position.hpp>
+
+
+//
+// static evaluation in centipawns from the side to move's point of view
+//	material plus piece square tables, blended between middlegame and endgame tables by the material left,
+//	small on purpose, the search does the heavy lifting
+//
+namespace Chess
+{
+	constexpr int PIECE_VALUES[] = { 100, 320, 330, 500, 900, 0 };
+
+	int evaluate(const Position& position);
+}
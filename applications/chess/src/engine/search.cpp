@@ -0,0 +1,534 @@
+#include "search.hpp"
+#include "evaluation.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+
+using namespace Chess;
+
+namespace
+{
+	// mates are stored relative to the node rather than the root, so a table hit at another ply reads the right distance
+	int score_to_table(int score, int ply)
+	{
+		return score >= Search::MATE - Search::MAX_PLY ? score + ply : score <= -Search::MATE + Search::MAX_PLY ? score - ply : score;
+	}
+
+	int score_from_table(int score, int ply)
+	{
+		return score >= Search::MATE - Search::MAX_PLY ? score - ply : score <= -Search::MATE + Search::MAX_PLY ? score + ply : score;
+	}
+
+	// order bands, the table move first, then winning to losing captures, killers and quiet moves by history
+	constexpr int TABLE_MOVE_SCORE = 1 << 30;
+	constexpr int CAPTURE_SCORE = 1 << 28;
+	constexpr int KILLER_SCORE = 1 << 27;
+}
+
+class Search::Thread
+{
+public:
+	Thread(Search& search, int index) :
+		search(search),
+		index(index)
+	{
+		std::memset(history, 0, sizeof(history));
+	}
+
+	void prepare(const Position& root)
+	{
+		position = root;
+		nodes = 0;
+		best_move = Move();
+		completed = SearchInfo{};
+		for (auto& ply_killers : killers)
+		{
+			ply_killers[0] = ply_killers[1] = Move();
+		}
+		// history from the last search still says something, but shouldn't outweigh what this one learns
+		for (auto& from : history)
+		{
+			for (auto& to : from)
+			{
+				for (int& value : to)
+				{
+					value /= 8;
+				}
+			}
+		}
+	}
+
+	void clear_history()
+	{
+		std::memset(history, 0, sizeof(history));
+	}
+
+	void iterate(const std::function<void(const SearchInfo&)>& on_info)
+	{
+		for (int depth = 1; depth <= search.limits.max_depth; depth++)
+		{
+			// helpers on odd indices run a ply ahead, so threads spread over two depths rather than racing on one
+			const int thread_depth = std::min(depth + (index % 2), MAX_PLY - 1);
+			const int score = search_node(-INFINITE_SCORE, INFINITE_SCORE, thread_depth, 0, false);
+			if (search.should_stop)
+			{
+				// an unfinished iteration is only trusted for its first move, the previous one's result stands
+				break;
+			}
+
+			best_move = pv[0][0];
+			completed.depth = thread_depth;
+			completed.score = score;
+			completed.principal_variation.assign(pv[0], pv[0] + pv_length[0]);
+			if (index != 0)
+			{
+				continue;
+			}
+
+			completed.seconds = search.get_elapsed_seconds();
+			completed.nodes = search.get_total_nodes();
+			completed.nodes_per_second = completed.seconds > 0.0 ? double(completed.nodes) / completed.seconds : 0.0;
+			if (on_info)
+			{
+				on_info(completed);
+			}
+			// a new depth takes longer than everything before it, don't start one that can't finish
+			if (search.limits.time.count() > 0 && completed.seconds * 2.0 > std::chrono::duration<double>(search.limits.time).count())
+			{
+				break;
+			}
+			if (is_mate_score(score) && MATE - std::abs(score) <= depth)
+			{
+				// the mate is found with all replies, searching deeper finds nothing new
+				break;
+			}
+		}
+	}
+
+	Position position;
+	std::atomic<uint64_t> nodes = 0;
+	Move best_move;
+	SearchInfo completed;
+
+private:
+	int search_node(int alpha, int beta, int depth, int ply, bool is_null_allowed);
+	int quiescence(int alpha, int beta, int ply);
+	void score_moves(const MoveList& moves, int* scores, Move table_move, int ply) const;
+	static Move pick_next(MoveList& moves, int* scores, size_t i);
+	void count_node()
+	{
+		const uint64_t count = nodes.fetch_add(1, std::memory_order_relaxed) + 1;
+		if (index == 0 && (count & 2047) == 0)
+		{
+			search.check_limits();
+		}
+	}
+
+	Search& search;
+	const int index;
+	Move killers[MAX_PLY][2];
+	// [side][from][to], bumped for quiet moves that cause cutoffs
+	int history[2][64][64];
+	Move pv[MAX_PLY][MAX_PLY];
+	int pv_length[MAX_PLY] = {};
+};
+
+int Search::Thread::search_node(int alpha, int beta, int depth, int ply, bool is_null_allowed)
+{
+	pv_length[ply] = ply;
+	const bool is_root = ply == 0;
+	const bool is_pv = beta - alpha > 1;
+	const bool in_check = position.is_in_check();
+	if (search.should_stop)
+	{
+		return 0;
+	}
+	if (!is_root)
+	{
+		if (position.get_halfmove_clock() >= 100 || position.is_repetition())
+		{
+			return 0;
+		}
+		// no line from here can beat a mate that was already found closer to the root
+		alpha = std::max(alpha, -MATE + ply);
+		beta = std::min(beta, MATE - ply - 1);
+		if (alpha >= beta)
+		{
+			return alpha;
+		}
+	}
+	if (ply >= MAX_PLY - 1)
+	{
+		return evaluate(position);
+	}
+	// checks are searched a ply deeper so forcing lines aren't cut off at the horizon
+	if (in_check)
+	{
+		depth++;
+	}
+	if (depth <= 0)
+	{
+		return quiescence(alpha, beta, ply);
+	}
+	count_node();
+
+	TranspositionTable::Entry entry;
+	Move table_move;
+	if (search.table.probe(position.get_key(), entry))
+	{
+		table_move = entry.move;
+		const int score = score_from_table(entry.score, ply);
+		if (!is_pv && !is_root && entry.depth >= depth && (
+			entry.bound == TranspositionTable::Bound::EXACT ||
+			(entry.bound == TranspositionTable::Bound::LOWER && score >= beta) ||
+			(entry.bound == TranspositionTable::Bound::UPPER && score <= alpha)))
+		{
+			return score;
+		}
+	}
+
+	// null move pruning, if passing still beats beta a real move will too, except in zugzwang which needs pieces gone
+	const Color us = position.get_side();
+	const bool has_pieces = (position.get_pieces(us) & ~position.get_pieces(us, PAWN) & ~position.get_pieces(us, KING)) != 0;
+	if (!is_pv && !in_check && is_null_allowed && depth >= 3 && has_pieces && evaluate(position) >= beta)
+	{
+		const int reduction = 3 + depth / 6;
+		position.make_null_move();
+		const int score = -search_node(-beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+		position.unmake_null_move();
+		if (search.should_stop)
+		{
+			return 0;
+		}
+		if (score >= beta && !is_mate_score(score))
+		{
+			return beta;
+		}
+	}
+
+	MoveList moves;
+	position.generate_legal_moves(moves);
+	if (moves.empty())
+	{
+		return in_check ? -MATE + ply : 0;
+	}
+	int scores[256];
+	score_moves(moves, scores, table_move, ply);
+
+	const int original_alpha = alpha;
+	int best_score = -INFINITE_SCORE;
+	Move best_move;
+	for (size_t i = 0; i < moves.size(); i++)
+	{
+		const Move move = pick_next(moves, scores, i);
+		const bool is_quiet = !move.is_capture() && !move.is_promotion();
+		position.make_move(move);
+
+		int score;
+		if (i == 0)
+		{
+			score = -search_node(-beta, -alpha, depth - 1, ply + 1, true);
+		} else
+		{
+			// late quiet moves are unlikely to be best, try them shallower first
+			int reduction = 0;
+			if (depth >= 3 && i >= 3 && is_quiet && !in_check && !position.is_in_check())
+			{
+				reduction = 1 + (i >= 8) + (depth >= 8);
+			}
+			// the first move is assumed best, the rest only have to be shown worse with a null window
+			score = -search_node(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1, true);
+			if (score > alpha && reduction > 0)
+			{
+				score = -search_node(-alpha - 1, -alpha, depth - 1, ply + 1, true);
+			}
+			if (score > alpha && score < beta)
+			{
+				score = -search_node(-beta, -alpha, depth - 1, ply + 1, true);
+			}
+		}
+		position.unmake_move();
+		if (search.should_stop)
+		{
+			return 0;
+		}
+
+		if (score > best_score)
+		{
+			best_score = score;
+			best_move = move;
+		}
+		if (score > alpha)
+		{
+			alpha = score;
+			pv[ply][ply] = move;
+			std::copy(pv[ply + 1] + ply + 1, pv[ply + 1] + pv_length[ply + 1], pv[ply] + ply + 1);
+			pv_length[ply] = pv_length[ply + 1];
+		}
+		if (alpha >= beta)
+		{
+			if (is_quiet)
+			{
+				if (killers[ply][0] != move)
+				{
+					killers[ply][1] = killers[ply][0];
+					killers[ply][0] = move;
+				}
+				int& value = history[us][move.get_from()][move.get_to()];
+				value = std::min(value + depth * depth, KILLER_SCORE - 1);
+			}
+			break;
+		}
+	}
+
+	const TranspositionTable::Bound bound = best_score >= beta ? TranspositionTable::Bound::LOWER :
+		alpha > original_alpha ? TranspositionTable::Bound::EXACT : TranspositionTable::Bound::UPPER;
+	search.table.store(position.get_key(), bound == TranspositionTable::Bound::UPPER ? Move() : best_move, score_to_table(best_score, ply), depth, bound);
+
+	return best_score;
+}
+
+int Search::Thread::quiescence(int alpha, int beta, int ply)
+{
+	pv_length[ply] = ply;
+	count_node();
+	if (search.should_stop)
+	{
+		return 0;
+	}
+	const bool in_check = position.is_in_check();
+	if (ply >= MAX_PLY - 1)
+	{
+		return evaluate(position);
+	}
+
+	// captures only, unless in check where every evasion has to be looked at, standing pat is not an option then
+	int best_score = -INFINITE_SCORE;
+	if (!in_check)
+	{
+		best_score = evaluate(position);
+		if (best_score >= beta)
+		{
+			return best_score;
+		}
+		alpha = std::max(alpha, best_score);
+	}
+
+	MoveList moves;
+	position.generate_legal_moves(moves);
+	if (in_check && moves.empty())
+	{
+		return -MATE + ply;
+	}
+	int scores[256];
+	score_moves(moves, scores, Move(), ply);
+	for (size_t i = 0; i < moves.size(); i++)
+	{
+		const Move move = pick_next(moves, scores, i);
+		if (!in_check && !move.is_capture() && !move.is_promotion())
+		{
+			// sorted, the rest are quiet too
+			break;
+		}
+
+		position.make_move(move);
+		const int score = -quiescence(-beta, -alpha, ply + 1);
+		position.unmake_move();
+		if (search.should_stop)
+		{
+			return 0;
+		}
+
+		if (score > best_score)
+		{
+			best_score = score;
+			if (score > alpha)
+			{
+				alpha = score;
+				pv[ply][ply] = move;
+				std::copy(pv[ply + 1] + ply + 1, pv[ply + 1] + pv_length[ply + 1], pv[ply] + ply + 1);
+				pv_length[ply] = pv_length[ply + 1];
+			}
+			if (alpha >= beta)
+			{
+				break;
+			}
+		}
+	}
+
+	return best_score;
+}
+
+void Search::Thread::score_moves(const MoveList& moves, int* scores, Move table_move, int ply) const
+{
+	const Color us = position.get_side();
+	for (size_t i = 0; i < moves.size(); i++)
+	{
+		const Move move = moves[i];
+		if (move == table_move)
+		{
+			scores[i] = TABLE_MOVE_SCORE;
+		} else if (move.is_capture() || move.is_promotion())
+		{
+			// most valuable victim, then least valuable attacker
+			const PieceType victim = move.get_flags() == Move::EN_PASSANT ? PAWN : position.get_piece_type(move.get_to());
+			const int victim_value = victim == NO_PIECE_TYPE ? 0 : PIECE_VALUES[victim];
+			const int promotion_value = move.is_promotion() ? PIECE_VALUES[move.get_promotion_type()] : 0;
+			scores[i] = CAPTURE_SCORE + (victim_value + promotion_value) * 8 - int(position.get_piece_type(move.get_from()));
+		} else if (move == killers[ply][0] || move == killers[ply][1])
+		{
+			scores[i] = KILLER_SCORE;
+		} else
+		{
+			scores[i] = history[us][move.get_from()][move.get_to()];
+		}
+	}
+}
+
+Move Search::Thread::pick_next(MoveList& moves, int* scores, size_t i)
+{
+	// selection sort one step at a time, a cutoff usually comes early and leaves the rest unsorted
+	size_t best = i;
+	for (size_t j = i + 1; j < moves.size(); j++)
+	{
+		if (scores[j] > scores[best])
+		{
+			best = j;
+		}
+	}
+	std::swap(moves[i], moves[best]);
+	std::swap(scores[i], scores[best]);
+	return moves[i];
+}
+
+Search::Search(size_t table_megabytes) :
+	table(table_megabytes)
+{
+}
+
+Search::~Search()
+{
+	stop();
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+}
+
+double Search::get_elapsed_seconds() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+uint64_t Search::get_total_nodes() const
+{
+	uint64_t nodes = 0;
+	for (const auto& thread : threads)
+	{
+		nodes += thread->nodes.load(std::memory_order_relaxed);
+	}
+	return nodes;
+}
+
+void Search::check_limits()
+{
+	if ((limits.time.count() > 0 && std::chrono::steady_clock::now() - start_time >= limits.time) ||
+		(limits.max_nodes > 0 && get_total_nodes() >= limits.max_nodes))
+	{
+		should_stop = true;
+	}
+}
+
+SearchResult Search::run(const Position& position, const SearchLimits& limits, std::function<void(const SearchInfo&)> on_info)
+{
+	this->limits = limits;
+	this->limits.max_depth = std::clamp(limits.max_depth, 1, MAX_PLY - 1);
+	should_stop = false;
+	start_time = std::chrono::steady_clock::now();
+	table.new_search();
+
+	const size_t num_threads = size_t(std::max(limits.num_threads, 1));
+	while (threads.size() < num_threads)
+	{
+		threads.push_back(std::make_unique<Thread>(*this, int(threads.size())));
+	}
+	threads.resize(num_threads);
+	for (const auto& thread : threads)
+	{
+		thread->prepare(position);
+	}
+
+	std::vector<std::thread> helpers;
+	for (size_t i = 1; i < num_threads; i++)
+	{
+		helpers.emplace_back([thread = threads[i].get()]() { thread->iterate({}); });
+	}
+	threads[0]->iterate(on_info);
+	// the main thread decides when the search is over, helpers only add to the table
+	should_stop = true;
+	for (std::thread& helper : helpers)
+	{
+		helper.join();
+	}
+
+	SearchResult result;
+	result.best_move = threads[0]->best_move;
+	result.info = threads[0]->completed;
+	result.info.seconds = get_elapsed_seconds();
+	result.info.nodes = get_total_nodes();
+	result.info.nodes_per_second = result.info.seconds > 0.0 ? double(result.info.nodes) / result.info.seconds : 0.0;
+	if (result.best_move.is_null())
+	{
+		// stopped before the first depth finished, any legal move beats none
+		MoveList moves;
+		position.generate_legal_moves(moves);
+		if (!moves.empty())
+		{
+			result.best_move = moves[0];
+		}
+	}
+
+	return result;
+}
+
+void Search::start(const Position& position, const SearchLimits& limits, std::function<void(const SearchInfo&)> on_info)
+{
+	if (worker.joinable())
+	{
+		throw std::runtime_error("Search::start: a search is already running");
+	}
+
+	is_worker_done = false;
+	worker = std::thread([this, position, limits, on_info = std::move(on_info)]()
+	{
+		worker_result = run(position, limits, on_info);
+		is_worker_done = true;
+	});
+}
+
+std::optional<SearchResult> Search::poll()
+{
+	if (!worker.joinable() || !is_worker_done)
+	{
+		return std::nullopt;
+	}
+
+	worker.join();
+	return worker_result;
+}
+
+void Search::clear()
+{
+	if (worker.joinable())
+	{
+		throw std::runtime_error("Search::clear: can't clear during a search");
+	}
+
+	table.clear();
+	for (const auto& thread : threads)
+	{
+		thread->clear_history();
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "transposition_table.hpp"
+
+#include <bitboard/position.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+
+//
+// iterative deepening principal variation search (alpha-beta with null windows after the first move)
+//	with a quiescence search, null move pruning, late move reductions and move ordering by
+//	transposition table move, captures by MVV-LVA, killer moves and history
+//
+//	multi threaded by Lazy SMP, every thread searches the same root on its own copy of the position
+//	and they only share the transposition table, helpers start at staggered depths so they fill in results
+//	the main thread then finds in the table instead of duplicating its work
+//
+struct SearchLimits
+{
+	std::chrono::milliseconds time = std::chrono::milliseconds(1000);
+	int max_depth = 64;
+	// 0 is no limit
+	uint64_t max_nodes = 0;
+	int num_threads = 1;
+};
+
+// reported after each finished depth
+struct SearchInfo
+{
+	int depth = 0;
+	// centipawns from the side to move's point of view, mates are near Search::MATE
+	int score = 0;
+	uint64_t nodes = 0;
+	double seconds = 0.0;
+	double nodes_per_second = 0.0;
+	std::vector<Chess::Move> principal_variation;
+};
+
+struct SearchResult
+{
+	// null when the side to move has no legal moves
+	Chess::Move best_move;
+	SearchInfo info;
+};
+
+class Search
+{
+public:
+	static constexpr int MATE = 32000;
+	static constexpr int INFINITE_SCORE = 32001;
+	static constexpr int MAX_PLY = 128;
+
+	explicit Search(size_t table_megabytes = 64);
+	~Search();
+
+	// blocks until done, on_info is called from the searching thread
+	SearchResult run(const Chess::Position& position, const SearchLimits& limits, std::function<void(const SearchInfo&)> on_info = {});
+
+	// the same on a worker thread, so a frame loop only has to poll for the result
+	void start(const Chess::Position& position, const SearchLimits& limits, std::function<void(const SearchInfo&)> on_info = {});
+	// the result once the worker has finished, after which a new search can be started
+	std::optional<SearchResult> poll();
+	// makes a running search return what it has as soon as possible
+	void stop() { should_stop = true; }
+	bool is_searching() const { return worker.joinable(); }
+
+	// forgets everything learned, for a new game
+	void clear();
+
+	static bool is_mate_score(int score) { return std::abs(score) >= MATE - MAX_PLY; }
+
+private:
+	class Thread;
+
+	double get_elapsed_seconds() const;
+	uint64_t get_total_nodes() const;
+	// called by the main thread every so many nodes, sets should_stop once the time or node budget is spent
+	void check_limits();
+
+	TranspositionTable table;
+	std::atomic<bool> should_stop = false;
+	std::vector<std::unique_ptr<Thread>> threads;
+	SearchLimits limits;
+	std::chrono::steady_clock::time_point start_time;
+
+	std::thread worker;
+	std::atomic<bool> is_worker_done = false;
+	SearchResult worker_result;
+};
@@ -0,0 +1,95 @@
+#include "transposition_table.hpp"
+
+#include <algorithm>
+#include <bit>
+
+
+namespace
+{
+	Chess::Move get_move(uint64_t data) { return Chess::Move::from_data(uint16_t(data)); }
+	int get_score(uint64_t data) { return int(int16_t(uint16_t(data >> 16))); }
+	int get_depth(uint64_t data) { return int(uint8_t(data >> 32)); }
+	TranspositionTable::Bound get_bound(uint64_t data) { return TranspositionTable::Bound((data >> 40) & 3); }
+	uint8_t get_generation(uint64_t data) { return uint8_t(data >> 42) & 63; }
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+{
+	resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+	const size_t num_slots = std::bit_floor(std::max<size_t>(megabytes * 1024 * 1024 / sizeof(Slot), 1024));
+	slots = std::make_unique<Slot[]>(num_slots);
+	mask = num_slots - 1;
+	clear();
+}
+
+void TranspositionTable::clear()
+{
+	for (size_t i = 0; i <= mask; i++)
+	{
+		slots[i].key_xor_data.store(0, std::memory_order_relaxed);
+		slots[i].data.store(0, std::memory_order_relaxed);
+	}
+	generation = 0;
+}
+
+uint64_t TranspositionTable::pack(Chess::Move move, int score, int depth, Bound bound, uint8_t generation)
+{
+	return uint64_t(move.get_data()) |
+		(uint64_t(uint16_t(int16_t(score))) << 16) |
+		(uint64_t(uint8_t(std::clamp(depth, 0, 255))) << 32) |
+		(uint64_t(bound) << 40) |
+		(uint64_t(generation) << 42);
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry& entry) const
+{
+	const Slot& slot = slots[key & mask];
+	const uint64_t data = slot.data.load(std::memory_order_relaxed);
+	if ((slot.key_xor_data.load(std::memory_order_relaxed) ^ data) != key || get_bound(data) == Bound::NONE)
+	{
+		return false;
+	}
+
+	entry.move = get_move(data);
+	entry.score = get_score(data);
+	entry.depth = get_depth(data);
+	entry.bound = get_bound(data);
+	return true;
+}
+
+void TranspositionTable::store(uint64_t key, Chess::Move move, int score, int depth, Bound bound)
+{
+	Slot& slot = slots[key & mask];
+	const uint64_t old_data = slot.data.load(std::memory_order_relaxed);
+	const bool same_position = (slot.key_xor_data.load(std::memory_order_relaxed) ^ old_data) == key;
+
+	// deeper results from this search are worth more than shallower ones, anything from an older search can go
+	if (!same_position && get_generation(old_data) == generation && get_depth(old_data) > depth + 2 && bound != Bound::EXACT)
+	{
+		return;
+	}
+	// a result without a move keeps the move found earlier, it's still the best guess to try first
+	if (same_position && move.is_null())
+	{
+		move = get_move(old_data);
+	}
+
+	const uint64_t data = pack(move, score, depth, bound, generation);
+	slot.key_xor_data.store(key ^ data, std::memory_order_relaxed);
+	slot.data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::get_fill_permille() const
+{
+	int count = 0;
+	for (size_t i = 0; i < 1000; i++)
+	{
+		const uint64_t data = slots[i].data.load(std::memory_order_relaxed);
+		count += get_bound(data) != Bound::NONE && get_generation(data) == generation;
+	}
+	return count;
+}
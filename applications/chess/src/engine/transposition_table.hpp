@@ -0,0 +1,65 @@
+#pragma once
+
+#include <bitboard/position.hpp>
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+
+//
+// hash table of search results shared by every search thread without locks
+//	an entry is two 64 bit words, the data and the key xor-ed with the data, written and read separately
+//	a torn entry, half written by another thread, fails the key check and reads as a miss instead of as garbage
+//
+class TranspositionTable
+{
+public:
+	enum class Bound : uint8_t
+	{
+		NONE,
+		// the score is exact, a lower bound after a beta cutoff, or an upper bound when no move raised alpha
+		EXACT,
+		LOWER,
+		UPPER,
+	};
+
+	struct Entry
+	{
+		Chess::Move move;
+		int score;
+		int depth;
+		Bound bound;
+	};
+
+	explicit TranspositionTable(size_t megabytes = 64);
+
+	// rounds down to a power of two number of entries and clears
+	void resize(size_t megabytes);
+	void clear();
+	// entries from older searches are replaced first
+	void new_search() { generation = (generation + 1) & GENERATION_MASK; }
+
+	bool probe(uint64_t key, Entry& entry) const;
+	void store(uint64_t key, Chess::Move move, int score, int depth, Bound bound);
+
+	// permille of a sample of entries written by the current search, as UCI's hashfull
+	int get_fill_permille() const;
+	size_t get_num_entries() const { return mask + 1; }
+
+private:
+	static constexpr uint8_t GENERATION_MASK = 63;
+
+	struct Slot
+	{
+		std::atomic<uint64_t> key_xor_data;
+		std::atomic<uint64_t> data;
+	};
+
+	// move 16 bits, score 16, depth 8, bound 2, generation 6
+	static uint64_t pack(Chess::Move move, int score, int depth, Bound bound, uint8_t generation);
+
+	std::unique_ptr<Slot[]> slots;
+	size_t mask = 0;
+	uint8_t generation = 0;
+};
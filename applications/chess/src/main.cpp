@@ -2,6 +2,7 @@
 #include "pieces.hpp"
 #include "board.hpp"
 #include "state_machine.hpp"
+#include "engine/search.hpp"
 
 #include <game_engine.hpp>
 #include <graphics_engine/graphics_engine.hpp>
@@ -11,10 +12,12 @@
 #include <camera.hpp>
 #include <objects/light_source.hpp>
 
+#include <quill/LogMacros.h>
 #include <fmt/core.h>
 #include <fmt/color.h>
 #include <glm/gtx/string_cast.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 class Application : public IApplication
@@ -30,12 +33,36 @@ public:
 
 	virtual void on_tick(float delta) override
 	{
+		if (board.position.get_side() != computer_side)
+		{
+			return;
+		}
 
+		// the search runs on its own thread, a frame only starts it and picks up the move once it's there
+		if (!search.is_searching())
+		{
+			Chess::MoveList moves;
+			board.position.generate_legal_moves(moves);
+			if (!moves.empty())
+			{
+				search.start(board.position, search_limits, [](const SearchInfo& info)
+				{
+					LOG_INFO(Utility::get_logger(), "Search: depth {} score {} nodes {} {:.0f} knps", info.depth, info.score, info.nodes, info.nodes_per_second * 1e-3);
+				});
+			}
+		} else if (const auto result = search.poll())
+		{
+			board.play_move(engine, result->best_move);
+		}
 	}
 
 	virtual void on_click(Object& object) override
 	{
-		state = state->process(object);
+		// the pieces can't be touched while the computer is thinking
+		if (board.position.get_side() != computer_side)
+		{
+			state = state->process(object);
+		}
 	}
 	
 	virtual void on_begin() override
@@ -49,6 +76,11 @@ private:
 	Board board;
 	Tile* active_tile = nullptr;
 	State* state = State::initial.get();
+
+	// the computer plays black
+	const Chess::Color computer_side = Chess::BLACK;
+	const SearchLimits search_limits = { std::chrono::milliseconds(2000), Search::MAX_PLY - 1, 0, int(std::max(1u, std::thread::hardware_concurrency() / 2)) };
+	Search search;
 };
 
 int main()
@@ -33,11 +33,8 @@ public:
 
 	Tile* get_tile() { return tile; }
 
-	std::vector<std::pair<int, int>> get_move_set() { return get_move_set(type); }
-
 	Side side = Side::WHITE;
 
 private:
-	std::vector<std::pair<int, int>> get_move_set(int desired_type);
 	Tile* tile;
 };
\ No newline at end of file
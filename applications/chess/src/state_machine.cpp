@@ -2,6 +2,7 @@
 
 #include <game_engine.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 
@@ -31,10 +32,15 @@ State* Initial::process(Object& object)
 	}
 	
 	piece->get_tile()->highlight(true);
-	const auto move_set = piece->get_move_set();
-	for (auto move : move_set)
+	const Chess::Square from = Board::get_square(piece->get_tile());
+	Chess::MoveList moves;
+	board->position.generate_legal_moves(moves);
+	for (const Chess::Move move : moves)
 	{
-		board->get_tile(move.first, move.second)->highlight(true);
+		if (move.get_from() == from)
+		{
+			board->get_tile(move.get_to())->highlight(true);
+		}
 	}
 	piece_selected->current_tile = piece->get_tile();
 
@@ -61,12 +67,20 @@ State* PieceSelected::process(Object& object)
 
 	if (tile->is_highlighted() && tile != current_tile)
 	{
-		if (tile->piece)
+		// promotions are always to a queen, there is no piece picker
+		const Chess::Square from = Board::get_square(current_tile);
+		const Chess::Square to = Board::get_square(tile);
+		Chess::MoveList moves;
+		board->position.generate_legal_moves(moves);
+		const auto it = std::find_if(moves.begin(), moves.end(), [&](const Chess::Move& move)
+		{
+			return move.get_from() == from && move.get_to() == to && (!move.is_promotion() || move.get_promotion_type() == Chess::QUEEN);
+		});
+
+		if (it != moves.end())
 		{
-			engine->delete_object(tile->piece->get_id());
-			tile->piece = nullptr;
+			board->play_move(*engine, *it);
 		}
-		current_tile->piece->move_to_tile(tile);
 	}
 
 	for (auto* t : board->tiles)
@@ -1,31 +1,133 @@
 #include "tile_system.hpp"
 
+#include <glm/glm.hpp>
+
+
+namespace
+{
+	// rounds towards negative infinity so negative coordinates land in their own chunks
+	int floor_div(int value, int divisor)
+	{
+		return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+	}
+}
+
+TileCoord TileSet::get_chunk_coord(const TileCoord& coord)
+{
+	return TileCoord(floor_div(coord.x, CHUNK_SIZE), floor_div(coord.y, CHUNK_SIZE));
+}
+
+int TileSet::get_local_index(const TileCoord& coord)
+{
+	const TileCoord local = coord - get_chunk_coord(coord) * CHUNK_SIZE;
+	return local.y * CHUNK_SIZE + local.x;
+}
+
+TileSet::Chunk* TileSet::find_chunk(const TileCoord& chunk_coord) const
+{
+	if (last_chunk && last_chunk_coord == chunk_coord)
+	{
+		return last_chunk;
+	}
+
+	auto it = chunks.find(chunk_coord);
+	if (it == chunks.end())
+		return nullptr;
+
+	last_chunk_coord = chunk_coord;
+	last_chunk = it->second.get();
+	return last_chunk;
+}
 
 void TileSet::add_tile(const TileCoord& coord)
 {
-	tiles.emplace(coord, Tile(coord));
+	const TileCoord chunk_coord = get_chunk_coord(coord);
+	Chunk* chunk = find_chunk(chunk_coord);
+	if (!chunk)
+	{
+		chunk = chunks.emplace(chunk_coord, std::make_unique<Chunk>()).first->second.get();
+		last_chunk_coord = chunk_coord;
+		last_chunk = chunk;
+	}
+
+	auto& tile = chunk->tiles[get_local_index(coord)];
+	if (!tile)
+	{
+		tile.emplace(coord);
+		num_tiles++;
+	}
+}
+
+void TileSet::add_tiles(const TileCoord& first, const TileCoord& last)
+{
+	for (int y = first.y; y <= last.y; ++y)
+	{
+		for (int x = first.x; x <= last.x; ++x)
+		{
+			add_tile({x, y});
+		}
+	}
 }
 
 Tile* TileSet::get_tile(const TileCoord& coord)
 {
-	auto it = tiles.find(coord);
-	if (it == tiles.end())
+	Chunk* chunk = find_chunk(get_chunk_coord(coord));
+	if (!chunk)
+		return nullptr;
+
+	auto& tile = chunk->tiles[get_local_index(coord)];
+	return tile ? &*tile : nullptr;
+}
+
+const Tile* TileSet::get_tile(const TileCoord& coord) const
+{
+	const Chunk* chunk = find_chunk(get_chunk_coord(coord));
+	if (!chunk)
 		return nullptr;
-	return &it->second;
+
+	const auto& tile = chunk->tiles[get_local_index(coord)];
+	return tile ? &*tile : nullptr;
+}
+
+void TileSet::add_to_tile(const TileCoord& coord, const ObjectID& object_id)
+{
+	add_tile(coord);
+	Tile* tile = get_tile(coord);
+	tile->add_object(object_id);
+	object_to_tiles[object_id].push_back(tile);
+}
+
+void TileSet::remove_from_tile(const TileCoord& coord, const ObjectID& object_id)
+{
+	Tile* tile = get_tile(coord);
+	auto object_it = object_to_tiles.find(object_id);
+	if (!tile || object_it == object_to_tiles.end())
+		return;
+
+	auto& tiles = object_it->second;
+	auto it = std::find(tiles.begin(), tiles.end(), tile);
+	if (it == tiles.end())
+		return;
+
+	tiles.erase(it);
+	tile->remove_object(object_id);
+	if (tiles.empty())
+	{
+		object_to_tiles.erase(object_it);
+	}
 }
 
-std::vector<Tile*> TileSet::get_tiles(const ObjectID& object_id)
+const std::vector<Tile*>& TileSet::get_tiles(const ObjectID& object_id) const
 {
-	auto it = object_to_tile.find(object_id);
-	if (it == object_to_tile.end())
-		return {};
-	return it->second;
+	static const std::vector<Tile*> no_tiles;
+	auto it = object_to_tiles.find(object_id);
+	return it != object_to_tiles.end() ? it->second : no_tiles;
 }
 
 void TileSet::remove_object(const ObjectID& object_id)
 {
-	auto it = object_to_tile.find(object_id);
-	if (it == object_to_tile.end())
+	auto it = object_to_tiles.find(object_id);
+	if (it == object_to_tiles.end())
 		return;
 
 	for (auto tile : it->second)
@@ -33,36 +135,57 @@ void TileSet::remove_object(const ObjectID& object_id)
 		tile->remove_object(object_id);
 	}
 
-	object_to_tile.erase(it);
+	object_to_tiles.erase(it);
 }
 
-TileSystem::TileSystem()
+NavGrid TileSet::make_nav_grid() const
 {
-	auto& default_tileset = tilesets.emplace("", TileSet()).first->second;
-	// create a default tileset with 21x21 tiles
-	for (int i = -10; i <= 10; ++i)
+	if (chunks.empty())
+	{
+		return NavGrid(TileCoord(0), TileCoord(1), NavGrid::BLOCKED);
+	}
+
+	TileCoord first_chunk = chunks.begin()->first;
+	TileCoord last_chunk = first_chunk;
+	for (const auto& [chunk_coord, chunk] : chunks)
+	{
+		first_chunk = glm::min(first_chunk, chunk_coord);
+		last_chunk = glm::max(last_chunk, chunk_coord);
+	}
+
+	NavGrid grid(first_chunk * CHUNK_SIZE, (last_chunk - first_chunk + 1) * CHUNK_SIZE, NavGrid::BLOCKED);
+	for (const auto& [chunk_coord, chunk] : chunks)
 	{
-		for (int j = -10; j <= 10; ++j)
+		for (const auto& tile : chunk->tiles)
 		{
-			default_tileset.add_tile({i, j});
+			if (tile)
+			{
+				grid.set_cost(tile->coord, tile->get_movement_cost());
+			}
 		}
 	}
+
+	return grid;
+}
+
+TileSystem::TileSystem()
+{
+	auto& default_tileset = tilesets.emplace("", TileSet()).first->second;
+	// create a default tileset with 21x21 tiles
+	default_tileset.add_tiles({-10, -10}, {10, 10});
 }
 
 Tile* TileSystem::get_tile(const TileCoord& coord, const TileSet::TileSetID& tileset_id)
 {
-	auto it = tilesets.find(tileset_id);
-	if (it == tilesets.end())
-		return nullptr;
-	return it->second.get_tile(coord);
+	TileSet* tileset = get_tileset(tileset_id);
+	return tileset ? tileset->get_tile(coord) : nullptr;
 }
 
-std::vector<Tile*> TileSystem::get_tiles(const ObjectID& object_id, const TileSet::TileSetID& tileset_id)
+const std::vector<Tile*>& TileSystem::get_tiles(const ObjectID& object_id, const TileSet::TileSetID& tileset_id)
 {
-	auto it = tilesets.find(tileset_id);
-	if (it == tilesets.end())
-		return {};
-	return it->second.get_tiles(object_id);
+	static const std::vector<Tile*> no_tiles;
+	TileSet* tileset = get_tileset(tileset_id);
+	return tileset ? tileset->get_tiles(object_id) : no_tiles;
 }
 
 void TileSystem::remove_object(const ObjectID& object_id)
@@ -73,29 +196,32 @@ void TileSystem::remove_object(const ObjectID& object_id)
 	}
 }
 
-void TileSystem::add_to_tile(const TileCoord& coord, const ObjectID& object_id, const TileSet::TileSetID& tileset_id) 
+void TileSystem::add_to_tile(const TileCoord& coord, const ObjectID& object_id, const TileSet::TileSetID& tileset_id)
 {
 	auto it = tilesets.find(tileset_id);
 	if (it == tilesets.end())
 	{
-		tilesets.emplace(tileset_id, TileSet());
-		it = tilesets.find(tileset_id);
+		it = tilesets.emplace(tileset_id, TileSet()).first;
 	}
 
-	it->second.add_tile(coord);
-	it->second.get_tile(coord)->add_object(object_id);
-	it->second.get_tiles(object_id).push_back(it->second.get_tile(coord));
+	it->second.add_to_tile(coord, object_id);
 }
 
 void TileSystem::remove_from_tile(const TileCoord& coord,
                                   const ObjectID& object_id,
                                   const TileSet::TileSetID& tileset_id)
 {
-	auto it = tilesets.find(tileset_id);
-	if (it == tilesets.end())
+	TileSet* tileset = get_tileset(tileset_id);
+	if (!tileset)
 		return;
 
-	it->second.get_tile(coord)->remove_object(object_id);
+	tileset->remove_from_tile(coord, object_id);
+}
+
+TileSet* TileSystem::get_tileset(const TileSet::TileSetID& tileset_id)
+{
+	auto it = tilesets.find(tileset_id);
+	return it == tilesets.end() ? nullptr : &it->second;
 }
 
 Tile::TileObjectSpawner Tile::tile_object_spawner = [](const TileCoord& coord)
@@ -106,4 +232,4 @@ Tile::Tile(const TileCoord& coord) :
 	coord(coord)
 {
 	tile_object_spawner(coord);
-}
\ No newline at end of file
+}
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "identifications.hpp"
+#include "navigation/nav_grid.hpp"
 
 #include <glm/vec2.hpp>
 
 #include <vector>
+#include <array>
+#include <optional>
+#include <memory>
 #include <unordered_map>
 #include <functional>
+#include <algorithm>
 
 
 /*
@@ -21,7 +26,12 @@ namespace std
 	{
 		std::size_t operator()(const TileCoord& coord) const noexcept
 		{
-			return std::hash<int>()(coord.x) ^ std::hash<int>()(coord.y);
+			// xor-ing the axes maps (a, b) and (b, a) to the same bucket, mix the packed pair instead
+			uint64_t key = (uint64_t(uint32_t(coord.x)) << 32) | uint32_t(coord.y);
+			key ^= key >> 33;
+			key *= 0xff51afd7ed558ccdull;
+			key ^= key >> 33;
+			return std::size_t(key);
 		}
 	};
 }
@@ -37,43 +47,143 @@ public:
 
 	void add_object(ObjectID id) { objects.push_back(id); }
 	void remove_object(ObjectID id) { objects.erase(std::find(objects.begin(), objects.end(), id)); }
-	std::vector<ObjectID> get_objects() const { return objects; }
+	const std::vector<ObjectID>& get_objects() const { return objects; }
+
+	// NavGrid::BLOCKED is impassable
+	uint8_t get_movement_cost() const { return movement_cost; }
+	void set_movement_cost(uint8_t cost) { movement_cost = cost; }
 
 	using TileObjectSpawner = std::function<void(const TileCoord& coord)>;
 	static TileObjectSpawner tile_object_spawner;
 
 private:
 	std::vector<ObjectID> objects;
+	uint8_t movement_cost = NavGrid::DEFAULT_COST;
 };
 
 // This is useful in scenarios i.e. houses, different dimensions, different floors
+//	tiles live in 32x32 chunks that are allocated the first time one of their tiles is added,
+//	so a lookup is a chunk lookup plus an array index and neighbouring tiles are mostly next to each other in memory
 class TileSet
 {
 public:
 	using TileSetID = std::string;
 
+	static constexpr int CHUNK_SIZE = 32;
+
+	// adding a tile that already exists does nothing
 	void add_tile(const TileCoord& coord);
+	// inclusive rectangle of tiles
+	void add_tiles(const TileCoord& first, const TileCoord& last);
 	Tile* get_tile(const TileCoord& coord);
-	std::vector<Tile*> get_tiles(const ObjectID& object_id);
+	const Tile* get_tile(const TileCoord& coord) const;
+	size_t size() const { return num_tiles; }
+	// objects that are on at least one tile
+	size_t get_num_objects() const { return object_to_tiles.size(); }
+
+	void add_to_tile(const TileCoord& coord, const ObjectID& object_id);
+	void remove_from_tile(const TileCoord& coord, const ObjectID& object_id);
+	const std::vector<Tile*>& get_tiles(const ObjectID& object_id) const;
 	void remove_object(const ObjectID& object_id);
 
+	// the 4 edge neighbours that exist, in the order right, up, left, down
+	template<typename Func>
+	void for_each_neighbour(const TileCoord& coord, Func&& func);
+	// every tile, chunk by chunk
+	template<typename Func>
+	void for_each_tile(Func&& func);
+
+	static TileCoord get_chunk_coord(const TileCoord& coord);
+
+	// movement costs over the chunks in use, for the pathfinders, tiles that don't exist are blocked
+	NavGrid make_nav_grid() const;
+
 private:
-	std::unordered_map<TileCoord, Tile> tiles;
-	std::unordered_map<ObjectID, std::vector<Tile*>> object_to_tile;
+	struct Chunk
+	{
+		// row major, index = y * CHUNK_SIZE + x
+		std::array<std::optional<Tile>, CHUNK_SIZE * CHUNK_SIZE> tiles;
+	};
+
+	static int get_local_index(const TileCoord& coord);
+	Chunk* find_chunk(const TileCoord& chunk_coord) const;
+
+	// chunks are heap allocated so tile pointers stay valid when the map grows
+	std::unordered_map<TileCoord, std::unique_ptr<Chunk>> chunks;
+	size_t num_tiles = 0;
+
+	// most lookups land in the same chunk as the one before
+	mutable TileCoord last_chunk_coord = TileCoord(0);
+	mutable Chunk* last_chunk = nullptr;
+
+	// only objects that are on a tile have an entry, it is erased when they leave their last tile
+	std::unordered_map<ObjectID, std::vector<Tile*>> object_to_tiles;
 };
 
 class TileSystem
 {
 public:
 	TileSystem();
-	
+
 	Tile* get_tile(const TileCoord& coord, const TileSet::TileSetID& tileset_id = {});
-	std::vector<Tile*> get_tiles(const ObjectID& object_id, const TileSet::TileSetID& tileset_id = {});
+	const std::vector<Tile*>& get_tiles(const ObjectID& object_id, const TileSet::TileSetID& tileset_id = {});
 	void remove_object(const ObjectID& object_id);
 
 	void add_to_tile(const TileCoord& coord, const ObjectID& object_id, const TileSet::TileSetID& tileset_id = {});
 	void remove_from_tile(const TileCoord& coord, const ObjectID& object_id, const TileSet::TileSetID& tileset_id = {});
 
+	TileSet* get_tileset(const TileSet::TileSetID& tileset_id = {});
+
 private:
 	std::unordered_map<TileSet::TileSetID, TileSet> tilesets;
-};
\ No newline at end of file
+};
+
+template<typename Func>
+void TileSet::for_each_neighbour(const TileCoord& coord, Func&& func)
+{
+	static const std::array<TileCoord, 4> offsets = { TileCoord(1, 0), TileCoord(0, 1), TileCoord(-1, 0), TileCoord(0, -1) };
+
+	const TileCoord chunk_coord = get_chunk_coord(coord);
+	const TileCoord local = coord - chunk_coord * CHUNK_SIZE;
+	if (local.x > 0 && local.y > 0 && local.x < CHUNK_SIZE - 1 && local.y < CHUNK_SIZE - 1)
+	{
+		// all neighbours are in the same chunk, skip the chunk lookups
+		Chunk* chunk = find_chunk(chunk_coord);
+		if (!chunk)
+		{
+			return;
+		}
+		const int index = local.y * CHUNK_SIZE + local.x;
+		for (const int neighbour : { index + 1, index + CHUNK_SIZE, index - 1, index - CHUNK_SIZE })
+		{
+			if (auto& tile = chunk->tiles[neighbour])
+			{
+				func(*tile);
+			}
+		}
+		return;
+	}
+
+	for (const TileCoord& offset : offsets)
+	{
+		if (Tile* tile = get_tile(coord + offset))
+		{
+			func(*tile);
+		}
+	}
+}
+
+template<typename Func>
+void TileSet::for_each_tile(Func&& func)
+{
+	for (auto& [chunk_coord, chunk] : chunks)
+	{
+		for (auto& tile : chunk->tiles)
+		{
+			if (tile)
+			{
+				func(*tile);
+			}
+		}
+	}
+}
@@ -0,0 +1,153 @@
+#include <simulator/placement_ai.hpp>
+#include <simulator/replay.hpp>
+
+#include <fmt/core.h>
+#include <fmt/color.h>
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <string_view>
+
+
+//
+// soak test of the tetris rules, the placement AI plays game after game on the headless simulator
+//	tetris_soak --pieces n --seed n --record <file>   plays n pieces, records the first game and checks it replays the same
+//	tetris_soak --verify <file>                        replays a game recorded by the rendered game on the simulator
+//
+namespace
+{
+	struct Totals
+	{
+		uint64_t pieces = 0;
+		uint64_t rows = 0;
+		uint64_t games = 0;
+		int64_t best_score = 0;
+	};
+
+	int run_soak(uint64_t num_pieces, uint32_t seed, const std::string& record_path)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<int> piece_distribution(0, Tetris::NUM_PIECE_TYPES - 1);
+		std::uniform_int_distribution<int> spawn_distribution(Tetris::Game::MIN_SPAWN_X, Tetris::Game::MAX_SPAWN_X);
+		const Tetris::PlacementAI ai;
+		Tetris::Game game;
+		Tetris::Placement placement;
+		Tetris::Replay replay;
+		bool is_recording = !record_path.empty();
+		Totals totals;
+
+		const auto start = std::chrono::steady_clock::now();
+		while (totals.pieces < num_pieces)
+		{
+			const auto piece = Tetris::PieceType(piece_distribution(rng));
+			const int x = spawn_distribution(rng);
+			if (is_recording)
+			{
+				replay.record_spawn(piece, x);
+			}
+			totals.pieces++;
+			if (!game.spawn(piece, x) || !ai.choose(game, placement))
+			{
+				if (is_recording)
+				{
+					replay.record_end(game.get_score());
+					is_recording = false;
+				}
+				totals.rows += game.get_num_rows_cleared();
+				totals.games++;
+				totals.best_score = std::max(totals.best_score, game.get_score());
+				game.reset();
+				continue;
+			}
+
+			for (const Tetris::Action action : placement.actions)
+			{
+				if (action == Tetris::Action::HARD_DROP && (game.get_piece().rotation != placement.rotation || game.get_piece().x != placement.x))
+				{
+					// the AI only picks placements it thinks the inputs reach, the simulator disagreeing is a bug in one of them
+					fmt::print(fg(fmt::color::red), "piece {} ended up at rotation {} x {} instead of rotation {} x {}\n{}",
+						totals.pieces, game.get_piece().rotation, game.get_piece().x, placement.rotation, placement.x, game.get_board().to_string());
+					return EXIT_FAILURE;
+				}
+				if (is_recording)
+				{
+					replay.record_action(action);
+				}
+				game.apply(action);
+			}
+			if (is_recording)
+			{
+				replay.record_lock(game.get_board().get_hash());
+			}
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		totals.rows += game.get_num_rows_cleared();
+		totals.best_score = std::max(totals.best_score, game.get_score());
+
+		fmt::print("{} pieces in {:.3f}s, {:.2f} million pieces per minute\n", totals.pieces, seconds, double(totals.pieces) / seconds * 60e-6);
+		fmt::print("{} rows cleared, {} games over, best score {}\n", totals.rows, totals.games, totals.best_score);
+
+		if (!record_path.empty())
+		{
+			// a game still going at the end is saved without its end
+			replay.save(record_path);
+			if (const auto mismatch = Tetris::Replay::load(record_path).verify())
+			{
+				fmt::print(fg(fmt::color::red), "the recorded game doesn't replay the same, {}\n", *mismatch);
+				return EXIT_FAILURE;
+			}
+			fmt::print("recorded {} events to {}\n", replay.get_events().size(), record_path);
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	int run_verify(const std::string& path)
+	{
+		const Tetris::Replay replay = Tetris::Replay::load(path);
+		if (const auto mismatch = replay.verify())
+		{
+			fmt::print(fg(fmt::color::red), "{} differs from the simulator, {}\n", path, *mismatch);
+			return EXIT_FAILURE;
+		}
+
+		fmt::print(fg(fmt::color::green), "{} events of {} match the simulator\n", replay.get_events().size(), path);
+		return EXIT_SUCCESS;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	try {
+		uint64_t num_pieces = 1'000'000;
+		uint32_t seed = 1;
+		std::string record_path;
+		std::string verify_path;
+		for (int i = 1; i + 1 < argc; i += 2)
+		{
+			const std::string_view flag = argv[i];
+			if (flag == "--pieces")
+			{
+				num_pieces = std::stoull(argv[i + 1]);
+			} else if (flag == "--seed")
+			{
+				seed = uint32_t(std::stoul(argv[i + 1]));
+			} else if (flag == "--record")
+			{
+				record_path = argv[i + 1];
+			} else if (flag == "--verify")
+			{
+				verify_path = argv[i + 1];
+			} else
+			{
+				throw std::runtime_error(fmt::format("unknown flag {}", flag));
+			}
+		}
+
+		return verify_path.empty() ? run_soak(num_pieces, seed, record_path) : run_verify(verify_path);
+	} catch (const std::exception& e) {
+		fmt::print(fg(fmt::color::red), "Exception Thrown!: {}\n", e.what());
+		return EXIT_FAILURE;
+	}
+}
@@ -6,6 +6,7 @@
 #include <camera.hpp>
 #include <config.hpp>
 #include <shapes/shape_factory.hpp>
+#include "simulator/replay.hpp"
 
 #include <fmt/core.h>
 #include <fmt/color.h>
@@ -175,6 +176,7 @@ public:
 	}
 
 	glm::vec3 get_type_specific_offset() const { return type_specific_offset; }
+	TetrisPieceType get_type() const { return type; }
 
 	std::vector<glm::ivec2> get_cell_locations() const 
 	{
@@ -273,6 +275,7 @@ public:
 		{
 			elapsed_sec = 0;
 
+			replay.record_action(Tetris::Action::DOWN);
 			const glm::mat4 new_transform = glm::translate(glm::mat4(1.0f), -Maths::up_vec) * 
 				get_latest_piece().get_transform();
 			try_transform_piece(new_transform);
@@ -322,6 +325,7 @@ public:
 			switch (key)
 			{
 				case GLFW_KEY_LEFT:
+					replay.record_action(Tetris::Action::LEFT);
 					transform = glm::translate(glm::mat4(1.0f), glm::vec3(-1.0f, 0.0f, 0.0f)) * curr_transform;
 					if (!check_for_collision(transform))
 					{
@@ -329,6 +333,7 @@ public:
 					}
 					break;
 				case GLFW_KEY_RIGHT:
+					replay.record_action(Tetris::Action::RIGHT);
 					transform = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.0f, 0.0f)) * curr_transform;
 					if (!check_for_collision(transform))
 					{
@@ -336,6 +341,7 @@ public:
 					}
 					break;
 				case GLFW_KEY_UP:
+					replay.record_action(Tetris::Action::ROTATE);
 					transform = curr_transform * glm::rotate(glm::mat4(1.0f), -Maths::PI/2.0f, Maths::forward_vec);
 					if (!check_for_collision(transform))
 					{
@@ -343,10 +349,12 @@ public:
 					}
 					break;
 				case GLFW_KEY_DOWN:
+					replay.record_action(Tetris::Action::DOWN);
 					transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f)) * curr_transform;
 					try_transform_piece(transform);
 					break;
 				case GLFW_KEY_SPACE:
+					replay.record_action(Tetris::Action::HARD_DROP);
 					while (try_transform_piece(glm::translate(glm::mat4(1.0f), -Maths::up_vec) * get_latest_piece().get_transform()));
 					break;
 				case GLFW_KEY_Z:
@@ -397,6 +405,7 @@ private:
 
 		current_piece = next_piece;
 		const glm::vec3 position = glm::vec3(Maths::RandomUniform(-width/2+2, width/2-3), height/2.0f, 0.0f);
+		replay.record_spawn(Tetris::PieceType(current_piece->get_type()), int(position.x) + width/2);
 		current_piece->set_position(position + current_piece->get_type_specific_offset());
 		current_piece->set_visibility(true);
 		current_piece->set_scale(glm::vec3(1.0f)); // reset scale to normal size
@@ -453,6 +462,7 @@ private:
 		filled_spots.clear();
 		engine.delete_object(get_latest_piece().get_id());
 		current_piece = nullptr;
+		replay.clear();
 
 		// prepare for next game
 		generate_next_piece();
@@ -520,6 +530,14 @@ private:
 			gui->score += rows_cleared * rows_cleared * 100;
 		}
 
+		// the board as the simulator sees it, so a replay can tell where the two went apart
+		Tetris::Board board;
+		for (glm::ivec2 cell : filled_spots)
+		{
+			board.set_cell(cell.x + width/2, cell.y + height/2 - 1);
+		}
+		replay.record_lock(board.get_hash());
+
 		// generate new piece
 		generate_next_piece();
 	}
@@ -551,6 +569,14 @@ private:
 		gui->game_over = true;
 		// can simulate game over with a paused game that can only be resumed on new game
 		gui->paused = true;
+
+		// tetris_soak --verify plays it back on the simulator
+		replay.record_end(gui->score);
+		try {
+			replay.save(Utility::get_binary_path() / "tetris_replay.txt");
+		} catch (const std::exception& e) {
+			fmt::print(fg(fmt::color::red), "{}\n", e.what());
+		}
 	}
 
 private:
@@ -564,6 +590,7 @@ private:
 
 	std::array<std::vector<Object*>, height+2> entrenched_cells;
 	std::unordered_set<glm::ivec2> filled_spots;
+	Tetris::Replay replay;
 	std::unique_ptr<AudioSource> main_theme;
 	std::unique_ptr<AudioSource> clear_line_fx;
 };
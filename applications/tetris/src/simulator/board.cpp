@@ -0,0 +1,183 @@
+#include "board.hpp"
+
+#include <algorithm>
+#include <bit>
+
+
+using namespace Tetris;
+
+namespace
+{
+	struct ShapeTable
+	{
+		ShapeTable()
+		{
+			// the rendered game's cell locations and the offset of pieces that rotate about a point between cells,
+			// both doubled so the half cells are integers
+			struct Definition
+			{
+				std::array<Cell, 4> cells;
+				Cell offset;
+			};
+			const std::array<Definition, NUM_PIECE_TYPES> definitions = { {
+				{ { { { -3, 1 }, { -1, 1 }, { 1, 1 }, { 3, 1 } } }, { 1, 1 } },
+				{ { { { -2, 2 }, { -2, 0 }, { 0, 0 }, { 2, 0 } } }, { 0, 0 } },
+				{ { { { -2, 0 }, { 0, 0 }, { 2, 0 }, { 2, 2 } } }, { 0, 0 } },
+				{ { { { -1, 1 }, { 1, 1 }, { -1, -1 }, { 1, -1 } } }, { 1, 1 } },
+				{ { { { -2, 0 }, { 0, 0 }, { 0, 2 }, { 2, 2 } } }, { 0, 0 } },
+				{ { { { -2, 0 }, { 0, 0 }, { 2, 0 }, { 0, 2 } } }, { 0, 0 } },
+				{ { { { -2, 2 }, { 0, 2 }, { 0, 0 }, { 2, 0 } } }, { 0, 0 } },
+			} };
+
+			for (int type = 0; type < NUM_PIECE_TYPES; type++)
+			{
+				std::array<Cell, 4> cells = definitions[type].cells;
+				for (int rotation = 0; rotation < NUM_ROTATIONS; rotation++)
+				{
+					Shape& shape = shapes[type][rotation];
+					for (int i = 0; i < 4; i++)
+					{
+						shape.cells[i] = { (definitions[type].offset.x + cells[i].x) / 2, (definitions[type].offset.y + cells[i].y) / 2 };
+						// clockwise for the next rotation
+						cells[i] = { cells[i].y, -cells[i].x };
+					}
+					shape.min_x = shape.max_x = shape.cells[0].x;
+					shape.min_y = shape.max_y = shape.cells[0].y;
+					for (const Cell& cell : shape.cells)
+					{
+						shape.min_x = std::min(shape.min_x, cell.x);
+						shape.max_x = std::max(shape.max_x, cell.x);
+						shape.min_y = std::min(shape.min_y, cell.y);
+						shape.max_y = std::max(shape.max_y, cell.y);
+					}
+					shape.rows = {};
+					for (const Cell& cell : shape.cells)
+					{
+						shape.rows[cell.y - shape.min_y] |= Row(1 << (cell.x - shape.min_x));
+					}
+					std::sort(shape.cells.begin(), shape.cells.end(), [](const Cell& a, const Cell& b) { return a.y < b.y || (a.y == b.y && a.x < b.x); });
+
+					const bool is_repeat = std::any_of(shapes[type].begin(), shapes[type].begin() + rotation, [&shape](const Shape& other)
+					{
+						return std::equal(shape.cells.begin(), shape.cells.end(), other.cells.begin(), [](const Cell& a, const Cell& b) { return a.x == b.x && a.y == b.y; });
+					});
+					num_distinct_rotations[type] += !is_repeat;
+				}
+			}
+		}
+
+		std::array<std::array<Shape, NUM_ROTATIONS>, NUM_PIECE_TYPES> shapes;
+		std::array<int, NUM_PIECE_TYPES> num_distinct_rotations = {};
+	};
+
+	const ShapeTable shape_table;
+}
+
+const Shape& Tetris::get_shape(PieceType type, int rotation)
+{
+	return shape_table.shapes[int(type)][rotation & (NUM_ROTATIONS - 1)];
+}
+
+int Tetris::get_num_distinct_rotations(PieceType type)
+{
+	return shape_table.num_distinct_rotations[int(type)];
+}
+
+char Tetris::to_char(PieceType type)
+{
+	return "IJLOSTZ"[int(type)];
+}
+
+bool Board::collides(const Shape& shape, int x, int y) const
+{
+	if (x + shape.min_x < 0 || x + shape.max_x >= WIDTH || y + shape.min_y < 0)
+	{
+		return true;
+	}
+
+	const int first_row = y + shape.min_y;
+	const int last_row = std::min(y + shape.max_y, ROWS - 1);
+	for (int row = first_row; row <= last_row; row++)
+	{
+		if (rows[row] & (shape.rows[row - first_row] << (x + shape.min_x)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int Board::get_drop_row(const Shape& shape, int x, int y) const
+{
+	while (!collides(shape, x, y - 1))
+	{
+		y--;
+	}
+
+	return y;
+}
+
+int Board::lock(const Shape& shape, int x, int y)
+{
+	const int first_row = y + shape.min_y;
+	const int last_row = std::min(y + shape.max_y, ROWS - 1);
+	for (int row = first_row; row <= last_row; row++)
+	{
+		rows[row] |= Row(shape.rows[row - first_row] << (x + shape.min_x));
+	}
+
+	// only the rows the piece went into can have filled up
+	int num_cleared = 0;
+	for (int row = first_row; row <= last_row - num_cleared;)
+	{
+		if (rows[row] == FULL_ROW)
+		{
+			std::copy(rows.begin() + row + 1, rows.end(), rows.begin() + row);
+			rows.back() = 0;
+			num_cleared++;
+		} else
+		{
+			row++;
+		}
+	}
+
+	return num_cleared;
+}
+
+int Board::get_height() const
+{
+	int height = ROWS;
+	while (height > 0 && rows[height - 1] == 0)
+	{
+		height--;
+	}
+
+	return height;
+}
+
+uint64_t Board::get_hash() const
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (const Row row : rows)
+	{
+		hash = (hash ^ row) * 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+std::string Board::to_string() const
+{
+	std::string result;
+	for (int y = std::max(get_height(), 1) - 1; y >= 0; y--)
+	{
+		for (int x = 0; x < WIDTH; x++)
+		{
+			result += get_cell(x, y) ? '#' : '.';
+		}
+		result += '\n';
+	}
+
+	return result;
+}
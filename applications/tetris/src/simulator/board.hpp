@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+
+//
+// the tetris rules without any rendering, a row is a 10 bit mask so collision is a few ands per piece
+//	and a full row is a single compare, fast enough to play millions of pieces a minute headless
+//
+//	board coordinates are columns 0-9 from the left and rows from 0 at the bottom,
+//	the rendered game's cell (x, y) is column x + WIDTH / 2, row y + HEIGHT / 2 - 1
+//
+namespace Tetris
+{
+	constexpr int WIDTH = 10;
+	constexpr int HEIGHT = 20;
+	// pieces spawn at the top row and stick out above it, these rows hold what locks up there
+	constexpr int ROWS = HEIGHT + 4;
+	constexpr int SPAWN_ROW = HEIGHT - 1;
+	constexpr uint16_t FULL_ROW = (1 << WIDTH) - 1;
+
+	using Row = uint16_t;
+
+	// same order as the rendered game's TetrisPieceType
+	enum class PieceType : uint8_t
+	{
+		I,
+		J,
+		L,
+		O,
+		S,
+		T,
+		Z,
+	};
+	constexpr int NUM_PIECE_TYPES = 7;
+	constexpr int NUM_ROTATIONS = 4;
+
+	struct Cell
+	{
+		int x;
+		int y;
+	};
+
+	// a piece in one rotation, relative to its origin, rotations are clockwise about the same point as in the rendered game
+	struct Shape
+	{
+		std::array<Cell, 4> cells;
+		int min_x;
+		int max_x;
+		int min_y;
+		int max_y;
+		// rows[i] is row min_y + i with bit 0 at min_x
+		std::array<Row, 4> rows;
+	};
+
+	const Shape& get_shape(PieceType type, int rotation);
+	// rotations that give a different set of cells, the O piece only has one
+	int get_num_distinct_rotations(PieceType type);
+	char to_char(PieceType type);
+
+	class Board
+	{
+	public:
+		bool collides(const Shape& shape, int x, int y) const;
+		// the row the piece lands on when dropped straight down from y
+		int get_drop_row(const Shape& shape, int x, int y) const;
+		// adds the piece and clears full rows, returns how many were cleared
+		int lock(const Shape& shape, int x, int y);
+
+		Row get_row(int y) const { return rows[y]; }
+		bool get_cell(int x, int y) const { return (rows[y] >> x) & 1; }
+		void set_cell(int x, int y) { rows[y] |= Row(1 << x); }
+		// one past the highest row with a cell in it
+		int get_height() const;
+		void clear() { rows = {}; }
+
+		// FNV-1a over the rows, replays compare boards by it
+		uint64_t get_hash() const;
+		// top row first, # for filled cells
+		std::string to_string() const;
+
+		bool operator==(const Board& other) const { return rows == other.rows; }
+
+	private:
+		std::array<Row, ROWS> rows = {};
+	};
+}
@@ -0,0 +1,89 @@
+#include "game.hpp"
+
+#include <stdexcept>
+
+
+using namespace Tetris;
+
+char Tetris::to_char(Action action)
+{
+	return "LRUDH"[int(action)];
+}
+
+bool Game::spawn(PieceType type, int x)
+{
+	if (is_piece_active || game_over)
+	{
+		throw std::runtime_error("Game::spawn: the last piece hasn't locked or the game is over");
+	}
+
+	piece = { type, 0, x, SPAWN_ROW };
+	num_pieces++;
+	if (board.collides(piece.get_shape(), piece.x, piece.y))
+	{
+		game_over = true;
+		return false;
+	}
+
+	is_piece_active = true;
+	return true;
+}
+
+bool Game::apply(Action action)
+{
+	if (!is_piece_active)
+	{
+		throw std::runtime_error("Game::apply: there is no piece to move");
+	}
+
+	switch (action)
+	{
+	case Action::LEFT:
+		try_move(piece.rotation, piece.x - 1, piece.y);
+		return false;
+	case Action::RIGHT:
+		try_move(piece.rotation, piece.x + 1, piece.y);
+		return false;
+	case Action::ROTATE:
+		try_move((piece.rotation + 1) % NUM_ROTATIONS, piece.x, piece.y);
+		return false;
+	case Action::DOWN:
+		if (try_move(piece.rotation, piece.x, piece.y - 1))
+		{
+			return false;
+		}
+		break;
+	case Action::HARD_DROP:
+		piece.y = board.get_drop_row(piece.get_shape(), piece.x, piece.y);
+		break;
+	}
+
+	lock();
+	return true;
+}
+
+void Game::reset()
+{
+	*this = Game();
+}
+
+bool Game::try_move(int rotation, int x, int y)
+{
+	if (board.collides(get_shape(piece.type, rotation), x, y))
+	{
+		return false;
+	}
+
+	piece.rotation = rotation;
+	piece.x = x;
+	piece.y = y;
+	return true;
+}
+
+void Game::lock()
+{
+	const int num_cleared = board.lock(piece.get_shape(), piece.x, piece.y);
+	score += num_cleared * num_cleared * 100;
+	num_rows_cleared += num_cleared;
+	is_piece_active = false;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "board.hpp"
+
+
+namespace Tetris
+{
+	// the inputs of the rendered game, DOWN is also what the gravity tick does
+	enum class Action : uint8_t
+	{
+		LEFT,
+		RIGHT,
+		ROTATE,
+		DOWN,
+		HARD_DROP,
+	};
+	char to_char(Action action);
+
+	struct Piece
+	{
+		PieceType type;
+		int rotation;
+		int x;
+		int y;
+
+		const Shape& get_shape() const { return Tetris::get_shape(type, rotation); }
+	};
+
+	// the falling piece on a board, with the same rules as the rendered game:
+	//	blocked moves and rotations are ignored, a blocked DOWN locks the piece,
+	//	a cleared row scores 100, 400 for two, 900 for three and so on, and the game is over when a new piece spawns blocked
+	class Game
+	{
+	public:
+		// in the rendered game the piece origin starts between columns 2 and 7
+		static constexpr int MIN_SPAWN_X = 2;
+		static constexpr int MAX_SPAWN_X = WIDTH - 3;
+
+		// returns false and ends the game if the piece is blocked
+		bool spawn(PieceType type, int x);
+		// returns true when the action locked the piece, a new one has to be spawned then
+		bool apply(Action action);
+		void reset();
+
+		const Board& get_board() const { return board; }
+		const Piece& get_piece() const { return piece; }
+		bool has_piece() const { return is_piece_active; }
+		bool is_game_over() const { return game_over; }
+		int64_t get_score() const { return score; }
+		uint64_t get_num_pieces() const { return num_pieces; }
+		uint64_t get_num_rows_cleared() const { return num_rows_cleared; }
+
+	private:
+		bool try_move(int rotation, int x, int y);
+		void lock();
+
+		Board board;
+		Piece piece = {};
+		bool is_piece_active = false;
+		bool game_over = false;
+		int64_t score = 0;
+		uint64_t num_pieces = 0;
+		uint64_t num_rows_cleared = 0;
+	};
+}
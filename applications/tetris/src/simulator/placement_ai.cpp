@@ -0,0 +1,134 @@
+#include "placement_ai.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+
+using namespace Tetris;
+
+bool PlacementAI::choose(const Game& game, Placement& placement) const
+{
+	if (!game.has_piece())
+	{
+		throw std::runtime_error("PlacementAI::choose: the game has no piece to place");
+	}
+
+	const Board& board = game.get_board();
+	const Piece& spawned = game.get_piece();
+	double best_score = -std::numeric_limits<double>::infinity();
+	for (int rotation = 0; rotation < get_num_distinct_rotations(spawned.type); rotation++)
+	{
+		const Shape& shape = get_shape(spawned.type, rotation);
+		// the game ignores a blocked rotation, a placement that needs one isn't reachable this way
+		bool is_blocked = false;
+		for (int turn = 1; turn <= rotation && !is_blocked; turn++)
+		{
+			is_blocked = board.collides(get_shape(spawned.type, turn), spawned.x, spawned.y);
+		}
+		if (is_blocked)
+		{
+			continue;
+		}
+
+		// slide outwards from the spawn column in both directions until something is in the way
+		for (const int direction : { -1, 1 })
+		{
+			for (int x = direction < 0 ? spawned.x : spawned.x + 1; ; x += direction)
+			{
+				if (board.collides(shape, x, spawned.y))
+				{
+					break;
+				}
+
+				const int y = board.get_drop_row(shape, x, spawned.y);
+				Board result = board;
+				const int num_cleared = result.lock(shape, x, y);
+				int eroded_cells = 0;
+				if (num_cleared > 0)
+				{
+					// the piece's cells in the cleared rows, the rows are full so only the piece rows that vanished count
+					for (int i = 0; i <= shape.max_y - shape.min_y; i++)
+					{
+						if ((board.get_row(y + shape.min_y + i) | Row(shape.rows[i] << (x + shape.min_x))) == FULL_ROW)
+						{
+							eroded_cells += std::popcount(shape.rows[i]);
+						}
+					}
+				}
+
+				const double landing_height = y + (shape.min_y + shape.max_y) * 0.5;
+				const double score = evaluate(result, landing_height, num_cleared * eroded_cells);
+				if (score > best_score)
+				{
+					best_score = score;
+					placement.rotation = rotation;
+					placement.x = x;
+					placement.score = score;
+				}
+			}
+		}
+	}
+
+	if (best_score == -std::numeric_limits<double>::infinity())
+	{
+		return false;
+	}
+
+	placement.actions.assign(placement.rotation, Action::ROTATE);
+	const Action slide = placement.x < spawned.x ? Action::LEFT : Action::RIGHT;
+	placement.actions.insert(placement.actions.end(), std::abs(placement.x - spawned.x), slide);
+	placement.actions.push_back(Action::HARD_DROP);
+	return true;
+}
+
+double PlacementAI::evaluate(const Board& board, double landing_height, int eroded_cells) const
+{
+	const int height = board.get_height();
+	int row_transitions = 0;
+	int column_transitions = 0;
+	int holes = 0;
+	int wells = 0;
+
+	// the walls and the floor count as filled
+	Row below = FULL_ROW;
+	for (int y = 0; y < height; y++)
+	{
+		const Row row = board.get_row(y);
+		const uint32_t walled = (uint32_t(row) << 1) | 1u | (1u << (WIDTH + 1));
+		row_transitions += std::popcount((walled ^ (walled >> 1)) & ((1u << (WIDTH + 1)) - 1));
+		column_transitions += std::popcount(Row(row ^ below));
+		below = row;
+	}
+	// the empty row above the stack
+	column_transitions += std::popcount(below);
+
+	// top down, a cell is a hole when anything is above it, and a well cell when it's empty between filled neighbours,
+	// each well cell counts for its depth in the well so deep wells cost more than several shallow ones
+	Row covered = 0;
+	std::array<int, WIDTH> well_depths = {};
+	for (int y = height - 1; y >= 0; y--)
+	{
+		const Row row = board.get_row(y);
+		holes += std::popcount(Row(~row & covered & FULL_ROW));
+		covered |= row;
+
+		const Row left_filled = Row((row << 1) | 1);
+		const Row right_filled = Row((row >> 1) | (1 << (WIDTH - 1)));
+		const Row well_cells = Row(~row & left_filled & right_filled & FULL_ROW);
+		for (int x = 0; x < WIDTH; x++)
+		{
+			well_depths[x] = (well_cells >> x) & 1 ? well_depths[x] + 1 : 0;
+			wells += well_depths[x];
+		}
+	}
+
+	return weights.landing_height * landing_height +
+		weights.eroded_cells * eroded_cells +
+		weights.row_transitions * row_transitions +
+		weights.column_transitions * column_transitions +
+		weights.holes * holes +
+		weights.wells * wells;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "game.hpp"
+
+#include <vector>
+
+
+namespace Tetris
+{
+	struct Placement
+	{
+		int rotation = 0;
+		int x = 0;
+		double score = 0.0;
+		// what to press from the spawn position, rotations first, then sideways moves and a hard drop
+		std::vector<Action> actions;
+	};
+
+	//
+	// one piece lookahead placement by a weighted sum of board features [Dellacherie, weights from El-Tetris]
+	//	every rotation and column the piece can reach from where it spawned by rotating, sliding and dropping is tried,
+	//	so the chosen placement can be played as inputs in the rendered game
+	//
+	class PlacementAI
+	{
+	public:
+		struct Weights
+		{
+			double landing_height = -4.500158825082766;
+			// cleared rows times the cells of the piece in them
+			double eroded_cells = 3.4181268101392694;
+			double row_transitions = -3.2178882868487753;
+			double column_transitions = -9.348695305445199;
+			double holes = -7.899265427351652;
+			double wells = -3.3855972247263626;
+		};
+
+		PlacementAI() = default;
+		explicit PlacementAI(const Weights& weights) : weights(weights) {}
+
+		// the game must have a piece that hasn't moved since it spawned, false if it can't be placed anywhere
+		bool choose(const Game& game, Placement& placement) const;
+
+		// the features summed with the weights, for a board after the piece locked
+		double evaluate(const Board& board, double landing_height, int eroded_cells) const;
+
+	private:
+		Weights weights;
+	};
+}
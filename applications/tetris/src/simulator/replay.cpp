@@ -0,0 +1,168 @@
+#include "replay.hpp"
+
+#include <fmt/core.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+
+using namespace Tetris;
+
+namespace
+{
+	constexpr std::string_view piece_chars = "IJLOSTZ";
+	constexpr std::string_view action_chars = "LRUDH";
+}
+
+void Replay::save(const std::filesystem::path& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		throw std::runtime_error(fmt::format("Replay::save: can't open {}", path.string()));
+	}
+
+	for (const Event& event : events)
+	{
+		switch (event.type)
+		{
+		case EventType::SPAWN:
+			file << fmt::format("S {} {}\n", to_char(event.piece), event.x);
+			break;
+		case EventType::ACTION:
+			file << fmt::format("A {}\n", to_char(event.action));
+			break;
+		case EventType::LOCK:
+			file << fmt::format("K {:016x}\n", event.value);
+			break;
+		case EventType::END:
+			file << fmt::format("E {}\n", int64_t(event.value));
+			break;
+		}
+	}
+}
+
+Replay Replay::load(const std::filesystem::path& path)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		throw std::runtime_error(fmt::format("Replay::load: can't open {}", path.string()));
+	}
+
+	Replay replay;
+	std::string line;
+	for (size_t line_number = 1; std::getline(file, line); line_number++)
+	{
+		if (line.empty())
+		{
+			continue;
+		}
+
+		std::istringstream stream(line);
+		char type = 0;
+		std::string value;
+		stream >> type >> value;
+		const auto fail = [&]()
+		{
+			return std::runtime_error(fmt::format("Replay::load: can't read line {} of {}: {}", line_number, path.string(), line));
+		};
+		if (value.empty())
+		{
+			throw fail();
+		}
+
+		switch (type)
+		{
+		case 'S':
+		{
+			const size_t piece = piece_chars.find(value[0]);
+			int x = 0;
+			if (value.size() != 1 || piece == std::string_view::npos || !(stream >> x))
+			{
+				throw fail();
+			}
+			replay.record_spawn(PieceType(piece), x);
+			break;
+		}
+		case 'A':
+		{
+			const size_t action = action_chars.find(value[0]);
+			if (value.size() != 1 || action == std::string_view::npos)
+			{
+				throw fail();
+			}
+			replay.record_action(Action(action));
+			break;
+		}
+		case 'K':
+			replay.record_lock(std::stoull(value, nullptr, 16));
+			break;
+		case 'E':
+			replay.record_end(std::stoll(value));
+			break;
+		default:
+			throw fail();
+		}
+	}
+
+	return replay;
+}
+
+std::optional<std::string> Replay::verify() const
+{
+	Game game;
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		const Event& event = events[i];
+		switch (event.type)
+		{
+		case EventType::SPAWN:
+			if (game.has_piece())
+			{
+				return fmt::format("event {}: a piece spawned while the simulator's piece is still falling", i);
+			}
+			if (game.is_game_over())
+			{
+				return fmt::format("event {}: a piece spawned after the simulator's game ended", i);
+			}
+			if (event.x < Game::MIN_SPAWN_X || event.x > Game::MAX_SPAWN_X)
+			{
+				return fmt::format("event {}: spawn column {} is outside the spawn range", i, event.x);
+			}
+			game.spawn(event.piece, event.x);
+			break;
+		case EventType::ACTION:
+			if (!game.has_piece())
+			{
+				return fmt::format("event {}: an input with no piece falling, the simulator locked it earlier or the game is over", i);
+			}
+			game.apply(event.action);
+			break;
+		case EventType::LOCK:
+			if (game.has_piece())
+			{
+				return fmt::format("event {}: the piece locked at ({}, {}) but it can still fall in the simulator", i, game.get_piece().x, game.get_piece().y);
+			}
+			if (event.value != game.get_board().get_hash())
+			{
+				return fmt::format("event {}: the boards differ after the lock, the simulator's is\n{}", i, game.get_board().to_string());
+			}
+			break;
+		case EventType::END:
+			if (!game.is_game_over())
+			{
+				return fmt::format("event {}: the game ended but the simulator's is still going", i);
+			}
+			if (int64_t(event.value) != game.get_score())
+			{
+				return fmt::format("event {}: the score is {} but the simulator's is {}", i, int64_t(event.value), game.get_score());
+			}
+			break;
+		}
+	}
+
+	return std::nullopt;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "game.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+namespace Tetris
+{
+	//
+	// a recorded game, enough to play it again on the simulator and compare every board it went through,
+	// the rendered game records one so its logic can be checked against the simulator's
+	//	saved as one event per line
+	//	S <piece> <x>   a piece spawned, the piece as a letter and x as a board column
+	//	A <action>      an input or a gravity tick, one of LRUDH
+	//	K <hash>        the piece locked, the board hash in hex once full rows were cleared
+	//	E <score>       the game is over
+	//
+	class Replay
+	{
+	public:
+		enum class EventType : uint8_t
+		{
+			SPAWN,
+			ACTION,
+			LOCK,
+			END,
+		};
+
+		struct Event
+		{
+			EventType type;
+			PieceType piece = PieceType::I;
+			Action action = Action::DOWN;
+			int x = 0;
+			// board hash or score
+			uint64_t value = 0;
+		};
+
+		void record_spawn(PieceType piece, int x) { events.push_back({ EventType::SPAWN, piece, Action::DOWN, x }); }
+		void record_action(Action action) { events.push_back({ EventType::ACTION, PieceType::I, action }); }
+		void record_lock(uint64_t board_hash) { events.push_back({ EventType::LOCK, PieceType::I, Action::DOWN, 0, board_hash }); }
+		void record_end(int64_t score) { events.push_back({ EventType::END, PieceType::I, Action::DOWN, 0, uint64_t(score) }); }
+		void clear() { events.clear(); }
+		const std::vector<Event>& get_events() const { return events; }
+
+		void save(const std::filesystem::path& path) const;
+		static Replay load(const std::filesystem::path& path);
+
+		// plays the events on a new game, what went differently at the first event the simulator disagrees with
+		std::optional<std::string> verify() const;
+
+	private:
+		std::vector<Event> events;
+	};
+}
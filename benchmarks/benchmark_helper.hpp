@@ -0,0 +1,41 @@
+#pragma once
+
+#include <game_engine.hpp>
+#include <iapplication.hpp>
+
+#include "mock_graphics_engine.hpp"
+#include "mock_window.hpp"
+
+
+// GameEngine wired up with the mock graphics engine and window so it can be driven without a GPU
+struct HeadlessEngine
+{
+	HeadlessEngine() :
+		engine(window, [](GameEngine& engine) { return std::make_unique<MockGraphicsEngine>(); })
+	{
+		engine.set_application(&application);
+	}
+
+	~HeadlessEngine()
+	{
+		// the ECS is a global singleton, unhook everything so later engines don't see dangling objects
+		for (const auto& [id, object] : engine.get_objects())
+		{
+			engine.get_ecs().remove_object(id);
+		}
+	}
+
+	// deletions are acknowledged immediately by the mock graphics engine, a tick flushes them
+	void delete_objects(const std::vector<ObjectID>& ids)
+	{
+		for (const auto id : ids)
+		{
+			engine.delete_object(id);
+		}
+		engine.main_loop(0.0f);
+	}
+
+	MockWindow window;
+	DummyApplication application;
+	GameEngine engine;
+};
@@ -0,0 +1,176 @@
+#include "benchmark_helper.hpp"
+
+#include <collision/sweep_and_prune.hpp>
+#include <collision/narrowphase.hpp>
+#include <renderable/mesh_factory.hpp>
+#include <renderable/renderable.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <cmath>
+
+
+namespace
+{
+	struct MovingBounds
+	{
+		SweepAndPrune::ProxyID proxy;
+		AABB bounds;
+		glm::vec3 velocity;
+	};
+
+	// side length of a world with roughly one unit box per 8 cubic units, so the number of overlaps grows linearly
+	float get_world_size(int64_t count)
+	{
+		return 2.0f * std::cbrt(float(count));
+	}
+
+	std::vector<MovingBounds> spawn_moving_bounds(SweepAndPrune& broadphase, int64_t count, std::mt19937& rng)
+	{
+		const float world_size = get_world_size(count);
+		std::uniform_real_distribution<float> position(0.0f, world_size - 1.0f);
+		std::uniform_real_distribution<float> velocity(-0.05f, 0.05f);
+		std::vector<MovingBounds> bodies;
+		bodies.reserve(count);
+		for (int64_t i = 0; i < count; i++)
+		{
+			const glm::vec3 min(position(rng), position(rng), position(rng));
+			const AABB bounds(min, min + glm::vec3(1.0f));
+			bodies.push_back(MovingBounds{ broadphase.add(ObjectID(i), bounds), bounds, glm::vec3(velocity(rng), velocity(rng), velocity(rng)) });
+		}
+
+		return bodies;
+	}
+}
+
+static void BM_SweepAndPruneMoving(benchmark::State& state)
+{
+	std::mt19937 rng(0);
+	SweepAndPrune broadphase;
+	auto bodies = spawn_moving_bounds(broadphase, state.range(0), rng);
+	const float world_size = get_world_size(state.range(0));
+	broadphase.update();
+
+	size_t num_pairs = 0;
+	for (auto _ : state)
+	{
+		for (auto& body : bodies)
+		{
+			// bounce off the world's walls so the density stays constant
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if (body.bounds.min_bound[axis] + body.velocity[axis] < 0.0f || body.bounds.max_bound[axis] + body.velocity[axis] > world_size)
+				{
+					body.velocity[axis] = -body.velocity[axis];
+				}
+			}
+			body.bounds += body.velocity;
+			broadphase.set_bounds(body.proxy, body.bounds);
+		}
+		num_pairs = broadphase.update().size();
+	}
+
+	state.counters["pairs"] = static_cast<double>(num_pairs);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SweepAndPruneMoving)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+
+// the worst case for the incremental sort, everything is re-sorted from scratch
+static void BM_SweepAndPruneRebuild(benchmark::State& state)
+{
+	std::mt19937 rng(0);
+	for (auto _ : state)
+	{
+		SweepAndPrune broadphase;
+		spawn_moving_bounds(broadphase, state.range(0), rng);
+		benchmark::DoNotOptimize(broadphase.update().size());
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SweepAndPruneRebuild)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_NarrowphaseBoxBox(benchmark::State& state)
+{
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> position(-1.5f, 1.5f);
+	std::uniform_real_distribution<float> angle(-Maths::PI, Maths::PI);
+	std::vector<Maths::OBB> boxes;
+	for (int i = 0; i < 1024; i++)
+	{
+		boxes.emplace_back(glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(0.5f), 
+			glm::mat3_cast(glm::angleAxis(angle(rng), glm::normalize(glm::vec3(position(rng), position(rng), 1.0f)))));
+	}
+
+	size_t idx = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(Narrowphase::box_box(boxes[idx % boxes.size()], boxes[(idx + 1) % boxes.size()]));
+		idx++;
+	}
+}
+BENCHMARK(BM_NarrowphaseBoxBox);
+
+static void BM_NarrowphaseBoxCapsule(benchmark::State& state)
+{
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> position(-1.5f, 1.5f);
+	std::vector<Maths::Capsule> capsules;
+	for (int i = 0; i < 1024; i++)
+	{
+		const glm::vec3 start(position(rng), position(rng), position(rng));
+		capsules.emplace_back(start, start + glm::vec3(position(rng), position(rng), position(rng)), 0.25f);
+	}
+	const Maths::OBB box(glm::vec3(0.0f), glm::vec3(0.5f), glm::mat3_cast(glm::angleAxis(0.5f, Maths::up_vec)));
+
+	size_t idx = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(Narrowphase::box_capsule(box, capsules[idx++ % capsules.size()]));
+	}
+}
+BENCHMARK(BM_NarrowphaseBoxCapsule);
+
+static void BM_ColliderSystemContacts(benchmark::State& state)
+{
+	HeadlessEngine headless;
+	auto& ecs = headless.engine.get_ecs();
+	std::vector<Object*> objects;
+	std::vector<ObjectID> ids;
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> position(0.0f, get_world_size(state.range(0)));
+	for (int64_t i = 0; i < state.range(0); i++)
+	{
+		auto& object = headless.engine.spawn_object(
+			std::make_shared<Object>(Renderable::make_default(MeshFactory::cube_id())));
+		object.set_position(glm::vec3(position(rng), position(rng), position(rng)));
+		if (i % 2 == 0)
+		{
+			ecs.add_collider(object.get_id(), std::make_unique<BoxCollider>());
+		} else
+		{
+			ecs.add_collider(object.get_id(), std::make_unique<CapsuleCollider>(Maths::Capsule(glm::vec3(0.0f, -0.25f, 0.0f), glm::vec3(0.0f, 0.25f, 0.0f), 0.25f)));
+		}
+		objects.push_back(&object);
+		ids.push_back(object.get_id());
+	}
+
+	float time = 0.0f;
+	for (auto _ : state)
+	{
+		time += 1.0f / 60.0f;
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			const glm::vec3 position = objects[i]->get_position();
+			objects[i]->set_position(position + 0.01f * glm::vec3(std::sin(time + float(i)), std::cos(time + float(i)), 0.0f));
+		}
+		ecs.update_contacts();
+		benchmark::DoNotOptimize(ecs.get_contacts().size());
+	}
+
+	state.counters["contacts"] = static_cast<double>(ecs.get_contacts().size());
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	headless.delete_objects(ids);
+}
+BENCHMARK(BM_ColliderSystemContacts)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMicrosecond);
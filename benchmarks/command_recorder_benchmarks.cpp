@@ -0,0 +1,73 @@
+#include <graphics_engine/worker_pool.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <glm/mat4x4.hpp>
+
+#include <cstring>
+#include <vector>
+
+
+namespace
+{
+	// what recording an object reads, its transform and the handles it binds
+	struct SceneObject
+	{
+		glm::mat4 model;
+		uint32_t mesh_slot;
+		uint32_t material_slot;
+		uint32_t num_indices;
+	};
+
+	// stands in for a command buffer, recording is mostly copying into the pool's memory
+	//	bind descriptor set, push constants with the model matrix, bind vertex and index buffers and a draw
+	void record_object(std::vector<uint32_t>& commands, const SceneObject& object)
+	{
+		const size_t offset = commands.size();
+		commands.resize(offset + 24);
+		uint32_t* command = commands.data() + offset;
+		command[0] = 1;
+		command[1] = object.material_slot;
+		command[2] = 2;
+		std::memcpy(command + 3, &object.model, sizeof(object.model));
+		command[19] = 3;
+		command[20] = object.mesh_slot;
+		command[21] = 4;
+		command[22] = object.num_indices;
+		command[23] = 0;
+	}
+}
+
+// the cached draw commands of a large scene recorded by 1 to 8 workers, each taking an equal range like Renderer
+//	the speed up over 1 worker is bounded by the cores the machine has
+static void BM_CommandRecorderScaling(benchmark::State& state)
+{
+	const uint32_t num_workers = uint32_t(state.range(0));
+	const size_t num_objects = size_t(state.range(1));
+	std::vector<SceneObject> scene(num_objects);
+	for (size_t i = 0; i < num_objects; i++)
+	{
+		scene[i] = SceneObject{ glm::mat4(float(i)), uint32_t(i % 64), uint32_t(i % 16), 36 };
+	}
+
+	WorkerPool workers(num_workers, "BenchmarkRecorder");
+	std::vector<std::vector<uint32_t>> command_buffers(num_workers);
+	for (auto _ : state)
+	{
+		workers.run(num_workers, [&](uint32_t worker_idx)
+		{
+			auto& commands = command_buffers[worker_idx];
+			commands.clear();
+			const size_t first = num_objects * worker_idx / num_workers;
+			const size_t last = num_objects * (worker_idx + 1) / num_workers;
+			for (size_t i = first; i < last; i++)
+			{
+				record_object(commands, scene[i]);
+			}
+		});
+		benchmark::DoNotOptimize(command_buffers.front().data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * int64_t(num_objects));
+}
+BENCHMARK(BM_CommandRecorderScaling)->ArgsProduct({ { 1, 2, 4, 8 }, { 100000 } })->UseRealTime()->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "benchmark_helper.hpp"
+
+#include <renderable/mesh_factory.hpp>
+#include <renderable/renderable.hpp>
+#include <resource_loader/resource_loader.hpp>
+#include <utility.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+
+static const std::filesystem::path test_model_path = Utility::get_top_level_path()/"test/data/simple_test_model.gltf";
+
+static void BM_ECSProcessAnimations(benchmark::State& state)
+{
+	HeadlessEngine headless;
+	auto& ecs = headless.engine.get_ecs();
+	std::vector<ObjectID> ids;
+	for (int64_t i = 0; i < state.range(0); i++)
+	{
+		auto& object = headless.engine.spawn_object(
+			std::make_shared<Object>(Renderable::make_default(MeshFactory::cube_id())));
+		ids.push_back(object.get_id());
+		Maths::Transform final_transform;
+		final_transform.set_pos(glm::vec3(float(i), 1.0f, 0.0f));
+		// long enough that the animation never completes during the benchmark
+		ecs.animate(object.get_id(), AnimationSequence(Maths::Transform{}, final_transform, 1e9f));
+	}
+
+	for (auto _ : state)
+	{
+		ecs.process(1.0f / 60.0f);
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	headless.delete_objects(ids);
+}
+BENCHMARK(BM_ECSProcessAnimations)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_SkeletalAnimationSampling(benchmark::State& state)
+{
+	HeadlessEngine headless;
+	auto& ecs = headless.engine.get_ecs();
+	std::vector<ObjectID> ids;
+	for (int64_t i = 0; i < state.range(0); i++)
+	{
+		auto model = ResourceLoader::load_model(test_model_path.string());
+		const auto skeleton_id = model.renderables[0].skeleton_id.value();
+		ids.push_back(headless.engine.spawn_object(std::make_shared<Object>(model.renderables)).get_id());
+		ecs.play_animation(skeleton_id, model.animations[0], true);
+	}
+
+	for (auto _ : state)
+	{
+		ecs.process(1.0f / 60.0f);
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	headless.delete_objects(ids);
+}
+BENCHMARK(BM_SkeletalAnimationSampling)->RangeMultiplier(10)->Range(1, 1000)->Unit(benchmark::kMicrosecond);
+
+static void BM_Picking(benchmark::State& state)
+{
+	HeadlessEngine headless;
+	auto& ecs = headless.engine.get_ecs();
+	std::vector<ObjectID> ids;
+	const int64_t width = static_cast<int64_t>(std::sqrt(state.range(0)));
+	for (int64_t i = 0; i < state.range(0); i++)
+	{
+		auto& object = headless.engine.spawn_object(
+			std::make_shared<Object>(Renderable::make_default(MeshFactory::sphere_id())));
+		object.set_position(glm::vec3(float(i % width) * 2.0f, float(i / width) * 2.0f, 10.0f));
+		ecs.add_collider(object.get_id(), std::make_unique<SphereCollider>());
+		ecs.add_clickable_entity(object.get_id());
+		ids.push_back(object.get_id());
+	}
+
+	int64_t ray_idx = 0;
+	for (auto _ : state)
+	{
+		const float x = float(ray_idx % width) * 2.0f;
+		const float y = float((ray_idx / width) % width) * 2.0f;
+		const Maths::Ray ray(glm::vec3(x, y, 0.0f), Maths::forward_vec);
+		benchmark::DoNotOptimize(ecs.check_any_entity_clicked(ray));
+		++ray_idx;
+	}
+
+	headless.delete_objects(ids);
+}
+BENCHMARK(BM_Picking)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
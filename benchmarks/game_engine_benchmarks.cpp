@@ -0,0 +1,44 @@
+#include "benchmark_helper.hpp"
+
+#include <renderable/mesh_factory.hpp>
+#include <renderable/renderable.hpp>
+
+#include <benchmark/benchmark.h>
+
+
+static void BM_SpawnDeleteObjects(benchmark::State& state)
+{
+	HeadlessEngine headless;
+	const auto mesh_id = MeshFactory::cube_id();
+	std::vector<ObjectID> ids(state.range(0));
+	for (auto _ : state)
+	{
+		for (auto& id : ids)
+		{
+			id = headless.engine.spawn_object(std::make_shared<Object>(Renderable::make_default(mesh_id))).get_id();
+		}
+		headless.delete_objects(ids);
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SpawnDeleteObjects)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_MainLoop(benchmark::State& state)
+{
+	HeadlessEngine headless;
+	std::vector<ObjectID> ids;
+	for (int64_t i = 0; i < state.range(0); i++)
+	{
+		ids.push_back(headless.engine.spawn_object(
+			std::make_shared<Object>(Renderable::make_default(MeshFactory::cube_id()))).get_id());
+	}
+
+	for (auto _ : state)
+	{
+		headless.engine.main_loop(1.0f / 60.0f);
+	}
+
+	headless.delete_objects(ids);
+}
+BENCHMARK(BM_MainLoop)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,244 @@
+#include <navigation/nav_grid.hpp>
+#include <navigation/pathfinder.hpp>
+#include <navigation/flow_field.hpp>
+#include <navigation/hierarchical_pathfinder.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+
+namespace
+{
+	// open ground with scattered blocked tiles and a few long walls, so paths have to route around things
+	NavGrid make_map(int size, uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+		std::uniform_int_distribution<int> coordinate(0, size - 1);
+		NavGrid grid(NavGrid::Coord(0), NavGrid::Coord(size));
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				if (chance(rng) < 0.2f)
+				{
+					grid.set_cost(NavGrid::Coord(x, y), NavGrid::BLOCKED);
+				} else if (chance(rng) < 0.1f)
+				{
+					grid.set_cost(NavGrid::Coord(x, y), 3);
+				}
+			}
+		}
+		for (int wall = 0; wall < size / 16; wall++)
+		{
+			const NavGrid::Coord start(coordinate(rng), coordinate(rng));
+			const bool horizontal = wall % 2 == 0;
+			for (int i = 0; i < size / 4; i++)
+			{
+				const NavGrid::Coord tile = start + (horizontal ? NavGrid::Coord(i, 0) : NavGrid::Coord(0, i));
+				if (grid.contains(tile))
+				{
+					grid.set_cost(tile, NavGrid::BLOCKED);
+				}
+			}
+		}
+
+		return grid;
+	}
+
+	std::vector<NavGrid::Coord> pick_open_tiles(const NavGrid& grid, size_t count, std::mt19937& rng)
+	{
+		std::uniform_int_distribution<int> coordinate(0, grid.get_size().x - 1);
+		std::vector<NavGrid::Coord> tiles;
+		while (tiles.size() < count)
+		{
+			const NavGrid::Coord tile(coordinate(rng), coordinate(rng));
+			if (grid.is_passable(tile))
+			{
+				tiles.push_back(tile);
+			}
+		}
+
+		return tiles;
+	}
+}
+
+// one unit ordered between two random points on the map
+static void BM_AStarPath(benchmark::State& state)
+{
+	const NavGrid grid = make_map(int(state.range(0)), 1);
+	std::mt19937 rng(2);
+	const auto starts = pick_open_tiles(grid, 64, rng);
+	const auto goals = pick_open_tiles(grid, 64, rng);
+	Pathfinder pathfinder;
+	size_t query = 0;
+	size_t num_expanded = 0;
+	for (auto _ : state)
+	{
+		const Path path = pathfinder.find_path(grid, starts[query % starts.size()], goals[query % goals.size()]);
+		benchmark::DoNotOptimize(path.cost);
+		num_expanded += pathfinder.get_num_expanded();
+		query++;
+	}
+
+	state.SetItemsProcessed(int64_t(num_expanded));
+	state.counters["expanded"] = benchmark::Counter(float(num_expanded), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_AStarPath)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMicrosecond);
+
+static void BM_FlowFieldBuild(benchmark::State& state)
+{
+	const NavGrid grid = make_map(int(state.range(0)), 1);
+	std::mt19937 rng(2);
+	const auto goals = pick_open_tiles(grid, 16, rng);
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		const FlowField field(grid, goals[query++ % goals.size()]);
+		benchmark::DoNotOptimize(field.get_cost_to_goal(goals[0]));
+	}
+
+	state.SetItemsProcessed(state.iterations() * grid.get_num_tiles());
+}
+BENCHMARK(BM_FlowFieldBuild)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond);
+
+// a group of units ordered to one destination, each walks its whole route through the shared field
+static void BM_FlowFieldGroupMove(benchmark::State& state)
+{
+	const NavGrid grid = make_map(256, 1);
+	std::mt19937 rng(2);
+	const auto units = pick_open_tiles(grid, size_t(state.range(0)), rng);
+	const auto goals = pick_open_tiles(grid, 16, rng);
+	FlowFieldCache cache;
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		const auto field = cache.get(grid, goals[query++ % goals.size()]);
+		for (const auto& unit : units)
+		{
+			benchmark::DoNotOptimize(field->trace(unit).size());
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FlowFieldGroupMove)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMicrosecond);
+
+// the same group move with a separate A* search per unit
+static void BM_AStarGroupMove(benchmark::State& state)
+{
+	const NavGrid grid = make_map(256, 1);
+	std::mt19937 rng(2);
+	const auto units = pick_open_tiles(grid, size_t(state.range(0)), rng);
+	const auto goals = pick_open_tiles(grid, 16, rng);
+	Pathfinder pathfinder;
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		const auto& goal = goals[query++ % goals.size()];
+		for (const auto& unit : units)
+		{
+			benchmark::DoNotOptimize(pathfinder.find_path(grid, unit, goal).tiles.size());
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AStarGroupMove)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMicrosecond);
+
+// building the cluster graph for a whole map, which the first query pays for
+static void BM_HierarchicalBuild(benchmark::State& state)
+{
+	NavGrid grid = make_map(int(state.range(0)), 1);
+	for (auto _ : state)
+	{
+		HierarchicalPathfinder pathfinder(grid);
+		benchmark::DoNotOptimize(pathfinder.find_path(NavGrid::Coord(0), NavGrid::Coord(0)).found());
+	}
+}
+BENCHMARK(BM_HierarchicalBuild)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond);
+
+// the same single orders as BM_AStarPath through the cluster graph, the route cache is off so every query searches
+static void BM_HierarchicalPath(benchmark::State& state)
+{
+	NavGrid grid = make_map(int(state.range(0)), 1);
+	std::mt19937 rng(2);
+	const auto starts = pick_open_tiles(grid, 64, rng);
+	const auto goals = pick_open_tiles(grid, 64, rng);
+	HierarchicalPathfinder pathfinder(grid, HierarchicalPathfinder::DEFAULT_CLUSTER_SIZE, 0);
+	// the graph is built by the first query
+	pathfinder.find_path(starts[0], goals[0]);
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		const size_t i = query++ % starts.size();
+		benchmark::DoNotOptimize(pathfinder.find_path(starts[i], goals[i]).tiles.size());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HierarchicalPath)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMicrosecond);
+
+// a squad standing together ordered across a large map, units after the first mostly reuse the cached route
+static void BM_HierarchicalGroupMove(benchmark::State& state)
+{
+	NavGrid grid = make_map(1024, 1);
+	std::mt19937 rng(2);
+	std::uniform_int_distribution<int> offset(0, HierarchicalPathfinder::DEFAULT_CLUSTER_SIZE - 1);
+	std::vector<NavGrid::Coord> units;
+	while (units.size() < size_t(state.range(0)))
+	{
+		const NavGrid::Coord tile = NavGrid::Coord(96) + NavGrid::Coord(offset(rng), offset(rng));
+		if (grid.is_passable(tile))
+		{
+			units.push_back(tile);
+		}
+	}
+	// goals walled off from the squad are left out, every unit would search the whole graph to find that out
+	HierarchicalPathfinder pathfinder(grid);
+	std::vector<NavGrid::Coord> goals;
+	for (const auto& goal : pick_open_tiles(grid, 32, rng))
+	{
+		if (goals.size() < 16 && pathfinder.find_path(units[0], goal).found())
+		{
+			goals.push_back(goal);
+		}
+	}
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		const auto& goal = goals[query++ % goals.size()];
+		for (const auto& unit : units)
+		{
+			benchmark::DoNotOptimize(pathfinder.find_path(unit, goal).tiles.size());
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HierarchicalGroupMove)->RangeMultiplier(4)->Range(16, 256)->Unit(benchmark::kMillisecond);
+
+// a wall tile flips every query, only the clusters around it are rebuilt before the search
+static void BM_HierarchicalPathAfterChange(benchmark::State& state)
+{
+	NavGrid grid = make_map(1024, 1);
+	std::mt19937 rng(2);
+	const auto starts = pick_open_tiles(grid, 64, rng);
+	const auto goals = pick_open_tiles(grid, 64, rng);
+	const auto changes = pick_open_tiles(grid, 64, rng);
+	HierarchicalPathfinder pathfinder(grid);
+	pathfinder.find_path(starts[0], goals[0]);
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		const size_t i = query++ % starts.size();
+		const NavGrid::Coord& change = changes[i];
+		pathfinder.set_cost(change, grid.is_passable(change) ? NavGrid::BLOCKED : NavGrid::DEFAULT_COST);
+		benchmark::DoNotOptimize(pathfinder.find_path(starts[i], goals[i]).tiles.size());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HierarchicalPathAfterChange)->Unit(benchmark::kMicrosecond);
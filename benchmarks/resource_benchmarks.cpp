@@ -0,0 +1,114 @@
+#include <graphics_engine/resource_manager/graphics_buffer.hpp>
+#include <renderable/mesh_factory.hpp>
+#include <resource_loader/resource_loader.hpp>
+#include <entity_component_system/mesh_system.hpp>
+#include <entity_component_system/material_system.hpp>
+#include <entity_component_system/ecs.hpp>
+#include <utility.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+
+static void BM_GraphicsBufferReserveFree(benchmark::State& state)
+{
+	const uint32_t num_slots = static_cast<uint32_t>(state.range(0));
+	const uint32_t slot_size = 256;
+	GraphicsBuffer buffer(nullptr, nullptr, num_slots * slot_size, 16);
+	std::vector<uint32_t> order(num_slots);
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), std::mt19937(0));
+
+	for (auto _ : state)
+	{
+		for (uint32_t id = 0; id < num_slots; id++)
+		{
+			benchmark::DoNotOptimize(buffer.reserve_slot(id, slot_size - id % 16));
+		}
+		// freeing in random order exercises the free slot coalescing
+		for (const uint32_t id : order)
+		{
+			buffer.free_slot(id);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * num_slots);
+}
+BENCHMARK(BM_GraphicsBufferReserveFree)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_MeshGenerationSphere(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(MeshFactory::sphere(
+			MeshFactory::EVertexType::COLOR, 
+			MeshFactory::GenerationMethod::UV_SPHERE, 
+			static_cast<int>(state.range(0))));
+	}
+}
+BENCHMARK(BM_MeshGenerationSphere)->RangeMultiplier(4)->Range(64, 16384)->Unit(benchmark::kMicrosecond);
+
+static void BM_MeshGenerationPrimitives(benchmark::State& state)
+{
+	const uint32_t num_vertices = static_cast<uint32_t>(state.range(0));
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(MeshFactory::cylinder(MeshFactory::EVertexType::COLOR, num_vertices));
+		benchmark::DoNotOptimize(MeshFactory::cone(MeshFactory::EVertexType::COLOR, num_vertices));
+		benchmark::DoNotOptimize(MeshFactory::arrow(0.05f, num_vertices));
+	}
+}
+BENCHMARK(BM_MeshGenerationPrimitives)->RangeMultiplier(4)->Range(8, 512)->Unit(benchmark::kMicrosecond);
+
+static void BM_MeshSystemAddRemove(benchmark::State& state)
+{
+	std::vector<MeshID> ids(state.range(0));
+	for (auto _ : state)
+	{
+		for (auto& id : ids)
+		{
+			id = MeshSystem::add(MeshFactory::quad());
+		}
+		for (const auto id : ids)
+		{
+			MeshSystem::unregister_owner(id);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MeshSystemAddRemove)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_LoadGltfModel(benchmark::State& state)
+{
+	const auto path = (Utility::get_top_level_path()/"test/data/simple_test_model.gltf").string();
+	for (auto _ : state)
+	{
+		auto model = ResourceLoader::load_model(path);
+		benchmark::DoNotOptimize(model);
+
+		// loaded resources are owned by the returned model, release them so memory doesn't grow
+		state.PauseTiming();
+		for (const auto& renderable : model.renderables)
+		{
+			MeshSystem::unregister_owner(renderable.mesh_id);
+			for (const auto material_id : renderable.material_ids)
+			{
+				MaterialSystem::unregister_owner(material_id);
+			}
+			if (renderable.skeleton_id)
+			{
+				ECS::get().remove_skeleton(*renderable.skeleton_id);
+			}
+		}
+		for (const auto animation_id : model.animations)
+		{
+			ECS::get().remove_skeletal_animation(animation_id);
+		}
+		state.ResumeTiming();
+	}
+}
+BENCHMARK(BM_LoadGltfModel)->Unit(benchmark::kMicrosecond);
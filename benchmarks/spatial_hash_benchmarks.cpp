@@ -0,0 +1,162 @@
+#include "benchmark_helper.hpp"
+
+#include <collision/spatial_hash.hpp>
+#include <entity_component_system/ecs.hpp>
+#include <objects/object.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <glm/gtx/norm.hpp>
+
+#include <random>
+#include <cmath>
+
+
+namespace
+{
+	constexpr float QUERY_RADIUS = 4.0f;
+
+	// side length of a world with one point per 8 cubic units, so a query finds the same number of points at every count
+	float get_world_size(int64_t count)
+	{
+		return 2.0f * std::cbrt(float(count));
+	}
+
+	std::vector<glm::vec3> spawn_points(int64_t count, std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> coordinate(0.0f, get_world_size(count));
+		std::vector<glm::vec3> points;
+		points.reserve(count);
+		for (int64_t i = 0; i < count; i++)
+		{
+			points.emplace_back(coordinate(rng), coordinate(rng), coordinate(rng));
+		}
+
+		return points;
+	}
+
+	SpatialHash make_hash(const std::vector<glm::vec3>& points)
+	{
+		SpatialHash hash(QUERY_RADIUS);
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			hash.insert(ObjectID(i), points[i]);
+		}
+
+		return hash;
+	}
+}
+
+static void BM_SpatialHashRadiusQuery(benchmark::State& state)
+{
+	std::mt19937 rng(0);
+	const auto points = spawn_points(state.range(0), rng);
+	const SpatialHash hash = make_hash(points);
+	std::vector<ObjectID> found;
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		found.clear();
+		hash.query_radius(points[query++ % points.size()], QUERY_RADIUS, found);
+		benchmark::DoNotOptimize(found.data());
+	}
+
+	state.counters["found"] = float(found.size());
+}
+BENCHMARK(BM_SpatialHashRadiusQuery)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+// the linear scan over every position the hash replaces
+static void BM_BruteForceRadiusQuery(benchmark::State& state)
+{
+	std::mt19937 rng(0);
+	const auto points = spawn_points(state.range(0), rng);
+	std::vector<ObjectID> found;
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		found.clear();
+		const glm::vec3 center = points[query++ % points.size()];
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			if (glm::distance2(points[i], center) <= QUERY_RADIUS * QUERY_RADIUS)
+			{
+				found.push_back(ObjectID(i));
+			}
+		}
+		benchmark::DoNotOptimize(found.data());
+	}
+}
+BENCHMARK(BM_BruteForceRadiusQuery)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_SpatialHashNearest(benchmark::State& state)
+{
+	std::mt19937 rng(0);
+	const auto points = spawn_points(state.range(0), rng);
+	const SpatialHash hash = make_hash(points);
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(hash.query_nearest(points[query++ % points.size()], 8));
+	}
+}
+BENCHMARK(BM_SpatialHashNearest)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+// every point moves a little each tick, like objects in a running game
+static void BM_SpatialHashUpdate(benchmark::State& state)
+{
+	std::mt19937 rng(0);
+	auto points = spawn_points(state.range(0), rng);
+	SpatialHash hash = make_hash(points);
+	std::uniform_real_distribution<float> step(-0.1f, 0.1f);
+	std::vector<glm::vec3> velocities;
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		velocities.emplace_back(step(rng), step(rng), step(rng));
+	}
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			points[i] += velocities[i];
+			hash.update(ObjectID(i), points[i]);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SpatialHashUpdate)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+// 100k objects of which range(0) move per tick, the ECS upkeep should scale with the movers rather than the objects
+static void BM_SpatialSystemUpdate(benchmark::State& state)
+{
+	const int64_t num_objects = 100000;
+	std::mt19937 rng(0);
+	const auto points = spawn_points(num_objects, rng);
+	ECS ecs;
+	std::vector<Object> objects(num_objects);
+	for (int64_t i = 0; i < num_objects; i++)
+	{
+		objects[i].set_position(points[i]);
+		ecs.add_object(objects[i]);
+	}
+	ecs.process(0.0f);
+
+	const int64_t num_moving = state.range(0);
+	const glm::vec3 step(0.01f);
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < num_moving; i++)
+		{
+			objects[i].set_position(objects[i].get_position() + step);
+		}
+		ecs.process(0.0f);
+	}
+
+	for (const Object& object : objects)
+	{
+		ecs.remove_object(object.get_id());
+	}
+	state.SetItemsProcessed(state.iterations() * num_moving);
+}
+BENCHMARK(BM_SpatialSystemUpdate)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,72 @@
+#include <tile_system.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+
+namespace
+{
+	// a square map centred on the origin so the chunks on both sides of zero are used
+	TileSet make_tileset(int size)
+	{
+		TileSet tileset;
+		tileset.add_tiles(TileCoord(-size / 2), TileCoord(size / 2 - 1));
+		return tileset;
+	}
+
+	std::vector<TileCoord> pick_tiles(int size, size_t count, uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<int> coordinate(-size / 2, size / 2 - 1);
+		std::vector<TileCoord> tiles(count);
+		for (auto& tile : tiles)
+		{
+			tile = TileCoord(coordinate(rng), coordinate(rng));
+		}
+
+		return tiles;
+	}
+}
+
+// random tile lookups, the time per lookup should stay flat as the map grows to 1024x1024
+static void BM_TileSetLookup(benchmark::State& state)
+{
+	const int size = int(state.range(0));
+	const TileSet tileset = make_tileset(size);
+	const auto coords = pick_tiles(size, 4096, 1);
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(tileset.get_tile(coords[query++ % coords.size()]));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TileSetLookup)->RangeMultiplier(4)->Range(64, 1024);
+
+// units spawned onto a 1024x1024 map and removed again, object ids are never reused
+//	so this checks that the per object bookkeeping doesn't grow with the number of objects ever created
+static void BM_TileSetObjectChurn(benchmark::State& state)
+{
+	TileSet tileset = make_tileset(1024);
+	const auto coords = pick_tiles(1024, 4096, 2);
+	const size_t num_alive = size_t(state.range(0));
+	std::vector<ObjectID> alive;
+	size_t query = 0;
+	for (auto _ : state)
+	{
+		const ObjectID id = ObjectID::generate_new_id();
+		tileset.add_to_tile(coords[query++ % coords.size()], id);
+		alive.push_back(id);
+		if (alive.size() > num_alive)
+		{
+			tileset.remove_object(alive[alive.size() - num_alive - 1]);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	state.counters["tracked_objects"] = float(tileset.get_num_objects());
+}
+BENCHMARK(BM_TileSetObjectChurn)->RangeMultiplier(16)->Range(16, 4096);
\ No newline at end of file
@@ -36,6 +36,7 @@ class vulkan_conan(ConanFile):
 		"fmt/8.1.1",
 		"imgui/1.87", # also update backend under third_party
 		"gtest/1.8.1",
+		"benchmark/1.6.1",
 		"yaml-cpp/0.7.0",
 		"magic_enum/0.8.2"
 	) 
@@ -0,0 +1,68 @@
+// point lights binned into clusters of the view frustum, see LightClusters
+// include after library.glsl and the global_data declaration
+
+layout(std430, set=RASTERIZATION_LOW_FREQ_SET_OFFSET, binding=RASTERIZATION_POINT_LIGHTS_DATA_BINDING) readonly buffer PointLightsBuffer
+{
+	PointLight data[];
+} point_lights;
+
+layout(std430, set=RASTERIZATION_LOW_FREQ_SET_OFFSET, binding=RASTERIZATION_LIGHT_CLUSTERS_DATA_BINDING) readonly buffer LightClustersBuffer
+{
+	LightCluster data[];
+} light_clusters;
+
+layout(std430, set=RASTERIZATION_LOW_FREQ_SET_OFFSET, binding=RASTERIZATION_LIGHT_INDICES_DATA_BINDING) readonly buffer LightIndicesBuffer
+{
+	uint data[];
+} light_indices;
+
+// the same cluster LightClusters::find_cluster picks
+uint get_light_cluster_index(vec3 frag_pos)
+{
+	const vec4 view_pos = global_data.data.view * vec4(frag_pos, 1.0);
+	const vec4 clip = global_data.data.proj * view_pos;
+	const vec2 ndc = clip.xy / clip.w;
+
+	const uvec2 tile = uvec2(clamp(
+		ivec2(floor((ndc * 0.5 + 0.5) * vec2(LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y))),
+		ivec2(0),
+		ivec2(LIGHT_CLUSTER_GRID_X - 1, LIGHT_CLUSTER_GRID_Y - 1)));
+	const float depth = max(view_pos.z, global_data.data.light_cluster_near_depth);
+	const uint slice = uint(clamp(
+		int(floor(log(depth / global_data.data.light_cluster_near_depth) * global_data.data.light_cluster_slice_scale)),
+		0,
+		LIGHT_CLUSTER_GRID_Z - 1));
+
+	return (slice * LIGHT_CLUSTER_GRID_Y + tile.y) * LIGHT_CLUSTER_GRID_X + tile.x;
+}
+
+// diffuse and specular of the point lights reaching the fragment
+vec3 compute_clustered_point_lights(
+	vec3 frag_pos, vec3 norm, vec3 view_dir, vec3 diffuse_color, vec3 specular_color, float shininess)
+{
+	const LightCluster cluster = light_clusters.data[get_light_cluster_index(frag_pos)];
+
+	vec3 result = vec3(0.0);
+	for (uint i = 0; i < cluster.count; ++i)
+	{
+		const PointLight light = point_lights.data[light_indices.data[cluster.offset + i]];
+		const vec3 to_light = light.pos - frag_pos;
+		const float dist = length(to_light);
+		if (dist >= light.radius)
+		{
+			continue;
+		}
+
+		// inverse square falloff windowed to reach zero at the radius
+		const float window = clamp(1.0 - pow(dist / light.radius, 4.0), 0.0, 1.0);
+		const float attenuation = window * window / (dist * dist + 1.0);
+
+		const vec3 light_dir = to_light / max(dist, 0.0001);
+		const float diff = max(dot(norm, light_dir), 0.0);
+		const float spec = diff > 0.0 ? get_bling_phong_spec(light_dir, norm, view_dir, shininess) : 0.0;
+		result += light.color * attenuation *
+			(diff * DIFFUSE_STRENGTH * diffuse_color + SPECULAR_STRENGTH * spec * specular_color);
+	}
+
+	return result;
+}
@@ -6,6 +6,19 @@ const float SPECULAR_STRENGTH = 0.5;
 const float EMISSIVE_STRENGTH = 1.0; // it's high because for now only light sources use this value
 const float STENCIL_OFFSET = 0.05;
 const vec4 STENCIL_COLOR = vec4(1.0, 0.5, 0.0, 1.0);
+const int OUTLINE_WIDTH = 2; // in pixels
+
+// inverse of VertexQuantization::encode_octahedral, the input is the raw snorm16x2 attribute
+vec3 decode_octahedral(vec2 oct)
+{
+	vec3 normal = vec3(oct, 1.0 - abs(oct.x) - abs(oct.y));
+	if (normal.z < 0.0)
+	{
+		normal.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+	}
+
+	return normalize(normal);
+}
 
 float get_phong_spec(vec3 lightDir, vec3 norm, vec3 viewDir, float shininess)
 {
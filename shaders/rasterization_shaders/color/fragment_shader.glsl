@@ -7,7 +7,6 @@
 // note that the fragment shader receives the input as interpolated values
 layout(location=2) in vec3 surface_normal;
 layout(location=4) in vec3 frag_pos;
-layout(location=5) in vec4 shadow_coords;
 
 layout(location=0) out vec4 out_color;
 
@@ -21,17 +20,27 @@ layout(set=RASTERIZATION_LOW_FREQ_SET_OFFSET, binding=RASTERIZATION_GLOBAL_DATA_
 	GlobalData data;
 } global_data;
 
-layout(set=RASTERIZATION_SHADOW_MAP_SET_OFFSET, binding=RASTERIZATION_SHADOW_MAP_DATA_BINDING) uniform sampler2D shadow_map;
+#include "../../library/clustered_lighting.glsl"
 
-float compute_shadow_factor(vec4 shadow_coords)
+// a layer per cascade
+layout(set=RASTERIZATION_SHADOW_MAP_SET_OFFSET, binding=RASTERIZATION_SHADOW_MAP_DATA_BINDING) uniform sampler2DArray shadow_map;
+
+float compute_shadow_factor(vec3 frag_pos)
 {
-	// if (abs(shadow_coords.z) > 1.0)
-	// {
-	// 	// outside NDC, so treat as if not in shadow
-	// 	return 1.0;
-	// }
+	// the closest cascade that still covers the fragment, past the last one nothing is in shadow
+	const float view_depth = (global_data.data.view * vec4(frag_pos, 1.0)).z;
+	int cascade = 0;
+	while (cascade < SHADOW_MAP_NUM_CASCADES && view_depth > global_data.data.shadow_cascade_splits[cascade])
+	{
+		++cascade;
+	}
+	if (cascade == SHADOW_MAP_NUM_CASCADES)
+	{
+		return 1.0;
+	}
 
 	// convert light space to screen space NDC
+	vec4 shadow_coords = global_data.data.shadow_cascade_view_proj[cascade] * vec4(frag_pos, 1.0);
 	shadow_coords.xyz /= shadow_coords.w;
 	// Vulkan's Z is already in NDC [0 : 1]
 	shadow_coords.xy = shadow_coords.xy * 0.5 + 0.5;
@@ -39,13 +48,13 @@ float compute_shadow_factor(vec4 shadow_coords)
 	shadow_coords.y = 1.0 - shadow_coords.y; // I'm not sure why it appears the y-axis is flipped, adding here
 
 	// percentage closer filtering
-	const vec2 texel_size = 1.0 / textureSize(shadow_map, 0);
+	const vec2 texel_size = 1.0 / textureSize(shadow_map, 0).xy;
 	float shadow_factor = 0.0;
 	for (int x = -1; x <= 1; ++x)
 	{
 		for (int y = -1; y <= 1; ++y)
 		{
-			const float closest_depth = texture(shadow_map, shadow_coords.xy + vec2(x, y) * texel_size).r; 
+			const float closest_depth = texture(shadow_map, vec3(shadow_coords.xy + vec2(x, y) * texel_size, cascade)).r; 
 			shadow_factor += shadow_coords.z > closest_depth ? 0.05 : 1.0;
 		}
 	}
@@ -73,6 +82,10 @@ void main()
 
 	// emissive
 	const vec3 emissive = EMISSIVE_STRENGTH * mat_data.data.emissive;
+
+	// point lights
+	const vec3 point_lights = compute_clustered_point_lights(
+		frag_pos, norm, viewDir, mat_data.data.diffuse, mat_data.data.specular, mat_data.data.shininess);
         
-	out_color = vec4(ambient + (diffuse + specular)*compute_shadow_factor(shadow_coords) + emissive, 1.0);
+	out_color = vec4(ambient + (diffuse + specular)*compute_shadow_factor(frag_pos) + point_lights + emissive, 1.0);
 }
\ No newline at end of file
@@ -6,11 +6,10 @@
 
 // keep in mind that some types such as dvec3 uses 2 slots therefore we need the next layout location to be 2 indices after
 layout(location=0) in vec3 in_position; // vertex pos
-layout(location=3) in vec3 in_normal; // vertex normal
+layout(location=3) in vec2 in_normal; // vertex normal, octahedral encoded
 
 layout(location=2) out vec3 surface_normal;
 layout(location=4) out vec3 frag_pos;
-layout(location=5) out vec4 shadow_coords;
 
 layout(set=RASTERIZATION_HIGH_FREQ_PER_OBJ_SET_OFFSET, binding=RASTERIZATION_OBJECT_DATA_BINDING) uniform ObjectDataBuffer
 {
@@ -20,7 +19,6 @@ layout(set=RASTERIZATION_HIGH_FREQ_PER_OBJ_SET_OFFSET, binding=RASTERIZATION_OBJ
 void main()
 {
     gl_Position = object_data.data.mvp * vec4(in_position, 1.0);
-    surface_normal = (object_data.data.model * vec4(in_normal, 0.0)).xyz;
+    surface_normal = (object_data.data.model * vec4(decode_octahedral(in_normal), 0.0)).xyz;
 	frag_pos = (object_data.data.model * vec4(in_position, 1.0)).xyz;
-	shadow_coords = object_data.data.shadow_mvp * vec4(in_position, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+#include "../../library/library.glsl"
+
+// the stencil of the multisampled rasterization depth attachment, the stenciled objects are marked with 1
+layout(set=0, binding=0) uniform usampler2DMS stencil_sampler;
+
+layout(location = 0) out vec4 out_color;
+
+bool is_marked(ivec2 coord)
+{
+	const ivec2 size = textureSize(stencil_sampler);
+	return texelFetch(stencil_sampler, clamp(coord, ivec2(0), size - 1), 0).r != 0u;
+}
+
+void main()
+{
+	const ivec2 coord = ivec2(gl_FragCoord.xy);
+	if (is_marked(coord))
+	{
+		discard;
+	}
+
+	// outside of the marked objects, outlined when one is within OUTLINE_WIDTH pixels
+	for (int y = -OUTLINE_WIDTH; y <= OUTLINE_WIDTH; ++y)
+	{
+		for (int x = -OUTLINE_WIDTH; x <= OUTLINE_WIDTH; ++x)
+		{
+			if (is_marked(coord + ivec2(x, y)))
+			{
+				out_color = STENCIL_COLOR;
+				return;
+			}
+		}
+	}
+
+	discard;
+}
\ No newline at end of file
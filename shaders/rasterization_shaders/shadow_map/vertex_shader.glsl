@@ -12,7 +12,14 @@ layout(set=RASTERIZATION_HIGH_FREQ_PER_OBJ_SET_OFFSET, binding=RASTERIZATION_OBJ
 	ObjectData data;
 } object_data;
 
+layout(set=RASTERIZATION_LOW_FREQ_SET_OFFSET, binding=RASTERIZATION_GLOBAL_DATA_BINDING) uniform GlobalDataBuffer
+{
+	GlobalData data;
+} global_data;
+
 void main()
 {
-    gl_Position = object_data.data.shadow_mvp * vec4(in_position, 1.0);
+	// the cascade is drawn as the first instance, see ShadowMapRenderer
+	const mat4 cascade_view_proj = global_data.data.shadow_cascade_view_proj[gl_InstanceIndex];
+    gl_Position = cascade_view_proj * object_data.data.model * vec4(in_position, 1.0);
 }
\ No newline at end of file
@@ -5,9 +5,9 @@
 
 // keep in mind that some types such as dvec3 uses 2 slots therefore we need the next layout location to be 2 indices after
 layout(location=0) in vec3 in_position;
-layout(location=1) in vec3 in_normal;
+layout(location=1) in vec2 in_normal; // octahedral encoded
 layout(location=2) in vec2 in_tex_coord;
-layout(location=3) in vec4 bone_ids;
+layout(location=3) in uvec4 bone_ids;
 layout(location=4) in vec4 bone_weights;
 
 layout(location=0) out vec2 frag_tex_coord;
@@ -29,9 +29,9 @@ layout(set=RASTERIZATION_LOW_FREQ_SET_OFFSET, binding=RASTERIZATION_GLOBAL_DATA_
 	GlobalData data;
 } global_data;
 
-mat4 get_bone_matrix(float index)
+mat4 get_bone_matrix(uint index)
 {
-	return bone_data.data[int(index)].final_transform;
+	return bone_data.data[index].final_transform;
 }
 
 void main()
@@ -46,7 +46,7 @@ void main()
 		get_bone_matrix(bone_ids.w) * bone_weights.w;
 	frag_pos = (skin_matrix * vec4(in_position, 1.0)).xyz;
 
-    surface_normal = (skin_matrix * vec4(in_normal, 0.0)).xyz;
+    surface_normal = (skin_matrix * vec4(decode_octahedral(in_normal), 0.0)).xyz;
 	frag_tex_coord = in_tex_coord;
     gl_Position = global_data.data.proj * global_data.data.view * vec4(frag_pos, 1.0);
 }
\ No newline at end of file
@@ -5,9 +5,9 @@
 
 // keep in mind that some types such as dvec3 uses 2 slots therefore we need the next layout location to be 2 indices after
 layout(location=0) in vec3 in_position;
-layout(location=1) in vec3 in_normal;
+layout(location=1) in vec2 in_normal; // octahedral encoded
 layout(location=2) in vec2 in_tex_coord;
-layout(location=3) in vec4 bone_ids;
+layout(location=3) in uvec4 bone_ids;
 layout(location=4) in vec4 bone_weights;
 
 layout(set=RASTERIZATION_HIGH_FREQ_PER_OBJ_SET_OFFSET, binding=RASTERIZATION_OBJECT_DATA_BINDING) uniform ObjectDataBuffer
@@ -25,9 +25,9 @@ layout(set=RASTERIZATION_LOW_FREQ_SET_OFFSET, binding=RASTERIZATION_GLOBAL_DATA_
 	GlobalData data;
 } global_data;
 
-mat4 get_bone_matrix(float index)
+mat4 get_bone_matrix(uint index)
 {
-	return bone_data.data[int(index)].final_transform;
+	return bone_data.data[index].final_transform;
 }
 
 
@@ -20,6 +20,8 @@ layout(set=RASTERIZATION_LOW_FREQ_SET_OFFSET, binding=RASTERIZATION_GLOBAL_DATA_
 	GlobalData data;
 } global_data;
 
+#include "../../library/clustered_lighting.glsl"
+
 void main()
 {
 	vec3 color = texture(tex_sampler, frag_tex_coord).rgb; // note that we lose alpha channel here
@@ -41,5 +43,9 @@ void main()
 	const float spec = diff > 0.0 ? get_bling_phong_spec(lightDir, norm, viewDir, default_specular_factor) : 0.0;
     const vec3 specular = light_color * (SPECULAR_STRENGTH * global_data.data.lighting_scalar * spec);
 
-	out_color = vec4(ambient + diffuse + specular, 1.0);
+	// point lights
+	const vec3 point_lights = compute_clustered_point_lights(
+		frag_pos, norm, viewDir, color, light_color, default_specular_factor);
+
+	out_color = vec4(ambient + diffuse + specular + point_lights, 1.0);
 }
\ No newline at end of file
@@ -5,7 +5,7 @@
 // keep in mind that some types such as dvec3 uses 2 slots therefore we need the next layout location to be 2 indices after
 layout(location = 0) in vec3 in_position;
 layout(location = 2) in vec2 inTexCoord;
-layout(location = 3) in vec3 inNormal;
+layout(location = 3) in vec2 inNormal; // octahedral encoded
 
 layout(location=0) out vec2 frag_tex_coord;
 layout(location=1) out vec3 surface_normal;
@@ -31,7 +31,7 @@ void main()
 	gl_Position = object_data.data.mvp * vec4(in_position, 1.0);
 
 	frag_tex_coord = inTexCoord;
-	surface_normal = object_data.data.rot_mat * inNormal;
+	surface_normal = object_data.data.rot_mat * decode_octahedral(inNormal);
 	// it's likely we can remove the need for global_data.data.view_pos and compute everything in "view space"
 	frag_pos = (object_data.data.model * vec4(in_position, 1.0)).xyz;
 }
\ No newline at end of file
@@ -15,20 +15,32 @@ layout(set=RAYTRACING_LOW_FREQ_SET_OFFSET, binding=RAYTRACING_GLOBAL_DATA_BINDIN
 } global_data;
 
 layout(set=RAYTRACING_MESH_DATA_SET_OFFSET, binding=BUFFER_MAPPER_BINDING) buffer Offsets { BufferMapEntry entries[]; } offsets; // Maps object id to offset in vertices and indices buffers
-layout(set=RAYTRACING_MESH_DATA_SET_OFFSET, binding=VERTICES_DATA_BINDING) buffer Vertices { ColorVertex v[]; } vertices; // Positions of an object
-layout(set=RAYTRACING_MESH_DATA_SET_OFFSET, binding=INDICES_DATA_BINDING, scalar) buffer Indices { uint i[]; } indices; // Triangle indices
+layout(set=RAYTRACING_MESH_DATA_SET_OFFSET, binding=VERTICES_DATA_BINDING, scalar) buffer Vertices { PackedColorVertex v[]; } vertices; // Positions of an object
+layout(set=RAYTRACING_MESH_DATA_SET_OFFSET, binding=INDICES_DATA_BINDING, scalar) buffer Indices { uint i[]; } indices; // Triangle indices, 16 or 32 bit depending on the mesh
+
+uint fetch_index(BufferMapEntry entry, uint idx)
+{
+	// 16 bit indices are packed two to a word, the first one in the low half
+	if (entry.index_size == 2)
+	{
+		const uint element = entry.index_offset / 2 + idx;
+		return (indices.i[element / 2] >> ((element % 2) * 16)) & 0xFFFF;
+	}
+
+	return indices.i[entry.index_offset / 4 + idx];
+}
 
 ColorVertex unpack(uint idx)
 {
-	BufferMapEntry entry = offsets.entries[gl_InstanceCustomIndexEXT];
-	entry.vertex_offset /= 4;
-	entry.index_offset /= 4;
-	entry.uniform_offset /= 4;
+	const BufferMapEntry entry = offsets.entries[gl_InstanceCustomIndexEXT];
 
-	const uint index = indices.i[entry.index_offset + idx];
-	const uint offset = entry.vertex_offset + index * COLOR_VERTEX_SIZE;
+	const uint index = fetch_index(entry, idx);
+	const PackedColorVertex packed = vertices.v[entry.vertex_offset / (4 * PACKED_COLOR_VERTEX_WORDS) + index];
 
-	return vertices.v[offset / 4];
+	ColorVertex vertex;
+	vertex.pos = packed.pos;
+	vertex.normal = decode_octahedral(unpackSnorm2x16(packed.normal));
+	return vertex;
 }
 
 void main()
@@ -53,4 +53,15 @@ namespace std
 				hash<glm::vec2>()(vertex.texCoord);
 		}
 	};
+
+	template<>
+	struct hash<SDS::SkinnedVertex>
+	{
+		size_t operator()(SDS::SkinnedVertex const& vertex) const
+		{
+			return 
+				hash<glm::vec3>()(vertex.pos) ^ hash<glm::vec3>()(vertex.normal) ^ 
+				hash<glm::vec2>()(vertex.texCoord) ^ hash<glm::vec4>()(vertex.bone_ids);
+		}
+	};
 }
\ No newline at end of file
@@ -20,7 +20,7 @@ Analytics::Analytics(std::function<void(float)>&& on_log, const int period) :
 void Analytics::start()
 {
 	assert(state != State::STARTED);
-	lap_cycle_start = system_clock::now();
+	lap_cycle_start = steady_clock::now();
 	if (state == State::FRESH)
 	{
 		log_cycle_start = lap_cycle_start;
@@ -32,7 +32,7 @@ void Analytics::stop()
 {
 	assert(state == State::STARTED);
 	state = State::STOPPED;
-	auto now = system_clock::now();
+	auto now = steady_clock::now();
 	elapsed_log_cycle += duration_cast<nanoseconds>(now - lap_cycle_start);
 	num_elapsed_cycles++;
 	if (now - log_cycle_start > LOG_PERIOD)
@@ -53,7 +53,7 @@ void Analytics::stop()
 
 void Analytics::quick_timer_start()
 {
-	quick_timer_start_time = system_clock::now();
+	quick_timer_start_time = steady_clock::now();
 }
 
 void Analytics::quick_timer_stop()
@@ -63,7 +63,7 @@ void Analytics::quick_timer_stop()
 
 void Analytics::quick_timer_stop(const std::string& mesg)
 {
-	auto elapsed = duration_cast<nanoseconds>(system_clock::now() - quick_timer_start_time);
+	auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - quick_timer_start_time);
 	double elapsed_float =  round((double)elapsed.count() / 10.0) / 100.0;
 	LOG_INFO(Utility::get_logger(), "{}, quick timer {} microseconds", mesg, elapsed_float);
 }
\ No newline at end of file
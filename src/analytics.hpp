@@ -34,10 +34,10 @@ public:
 
 private:
 	uint64_t num_elapsed_cycles = 0;
-	std::chrono::time_point<std::chrono::system_clock> log_cycle_start;
-	std::chrono::time_point<std::chrono::system_clock> lap_cycle_start;
+	std::chrono::time_point<std::chrono::steady_clock> log_cycle_start;
+	std::chrono::time_point<std::chrono::steady_clock> lap_cycle_start;
 	std::chrono::nanoseconds elapsed_log_cycle = std::chrono::nanoseconds(0);
-	std::chrono::time_point<std::chrono::system_clock> quick_timer_start_time;
+	std::chrono::time_point<std::chrono::steady_clock> quick_timer_start_time;
 	// once every X seconds Analytics::stop is called, data will be logged
 	const std::chrono::seconds LOG_PERIOD;
 
@@ -16,8 +16,7 @@ Camera::Camera(Listener&& listener, float aspect_ratio) :
 	listener(std::move(listener)),
 	aspect_ratio(aspect_ratio)
 {
-	perspective_matrix = glm::perspectiveLH(fov, aspect_ratio, near_clipping, far_clipping);
-	orthographic_matrix = glm::orthoLH(-aspect_ratio, aspect_ratio, -1.0f, 1.0f, near_clipping, far_clipping);
+	update_projections();
 	focus_obj = std::make_shared<Object>(Renderable::make_default(MeshFactory::sphere_id()));
 	focus_obj->set_scale(glm::vec3(0.3f, 0.3f, 0.3f));
 	focus_obj->set_visibility(false);
@@ -107,11 +106,24 @@ void Camera::toggle_projection()
 
 void Camera::set_orthographic_projection(const glm::vec2& horizontal_span)
 {
+	orthographic_vertical_span = horizontal_span / aspect_ratio;
+	update_projections();
+}
+
+void Camera::on_resize(float aspect_ratio)
+{
+	this->aspect_ratio = aspect_ratio;
+	update_projections();
+}
+
+void Camera::update_projections()
+{
+	perspective_matrix = glm::perspectiveLH(fov, aspect_ratio, near_clipping, far_clipping);
 	orthographic_matrix = glm::orthoLH(
-		horizontal_span.x, 
-		horizontal_span.y, 
-		horizontal_span.x / aspect_ratio, 
-		horizontal_span.y / aspect_ratio, 
+		orthographic_vertical_span.x * aspect_ratio, 
+		orthographic_vertical_span.y * aspect_ratio, 
+		orthographic_vertical_span.x, 
+		orthographic_vertical_span.y, 
 		near_clipping, 
 		far_clipping);
 }
@@ -184,8 +196,8 @@ void Camera::zoom_in(float length)
 	if (!projection_is_perspective)
 	{
 		length = std::fabsf(length);
-		orthographic_matrix = glm::orthoLH(
-			-aspect_ratio * length, aspect_ratio * length, -length, length, near_clipping, far_clipping);
+		orthographic_vertical_span = glm::vec2(-length, length);
+		update_projections();
 	}
 }
 
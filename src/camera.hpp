@@ -49,6 +49,9 @@ public:
 	void toggle_projection();
 
 	void set_orthographic_projection(const glm::vec2& horizontal_span);
+	// the swap chain was recreated with a different extent, keeps the vertical field of view
+	void on_resize(float aspect_ratio);
+	float get_aspect_ratio() const { return aspect_ratio; }
 
 public: // object
 	virtual void update_tracker() override;
@@ -72,8 +75,13 @@ protected:
 	virtual void set_rotation(const glm::quat& rotation) override;
 
 private:
+	// both projections from the aspect ratio, the orthographic one keeps its vertical span
+	void update_projections();
+
 	glm::mat4 perspective_matrix;
 	glm::mat4 orthographic_matrix;
+	// bottom and top of the orthographic view, the sides follow from the aspect ratio
+	glm::vec2 orthographic_vertical_span = glm::vec2(-1.0f, 1.0f);
 
 	glm::vec3 prev_focus;
 
@@ -85,7 +93,7 @@ private:
 
 	static constexpr float panning_sensitivity = 0.2f;
 	bool projection_is_perspective = true;
-	const float aspect_ratio;
+	float aspect_ratio;
 	const float fov = Maths::deg2rad(45.0f);
 	const float near_clipping = 0.1f;
 	const float far_clipping = 250.0f;
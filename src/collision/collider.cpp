@@ -8,10 +8,19 @@ Maths::Ray RayCollider::get_data() const
 
 	ray.origin = transform.get_mat4() * glm::vec4(data.origin, 1.0f);
 	ray.direction = glm::normalize(transform.get_orient() * data.direction);
+	ray.length = data.length;
 
 	return ray;
 }
 
+AABB RayCollider::get_bounding_box() const
+{
+	const auto ray = get_data();
+	const glm::vec3 end = ray.origin + ray.direction * ray.length;
+
+	return AABB(glm::min(ray.origin, end), glm::max(ray.origin, end));
+}
+
 Maths::Sphere SphereCollider::get_data() const
 {
 	Maths::Sphere sphere;
@@ -22,3 +31,55 @@ Maths::Sphere SphereCollider::get_data() const
 
 	return sphere;
 }
+
+AABB SphereCollider::get_bounding_box() const
+{
+	const auto sphere = get_data();
+
+	return AABB(sphere.origin - glm::vec3(sphere.radius), sphere.origin + glm::vec3(sphere.radius));
+}
+
+Maths::OBB BoxCollider::get_data() const
+{
+	Maths::OBB box;
+	const auto& transform = get_temporary_transform();
+
+	box.center = transform.get_mat4() * glm::vec4(data.center, 1.0f);
+	box.half_extents = transform.get_scale() * data.half_extents;
+	box.orientation = glm::mat3_cast(transform.get_orient()) * data.orientation;
+
+	return box;
+}
+
+AABB BoxCollider::get_bounding_box() const
+{
+	const auto box = get_data();
+	// extent along each world axis is the sum of the projected half extents
+	const glm::vec3 extent = 
+		glm::abs(box.orientation[0]) * box.half_extents.x +
+		glm::abs(box.orientation[1]) * box.half_extents.y +
+		glm::abs(box.orientation[2]) * box.half_extents.z;
+
+	return AABB(box.center - extent, box.center + extent);
+}
+
+Maths::Capsule CapsuleCollider::get_data() const
+{
+	Maths::Capsule capsule;
+	const auto& transform = get_temporary_transform();
+
+	capsule.start = transform.get_mat4() * glm::vec4(data.start, 1.0f);
+	capsule.end = transform.get_mat4() * glm::vec4(data.end, 1.0f);
+	capsule.radius = (transform.get_scale().x + transform.get_scale().y + transform.get_scale().z)/3.0f * data.radius;
+
+	return capsule;
+}
+
+AABB CapsuleCollider::get_bounding_box() const
+{
+	const auto capsule = get_data();
+
+	return AABB(
+		glm::min(capsule.start, capsule.end) - glm::vec3(capsule.radius), 
+		glm::max(capsule.start, capsule.end) + glm::vec3(capsule.radius));
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "bounding_box.hpp"
 #include "maths.hpp"
 
 
@@ -8,17 +9,23 @@ enum class ECollider
 	// MAIN COLLIDERS
 	RAY,
 	SPHERE,
-	// BOX,
-	// CAPSULE,
+	BOX,
+	CAPSULE,
 
 	// CUSTOM COLLIDERS
 
+	// number of collider types, keep last
+	COUNT
 };
 
 struct Collider
 {
+	virtual ~Collider() = default;
+
 	virtual ECollider get_type() const = 0;
 	virtual void apply_transform(const Maths::Transform& transform) {}
+	// world space bounds with the temporary transform applied, used by the broadphase
+	virtual AABB get_bounding_box() const = 0;
 
 	void set_temporary_transform(const Maths::Transform& transform) const { temporary_transform = transform; }
 	void clear_temporary_transform() const { temporary_transform = Maths::Transform{}; }
@@ -35,6 +42,7 @@ struct RayCollider : public Collider
 {
 	RayCollider(const Maths::Ray& ray) : data(ray) {}
 	virtual ECollider get_type() const override { return ECollider::RAY; }
+	virtual AABB get_bounding_box() const override;
 	Maths::Ray get_data() const;
 
 private:
@@ -46,8 +54,35 @@ struct SphereCollider : public Collider
 	SphereCollider() = default;
 	SphereCollider(const Maths::Sphere& sphere) : data(sphere) {}
 	virtual ECollider get_type() const override { return ECollider::SPHERE; }
+	virtual AABB get_bounding_box() const override;
 	Maths::Sphere get_data() const;
 
 private:
 	Maths::Sphere data;
 };
+
+struct BoxCollider : public Collider
+{
+	BoxCollider() = default;
+	BoxCollider(const Maths::OBB& box) : data(box) {}
+	virtual ECollider get_type() const override { return ECollider::BOX; }
+	virtual AABB get_bounding_box() const override;
+	// non uniform scale is applied along the box's local axes
+	Maths::OBB get_data() const;
+
+private:
+	Maths::OBB data;
+};
+
+struct CapsuleCollider : public Collider
+{
+	CapsuleCollider() = default;
+	CapsuleCollider(const Maths::Capsule& capsule) : data(capsule) {}
+	virtual ECollider get_type() const override { return ECollider::CAPSULE; }
+	virtual AABB get_bounding_box() const override;
+	// like the sphere the radius is scaled by the mean scale
+	Maths::Capsule get_data() const;
+
+private:
+	Maths::Capsule data;
+};
@@ -1,41 +1,119 @@
 #include "collision_detector.hpp"
+#include "narrowphase.hpp"
 
 
-std::unordered_map<CollisionType, CollisionDetector::SpecialisedCollisionDetector> CollisionDetector::detectors;
+std::array<std::array<CollisionDetector::SpecialisedCollisionDetector, CollisionDetector::NUM_COLLIDER_TYPES>, CollisionDetector::NUM_COLLIDER_TYPES> CollisionDetector::detectors;
 CollisionDetector CollisionDetector::instance;
 
 CollisionResult CollisionDetector::check_collision(const Collider* collider1, const Collider* collider2)
 {
-	const auto type1 = collider1->get_type();
-	const auto type2 = collider2->get_type();
-	auto it = detectors.find(CollisionType{ type1, type2 });
-	if (it != detectors.end())
+	const auto& detector = detectors[static_cast<size_t>(collider1->get_type())][static_cast<size_t>(collider2->get_type())];
+	if (detector)
 	{
-		return it->second(collider1, collider2);
+		return detector(collider1, collider2);
 	}
 
-	it = detectors.find(CollisionType{ type2, type1 });
-	if (it != detectors.end())
+	return CollisionResult{};
+}
+
+void CollisionDetector::add_collision_detector(const CollisionType& collision_type, SpecialisedCollisionDetector detector)
+{
+	const auto type1 = static_cast<size_t>(collision_type.collider1);
+	const auto type2 = static_cast<size_t>(collision_type.collider2);
+	if (type1 != type2)
 	{
-		return it->second(collider2, collider1);
+		detectors[type2][type1] = [detector](const Collider* collider2, const Collider* collider1)
+		{
+			auto result = detector(collider1, collider2);
+			result.normal = -result.normal;
+			return result;
+		};
 	}
+	detectors[type1][type2] = std::move(detector);
+}
 
-	return CollisionResult{};
+void CollisionDetector::remove_collision_detector(const CollisionType& collision_type)
+{
+	detectors[static_cast<size_t>(collision_type.collider1)][static_cast<size_t>(collision_type.collider2)] = nullptr;
+	detectors[static_cast<size_t>(collision_type.collider2)][static_cast<size_t>(collision_type.collider1)] = nullptr;
 }
 
 CollisionDetector::CollisionDetector()
 {
-	CollisionType ray_sphere{ ECollider::RAY, ECollider::SPHERE };
-	detectors.emplace(ray_sphere, [](const Collider* collider1, const Collider* collider2) -> CollisionResult
+	add_collision_detector({ ECollider::RAY, ECollider::SPHERE }, [](const Collider* collider1, const Collider* collider2) -> CollisionResult
 	{
 		const auto* ray = static_cast<const RayCollider*>(collider1);
 		const auto* sphere = static_cast<const SphereCollider*>(collider2);
 
-		auto res = Maths::ray_sphere_collision(sphere->get_data(), ray->get_data());
+		const auto ray_data = ray->get_data();
+		const auto sphere_data = sphere->get_data();
+		auto res = Maths::ray_sphere_collision(sphere_data, ray_data);
+		if (!res.has_value())
+		{
+			return CollisionResult{};
+		}
 
+		const glm::vec3 offset = sphere_data.origin - res.value();
 		return {
-			res.has_value(),
-			res.value_or(glm::vec3(0.0f))
+			true,
+			res.value(),
+			glm::length(offset) > 0.0f ? glm::normalize(offset) : ray_data.direction
 		};
 	});
-}
\ No newline at end of file
+
+	add_collision_detector({ ECollider::RAY, ECollider::BOX }, [](const Collider* collider1, const Collider* collider2)
+	{
+		return Narrowphase::ray_box(
+			static_cast<const RayCollider*>(collider1)->get_data(), 
+			static_cast<const BoxCollider*>(collider2)->get_data());
+	});
+
+	add_collision_detector({ ECollider::RAY, ECollider::CAPSULE }, [](const Collider* collider1, const Collider* collider2)
+	{
+		return Narrowphase::ray_capsule(
+			static_cast<const RayCollider*>(collider1)->get_data(), 
+			static_cast<const CapsuleCollider*>(collider2)->get_data());
+	});
+
+	add_collision_detector({ ECollider::SPHERE, ECollider::SPHERE }, [](const Collider* collider1, const Collider* collider2)
+	{
+		return Narrowphase::sphere_sphere(
+			static_cast<const SphereCollider*>(collider1)->get_data(), 
+			static_cast<const SphereCollider*>(collider2)->get_data());
+	});
+
+	add_collision_detector({ ECollider::SPHERE, ECollider::BOX }, [](const Collider* collider1, const Collider* collider2)
+	{
+		return Narrowphase::sphere_box(
+			static_cast<const SphereCollider*>(collider1)->get_data(), 
+			static_cast<const BoxCollider*>(collider2)->get_data());
+	});
+
+	add_collision_detector({ ECollider::SPHERE, ECollider::CAPSULE }, [](const Collider* collider1, const Collider* collider2)
+	{
+		return Narrowphase::sphere_capsule(
+			static_cast<const SphereCollider*>(collider1)->get_data(), 
+			static_cast<const CapsuleCollider*>(collider2)->get_data());
+	});
+
+	add_collision_detector({ ECollider::BOX, ECollider::BOX }, [](const Collider* collider1, const Collider* collider2)
+	{
+		return Narrowphase::box_box(
+			static_cast<const BoxCollider*>(collider1)->get_data(), 
+			static_cast<const BoxCollider*>(collider2)->get_data());
+	});
+
+	add_collision_detector({ ECollider::BOX, ECollider::CAPSULE }, [](const Collider* collider1, const Collider* collider2)
+	{
+		return Narrowphase::box_capsule(
+			static_cast<const BoxCollider*>(collider1)->get_data(), 
+			static_cast<const CapsuleCollider*>(collider2)->get_data());
+	});
+
+	add_collision_detector({ ECollider::CAPSULE, ECollider::CAPSULE }, [](const Collider* collider1, const Collider* collider2)
+	{
+		return Narrowphase::capsule_capsule(
+			static_cast<const CapsuleCollider*>(collider1)->get_data(), 
+			static_cast<const CapsuleCollider*>(collider2)->get_data());
+	});
+}
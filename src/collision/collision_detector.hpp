@@ -4,14 +4,19 @@
 
 #include <glm/vec3.hpp>
 
-#include <unordered_map>
+#include <array>
 #include <functional>
 
 
 struct CollisionResult
 {
 	bool bCollided = false;
-	glm::vec3 intersection;
+	// contact point, for rays the first point hit
+	glm::vec3 intersection = glm::vec3(0.0f);
+	// points from the first collider towards the second, 
+	// moving the second one by normal * penetration_depth separates them
+	glm::vec3 normal = glm::vec3(0.0f);
+	float penetration_depth = 0.0f;
 };
 
 struct CollisionType
@@ -42,20 +47,16 @@ public:
 
 	static CollisionResult check_collision(const Collider* collider1, const Collider* collider2);
 
-	static void add_collision_detector(const CollisionType& collision_type, SpecialisedCollisionDetector detector)
-	{
-		detectors.emplace(collision_type, std::move(detector));
-	}
-
-	static void remove_collision_detector(const CollisionType& collision_type)
-	{
-		detectors.erase(collision_type);
-	}
+	// also handles the swapped pair (collider2, collider1) by flipping the normal
+	static void add_collision_detector(const CollisionType& collision_type, SpecialisedCollisionDetector detector);
+	static void remove_collision_detector(const CollisionType& collision_type);
 
 private:
 	CollisionDetector();
 
 	static CollisionDetector instance;
 
-	static std::unordered_map<CollisionType, SpecialisedCollisionDetector> detectors;
+	static constexpr size_t NUM_COLLIDER_TYPES = static_cast<size_t>(ECollider::COUNT);
+	// dense [collider1][collider2] table, dispatch is a single lookup instead of hashing both orders
+	static std::array<std::array<SpecialisedCollisionDetector, NUM_COLLIDER_TYPES>, NUM_COLLIDER_TYPES> detectors;
 };
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "gjk.hpp"
+
+#include <glm/gtx/norm.hpp>
+
+#include <array>
+#include <initializer_list>
+#include <limits>
+#include <cmath>
+
+
+namespace
+{
+	// below this the shapes are considered to be touching
+	constexpr float INTERSECTION_DISTANCE = 1e-5f;
+
+	struct SimplexVertex
+	{
+		// w = a - b is a point of the Minkowski difference
+		glm::vec3 w;
+		glm::vec3 a;
+		glm::vec3 b;
+	};
+
+	struct Simplex
+	{
+		std::array<SimplexVertex, 4> vertices;
+		// barycentric coordinates of the closest point to the origin
+		std::array<float, 4> weights;
+		uint32_t size = 0;
+	};
+
+	// sub simplex of the given vertices with their barycentric weights
+	Simplex reduce(const Simplex& simplex, std::initializer_list<std::pair<uint32_t, float>> kept)
+	{
+		Simplex reduced;
+		for (const auto& [index, weight] : kept)
+		{
+			reduced.vertices[reduced.size] = simplex.vertices[index];
+			reduced.weights[reduced.size] = weight;
+			reduced.size++;
+		}
+
+		return reduced;
+	}
+
+	glm::vec3 closest_point(const Simplex& simplex)
+	{
+		glm::vec3 point(0.0f);
+		for (uint32_t i = 0; i < simplex.size; i++)
+		{
+			point += simplex.vertices[i].w * simplex.weights[i];
+		}
+
+		return point;
+	}
+
+	Simplex solve_segment(const Simplex& simplex, uint32_t i0, uint32_t i1)
+	{
+		const glm::vec3& a = simplex.vertices[i0].w;
+		const glm::vec3 ab = simplex.vertices[i1].w - a;
+		const float t = glm::dot(-a, ab);
+		if (t <= 0.0f)
+		{
+			return reduce(simplex, { { i0, 1.0f } });
+		}
+
+		const float denominator = glm::dot(ab, ab);
+		if (t >= denominator)
+		{
+			return reduce(simplex, { { i1, 1.0f } });
+		}
+
+		const float v = t / denominator;
+		return reduce(simplex, { { i0, 1.0f - v }, { i1, v } });
+	}
+
+	// Ericson 5.1.5 with the origin as the query point
+	Simplex solve_triangle(const Simplex& simplex, uint32_t i0, uint32_t i1, uint32_t i2)
+	{
+		const glm::vec3& a = simplex.vertices[i0].w;
+		const glm::vec3& b = simplex.vertices[i1].w;
+		const glm::vec3& c = simplex.vertices[i2].w;
+		const glm::vec3 ab = b - a;
+		const glm::vec3 ac = c - a;
+
+		const float d1 = glm::dot(ab, -a);
+		const float d2 = glm::dot(ac, -a);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+		{
+			return reduce(simplex, { { i0, 1.0f } });
+		}
+
+		const float d3 = glm::dot(ab, -b);
+		const float d4 = glm::dot(ac, -b);
+		if (d3 >= 0.0f && d4 <= d3)
+		{
+			return reduce(simplex, { { i1, 1.0f } });
+		}
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		{
+			const float v = d1 / (d1 - d3);
+			return reduce(simplex, { { i0, 1.0f - v }, { i1, v } });
+		}
+
+		const float d5 = glm::dot(ab, -c);
+		const float d6 = glm::dot(ac, -c);
+		if (d6 >= 0.0f && d5 <= d6)
+		{
+			return reduce(simplex, { { i2, 1.0f } });
+		}
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		{
+			const float w = d2 / (d2 - d6);
+			return reduce(simplex, { { i0, 1.0f - w }, { i2, w } });
+		}
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+		{
+			const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			return reduce(simplex, { { i1, 1.0f - w }, { i2, w } });
+		}
+
+		const float denominator = 1.0f / (va + vb + vc);
+		const float v = vb * denominator;
+		const float w = vc * denominator;
+		return reduce(simplex, { { i0, 1.0f - v - w }, { i1, v }, { i2, w } });
+	}
+
+	// the origin and d lie on opposite sides of the plane through abc
+	bool is_origin_outside_of_plane(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d)
+	{
+		const glm::vec3 normal = glm::cross(b - a, c - a);
+		const float sign_origin = glm::dot(-a, normal);
+		const float sign_d = glm::dot(d - a, normal);
+		// a flat tetrahedron has no inside, every face has to be tested
+		if (std::abs(sign_d) <= 1e-6f * glm::length(normal) * glm::length(d - a))
+		{
+			return true;
+		}
+
+		return sign_origin * sign_d < 0.0f;
+	}
+
+	// Ericson 5.1.6, the closest point is on one of the faces the origin is in front of
+	Simplex solve_tetrahedron(const Simplex& simplex, bool& contains_origin)
+	{
+		// the last index is the vertex opposite the face
+		constexpr std::array<std::array<uint32_t, 4>, 4> faces = { {
+			{ 0, 1, 2, 3 },
+			{ 0, 2, 3, 1 },
+			{ 0, 3, 1, 2 },
+			{ 1, 3, 2, 0 },
+		} };
+
+		contains_origin = true;
+		Simplex closest;
+		float closest_distance2 = std::numeric_limits<float>::max();
+		for (const auto& face : faces)
+		{
+			if (!is_origin_outside_of_plane(
+				simplex.vertices[face[0]].w, simplex.vertices[face[1]].w, simplex.vertices[face[2]].w, simplex.vertices[face[3]].w))
+			{
+				continue;
+			}
+
+			contains_origin = false;
+			const Simplex candidate = solve_triangle(simplex, face[0], face[1], face[2]);
+			const float distance2 = glm::length2(closest_point(candidate));
+			if (distance2 < closest_distance2)
+			{
+				closest = candidate;
+				closest_distance2 = distance2;
+			}
+		}
+
+		return contains_origin ? simplex : closest;
+	}
+}
+
+namespace GJK
+{
+	glm::vec3 Segment::support(const glm::vec3& direction) const
+	{
+		return glm::dot(direction, end - start) > 0.0f ? end : start;
+	}
+
+	glm::vec3 Box::support(const glm::vec3& direction) const
+	{
+		glm::vec3 point = box.center;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float sign = glm::dot(direction, box.orientation[axis]) >= 0.0f ? 1.0f : -1.0f;
+			point += box.orientation[axis] * (sign * box.half_extents[axis]);
+		}
+
+		return point;
+	}
+
+	Result distance(const Shape& a, const Shape& b, uint32_t max_iterations)
+	{
+		const auto support = [&a, &b](const glm::vec3& direction)
+		{
+			SimplexVertex vertex;
+			vertex.a = a.support(direction);
+			vertex.b = b.support(-direction);
+			vertex.w = vertex.a - vertex.b;
+			return vertex;
+		};
+
+		Result result;
+		Simplex simplex;
+		simplex.vertices[0] = support(glm::vec3(1.0f, 0.0f, 0.0f));
+		simplex.weights[0] = 1.0f;
+		simplex.size = 1;
+		glm::vec3 closest = simplex.vertices[0].w;
+
+		while (result.iterations < max_iterations)
+		{
+			result.iterations++;
+			const float distance2 = glm::length2(closest);
+			if (distance2 <= INTERSECTION_DISTANCE * INTERSECTION_DISTANCE)
+			{
+				result.intersecting = true;
+				break;
+			}
+
+			const SimplexVertex vertex = support(-closest);
+			// the support point is no further along the search direction, closest can't be improved upon
+			if (distance2 - glm::dot(closest, vertex.w) <= TOLERANCE * distance2)
+			{
+				break;
+			}
+
+			Simplex next = simplex;
+			next.vertices[next.size++] = vertex;
+			bool contains_origin = false;
+			switch (next.size)
+			{
+			case 2:
+				next = solve_segment(next, 0, 1);
+				break;
+			case 3:
+				next = solve_triangle(next, 0, 1, 2);
+				break;
+			default:
+				next = solve_tetrahedron(next, contains_origin);
+				break;
+			}
+
+			if (contains_origin)
+			{
+				result.intersecting = true;
+				break;
+			}
+
+			// the distance has to decrease strictly, otherwise rounding errors are making it cycle
+			const glm::vec3 next_closest = closest_point(next);
+			if (glm::length2(next_closest) >= distance2)
+			{
+				break;
+			}
+
+			simplex = next;
+			closest = next_closest;
+		}
+
+		if (result.intersecting)
+		{
+			return result;
+		}
+
+		for (uint32_t i = 0; i < simplex.size; i++)
+		{
+			result.closest_a += simplex.vertices[i].a * simplex.weights[i];
+			result.closest_b += simplex.vertices[i].b * simplex.weights[i];
+		}
+		result.distance = glm::length(closest);
+
+		return result;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "maths.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+
+
+//
+// Gilbert-Johnson-Keerthi distance between two convex shapes [Gilbert et al. 1988]
+//	iterates a simplex on the Minkowski difference A - B towards the origin,
+//	the closest point of the difference to the origin gives the separation and the witness points on each shape
+//	closest points on the simplex are found with the Voronoi region tests from Ericson's Real-Time Collision Detection
+//
+namespace GJK
+{
+	constexpr uint32_t MAX_ITERATIONS = 32;
+	// relative improvement of the squared distance below which the search has converged
+	constexpr float TOLERANCE = 1e-6f;
+
+	// convex shape described by its support mapping, the furthest point along a direction
+	struct Shape
+	{
+		virtual ~Shape() = default;
+		virtual glm::vec3 support(const glm::vec3& direction) const = 0;
+	};
+
+	struct Point : public Shape
+	{
+		Point(const glm::vec3& point) : point(point) {}
+		virtual glm::vec3 support(const glm::vec3&) const override { return point; }
+
+		glm::vec3 point;
+	};
+
+	struct Segment : public Shape
+	{
+		Segment(const glm::vec3& start, const glm::vec3& end) : start(start), end(end) {}
+		virtual glm::vec3 support(const glm::vec3& direction) const override;
+
+		glm::vec3 start;
+		glm::vec3 end;
+	};
+
+	struct Box : public Shape
+	{
+		Box(const Maths::OBB& box) : box(box) {}
+		virtual glm::vec3 support(const glm::vec3& direction) const override;
+
+		Maths::OBB box;
+	};
+
+	struct Result
+	{
+		// the shapes touch or overlap, distance and the closest points are then meaningless
+		bool intersecting = false;
+		float distance = 0.0f;
+		glm::vec3 closest_a = glm::vec3(0.0f);
+		glm::vec3 closest_b = glm::vec3(0.0f);
+		uint32_t iterations = 0;
+	};
+
+	Result distance(const Shape& a, const Shape& b, uint32_t max_iterations = MAX_ITERATIONS);
+}
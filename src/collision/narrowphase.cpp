@@ -0,0 +1,454 @@
+#include "narrowphase.hpp"
+#include "gjk.hpp"
+
+#include <glm/gtx/norm.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+
+namespace
+{
+	constexpr float EPSILON = 1e-6f;
+	// squared sine of the angle between two edges below which they are treated as parallel
+	constexpr float PARALLEL_EDGES = 1e-6f;
+	// edge-edge axes have to be noticeably better than a face axis to be picked,
+	// otherwise resting contacts flicker between them due to rounding
+	constexpr float EDGE_AXIS_WEIGHT = 1.05f;
+
+	// tracks the axis of least penetration while candidate separating axes are tested
+	struct SeparatingAxes
+	{
+		SeparatingAxes(const glm::vec3& offset) : offset(offset) {}
+
+		// false if the axis separates the shapes, radii are the half lengths of their projections
+		bool test(const glm::vec3& axis, float radius1, float radius2, float weight = 1.0f)
+		{
+			const float distance = glm::dot(offset, axis);
+			const float overlap = radius1 + radius2 - std::abs(distance);
+			if (overlap < 0.0f)
+			{
+				return false;
+			}
+
+			if (overlap * weight < min_weighted_overlap)
+			{
+				min_weighted_overlap = overlap * weight;
+				min_overlap = overlap;
+				min_axis = distance < 0.0f ? -axis : axis;
+			}
+
+			return true;
+		}
+
+		// from the first shape's center to the second's
+		glm::vec3 offset;
+		float min_overlap = std::numeric_limits<float>::max();
+		float min_weighted_overlap = std::numeric_limits<float>::max();
+		glm::vec3 min_axis = Maths::up_vec;
+	};
+
+	float project_box(const Maths::OBB& box, const glm::vec3& axis)
+	{
+		return 
+			box.half_extents.x * std::abs(glm::dot(axis, box.orientation[0])) +
+			box.half_extents.y * std::abs(glm::dot(axis, box.orientation[1])) +
+			box.half_extents.z * std::abs(glm::dot(axis, box.orientation[2]));
+	}
+
+	// center of the face, edge or vertex of the box furthest along direction
+	glm::vec3 support_feature(const Maths::OBB& box, const glm::vec3& direction)
+	{
+		glm::vec3 point = box.center;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float distance = glm::dot(direction, box.orientation[axis]);
+			if (std::abs(distance) > 1e-3f)
+			{
+				point += box.orientation[axis] * (distance > 0.0f ? box.half_extents[axis] : -box.half_extents[axis]);
+			}
+		}
+
+		return point;
+	}
+
+	// distance along the ray to the first hit, negative if it misses
+	float ray_sphere_distance(const Maths::Ray& ray, const glm::vec3& center, float radius)
+	{
+		const glm::vec3 offset = ray.origin - center;
+		const float b = glm::dot(offset, ray.direction);
+		const float c = glm::dot(offset, offset) - radius * radius;
+		const float discriminant = b * b - c;
+		if (discriminant < 0.0f)
+		{
+			return -1.0f;
+		}
+
+		return -b - std::sqrt(discriminant);
+	}
+}
+
+namespace Narrowphase
+{
+	glm::vec3 closest_point_on_segment(const glm::vec3& point, const glm::vec3& start, const glm::vec3& end)
+	{
+		const glm::vec3 segment = end - start;
+		const float length2 = glm::dot(segment, segment);
+		if (length2 <= EPSILON * EPSILON)
+		{
+			return start;
+		}
+
+		const float t = std::clamp(glm::dot(point - start, segment) / length2, 0.0f, 1.0f);
+		return start + segment * t;
+	}
+
+	glm::vec3 closest_point_on_box(const glm::vec3& point, const Maths::OBB& box)
+	{
+		const glm::vec3 offset = point - box.center;
+		glm::vec3 closest = box.center;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float distance = std::clamp(glm::dot(offset, box.orientation[axis]), -box.half_extents[axis], box.half_extents[axis]);
+			closest += box.orientation[axis] * distance;
+		}
+
+		return closest;
+	}
+
+	void closest_points_between_segments(
+		const glm::vec3& start1, const glm::vec3& end1,
+		const glm::vec3& start2, const glm::vec3& end2,
+		glm::vec3& closest1, glm::vec3& closest2)
+	{
+		const glm::vec3 direction1 = end1 - start1;
+		const glm::vec3 direction2 = end2 - start2;
+		const glm::vec3 offset = start1 - start2;
+		const float length1 = glm::dot(direction1, direction1);
+		const float length2 = glm::dot(direction2, direction2);
+		const float f = glm::dot(direction2, offset);
+
+		float s = 0.0f;
+		float t = 0.0f;
+		if (length1 <= EPSILON && length2 <= EPSILON)
+		{
+			// both degenerate into points
+		} else if (length1 <= EPSILON)
+		{
+			t = std::clamp(f / length2, 0.0f, 1.0f);
+		} else
+		{
+			const float c = glm::dot(direction1, offset);
+			if (length2 <= EPSILON)
+			{
+				s = std::clamp(-c / length1, 0.0f, 1.0f);
+			} else
+			{
+				const float b = glm::dot(direction1, direction2);
+				const float denominator = length1 * length2 - b * b;
+				// parallel segments have no unique closest points, any s works
+				if (denominator > EPSILON * length1 * length2)
+				{
+					s = std::clamp((b * f - c * length2) / denominator, 0.0f, 1.0f);
+				}
+
+				t = (b * s + f) / length2;
+				if (t < 0.0f)
+				{
+					t = 0.0f;
+					s = std::clamp(-c / length1, 0.0f, 1.0f);
+				} else if (t > 1.0f)
+				{
+					t = 1.0f;
+					s = std::clamp((b - c) / length1, 0.0f, 1.0f);
+				}
+			}
+		}
+
+		closest1 = start1 + direction1 * s;
+		closest2 = start2 + direction2 * t;
+	}
+
+	CollisionResult sphere_sphere(const Maths::Sphere& sphere1, const Maths::Sphere& sphere2)
+	{
+		const glm::vec3 offset = sphere2.origin - sphere1.origin;
+		const float distance2 = glm::length2(offset);
+		const float radii = sphere1.radius + sphere2.radius;
+		if (distance2 > radii * radii)
+		{
+			return CollisionResult{};
+		}
+
+		const float distance = std::sqrt(distance2);
+		CollisionResult result;
+		result.bCollided = true;
+		// concentric spheres can be separated in any direction
+		result.normal = distance > EPSILON ? offset / distance : Maths::up_vec;
+		result.penetration_depth = radii - distance;
+		// halfway between the two deepest points
+		result.intersection = sphere1.origin + result.normal * (sphere1.radius - result.penetration_depth * 0.5f);
+
+		return result;
+	}
+
+	CollisionResult sphere_box(const Maths::Sphere& sphere, const Maths::OBB& box)
+	{
+		const glm::vec3 closest = closest_point_on_box(sphere.origin, box);
+		const glm::vec3 offset = closest - sphere.origin;
+		const float distance2 = glm::length2(offset);
+		if (distance2 > sphere.radius * sphere.radius)
+		{
+			return CollisionResult{};
+		}
+
+		CollisionResult result;
+		result.bCollided = true;
+		if (distance2 > EPSILON * EPSILON)
+		{
+			const float distance = std::sqrt(distance2);
+			result.normal = offset / distance;
+			result.penetration_depth = sphere.radius - distance;
+			result.intersection = closest + result.normal * (result.penetration_depth * 0.5f);
+
+			return result;
+		}
+
+		// the center is inside the box, the sphere has to leave through the nearest face
+		int nearest_axis = 0;
+		float nearest_distance = std::numeric_limits<float>::max();
+		float side = 1.0f;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float local = glm::dot(sphere.origin - box.center, box.orientation[axis]);
+			const float distance = box.half_extents[axis] - std::abs(local);
+			if (distance < nearest_distance)
+			{
+				nearest_axis = axis;
+				nearest_distance = distance;
+				side = local >= 0.0f ? 1.0f : -1.0f;
+			}
+		}
+		result.normal = -box.orientation[nearest_axis] * side;
+		result.penetration_depth = sphere.radius + nearest_distance;
+		result.intersection = sphere.origin;
+
+		return result;
+	}
+
+	CollisionResult sphere_capsule(const Maths::Sphere& sphere, const Maths::Capsule& capsule)
+	{
+		const glm::vec3 closest = closest_point_on_segment(sphere.origin, capsule.start, capsule.end);
+		return sphere_sphere(sphere, Maths::Sphere(closest, capsule.radius));
+	}
+
+	CollisionResult capsule_capsule(const Maths::Capsule& capsule1, const Maths::Capsule& capsule2)
+	{
+		glm::vec3 closest1;
+		glm::vec3 closest2;
+		closest_points_between_segments(capsule1.start, capsule1.end, capsule2.start, capsule2.end, closest1, closest2);
+
+		return sphere_sphere(Maths::Sphere(closest1, capsule1.radius), Maths::Sphere(closest2, capsule2.radius));
+	}
+
+	CollisionResult box_box(const Maths::OBB& box1, const Maths::OBB& box2)
+	{
+		SeparatingAxes axes(box2.center - box1.center);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (!axes.test(box1.orientation[axis], box1.half_extents[axis], project_box(box2, box1.orientation[axis])))
+			{
+				return CollisionResult{};
+			}
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (!axes.test(box2.orientation[axis], project_box(box1, box2.orientation[axis]), box2.half_extents[axis]))
+			{
+				return CollisionResult{};
+			}
+		}
+		for (int axis1 = 0; axis1 < 3; axis1++)
+		{
+			for (int axis2 = 0; axis2 < 3; axis2++)
+			{
+				const glm::vec3 edge_axis = glm::cross(box1.orientation[axis1], box2.orientation[axis2]);
+				const float length2 = glm::length2(edge_axis);
+				// parallel edges are already covered by the face axes
+				if (length2 < PARALLEL_EDGES)
+				{
+					continue;
+				}
+
+				const glm::vec3 axis = edge_axis / std::sqrt(length2);
+				if (!axes.test(axis, project_box(box1, axis), project_box(box2, axis), EDGE_AXIS_WEIGHT))
+				{
+					return CollisionResult{};
+				}
+			}
+		}
+
+		CollisionResult result;
+		result.bCollided = true;
+		result.normal = axes.min_axis;
+		result.penetration_depth = axes.min_overlap;
+		// the touching features of each box clamped into the other one, their midpoint lies in the contact region
+		const glm::vec3 contact1 = closest_point_on_box(support_feature(box1, result.normal), box2);
+		const glm::vec3 contact2 = closest_point_on_box(support_feature(box2, -result.normal), box1);
+		result.intersection = (contact1 + contact2) * 0.5f;
+
+		return result;
+	}
+
+	CollisionResult box_capsule(const Maths::OBB& box, const Maths::Capsule& capsule)
+	{
+		const auto distance = GJK::distance(GJK::Box(box), GJK::Segment(capsule.start, capsule.end));
+		if (!distance.intersecting)
+		{
+			if (distance.distance > capsule.radius)
+			{
+				return CollisionResult{};
+			}
+
+			CollisionResult result;
+			result.bCollided = true;
+			result.normal = (distance.closest_b - distance.closest_a) / distance.distance;
+			result.penetration_depth = capsule.radius - distance.distance;
+			result.intersection = distance.closest_a - result.normal * (result.penetration_depth * 0.5f);
+
+			return result;
+		}
+
+		// the core segment is inside the box, GJK has no depth to offer so find the axis of least penetration
+		const glm::vec3 segment = capsule.end - capsule.start;
+		SeparatingAxes axes((capsule.start + capsule.end) * 0.5f - box.center);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const glm::vec3& box_axis = box.orientation[axis];
+			axes.test(box_axis, box.half_extents[axis], std::abs(glm::dot(segment, box_axis)) * 0.5f + capsule.radius);
+
+			const glm::vec3 edge_axis = glm::cross(box_axis, segment);
+			const float length2 = glm::length2(edge_axis);
+			if (length2 < PARALLEL_EDGES * glm::length2(segment))
+			{
+				continue;
+			}
+			const glm::vec3 unit_edge_axis = edge_axis / std::sqrt(length2);
+			axes.test(unit_edge_axis, project_box(box, unit_edge_axis), capsule.radius, EDGE_AXIS_WEIGHT);
+		}
+
+		CollisionResult result;
+		result.bCollided = true;
+		result.normal = axes.min_axis;
+		result.penetration_depth = axes.min_overlap;
+		result.intersection = closest_point_on_box(closest_point_on_segment(box.center, capsule.start, capsule.end), box);
+
+		return result;
+	}
+
+	CollisionResult ray_box(const Maths::Ray& ray, const Maths::OBB& box)
+	{
+		const glm::vec3 offset = ray.origin - box.center;
+		float t_min = 0.0f;
+		float t_max = std::numeric_limits<float>::max();
+		glm::vec3 entry_normal = ray.direction;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float origin = glm::dot(offset, box.orientation[axis]);
+			const float direction = glm::dot(ray.direction, box.orientation[axis]);
+			if (std::abs(direction) < EPSILON)
+			{
+				// parallel to the slab, it has to start between the two faces
+				if (std::abs(origin) > box.half_extents[axis])
+				{
+					return CollisionResult{};
+				}
+				continue;
+			}
+
+			float t0 = (-box.half_extents[axis] - origin) / direction;
+			float t1 = (box.half_extents[axis] - origin) / direction;
+			// the ray enters through the face it is travelling towards
+			float face = -1.0f;
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+				face = 1.0f;
+			}
+			if (t0 > t_min)
+			{
+				t_min = t0;
+				entry_normal = -box.orientation[axis] * face;
+			}
+			t_max = std::min(t_max, t1);
+			if (t_min > t_max)
+			{
+				return CollisionResult{};
+			}
+		}
+
+		CollisionResult result;
+		result.bCollided = true;
+		result.intersection = ray.origin + ray.direction * t_min;
+		result.normal = entry_normal;
+
+		return result;
+	}
+
+	CollisionResult ray_capsule(const Maths::Ray& ray, const Maths::Capsule& capsule)
+	{
+		CollisionResult result;
+		if (glm::distance2(closest_point_on_segment(ray.origin, capsule.start, capsule.end), ray.origin) < capsule.radius * capsule.radius)
+		{
+			result.bCollided = true;
+			result.intersection = ray.origin;
+			result.normal = ray.direction;
+			return result;
+		}
+
+		// the first hit is either on one of the hemispherical caps or on the cylinder in between
+		float t = std::numeric_limits<float>::max();
+		for (const auto& cap : { capsule.start, capsule.end })
+		{
+			const float t_cap = ray_sphere_distance(ray, cap, capsule.radius);
+			if (t_cap >= 0.0f)
+			{
+				t = std::min(t, t_cap);
+			}
+		}
+
+		const glm::vec3 axis = capsule.end - capsule.start;
+		const glm::vec3 offset = ray.origin - capsule.start;
+		const float axis_axis = glm::dot(axis, axis);
+		const float axis_direction = glm::dot(axis, ray.direction);
+		const float axis_offset = glm::dot(axis, offset);
+		// the cylinder's quadratic, degenerate when the ray runs parallel to the axis in which case the caps are hit first
+		const float a = axis_axis - axis_direction * axis_direction;
+		if (a > EPSILON * axis_axis)
+		{
+			const float b = axis_axis * glm::dot(offset, ray.direction) - axis_offset * axis_direction;
+			const float c = axis_axis * glm::dot(offset, offset) - axis_offset * axis_offset - capsule.radius * capsule.radius * axis_axis;
+			const float discriminant = b * b - a * c;
+			if (discriminant >= 0.0f)
+			{
+				const float t_cylinder = (-b - std::sqrt(discriminant)) / a;
+				const float along_axis = axis_offset + t_cylinder * axis_direction;
+				if (t_cylinder >= 0.0f && along_axis > 0.0f && along_axis < axis_axis)
+				{
+					t = std::min(t, t_cylinder);
+				}
+			}
+		}
+
+		if (t == std::numeric_limits<float>::max())
+		{
+			return result;
+		}
+
+		result.bCollided = true;
+		result.intersection = ray.origin + ray.direction * t;
+		result.normal = glm::normalize(closest_point_on_segment(result.intersection, capsule.start, capsule.end) - result.intersection);
+
+		return result;
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "collision_detector.hpp"
+#include "maths.hpp"
+
+#include <glm/vec3.hpp>
+
+
+//
+// exact tests between pairs of primitive shapes, the normal of the results always points from the first shape to the second
+//	spheres and capsules reduce to closest points between their cores, boxes use the separating axis theorem
+//	and box-capsule uses GJK for the distance between the box and the capsule's core segment
+//	only a single contact point is produced, there is no contact manifold
+//
+namespace Narrowphase
+{
+	glm::vec3 closest_point_on_segment(const glm::vec3& point, const glm::vec3& start, const glm::vec3& end);
+	glm::vec3 closest_point_on_box(const glm::vec3& point, const Maths::OBB& box);
+	// [Ericson 2005, 5.1.9]
+	void closest_points_between_segments(
+		const glm::vec3& start1, const glm::vec3& end1,
+		const glm::vec3& start2, const glm::vec3& end2,
+		glm::vec3& closest1, glm::vec3& closest2);
+
+	CollisionResult sphere_sphere(const Maths::Sphere& sphere1, const Maths::Sphere& sphere2);
+	CollisionResult sphere_box(const Maths::Sphere& sphere, const Maths::OBB& box);
+	CollisionResult sphere_capsule(const Maths::Sphere& sphere, const Maths::Capsule& capsule);
+	CollisionResult capsule_capsule(const Maths::Capsule& capsule1, const Maths::Capsule& capsule2);
+	// 15 axis separating axis test, the axis of least penetration gives the normal
+	CollisionResult box_box(const Maths::OBB& box1, const Maths::OBB& box2);
+	CollisionResult box_capsule(const Maths::OBB& box, const Maths::Capsule& capsule);
+
+	// like Maths::ray_sphere_collision a ray starting inside the shape hits at its origin
+	CollisionResult ray_box(const Maths::Ray& ray, const Maths::OBB& box);
+	CollisionResult ray_capsule(const Maths::Ray& ray, const Maths::Capsule& capsule);
+}
@@ -0,0 +1,355 @@
+#include "spatial_hash.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <glm/gtx/component_wise.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+
+namespace
+{
+	// 21 bits per axis, cells further out than ±2^20 wrap around and share a key which is only a little slower
+	constexpr int KEY_BITS = 21;
+	constexpr uint64_t KEY_MASK = (uint64_t(1) << KEY_BITS) - 1;
+
+	int decode_axis(uint64_t bits)
+	{
+		// sign extend
+		return int(int64_t(bits << (64 - KEY_BITS)) >> (64 - KEY_BITS));
+	}
+
+	int get_ring(const glm::ivec3& coord, const glm::ivec3& center)
+	{
+		return glm::compMax(glm::abs(coord - center));
+	}
+
+	using Candidate = std::pair<float, ObjectID>;
+}
+
+SpatialHash::SpatialHash(float cell_size) :
+	cell_size(cell_size),
+	inv_cell_size(1.0f / cell_size)
+{
+	if (!(cell_size > 0.0f))
+	{
+		throw std::runtime_error("SpatialHash::SpatialHash: cell size must be positive");
+	}
+}
+
+void SpatialHash::insert(ObjectID id, const glm::vec3& position)
+{
+	const auto [it, inserted] = id_to_item.emplace(id, uint32_t(items.size()));
+	if (!inserted)
+	{
+		throw std::runtime_error("SpatialHash::insert: id is already in the hash");
+	}
+
+	items.push_back(Item{});
+	add_to_cell(it->second, get_cell_key(get_cell_coord(position)), id, position);
+}
+
+void SpatialHash::update(ObjectID id, const glm::vec3& position)
+{
+	const auto it = id_to_item.find(id);
+	if (it == id_to_item.end())
+	{
+		throw std::runtime_error("SpatialHash::update: id is not in the hash");
+	}
+
+	const Item& item = items[it->second];
+	const CellKey key = get_cell_key(get_cell_coord(position));
+	if (key == item.key)
+	{
+		item.cell->entries[item.index_in_cell].position = position;
+	} else
+	{
+		remove_from_cell(it->second);
+		add_to_cell(it->second, key, id, position);
+	}
+}
+
+void SpatialHash::remove(ObjectID id)
+{
+	const auto it = id_to_item.find(id);
+	if (it == id_to_item.end())
+	{
+		throw std::runtime_error("SpatialHash::remove: id is not in the hash");
+	}
+
+	const uint32_t index = it->second;
+	remove_from_cell(index);
+	id_to_item.erase(it);
+
+	// keep the items dense by moving the last one into the hole
+	const uint32_t last = uint32_t(items.size() - 1);
+	if (index != last)
+	{
+		items[index] = items[last];
+		Entry& moved = items[index].cell->entries[items[index].index_in_cell];
+		moved.item = index;
+		id_to_item[moved.id] = index;
+	}
+	items.pop_back();
+}
+
+void SpatialHash::clear()
+{
+	items.clear();
+	id_to_item.clear();
+	cells.clear();
+}
+
+const glm::vec3& SpatialHash::get_position(ObjectID id) const
+{
+	const auto it = id_to_item.find(id);
+	if (it == id_to_item.end())
+	{
+		throw std::runtime_error("SpatialHash::get_position: id is not in the hash");
+	}
+	const Item& item = items[it->second];
+	return item.cell->entries[item.index_in_cell].position;
+}
+
+void SpatialHash::query_radius(const glm::vec3& center, float radius, std::vector<ObjectID>& result) const
+{
+	if (radius < 0.0f)
+	{
+		return;
+	}
+
+	const glm::ivec3 first = get_cell_coord(center - glm::vec3(radius));
+	const glm::ivec3 last = get_cell_coord(center + glm::vec3(radius));
+	const float radius2 = radius * radius;
+	const auto test_cell = [&](const Cell& cell)
+	{
+		for (const Entry& entry : cell.entries)
+		{
+			if (glm::distance2(entry.position, center) <= radius2)
+			{
+				result.push_back(entry.id);
+			}
+		}
+	};
+
+	// a huge radius touches more cells than are occupied, then it's cheaper to walk the occupied ones
+	const glm::dvec3 range = glm::dvec3(last - first) + 1.0;
+	if (range.x * range.y * range.z > double(cells.size()))
+	{
+		for (const auto& [key, cell] : cells)
+		{
+			const glm::ivec3 coord = get_cell_coord(key);
+			if (glm::all(glm::greaterThanEqual(coord, first)) && glm::all(glm::lessThanEqual(coord, last)))
+			{
+				test_cell(cell);
+			}
+		}
+		return;
+	}
+
+	for (int z = first.z; z <= last.z; z++)
+	{
+		for (int y = first.y; y <= last.y; y++)
+		{
+			for (int x = first.x; x <= last.x; x++)
+			{
+				if (const Cell* cell = find_cell(glm::ivec3(x, y, z)))
+				{
+					test_cell(*cell);
+				}
+			}
+		}
+	}
+}
+
+void SpatialHash::query_box(const AABB& box, std::vector<ObjectID>& result) const
+{
+	if (!glm::all(glm::lessThanEqual(box.min_bound, box.max_bound)))
+	{
+		return;
+	}
+
+	const glm::ivec3 first = get_cell_coord(box.min_bound);
+	const glm::ivec3 last = get_cell_coord(box.max_bound);
+	const auto test_cell = [&](const Cell& cell)
+	{
+		for (const Entry& entry : cell.entries)
+		{
+			if (glm::all(glm::greaterThanEqual(entry.position, box.min_bound)) && glm::all(glm::lessThanEqual(entry.position, box.max_bound)))
+			{
+				result.push_back(entry.id);
+			}
+		}
+	};
+
+	const glm::dvec3 range = glm::dvec3(last - first) + 1.0;
+	if (range.x * range.y * range.z > double(cells.size()))
+	{
+		for (const auto& [key, cell] : cells)
+		{
+			const glm::ivec3 coord = get_cell_coord(key);
+			if (glm::all(glm::greaterThanEqual(coord, first)) && glm::all(glm::lessThanEqual(coord, last)))
+			{
+				test_cell(cell);
+			}
+		}
+		return;
+	}
+
+	for (int z = first.z; z <= last.z; z++)
+	{
+		for (int y = first.y; y <= last.y; y++)
+		{
+			for (int x = first.x; x <= last.x; x++)
+			{
+				if (const Cell* cell = find_cell(glm::ivec3(x, y, z)))
+				{
+					test_cell(*cell);
+				}
+			}
+		}
+	}
+}
+
+std::vector<ObjectID> SpatialHash::query_nearest(const glm::vec3& center, size_t k) const
+{
+	k = std::min(k, items.size());
+	if (k == 0)
+	{
+		return {};
+	}
+
+	// max heap on (distance, id), the top is the worst of the best k so far
+	std::vector<Candidate> best;
+	best.reserve(k + 1);
+	const auto test_cell = [&](const Cell& cell)
+	{
+		for (const Entry& entry : cell.entries)
+		{
+			const Candidate candidate(glm::distance2(entry.position, center), entry.id);
+			if (best.size() < k)
+			{
+				best.push_back(candidate);
+				std::push_heap(best.begin(), best.end());
+			} else if (candidate < best.front())
+			{
+				std::pop_heap(best.begin(), best.end());
+				best.back() = candidate;
+				std::push_heap(best.begin(), best.end());
+			}
+		}
+	};
+
+	// rings of cells around the center cell, ring r is the shell of the (2r+1)^3 block
+	// everything outside the visited block is at least r cells plus the gap to the nearest face of the center cell away
+	const glm::ivec3 center_cell = get_cell_coord(center);
+	const glm::vec3 local = center * inv_cell_size - glm::vec3(center_cell);
+	const float face_gap = glm::compMin(glm::min(local, 1.0f - local)) * cell_size;
+	size_t num_visited = 0;
+	for (int ring = 0; ; ring++)
+	{
+		const double shell_cells = std::pow(2.0 * ring + 1.0, 3.0) - (ring > 0 ? std::pow(2.0 * ring - 1.0, 3.0) : 0.0);
+		if (shell_cells > double(cells.size()))
+		{
+			// the rings have outgrown the occupied cells, finish by walking the ones that haven't been visited yet
+			for (const auto& [key, cell] : cells)
+			{
+				if (get_ring(get_cell_coord(key), center_cell) >= ring)
+				{
+					test_cell(cell);
+				}
+			}
+			break;
+		}
+
+		for (int z = -ring; z <= ring; z++)
+		{
+			for (int y = -ring; y <= ring; y++)
+			{
+				const bool on_shell = std::abs(z) == ring || std::abs(y) == ring;
+				const int step = on_shell ? 1 : std::max(2 * ring, 1);
+				for (int x = -ring; x <= ring; x += step)
+				{
+					if (const Cell* cell = find_cell(center_cell + glm::ivec3(x, y, z)))
+					{
+						test_cell(*cell);
+						num_visited += cell->entries.size();
+					}
+				}
+			}
+		}
+
+		if (num_visited == items.size())
+		{
+			break;
+		}
+		const float reach = float(ring) * cell_size + face_gap;
+		if (best.size() == k && best.front().first <= reach * reach)
+		{
+			break;
+		}
+	}
+
+	std::sort_heap(best.begin(), best.end());
+	std::vector<ObjectID> result;
+	result.reserve(best.size());
+	for (const auto& [distance2, id] : best)
+	{
+		result.push_back(id);
+	}
+
+	return result;
+}
+
+glm::ivec3 SpatialHash::get_cell_coord(const glm::vec3& position) const
+{
+	return glm::ivec3(glm::floor(position * inv_cell_size));
+}
+
+SpatialHash::CellKey SpatialHash::get_cell_key(const glm::ivec3& coord)
+{
+	return (uint64_t(uint32_t(coord.x)) & KEY_MASK) |
+		((uint64_t(uint32_t(coord.y)) & KEY_MASK) << KEY_BITS) |
+		((uint64_t(uint32_t(coord.z)) & KEY_MASK) << (2 * KEY_BITS));
+}
+
+glm::ivec3 SpatialHash::get_cell_coord(CellKey key)
+{
+	return glm::ivec3(
+		decode_axis(key & KEY_MASK),
+		decode_axis((key >> KEY_BITS) & KEY_MASK),
+		decode_axis((key >> (2 * KEY_BITS)) & KEY_MASK));
+}
+
+const SpatialHash::Cell* SpatialHash::find_cell(const glm::ivec3& coord) const
+{
+	const auto it = cells.find(get_cell_key(coord));
+	return it == cells.end() ? nullptr : &it->second;
+}
+
+void SpatialHash::add_to_cell(uint32_t item_index, CellKey key, ObjectID id, const glm::vec3& position)
+{
+	Item& item = items[item_index];
+	item.key = key;
+	item.cell = &cells[key];
+	item.index_in_cell = uint32_t(item.cell->entries.size());
+	item.cell->entries.push_back(Entry{ position, id, item_index });
+}
+
+void SpatialHash::remove_from_cell(uint32_t item_index)
+{
+	const Item& item = items[item_index];
+	auto& entries = item.cell->entries;
+	const Entry& moved = entries.back();
+	items[moved.item].index_in_cell = item.index_in_cell;
+	entries[item.index_in_cell] = moved;
+	entries.pop_back();
+
+	// empty cells are dropped so the map only ever holds occupied ones
+	if (entries.empty())
+	{
+		cells.erase(item.key);
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "bounding_box.hpp"
+#include "identifications.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+
+//
+// uniform grid of cubic cells over points, only the occupied cells are stored in a hash map [Ericson 2005, 7.1.6]
+//	a query only visits the cells its volume touches, so its cost depends on the local density rather than on the total count
+//	moving a point only touches the buckets when it crosses into another cell
+//	cells should be about the size of a typical query radius, much smaller and queries visit many empty cells,
+//	much larger and they distance test many points that are out of range
+//
+class SpatialHash
+{
+public:
+	static constexpr float DEFAULT_CELL_SIZE = 4.0f;
+
+	SpatialHash(float cell_size = DEFAULT_CELL_SIZE);
+
+	void insert(ObjectID id, const glm::vec3& position);
+	void update(ObjectID id, const glm::vec3& position);
+	void remove(ObjectID id);
+	void clear();
+
+	bool contains(ObjectID id) const { return id_to_item.contains(id); }
+	const glm::vec3& get_position(ObjectID id) const;
+	size_t size() const { return items.size(); }
+	float get_cell_size() const { return cell_size; }
+	size_t get_num_cells() const { return cells.size(); }
+
+	// ids are appended to result in no particular order, the range and box are inclusive
+	void query_radius(const glm::vec3& center, float radius, std::vector<ObjectID>& result) const;
+	void query_box(const AABB& box, std::vector<ObjectID>& result) const;
+	// up to k ids sorted by increasing distance, ties are broken by the smaller id
+	std::vector<ObjectID> query_nearest(const glm::vec3& center, size_t k) const;
+
+private:
+	using CellKey = uint64_t;
+
+	struct CellKeyHash
+	{
+		size_t operator()(CellKey key) const
+		{
+			// the packed coordinates differ in few bits, spread them out before they are reduced to a bucket
+			key ^= key >> 33;
+			key *= 0xff51afd7ed558ccdull;
+			key ^= key >> 33;
+			return size_t(key);
+		}
+	};
+
+	// queries only walk the cells, so they carry a copy of the position instead of looking up the item
+	struct Entry
+	{
+		glm::vec3 position;
+		ObjectID id;
+		uint32_t item;
+	};
+
+	struct Cell
+	{
+		std::vector<Entry> entries;
+	};
+
+	struct Item
+	{
+		CellKey key;
+		// nodes of the map never move, so this stays valid for as long as the cell is occupied
+		Cell* cell;
+		// where the item sits in its cell, so removal is a swap with the back
+		uint32_t index_in_cell;
+	};
+
+	glm::ivec3 get_cell_coord(const glm::vec3& position) const;
+	static CellKey get_cell_key(const glm::ivec3& coord);
+	static glm::ivec3 get_cell_coord(CellKey key);
+
+	const Cell* find_cell(const glm::ivec3& coord) const;
+	void add_to_cell(uint32_t item_index, CellKey key, ObjectID id, const glm::vec3& position);
+	void remove_from_cell(uint32_t item_index);
+
+	float cell_size;
+	float inv_cell_size;
+
+	std::vector<Item> items;
+	std::unordered_map<ObjectID, uint32_t> id_to_item;
+	std::unordered_map<CellKey, Cell, CellKeyHash> cells;
+};
@@ -0,0 +1,346 @@
+#include "sweep_and_prune.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+
+namespace
+{
+	// the sort axis is only replaced once another one is clearly better, switching rebuilds the grid
+	constexpr float AXIS_SWITCH_RATIO = 1.5f;
+	// once more than 1 / FULL_SORT_RATIO of a cell's entries are new (unsorted) a full sort beats the insertion sort
+	constexpr size_t FULL_SORT_RATIO = 8;
+	// in multiples of the mean bounds size, smaller cells put too many bounds into several cells at once
+	constexpr float MIN_CELL_SIZE = 2.0f;
+	constexpr uint32_t MAX_CELLS_PER_AXIS = 64;
+	// the grid is rebuilt once the spread of the bounds calls for this many times more or fewer cells
+	constexpr uint32_t REBUILD_RATIO = 2;
+}
+
+SweepAndPrune::ProxyID SweepAndPrune::add(ObjectID id, const AABB& bounds)
+{
+	ProxyID proxy;
+	if (free_proxies.empty())
+	{
+		proxy = static_cast<ProxyID>(proxies.size());
+		proxies.emplace_back();
+	} else
+	{
+		proxy = free_proxies.back();
+		free_proxies.pop_back();
+	}
+
+	// entries are created by the next update
+	proxies[proxy] = Proxy{ id, bounds, true, CellRange{} };
+	num_active++;
+
+	return proxy;
+}
+
+void SweepAndPrune::remove(ProxyID proxy)
+{
+	if (proxy >= proxies.size() || !proxies[proxy].active)
+	{
+		throw std::runtime_error("SweepAndPrune::remove: proxy is not in use");
+	}
+
+	auto& removed = proxies[proxy];
+	removed.active = false;
+	for (uint32_t y = removed.cells.first.y; y <= removed.cells.last.y; y++)
+	{
+		for (uint32_t x = removed.cells.first.x; x <= removed.cells.last.x; x++)
+		{
+			get_cell(glm::uvec2(x, y)).has_stale_entries = true;
+		}
+	}
+	removed_proxies.push_back(proxy);
+	num_active--;
+}
+
+void SweepAndPrune::set_bounds(ProxyID proxy, const AABB& bounds)
+{
+	proxies[proxy].bounds = bounds;
+}
+
+const std::vector<SweepAndPrune::Pair>& SweepAndPrune::update()
+{
+	const auto statistics = compute_statistics();
+	if (select_sort_axis(statistics) || is_grid_outdated(statistics))
+	{
+		rebuild_grid(statistics);
+	} else
+	{
+		update_cell_membership();
+	}
+
+	for (uint32_t index = 0; index < cells.size(); index++)
+	{
+		auto& cell = cells[index];
+		if (cell.has_stale_entries)
+		{
+			const glm::uvec2 coordinate(index % grid_size.x, index / grid_size.x);
+			std::erase_if(cell.entries, [this, &coordinate](const Entry& entry)
+			{
+				const auto& proxy = proxies[entry.proxy];
+				return !proxy.active || !proxy.cells.contains(coordinate);
+			});
+			cell.has_stale_entries = false;
+		}
+		for (auto& entry : cell.entries)
+		{
+			entry.bounds = proxies[entry.proxy].bounds;
+		}
+		sort_cell(cell, cell.num_added * FULL_SORT_RATIO > cell.entries.size());
+		cell.num_added = 0;
+	}
+
+	free_proxies.insert(free_proxies.end(), removed_proxies.begin(), removed_proxies.end());
+	removed_proxies.clear();
+
+	pairs.clear();
+	for (uint32_t y = 0; y < grid_size.y; y++)
+	{
+		for (uint32_t x = 0; x < grid_size.x; x++)
+		{
+			sweep_cell(glm::uvec2(x, y));
+		}
+	}
+
+	return pairs;
+}
+
+SweepAndPrune::AxisStatistics SweepAndPrune::compute_statistics() const
+{
+	AxisStatistics statistics{ glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) };
+	if (num_active == 0)
+	{
+		return statistics;
+	}
+
+	statistics.min_center = glm::vec3(std::numeric_limits<float>::max());
+	statistics.max_center = glm::vec3(std::numeric_limits<float>::lowest());
+	glm::vec3 sum(0.0f);
+	glm::vec3 sum2(0.0f);
+	for (const auto& proxy : proxies)
+	{
+		if (!proxy.active)
+		{
+			continue;
+		}
+
+		const glm::vec3 center = (proxy.bounds.min_bound + proxy.bounds.max_bound) * 0.5f;
+		sum += center;
+		sum2 += center * center;
+		statistics.min_center = glm::min(statistics.min_center, center);
+		statistics.max_center = glm::max(statistics.max_center, center);
+		statistics.mean_size += proxy.bounds.max_bound - proxy.bounds.min_bound;
+	}
+	const float count = static_cast<float>(num_active);
+	statistics.variance = sum2 / count - (sum / count) * (sum / count);
+	statistics.mean_size /= count;
+
+	return statistics;
+}
+
+bool SweepAndPrune::select_sort_axis(const AxisStatistics& statistics)
+{
+	int best_axis = sort_axis;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (statistics.variance[axis] > statistics.variance[best_axis] * AXIS_SWITCH_RATIO)
+		{
+			best_axis = axis;
+		}
+	}
+
+	const bool changed = best_axis != sort_axis;
+	sort_axis = best_axis;
+
+	return changed;
+}
+
+namespace
+{
+	uint32_t get_grid_size(float spread, float mean_size)
+	{
+		const float min_cell_size = std::max(mean_size * MIN_CELL_SIZE, std::numeric_limits<float>::epsilon());
+		return static_cast<uint32_t>(std::clamp(spread / min_cell_size, 1.0f, float(MAX_CELLS_PER_AXIS)));
+	}
+}
+
+bool SweepAndPrune::is_grid_outdated(const AxisStatistics& statistics) const
+{
+	if (cells.empty())
+	{
+		return true;
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		const int axis = (sort_axis + 1 + i) % 3;
+		const uint32_t size = get_grid_size(statistics.max_center[axis] - statistics.min_center[axis], statistics.mean_size[axis]);
+		if (size > grid_size[i] * REBUILD_RATIO || size * REBUILD_RATIO < grid_size[i])
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void SweepAndPrune::rebuild_grid(const AxisStatistics& statistics)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		const int axis = (sort_axis + 1 + i) % 3;
+		const float spread = statistics.max_center[axis] - statistics.min_center[axis];
+		grid_size[i] = get_grid_size(spread, statistics.mean_size[axis]);
+		grid_origin[i] = statistics.min_center[axis];
+		cell_size[i] = std::max(spread / float(grid_size[i]), std::numeric_limits<float>::epsilon());
+	}
+
+	cells.assign(grid_size.x * grid_size.y, Cell{});
+	for (ProxyID id = 0; id < proxies.size(); id++)
+	{
+		auto& proxy = proxies[id];
+		if (!proxy.active)
+		{
+			proxy.cells = CellRange{};
+			continue;
+		}
+
+		proxy.cells = get_cell_range(proxy.bounds);
+		for (uint32_t y = proxy.cells.first.y; y <= proxy.cells.last.y; y++)
+		{
+			for (uint32_t x = proxy.cells.first.x; x <= proxy.cells.last.x; x++)
+			{
+				auto& cell = get_cell(glm::uvec2(x, y));
+				cell.entries.push_back(Entry{ proxy.bounds, id });
+				cell.num_added++;
+			}
+		}
+	}
+}
+
+void SweepAndPrune::update_cell_membership()
+{
+	for (ProxyID id = 0; id < proxies.size(); id++)
+	{
+		auto& proxy = proxies[id];
+		if (!proxy.active)
+		{
+			continue;
+		}
+
+		const CellRange range = get_cell_range(proxy.bounds);
+		if (range == proxy.cells)
+		{
+			continue;
+		}
+
+		for (uint32_t y = proxy.cells.first.y; y <= proxy.cells.last.y; y++)
+		{
+			for (uint32_t x = proxy.cells.first.x; x <= proxy.cells.last.x; x++)
+			{
+				if (!range.contains(glm::uvec2(x, y)))
+				{
+					get_cell(glm::uvec2(x, y)).has_stale_entries = true;
+				}
+			}
+		}
+		for (uint32_t y = range.first.y; y <= range.last.y; y++)
+		{
+			for (uint32_t x = range.first.x; x <= range.last.x; x++)
+			{
+				if (!proxy.cells.contains(glm::uvec2(x, y)))
+				{
+					auto& cell = get_cell(glm::uvec2(x, y));
+					cell.entries.push_back(Entry{ proxy.bounds, id });
+					cell.num_added++;
+				}
+			}
+		}
+		proxy.cells = range;
+	}
+}
+
+SweepAndPrune::CellRange SweepAndPrune::get_cell_range(const AABB& bounds) const
+{
+	CellRange range;
+	for (int i = 0; i < 2; i++)
+	{
+		const int axis = (sort_axis + 1 + i) % 3;
+		// anything beyond the grid goes into the outermost cells, which is still correct, just slower
+		const float max_cell = float(grid_size[i] - 1);
+		range.first[i] = static_cast<uint32_t>(std::clamp(std::floor((bounds.min_bound[axis] - grid_origin[i]) / cell_size[i]), 0.0f, max_cell));
+		range.last[i] = static_cast<uint32_t>(std::clamp(std::floor((bounds.max_bound[axis] - grid_origin[i]) / cell_size[i]), 0.0f, max_cell));
+	}
+
+	return range;
+}
+
+void SweepAndPrune::sort_cell(Cell& cell, bool full_sort)
+{
+	auto& entries = cell.entries;
+	if (full_sort)
+	{
+		std::sort(entries.begin(), entries.end(), [this](const Entry& entry1, const Entry& entry2)
+		{
+			return entry1.bounds.min_bound[sort_axis] < entry2.bounds.min_bound[sort_axis];
+		});
+		return;
+	}
+
+	// frame to frame the order barely changes, so each entry only moves a few places
+	for (size_t i = 1; i < entries.size(); i++)
+	{
+		const Entry entry = entries[i];
+		const float min = entry.bounds.min_bound[sort_axis];
+		size_t j = i;
+		while (j > 0 && entries[j - 1].bounds.min_bound[sort_axis] > min)
+		{
+			entries[j] = entries[j - 1];
+			j--;
+		}
+		entries[j] = entry;
+	}
+}
+
+void SweepAndPrune::sweep_cell(const glm::uvec2& cell)
+{
+	// locals, otherwise every pair written forces the compiler to reload them
+	const Entry* entries = get_cell(cell).entries.data();
+	const size_t num_entries = get_cell(cell).entries.size();
+	const int axis0 = sort_axis;
+	const int axis1 = (sort_axis + 1) % 3;
+	const int axis2 = (sort_axis + 2) % 3;
+	for (size_t i = 0; i < num_entries; i++)
+	{
+		const AABB& bounds = entries[i].bounds;
+		const float max = bounds.max_bound[axis0];
+		// sorted by the minimum, so past the first entry starting after this one ends nothing can overlap
+		for (size_t j = i + 1; j < num_entries && entries[j].bounds.min_bound[axis0] <= max; j++)
+		{
+			const AABB& other = entries[j].bounds;
+			// non short circuiting, the outcome of each comparison is close to random and mispredicted branches dominate
+			const bool separated = 
+				(bounds.min_bound[axis1] > other.max_bound[axis1]) | (other.min_bound[axis1] > bounds.max_bound[axis1]) |
+				(bounds.min_bound[axis2] > other.max_bound[axis2]) | (other.min_bound[axis2] > bounds.max_bound[axis2]);
+			if (separated)
+			{
+				continue;
+			}
+
+			// bounds spanning several cells meet in each of them, only the first cell they share reports the pair
+			const auto& proxy1 = proxies[entries[i].proxy];
+			const auto& proxy2 = proxies[entries[j].proxy];
+			if (glm::max(proxy1.cells.first, proxy2.cells.first) != cell)
+			{
+				continue;
+			}
+
+			pairs.emplace_back(std::min(proxy1.id, proxy2.id), std::max(proxy1.id, proxy2.id));
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "bounding_box.hpp"
+#include "identifications.hpp"
+
+#include <glm/vec2.hpp>
+
+#include <vector>
+#include <utility>
+#include <limits>
+#include <cstdint>
+
+
+//
+// sort and sweep broadphase [Ericson 2005, 7.1.2]
+//	the bounds are kept sorted by their minimum along the axis with the greatest spread of centers,
+//	objects barely move between ticks so the order is nearly sorted already and an insertion sort repairs it in ~O(n),
+//	the sweep then only compares bounds whose intervals overlap on that axis
+//	on its own the sweep still compares everything sharing a slice of the sort axis, which grows faster than the number of bounds,
+//	so the two other axes are split into a coarse grid of cells that are each sorted and swept on their own (multi SAP)
+//
+class SweepAndPrune
+{
+public:
+	using ProxyID = uint32_t;
+	using Pair = std::pair<ObjectID, ObjectID>;
+
+	static constexpr ProxyID INVALID_PROXY = std::numeric_limits<ProxyID>::max();
+
+	ProxyID add(ObjectID id, const AABB& bounds);
+	void remove(ProxyID proxy);
+	void set_bounds(ProxyID proxy, const AABB& bounds);
+	const AABB& get_bounds(ProxyID proxy) const { return proxies[proxy].bounds; }
+
+	size_t size() const { return num_active; }
+	int get_sort_axis() const { return sort_axis; }
+	size_t get_num_cells() const { return cells.size(); }
+
+	// re-sorts and sweeps the bounds, every overlapping pair is reported once with the smaller id first
+	const std::vector<Pair>& update();
+	const std::vector<Pair>& get_pairs() const { return pairs; }
+
+private:
+	// inclusive range of grid cells, empty when first.x > last.x
+	struct CellRange
+	{
+		glm::uvec2 first = glm::uvec2(1);
+		glm::uvec2 last = glm::uvec2(0);
+
+		bool contains(const glm::uvec2& cell) const
+		{
+			return cell.x >= first.x && cell.x <= last.x && cell.y >= first.y && cell.y <= last.y;
+		}
+		bool operator==(const CellRange& other) const = default;
+	};
+
+	struct Proxy
+	{
+		ObjectID id;
+		AABB bounds;
+		bool active = false;
+		// cells the bounds currently have entries in
+		CellRange cells;
+	};
+
+	// the sweep only touches this array, so it carries a copy of the bounds instead of looking up the proxy
+	struct Entry
+	{
+		AABB bounds;
+		ProxyID proxy;
+	};
+
+	struct Cell
+	{
+		std::vector<Entry> entries;
+		size_t num_added = 0;
+		bool has_stale_entries = false;
+	};
+
+	struct AxisStatistics
+	{
+		glm::vec3 variance;
+		glm::vec3 min_center;
+		glm::vec3 max_center;
+		glm::vec3 mean_size;
+	};
+
+	AxisStatistics compute_statistics() const;
+	bool select_sort_axis(const AxisStatistics& statistics);
+	bool is_grid_outdated(const AxisStatistics& statistics) const;
+	void rebuild_grid(const AxisStatistics& statistics);
+	void update_cell_membership();
+	CellRange get_cell_range(const AABB& bounds) const;
+	Cell& get_cell(const glm::uvec2& cell) { return cells[cell.y * grid_size.x + cell.x]; }
+	void sort_cell(Cell& cell, bool full_sort);
+	void sweep_cell(const glm::uvec2& cell);
+
+	std::vector<Proxy> proxies;
+	std::vector<ProxyID> free_proxies;
+	// only recycled once their entries are gone
+	std::vector<ProxyID> removed_proxies;
+	std::vector<Cell> cells;
+	std::vector<Pair> pairs;
+
+	int sort_axis = 0;
+	// the grid spans the two remaining axes, (sort_axis + 1) % 3 and (sort_axis + 2) % 3
+	glm::uvec2 grid_size = glm::uvec2(1);
+	glm::vec2 grid_origin = glm::vec2(0.0f);
+	glm::vec2 cell_size = glm::vec2(1.0f);
+	// what the grid was built for, it is rebuilt once that no longer fits
+	size_t grid_count = 0;
+	glm::vec2 grid_spread = glm::vec2(0.0f);
+	size_t num_active = 0;
+};
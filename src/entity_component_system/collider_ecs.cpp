@@ -1,5 +1,6 @@
 #include "collider_ecs.hpp"
 #include "ecs.hpp"
+#include "profiler.hpp"
 
 
 void ColliderSystem::add_collider(EntityID id, std::unique_ptr<Collider>&& collider) 
@@ -9,9 +10,19 @@ void ColliderSystem::add_collider(EntityID id, std::unique_ptr<Collider>&& colli
 
 void ColliderSystem::add_collider(EntityID id, std::unique_ptr<Collider>&& collider, const Maths::Transform& offset) 
 {
+	if (components.contains(id))
+	{
+		return;
+	}
+
 	ColliderComponent new_component;
 	new_component.collider = std::move(collider);
 	new_component.collider->apply_transform(offset);
+	if (new_component.collider->get_type() != ECollider::RAY)
+	{
+		// the bounds are filled in by the next update_contacts
+		new_component.broadphase_proxy = broadphase.add(id, AABB(glm::vec3(0.0f), glm::vec3(0.0f)));
+	}
 
 	components.emplace(id, std::move(new_component));
 }
@@ -28,4 +39,45 @@ const Collider* ColliderSystem::get_collider(EntityID id) const
 	collider->set_temporary_transform(get_ecs().get_object(id).get_maths_transform());
 
 	return collider;
-}
\ No newline at end of file
+}
+
+void ColliderSystem::update_contacts()
+{
+	PROFILE_SCOPE("ColliderSystem::update_contacts");
+	for (const auto& [id, component] : components)
+	{
+		if (component.broadphase_proxy == SweepAndPrune::INVALID_PROXY)
+		{
+			continue;
+		}
+
+		// the temporary transform is kept for the narrowphase below
+		component.collider->set_temporary_transform(get_ecs().get_object(id).get_maths_transform());
+		broadphase.set_bounds(component.broadphase_proxy, component.collider->get_bounding_box());
+	}
+
+	contacts.clear();
+	for (const auto& [id1, id2] : broadphase.update())
+	{
+		const auto result = CollisionDetector::check_collision(components.at(id1).collider.get(), components.at(id2).collider.get());
+		if (result.bCollided)
+		{
+			contacts.push_back(Contact{ id1, id2, result });
+		}
+	}
+}
+
+void ColliderSystem::remove_entity(EntityID id)
+{
+	auto it = components.find(id);
+	if (it == components.end())
+	{
+		return;
+	}
+
+	if (it->second.broadphase_proxy != SweepAndPrune::INVALID_PROXY)
+	{
+		broadphase.remove(it->second.broadphase_proxy);
+	}
+	components.erase(it);
+}
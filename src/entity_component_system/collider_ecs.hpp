@@ -2,10 +2,13 @@
 
 #include "identifications.hpp"
 #include "collision/collider.hpp"
+#include "collision/collision_detector.hpp"
+#include "collision/sweep_and_prune.hpp"
 #include "maths.hpp"
 
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 
 using EntityID = ObjectID;
@@ -13,6 +16,16 @@ using EntityID = ObjectID;
 struct ColliderComponent
 {
 	std::unique_ptr<Collider> collider;
+	// rays are queries rather than bodies and stay out of the broadphase
+	SweepAndPrune::ProxyID broadphase_proxy = SweepAndPrune::INVALID_PROXY;
+};
+
+struct Contact
+{
+	EntityID entity1;
+	EntityID entity2;
+	// the normal points from entity1 towards entity2
+	CollisionResult result;
 };
 
 class ECS;
@@ -24,13 +37,20 @@ public:
 
 	void add_collider(EntityID id, std::unique_ptr<Collider>&& collider);
 	void add_collider(EntityID id, std::unique_ptr<Collider>&& collider, const Maths::Transform& offset);
-	void remove_collider(EntityID id) { components.erase(id); }
+	void remove_collider(EntityID id) { remove_entity(id); }
 
 	const Collider* get_collider(EntityID id) const;
 
+	// moves the broadphase bounds to the current object transforms and narrowphase tests the overlapping pairs
+	void update_contacts();
+	// touching colliders as of the last update_contacts
+	const std::vector<Contact>& get_contacts() const { return contacts; }
+
 protected:
-	void remove_entity(EntityID id) { components.erase(id); }
+	void remove_entity(EntityID id);
 
 private:
 	std::unordered_map<EntityID, ColliderComponent> components;
-};
\ No newline at end of file
+	SweepAndPrune broadphase;
+	std::vector<Contact> contacts;
+};
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "identifications.hpp"
+#include "slot_map.hpp"
 
 #include <glm/vec3.hpp>
 
 #include <unordered_map>
+#include <vector>
+#include <memory>
+#include <algorithm>
 #include <stdexcept>
 
 
@@ -24,7 +28,7 @@ public:
 	static IDType add_permanent(std::unique_ptr<ContentType>&& content)
 	{
 		const auto id = get_global()._add(std::move(content));
-		get_global().owners[id] = PERMANENTLY_OWNED;
+		get_global()._set_permanently_owned(id);
 
 		return id;
 	}
@@ -62,48 +66,149 @@ public:
 		return get_global()._decrement_owners(id);
 	}
 
+	// contiguous iteration over every live content
+	template<typename Func>
+	static void for_each(Func&& func)
+	{
+		for (auto& entry : get_global().entries)
+		{
+			func(*entry.content);
+		}
+	}
+
+	static size_t size()
+	{
+		return get_global().entries.size();
+	}
+
+	// the number of id lookup entries, bounded by the live contents rather than every id ever added
+	static size_t get_id_table_size()
+	{
+		return get_global().id_to_handle.size() + get_global().old_id_to_handle.size();
+	}
+
 private:
 	static constexpr uint32_t PERMANENTLY_OWNED = std::numeric_limits<uint32_t>::max();
+	static constexpr size_t MIN_ID_WINDOW_SIZE = 64;
+
+	struct Entry
+	{
+		std::unique_ptr<ContentType> content;
+		uint32_t owners = 0;
+	};
+
+	using Handle = typename SlotMap<Entry>::Handle;
 
 	IDType _add(std::unique_ptr<ContentType>&& content)
 	{
 		const IDType id = content->get_id();
-		assert(!contents.contains(id));
-		contents.emplace(id, std::move(content));
-		owners[id] = 0;
+		assert(!_find(id));
+		const Handle handle = entries.insert(Entry{ std::move(content), 0 });
+		const auto idx = id.get_underlying();
+		if (idx < id_base)
+		{
+			// added after newer ids were, it's older than the window
+			old_id_to_handle[idx] = handle;
+			return id;
+		}
+
+		if (idx >= id_base + id_to_handle.size())
+		{
+			_compact_id_table();
+			id_to_handle.resize(idx + 1 - id_base);
+		}
+		id_to_handle[idx - id_base] = handle;
 
 		return id;
 	}
 
+	// ids are never reused so the window of recent ids slides forward once at least half of it is dead,
+	// the live ids left behind are moved to old_id_to_handle so the table is bounded by the live contents
+	void _compact_id_table()
+	{
+		const size_t num_window_live = entries.size() - old_id_to_handle.size();
+		if (id_to_handle.size() < MIN_ID_WINDOW_SIZE || num_window_live * 2 > id_to_handle.size())
+		{
+			return;
+		}
+
+		const size_t cut = id_to_handle.size() / 2;
+		for (size_t i = 0; i < cut; i++)
+		{
+			if (entries.contains(id_to_handle[i]))
+			{
+				old_id_to_handle[id_base + i] = id_to_handle[i];
+			}
+		}
+		id_to_handle.erase(id_to_handle.begin(), id_to_handle.begin() + cut);
+		id_base += cut;
+	}
+
+	// ids are generated sequentially per IDType so recent ones index id_to_handle directly,
+	// a stale handle (content that has since been erased) is caught by the slot map's generation check
+	const Handle* _find_handle(uint64_t idx) const
+	{
+		if (idx >= id_base)
+		{
+			return idx - id_base < id_to_handle.size() ? &id_to_handle[idx - id_base] : nullptr;
+		}
+		const auto it = old_id_to_handle.find(idx);
+		return it != old_id_to_handle.end() ? &it->second : nullptr;
+	}
+
+	Entry* _find(IDType id)
+	{
+		const Handle* handle = _find_handle(id.get_underlying());
+		return handle ? entries.get(*handle) : nullptr;
+	}
+
+	const Entry* _find(IDType id) const
+	{
+		const Handle* handle = _find_handle(id.get_underlying());
+		return handle ? entries.get(*handle) : nullptr;
+	}
+
+	void _set_permanently_owned(IDType id)
+	{
+		_find(id)->owners = PERMANENTLY_OWNED;
+	}
+
 	ContentType& _get(IDType id)
 	{
-		if (!contents.contains(id))
+		Entry* entry = _find(id);
+		if (!entry)
 		{
 			throw std::runtime_error("CountableSystem::_get: id not found");
 		}
-		return *contents[id];
+		return *entry->content;
 	}
 
 	uint32_t _get_num_owners(IDType id) const
 	{
-		return owners.contains(id) ? owners.at(id) : 0;
+		const Entry* entry = _find(id);
+		return entry ? entry->owners : 0;
 	}
 
 	uint32_t _increment_owners(IDType id)
 	{
-		assert(owners.contains(id));
-		if (owners[id] == PERMANENTLY_OWNED)
+		Entry* entry = _find(id);
+		assert(entry);
+		if (entry->owners == PERMANENTLY_OWNED)
 		{
 			return PERMANENTLY_OWNED;
 		}
 
-		return ++owners[id];
+		return ++entry->owners;
 	}
 
 	uint32_t _decrement_owners(IDType id)
 	{
-		assert(owners.contains(id));
-		const auto count = owners[id];
+		Entry* entry = _find(id);
+		if (!entry)
+		{
+			throw std::runtime_error("CountableSystem::_decrement_owners: id not found");
+		}
+		const auto count = entry->owners;
 		if (count == 0)
 		{
 			throw std::runtime_error("CountableSystem::_decrement_owners: count < 0");
@@ -112,12 +217,19 @@ private:
 			return PERMANENTLY_OWNED;
 		} else if (count == 1)
 		{
-			contents.erase(id);
-			owners.erase(id);
+			const auto idx = id.get_underlying();
+			entries.erase(*_find_handle(idx));
+			if (idx < id_base)
+			{
+				old_id_to_handle.erase(idx);
+			} else
+			{
+				id_to_handle[idx - id_base] = Handle{};
+			}
 			return 0;
 		} else
 		{
-			return --owners[id];
+			return --entry->owners;
 		}
 	}
 
@@ -128,8 +240,12 @@ private:
 	}
 
 private:
-	std::unordered_map<IDType, std::unique_ptr<ContentType>> contents;
-	std::unordered_map<IDType, uint32_t> owners;
+	SlotMap<Entry> entries;
+	// ids [id_base, id_base + id_to_handle.size())
+	std::vector<Handle> id_to_handle;
+	uint64_t id_base = 0;
+	// live ids below id_base
+	std::unordered_map<uint64_t, Handle> old_id_to_handle;
 };
 
 class ECS;
@@ -14,6 +14,8 @@ void ECS::process(const float delta_secs)
 {
 	AnimationSystem::process(delta_secs);
 	SkeletalAnimationSystem::process(delta_secs);
+	SpatialSystem::update_positions();
+	ColliderSystem::update_contacts();
 }
 
 ECS& ECS::get()
@@ -22,6 +24,12 @@ ECS& ECS::get()
 	return ecs;
 }
 
+void ECS::add_object(Object& object)
+{
+	objects.emplace(object.get_id(), &object);
+	SpatialSystem::add_entity(object);
+}
+
 void ECS::remove_object(const ObjectID id) 
 {
 	SkeletalSystem::remove_entity(id);
@@ -29,6 +37,7 @@ void ECS::remove_object(const ObjectID id)
 	LightSystem::remove_entity(id);
 	ColliderSystem::remove_entity(id);
 	ClickableSystem::remove_entity(id);
+	SpatialSystem::remove_entity(id);
 	objects.erase(id);
 }
 
@@ -6,6 +6,7 @@
 #include "collider_ecs.hpp"
 #include "clickable.hpp"
 #include "hoverable.hpp"
+#include "spatial_ecs.hpp"
 #include "objects/object.hpp"
 
 #include <unordered_map>
@@ -25,7 +26,8 @@ class ECS :
 	public LightSystem,
 	public ColliderSystem,
 	public ClickableSystem,
-	public HoverableSystem
+	public HoverableSystem,
+	public SpatialSystem
 {
 public:
 	ECS();
@@ -45,7 +47,7 @@ public:
 	// void remove_animation(const ObjectID id) { animation.remove_component(id); }
 
 	// Used by GameEngine
-	void add_object(Object& object) { objects.emplace(object.get_id(), &object); }
+	void add_object(Object& object);
 	void remove_object(const ObjectID id);
 
 	// Used by ECSComponents
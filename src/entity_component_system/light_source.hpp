@@ -11,6 +11,8 @@ struct LightComponent
 {
 	float intensity = 1.0f;
 	glm::vec3 color = { 1.0f, 0.9f, 0.2f };
+	// the distance at which the light has faded out, the global light source ignores it
+	float radius = 10.0f;
 };
 
 class LightSystem
@@ -34,6 +36,8 @@ public:
 		return comp == lights.end() ? nullptr : &comp->second;
 	}
 
+	const std::unordered_map<ObjectID, LightComponent>& get_light_components() const { return lights; }
+
 protected:
 	void remove_entity(const ObjectID id) { lights.erase(id); }
 
@@ -63,6 +63,7 @@ public:
 	virtual ECS& get_ecs() = 0;
 
 	SkeletonID add_skeleton(const std::vector<Bone>& bones);
+	void remove_skeleton(SkeletonID id) { skeletons.erase(id); }
 	std::vector<SDS::Bone> get_bones(SkeletonID id) const { return skeletons.at(id).get_bones_data(); }
 	SkeletalComponent& get_skeletal_component(SkeletonID id) { return skeletons.at(id); }
 
@@ -82,6 +83,8 @@ public:
 	void process(const float delta_secs);
 
 	AnimationID add_skeletal_animation(const std::string& name, std::vector<BoneAnimation>&& bone_animations);
+	// the animation must not be playing
+	void remove_skeletal_animation(AnimationID id) { animations.erase(id); }
 	void play_animation(SkeletonID skeleton_id, AnimationID animation_id, bool loop = false);
 	const std::unordered_map<AnimationID, SkeletalAnimation>& get_skeletal_animations() const { return animations; }
 
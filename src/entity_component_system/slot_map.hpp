@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <vector>
+#include <utility>
+#include <limits>
+
+
+// Generational-index slot map
+//	* O(1) insert, erase and lookup without hashing
+//	* handles carry a generation so stale handles (to erased elements) are detected instead of aliasing
+//	* values are kept densely packed (swap-and-pop on erase) so iteration is contiguous
+template<typename T>
+class SlotMap
+{
+public:
+	struct Handle
+	{
+		uint32_t index = INVALID_INDEX;
+		uint32_t generation = 0;
+
+		bool operator==(const Handle&) const = default;
+		bool is_null() const { return index == INVALID_INDEX; }
+	};
+
+	static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+public:
+	Handle insert(T&& value)
+	{
+		uint32_t slot_idx;
+		if (free_head != INVALID_INDEX)
+		{
+			slot_idx = free_head;
+			free_head = slots[slot_idx].dense_idx;
+		} else
+		{
+			slot_idx = static_cast<uint32_t>(slots.size());
+			slots.push_back(Slot{});
+		}
+
+		Slot& slot = slots[slot_idx];
+		slot.dense_idx = static_cast<uint32_t>(dense.size());
+		dense.push_back(std::move(value));
+		dense_to_slot.push_back(slot_idx);
+
+		return Handle{ slot_idx, slot.generation };
+	}
+
+	// returns false if the handle was stale
+	bool erase(Handle handle)
+	{
+		if (!contains(handle))
+		{
+			return false;
+		}
+
+		Slot& slot = slots[handle.index];
+		const uint32_t dense_idx = slot.dense_idx;
+		const uint32_t last_idx = static_cast<uint32_t>(dense.size() - 1);
+		if (dense_idx != last_idx)
+		{
+			dense[dense_idx] = std::move(dense[last_idx]);
+			dense_to_slot[dense_idx] = dense_to_slot[last_idx];
+			slots[dense_to_slot[dense_idx]].dense_idx = dense_idx;
+		}
+		dense.pop_back();
+		dense_to_slot.pop_back();
+
+		// bumping the generation invalidates every outstanding handle to this slot
+		++slot.generation;
+		slot.dense_idx = free_head;
+		free_head = handle.index;
+
+		return true;
+	}
+
+	bool contains(Handle handle) const
+	{
+		return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+	}
+
+	// returns nullptr if the handle is stale
+	T* get(Handle handle)
+	{
+		return contains(handle) ? &dense[slots[handle.index].dense_idx] : nullptr;
+	}
+
+	const T* get(Handle handle) const
+	{
+		return contains(handle) ? &dense[slots[handle.index].dense_idx] : nullptr;
+	}
+
+	T& operator[](Handle handle)
+	{
+		assert(contains(handle));
+		return dense[slots[handle.index].dense_idx];
+	}
+
+	const T& operator[](Handle handle) const
+	{
+		assert(contains(handle));
+		return dense[slots[handle.index].dense_idx];
+	}
+
+	void reserve(size_t capacity)
+	{
+		slots.reserve(capacity);
+		dense.reserve(capacity);
+		dense_to_slot.reserve(capacity);
+	}
+
+	void clear()
+	{
+		while (!dense.empty())
+		{
+			erase(Handle{ dense_to_slot.back(), slots[dense_to_slot.back()].generation });
+		}
+	}
+
+	size_t size() const { return dense.size(); }
+	bool empty() const { return dense.empty(); }
+
+	// contiguous iteration over the live values, order is unspecified
+	auto begin() { return dense.begin(); }
+	auto end() { return dense.end(); }
+	auto begin() const { return dense.begin(); }
+	auto end() const { return dense.end(); }
+
+private:
+	struct Slot
+	{
+		// index into dense when occupied, next free slot when on the free list
+		uint32_t dense_idx = INVALID_INDEX;
+		uint32_t generation = 0;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<T> dense;
+	std::vector<uint32_t> dense_to_slot;
+	uint32_t free_head = INVALID_INDEX;
+};
@@ -0,0 +1,46 @@
+#include "spatial_ecs.hpp"
+#include "objects/object.hpp"
+#include "profiler.hpp"
+
+
+void SpatialSystem::add_entity(const Object& object)
+{
+	const glm::vec3 position = object.get_position();
+	if (entities.emplace(object.get_id(), Entity{ &object, position }).second)
+	{
+		spatial_hash.insert(object.get_id(), position);
+		object.track_moves(&moved_entities);
+	}
+}
+
+// the object may already be destroyed so it's not untracked, its queued ids are skipped
+void SpatialSystem::remove_entity(EntityID id)
+{
+	if (entities.erase(id))
+	{
+		spatial_hash.remove(id);
+	}
+}
+
+void SpatialSystem::update_positions()
+{
+	PROFILE_SCOPE("SpatialSystem::update_positions");
+	for (const EntityID id : moved_entities)
+	{
+		const auto it = entities.find(id);
+		if (it == entities.end())
+		{
+			continue;
+		}
+
+		Entity& entity = it->second;
+		entity.object->clear_move_queued();
+		const glm::vec3 position = entity.object->get_position();
+		if (position != entity.position)
+		{
+			entity.position = position;
+			spatial_hash.update(id, position);
+		}
+	}
+	moved_entities.clear();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "identifications.hpp"
+#include "collision/spatial_hash.hpp"
+#include "collision/bounding_box.hpp"
+#include "common.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+
+class Object;
+
+// proximity queries over the positions of every object in the ECS
+//	positions are refreshed once per ECS::process, the objects queue themselves when their transform changes
+//	so only those that moved are looked at, and only those that crossed into another cell change buckets
+class SpatialSystem
+{
+public:
+	virtual ECS& get_ecs() = 0;
+	virtual const ECS& get_ecs() const = 0;
+
+	// ids are appended to result in no particular order
+	void query_radius(const glm::vec3& center, float radius, std::vector<EntityID>& result) const { spatial_hash.query_radius(center, radius, result); }
+	void query_box(const AABB& box, std::vector<EntityID>& result) const { spatial_hash.query_box(box, result); }
+	// up to k entities sorted by increasing distance
+	std::vector<EntityID> query_nearest(const glm::vec3& center, size_t k) const { return spatial_hash.query_nearest(center, k); }
+
+	const SpatialHash& get_spatial_hash() const { return spatial_hash; }
+
+protected:
+	void add_entity(const Object& object);
+	void remove_entity(EntityID id);
+	void update_positions();
+
+private:
+	struct Entity
+	{
+		const Object* object;
+		// the position the hash last saw, a transform change doesn't always move the object
+		glm::vec3 position;
+	};
+
+	SpatialHash spatial_hash;
+	std::unordered_map<EntityID, Entity> entities;
+	// filled by the objects, see Object::track_moves, may hold ids that have since been removed
+	std::vector<EntityID> moved_entities;
+};
@@ -9,6 +9,7 @@
 #include "graphics_engine/graphics_engine_commands.hpp"
 #include "utility.hpp"
 #include "analytics.hpp"
+#include "profiler.hpp"
 #include "interface/gizmo.hpp"
 #include "hot_reload.hpp"
 #include "gui/gui_manager.hpp"
@@ -93,6 +94,7 @@ void GameEngine::run()
 
 		std::chrono::time_point<std::chrono::system_clock> time = std::chrono::system_clock::now();
 
+		Profiler::set_thread_name("GameEngine");
 		TPS_counter->start();
 		Utility::LoopSleeper loop_sleeper(std::chrono::milliseconds(17));
 		while (!should_shutdown && !window.should_close())
@@ -104,6 +106,7 @@ void GameEngine::run()
 			std::chrono::duration<float, std::milli> chrono_time_delta = new_time - time;
 			const float time_delta = chrono_time_delta.count() * 0.001; // in seconds
 			time = new_time;
+			Profiler::mark_frame();
 			analytics.start();
 
 			// for ticks per second
@@ -125,12 +128,20 @@ void GameEngine::run()
 
 void GameEngine::main_loop(const float time_delta)
 {
-	window.poll_events();
+	PROFILE_SCOPE("GameEngine::main_loop");
+
+	{
+		PROFILE_SCOPE("poll_events");
+		window.poll_events();
+	}
 
 	process_objs_to_delete();
 
 	// poll gui stuff, we should take advantage of polymorphism later on, but for now this is relatively simple
-	get_gui_manager().process(*this);
+	{
+		PROFILE_SCOPE("GuiManager::process");
+		get_gui_manager().process(*this);
+	}
 
 	if (mouse->mmb_down)
 	{
@@ -175,9 +186,15 @@ void GameEngine::main_loop(const float time_delta)
 		}
 	}
 
-	ecs.process(time_delta);
+	{
+		PROFILE_SCOPE("ECS::process");
+		ecs.process(time_delta);
+	}
 	experimental->process(time_delta);
-	application->on_tick(time_delta);
+	{
+		PROFILE_SCOPE("IApplication::on_tick");
+		application->on_tick(time_delta);
+	}
 }
 
 void GameEngine::shutdown_impl()
@@ -0,0 +1,96 @@
+#include "blas_refit_scheduler.hpp"
+
+#include <algorithm>
+
+
+BlasRefitScheduler::BlasRefitScheduler(uint32_t max_refits, uint32_t rebuild_budget) :
+	max_refits(max_refits),
+	rebuild_budget(rebuild_budget)
+{
+}
+
+BlasRefitScheduler::Updates BlasRefitScheduler::update(
+	const std::vector<ObjectID>& traced, 
+	const std::function<bool(ObjectID)>& is_deformable)
+{
+	Updates updates;
+	std::vector<ObjectID> worn_out;
+	for (const ObjectID id : traced)
+	{
+		auto [it, is_new] = entries.try_emplace(id);
+		Entry& entry = it->second;
+		entry.is_seen = true;
+		if (is_new)
+		{
+			entry.is_refittable = is_deformable(id) || deformed.contains(id);
+			updates.to_build.push_back(id);
+		} else if (deformed.contains(id))
+		{
+			if (!entry.is_refittable)
+			{
+				// built as static, this build allows refits from now on
+				entry.is_refittable = true;
+				entry.num_refits = 0;
+				updates.to_build.push_back(id);
+			} else
+			{
+				(entry.num_refits >= max_refits ? worn_out : updates.to_refit).push_back(id);
+			}
+		}
+	}
+
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		if (!it->second.is_seen)
+		{
+			updates.removed.push_back(it->first);
+			it = entries.erase(it);
+		} else
+		{
+			it->second.is_seen = false;
+			++it;
+		}
+	}
+
+	// the most refit first, the ones over the budget get refit once more and wait for a later frame
+	std::stable_sort(worn_out.begin(), worn_out.end(), [this](ObjectID a, ObjectID b)
+	{
+		return entries.at(a).num_refits > entries.at(b).num_refits;
+	});
+	for (size_t i = 0; i < worn_out.size(); i++)
+	{
+		if (i < rebuild_budget)
+		{
+			entries.at(worn_out[i]).num_refits = 0;
+			updates.to_build.push_back(worn_out[i]);
+		} else
+		{
+			updates.to_refit.push_back(worn_out[i]);
+		}
+	}
+	for (const ObjectID id : updates.to_refit)
+	{
+		entries.at(id).num_refits++;
+	}
+
+	deformed.clear();
+	return updates;
+}
+
+void BlasRefitScheduler::clear()
+{
+	entries.clear();
+	deformed.clear();
+}
+
+bool BlasRefitScheduler::is_refittable(ObjectID id) const
+{
+	auto it = entries.find(id);
+	return it != entries.end() && it->second.is_refittable;
+}
+
+uint32_t BlasRefitScheduler::get_num_refits(ObjectID id) const
+{
+	auto it = entries.find(id);
+	return it != entries.end() ? it->second.num_refits : 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "identifications.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+// Decides which BLASes a frame builds and which it refits, the Vulkan work is left to GraphicsEngineRayTracing.
+// A BLAS is built once when its object first shows up, objects marked deformed since the last frame are refit,
+// refits loosen the tree so BLASes refit max_refits times are rebuilt, the most refit first, rebuild_budget a frame
+class BlasRefitScheduler
+{
+public:
+	struct Updates
+	{
+		// objects whose BLAS is no longer traced
+		std::vector<ObjectID> removed;
+		std::vector<ObjectID> to_build;
+		std::vector<ObjectID> to_refit;
+	};
+
+	BlasRefitScheduler(uint32_t max_refits, uint32_t rebuild_budget);
+
+	void mark_deformed(ObjectID id) { deformed.insert(id); }
+	// the objects traced this frame, is_deformable says whether a new BLAS should allow refits
+	Updates update(const std::vector<ObjectID>& traced, const std::function<bool(ObjectID)>& is_deformable);
+	void clear();
+
+	bool is_refittable(ObjectID id) const;
+	uint32_t get_num_refits(ObjectID id) const;
+	size_t size() const { return entries.size(); }
+
+private:
+	struct Entry
+	{
+		bool is_refittable = false;
+		// since the last build
+		uint32_t num_refits = 0;
+		// traced in the current update
+		bool is_seen = false;
+	};
+
+	const uint32_t max_refits;
+	const uint32_t rebuild_budget;
+	std::unordered_map<ObjectID, Entry> entries;
+	std::unordered_set<ObjectID> deformed;
+};
@@ -8,6 +8,9 @@
 namespace CSTS // short for Constants
 {
 	const uint32_t NUM_EXPECTED_SWAPCHAIN_IMAGES = 3;
+	// frames the CPU may record while the GPU still executes earlier ones, each has its own command buffer, fence,
+	// uniform regions and deletion queue. It's independent of the number of swap chain images
+	const uint32_t MAX_FRAMES_IN_FLIGHT = 2;
 
 	// The default msaa used throughout
 	const VkSampleCountFlagBits MSAA_SAMPLE_COUNT = VK_SAMPLE_COUNT_4_BIT;
@@ -16,6 +16,7 @@ public:
 	virtual void handle_command(UnStencilObjectCmd& cmd) {}
 	virtual void handle_command(ShutdownCmd& cmd) {}
 	virtual void handle_command(ToggleWireFrameModeCmd& cmd) {}
+	virtual void handle_command(ToggleOutlineModeCmd& cmd) {}
 	virtual void handle_command(UpdateCommandBufferCmd& cmd) {}
 	virtual void handle_command(UpdateRayTracingCmd& cmd) {}
 	virtual void handle_command(PreviewObjectsCmd& cmd) {}
@@ -28,22 +28,24 @@ void GraphicsEngine::handle_command(SpawnObjectCmd& cmd)
 			std::make_unique<GraphicsEngineObjectPtr>(*this, std::move(cmd.object)));
 		spawn_object(*graphics_object.first->second);
 	}
+	invalidate_scene();
 }
 
 void GraphicsEngine::handle_command(DeleteObjectCmd& cmd)
 {
-	get_swap_chain().get_prev_frame().mark_obj_for_delete(cmd.object_id);
-	get_objects()[cmd.object_id]->mark_for_delete();
+	cleanup_entity(cmd.object_id);
 }
 
 void GraphicsEngine::handle_command(StencilObjectCmd& cmd)
 {
 	stenciled_objects.insert(cmd.object_id);
+	invalidate_scene();
 }
 
 void GraphicsEngine::handle_command(UnStencilObjectCmd& cmd)
 {
 	stenciled_objects.erase(cmd.object_id);
+	invalidate_scene();
 }
 
 void GraphicsEngine::handle_command(ShutdownCmd& cmd)
@@ -54,12 +56,20 @@ void GraphicsEngine::handle_command(ShutdownCmd& cmd)
 void GraphicsEngine::handle_command(ToggleWireFrameModeCmd& cmd)
 {
     is_wireframe_mode = !is_wireframe_mode;
-	update_command_buffer();
+	invalidate_scene();
+}
+
+void GraphicsEngine::handle_command(ToggleOutlineModeCmd& cmd)
+{
+	is_outline_mode = !is_outline_mode;
+	invalidate_scene();
 }
 
 void GraphicsEngine::handle_command(UpdateCommandBufferCmd& cmd)
 {
-	update_command_buffer();
+	// the command buffer of every frame in flight is recorded again each time it's drawn,
+	// only the cached draw commands may be stale
+	invalidate_scene();
 }
 
 void GraphicsEngine::handle_command(UpdateRayTracingCmd& cmd)
@@ -90,7 +100,7 @@ void GraphicsEngine::handle_command(PreviewObjectsCmd& cmd)
 	get_graphics_gui_manager().update_preview_window(
 		cmd.gui, 
 		get_texture_mgr().fetch_sampler(ETextureSamplerType::ADDR_MODE_CLAMP_TO_EDGE),
-		renderer.get_output_image_view(get_swap_chain().get_curr_frame().image_index),
+		renderer.get_output_image_view(0),
 		glm::uvec2(extent.width, extent.height));
 }
 
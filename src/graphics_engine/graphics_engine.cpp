@@ -7,10 +7,12 @@
 #include "objects/object.hpp"
 #include "shared_data_structures.hpp"
 #include "analytics.hpp"
+#include "profiler.hpp"
 #include "entity_component_system/ecs.hpp"
 #include "entity_component_system/mesh_system.hpp"
 #include "entity_component_system/material_system.hpp"
 #include "constants.hpp"
+#include "config.hpp"
 #include "renderable/material_group.hpp"
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -18,6 +20,7 @@
 #include <fmt/core.h>
 #include <fmt/color.h>
 
+#include <array>
 #include <stdexcept>
 #include <thread>
 #include <chrono>
@@ -30,6 +33,10 @@ GraphicsEngine::GraphicsEngine(GameEngine& game_engine) :
 	instance(*this),
 	validation_layer(*this),
 	device(*this),
+	transfer_queue(*this, device.get_queue_family_indices().getTransferFamily()),
+	compute_queue(*this, device.get_queue_family_indices().getComputeFamily()),
+	deletion_queue(*this),
+	command_recorder(*this),
 	texture_mgr(*this),
 	rsrc_mgr(*this),
 	renderer_mgr(*this),
@@ -50,6 +57,8 @@ GraphicsEngine::~GraphicsEngine()
 	fmt::print("GraphicsEngine: cleaning up\n");
 	vkDeviceWaitIdle(get_logical_device());
 	objects.clear(); // must be cleared before the logical device is destroyed
+	deletion_queue.release_all();
+	vkDestroySemaphore(get_logical_device(), graphics_timeline_semaphore, nullptr);
 }
 
 Camera* GraphicsEngine::get_camera()
@@ -86,6 +95,28 @@ QueueFamilyIndices GraphicsEngine::findQueueFamilies(VkPhysicalDevice device) {
 		}
 	}
 
+	// a transfer only family is usually the copy engine, a compute family without graphics the async compute queues
+	for (uint32_t i = 0; i < queueFamilies.size(); i++)
+	{
+		const VkQueueFlags flags = queueFamilies[i].queueFlags;
+		if (flags & VK_QUEUE_GRAPHICS_BIT)
+			continue;
+
+		if (!indices.computeFamily.has_value() && flags & VK_QUEUE_COMPUTE_BIT)
+		{
+			indices.computeFamily = i;
+		}
+		if (!indices.transferFamily.has_value() && flags & VK_QUEUE_TRANSFER_BIT && !(flags & VK_QUEUE_COMPUTE_BIT))
+		{
+			indices.transferFamily = i;
+		}
+	}
+	// compute queues can copy too, still better than uploading in between draws
+	if (!indices.transferFamily.has_value())
+	{
+		indices.transferFamily = indices.computeFamily;
+	}
+
 	return indices;
 }
 
@@ -93,35 +124,49 @@ void GraphicsEngine::run() {
 	try {
 		Analytics analytics(60);
 		analytics.text = "GraphicsEngine: avg loop processing period (excluding sleep)";
+		Profiler::set_thread_name("GraphicsEngine");
 		FPS_tracker->start();
-		Utility::LoopSleeper loop_sleeper(std::chrono::milliseconds(17));
 		while (!should_shutdown)
 		{
 			// for FPS
 			FPS_tracker->stop();
 			FPS_tracker->start();
 
+			Profiler::mark_frame();
 			analytics.start();
 
-			ge_cmd_q_mutex.lock();
-			while (!ge_cmd_q.empty())
 			{
-				ge_cmd_q.front()->process(this);
-				ge_cmd_q.pop();
-			}
-			ge_cmd_q_mutex.unlock();
+				PROFILE_SCOPE("GraphicsEngine::run");
 
-			gui_manager.draw();
+				{
+					PROFILE_SCOPE("process_commands");
+					ge_cmd_q_mutex.lock();
+					while (!ge_cmd_q.empty())
+					{
+						ge_cmd_q.front()->process(this);
+						ge_cmd_q.pop();
+					}
+					ge_cmd_q_mutex.unlock();
+				}
 
-			raytracing_component.process();
+				{
+					PROFILE_SCOPE("GuiManager::draw");
+					gui_manager.draw();
+				}
+				apply_presentation_settings();
 
-			swap_chain.draw();
+				{
+					PROFILE_SCOPE("RaytracingComponent::process");
+					raytracing_component.process();
+				}
+
+				deletion_queue.process();
+				swap_chain.draw();
+			}
 
 			analytics.stop();
 
-#ifndef DISABLE_SLEEP
-			loop_sleeper();
-#endif
+			swap_chain.get_frame_pacer().pace();
 
 		}
     } catch (const std::exception& e) {
@@ -162,8 +207,11 @@ const ECS& GraphicsEngine::get_ecs() const
 void GraphicsEngine::cleanup_entity(const ObjectID id)
 {
 	auto& obj = get_object(id);
+	stenciled_objects.erase(id);
+	offscreen_rendering_objects.erase(id);
 
-	for (uint32_t frame_idx = 0; frame_idx < CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES; ++frame_idx)
+	// the frames in flight may still use its buffers and dsets, the deletion queue releases them once they're done
+	for (uint32_t frame_idx = 0; frame_idx < CSTS::MAX_FRAMES_IN_FLIGHT; ++frame_idx)
 	{
 		EntityFrameID efid{id, frame_idx};
 		get_rsrc_mgr().free_uniform_buffer(efid);
@@ -176,23 +224,34 @@ void GraphicsEngine::cleanup_entity(const ObjectID id)
 	}
 	objects.erase(id);
 	++num_objs_deleted;
+	invalidate_scene();
 }
 
 void GraphicsEngine::recreate_swap_chain()
 {
-	// TODO:
-	// Reimplement this, or don't since resizing window is very low priority
-
-	// // for when window is minimised
-	// int width = 0, height = 0;
-    // while (width == 0 || height == 0) {
-    //     glfwGetFramebufferSize(get_window(), &width, &height);
-    //     glfwWaitEvents();
-    // }
+	swap_chain.recreate_swap_chain();
+}
 
-	// vkDeviceWaitIdle(get_logical_device()); // we want to wait until resource is no longer in use
+void GraphicsEngine::apply_presentation_settings()
+{
+	auto& graphic_settings = get_gui_manager().graphic_settings;
+	if (graphic_settings.selected_present_mode.changed)
+	{
+		// in the order of GuiGraphicsSettings::present_modes
+		const std::array present_modes = { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+		swap_chain.set_present_mode(present_modes[graphic_settings.selected_present_mode]);
+		graphic_settings.selected_present_mode.changed = false;
+	}
 
-	// swap_chain.reset();
+	if (graphic_settings.frame_rate_cap.changed)
+	{
+#ifndef DISABLE_SLEEP
+		const int frame_rate_cap = graphic_settings.frame_rate_cap;
+		swap_chain.get_frame_pacer().set_target_interval(frame_rate_cap > 0 ?
+			std::chrono::nanoseconds(1'000'000'000 / frame_rate_cap) : std::chrono::nanoseconds(0));
+#endif
+		graphic_settings.frame_rate_cap.changed = false;
+	}
 }
 
 void GraphicsEngine::enqueue_cmd(std::unique_ptr<GraphicsEngineCommand>&& cmd)
@@ -210,6 +269,7 @@ VkCommandBuffer GraphicsEngine::begin_single_time_commands()
 
  	// start recording the command buffer
     vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	get_rsrc_mgr().record_pending_acquires(commandBuffer);
 
     return commandBuffer;
 }
@@ -218,26 +278,102 @@ void GraphicsEngine::end_single_time_commands(VkCommandBuffer command_buffer)
 {
     vkEndCommandBuffer(command_buffer);
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &command_buffer;
-
 	// note that unlike draw stage, we don't need to wait for anything here except for the queue to become idle
-    vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
+	// and the uploads the commands may read
+	submit_graphics(command_buffer);
     vkQueueWaitIdle(graphics_queue);
 
     vkFreeCommandBuffers(get_logical_device(), get_command_pool(), 1, &command_buffer);
 }
 
-VkExtent2D GraphicsEngine::get_extent()
+void GraphicsEngine::submit_graphics(
+	VkCommandBuffer command_buffer,
+	const std::vector<GraphicsEngineAsyncQueue::Wait>& waits,
+	VkSemaphore signal_semaphore,
+	VkFence fence)
 {
-	return GraphicsEngineSwapChain::get_extent(get_physical_device(), get_window_surface());
+	if (graphics_timeline_semaphore == VK_NULL_HANDLE)
+	{
+		graphics_timeline_semaphore = GraphicsEngineAsyncQueue::create_timeline_semaphore(get_logical_device());
+	}
+
+	std::vector<GraphicsEngineAsyncQueue::Wait> all_waits = waits;
+	// the acquires of the uploads come first in the command buffer, they wait for all of them
+	if (const auto wait = transfer_queue.get_wait(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT))
+	{
+		all_waits.push_back(*wait);
+	}
+	// only the ray tracing reads what the compute queue builds, everything before it can run alongside the builds
+	if (const auto wait = compute_queue.get_wait(VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR))
+	{
+		all_waits.push_back(*wait);
+	}
+
+	std::vector<VkSemaphore> wait_semaphores;
+	std::vector<uint64_t> wait_values;
+	std::vector<VkPipelineStageFlags> wait_stages;
+	for (const auto& wait : all_waits)
+	{
+		wait_semaphores.push_back(wait.semaphore);
+		wait_values.push_back(wait.value); // ignored for binary semaphores
+		wait_stages.push_back(wait.stages);
+	}
+
+	std::vector<VkSemaphore> signal_semaphores{graphics_timeline_semaphore};
+	std::vector<uint64_t> signal_values{++graphics_timeline_value};
+	if (signal_semaphore != VK_NULL_HANDLE)
+	{
+		signal_semaphores.push_back(signal_semaphore);
+		signal_values.push_back(0);
+	}
+
+	VkTimelineSemaphoreSubmitInfo timeline_info{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+	timeline_info.waitSemaphoreValueCount = static_cast<uint32_t>(wait_values.size());
+	timeline_info.pWaitSemaphoreValues = wait_values.data();
+	timeline_info.signalSemaphoreValueCount = static_cast<uint32_t>(signal_values.size());
+	timeline_info.pSignalSemaphoreValues = signal_values.data();
+
+	VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+	submit_info.pNext = &timeline_info;
+	submit_info.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size());
+	submit_info.pWaitSemaphores = wait_semaphores.data();
+	submit_info.pWaitDstStageMask = wait_stages.data();
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers = &command_buffer;
+	submit_info.signalSemaphoreCount = static_cast<uint32_t>(signal_semaphores.size());
+	submit_info.pSignalSemaphores = signal_semaphores.data();
+
+	if (vkQueueSubmit(graphics_queue, 1, &submit_info, fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("GraphicsEngine::submit_graphics: failed to submit command buffer!");
+	}
 }
 
-void GraphicsEngine::update_command_buffer()
+std::optional<GraphicsEngineAsyncQueue::Wait> GraphicsEngine::get_graphics_wait(VkPipelineStageFlags stages) const
 {
-	swap_chain.update_command_buffer();
+	if (graphics_timeline_value == 0)
+	{
+		return std::nullopt;
+	}
+
+	return GraphicsEngineAsyncQueue::Wait{graphics_timeline_semaphore, graphics_timeline_value, stages};
+}
+
+bool GraphicsEngine::is_graphics_complete(uint64_t value)
+{
+	if (graphics_timeline_semaphore == VK_NULL_HANDLE)
+	{
+		return true;
+	}
+
+	uint64_t completed = 0;
+	vkGetSemaphoreCounterValue(get_logical_device(), graphics_timeline_semaphore, &completed);
+	return completed >= value;
+}
+
+VkExtent2D GraphicsEngine::get_extent()
+{
+	return GraphicsEngineSwapChain::get_extent(get_physical_device(), get_window_surface());
 }
 
 void GraphicsEngine::create_image(uint32_t width,
@@ -304,7 +440,8 @@ VkImageView GraphicsEngine::create_image_view(
 	VkFormat format,
 	VkImageAspectFlags aspect_flags,
 	VkImageViewType view_type,
-	const uint32_t layer_count)
+	const uint32_t layer_count,
+	const uint32_t base_layer)
 {
 	VkImageViewCreateInfo create_info{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
 	create_info.image = image;
@@ -314,7 +451,7 @@ VkImageView GraphicsEngine::create_image_view(
 	create_info.subresourceRange.aspectMask = aspect_flags; // describes image purpose and which part should be accessed
 	create_info.subresourceRange.baseMipLevel = 0;
 	create_info.subresourceRange.levelCount = 1;
-	create_info.subresourceRange.baseArrayLayer = 0;
+	create_info.subresourceRange.baseArrayLayer = base_layer;
 	create_info.subresourceRange.layerCount = layer_count;
 
 	VkImageView image_view;
@@ -475,7 +612,8 @@ VkFormat GraphicsEngine::find_depth_format()
 			// we want the S8_UINT bit for stencil buffer
 			{VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
 			VK_IMAGE_TILING_OPTIMAL,
-			VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+			// the outline renderer samples the stencil
+			VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
 	}
 
 	return depth_format.value();
@@ -509,8 +647,8 @@ void GraphicsEngine::spawn_object_create_buffers(GraphicsEngineObject& graphics_
 		}
 	}
 
-	// these buffers are dynamic (changing between frames) and therefore requires duplicate buffers per swapchain image
-	for (uint32_t frame_idx = 0; frame_idx < CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES; ++frame_idx)
+	// these buffers are dynamic (changing between frames) and therefore requires duplicate buffers per frame in flight
+	for (uint32_t frame_idx = 0; frame_idx < CSTS::MAX_FRAMES_IN_FLIGHT; ++frame_idx)
 	{
 		// allocate space for object uniform buffer
 		rsrc_mgr.reserve_uniform_buffer(EntityFrameID{graphics_object.get_id(), frame_idx}, sizeof(SDS::ObjectData));
@@ -527,16 +665,19 @@ void GraphicsEngine::spawn_object_create_buffers(GraphicsEngineObject& graphics_
 		}
 	}
 
-	// TODO: needs to be fixed for raytracing
-	// SDS::BufferMapEntry buffer_map;
-	// buffer_map.vertex_offset = rsrc_mgr.get_vertex_buffer_offset(id);
-	// buffer_map.index_offset = rsrc_mgr.get_index_buffer_offset(id);
-	// // this is currently hardcoded to always use the first frame's uniform buffer
-	// // since the buffer map is only used for raytracing it's ignored for now
-	// // TODO: fix this
-	// buffer_map.uniform_offset = rsrc_mgr.get_uniform_buffer_offset(EntityFrameID{id, 0});
-
-	// rsrc_mgr.write_to_mapping_buffer(id, buffer_map);
+	// the ray hit shader finds the object's mesh through this, indexed by the TLAS instance's custom index.
+	// There is one entry per object so objects with several renderables are shaded with the first one's mesh
+	if (Config::is_raytracing_enabled() && !graphics_object.get_renderables().empty())
+	{
+		const auto& mesh = MeshSystem::get(graphics_object.get_renderables().front().mesh_id);
+		SDS::BufferMapEntry buffer_map;
+		buffer_map.vertex_offset = rsrc_mgr.get_vertex_buffer_offset(mesh.get_id());
+		buffer_map.index_offset = rsrc_mgr.get_index_buffer_offset(mesh.get_id());
+		// the buffer map is only used for raytracing which only reads the first frame's uniforms
+		buffer_map.uniform_offset = rsrc_mgr.get_uniform_buffer_offset(EntityFrameID{graphics_object.get_id(), 0});
+		buffer_map.index_size = mesh.get_index_size();
+		rsrc_mgr.write_to_mapping_buffer(graphics_object.get_id(), buffer_map);
+	}
 }
 
 void GraphicsEngine::spawn_object_create_dsets(GraphicsEngineObject& object)
@@ -545,7 +686,7 @@ void GraphicsEngine::spawn_object_create_dsets(GraphicsEngineObject& object)
 	// currently the resources that are per obj just happen to be purely dynamic and so all of them need a separate
 	// buffer + dset for each frame
 	std::vector<VkDescriptorSet> object_dsets;
-	for (uint32_t frame_idx = 0; frame_idx < CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES; ++frame_idx)
+	for (uint32_t frame_idx = 0; frame_idx < CSTS::MAX_FRAMES_IN_FLIGHT; ++frame_idx)
 	{
 		VkDescriptorSet new_descriptor_set = get_rsrc_mgr().reserve_dset(get_rsrc_mgr().get_per_obj_dset_layout());
 		std::vector<VkWriteDescriptorSet> descriptor_writes;
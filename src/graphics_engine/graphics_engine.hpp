@@ -6,6 +6,9 @@
 #include "graphics_engine_swap_chain.hpp"
 #include "graphics_engine_instance.hpp"
 #include "graphics_engine_device.hpp"
+#include "graphics_engine_async_queue.hpp"
+#include "graphics_engine_deletion_queue.hpp"
+#include "graphics_engine_command_recorder.hpp"
 #include "resource_manager/graphics_resource_manager.hpp"
 #include "graphics_engine_commands.hpp"
 #include "graphics_engine_object.hpp"
@@ -44,6 +47,8 @@ public:
 
 public:
 	bool is_wireframe_mode = false;
+	// stenciled objects are outlined by the outline renderer rather than drawn again, see OutlineRenderer
+	bool is_outline_mode = true;
 
 public: // getters and setters
 	VkExtent2D get_extent();
@@ -64,9 +69,14 @@ public: // getters and setters
 	VkInstance& get_instance() { return instance.get(); }
 	VkQueue& get_present_queue() { return present_queue; }
 	VkQueue& get_graphics_queue() { return graphics_queue; }
+	GraphicsEngineAsyncQueue& get_transfer_queue() { return transfer_queue; }
+	GraphicsEngineAsyncQueue& get_compute_queue() { return compute_queue; }
+	GraphicsEngineDeletionQueue& get_deletion_queue() { return deletion_queue; }
+	GraphicsEngineCommandRecorder& get_command_recorder() { return command_recorder; }
 	VkSurfaceKHR& get_window_surface() { return instance.window_surface; }
 	GraphicsEngineSwapChain& get_swap_chain() { return swap_chain; }
 	static constexpr uint32_t get_num_swapchain_images() { return CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES; }
+	static constexpr uint32_t get_num_frames_in_flight() { return CSTS::MAX_FRAMES_IN_FLIGHT; }
 	VkCommandPool& get_command_pool() { return get_rsrc_mgr().get_command_pool(); }
 	GraphicsEnginePipelineManager& get_pipeline_mgr() { return pipeline_mgr; }
 	GraphicsEngineTextureManager& get_texture_mgr() { return texture_mgr; }
@@ -85,11 +95,27 @@ public: // getters and setters
 	uint64_t get_num_objs_deleted() const final { return num_objs_deleted; }
 	void increment_num_objs_deleted() final { ++num_objs_deleted; }
 	void cleanup_entity(const ObjectID id);
+	// bumped whenever what the renderers record changes, i.e. spawns, deletes, stencils, pipelines,
+	// visibility or LODs, the cached draw commands recorded at an older version are recorded again
+	uint64_t get_scene_version() const { return scene_version; }
+	void invalidate_scene() { ++scene_version; }
+	// hash of the visibility and LODs selected for the frame, see GraphicsEngineFrame::select_lods
+	void update_draw_state(size_t draw_state_hash)
+	{
+		if (draw_state_hash != last_draw_state_hash)
+		{
+			last_draw_state_hash = draw_state_hash;
+			invalidate_scene();
+		}
+	}
 
 private:
 	bool should_shutdown = false;
 	VkQueue graphics_queue;
 	VkQueue present_queue;
+	// signalled by every graphics queue submission
+	VkSemaphore graphics_timeline_semaphore = VK_NULL_HANDLE;
+	uint64_t graphics_timeline_value = 0;
 	std::unordered_map<ObjectID, std::unique_ptr<GraphicsEngineObject>> objects;
 	std::unordered_set<ObjectID> stenciled_objects;
 	// currently used for OffscreenGuiViewportRenderer, in future we should have a scene system
@@ -101,16 +127,29 @@ private:
 	std::optional<VkFormat> depth_format;
 	float fps = 0.0f;
 	uint64_t num_objs_deleted = 0; // used for synchronisation, and knowing when an obj is safe to delete in game engine
+	uint64_t scene_version = 0;
+	size_t last_draw_state_hash = 0;
 
 // if confused about the different vulkan definitions see here
 // https://stackoverflow.com/questions/39557141/what-is-the-difference-between-framebuffer-and-image-in-vulkan
 
 public: // swap chain
 	void recreate_swap_chain(); // useful for when size of window is changing
-	void update_command_buffer();
 	VkCommandBuffer begin_single_time_commands();
 	void end_single_time_commands(VkCommandBuffer command_buffer);
 
+	// submits to the graphics queue, it waits for the uploads and acceleration structure builds
+	// submitted before it as well as the given waits, and signals the graphics timeline
+	void submit_graphics(
+		VkCommandBuffer command_buffer, 
+		const std::vector<GraphicsEngineAsyncQueue::Wait>& waits = {},
+		VkSemaphore signal_semaphore = VK_NULL_HANDLE,
+		VkFence fence = VK_NULL_HANDLE);
+	// for async queue work that writes something the rendering submitted so far may still read
+	std::optional<GraphicsEngineAsyncQueue::Wait> get_graphics_wait(VkPipelineStageFlags stages) const;
+	uint64_t get_graphics_timeline_value() const { return graphics_timeline_value; }
+	bool is_graphics_complete(uint64_t value);
+
 	// utilizes vkQueueWaitIdle to ensure that once the function returns, the data is copied into the staging buffer
 	void copy_buffer(VkBuffer src_buffer, VkBuffer dest_buffer, size_t size);
 
@@ -133,7 +172,8 @@ public: // swap chain
 								  VkFormat format,
 						   		  VkImageAspectFlags aspect_flags,
 								  VkImageViewType view_type = VkImageViewType::VK_IMAGE_VIEW_TYPE_2D,
-								  const uint32_t layer_count = 1); // for cube map
+								  const uint32_t layer_count = 1, // for cube map
+								  const uint32_t base_layer = 0); // for a single layer of a layered image
 
 	void transition_image_layout(
 		VkImage image, 
@@ -158,6 +198,12 @@ private: // core components
 	GraphicsEngineInstance instance;
 	GraphicsEngineValidationLayer validation_layer;
 	GraphicsEngineDevice device;
+	GraphicsEngineAsyncQueue transfer_queue;
+	GraphicsEngineAsyncQueue compute_queue;
+	// declared before every module that frees GPU resources, so it outlives them
+	GraphicsEngineDeletionQueue deletion_queue;
+	// outlives the renderers, its command pools hold their cached command buffers
+	GraphicsEngineCommandRecorder command_recorder;
 	GraphicsEngineTextureManager texture_mgr;
 	GraphicsResourceManager rsrc_mgr;
 	RendererManager renderer_mgr;
@@ -173,12 +219,15 @@ public: // commands
 	void handle_command(UnStencilObjectCmd& cmd) final;
 	void handle_command(ShutdownCmd& cmd) final;
 	void handle_command(ToggleWireFrameModeCmd& cmd) final;
+	void handle_command(ToggleOutlineModeCmd& cmd) final;
 	void handle_command(UpdateCommandBufferCmd& cmd) final;
 	void handle_command(UpdateRayTracingCmd& cmd) final;
 	void handle_command(PreviewObjectsCmd& cmd) final;
 	void handle_command(DestroyResourcesCmd& cmd) final;
 
 private:
+	// present mode and frame rate cap from the graphics settings
+	void apply_presentation_settings();
 	void spawn_object_create_buffers(GraphicsEngineObject& obj);
 	void spawn_object_create_dsets(GraphicsEngineObject& obj);
 };
\ No newline at end of file
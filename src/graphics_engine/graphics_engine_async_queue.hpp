@@ -0,0 +1,66 @@
+#pragma once
+
+#include "graphics_engine_base_module.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <deque>
+#include <optional>
+#include <vector>
+
+
+// A queue next to the graphics one, i.e. the transfer or async compute queue, on the graphics family
+// when the device has no dedicated one for the work.
+// Every submission signals the next value of a timeline semaphore, work that depends on it waits for
+// that value on the GPU instead of the CPU waiting for the queue to become idle
+class GraphicsEngineAsyncQueue : public GraphicsEngineBaseModule
+{
+public:
+	struct Wait
+	{
+		VkSemaphore semaphore;
+		uint64_t value;
+		VkPipelineStageFlags stages;
+	};
+
+	static VkSemaphore create_timeline_semaphore(VkDevice device);
+
+	GraphicsEngineAsyncQueue(GraphicsEngine& engine, uint32_t family);
+	GraphicsEngineAsyncQueue(const GraphicsEngineAsyncQueue&) = delete;
+	~GraphicsEngineAsyncQueue();
+
+	// command buffers on the graphics family take ownership of the uploads that are still pending first
+	VkCommandBuffer begin_commands();
+	// returns the value the timeline semaphore reaches once the commands have executed
+	uint64_t submit(VkCommandBuffer command_buffer, const std::vector<Wait>& waits = {});
+
+	bool is_complete(uint64_t value);
+	void wait(uint64_t value);
+	void wait_idle() { wait(last_submitted); }
+
+	// waits for everything submitted so far, nothing to wait for before the first submission
+	std::optional<Wait> get_wait(VkPipelineStageFlags stages) const;
+
+	uint32_t get_family() const { return family; }
+	// false when it's on the graphics family, buffers then don't change owners between the two
+	bool is_dedicated() const { return dedicated; }
+	uint64_t get_last_submitted() const { return last_submitted; }
+
+private:
+	void free_completed_command_buffers();
+
+	const uint32_t family;
+	bool dedicated;
+	VkQueue queue;
+	VkCommandPool command_pool;
+	VkSemaphore timeline_semaphore;
+	uint64_t last_submitted = 0;
+
+	struct InFlightCommandBuffer
+	{
+		VkCommandBuffer command_buffer;
+		uint64_t value;
+	};
+
+	std::deque<InFlightCommandBuffer> in_flight;
+};
\ No newline at end of file
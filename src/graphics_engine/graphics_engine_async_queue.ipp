@@ -0,0 +1,157 @@
+#pragma once
+
+#include "graphics_engine_async_queue.hpp"
+#include "graphics_engine.hpp"
+
+#include <limits>
+
+
+VkSemaphore GraphicsEngineAsyncQueue::create_timeline_semaphore(VkDevice device)
+{
+	VkSemaphoreTypeCreateInfo semaphore_type_info{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+	semaphore_type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	semaphore_type_info.initialValue = 0;
+	VkSemaphoreCreateInfo semaphore_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+	semaphore_info.pNext = &semaphore_type_info;
+
+	VkSemaphore semaphore;
+	if (vkCreateSemaphore(device, &semaphore_info, nullptr, &semaphore) != VK_SUCCESS)
+	{
+		throw std::runtime_error("GraphicsEngineAsyncQueue: failed to create timeline semaphore!");
+	}
+
+	return semaphore;
+}
+
+GraphicsEngineAsyncQueue::GraphicsEngineAsyncQueue(GraphicsEngine& engine, uint32_t family) :
+	GraphicsEngineBaseModule(engine),
+	family(family),
+	dedicated(family != engine.get_device_module().get_queue_family_indices().graphicsFamily.value())
+{
+	// on the graphics family this is the graphics queue itself
+	vkGetDeviceQueue(get_logical_device(), family, 0, &queue);
+
+	VkCommandPoolCreateInfo command_pool_create_info{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+	command_pool_create_info.queueFamilyIndex = family;
+	command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	if (vkCreateCommandPool(get_logical_device(), &command_pool_create_info, nullptr, &command_pool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("GraphicsEngineAsyncQueue: failed to create command pool!");
+	}
+
+	timeline_semaphore = create_timeline_semaphore(get_logical_device());
+}
+
+GraphicsEngineAsyncQueue::~GraphicsEngineAsyncQueue()
+{
+	wait_idle();
+	free_completed_command_buffers();
+	vkDestroySemaphore(get_logical_device(), timeline_semaphore, nullptr);
+	vkDestroyCommandPool(get_logical_device(), command_pool, nullptr);
+}
+
+VkCommandBuffer GraphicsEngineAsyncQueue::begin_commands()
+{
+	free_completed_command_buffers();
+
+	VkCommandBufferAllocateInfo allocation_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+	allocation_info.commandPool = command_pool;
+	allocation_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocation_info.commandBufferCount = 1;
+
+	VkCommandBuffer command_buffer;
+	if (vkAllocateCommandBuffers(get_logical_device(), &allocation_info, &command_buffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("GraphicsEngineAsyncQueue: failed to allocate command buffer!");
+	}
+
+	VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(command_buffer, &begin_info);
+
+	if (!dedicated)
+	{
+		get_rsrc_mgr().record_pending_acquires(command_buffer);
+	}
+
+	return command_buffer;
+}
+
+uint64_t GraphicsEngineAsyncQueue::submit(VkCommandBuffer command_buffer, const std::vector<Wait>& waits)
+{
+	vkEndCommandBuffer(command_buffer);
+
+	std::vector<VkSemaphore> wait_semaphores;
+	std::vector<uint64_t> wait_values;
+	std::vector<VkPipelineStageFlags> wait_stages;
+	for (const Wait& wait : waits)
+	{
+		wait_semaphores.push_back(wait.semaphore);
+		wait_values.push_back(wait.value);
+		wait_stages.push_back(wait.stages);
+	}
+
+	const uint64_t signal_value = last_submitted + 1;
+	VkTimelineSemaphoreSubmitInfo timeline_info{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+	timeline_info.waitSemaphoreValueCount = static_cast<uint32_t>(wait_values.size());
+	timeline_info.pWaitSemaphoreValues = wait_values.data();
+	timeline_info.signalSemaphoreValueCount = 1;
+	timeline_info.pSignalSemaphoreValues = &signal_value;
+
+	VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+	submit_info.pNext = &timeline_info;
+	submit_info.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size());
+	submit_info.pWaitSemaphores = wait_semaphores.data();
+	submit_info.pWaitDstStageMask = wait_stages.data();
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers = &command_buffer;
+	submit_info.signalSemaphoreCount = 1;
+	submit_info.pSignalSemaphores = &timeline_semaphore;
+
+	if (vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS)
+	{
+		throw std::runtime_error("GraphicsEngineAsyncQueue: failed to submit command buffer!");
+	}
+
+	last_submitted = signal_value;
+	in_flight.push_back({command_buffer, signal_value});
+
+	return signal_value;
+}
+
+bool GraphicsEngineAsyncQueue::is_complete(uint64_t value)
+{
+	uint64_t completed = 0;
+	vkGetSemaphoreCounterValue(get_logical_device(), timeline_semaphore, &completed);
+	return completed >= value;
+}
+
+void GraphicsEngineAsyncQueue::wait(uint64_t value)
+{
+	VkSemaphoreWaitInfo wait_info{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+	wait_info.semaphoreCount = 1;
+	wait_info.pSemaphores = &timeline_semaphore;
+	wait_info.pValues = &value;
+	vkWaitSemaphores(get_logical_device(), &wait_info, std::numeric_limits<uint64_t>::max());
+}
+
+std::optional<GraphicsEngineAsyncQueue::Wait> GraphicsEngineAsyncQueue::get_wait(VkPipelineStageFlags stages) const
+{
+	if (last_submitted == 0)
+	{
+		return std::nullopt;
+	}
+
+	return Wait{timeline_semaphore, last_submitted, stages};
+}
+
+void GraphicsEngineAsyncQueue::free_completed_command_buffers()
+{
+	uint64_t completed = 0;
+	vkGetSemaphoreCounterValue(get_logical_device(), timeline_semaphore, &completed);
+	while (!in_flight.empty() && in_flight.front().value <= completed)
+	{
+		vkFreeCommandBuffers(get_logical_device(), command_pool, 1, &in_flight.front().command_buffer);
+		in_flight.pop_front();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "graphics_engine_base_module.hpp"
+#include "worker_pool.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <vector>
+
+
+// Records secondary command buffers on several threads. A command pool and the command buffers allocated
+// from it may only be used by one thread at a time, so every worker has its own pool.
+// The graphics thread itself is worker 0, it runs the first job while the worker threads run the others
+// and then waits for them, the results are stitched into its primary command buffer in order
+class GraphicsEngineCommandRecorder : public GraphicsEngineBaseModule
+{
+public:
+	// below this a job costs more to hand over than to record on the graphics thread
+	static constexpr size_t MIN_OBJECTS_PER_JOB = 256;
+	static constexpr uint32_t MAX_WORKERS = 8;
+
+	GraphicsEngineCommandRecorder(GraphicsEngine& engine);
+	GraphicsEngineCommandRecorder(const GraphicsEngineCommandRecorder&) = delete;
+	~GraphicsEngineCommandRecorder();
+
+	uint32_t get_num_workers() const { return command_pools.size(); }
+	// the number of jobs to split the given number of objects into
+	uint32_t get_num_jobs(size_t num_objects) const;
+
+	// runs job(worker_idx) for the first num_jobs workers and returns once all of them are done,
+	// a job may only use command buffers allocated from the pool of its worker
+	void run(uint32_t num_jobs, const std::function<void(uint32_t worker_idx)>& job) { workers.run(num_jobs, job); }
+
+	VkCommandPool get_command_pool(uint32_t worker_idx) const { return command_pools[worker_idx]; }
+	VkCommandBuffer allocate_secondary_command_buffer(uint32_t worker_idx);
+
+private:
+	std::vector<VkCommandPool> command_pools;
+	// worker 0 is the graphics thread
+	WorkerPool workers;
+};
\ No newline at end of file
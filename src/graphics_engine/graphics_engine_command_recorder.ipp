@@ -0,0 +1,66 @@
+#pragma once
+
+#include "graphics_engine_command_recorder.hpp"
+#include "graphics_engine.hpp"
+
+#include <algorithm>
+#include <thread>
+
+
+namespace
+{
+	uint32_t get_default_num_workers()
+	{
+		// the game engine has a thread of its own
+		return std::clamp(std::thread::hardware_concurrency(), 2u, GraphicsEngineCommandRecorder::MAX_WORKERS + 1) - 1;
+	}
+}
+
+GraphicsEngineCommandRecorder::GraphicsEngineCommandRecorder(GraphicsEngine& engine) :
+	GraphicsEngineBaseModule(engine),
+	workers(get_default_num_workers(), "GraphicsRecorder")
+{
+	VkCommandPoolCreateInfo command_pool_create_info{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+	command_pool_create_info.queueFamilyIndex = engine.get_device_module().get_queue_family_indices().graphicsFamily.value();
+	// the cached command buffers are reset one by one when they're recorded again
+	command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	command_pools.resize(workers.get_num_workers());
+	for (VkCommandPool& command_pool : command_pools)
+	{
+		if (vkCreateCommandPool(get_logical_device(), &command_pool_create_info, nullptr, &command_pool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("GraphicsEngineCommandRecorder: failed to create command pool!");
+		}
+	}
+}
+
+GraphicsEngineCommandRecorder::~GraphicsEngineCommandRecorder()
+{
+	// destroying a pool frees the command buffers allocated from it, the workers are idle between runs
+	for (VkCommandPool command_pool : command_pools)
+	{
+		vkDestroyCommandPool(get_logical_device(), command_pool, nullptr);
+	}
+}
+
+uint32_t GraphicsEngineCommandRecorder::get_num_jobs(size_t num_objects) const
+{
+	const size_t num_jobs = (num_objects + MIN_OBJECTS_PER_JOB - 1) / MIN_OBJECTS_PER_JOB;
+	return uint32_t(std::clamp<size_t>(num_jobs, 1, get_num_workers()));
+}
+
+VkCommandBuffer GraphicsEngineCommandRecorder::allocate_secondary_command_buffer(uint32_t worker_idx)
+{
+	VkCommandBufferAllocateInfo allocation_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+	allocation_info.commandPool = command_pools[worker_idx];
+	allocation_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+	allocation_info.commandBufferCount = 1;
+
+	VkCommandBuffer command_buffer;
+	if (vkAllocateCommandBuffers(get_logical_device(), &allocation_info, &command_buffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("GraphicsEngineCommandRecorder: failed to allocate command buffer!");
+	}
+
+	return command_buffer;
+}
\ No newline at end of file
@@ -47,6 +47,11 @@ void ToggleWireFrameModeCmd::process(GraphicsEngineBase* engine)
 	engine->handle_command(*this);
 }
 
+void ToggleOutlineModeCmd::process(GraphicsEngineBase* engine)
+{
+	engine->handle_command(*this);
+}
+
 void UpdateCommandBufferCmd::process(GraphicsEngineBase* engine)
 {
 	engine->handle_command(*this);
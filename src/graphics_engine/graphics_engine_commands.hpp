@@ -62,6 +62,12 @@ struct ToggleWireFrameModeCmd : public GraphicsEngineCommand
 	virtual void process(GraphicsEngineBase* engine) override;
 };
 
+// outlines the stenciled objects in a single full-screen pass instead of drawing them again
+struct ToggleOutlineModeCmd : public GraphicsEngineCommand
+{
+	virtual void process(GraphicsEngineBase* engine) override;
+};
+
 struct UpdateCommandBufferCmd : public GraphicsEngineCommand
 {
 	virtual void process(GraphicsEngineBase* engine) override;
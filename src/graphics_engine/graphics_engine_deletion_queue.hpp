@@ -0,0 +1,41 @@
+#pragma once
+
+#include "graphics_engine_base_module.hpp"
+
+#include <deque>
+#include <functional>
+
+
+// Destroys GPU resources once the GPU is done with them, without waiting for it.
+// A resource is stamped with the values the graphics, transfer and compute timelines reach once everything
+// submitted so far has executed, and it's released once all of them are passed. Logical deletion,
+// i.e. freeing an id or erasing an object, is immediate
+class GraphicsEngineDeletionQueue : public GraphicsEngineBaseModule
+{
+public:
+	GraphicsEngineDeletionQueue(GraphicsEngine& engine);
+	GraphicsEngineDeletionQueue(const GraphicsEngineDeletionQueue&) = delete;
+
+	// the submissions made from here on can't use the resource anymore
+	void push(std::function<void()>&& release);
+	// releases the resources the GPU is done with, called once per frame
+	void process();
+	// releases everything and from then on releases straight away, the device has to be idle.
+	// For shutting down, when modules free their resources as they're destroyed
+	void release_all();
+
+	size_t get_num_pending() const { return pending.size(); }
+
+private:
+	struct PendingRelease
+	{
+		uint64_t graphics_value;
+		uint64_t transfer_value;
+		uint64_t compute_value;
+		std::function<void()> release;
+	};
+
+	// in the order they were pushed, so the stamps only ever increase
+	std::deque<PendingRelease> pending;
+	bool is_released_immediately = false;
+};
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "graphics_engine_deletion_queue.hpp"
+#include "graphics_engine.hpp"
+#include "profiler.hpp"
+
+
+GraphicsEngineDeletionQueue::GraphicsEngineDeletionQueue(GraphicsEngine& engine) :
+	GraphicsEngineBaseModule(engine)
+{
+}
+
+void GraphicsEngineDeletionQueue::push(std::function<void()>&& release)
+{
+	if (is_released_immediately)
+	{
+		release();
+		return;
+	}
+
+	GraphicsEngine& engine = get_graphics_engine();
+	pending.push_back({
+		engine.get_graphics_timeline_value(),
+		engine.get_transfer_queue().get_last_submitted(),
+		engine.get_compute_queue().get_last_submitted(),
+		std::move(release) });
+}
+
+void GraphicsEngineDeletionQueue::process()
+{
+	PROFILE_SCOPE("GraphicsEngineDeletionQueue::process");
+
+	GraphicsEngine& engine = get_graphics_engine();
+	while (!pending.empty())
+	{
+		const PendingRelease& front = pending.front();
+		if (!engine.is_graphics_complete(front.graphics_value) ||
+			!engine.get_transfer_queue().is_complete(front.transfer_value) ||
+			!engine.get_compute_queue().is_complete(front.compute_value))
+		{
+			break;
+		}
+
+		front.release();
+		pending.pop_front();
+	}
+}
+
+void GraphicsEngineDeletionQueue::release_all()
+{
+	while (!pending.empty())
+	{
+		pending.front().release();
+		pending.pop_front();
+	}
+	is_released_immediately = true;
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "graphics_engine_base_module.hpp"
+#include "queues.hpp"
 
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_beta.h>
@@ -23,6 +24,9 @@ public:
 
 	const VkPhysicalDeviceProperties2& get_physical_device_properties();
 	VkDeviceAddress get_buffer_device_address(VkBuffer buffer);	
+	const QueueFamilyIndices& get_queue_family_indices() const { return queue_family_indices; }
+	// VK_KHR_present_id and VK_KHR_present_wait are only enabled when the device supports both
+	bool supports_present_wait() const { return present_wait_supported; }
 
 	VkPhysicalDeviceRayTracingPipelinePropertiesKHR get_ray_tracing_properties() const 
 	{ 
@@ -42,7 +46,10 @@ private:
 	void pick_physical_device();
 	void create_logical_device();
 	bool check_device_extension_support(VkPhysicalDevice device);
+	bool check_present_wait_support(VkPhysicalDevice device);
 
+	QueueFamilyIndices queue_family_indices;
+	bool present_wait_supported = false;
 	std::optional<VkPhysicalDeviceProperties2> physical_device_properties;
 	VkPhysicalDeviceRayTracingPipelinePropertiesKHR ray_tracing_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR};
 };
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <fmt/core.h>
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <iostream>
 #include <set>
 #include <string_view>
@@ -124,14 +125,51 @@ bool GraphicsEngineDevice::check_device_extension_support(VkPhysicalDevice devic
 	return required_extensions_set.empty();
 }
 
+bool GraphicsEngineDevice::check_present_wait_support(VkPhysicalDevice device)
+{
+#ifdef __APPLE__
+	return false;
+#else
+	uint32_t extension_count;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, nullptr);
+	std::vector<VkExtensionProperties> available_extensions(extension_count);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, available_extensions.data());
+
+	const auto is_available = [&](std::string_view name)
+	{
+		return std::ranges::any_of(available_extensions, [name](const VkExtensionProperties& extension)
+		{
+			return name == extension.extensionName;
+		});
+	};
+	if (!is_available(VK_KHR_PRESENT_ID_EXTENSION_NAME) || !is_available(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+	{
+		return false;
+	}
+
+	VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR};
+	VkPhysicalDevicePresentIdFeaturesKHR present_id_features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR};
+	present_id_features.pNext = &present_wait_features;
+	VkPhysicalDeviceFeatures2 features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+	features.pNext = &present_id_features;
+	vkGetPhysicalDeviceFeatures2(device, &features);
+
+	return present_id_features.presentId && present_wait_features.presentWait;
+#endif
+}
+
 void GraphicsEngineDevice::create_logical_device()
 {
-	QueueFamilyIndices indices = get_graphics_engine().findQueueFamilies(physicalDevice);
+	queue_family_indices = get_graphics_engine().findQueueFamilies(physicalDevice);
+	const QueueFamilyIndices& indices = queue_family_indices;
 
 	std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
-	std::vector<uint32_t> unique_queue_families{
+	// a family can only be listed once, the transfer and compute families fall back to the graphics one
+	std::set<uint32_t> unique_queue_families{
 		indices.graphicsFamily.value(),
-		indices.presentFamily.value()
+		indices.presentFamily.value(),
+		indices.getTransferFamily(),
+		indices.getComputeFamily()
 	};
 	// vulkan allows for some queues to have higher priority than others
 	const float queue_priority = 1.0f;
@@ -148,11 +186,26 @@ void GraphicsEngineDevice::create_logical_device()
 	VkDeviceCreateInfo create_info{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
 	create_info.pQueueCreateInfos = queue_create_infos.data();
 	create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
-	const auto required_device_extensions = get_required_extensions();
-	create_info.enabledExtensionCount = static_cast<uint32_t>(required_device_extensions.size());
-	create_info.ppEnabledExtensionNames = required_device_extensions.data();
+	auto device_extensions = get_required_extensions();
 	create_info.pNext = get_required_features();
 
+	// lets the frame pacer wait until a frame is displayed
+	VkPhysicalDevicePresentIdFeaturesKHR present_id_features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR};
+	VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR};
+	present_wait_supported = check_present_wait_support(physicalDevice);
+	if (present_wait_supported)
+	{
+		device_extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+		device_extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+		present_id_features.presentId = true;
+		present_wait_features.presentWait = true;
+		present_id_features.pNext = &present_wait_features;
+		present_wait_features.pNext = const_cast<void*>(create_info.pNext);
+		create_info.pNext = &present_id_features;
+	}
+	create_info.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
+	create_info.ppEnabledExtensionNames = device_extensions.data();
+
 	if (vkCreateDevice(physicalDevice, &create_info, nullptr, &logical_device) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to create logical device!");
@@ -161,6 +214,8 @@ void GraphicsEngineDevice::create_logical_device()
 	// retrieves the queue handles
 	vkGetDeviceQueue(logical_device, indices.presentFamily.value(), 0, &get_graphics_engine().get_present_queue());
 	vkGetDeviceQueue(logical_device, indices.graphicsFamily.value(), 0, &get_graphics_engine().get_graphics_queue());
+
+	LOG_INFO(Utility::get_logger(), "GraphicsEngineDevice: present wait supported: {}", present_wait_supported);
 }
 
 void GraphicsEngineDevice::print_physical_device_settings()
@@ -236,6 +291,8 @@ VkPhysicalDeviceFeatures2* GraphicsEngineDevice::get_required_features()
 	static VkPhysicalDeviceVulkan12Features device_features12{
 		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
 	device_features12.bufferDeviceAddress = true;
+	// the transfer and compute queues signal their progress on timeline semaphores
+	device_features12.timelineSemaphore = true;
 
 	// link up the structs to create a chain of features
 	device_features2.pNext = &device_features12;
@@ -3,70 +3,77 @@
 #include "graphics_engine_base_module.hpp"
 #include "identifications.hpp"
 #include "analytics.hpp"
+#include "light_clusters.hpp"
 
 #include <vulkan/vulkan.hpp>
 
-#include <queue>
 
 
 class GraphicsEngineSwapChain;
 
 class GraphicsEngineObject;
 
-// Note that frame refers to swap_chain frame and not actual frames
+// an image of the swap chain and what's needed to render into and present it, it's owned by the swap chain
+struct SwapChainImage
+{
+	VkImage image;
+	// Interprets a VkImage and describes how to access it
+	VkImageView image_view;
+	// indexes the per image resources of the renderers, i.e. framebuffers and attachments
+	uint32_t image_index;
+	// signalled once rendering into the image is finished and waited on by the present, it belongs to the image
+	// and not to the frame since the present may still wait on it when the frame is recorded again
+	VkSemaphore render_finished_semaphore;
+	// fence of the frame in flight that last rendered into the image, not owned
+	VkFence fence_frame_inflight = VK_NULL_HANDLE;
+};
+
+// A frame in flight, the CPU records and submits a frame while the GPU executes the ones before it.
+// Frames aren't tied to swap chain images, a frame renders into whichever image is acquired for it
 class GraphicsEngineFrame : public GraphicsEngineBaseModule
 {
 public:
-	GraphicsEngineFrame(GraphicsEngine& engine, GraphicsEngineSwapChain& parent_swapchain, VkImage image);
+	GraphicsEngineFrame(GraphicsEngine& engine, GraphicsEngineSwapChain& parent_swapchain, uint32_t frame_index);
 	GraphicsEngineFrame(const GraphicsEngineFrame&) = delete;
 	GraphicsEngineFrame(GraphicsEngineFrame&& frame) noexcept;
 	~GraphicsEngineFrame();
 
 public:
-	void update_command_buffer();
-	void draw();
+	// waits until the GPU finished the last submission of this frame, after which its resources can be reused
+	void wait_until_available();
+	// records, submits and presents the frame into the acquired image,
+	// returns false when the swap chain is out of date and has to be recreated
+	bool draw(SwapChainImage& image);
+	// signalled when the image acquired for this frame is ready to be rendered into
+	VkSemaphore get_image_available_semaphore() const { return image_available_semaphore; }
 
 private:
+	void update_command_buffer(const SwapChainImage& image);
 	void update_uniform_buffer();
 	void create_synchronisation_objects();
-	
-	// this function does stuff that needs to be done before cmd buffer is recorded
-	// i.e. check for objects to be deleted
-	void pre_cmdbuffer_recording();
+
+	// picks the LOD of every renderable from its projected size on screen
+	void select_lods();
 
 public:
-	// Interprets a VkImage and describes how to access it
-	VkImageView presentation_image_view;
 	VkCommandBuffer command_buffer;
 
-	const uint32_t image_index;
-	
-	// delete object
-	void mark_obj_for_delete(ObjectID id);
+	// indexes the per frame uniform regions and descriptor sets
+	const uint32_t frame_index;
 
 private:
 	
 	GraphicsEngineSwapChain& swap_chain;
 
-	//
-	// Image refers to an image in a swap chain
-	// Frame refers to a "canvas" being processed (i.e. by GPU) we can think of frames as being in-flight
-	// We produce a frame from a swapchain image and return it back to the image for presentation oncec we
-	//  are done processing it.
-	//
-
 	// GPU-GPU synchronisation
 	VkSemaphore image_available_semaphore;
-	VkSemaphore render_finished_semaphore;
 
 	// CPU-GPU synchronisation
-	// these track for each swap chain image and checks if an inflight frame is currently using it
-	VkFence fence_frame_inflight = VK_NULL_HANDLE; // signals when the command buffer finishes executing or when an inflight frame is finished
-	VkFence fence_image_inflight = VK_NULL_HANDLE; // check if a frame in flight is already using a swapchain image 
-
-	static int global_image_index;
+	VkFence fence_frame_inflight = VK_NULL_HANDLE; // signals when the command buffer finishes executing i.e. when the frame is no longer in flight
 
 	Analytics analytics;
 
-	std::queue<ObjectID> objs_to_delete;
+	// the point lights binned for this frame, kept to reuse its allocations
+	std::vector<SDS::PointLight> point_lights;
+	LightClusters light_clusters;
 };
\ No newline at end of file
@@ -8,53 +8,44 @@
 #include "shared_data_structures.hpp"
 #include "camera.hpp"
 #include "pipeline/pipeline.hpp"
+#include "renderers/renderers.hpp"
 #include "renderable/render_types.hpp"
+#include "profiler.hpp"
 
 #include "entity_component_system/ecs.hpp"
+#include "entity_component_system/mesh_system.hpp"
 
 #include <glm/gtx/string_cast.hpp>
 
 #include <iostream>
+#include <algorithm>
 
 
-int GraphicsEngineFrame::global_image_index = 0;
-
 GraphicsEngineFrame::GraphicsEngineFrame(
 	GraphicsEngine& engine, 
 	GraphicsEngineSwapChain& parent_swapchain, 
-	VkImage presentation_image) :
+	uint32_t frame_index) :
 	GraphicsEngineBaseModule(engine),
+	frame_index(frame_index),
 	swap_chain(parent_swapchain),
-	image_index(global_image_index++),
 	analytics(60)
 {
-	presentation_image_view = get_graphics_engine().create_image_view(
-		presentation_image, 
-		swap_chain.get_image_format(), 
-		VK_IMAGE_ASPECT_COLOR_BIT);
-	for (Renderer* renderer : get_graphics_engine().get_renderer_mgr().get_renderers())
-	{
-		renderer->allocate_per_frame_resources(presentation_image, presentation_image_view);
-	}
-
 	create_synchronisation_objects();
 	command_buffer = get_rsrc_mgr().create_command_buffer();
 
-	analytics.text = std::string("Frame ") + std::to_string(image_index);
+	analytics.text = std::string("Frame ") + std::to_string(frame_index);
 }
 
 GraphicsEngineFrame::GraphicsEngineFrame(GraphicsEngineFrame&& frame) noexcept :
 	GraphicsEngineBaseModule(frame.get_graphics_engine()),
-	presentation_image_view(std::move(frame.presentation_image_view)),
 	command_buffer(std::move(frame.command_buffer)),
-	image_index(std::move(frame.image_index)),
+	frame_index(std::move(frame.frame_index)),
 	swap_chain(frame.swap_chain),
 	image_available_semaphore(std::move(frame.image_available_semaphore)),
-	render_finished_semaphore(std::move(frame.render_finished_semaphore)),
 	fence_frame_inflight(std::move(frame.fence_frame_inflight)),
-	fence_image_inflight(std::move(frame.fence_image_inflight)),
 	analytics(std::move(frame.analytics)),
-	objs_to_delete(std::move(frame.objs_to_delete))
+	point_lights(std::move(frame.point_lights)),
+	light_clusters(std::move(frame.light_clusters))
 {
 	frame.should_destroy = false;
 }
@@ -66,59 +57,63 @@ GraphicsEngineFrame::~GraphicsEngineFrame()
 		return;
 	}
 
-	global_image_index--;
 	vkFreeCommandBuffers(get_logical_device(), get_graphics_engine().get_command_pool(), 1, &command_buffer);
 
 	// cleanup synchronisation objects
 	vkDestroySemaphore(get_logical_device(), image_available_semaphore, nullptr);
-	vkDestroySemaphore(get_logical_device(), render_finished_semaphore, nullptr);
 	vkDestroyFence(get_logical_device(), fence_frame_inflight, nullptr);
-	// vkDestroyFence(get_logical_device(), fence_image_inflight, nullptr); // this isn't an actual fence it's rather a reference to the inflight frame fence
-	vkDestroyImageView(get_logical_device(), presentation_image_view, nullptr);
 }
 
-void GraphicsEngineFrame::update_command_buffer()
+void GraphicsEngineFrame::wait_until_available()
+{
+	analytics.start();
+	// CPU-GPU synchronisation for in flight frames
+	{
+		PROFILE_SCOPE("wait_frame_fence");
+		vkWaitForFences(get_logical_device(), 1, &fence_frame_inflight, VK_TRUE, std::numeric_limits<uint64_t>::max());
+	}
+	analytics.stop();
+}
+
+void GraphicsEngineFrame::update_command_buffer(const SwapChainImage& image)
 {
-	// wait until command buffer is not used anymore i.e. when frame is no longer inflight
-	vkWaitForFences(get_logical_device(), 1, &fence_frame_inflight, VK_TRUE, std::numeric_limits<uint64_t>::max());
+	PROFILE_SCOPE("GraphicsEngineFrame::update_command_buffer");
+
+	// the command buffer isn't used anymore, the frame was waited for before its image was acquired
 	VkCommandBufferResetFlags reset_flags = 0;
 	vkResetCommandBuffer(command_buffer, reset_flags);
 
 	// starting command buffer recording
 	VkCommandBufferBeginInfo begin_info{};
 	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	begin_info.flags = 0;
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // recorded again every frame
 	begin_info.pInheritanceInfo = nullptr;
 
 	if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to begin recording command buffer!");
 	}
+	// take ownership of the buffers the transfer queue wrote since the last graphics commands
+	get_rsrc_mgr().record_pending_acquires(command_buffer);
 
-	//
-	// do stuff that needs to be done before we record a new command buffer
-	// i.e. deleting objects
-	//
-	pre_cmdbuffer_recording();
+	select_lods();
+	// the shadow casters are culled against the cascades while recording, the uniforms are written after
+	auto& shadow_map_renderer = static_cast<ShadowMapRenderer&>(
+		get_graphics_engine().get_renderer_mgr().get_renderer(ERendererType::SHADOW_MAP));
+	shadow_map_renderer.update_cascades();
 
-	auto& renderer_mgr = get_graphics_engine().get_renderer_mgr();
-	if (get_graphics_engine().get_gui_manager().graphic_settings.rtx_on)
-	{
-		renderer_mgr.get_renderer(ERendererType::RAYTRACING).submit_draw_commands(command_buffer, presentation_image_view, image_index);
-	} else
+	// dsets are picked by the frame, attachments and framebuffers by the image
+	get_graphics_engine().get_renderer_mgr().record_frame(command_buffer, image, frame_index);
+
+	Renderer::CommandCacheStatistics command_cache_statistics;
+	for (Renderer* renderer : get_graphics_engine().get_renderer_mgr().get_renderers())
 	{
-		renderer_mgr.get_renderer(ERendererType::SHADOW_MAP).submit_draw_commands(command_buffer, presentation_image_view, image_index);
-		renderer_mgr.get_renderer(ERendererType::RASTERIZATION).submit_draw_commands(command_buffer, presentation_image_view, image_index);
-		renderer_mgr.get_renderer(ERendererType::QUAD).submit_draw_commands(command_buffer, presentation_image_view, image_index);
+		const auto renderer_statistics = renderer->take_command_cache_statistics();
+		command_cache_statistics.num_hits += renderer_statistics.num_hits;
+		command_cache_statistics.num_misses += renderer_statistics.num_misses;
 	}
-
-	// Offscreen
-	renderer_mgr.get_renderer(ERendererType::OFFSCREEN_GUI_VIEWPORT).submit_draw_commands(
-		command_buffer, presentation_image_view, image_index);
-
-	// ImGui
-	renderer_mgr.get_renderer(ERendererType::GUI).submit_draw_commands(
-		command_buffer, presentation_image_view, image_index);
+	get_graphics_engine().get_gui_manager().update_command_cache_statistics(
+		command_cache_statistics.num_hits, command_cache_statistics.num_misses);
 	
 	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
 	{
@@ -126,51 +121,24 @@ void GraphicsEngineFrame::update_command_buffer()
 	}
 }
 
-void GraphicsEngineFrame::draw()
+bool GraphicsEngineFrame::draw(SwapChainImage& image)
 {
-	// 1. acquire image from swap chain
+	// 1. record the command buffer for the acquired image
 	// 2. execute command buffer with image as attachment in the frame buffer
 	// 3. return the image to swap chain for presentation
 
-	analytics.start();
-	// CPU-GPU synchronisation for in flight images
-	vkWaitForFences(get_logical_device(), 1, &fence_frame_inflight, VK_TRUE, std::numeric_limits<uint64_t>::max());
-	analytics.stop();
+	// recorded once an image is acquired, a recording that is never submitted would drop the pending acquires
+	update_command_buffer(image);
 
-	update_command_buffer();
-
-	uint32_t swap_chain_image_index;
-	// waits until there's an image available to use in the swap chain
-	VkResult result = vkAcquireNextImageKHR(get_logical_device(), 
-											swap_chain.get_swap_chain(), 
-											std::numeric_limits<uint64_t>::max(), // wait time (ns)
-											image_available_semaphore, 
-											VK_NULL_HANDLE, 
-											&swap_chain_image_index); // image index of the available image
-	if (image_index != swap_chain_image_index)
-	{
-		throw std::runtime_error("image_index and swap_chain_image_index mismatch!");
-	}											
-	if (result != VK_SUCCESS)
+	// check if a frame that is still in flight is using this image (i.e. there is a fence to wait on),
+	// images may be acquired out of order so it isn't necessarily the frame before this one
+	if (image.fence_frame_inflight != VK_NULL_HANDLE && image.fence_frame_inflight != fence_frame_inflight)
 	{
-		throw std::runtime_error("failed to acquire swapchain image!");
-	}
-	// if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-	// 	reset();
-	// 	return;
-	// } else if (image_index != swap_chain_image_index) {
-	// 	throw std::runtime_error("image_index and swap_chain_image_index mismatch!");
-	// } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-	// 	throw std::runtime_error("failed to acquire swap chain image!");
-	// }
-
-	// check if a previous frame is using this image (i.e. there is a fence to wait on)
-	if (fence_image_inflight != VK_NULL_HANDLE)
-	{
-		vkWaitForFences(get_logical_device(), 1, &fence_image_inflight, VK_TRUE, std::numeric_limits<uint64_t>::max());
+		PROFILE_SCOPE("wait_image_fence");
+		vkWaitForFences(get_logical_device(), 1, &image.fence_frame_inflight, VK_TRUE, std::numeric_limits<uint64_t>::max());
 	}
 	// mark the image as now being in use by this frame
-	fence_image_inflight = fence_frame_inflight;
+	image.fence_frame_inflight = fence_frame_inflight;
 
 	update_uniform_buffer();
 
@@ -178,30 +146,16 @@ void GraphicsEngineFrame::draw()
 	// submitting the command buffer
 	//
 
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-	VkSemaphore waitSemaphores[] = { image_available_semaphore };
-	VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-	// here we specify which semaphore to wait on before execution begins and in which stage of the pipeline to wait
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
-
-	// here we specify which command buffers to actually submit for execution
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &command_buffer;
-
-	// here we specify the semaphores to signal once the command buffer has finished execution
-	VkSemaphore signal_semaphores[] = { render_finished_semaphore };
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = signal_semaphores;
-
+	// here we specify which semaphore to wait on before execution begins and in which stage of the pipeline to wait,
+	// the uploads and acceleration structure builds this frame reads are waited for as well
+	// and the semaphore to signal once the command buffer has finished execution
+	VkSemaphore signal_semaphores[] = { image.render_finished_semaphore };
 	vkResetFences(get_logical_device(), 1, &fence_frame_inflight);
-	if (vkQueueSubmit(get_graphics_engine().get_graphics_queue(), 1, &submitInfo, fence_frame_inflight) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to submit draw command buffer!");
-	}
+	get_graphics_engine().submit_graphics(
+		command_buffer,
+		{ { image_available_semaphore, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT } },
+		image.render_finished_semaphore,
+		fence_frame_inflight);
 
 	//
 	// Presentation
@@ -215,24 +169,33 @@ void GraphicsEngineFrame::draw()
 
 	present_info.swapchainCount = 1;
 	present_info.pSwapchains = &swap_chain.get_swap_chain();
-	present_info.pImageIndices = &image_index;
+	present_info.pImageIndices = &image.image_index;
 	present_info.pResults = nullptr; // allows you to specify array of VkResult values to check for every individual swap chain if presentation was successful
+	// lets the frame pacer wait until this frame is displayed
+	swap_chain.get_frame_pacer().attach_present_id(present_info);
 
-	result = vkQueuePresentKHR(get_graphics_engine().get_present_queue(), &present_info);
-	if (result != VK_SUCCESS) {
+	VkResult result;
+	{
+		PROFILE_SCOPE("vkQueuePresentKHR");
+		result = vkQueuePresentKHR(get_graphics_engine().get_present_queue(), &present_info);
+	}
+	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		return false;
+	}
+	if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) 
+	{
 		throw std::runtime_error("failed to present swap chain image!");
 	}
+	swap_chain.get_frame_pacer().on_present();
 
-	// if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || frame_buffer_resized) { // recreate if we resize window
-	// 	frame_buffer_resized = false;
-	// 	reset();
-	// } else if (result != VK_SUCCESS) {
-	// 	throw std::runtime_error("failed to present swap chain image!");
-	// }
+	return result == VK_SUCCESS;
 }
 
 void GraphicsEngineFrame::update_uniform_buffer()
 {
+	PROFILE_SCOPE("GraphicsEngineFrame::update_uniform_buffer");
+
 	// update global uniform buffer
 	const auto& graphic_settings = get_graphics_engine().get_graphics_gui_manager().get_graphic_settings();
 	SDS::GlobalData gubo;
@@ -246,45 +209,51 @@ void GraphicsEngineFrame::update_uniform_buffer()
 	gubo.light_pos = light_source.get_game_object().get_position();
 	gubo.lighting_scalar = graphic_settings.light_strength;
 
-	get_rsrc_mgr().write_to_global_uniform_buffer(image_index, gubo);
+	// the cascades the shadow maps of this frame were recorded with, see update_command_buffer
+	const auto& cascades = static_cast<ShadowMapRenderer&>(
+		get_graphics_engine().get_renderer_mgr().get_renderer(ERendererType::SHADOW_MAP)).get_cascades();
+	for (uint32_t cascade = 0; cascade < SDS::SHADOW_MAP_NUM_CASCADES; ++cascade)
+	{
+		gubo.shadow_cascade_view_proj[cascade] = cascades[cascade].view_proj;
+		gubo.shadow_cascade_splits[cascade] = cascades[cascade].split_depth;
+	}
 
-	// TODO: this is a hacky approach, this will not work with multiple light sources
-	// we will need to eventually fix this up properly
-	
-	const auto get_shadow_view_proj_matrix = [&](const glm::vec3& obj_pos) -> glm::mat4
+	// every other light is a point light, shaded through the clusters it reaches into
+	point_lights.clear();
+	for (const auto& [id, light] : get_graphics_engine().get_ecs().get_light_components())
 	{
-		// const glm::mat4 view = glm::lookAtLH(
-		// 	gubo.light_pos,
-		// 	obj_pos, 
-		// 	Maths::forward_vec);
-		const glm::mat4 view = glm::lookAtLH(
-			gubo.light_pos + Maths::up_vec, 
-			gubo.light_pos, 
-			Maths::forward_vec);
-		// const glm::vec2 horizontal_span = { -10.0f, 10.0f };
-		// const glm::mat4 proj = glm::orthoLH(
-		// 	horizontal_span.x, 
-		// 	horizontal_span.y, 
-		// 	horizontal_span.x, 
-		// 	horizontal_span.y, 
-		// 	0.1f, 
-		// 	250.0f);
-
-		// const auto resolution = Maths::deg2rad(45.0f); // higher is lower
-		const auto resolution = Maths::deg2rad(135.0f); // higher is lower
-		const glm::mat4 proj = glm::perspectiveLH(resolution, 1.0f, 0.1f, 250.0f);
-		return proj * view;
-	};
+		const auto object = get_graphics_engine().get_objects().find(id);
+		if (id == entity || object == get_graphics_engine().get_objects().end() || 
+			object->second->is_marked_for_delete() || !object->second->get_visibility())
+		{
+			continue;
+		}
+		if (point_lights.size() == SDS::MAX_POINT_LIGHTS)
+		{
+			break;
+		}
+
+		SDS::PointLight& point_light = point_lights.emplace_back();
+		point_light.pos = object->second->get_game_object().get_position();
+		point_light.radius = light.radius;
+		point_light.color = light.color * light.intensity;
+	}
+	light_clusters.build(gubo.view, gubo.proj, point_lights);
+	gubo.light_cluster_near_depth = light_clusters.get_near_depth();
+	gubo.light_cluster_slice_scale = light_clusters.get_slice_scale();
+	get_rsrc_mgr().write_to_light_buffers(
+		frame_index, point_lights, light_clusters.get_clusters(), light_clusters.get_light_indices());
+
+	get_rsrc_mgr().write_to_global_uniform_buffer(frame_index, gubo);
 
 	// update per object uniforms
 	SDS::ObjectData object_data{};
 	for (const auto& [id, graphics_object] : get_graphics_engine().get_objects())
 	{
-		EntityFrameID efid{graphics_object->get_id(), image_index};
+		EntityFrameID efid{graphics_object->get_id(), frame_index};
 		object_data.model = graphics_object->get_game_object().get_transform();
 		object_data.mvp = gubo.proj * gubo.view * object_data.model;
 		object_data.rot_mat = glm::mat4_cast(graphics_object->get_game_object().get_rotation());
-		object_data.shadow_mvp = get_shadow_view_proj_matrix(graphics_object->get_game_object().get_position()) * object_data.model;
 		get_rsrc_mgr().write_to_uniform_buffer(efid, object_data);
 
 		// if object contains skinned meshes update the bone matrices
@@ -296,16 +265,66 @@ void GraphicsEngineFrame::update_uniform_buffer()
 			}
 
 			std::vector<SDS::Bone> bones = get_graphics_engine().get_ecs().get_bones(*renderable.skeleton_id);
-			std::ranges::for_each(bones, [transform=object_data.model, &get_shadow_view_proj_matrix](SDS::Bone& bone) {
+			std::ranges::for_each(bones, [transform=object_data.model](SDS::Bone& bone) {
 				bone.final_transform = transform * bone.final_transform;
-				const glm::vec3 DUMMY_POS = {0.0f, 0.0f, 0.0f};
-				bone.shadow_transform = get_shadow_view_proj_matrix(DUMMY_POS);
 			});
-			get_rsrc_mgr().write_to_buffer(SkeletonFrameID(*renderable.skeleton_id, image_index), bones);
+			get_rsrc_mgr().write_to_buffer(SkeletonFrameID(*renderable.skeleton_id, frame_index), bones);
 		}
 	}
 }
 
+void GraphicsEngineFrame::select_lods()
+{
+	PROFILE_SCOPE("GraphicsEngineFrame::select_lods");
+
+	const Camera& camera = *get_graphics_engine().get_camera();
+	// pixels covered by one unit at unit distance, proj[1][1] = 1 / tan(fov / 2)
+	const float pixels_per_unit = std::abs(camera.get_projection()[1][1]) * 0.5f * float(get_graphics_engine().get_extent().height);
+	const glm::vec3 camera_pos = camera.get_position();
+
+	uint32_t full_triangles = 0;
+	uint32_t drawn_triangles = 0;
+	// what the renderers skip or draw at which LOD, the cached draw commands are recorded again when it changes
+	size_t draw_state_hash = 0;
+	const auto combine_draw_state = [&draw_state_hash](size_t value)
+	{
+		draw_state_hash ^= value + 0x9e3779b9 + (draw_state_hash << 6) + (draw_state_hash >> 2);
+	};
+	for (const auto& [id, graphics_object] : get_graphics_engine().get_objects())
+	{
+		combine_draw_state(std::hash<ObjectID>{}(id));
+		combine_draw_state(graphics_object->get_visibility());
+		combine_draw_state(graphics_object->is_marked_for_delete());
+
+		const Object& object = graphics_object->get_game_object();
+		const glm::vec3 scale = glm::abs(object.get_scale());
+		const float max_scale = std::max({ scale.x, scale.y, scale.z });
+		// avoid blowing up when the camera is inside the object, LOD 0 is picked either way
+		const float distance = std::max(glm::length(object.get_position() - camera_pos), 1e-3f);
+
+		const auto& renderables = graphics_object->get_renderables();
+		auto& lods = graphics_object->get_renderable_lods();
+		lods.resize(renderables.size(), 0);
+		for (uint32_t renderable_idx = 0; renderable_idx < renderables.size(); renderable_idx++)
+		{
+			const Renderable& renderable = renderables[renderable_idx];
+			const Mesh& mesh = MeshSystem::get(renderable.mesh_id);
+			const float projected_radius = mesh.get_bounding_radius() * max_scale * pixels_per_unit / distance;
+			lods[renderable_idx] = renderable.select_lod(projected_radius, lods[renderable_idx]);
+			combine_draw_state(lods[renderable_idx]);
+
+			if (!graphics_object->is_marked_for_delete() && graphics_object->get_visibility())
+			{
+				full_triangles += mesh.get_num_vertex_indices() / 3;
+				drawn_triangles += mesh.get_lod(lods[renderable_idx]).num_indices / 3;
+			}
+		}
+	}
+
+	get_graphics_engine().get_gui_manager().update_lod_statistics(full_triangles, drawn_triangles);
+	get_graphics_engine().update_draw_state(draw_state_hash);
+}
+
 void GraphicsEngineFrame::create_synchronisation_objects()
 {
 	VkSemaphoreCreateInfo semaphore_create_info{};
@@ -316,26 +335,8 @@ void GraphicsEngineFrame::create_synchronisation_objects()
 	fence_create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
 	if (vkCreateSemaphore(get_logical_device(), &semaphore_create_info, nullptr, &image_available_semaphore) != VK_SUCCESS ||
-		vkCreateSemaphore(get_logical_device(), &semaphore_create_info, nullptr, &render_finished_semaphore) != VK_SUCCESS ||
 		vkCreateFence(get_logical_device(), &fence_create_info, nullptr, &fence_frame_inflight) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to create semaphores!");
 	}
-}
-
-void GraphicsEngineFrame::mark_obj_for_delete(ObjectID id)
-{
-	objs_to_delete.push(id);
-}
-
-void GraphicsEngineFrame::pre_cmdbuffer_recording()
-{
-	// Note: this code works since when we mark an object for deletion we only do so on the currently in flight frame.
-	// So therefore this function only gets called once the inflight frame finishes
-	// and all the frames gets cycled once. That means no frame would be using the affected resources.
-	while (!objs_to_delete.empty())
-	{
-		get_graphics_engine().cleanup_entity(objs_to_delete.front());
-		objs_to_delete.pop();
-	}
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "graphics_engine_base_module.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <chrono>
+#include <optional>
+
+
+// Paces the graphics loop off when frames are displayed instead of sleeping for a fixed period.
+// With VK_KHR_present_wait and FIFO presents the loop blocks until the frame before the last presented one
+// has been displayed, so at most one frame waits for the display, the frame times are then measured between
+// displays. Otherwise, i.e. mailbox where frames are meant to be replaced before they're displayed,
+// frame times are measured between presents and only the target interval limits the loop
+class GraphicsEngineFramePacer : public GraphicsEngineBaseModule
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	struct Statistics
+	{
+		float mean_ms = 0.0f;
+		float std_dev_ms = 0.0f;
+		float max_ms = 0.0f;
+	};
+
+	GraphicsEngineFramePacer(GraphicsEngine& engine);
+
+	// zero lets the present mode decide, i.e. the refresh rate with FIFO
+	void set_target_interval(std::chrono::nanoseconds interval) { target_interval = interval; }
+	std::chrono::nanoseconds get_target_interval() const { return target_interval; }
+
+	// called before any work on the next frame
+	void pace();
+
+	// chains the id of the present to the present info, returns false when present ids aren't supported
+	bool attach_present_id(VkPresentInfoKHR& present_info);
+	void on_present();
+	// ids belong to a swap chain, waiting on the ones of a retired swap chain is invalid
+	void on_swap_chain_recreated();
+
+	const Statistics& get_statistics() const { return statistics; }
+
+private:
+	bool waits_for_presents();
+	void record_frame_time(clock::time_point frame_end);
+	void update_statistics();
+
+	std::chrono::nanoseconds target_interval{0};
+
+	// ids are shared by every swap chain, they only have to keep increasing
+	VkPresentIdKHR present_id_info{VK_STRUCTURE_TYPE_PRESENT_ID_KHR};
+	uint64_t next_present_id = 1;
+	uint64_t last_present_id = 0;
+	// frames that weren't presented, i.e. when the swap chain is out of date, have nothing new to wait for
+	uint64_t last_waited_present_id = 0;
+	uint64_t first_present_id_of_swap_chain = 1;
+
+	// when the work on the last frame started, the next one starts a target interval later
+	std::optional<clock::time_point> last_frame_start;
+	// when the last frame was displayed, or presented without present waits
+	std::optional<clock::time_point> last_frame_end;
+
+	static constexpr size_t NUM_FRAME_TIMES = 120;
+	std::array<float, NUM_FRAME_TIMES> frame_times_ms{};
+	size_t num_frame_times = 0;
+	size_t frame_time_idx = 0;
+	Statistics statistics;
+};
\ No newline at end of file
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "graphics_engine_frame_pacer.hpp"
+#include "graphics_engine.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+
+GraphicsEngineFramePacer::GraphicsEngineFramePacer(GraphicsEngine& engine) :
+	GraphicsEngineBaseModule(engine)
+{
+}
+
+void GraphicsEngineFramePacer::pace()
+{
+	PROFILE_SCOPE("GraphicsEngineFramePacer::pace");
+
+	if (waits_for_presents())
+	{
+		// let one frame wait for the display while the next one is prepared, waiting for the last present
+		// would leave the GPU idle while the CPU records
+		const uint64_t present_id = last_present_id > 0 ? last_present_id - 1 : 0;
+		if (present_id >= first_present_id_of_swap_chain && present_id > last_waited_present_id)
+		{
+			const uint64_t timeout_ns = 100'000'000; // don't hang when the window stops being displayed, i.e. minimised
+			const VkResult result = LOAD_VK_FUNCTION(vkWaitForPresentKHR)(
+				get_logical_device(),
+				get_graphics_engine().get_swap_chain().get_swap_chain(),
+				present_id,
+				timeout_ns);
+			last_waited_present_id = present_id;
+			if (result == VK_SUCCESS)
+			{
+				record_frame_time(clock::now());
+			} else
+			{
+				// timed out or the swap chain went away, the time waited isn't a frame time and neither is the gap to the next display
+				last_frame_end.reset();
+			}
+		}
+	}
+
+	const clock::time_point now = clock::now();
+	if (target_interval.count() > 0 && last_frame_start)
+	{
+		// absolute deadlines, oversleeping one frame doesn't push back the ones after it
+		const clock::time_point deadline = *last_frame_start + std::chrono::duration_cast<clock::duration>(target_interval);
+		if (now < deadline)
+		{
+			std::this_thread::sleep_until(deadline);
+			last_frame_start = deadline;
+			return;
+		}
+	}
+	last_frame_start = now;
+}
+
+bool GraphicsEngineFramePacer::attach_present_id(VkPresentInfoKHR& present_info)
+{
+	if (!get_graphics_engine().get_device_module().supports_present_wait())
+	{
+		return false;
+	}
+
+	present_id_info.swapchainCount = 1;
+	present_id_info.pPresentIds = &next_present_id;
+	present_id_info.pNext = present_info.pNext;
+	present_info.pNext = &present_id_info;
+	return true;
+}
+
+void GraphicsEngineFramePacer::on_present()
+{
+	if (get_graphics_engine().get_device_module().supports_present_wait())
+	{
+		last_present_id = next_present_id++;
+	}
+
+	if (!waits_for_presents())
+	{
+		record_frame_time(clock::now());
+	}
+}
+
+void GraphicsEngineFramePacer::on_swap_chain_recreated()
+{
+	first_present_id_of_swap_chain = next_present_id;
+	// the time spent recreating isn't a frame time
+	last_frame_start.reset();
+	last_frame_end.reset();
+}
+
+bool GraphicsEngineFramePacer::waits_for_presents()
+{
+	return get_graphics_engine().get_device_module().supports_present_wait() &&
+		get_graphics_engine().get_swap_chain().get_present_mode() == VK_PRESENT_MODE_FIFO_KHR;
+}
+
+void GraphicsEngineFramePacer::record_frame_time(clock::time_point frame_end)
+{
+	if (last_frame_end)
+	{
+		const std::chrono::duration<float, std::milli> frame_time = frame_end - *last_frame_end;
+		frame_times_ms[frame_time_idx] = frame_time.count();
+		frame_time_idx = (frame_time_idx + 1) % NUM_FRAME_TIMES;
+		num_frame_times = std::min(num_frame_times + 1, NUM_FRAME_TIMES);
+		update_statistics();
+	}
+
+	last_frame_end = frame_end;
+}
+
+void GraphicsEngineFramePacer::update_statistics()
+{
+	float sum = 0.0f;
+	float max = 0.0f;
+	for (size_t i = 0; i < num_frame_times; i++)
+	{
+		sum += frame_times_ms[i];
+		max = std::max(max, frame_times_ms[i]);
+	}
+	const float mean = sum / float(num_frame_times);
+
+	float variance = 0.0f;
+	for (size_t i = 0; i < num_frame_times; i++)
+	{
+		variance += (frame_times_ms[i] - mean) * (frame_times_ms[i] - mean);
+	}
+	variance /= float(num_frame_times);
+
+	statistics = { mean, std::sqrt(variance), max };
+	get_graphics_engine().get_gui_manager().update_frame_pacing_statistics(
+		statistics.mean_ms, statistics.std_dev_ms, statistics.max_ms);
+}
\ No newline at end of file
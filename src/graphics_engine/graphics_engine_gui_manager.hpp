@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 
 class GraphicsEngineGuiManager : public GraphicsEngineBaseModule, public GuiManager
@@ -22,6 +23,8 @@ public:
 		VkSampler sampler, 
 		VkImageView image_view, 
 		const glm::uvec2& dimensions);
+	// previews read from the offscreen renderer, which is sized after the swap chain
+	void on_swap_chain_recreated();
 
 	void setup_imgui();
 	// some gui_windows require setup in the graphics_engine thread
@@ -36,4 +39,8 @@ private:
 	using GuiManager::graphic_settings;
 	using GuiManager::object_spawner;
 	using GuiManager::fps_counter;
+
+	// for caching dsets
+	std::unordered_map<VkImageView, VkDescriptorSet> preview_dsets;
+	std::unordered_map<GuiPhotoBase*, VkSampler> preview_windows;
 };
\ No newline at end of file
@@ -62,16 +62,16 @@ void GraphicsEngineGuiManager::update_preview_window(
 	VkImageView image_view,
 	const glm::uvec2& dimensions)
 {
-	// for caching dsets
-	static std::unordered_map<VkImageView, VkDescriptorSet> dsets;
-	const auto it = dsets.find(image_view);
-	if (it != dsets.end())
+	preview_windows[&gui] = sampler;
+
+	const auto it = preview_dsets.find(image_view);
+	if (it != preview_dsets.end())
 	{
 		gui.update(it->second, dimensions);
 		return;
 	}
 
-	VkDescriptorSet dset = dsets.emplace(image_view, ImGui_ImplVulkan_AddTexture(
+	VkDescriptorSet dset = preview_dsets.emplace(image_view, ImGui_ImplVulkan_AddTexture(
 		sampler, 
 		image_view, 
 		VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)).first->second;
@@ -79,6 +79,20 @@ void GraphicsEngineGuiManager::update_preview_window(
 	gui.update(dset, dimensions);
 }
 
+void GraphicsEngineGuiManager::on_swap_chain_recreated()
+{
+	// the cached views were destroyed and their handles may be reused by the new ones, this version of
+	// the ImGui Vulkan backend can't free the old descriptor sets, resizes are rare enough to leak them
+	preview_dsets.clear();
+
+	Renderer& renderer = get_graphics_engine().get_renderer_mgr().get_renderer(ERendererType::OFFSCREEN_GUI_VIEWPORT);
+	const auto extent = renderer.get_extent();
+	for (const auto& [gui, sampler] : preview_windows)
+	{
+		update_preview_window(*gui, sampler, renderer.get_output_image_view(0), glm::uvec2(extent.width, extent.height));
+	}
+}
+
 void GraphicsEngineGuiManager::setup_imgui()
 {
 	ImGui::CreateContext();
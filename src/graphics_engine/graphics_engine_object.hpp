@@ -39,10 +39,18 @@ public:
 	const std::vector<VkDescriptorSet>& get_renderable_dsets() const { return renderable_dsets; }
 	void set_renderable_dsets(const std::vector<VkDescriptorSet>& dsets) { renderable_dsets = dsets; }
 
+	// selected LOD per renderable, see GraphicsEngineFrame::select_lods
+	uint32_t get_renderable_lod(uint32_t renderable_idx) const
+	{
+		return renderable_idx < renderable_lods.size() ? renderable_lods[renderable_idx] : 0;
+	}
+	std::vector<uint32_t>& get_renderable_lods() { return renderable_lods; }
+
 private:
 	bool marked_for_delete = false;
 	std::vector<VkDescriptorSet> renderable_dsets; // i.e. mesh data
 	std::vector<VkDescriptorSet> per_frame_object_dsets; // i.e. uniform buffer
+	std::vector<uint32_t> renderable_lods;
 };
 
 // this object derivation CAN be destroyed while graphics engine is running
@@ -2,6 +2,7 @@
 
 #include "graphics_engine_base_module.hpp"
 #include "graphics_engine_frame.hpp"
+#include "graphics_engine_frame_pacer.hpp"
 
 #include <vulkan/vulkan.hpp>
 
@@ -23,14 +24,15 @@ public:
 	GraphicsEngineSwapChain(GraphicsEngine& engine);
 	~GraphicsEngineSwapChain();
 
-	void reset();
-
 	static constexpr int EXPECTED_NUM_SWAPCHAIN_IMAGES = CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES;
-	void update_command_buffer();
+	static constexpr int NUM_FRAMES_IN_FLIGHT = CSTS::MAX_FRAMES_IN_FLIGHT;
 	void draw();
 
-	// TODO: deprecate this infavor of something more useful, i.e. recreating the entire swapchain
-	void destroy_and_recreate_frames();
+	// recreates the swap chain and everything sized after it for the current extent of the window,
+	// returns false while the window is minimised
+	bool recreate_swap_chain();
+	// falls back to FIFO when the surface doesn't support it, takes effect on the next frame
+	void set_present_mode(VkPresentModeKHR present_mode);
 
 public: // getters
 	VkFormat get_image_format() { return VK_FORMAT_B8G8R8A8_SRGB; }
@@ -41,28 +43,48 @@ public: // getters
 	static SwapChainSupportDetails query_swap_chain_support(VkPhysicalDevice physical_device, VkSurfaceKHR window_surface);
 	static VkExtent2D choose_swap_extent(VkSurfaceKHR window_surface, const VkSurfaceCapabilitiesKHR& capabilities);
 
-	uint32_t get_num_images() const { return frames.size(); }
+	uint32_t get_num_images() const { return images.size(); }
 	VkSwapchainKHR& get_swap_chain() { return swap_chain; }
+	VkPresentModeKHR get_present_mode() const { return present_mode; }
+	GraphicsEngineFramePacer& get_frame_pacer() { return frame_pacer; }
+	// renderers that don't depend on the swap chain keep their per frame resources while it's recreated
+	bool is_recreating() const { return recreating; }
 	// assuming swapchain draw call is last in the main graphics execution loop
 	// this will reflect the frame TO BE drawn
 	GraphicsEngineFrame& get_curr_frame() { return frames[current_frame]; }
+	// the frame submitted last
 	GraphicsEngineFrame& get_prev_frame() { return frames[(current_frame + frames.size() - 1) % frames.size()]; }
 
 private:
 		
-	VkSwapchainKHR swap_chain;
+	VkSwapchainKHR swap_chain = VK_NULL_HANDLE;
 	static std::optional<VkExtent2D> swap_chain_extent;
+	// images are replaced when the swap chain is recreated, the frames in flight are kept
+	std::vector<SwapChainImage> images;
 	std::vector<GraphicsEngineFrame> frames;
+	GraphicsEngineFramePacer frame_pacer;
 
 	VkSurfaceFormatKHR choose_swap_surface_format(const std::vector<VkSurfaceFormatKHR>& available_formats);
 	VkPresentModeKHR choose_swap_present_mode(const std::vector<VkPresentModeKHR>& available_present_modes);
-	// void recreate_swap_chain(); // useful for when size of window is changing
+	// the old swap chain is handed to the driver so it can reuse its resources
+	void create_swap_chain(VkSwapchainKHR old_swap_chain);
+	void create_images();
+	void destroy_images();
+	void create_frames();
+	// returns the index of the acquired image, or nothing when the swap chain is out of date
+	std::optional<uint32_t> acquire_next_image(GraphicsEngineFrame& frame, bool& suboptimal);
+	bool is_surface_extent_changed();
 
 private:
 	VkImage presentation_image;
 	VkDeviceMemory presentation_image_memory;
 
+	VkPresentModeKHR requested_present_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+	VkPresentModeKHR present_mode = VK_PRESENT_MODE_FIFO_KHR;
+
 private: // synchronisation
-	bool frame_buffer_resized = false;
+	// set when presenting reports the swap chain as out of date or suboptimal, or when its settings change
+	bool out_of_date = false;
+	bool recreating = false;
 	int current_frame = 0;
 };
\ No newline at end of file
@@ -7,21 +7,71 @@
 
 #include "graphics_engine.hpp"
 #include "objects/object.hpp"
+#include "camera.hpp"
 #include "utility.hpp"
 
 #include <quill/LogMacros.h>
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
 
 std::optional<VkExtent2D> GraphicsEngineSwapChain::swap_chain_extent;
 
-GraphicsEngineSwapChain::GraphicsEngineSwapChain(GraphicsEngine& engine) : GraphicsEngineBaseModule(engine)
+GraphicsEngineSwapChain::GraphicsEngineSwapChain(GraphicsEngine& engine) : 
+	GraphicsEngineBaseModule(engine),
+	frame_pacer(engine)
+{
+	create_swap_chain(VK_NULL_HANDLE);
+	create_images();
+	create_frames();
+
+	get_graphics_engine().get_renderer_mgr().linkup_renderers();
+}
+
+GraphicsEngineSwapChain::~GraphicsEngineSwapChain()
+{
+	// for (auto& frame_buffer : swap_chain_frame_buffers)
+	// {
+	// 	vkDestroyFramebuffer(get_logical_device(), frame_buffer, nullptr); // moved this to frame
+	// }
+
+	// vkFreeCommandBuffers(get_logical_device(), command_pool, static_cast<uint32_t>(command_buffers.size()), command_buffers.data()); // moved frame destructor
+
+	// for (auto& swap_chain_image : swap_chain_image_views)
+	// {
+	// 	vkDestroyImageView(get_logical_device(), swap_chain_image, nullptr);
+	// }
+
+	destroy_images();
+	vkDestroySwapchainKHR(get_logical_device(), swap_chain, nullptr);
+
+	// for (size_t i = 0; i < swap_chain_images.size(); i++)
+	// {
+	// 	vkDestroyBuffer(get_logical_device(), uniform_buffers[i], nullptr);
+	// 	vkFreeMemory(get_logical_device(), uniform_buffers_memory[i], nullptr);
+	// }
+
+	// vkDestroyDescriptorPool(get_logical_device(), descriptor_pool, nullptr);
+
+	// destroy synchronisation object
+	//for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	//{
+	//	vkDestroySemaphore(get_logical_device(), image_available_semaphores[i], nullptr);
+	//	vkDestroySemaphore(get_logical_device(), render_finished_semaphores[i], nullptr);
+	//	vkDestroyFence(get_logical_device(), in_flight_fences[i], nullptr);
+	//}
+
+	vkDestroyImage(get_logical_device(), presentation_image, nullptr);
+	vkFreeMemory(get_logical_device(), presentation_image_memory, nullptr);
+}
+
+void GraphicsEngineSwapChain::create_swap_chain(VkSwapchainKHR old_swap_chain)
 {
 	SwapChainSupportDetails swap_chain_support = query_swap_chain_support(get_physical_device(), get_graphics_engine().get_window_surface());
 	VkSurfaceFormatKHR surface_format = choose_swap_surface_format(swap_chain_support.formats);
-	VkPresentModeKHR present_mode = choose_swap_present_mode(swap_chain_support.presentModes);
+	present_mode = choose_swap_present_mode(swap_chain_support.presentModes);
 	const auto extent = get_extent();
 	get_graphics_engine().create_image(
 		extent.width, 
@@ -79,59 +129,73 @@ GraphicsEngineSwapChain::GraphicsEngineSwapChain(GraphicsEngine& engine) : Graph
 	create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;				 // useful if we want to blend with other windows in the window system, typically opaque
 	create_info.presentMode = present_mode;
 	create_info.clipped = true;				   // best performance (ignore pixels that are obscured by another window)
-	create_info.oldSwapchain = VK_NULL_HANDLE; // assume swap chain never gets invalidated (which can happen when we resize the window)
+	create_info.oldSwapchain = old_swap_chain; // VK_NULL_HANDLE unless the swap chain is being recreated, i.e. when the window is resized
 
 	if (vkCreateSwapchainKHR(get_logical_device(), &create_info, nullptr, &swap_chain) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to create swap chain!");
 	}
-
-	destroy_and_recreate_frames();
-
-	get_graphics_engine().get_renderer_mgr().linkup_renderers();
 }
 
-GraphicsEngineSwapChain::~GraphicsEngineSwapChain()
+bool GraphicsEngineSwapChain::recreate_swap_chain()
 {
-	// for (auto& frame_buffer : swap_chain_frame_buffers)
-	// {
-	// 	vkDestroyFramebuffer(get_logical_device(), frame_buffer, nullptr); // moved this to frame
-	// }
+	// a minimised window has no extent, nothing can be presented until it's restored
+	const VkSurfaceCapabilitiesKHR capabilities = query_swap_chain_support(
+		get_physical_device(), get_graphics_engine().get_window_surface()).capabilities;
+	if (capabilities.currentExtent.width == 0 || capabilities.currentExtent.height == 0)
+	{
+		return false;
+	}
 
-	// vkFreeCommandBuffers(get_logical_device(), command_pool, static_cast<uint32_t>(command_buffers.size()), command_buffers.data()); // moved frame destructor
+	// the frames in flight may still use everything that is about to be destroyed
+	vkDeviceWaitIdle(get_logical_device());
 
-	// for (auto& swap_chain_image : swap_chain_image_views)
-	// {
-	// 	vkDestroyImageView(get_logical_device(), swap_chain_image, nullptr);
-	// }
+	recreating = true;
+	destroy_images();
+	for (Renderer* renderer : get_graphics_engine().get_renderer_mgr().get_renderers())
+	{
+		if (renderer->depends_on_swap_chain())
+		{
+			renderer->free_per_frame_resources();
+		}
+	}
+	get_graphics_engine().get_renderer_mgr().free_transient_attachments();
+	vkDestroyImage(get_logical_device(), presentation_image, nullptr);
+	vkFreeMemory(get_logical_device(), presentation_image_memory, nullptr);
 
-	vkDestroySwapchainKHR(get_logical_device(), swap_chain, nullptr);
+	swap_chain_extent.reset();
+	VkSwapchainKHR old_swap_chain = swap_chain;
+	create_swap_chain(old_swap_chain);
+	vkDestroySwapchainKHR(get_logical_device(), old_swap_chain, nullptr);
 
-	// for (size_t i = 0; i < swap_chain_images.size(); i++)
-	// {
-	// 	vkDestroyBuffer(get_logical_device(), uniform_buffers[i], nullptr);
-	// 	vkFreeMemory(get_logical_device(), uniform_buffers_memory[i], nullptr);
-	// }
+	create_images();
+	recreating = false;
+	out_of_date = false;
 
-	// vkDestroyDescriptorPool(get_logical_device(), descriptor_pool, nullptr);
+	get_graphics_engine().get_pipeline_mgr().destroy_pipelines();
+	// the cached draw commands bind the destroyed pipelines
+	get_graphics_engine().invalidate_scene();
+	get_graphics_engine().get_graphics_gui_manager().on_swap_chain_recreated();
+	frame_pacer.on_swap_chain_recreated();
 
-	// destroy synchronisation object
-	//for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-	//{
-	//	vkDestroySemaphore(get_logical_device(), image_available_semaphores[i], nullptr);
-	//	vkDestroySemaphore(get_logical_device(), render_finished_semaphores[i], nullptr);
-	//	vkDestroyFence(get_logical_device(), in_flight_fences[i], nullptr);
-	//}
+	// the projection would stretch the image to the new extent otherwise
+	const VkExtent2D extent = get_extent();
+	get_graphics_engine().get_camera()->on_resize(float(extent.width) / float(extent.height));
+	LOG_INFO(Utility::get_logger(), "GraphicsEngineSwapChain: recreated swap chain, extent: {}x{}, present mode: {}", 
+		extent.width, extent.height, int(present_mode));
 
-	vkDestroyImage(get_logical_device(), presentation_image, nullptr);
-	vkFreeMemory(get_logical_device(), presentation_image_memory, nullptr);
+	return true;
 }
 
-void GraphicsEngineSwapChain::reset()
+void GraphicsEngineSwapChain::set_present_mode(VkPresentModeKHR present_mode)
 {
-	auto &engine = get_graphics_engine();
-	this->~GraphicsEngineSwapChain();
-	new (this) GraphicsEngineSwapChain(engine);
+	if (requested_present_mode == present_mode)
+	{
+		return;
+	}
+
+	requested_present_mode = present_mode;
+	out_of_date = true;
 }
 
 VkSurfaceFormatKHR GraphicsEngineSwapChain::choose_swap_surface_format(const std::vector<VkSurfaceFormatKHR> &available_formats)
@@ -151,7 +215,7 @@ VkPresentModeKHR GraphicsEngineSwapChain::choose_swap_present_mode(const std::ve
 {
 	for (const auto &mode : available_present_modes)
 	{
-		if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
+		if (mode == requested_present_mode)
 		{
 			return mode;
 		}
@@ -160,56 +224,137 @@ VkPresentModeKHR GraphicsEngineSwapChain::choose_swap_present_mode(const std::ve
 	return VK_PRESENT_MODE_FIFO_KHR; // guranteed
 }
 
-// // void GraphicsEngineSwapChain::recreate_swap_chain()
-// {
-// 	// clean_up_swap_chain(); // moved to destructor
-
-// 	// create_swap_chain();
-// 	// create_image_views();
-// 	// create_graphics_pipeline();
-// 	// create_frame_buffers();
-// 	// create_uniform_buffers(); // this one should be frame specific... we will work out details later
-// 	// create_descriptor_pools();
-// 	// create_descriptor_sets(); // moved to on object spawn basis
-// 	// 1 by 1 to recreate the descriptor sets appropriately
-// 	// create_command_buffers(); // moved to on object spawn basis
-// }
-
 void GraphicsEngineSwapChain::draw()
 {
-	get_curr_frame().draw();
+	// not every platform reports the swap chain as out of date when the window is resized
+	if ((out_of_date || is_surface_extent_changed()) && !recreate_swap_chain())
+	{
+		return;
+	}
+
+	// the frame is recorded while the GPU still executes the frames in flight before it
+	GraphicsEngineFrame& frame = get_curr_frame();
+	frame.wait_until_available();
+
+	bool acquired_suboptimal = false;
+	const std::optional<uint32_t> image_index = acquire_next_image(frame, acquired_suboptimal);
+	// nothing was acquired, the frame isn't submitted and is used again for the next one
+	if (!image_index)
+	{
+		out_of_date = true;
+		return;
+	}
+
+	// false when the swap chain turned out to be out of date, it's recreated before the next frame.
+	// A suboptimal swap chain can still be presented to, it's recreated after this frame
+	out_of_date = !frame.draw(images[*image_index]) || acquired_suboptimal;
 
 	current_frame = (current_frame + 1) % frames.size();
 }
 
-void GraphicsEngineSwapChain::destroy_and_recreate_frames()
+std::optional<uint32_t> GraphicsEngineSwapChain::acquire_next_image(GraphicsEngineFrame& frame, bool& suboptimal)
+{
+	uint32_t image_index;
+	// waits until there's an image available to use in the swap chain,
+	// images aren't necessarily returned in order, i.e. with mailbox
+	VkResult result = vkAcquireNextImageKHR(get_logical_device(), 
+											swap_chain, 
+											std::numeric_limits<uint64_t>::max(), // wait time (ns)
+											frame.get_image_available_semaphore(), 
+											VK_NULL_HANDLE, 
+											&image_index); // image index of the available image
+	// the semaphore isn't signalled and the fence of the frame is left signalled
+	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		return std::nullopt;
+	}
+	if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+	{
+		throw std::runtime_error("GraphicsEngineSwapChain::acquire_next_image: failed to acquire swapchain image!");
+	}
+
+	suboptimal = result == VK_SUBOPTIMAL_KHR;
+	return image_index;
+}
+
+bool GraphicsEngineSwapChain::is_surface_extent_changed()
+{
+	VkSurfaceCapabilitiesKHR capabilities;
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(get_physical_device(), get_graphics_engine().get_window_surface(), &capabilities);
+	if (capabilities.currentExtent.width == UINT32_MAX) // the surface takes its extent from the swap chain
+	{
+		return false;
+	}
+
+	const VkExtent2D extent = get_extent();
+	return capabilities.currentExtent.width != extent.width || capabilities.currentExtent.height != extent.height;
+}
+
+void GraphicsEngineSwapChain::create_images()
 {
 	uint32_t image_count;
 	vkGetSwapchainImagesKHR(get_logical_device(), swap_chain, &image_count, nullptr); // get num images
 	std::vector<VkImage> swap_chain_images(image_count);
 	vkGetSwapchainImagesKHR(get_logical_device(), swap_chain, &image_count, swap_chain_images.data());
 
-	frames.clear();
-	frames.reserve(swap_chain_images.size());
-	if (frames.capacity() < swap_chain_images.size() || swap_chain_images.size() != EXPECTED_NUM_SWAPCHAIN_IMAGES)
+	if (swap_chain_images.size() != EXPECTED_NUM_SWAPCHAIN_IMAGES)
 	{
-		throw std::runtime_error("GraphicsEngineSwapChain::GraphicsEngineSwapChain() ERROR in num swapchain images!");
+		throw std::runtime_error("GraphicsEngineSwapChain::create_images: ERROR in num swapchain images!");
 	}
-	for (auto &handle : swap_chain_images)
+
+	// the frame buffers of the renderers are made with them
+	get_graphics_engine().get_renderer_mgr().allocate_transient_attachments();
+
+	VkSemaphoreCreateInfo semaphore_create_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+	images.reserve(swap_chain_images.size());
+	for (uint32_t image_index = 0; image_index < swap_chain_images.size(); image_index++)
 	{
-		// create the frames
-		frames.emplace_back(get_graphics_engine(), *this, handle);
+		SwapChainImage image{};
+		image.image = swap_chain_images[image_index];
+		image.image_view = get_graphics_engine().create_image_view(
+			image.image, 
+			get_image_format(), 
+			VK_IMAGE_ASPECT_COLOR_BIT);
+		image.image_index = image_index;
+		if (vkCreateSemaphore(get_logical_device(), &semaphore_create_info, nullptr, &image.render_finished_semaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("GraphicsEngineSwapChain::create_images: failed to create semaphores!");
+		}
+
+		for (Renderer* renderer : get_graphics_engine().get_renderer_mgr().get_renderers())
+		{
+			if (recreating && !renderer->depends_on_swap_chain())
+			{
+				continue;
+			}
+			renderer->allocate_per_frame_resources(image.image, image.image_view);
+		}
+
+		images.push_back(image);
 	}
 
-	LOG_INFO(Utility::get_logger(), "GraphicsEngineSwapChain: created {} frames", frames.size());
+	LOG_INFO(Utility::get_logger(), "GraphicsEngineSwapChain: created {} images", images.size());
 }
 
-void GraphicsEngineSwapChain::update_command_buffer()
+void GraphicsEngineSwapChain::destroy_images()
 {
-	for (auto& frame : frames)
+	for (const SwapChainImage& image : images)
 	{
-		frame.update_command_buffer();
+		vkDestroySemaphore(get_logical_device(), image.render_finished_semaphore, nullptr);
+		vkDestroyImageView(get_logical_device(), image.image_view, nullptr);
 	}
+	images.clear();
+}
+
+void GraphicsEngineSwapChain::create_frames()
+{
+	frames.reserve(NUM_FRAMES_IN_FLIGHT);
+	for (uint32_t frame_index = 0; frame_index < NUM_FRAMES_IN_FLIGHT; frame_index++)
+	{
+		frames.emplace_back(get_graphics_engine(), *this, frame_index);
+	}
+
+	LOG_INFO(Utility::get_logger(), "GraphicsEngineSwapChain: created {} frames in flight", frames.size());
 }
 
 VkExtent2D GraphicsEngineSwapChain::get_extent()
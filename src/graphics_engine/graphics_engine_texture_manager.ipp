@@ -106,8 +106,13 @@ void GraphicsEngineTextureManager::free_texture(MaterialID id)
 		return;
 	}
 	
-	texture_units.at(id).destroy(get_logical_device());
+	// the id can be used again straight away, the image is destroyed once the GPU stopped sampling it
+	auto texture = std::make_shared<GraphicsEngineTexture>(std::move(texture_units.at(id)));
 	texture_units.erase(id);
+	get_graphics_engine().get_deletion_queue().push([this, texture]
+	{
+		texture->destroy(get_logical_device());
+	});
 }
 
 GraphicsEngineTexture GraphicsEngineTextureManager::create_texture(
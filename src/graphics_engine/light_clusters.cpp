@@ -0,0 +1,199 @@
+#include "light_clusters.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+
+namespace
+{
+	// the tile of a normalised device coordinate along an axis of the grid
+	uint32_t get_tile(float ndc, int grid_size)
+	{
+		return uint32_t(std::clamp(int(std::floor((ndc * 0.5f + 0.5f) * grid_size)), 0, grid_size - 1));
+	}
+}
+
+void LightClusters::build(const glm::mat4& view, const glm::mat4& proj, const std::vector<SDS::PointLight>& lights)
+{
+	if (lights.size() > SDS::MAX_POINT_LIGHTS)
+	{
+		throw std::runtime_error("LightClusters::build: too many point lights");
+	}
+
+	this->view = view;
+	// the clusters are fixed in view space, they only move when the projection changes
+	if (cluster_bounds.empty() || proj != this->proj)
+	{
+		this->proj = proj;
+		compute_cluster_bounds(proj);
+	}
+
+	cluster_lights.clear();
+	for (uint32_t light_idx = 0; light_idx < lights.size(); light_idx++)
+	{
+		const SDS::PointLight& light = lights[light_idx];
+		const glm::vec3 center = glm::vec3(view * glm::vec4(light.pos, 1.0f));
+		const float radius = light.radius;
+		if (center.z + radius < near_depth || center.z - radius > far_depth)
+		{
+			continue;
+		}
+
+		// screen bounds of the box around the light, the part behind the near plane is never drawn,
+		// it's clamped to it so the projection stays in front of the camera
+		glm::vec2 ndc_min(std::numeric_limits<float>::max());
+		glm::vec2 ndc_max(std::numeric_limits<float>::lowest());
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			glm::vec3 corner = center + radius * glm::vec3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+			corner.z = std::max(corner.z, near_depth);
+			const glm::vec4 clip = proj * glm::vec4(corner, 1.0f);
+			const glm::vec2 ndc = glm::vec2(clip) / clip.w;
+			ndc_min = glm::min(ndc_min, ndc);
+			ndc_max = glm::max(ndc_max, ndc);
+		}
+		if (ndc_max.x < -1.0f || ndc_min.x > 1.0f || ndc_max.y < -1.0f || ndc_min.y > 1.0f)
+		{
+			continue;
+		}
+
+		const uint32_t min_x = get_tile(ndc_min.x, SDS::LIGHT_CLUSTER_GRID_X);
+		const uint32_t max_x = get_tile(ndc_max.x, SDS::LIGHT_CLUSTER_GRID_X);
+		const uint32_t min_y = get_tile(ndc_min.y, SDS::LIGHT_CLUSTER_GRID_Y);
+		const uint32_t max_y = get_tile(ndc_max.y, SDS::LIGHT_CLUSTER_GRID_Y);
+		const uint32_t min_z = get_slice(center.z - radius);
+		const uint32_t max_z = get_slice(center.z + radius);
+
+		for (uint32_t z = min_z; z <= max_z; z++)
+		{
+			for (uint32_t y = min_y; y <= max_y; y++)
+			{
+				for (uint32_t x = min_x; x <= max_x; x++)
+				{
+					// the closest point of the cluster to the light
+					const uint32_t cluster_idx = get_cluster_index(x, y, z);
+					const Bounds& bounds = cluster_bounds[cluster_idx];
+					const glm::vec3 closest = glm::clamp(center, bounds.min, bounds.max);
+					const glm::vec3 offset = closest - center;
+					if (glm::dot(offset, offset) <= radius * radius)
+					{
+						cluster_lights.emplace_back(cluster_idx, light_idx);
+					}
+				}
+			}
+		}
+	}
+
+	// counting sort by cluster, the lights of a cluster stay in the order they were given in
+	clusters.assign(NUM_CLUSTERS, SDS::LightCluster{ 0, 0 });
+	for (const auto& [cluster_idx, light_idx] : cluster_lights)
+	{
+		++clusters[cluster_idx].count;
+	}
+	uint32_t num_indices = 0;
+	fill_cursors.resize(NUM_CLUSTERS);
+	for (uint32_t cluster_idx = 0; cluster_idx < NUM_CLUSTERS; cluster_idx++)
+	{
+		SDS::LightCluster& cluster = clusters[cluster_idx];
+		cluster.count = std::min<uint32_t>({ 
+			cluster.count, 
+			SDS::MAX_LIGHTS_PER_CLUSTER, 
+			SDS::MAX_LIGHT_CLUSTER_INDICES - num_indices });
+		cluster.offset = num_indices;
+		fill_cursors[cluster_idx] = num_indices;
+		num_indices += cluster.count;
+	}
+
+	light_indices.resize(num_indices);
+	for (const auto& [cluster_idx, light_idx] : cluster_lights)
+	{
+		const SDS::LightCluster& cluster = clusters[cluster_idx];
+		uint32_t& cursor = fill_cursors[cluster_idx];
+		if (cursor < cluster.offset + cluster.count)
+		{
+			light_indices[cursor++] = light_idx;
+		}
+	}
+}
+
+uint32_t LightClusters::find_cluster(const glm::vec3& pos) const
+{
+	const glm::vec4 view_pos = view * glm::vec4(pos, 1.0f);
+	const glm::vec4 clip = proj * view_pos;
+	const glm::vec2 ndc = glm::vec2(clip) / clip.w;
+
+	return get_cluster_index(
+		get_tile(ndc.x, SDS::LIGHT_CLUSTER_GRID_X), 
+		get_tile(ndc.y, SDS::LIGHT_CLUSTER_GRID_Y), 
+		get_slice(view_pos.z));
+}
+
+void LightClusters::compute_cluster_bounds(const glm::mat4& proj)
+{
+	const glm::mat4 inv_proj = glm::inverse(proj);
+	const auto unproject = [&inv_proj](float x, float y, float z)
+	{
+		const glm::vec4 pos = inv_proj * glm::vec4(x, y, z, 1.0f);
+		return glm::vec3(pos) / pos.w;
+	};
+
+	// vulkan's depth range is [0, 1], the camera is left handed and looks along +z
+	near_depth = unproject(0.0f, 0.0f, 0.0f).z;
+	far_depth = unproject(0.0f, 0.0f, 1.0f).z;
+	if (near_depth <= 0.0f || far_depth <= near_depth)
+	{
+		throw std::runtime_error("LightClusters::compute_cluster_bounds: the near depth has to be positive and before the far depth");
+	}
+	slice_scale = float(SDS::LIGHT_CLUSTER_GRID_Z) / std::log(far_depth / near_depth);
+
+	// the view space lines through the corners of the tiles, from the near to the far plane
+	constexpr uint32_t num_lines_x = SDS::LIGHT_CLUSTER_GRID_X + 1;
+	constexpr uint32_t num_lines_y = SDS::LIGHT_CLUSTER_GRID_Y + 1;
+	std::array<std::pair<glm::vec3, glm::vec3>, num_lines_x * num_lines_y> lines;
+	for (uint32_t y = 0; y < num_lines_y; y++)
+	{
+		for (uint32_t x = 0; x < num_lines_x; x++)
+		{
+			const float ndc_x = -1.0f + 2.0f * float(x) / float(SDS::LIGHT_CLUSTER_GRID_X);
+			const float ndc_y = -1.0f + 2.0f * float(y) / float(SDS::LIGHT_CLUSTER_GRID_Y);
+			lines[y * num_lines_x + x] = { unproject(ndc_x, ndc_y, 0.0f), unproject(ndc_x, ndc_y, 1.0f) };
+		}
+	}
+
+	cluster_bounds.resize(NUM_CLUSTERS);
+	for (uint32_t z = 0; z < SDS::LIGHT_CLUSTER_GRID_Z; z++)
+	{
+		const std::array<float, 2> slice_depths = {
+			near_depth * std::pow(far_depth / near_depth, float(z) / float(SDS::LIGHT_CLUSTER_GRID_Z)),
+			near_depth * std::pow(far_depth / near_depth, float(z + 1) / float(SDS::LIGHT_CLUSTER_GRID_Z)) };
+		for (uint32_t y = 0; y < SDS::LIGHT_CLUSTER_GRID_Y; y++)
+		{
+			for (uint32_t x = 0; x < SDS::LIGHT_CLUSTER_GRID_X; x++)
+			{
+				Bounds bounds{ glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()) };
+				for (uint32_t corner = 0; corner < 4; corner++)
+				{
+					const auto& [near_pos, far_pos] = lines[(y + (corner >> 1)) * num_lines_x + x + (corner & 1)];
+					for (float depth : slice_depths)
+					{
+						const glm::vec3 pos = glm::mix(near_pos, far_pos, (depth - near_pos.z) / (far_pos.z - near_pos.z));
+						bounds.min = glm::min(bounds.min, pos);
+						bounds.max = glm::max(bounds.max, pos);
+					}
+				}
+				cluster_bounds[get_cluster_index(x, y, z)] = bounds;
+			}
+		}
+	}
+}
+
+uint32_t LightClusters::get_slice(float view_depth) const
+{
+	const float slice = std::log(std::max(view_depth, near_depth) / near_depth) * slice_scale;
+	return uint32_t(std::clamp(int(std::floor(slice)), 0, SDS::LIGHT_CLUSTER_GRID_Z - 1));
+}
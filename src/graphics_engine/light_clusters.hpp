@@ -0,0 +1,63 @@
+#pragma once
+
+#include "shared_data_structures.hpp"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+// Bins point lights into clusters of the view frustum, tiles on the screen split into exponential slices
+// along the view depth, so a fragment only shades the lights that reach into its cluster. Every cluster
+// lists at most SDS::MAX_LIGHTS_PER_CLUSTER lights, so the cost per fragment stays bounded however many
+// lights there are. The lights are binned on the CPU and uploaded as compact index lists
+class LightClusters
+{
+public:
+	static constexpr uint32_t NUM_CLUSTERS = SDS::LIGHT_CLUSTER_GRID_X * SDS::LIGHT_CLUSTER_GRID_Y * SDS::LIGHT_CLUSTER_GRID_Z;
+
+	// the lights are in world space, the camera may be perspective or orthographic
+	void build(const glm::mat4& view, const glm::mat4& proj, const std::vector<SDS::PointLight>& lights);
+
+	// one per cluster, indexed by get_cluster_index
+	const std::vector<SDS::LightCluster>& get_clusters() const { return clusters; }
+	const std::vector<uint32_t>& get_light_indices() const { return light_indices; }
+	// see SDS::GlobalData
+	float get_near_depth() const { return near_depth; }
+	float get_slice_scale() const { return slice_scale; }
+
+	static uint32_t get_cluster_index(uint32_t x, uint32_t y, uint32_t z)
+	{
+		return (z * SDS::LIGHT_CLUSTER_GRID_Y + y) * SDS::LIGHT_CLUSTER_GRID_X + x;
+	}
+	// the cluster the shaders pick for a world space position
+	uint32_t find_cluster(const glm::vec3& pos) const;
+
+private:
+	struct Bounds
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+
+	// view space bounding box of every cluster
+	void compute_cluster_bounds(const glm::mat4& proj);
+	uint32_t get_slice(float view_depth) const;
+
+	glm::mat4 view;
+	glm::mat4 proj;
+	float near_depth = 0.0f;
+	float far_depth = 0.0f;
+	float slice_scale = 0.0f;
+	std::vector<Bounds> cluster_bounds;
+
+	std::vector<SDS::LightCluster> clusters;
+	std::vector<uint32_t> light_indices;
+	// cluster and light index of every light reaching into a cluster, sorted by cluster into light_indices
+	std::vector<std::pair<uint32_t, uint32_t>> cluster_lights;
+	// where the next light index of every cluster is written
+	std::vector<uint32_t> fill_cursors;
+};
@@ -55,7 +55,7 @@ std::vector<VkVertexInputBindingDescription> GraphicsEnginePipeline::get_binding
 
 	VkVertexInputBindingDescription binding_description{};
 	binding_description.binding = 0;
-	binding_description.stride = sizeof(SDS::ColorVertex);
+	binding_description.stride = sizeof(SDS::PackedColorVertex);
 	// move to the next data entry after each vertex
 	binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 	// move to the next data entry after each instance
@@ -71,12 +71,13 @@ std::vector<VkVertexInputAttributeDescription> GraphicsEnginePipeline::get_attri
 	position_attr.binding = 0;
 	position_attr.location = 0; // specify in shader
 	position_attr.format = VK_FORMAT_R32G32B32_SFLOAT;
-	position_attr.offset = offsetof(SDS::ColorVertex, pos);
+	position_attr.offset = offsetof(SDS::PackedColorVertex, pos);
 
+	// octahedral encoded, decoded in the shader
 	normal_attr.binding = 0;
 	normal_attr.location = 3;
-	normal_attr.format = VK_FORMAT_R32G32B32_SFLOAT;
-	normal_attr.offset = offsetof(SDS::ColorVertex, normal);
+	normal_attr.format = VK_FORMAT_R16G16_SNORM;
+	normal_attr.offset = offsetof(SDS::PackedColorVertex, normal);
 
 	return {position_attr, normal_attr};
 }
@@ -12,7 +12,8 @@ enum class EPipelineModifier
 	STENCIL,
 	POST_STENCIL,
 	WIREFRAME,
-	SHADOW_MAP
+	SHADOW_MAP,
+	OUTLINE_MASK // the primary pipeline also marking the stencil for the outline renderer
 };
 
 struct PipelineID
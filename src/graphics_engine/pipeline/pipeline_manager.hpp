@@ -7,6 +7,8 @@
 
 #include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 
 class GraphicsEnginePipelineManager : public GraphicsEngineBaseModule
@@ -17,7 +19,14 @@ public:
 	GraphicsEnginePipelineManager(GraphicsEngine& engine);
 	~GraphicsEnginePipelineManager();
 
+	// thread safe, the draw commands are recorded on several threads
 	PipelineType* fetch_pipeline(PipelineID id);
+	// pipelines have the extent baked into their viewport, they are created again on their next fetch
+	void destroy_pipelines() 
+	{ 
+		std::unique_lock lock(pipelines_mutex);
+		pipelines_by_id.clear(); 
+	}
 
 	VkPipelineLayout get_generic_pipeline_layout() const { return generic_pipeline_layout; }
 
@@ -28,6 +37,8 @@ private:
 
 	std::unordered_map<ERenderType, std::unique_ptr<PipelineType>> pipelines;
 	std::unordered_map<PipelineID, std::unique_ptr<PipelineType>> pipelines_by_id;
+	// pipelines are only created the first time they're fetched, lookups don't block each other
+	std::shared_mutex pipelines_mutex;
 
 	VkPipelineLayout generic_pipeline_layout = nullptr;
 };
\ No newline at end of file
@@ -39,6 +39,17 @@ GraphicsEnginePipelineManager::~GraphicsEnginePipelineManager()
 
 GraphicsEnginePipeline* GraphicsEnginePipelineManager::fetch_pipeline(PipelineID id)
 {
+	{
+		std::shared_lock lock(pipelines_mutex);
+		auto it = pipelines_by_id.find(id);
+		if (it != pipelines_by_id.end())
+		{
+			return it->second.get();
+		}
+	}
+
+	std::unique_lock lock(pipelines_mutex);
+	// another thread may have created it in the meantime
 	auto it = pipelines_by_id.find(id);
 	if (it == pipelines_by_id.end())
 	{
@@ -75,6 +86,9 @@ std::unique_ptr<GraphicsEnginePipeline> GraphicsEnginePipelineManager::create_pi
 	case ERenderType::QUAD:
 		new_pipeline = create_pipeline<QuadPipeline>(id);
 		break;
+	case ERenderType::OUTLINE:
+		new_pipeline = create_pipeline<OutlinePipeline>(id);
+		break;
 	default:
 		throw std::runtime_error(
 			std::string("GraphicsEnginePipelineManager::create_pipeline: invalid primary pipeline type: ") +
@@ -135,6 +149,12 @@ std::unique_ptr<GraphicsEnginePipeline> GraphicsEnginePipelineManager::create_pi
 			return std::make_unique<ShadowMapPipeline<PrimaryPipelineType>>(get_graphics_engine());
 		}
 		break;
+	case EPipelineModifier::OUTLINE_MASK:
+		if constexpr (Stencileable<PrimaryPipelineType>)
+		{
+			return std::make_unique<OutlineMaskPipeline<PrimaryPipelineType>>(get_graphics_engine());
+		}
+		break;
 	default:
 		break;
 	}
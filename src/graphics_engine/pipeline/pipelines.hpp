@@ -9,8 +9,8 @@ class TexturePipeline : public GraphicsEnginePipeline
 public:
 	TexturePipeline(GraphicsEngine& engine) : GraphicsEnginePipeline(engine) {}
 
-	static uint32_t get_vertex_stride() { return sizeof(SDS::TexVertex); }
-	static uint32_t get_vertex_pos_offset() { return offsetof(SDS::TexVertex, pos); }
+	static uint32_t get_vertex_stride() { return sizeof(SDS::PackedTexVertex); }
+	static uint32_t get_vertex_pos_offset() { return offsetof(SDS::PackedTexVertex, pos); }
 
 protected:
 	virtual std::string_view get_shader_name() const override { return "texture"; }
@@ -23,8 +23,8 @@ class ColorPipeline : public GraphicsEnginePipeline
 public:
 	ColorPipeline(GraphicsEngine& engine) : GraphicsEnginePipeline(engine) {}
 
-	static uint32_t get_vertex_stride() { return sizeof(SDS::ColorVertex); }
-	static uint32_t get_vertex_pos_offset() { return offsetof(SDS::ColorVertex, pos); }
+	static uint32_t get_vertex_stride() { return sizeof(SDS::PackedColorVertex); }
+	static uint32_t get_vertex_pos_offset() { return offsetof(SDS::PackedColorVertex, pos); }
 
 protected:
 	virtual std::string_view get_shader_name() const override { return "color"; }
@@ -86,8 +86,8 @@ class SkinnedPipeline : public GraphicsEnginePipeline
 public:
 	SkinnedPipeline(GraphicsEngine& engine) : GraphicsEnginePipeline(engine) {}
 
-	static uint32_t get_vertex_stride() { return sizeof(SDS::SkinnedVertex); }
-	static uint32_t get_vertex_pos_offset() { return offsetof(SDS::SkinnedVertex, pos); }
+	static uint32_t get_vertex_stride() { return sizeof(SDS::PackedSkinnedVertex); }
+	static uint32_t get_vertex_pos_offset() { return offsetof(SDS::PackedSkinnedVertex, pos); }
 	static std::vector<VkVertexInputBindingDescription> get_binding_descriptions_();
 	static std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions_();
 
@@ -176,6 +176,32 @@ protected:
 	virtual std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions() const override;
 };
 
+// draws the object like its primary pipeline and marks its silhouette in the stencil, even where it's occluded
+template<Stencileable PrimaryPipelineType>
+class OutlineMaskPipeline : public PrimaryPipelineType
+{
+public:
+	OutlineMaskPipeline(GraphicsEngine& engine) : PrimaryPipelineType(engine) {}
+
+protected:
+	virtual VkPipelineDepthStencilStateCreateInfo get_depth_stencil_create_info() const override;
+};
+
+class OutlinePipeline : public GraphicsEnginePipeline
+{
+public:
+	OutlinePipeline(GraphicsEngine& engine) : GraphicsEnginePipeline(engine) {}
+
+protected:
+	virtual std::string_view get_shader_name() const override { return "outline"; }
+	virtual std::vector<VkVertexInputBindingDescription> get_binding_descriptions() const override { return {}; }
+	virtual std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions() const override { return {}; }
+	virtual VkRenderPass get_render_pass() override;
+	virtual VkSampleCountFlagBits get_msaa_sample_count() override { return VK_SAMPLE_COUNT_1_BIT; }
+	virtual std::vector<VkDescriptorSetLayout> get_expected_dset_layouts() override;
+	virtual VkPipelineDepthStencilStateCreateInfo get_depth_stencil_create_info() const override;
+};
+
 class PostStencilColorPipeline : public ColorPipeline
 {
 public:
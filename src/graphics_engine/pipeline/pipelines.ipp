@@ -1,13 +1,14 @@
 #pragma once
 
 #include "pipelines.hpp"
+#include "graphics_engine/renderers/renderers.hpp"
 
 
 std::vector<VkVertexInputBindingDescription> TexturePipeline::get_binding_descriptions() const
 {
 	VkVertexInputBindingDescription binding_description{};
 	binding_description.binding = 0;
-	binding_description.stride = sizeof(SDS::TexVertex);
+	binding_description.stride = sizeof(SDS::PackedTexVertex);
 	binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
 	return { binding_description };
@@ -19,17 +20,18 @@ std::vector<VkVertexInputAttributeDescription> TexturePipeline::get_attribute_de
 	position_attr.binding = 0;
 	position_attr.location = 0; // specify in shader
 	position_attr.format = VK_FORMAT_R32G32B32_SFLOAT;
-	position_attr.offset = offsetof(SDS::TexVertex, pos);
+	position_attr.offset = offsetof(SDS::PackedTexVertex, pos);
 
 	texCoord_attr.binding = 0;
 	texCoord_attr.location = 2; // specify in shader
-	texCoord_attr.format = VK_FORMAT_R32G32_SFLOAT;
-	texCoord_attr.offset = offsetof(SDS::TexVertex, texCoord);
+	texCoord_attr.format = VK_FORMAT_R16G16_SFLOAT;
+	texCoord_attr.offset = offsetof(SDS::PackedTexVertex, texCoord);
 
+	// octahedral encoded, decoded in the shader
 	normal_attr.binding = 0;
 	normal_attr.location = 3;
-	normal_attr.format = VK_FORMAT_R32G32B32_SFLOAT;
-	normal_attr.offset = offsetof(SDS::TexVertex, normal);
+	normal_attr.format = VK_FORMAT_R16G16_SNORM;
+	normal_attr.offset = offsetof(SDS::PackedTexVertex, normal);
 
 	return {position_attr, texCoord_attr, normal_attr};
 }
@@ -38,7 +40,7 @@ std::vector<VkVertexInputBindingDescription> CubemapPipeline::get_binding_descri
 {
 	VkVertexInputBindingDescription binding_description{};
 	binding_description.binding = 0;
-	binding_description.stride = sizeof(SDS::ColorVertex);
+	binding_description.stride = sizeof(SDS::PackedColorVertex);
 	binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
 	return { binding_description };
@@ -46,16 +48,11 @@ std::vector<VkVertexInputBindingDescription> CubemapPipeline::get_binding_descri
 
 std::vector<VkVertexInputAttributeDescription> CubemapPipeline::get_attribute_descriptions() const
 {
-	VkVertexInputAttributeDescription position_attr, texCoord_attr, normal_attr;
+	VkVertexInputAttributeDescription position_attr;
 	position_attr.binding = 0;
 	position_attr.location = 0; // specify in shader
 	position_attr.format = VK_FORMAT_R32G32B32_SFLOAT;
-	position_attr.offset = offsetof(SDS::TexVertex, pos);
-
-	texCoord_attr.binding = 0;
-	texCoord_attr.location = 2; // specify in shader
-	texCoord_attr.format = VK_FORMAT_R32G32_SFLOAT;
-	texCoord_attr.offset = offsetof(SDS::TexVertex, texCoord);
+	position_attr.offset = offsetof(SDS::PackedColorVertex, pos);
 
 	return {position_attr};
 }
@@ -168,6 +165,47 @@ std::vector<VkVertexInputAttributeDescription> StencilPipeline<SkinnedPipeline>:
 	return SkinnedPipeline::get_attribute_descriptions_();
 }
 
+template<Stencileable PrimaryPipelineType>
+VkPipelineDepthStencilStateCreateInfo OutlineMaskPipeline<PrimaryPipelineType>::get_depth_stencil_create_info() const
+{
+	VkPipelineDepthStencilStateCreateInfo info = PrimaryPipelineType::get_depth_stencil_create_info();
+	info.stencilTestEnable = VK_TRUE;
+
+	// always passes and writes the reference, the depth failing too so occluded parts are outlined as well
+	VkStencilOpState stencil_op_state{};
+	stencil_op_state.compareMask = UINT32_MAX;
+	stencil_op_state.writeMask = UINT32_MAX;
+	stencil_op_state.reference = 1;
+	stencil_op_state.compareOp = VkCompareOp::VK_COMPARE_OP_ALWAYS;
+	stencil_op_state.passOp = VkStencilOp::VK_STENCIL_OP_REPLACE;
+	stencil_op_state.failOp = VkStencilOp::VK_STENCIL_OP_KEEP;
+	stencil_op_state.depthFailOp = VkStencilOp::VK_STENCIL_OP_REPLACE;
+	info.front = stencil_op_state;
+	info.back = stencil_op_state;
+
+	return info;
+}
+
+VkRenderPass OutlinePipeline::get_render_pass()
+{
+	return get_graphics_engine().get_renderer_mgr().get_renderer(ERendererType::OUTLINE).get_render_pass();
+}
+
+std::vector<VkDescriptorSetLayout> OutlinePipeline::get_expected_dset_layouts()
+{
+	return { get_rsrc_mgr().request_dset_layout({ OutlineRenderer::get_stencil_binding() }) };
+}
+
+VkPipelineDepthStencilStateCreateInfo OutlinePipeline::get_depth_stencil_create_info() const
+{
+	// the outline render pass has no depth attachment
+	VkPipelineDepthStencilStateCreateInfo info = GraphicsEnginePipeline::get_depth_stencil_create_info();
+	info.depthTestEnable = VK_FALSE;
+	info.depthWriteEnable = VK_FALSE;
+
+	return info;
+}
+
 VkPipelineDepthStencilStateCreateInfo PostStencilColorPipeline::get_depth_stencil_create_info() const
 {
 	VkPipelineDepthStencilStateCreateInfo info = GraphicsEnginePipeline::get_depth_stencil_create_info();
@@ -320,7 +358,7 @@ std::vector<VkVertexInputBindingDescription> SkinnedPipeline::get_binding_descri
 {
 	VkVertexInputBindingDescription binding_description{};
 	binding_description.binding = 0;
-	binding_description.stride = sizeof(SDS::SkinnedVertex);
+	binding_description.stride = sizeof(SDS::PackedSkinnedVertex);
 	binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
 	return { binding_description };
@@ -332,31 +370,31 @@ std::vector<VkVertexInputAttributeDescription> SkinnedPipeline::get_attribute_de
 	position_attr.binding = 0;
 	position_attr.location = 0;
 	position_attr.format = VK_FORMAT_R32G32B32_SFLOAT;
-	position_attr.offset = offsetof(SDS::SkinnedVertex, pos);
+	position_attr.offset = offsetof(SDS::PackedSkinnedVertex, pos);
 
 	VkVertexInputAttributeDescription normal_attr{};
 	normal_attr.binding = 0;
 	normal_attr.location = 1;
-	normal_attr.format = VK_FORMAT_R32G32B32_SFLOAT;
-	normal_attr.offset = offsetof(SDS::SkinnedVertex, normal);
+	normal_attr.format = VK_FORMAT_R16G16_SNORM; // octahedral encoded, decoded in the shader
+	normal_attr.offset = offsetof(SDS::PackedSkinnedVertex, normal);
 
 	VkVertexInputAttributeDescription texCoord_attr{};
 	texCoord_attr.binding = 0;
 	texCoord_attr.location = 2;
-	texCoord_attr.format = VK_FORMAT_R32G32_SFLOAT;
-	texCoord_attr.offset = offsetof(SDS::SkinnedVertex, texCoord);
+	texCoord_attr.format = VK_FORMAT_R16G16_SFLOAT;
+	texCoord_attr.offset = offsetof(SDS::PackedSkinnedVertex, texCoord);
 
 	VkVertexInputAttributeDescription bone_ids_attr{};
 	bone_ids_attr.binding = 0;
 	bone_ids_attr.location = 3;
-	bone_ids_attr.format = VK_FORMAT_R32G32B32A32_SFLOAT; // using float as it's more convenient, we can simply refer to it as a vec4 in glsl
-	bone_ids_attr.offset = offsetof(SDS::SkinnedVertex, bone_ids);
+	bone_ids_attr.format = VK_FORMAT_R8G8B8A8_UINT; // uvec4 in glsl
+	bone_ids_attr.offset = offsetof(SDS::PackedSkinnedVertex, bone_ids);
 
 	VkVertexInputAttributeDescription bone_weights_attr{};
 	bone_weights_attr.binding = 0;
 	bone_weights_attr.location = 4;
-	bone_weights_attr.format = VK_FORMAT_R32G32B32A32_SFLOAT; // using float as it's more convenient, we can simply refer to it as a vec4 in glsl
-	bone_weights_attr.offset = offsetof(SDS::SkinnedVertex, bone_weights);
+	bone_weights_attr.format = VK_FORMAT_R8G8B8A8_UNORM; // unpacked to a normalised vec4
+	bone_weights_attr.offset = offsetof(SDS::PackedSkinnedVertex, bone_weights);
 
 	return {position_attr, texCoord_attr, normal_attr, bone_ids_attr, bone_weights_attr};
 }
@@ -10,9 +10,16 @@
 struct QueueFamilyIndices {
 	std::optional<uint32_t> graphicsFamily;
 	std::optional<uint32_t> presentFamily; // as in present image to the window surface
+	// families without graphics support, their queues run alongside rendering instead of taking turns with it
+	// empty when the device has none, the work then goes to the graphics family
+	std::optional<uint32_t> transferFamily;
+	std::optional<uint32_t> computeFamily;
 
 	bool isComplete()
 	{
 		return graphicsFamily.has_value() && presentFamily.has_value();
 	}
+
+	uint32_t getTransferFamily() const { return transferFamily.value_or(graphicsFamily.value()); }
+	uint32_t getComputeFamily() const { return computeFamily.value_or(graphicsFamily.value()); }
 };
\ No newline at end of file
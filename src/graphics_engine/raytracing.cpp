@@ -7,13 +7,24 @@
 #include "graphics_engine/renderers/renderers.hpp"
 #include "config.hpp"
 #include "objects/object.hpp"
+#include "entity_component_system/mesh_system.hpp"
 
 #include <quill/LogMacros.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <numeric>
 
 
+namespace
+{
+	float get_ms_since(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
 VkTransformMatrixKHR glm_to_vk(const glm::mat4& matrix)
 {
 	// glm uses column major while VkTransformMatrixKHR is row major
@@ -48,12 +59,23 @@ GraphicsEngineRayTracing::~GraphicsEngineRayTracing()
 
 	sbt_buffer->destroy(get_logical_device());
 
-	for (auto& as : bottom_as)
+	for (auto& [id, blas] : bottom_as)
 	{
-		destroy_as(as);
+		destroy_as(blas.as);
 	}
 	bottom_as.clear();
 	destroy_as(top_as);
+	for (auto& buffers : frame_buffers)
+	{
+		if (buffers.scratch)
+		{
+			buffers.scratch->destroy(get_logical_device());
+		}
+		if (buffers.instances)
+		{
+			buffers.instances->destroy(get_logical_device());
+		}
+	}
 }
 
 void GraphicsEngineRayTracing::update_acceleration_structures()
@@ -64,44 +86,19 @@ void GraphicsEngineRayTracing::update_acceleration_structures()
 	// 2. rebuilds should be used where there are large amounts of changes
 	//	this is due to accumulation of variance from original tree hierarchy
 	// An example is the bending of a branch = update, an explosion = rebuild
-	for (auto& as : bottom_as)
+	// process() does the updates every frame, this is for starting over
+	for (auto& [id, blas] : bottom_as)
 	{
-		destroy_as(as);
+		retire_as(blas.as);
 	}
 	bottom_as.clear();
-	destroy_as(top_as);
+	blas_scheduler.clear();
+	retire_as(top_as);
+	tlas_objects.clear();
 	update_blas();
 	update_tlas();
 }
 
-void GraphicsEngineRayTracing::update_tlas2()
-{
-	auto& objects = get_graphics_engine().get_objects();
-	
-	uint32_t instance_id = 0; // TODO: this is not correct, need to fix this up properly
-	for (auto& [id, object] : objects)
-	{
-		if (!object->get_visibility())
-			continue;
-
-		if (std::ranges::any_of(object->get_renderables(), [](const Renderable& renderable)
-			{
-				return renderable.pipeline_render_type == ERenderType::CUBEMAP;
-			}))
-		{
-			continue;
-		}
-		
-		auto& inst = tlas_instances[instance_id++];
-		inst.transform = glm_to_vk(object->get_game_object().get_transform());
-	}
-
-	build_tlas(
-		tlas_instances,
-		VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR, 
-		true);
-}
-
 void GraphicsEngineRayTracing::process()
 {
 	if (!is_enabled())
@@ -109,12 +106,29 @@ void GraphicsEngineRayTracing::process()
 		return;
 	}
 
+	// the builds that last used this frame's scratch and instance buffers were submitted frames ago, usually done by now
+	frame_buffers_index = (frame_buffers_index + 1) % frame_buffers.size();
+	get_graphics_engine().get_compute_queue().wait(frame_buffers[frame_buffers_index].compute_value);
+
+	frame_stats = {};
 	if (get_graphics_engine().get_gui_manager().graphic_settings.rtx_on.changed)
 	{
 		update_acceleration_structures();
 		static_cast<RaytracingRenderer&>(get_graphics_engine().get_renderer_mgr().
 			get_renderer(ERendererType::RAYTRACING)).update_rt_dsets();
+	} else
+	{
+		update_blas();
+		update_tlas();
 	}
+	frame_buffers[frame_buffers_index].compute_value = get_graphics_engine().get_compute_queue().get_last_submitted();
+	total_stats += frame_stats;
+
+	get_graphics_engine().get_gui_manager().update_acceleration_structure_statistics(
+		frame_stats.blas_builds + frame_stats.tlas_builds,
+		frame_stats.blas_refits + frame_stats.tlas_updates,
+		frame_stats.blas_build_ms + frame_stats.tlas_build_ms,
+		frame_stats.blas_refit_ms + frame_stats.tlas_update_ms);
 }
 
 bool GraphicsEngineRayTracing::is_enabled()
@@ -122,85 +136,117 @@ bool GraphicsEngineRayTracing::is_enabled()
 	return get_graphics_engine().get_gui_manager().graphic_settings.rtx_on;
 }
 
+bool GraphicsEngineRayTracing::is_traced(const GraphicsEngineObject& object)
+{
+	return object.get_visibility() && std::ranges::none_of(object.get_renderables(), [](const Renderable& renderable)
+	{
+		return renderable.pipeline_render_type == ERenderType::CUBEMAP;
+	});
+}
+
 typename GraphicsEngineRayTracing::BlasInput GraphicsEngineRayTracing::object_to_blas(
 	const GraphicsEngineObject& object,
 	VkBuildAccelerationStructureFlagsKHR flags)
 {
-	// TODO: this needs to be fixed, change to use per renderable mesh
-	return BlasInput{};
-/*
-	// BLAS builder requires raw device addresses.
-	VkDeviceAddress vertex_address = get_graphics_engine().get_device_module().
+	// BLAS builder requires raw device addresses
+	const VkDeviceAddress vertex_buffer_address = get_graphics_engine().get_device_module().
 		get_buffer_device_address(get_rsrc_mgr().get_vertex_buffer());
-	vertex_address += get_rsrc_mgr().get_vertex_buffer_offset(object.get_id());
-	VkDeviceAddress index_address = get_graphics_engine().get_device_module().
+	const VkDeviceAddress index_buffer_address = get_graphics_engine().get_device_module().
 		get_buffer_device_address(get_rsrc_mgr().get_index_buffer());
-	index_address += get_rsrc_mgr().get_index_buffer_offset(object.get_id());
-
-	uint32_t maxPrimitiveCount = object.get_num_primitives();
-
-	// Describe buffer as array of VertexObj.
-	VkAccelerationStructureGeometryTrianglesDataKHR triangles{VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR};
-	triangles.vertexFormat             = VK_FORMAT_R32G32B32_SFLOAT;  // vec3 vertex position data.
-	triangles.vertexData.deviceAddress = vertex_address;
-	triangles.vertexStride             = sizeof(SDS::ColorVertex); // WARNING TEXTURE ISN'T SUPPORTED YET FOR RAYTRACING
-	// Describe index data (32-bit unsigned int)
-	triangles.indexType               = VK_INDEX_TYPE_UINT32;
-	triangles.indexData.deviceAddress = index_address;
-	// Indicate identity transform by setting transformData to null device pointer.
-	// Note it ACTUALLY is possible to transform objects in the BLAS here
-	// but apparently from some reading it might be expensive, and maybe better to do by updating TLAS
-	// However i'm not sure on this
-	// https://www.reddit.com/r/vulkan/comments/s79m2a/updating_the_top_level_acceleration_structure/
-	triangles.transformData = {};
-	assert(false); // TODO: below line is completely wrong need to be fixed
-	// triangles.maxVertex = //
-
-	// Identify the above data as containing opaque triangles.
-	VkAccelerationStructureGeometryKHR asGeom{VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR};
-	asGeom.geometryType       = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
-	asGeom.flags              = VK_GEOMETRY_OPAQUE_BIT_KHR;
-	asGeom.geometry.triangles = triangles;
-
-	// The entire array will be used to build the BLAS.
-	VkAccelerationStructureBuildRangeInfoKHR offset;
-	offset.firstVertex     = 0;
-	offset.primitiveCount  = maxPrimitiveCount;
-	offset.primitiveOffset = 0;
-	offset.transformOffset = 0;
-
-	// Our blas is made from only one geometry, but could be made of many geometries
+
+	// a geometry per renderable, always the full detail mesh
 	BlasInput input;
-	input.asGeometry.emplace_back(asGeom);
-	input.asBuildOffsetInfo.emplace_back(offset);
 	input.flags = flags;
+	for (const auto& renderable : object.get_renderables())
+	{
+		const Mesh& mesh = MeshSystem::get(renderable.mesh_id);
+
+		// the position is at the start of every packed vertex type
+		VkAccelerationStructureGeometryTrianglesDataKHR triangles{VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR};
+		triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+		triangles.vertexData.deviceAddress = vertex_buffer_address + get_rsrc_mgr().get_vertex_buffer_offset(mesh.get_id());
+		triangles.vertexStride = mesh.get_packed_vertex_size();
+		triangles.maxVertex = mesh.get_num_unique_vertices() - 1;
+		triangles.indexType = mesh.has_16bit_indices() ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		triangles.indexData.deviceAddress = index_buffer_address + get_rsrc_mgr().get_index_buffer_offset(mesh.get_id());
+		// the BLAS is in object space, the object's transform goes in its TLAS instance
+		triangles.transformData = {};
+
+		VkAccelerationStructureGeometryKHR geometry{VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR};
+		geometry.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+		geometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+		geometry.geometry.triangles = triangles;
+
+		VkAccelerationStructureBuildRangeInfoKHR range{};
+		range.primitiveCount = mesh.get_lod(0).num_indices / 3;
+		range.primitiveOffset = 0;
+		range.firstVertex = 0;
+		range.transformOffset = 0;
+
+		input.asGeometry.push_back(geometry);
+		input.asBuildOffsetInfo.push_back(range);
+	}
 
 	return input;
-*/
 }
 
 void GraphicsEngineRayTracing::update_blas()
 {
-	std::vector<BlasInput> blas_inputs;
 	auto& objects = get_graphics_engine().get_objects();
-	blas_inputs.reserve(objects.size());
-	VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+	std::vector<ObjectID> traced;
 	for (auto& [id, object] : objects)
 	{
-		if (!object->get_visibility())
-			continue;
-
-		if (std::ranges::any_of(object->get_renderables(), [](const Renderable& renderable)
-			{
-				return renderable.pipeline_render_type == ERenderType::CUBEMAP;
-			}))
+		if (is_traced(*object))
 		{
-			continue;
+			traced.push_back(id);
 		}
+	}
+
+	const auto updates = blas_scheduler.update(traced, [&objects](ObjectID id)
+	{
+		return std::ranges::any_of(objects.at(id)->get_renderables(), [](const Renderable& renderable)
+		{
+			return renderable.skeleton_id.has_value();
+		});
+	});
+
+	// BLASes of objects that were deleted or hidden
+	for (const ObjectID id : updates.removed)
+	{
+		auto it = bottom_as.find(id);
+		retire_as(it->second.as);
+		bottom_as.erase(it);
+		is_tlas_stale = true;
+	}
+
+	build_blas(updates.to_build);
+	refit_blas(updates.to_refit);
+}
 
-		blas_inputs.emplace_back(object_to_blas(*object, flags));
+void GraphicsEngineRayTracing::build_blas(const std::vector<ObjectID>& object_ids)
+{
+	if (object_ids.empty())
+	{
+		return;
 	}
 
+	const auto start = std::chrono::steady_clock::now();
+	auto& objects = get_graphics_engine().get_objects();
+	for (const ObjectID id : object_ids)
+	{
+		// a rebuild lands in a new structure, the TLAS points to the old one until it's built again
+		Blas& blas = bottom_as[id];
+		retire_as(blas.as);
+
+		VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+		if (blas_scheduler.is_refittable(id))
+		{
+			flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+		}
+		blas.input = object_to_blas(*objects.at(id), flags);
+	}
+	is_tlas_stale = true;
+
 	//--------------------------------------------------------------------------------------------------
 	// Create all the BLAS from the vector of BlasInput
 	// - There will be one BLAS per input-vector entry
@@ -210,7 +256,7 @@ void GraphicsEngineRayTracing::update_blas()
 	// - if flag has the 'Compact' flag, the BLAS will be compacted
 	//
 	// m_cmdPool.init(m_device, m_queueIndex);
-	auto         nbBlas = static_cast<uint32_t>(blas_inputs.size());
+	auto         nbBlas = static_cast<uint32_t>(object_ids.size());
 	VkDeviceSize asTotalSize{0};     // Memory size of all allocated BLAS
 	uint32_t     nbCompactions{0};   // Nb of BLAS requesting compaction
 	VkDeviceSize maxScratchSize{0};  // Largest scratch size
@@ -219,22 +265,24 @@ void GraphicsEngineRayTracing::update_blas()
 	std::vector<BuildAccelerationStructure> buildAs(nbBlas);
 	for (uint32_t idx = 0; idx < nbBlas; idx++)
 	{
+		BlasInput& blas_input = bottom_as.at(object_ids[idx]).input;
+
 		// Filling partially the VkAccelerationStructureBuildGeometryInfoKHR for querying the build sizes.
 		// Other information will be filled in the createBlas (see #2)
 		buildAs[idx].buildInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
 		buildAs[idx].buildInfo.mode          = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-		buildAs[idx].buildInfo.flags         = blas_inputs[idx].flags;
-		buildAs[idx].buildInfo.geometryCount = static_cast<uint32_t>(blas_inputs[idx].asGeometry.size());
-		buildAs[idx].buildInfo.pGeometries   = blas_inputs[idx].asGeometry.data();
+		buildAs[idx].buildInfo.flags         = blas_input.flags;
+		buildAs[idx].buildInfo.geometryCount = static_cast<uint32_t>(blas_input.asGeometry.size());
+		buildAs[idx].buildInfo.pGeometries   = blas_input.asGeometry.data();
 
 		// Build range information
-		buildAs[idx].rangeInfo = blas_inputs[idx].asBuildOffsetInfo.data();
+		buildAs[idx].rangeInfo = blas_input.asBuildOffsetInfo.data();
 
 		// Finding sizes to create acceleration structures and scratch
-		std::vector<uint32_t> maxPrimCount(blas_inputs[idx].asBuildOffsetInfo.size());
-		for(auto tt = 0; tt < blas_inputs[idx].asBuildOffsetInfo.size(); tt++)
+		std::vector<uint32_t> maxPrimCount(blas_input.asBuildOffsetInfo.size());
+		for(auto tt = 0; tt < blas_input.asBuildOffsetInfo.size(); tt++)
 		{
-			maxPrimCount[tt] = blas_inputs[idx].asBuildOffsetInfo[tt].primitiveCount;  // Number of primitives/triangles
+			maxPrimCount[tt] = blas_input.asBuildOffsetInfo[tt].primitiveCount;  // Number of primitives/triangles
 		}
 
 		LOAD_VK_FUNCTION(vkGetAccelerationStructureBuildSizesKHR)(
@@ -247,20 +295,16 @@ void GraphicsEngineRayTracing::update_blas()
 		// Extra info
 		asTotalSize += buildAs[idx].sizeInfo.accelerationStructureSize;
 		maxScratchSize = std::max(maxScratchSize, buildAs[idx].sizeInfo.buildScratchSize);
-		if (buildAs[idx].buildInfo.flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR == 
+		bottom_as.at(object_ids[idx]).update_scratch_size = buildAs[idx].sizeInfo.updateScratchSize;
+		if ((buildAs[idx].buildInfo.flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR) == 
 			VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR)
 		{
 			++nbCompactions;
 		}
 	}
 
-	// Allocate the scratch buffers holding the temporary data of the acceleration structure builder
-	// TODO: track these and ddestroy them
-	GraphicsBuffer scratch_buffer = create_buffer(
-		maxScratchSize, 
-		VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	VkDeviceAddress scratchAddress = this->get_buffer_device_address(scratch_buffer);
+	// the scratch buffer holding the temporary data of the acceleration structure builder
+	VkDeviceAddress scratchAddress = get_scratch_address(maxScratchSize);
 
 	// Allocate a query pool for storing the needed size for every BLAS compaction.
 	VkQueryPool queryPool{VK_NULL_HANDLE};
@@ -284,15 +328,18 @@ void GraphicsEngineRayTracing::update_blas()
 		// Over the limit or last BLAS element
 		if (batchSize >= batchLimit || idx == nbBlas - 1)
 		{
-			VkCommandBuffer cmd_buf = get_graphics_engine().begin_single_time_commands();
+			VkCommandBuffer cmd_buf = begin_as_commands();
 			cmd_create_blas(cmd_buf, indices, buildAs, scratchAddress, queryPool);
-			get_graphics_engine().end_single_time_commands(cmd_buf);
+			uint64_t value = submit_as_commands(cmd_buf, false);
 
 			if (queryPool)
 			{
-				cmd_buf = get_graphics_engine().begin_single_time_commands();
+				// the compacted sizes are read back on the CPU
+				get_graphics_engine().get_compute_queue().wait(value);
+				cmd_buf = begin_as_commands();
 				cmd_compact_blas(cmd_buf, indices, buildAs, queryPool);
-				get_graphics_engine().end_single_time_commands(cmd_buf);
+				value = submit_as_commands(cmd_buf, false);
+				get_graphics_engine().get_compute_queue().wait(value);
 
 				// Destroy the non-compacted version
 				for (auto idx : indices)
@@ -317,14 +364,72 @@ void GraphicsEngineRayTracing::update_blas()
 	}
 
 	// Keeping all the created acceleration structures
-	for (auto& b : buildAs)
+	for (uint32_t idx = 0; idx < nbBlas; idx++)
 	{
-		bottom_as.emplace_back(b.as);
+		bottom_as.at(object_ids[idx]).as = buildAs[idx].as;
 	}
 
 	// Clean up
 	vkDestroyQueryPool(get_logical_device(), queryPool, nullptr);
-	scratch_buffer.destroy(get_logical_device());
+
+	frame_stats.blas_builds += nbBlas;
+	frame_stats.blas_build_ms += get_ms_since(start);
+}
+
+void GraphicsEngineRayTracing::refit_blas(const std::vector<ObjectID>& object_ids)
+{
+	if (object_ids.empty())
+	{
+		return;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	VkDeviceSize scratch_size = 0;
+	for (const ObjectID id : object_ids)
+	{
+		scratch_size = std::max(scratch_size, bottom_as.at(id).update_scratch_size);
+	}
+	const VkDeviceAddress scratch_address = get_scratch_address(scratch_size);
+
+	VkCommandBuffer cmd_buf = begin_as_commands();
+	for (const ObjectID id : object_ids)
+	{
+		// an update moves the bounds of the existing tree to the new vertices without changing its shape,
+		// much faster than a build but the tree gets looser the further the mesh moves from what it was built for
+		Blas& blas = bottom_as.at(id);
+		VkAccelerationStructureBuildGeometryInfoKHR build_info{VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR};
+		build_info.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+		build_info.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+		build_info.flags = blas.input.flags;
+		build_info.geometryCount = static_cast<uint32_t>(blas.input.asGeometry.size());
+		build_info.pGeometries = blas.input.asGeometry.data();
+		build_info.srcAccelerationStructure = blas.as.accel;
+		build_info.dstAccelerationStructure = blas.as.accel;
+		build_info.scratchData.deviceAddress = scratch_address;
+		const VkAccelerationStructureBuildRangeInfoKHR* range_info = blas.input.asBuildOffsetInfo.data();
+		LOAD_VK_FUNCTION(vkCmdBuildAccelerationStructuresKHR)(cmd_buf, 1, &build_info, &range_info);
+
+		// the refits share the scratch buffer
+		VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+		barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+		barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+		vkCmdPipelineBarrier(
+			cmd_buf,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+			0,
+			1,
+			&barrier,
+			0,
+			nullptr,
+			0,
+			nullptr);
+	}
+	// the previous frames may still trace the structures being refit
+	submit_as_commands(cmd_buf, true);
+
+	frame_stats.blas_refits += static_cast<uint32_t>(object_ids.size());
+	frame_stats.blas_refit_ms += get_ms_since(start);
 }
 
 void GraphicsEngineRayTracing::update_tlas()
@@ -332,40 +437,56 @@ void GraphicsEngineRayTracing::update_tlas()
 	auto& objects = get_graphics_engine().get_objects();
 	tlas_instances.clear();
 	tlas_instances.reserve(objects.size());
+	std::vector<ObjectID> instance_objects;
+	instance_objects.reserve(objects.size());
 
-	uint32_t instance_id = 0; // TODO: this is not correct, need to fix this up properly
 	for (auto& [id, object] : objects)
 	{
-		if (!object->get_visibility())
-			continue;
-			
-		if (std::ranges::any_of(object->get_renderables(), [](const Renderable& renderable)
-			{
-				return renderable.pipeline_render_type == ERenderType::CUBEMAP;
-			}))
-		{
+		if (!is_traced(*object))
 			continue;
-		}
 		
 		VkAccelerationStructureInstanceKHR ray_inst{};
 		ray_inst.transform = glm_to_vk(object->get_game_object().get_transform());
 
 		ray_inst.instanceCustomIndex = object->get_id().get_underlying(); // exists in shader as 'gl_InstanceCustomIndexEXT'
-		// TOOD: change this to use the actual object id, will need to refactor blas setup
-		ray_inst.accelerationStructureReference = getBlasDeviceAddress(instance_id++);
+		ray_inst.accelerationStructureReference = get_blas_device_address(bottom_as.at(id).as);
 		ray_inst.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
 		ray_inst.mask = 0xff; //  Only be hit if rayMask & instance.mask != 0
 		
 		// We will use the same hit group for all objects
 		// with more shaders maybe this should change
 		ray_inst.instanceShaderBindingTableRecordOffset = 0;
-		tlas_instances.emplace_back(ray_inst);		
+		tlas_instances.emplace_back(ray_inst);
+		instance_objects.push_back(id);
 	}
 
+	// an update refits the tree built for the old transforms, so it only works on the same instances,
+	// and as the objects drift from where they were at the build the tree gets looser until the next one
+	const bool can_update = top_as.accel != VK_NULL_HANDLE && !is_tlas_stale && 
+		instance_objects == tlas_objects && num_tlas_updates < TLAS_REBUILD_PERIOD;
+	if (!can_update)
+	{
+		retire_as(top_as);
+		num_tlas_updates = 0;
+	}
+	tlas_objects = std::move(instance_objects);
+	is_tlas_stale = false;
+
+	const auto start = std::chrono::steady_clock::now();
 	build_tlas(
 		tlas_instances, 
-		VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR, 
-		false);
+		VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR, 
+		can_update);
+	if (can_update)
+	{
+		num_tlas_updates++;
+		frame_stats.tlas_updates++;
+		frame_stats.tlas_update_ms += get_ms_since(start);
+	} else
+	{
+		frame_stats.tlas_builds++;
+		frame_stats.tlas_build_ms += get_ms_since(start);
+	}
 }
 
 void GraphicsEngineRayTracing::cmd_create_blas(VkCommandBuffer cmd_buf,
@@ -465,7 +586,7 @@ void GraphicsEngineRayTracing::cmd_compact_blas(VkCommandBuffer cmd_buf,
 	}	
 }
 
-GraphicsBuffer GraphicsEngineRayTracing::cmd_create_tlas(
+void GraphicsEngineRayTracing::cmd_create_tlas(
 	VkCommandBuffer cmd_buf,
 	uint32_t nInstances,
 	VkDeviceAddress inst_buffer_addr,
@@ -507,12 +628,8 @@ GraphicsBuffer GraphicsEngineRayTracing::cmd_create_tlas(
 		top_as = create_acceleration_structure(createInfo);
 	}
 	
-	// Allocate the scratch memory
-	GraphicsBuffer scratch_buffer(create_buffer(
-		sizeInfo.buildScratchSize, 
-		VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
-	VkDeviceAddress scratch_address = this->get_buffer_device_address(scratch_buffer);
+	// an update needs less scratch memory than a build
+	VkDeviceAddress scratch_address = get_scratch_address(update ? sizeInfo.updateScratchSize : sizeInfo.buildScratchSize);
 
 	// Finally build the acceleration structure
 
@@ -527,8 +644,6 @@ GraphicsBuffer GraphicsEngineRayTracing::cmd_create_tlas(
 
 	// Build the TLAS
 	LOAD_VK_FUNCTION(vkCmdBuildAccelerationStructuresKHR)(cmd_buf, 1, &buildInfo, &pBuildOffsetInfo);
-
-	return scratch_buffer;
 }
 
 typename GraphicsEngineRayTracing::AccelerationStructure 
@@ -551,15 +666,40 @@ typename GraphicsEngineRayTracing::AccelerationStructure
 	return resultAccel;
 }
 
-VkDeviceAddress GraphicsEngineRayTracing::getBlasDeviceAddress(uint32_t blasId)
+VkDeviceAddress GraphicsEngineRayTracing::get_blas_device_address(const AccelerationStructure& blas)
 {
-	assert(size_t(blasId) < bottom_as.size());
 	VkAccelerationStructureDeviceAddressInfoKHR addressInfo{VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR};
-	addressInfo.accelerationStructure = bottom_as[blasId].accel;
+	addressInfo.accelerationStructure = blas.accel;
 
 	return LOAD_VK_FUNCTION(vkGetAccelerationStructureDeviceAddressKHR)(get_logical_device(), &addressInfo);
 }
 
+VkDeviceAddress GraphicsEngineRayTracing::get_scratch_address(VkDeviceSize size)
+{
+	auto& scratch_buffer = frame_buffers[frame_buffers_index].scratch;
+	if (!scratch_buffer || scratch_buffer->get_capacity() < size)
+	{
+		retire_buffer(scratch_buffer);
+		scratch_buffer = std::make_unique<GraphicsBuffer>(create_buffer(
+			std::max<VkDeviceSize>(size, 1),
+			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	}
+
+	return this->get_buffer_device_address(*scratch_buffer);
+}
+
+void GraphicsEngineRayTracing::retire_buffer(std::unique_ptr<GraphicsBuffer>& buffer)
+{
+	if (buffer)
+	{
+		get_graphics_engine().get_deletion_queue().push([this, retired = std::shared_ptr<GraphicsBuffer>(std::move(buffer))]()
+		{
+			retired->destroy(get_logical_device());
+		});
+	}
+}
+
 void GraphicsEngineRayTracing::build_tlas(
 	const std::vector<VkAccelerationStructureInstanceKHR>& instances,
 	VkBuildAccelerationStructureFlagsKHR flags,
@@ -570,31 +710,34 @@ void GraphicsEngineRayTracing::build_tlas(
 		throw std::runtime_error("Cannot call buildTlas twice except to update.");
 	}
 
-    // Create a buffer holding the actual instance data (matrices++) for use by the AS builder
-	const auto instance_buffer_usage_flags = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-		VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
-	GraphicsBuffer instance_buffer(create_buffer(
-		instances.size() * sizeof(VkAccelerationStructureInstanceKHR),
-		instance_buffer_usage_flags,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	// the buffer holding the actual instance data (matrices++) for use by the AS builder
+	auto& instance_buffer = frame_buffers[frame_buffers_index].instances;
+	const size_t instances_size = std::max<size_t>(instances.size(), 1) * sizeof(VkAccelerationStructureInstanceKHR);
+	if (!instance_buffer || instance_buffer->get_capacity() < instances_size)
+	{
+		retire_buffer(instance_buffer);
+		const auto instance_buffer_usage_flags = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+			VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+		instance_buffer = std::make_unique<GraphicsBuffer>(create_buffer(
+			instances_size,
+			instance_buffer_usage_flags,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	}
 	get_rsrc_mgr().stage_data_to_buffer(
-		instance_buffer.get_buffer(),
+		instance_buffer->get_buffer(),
 		0,
-		instance_buffer.get_capacity(),
-		[&instances, &instance_buffer](std::byte* dest) { 
-			std::memcpy(dest, reinterpret_cast<const std::byte*>(instances.data()), instance_buffer.get_capacity()); 
+		instances.size() * sizeof(VkAccelerationStructureInstanceKHR),
+		[&instances](std::byte* dest) { 
+			std::memcpy(dest, reinterpret_cast<const std::byte*>(instances.data()), instances.size() * sizeof(VkAccelerationStructureInstanceKHR)); 
 		});
-	VkCommandBuffer cmd_buf = get_graphics_engine().begin_single_time_commands();
-	GraphicsBuffer scratch_buffer(cmd_create_tlas(
+	VkCommandBuffer cmd_buf = begin_as_commands();
+	cmd_create_tlas(
 		cmd_buf, 
 		instances.size(), 
-		this->get_buffer_device_address(instance_buffer),
+		this->get_buffer_device_address(*instance_buffer),
 		flags, 
-		update));
-	get_graphics_engine().end_single_time_commands(cmd_buf);
-
-	scratch_buffer.destroy(get_logical_device());
-	instance_buffer.destroy(get_logical_device());
+		update);
+	submit_as_commands(cmd_buf, update);
 }
 
 void GraphicsEngineRayTracing::create_shader_binding_table()
@@ -697,6 +840,60 @@ void GraphicsEngineRayTracing::create_shader_binding_table()
 	vkUnmapMemory(get_logical_device(), sbt_buffer->get_memory());
 }
 
+VkCommandBuffer GraphicsEngineRayTracing::begin_as_commands()
+{
+	VkCommandBuffer cmd_buf = get_graphics_engine().get_compute_queue().begin_commands();
+
+	// the builds of one frame are in separate submissions, they share the scratch buffer and read each other's results
+	VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+	barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	vkCmdPipelineBarrier(
+		cmd_buf,
+		VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+		VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+		0,
+		1,
+		&barrier,
+		0,
+		nullptr,
+		0,
+		nullptr);
+
+	return cmd_buf;
+}
+
+uint64_t GraphicsEngineRayTracing::submit_as_commands(VkCommandBuffer cmd_buf, bool is_in_place)
+{
+	// builds read the uploaded vertices and instances, in place updates also wait until nothing traces the old tree,
+	// builds into new structures run alongside the frames still in flight
+	std::vector<GraphicsEngineAsyncQueue::Wait> waits;
+	if (const auto wait = get_graphics_engine().get_transfer_queue().get_wait(VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR))
+	{
+		waits.push_back(*wait);
+	}
+	if (const auto wait = get_graphics_engine().get_graphics_wait(VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR);
+		wait && is_in_place)
+	{
+		waits.push_back(*wait);
+	}
+
+	return get_graphics_engine().get_compute_queue().submit(cmd_buf, waits);
+}
+
+void GraphicsEngineRayTracing::retire_as(AccelerationStructure& as)
+{
+	if (as.accel != VK_NULL_HANDLE)
+	{
+		// the frames submitted so far may trace it
+		get_graphics_engine().get_deletion_queue().push([this, retired = as]() mutable
+		{
+			destroy_as(retired);
+		});
+	}
+	as = {};
+}
+
 void GraphicsEngineRayTracing::destroy_as(AccelerationStructure& as)
 {
 	VkDevice device = get_logical_device();
@@ -2,10 +2,18 @@
 
 #include "graphics_engine_base_module.hpp"
 #include "vulkan_wrappers.hpp"
+#include "identifications.hpp"
+#include "blas_refit_scheduler.hpp"
+#include "constants.hpp"
 
 #include <vulkan/vulkan.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 
 VkTransformMatrixKHR glm_to_vk(const glm::mat4& matrix);
 
@@ -13,10 +21,45 @@ class GraphicsEngineSwapChain;
 
 class GraphicsEngineObject;
 
+// acceleration structure work, the times are for recording and submitting it to the compute queue
+struct AccelerationStructureStats
+{
+	uint32_t blas_builds = 0;
+	uint32_t blas_refits = 0;
+	uint32_t tlas_builds = 0;
+	uint32_t tlas_updates = 0;
+	float blas_build_ms = 0.0f;
+	float blas_refit_ms = 0.0f;
+	float tlas_build_ms = 0.0f;
+	float tlas_update_ms = 0.0f;
+
+	AccelerationStructureStats& operator+=(const AccelerationStructureStats& other)
+	{
+		blas_builds += other.blas_builds;
+		blas_refits += other.blas_refits;
+		tlas_builds += other.tlas_builds;
+		tlas_updates += other.tlas_updates;
+		blas_build_ms += other.blas_build_ms;
+		blas_refit_ms += other.blas_refit_ms;
+		tlas_build_ms += other.tlas_build_ms;
+		tlas_update_ms += other.tlas_update_ms;
+		return *this;
+	}
+};
+
 // Note that frame refers to swap_chain frame and not actual frames
+//	every traced object has its own BLAS, built once when it first shows up,
+//	deformed meshes are refit in place and the TLAS is updated in place while the set of instances stays the same,
+//	refits loosen the trees so the most refit BLASes are rebuilt a few per frame and the TLAS every so many updates
 class GraphicsEngineRayTracing : public GraphicsEngineBaseModule
 {
 public:
+	// refits a BLAS takes before it's queued for a rebuild
+	static constexpr uint32_t MAX_BLAS_REFITS = 64;
+	// worn out BLASes rebuilt per frame, the rest keep being refit until their turn
+	static constexpr uint32_t BLAS_REBUILD_BUDGET = 2;
+	static constexpr uint32_t TLAS_REBUILD_PERIOD = 256;
+
 	GraphicsEngineRayTracing(GraphicsEngine& engine);
 	GraphicsEngineRayTracing(const GraphicsEngineRayTracing&) = delete;
 	~GraphicsEngineRayTracing();
@@ -48,10 +91,16 @@ public:
 		AccelerationStructure cleanupAS;
   	};
 
+	// throws everything away and builds it again
 	void update_acceleration_structures();
+	// the object's vertex data changed, its BLAS is refit next frame
+	// objects with a skeleton are built so they can be refit, others are rebuilt the first time.
+	// Skinning only happens in the vertex shader, so skinned BLASes stay in bind pose until a pass writes deformed vertices
+	void mark_deformed(ObjectID id) { blas_scheduler.mark_deformed(id); }
 
-	void update_tlas2();
 	VkAccelerationStructureKHR get_tlas() const { return top_as.accel; }
+	const AccelerationStructureStats& get_frame_stats() const { return frame_stats; }
+	const AccelerationStructureStats& get_total_stats() const { return total_stats; }
 
 	void process();
 
@@ -65,10 +114,32 @@ public:
 	VkStridedDeviceAddressRegionKHR callable_sbt_region{};
 
 private:
+	struct Blas
+	{
+		AccelerationStructure as;
+		BlasInput input;
+		VkDeviceSize update_scratch_size = 0;
+	};
+
+	// the builds of a frame use their own scratch and instance buffers, so the next frame can start on its own
+	// while the GPU is still building, it only waits for the builds of the last frame that used the same buffers
+	struct FrameBuffers
+	{
+		std::unique_ptr<GraphicsBuffer> scratch;
+		std::unique_ptr<GraphicsBuffer> instances;
+		// the last compute submission using them
+		uint64_t compute_value = 0;
+	};
+
+	static bool is_traced(const GraphicsEngineObject& object);
 	BlasInput object_to_blas(const GraphicsEngineObject& object, VkBuildAccelerationStructureFlagsKHR flags);
 	// blas = bottom level acceleration struction
 	// tlas = top level acceleration structure
+	// builds the BLASes that are missing, refits deformed ones and rebuilds worn out ones within the budget
 	void update_blas();
+	void build_blas(const std::vector<ObjectID>& object_ids);
+	void refit_blas(const std::vector<ObjectID>& object_ids);
+	// updates the TLAS in place when it has the same instances, builds it otherwise
 	void update_tlas();
 
 	//--------------------------------------------------------------------------------------------------
@@ -92,7 +163,7 @@ private:
 		std::vector<BuildAccelerationStructure>& build_as,
 		VkQueryPool query_pool);
 
-	GraphicsBuffer cmd_create_tlas(
+	void cmd_create_tlas(
 		VkCommandBuffer cmd_buf,
 		uint32_t nInstances,
 		VkDeviceAddress inst_buffer_addr,
@@ -104,7 +175,11 @@ private:
 	//--------------------------------------------------------------------------------------------------
 	// Return the device address of a Blas previously created.
 	//
-	VkDeviceAddress getBlasDeviceAddress(uint32_t blasId);
+	VkDeviceAddress get_blas_device_address(const AccelerationStructure& blas);
+	// the builds of a frame share its scratch buffer, they're ordered by a barrier at the start of each submission
+	VkDeviceAddress get_scratch_address(VkDeviceSize size);
+	// replaced buffers may still be read by the builds submitted so far
+	void retire_buffer(std::unique_ptr<GraphicsBuffer>& buffer);
 
 	void build_tlas(
 		const std::vector<VkAccelerationStructureInstanceKHR>& instances,
@@ -114,11 +189,29 @@ private:
 	void create_shader_binding_table();
 
 	void destroy_as(AccelerationStructure& as);
+	// the builds run on the compute queue, the frames using them wait for them on the GPU
+	VkCommandBuffer begin_as_commands();
+	uint64_t submit_as_commands(VkCommandBuffer cmd_buf, bool is_in_place);
+
+	// for structures the frames in flight may still trace, they're destroyed once those have finished
+	void retire_as(AccelerationStructure& as);
 
 private:
 	// sbt = shader binding table
 	std::unique_ptr<GraphicsBuffer> sbt_buffer;
-	std::vector<AccelerationStructure> bottom_as;
+	std::unordered_map<ObjectID, Blas> bottom_as;
 	AccelerationStructure top_as;
 	std::vector<VkAccelerationStructureInstanceKHR> tlas_instances;
+	// the object of every instance in the TLAS, in order
+	std::vector<ObjectID> tlas_objects;
+	uint32_t num_tlas_updates = 0;
+	// a BLAS was rebuilt so an instance points somewhere else, that takes a TLAS build
+	bool is_tlas_stale = true;
+	BlasRefitScheduler blas_scheduler{ MAX_BLAS_REFITS, BLAS_REBUILD_BUDGET };
+
+	std::array<FrameBuffers, CSTS::MAX_FRAMES_IN_FLIGHT> frame_buffers;
+	uint32_t frame_buffers_index = 0;
+
+	AccelerationStructureStats frame_stats;
+	AccelerationStructureStats total_stats;
 };
\ No newline at end of file
@@ -0,0 +1,513 @@
+#include "render_graph.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+
+namespace
+{
+	constexpr VkAccessFlags WRITE_ACCESS_MASK =
+		VK_ACCESS_SHADER_WRITE_BIT |
+		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_TRANSFER_WRITE_BIT |
+		VK_ACCESS_HOST_WRITE_BIT |
+		VK_ACCESS_MEMORY_WRITE_BIT;
+
+	VkPipelineStageFlags get_stages(RenderGraph::EUsage usage)
+	{
+		switch (usage)
+		{
+		case RenderGraph::EUsage::COLOR_ATTACHMENT:
+			return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		case RenderGraph::EUsage::DEPTH_ATTACHMENT:
+			return VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		case RenderGraph::EUsage::SAMPLED:
+			return VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		case RenderGraph::EUsage::TRANSFER_DST:
+			return VK_PIPELINE_STAGE_TRANSFER_BIT;
+		}
+
+		throw std::runtime_error("RenderGraph::get_stages: unknown usage");
+	}
+
+	VkAccessFlags get_access(RenderGraph::EUsage usage, bool is_read, bool is_write)
+	{
+		VkAccessFlags access = 0;
+		switch (usage)
+		{
+		case RenderGraph::EUsage::COLOR_ATTACHMENT:
+			access |= is_read ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0;
+			access |= is_write ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0;
+			break;
+		case RenderGraph::EUsage::DEPTH_ATTACHMENT:
+			access |= is_read ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT : 0;
+			access |= is_write ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : 0;
+			break;
+		case RenderGraph::EUsage::SAMPLED:
+			access |= VK_ACCESS_SHADER_READ_BIT;
+			break;
+		case RenderGraph::EUsage::TRANSFER_DST:
+			access |= VK_ACCESS_TRANSFER_WRITE_BIT;
+			break;
+		}
+
+		return access;
+	}
+
+	VkDeviceSize align_up(VkDeviceSize offset, VkDeviceSize alignment)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+}
+
+RenderGraph::PassBuilder::Access& RenderGraph::PassBuilder::get_access(
+	ResourceHandle resource, EUsage usage, VkImageLayout layout)
+{
+	const auto it = std::ranges::find_if(accesses, [resource](const Access& access) { return access.resource == resource; });
+	if (it == accesses.end())
+	{
+		return accesses.emplace_back(Access{ resource, usage, layout, layout });
+	}
+	if (it->usage != usage || it->layout != layout)
+	{
+		throw std::runtime_error("RenderGraph::PassBuilder: a pass can only use an image in one way");
+	}
+
+	return *it;
+}
+
+void RenderGraph::PassBuilder::read(ResourceHandle resource, EUsage usage, VkImageLayout layout)
+{
+	if (usage == EUsage::TRANSFER_DST)
+	{
+		throw std::runtime_error("RenderGraph::PassBuilder::read: a transfer destination can't be read");
+	}
+
+	get_access(resource, usage, layout).is_read = true;
+}
+
+void RenderGraph::PassBuilder::write(ResourceHandle resource, EUsage usage, VkImageLayout layout, VkImageLayout final_layout)
+{
+	if (usage == EUsage::SAMPLED)
+	{
+		throw std::runtime_error("RenderGraph::PassBuilder::write: a sampled image can't be written");
+	}
+
+	Access& access = get_access(resource, usage, layout);
+	access.is_write = true;
+	access.final_layout = final_layout;
+}
+
+RenderGraph::ResourceHandle RenderGraph::import_image(const std::string& name, const ImageInfo& info, const ImportedState& state)
+{
+	resources.push_back({ name, info, state });
+	return ResourceHandle(resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::create_transient_image(
+	const std::string& name, const ImageInfo& info, const TransientMemory& memory)
+{
+	if (memory.alignment == 0)
+	{
+		throw std::runtime_error("RenderGraph::create_transient_image: the alignment can't be 0");
+	}
+
+	resources.push_back({ name, info, {}, memory });
+	return ResourceHandle(resources.size() - 1);
+}
+
+void RenderGraph::set_output(ResourceHandle resource, VkImageLayout final_layout)
+{
+	resources.at(resource).output_layout = final_layout;
+}
+
+uint32_t RenderGraph::add_pass(
+	const std::string& name,
+	const std::function<void(PassBuilder&)>& setup,
+	const std::function<void(VkCommandBuffer)>& execute)
+{
+	PassBuilder builder;
+	setup(builder);
+	for (const PassBuilder::Access& access : builder.accesses)
+	{
+		if (access.resource >= resources.size())
+		{
+			throw std::runtime_error("RenderGraph::add_pass: unknown resource");
+		}
+	}
+
+	passes.push_back({ name, std::move(builder.accesses), builder.has_side_effects, execute });
+	return uint32_t(passes.size() - 1);
+}
+
+void RenderGraph::compile()
+{
+	cull_passes();
+	place_transient_images();
+	derive_barriers();
+}
+
+bool RenderGraph::is_culled(uint32_t pass_idx) const
+{
+	return !live_passes.at(pass_idx);
+}
+
+VkDeviceSize RenderGraph::get_memory_offset(ResourceHandle resource) const
+{
+	const auto& memory = resources.at(resource).transient_memory;
+	if (!memory || !memory->offset)
+	{
+		throw std::runtime_error("RenderGraph::get_memory_offset: not a placed transient image");
+	}
+
+	return *memory->offset;
+}
+
+void RenderGraph::cull_passes()
+{
+	// which pass wrote what every pass reads, a pass only reads what the passes before it wrote
+	std::vector<std::optional<uint32_t>> last_writers(resources.size());
+	std::vector<std::vector<uint32_t>> producers(passes.size());
+	for (uint32_t pass_idx = 0; pass_idx < passes.size(); ++pass_idx)
+	{
+		for (const PassBuilder::Access& access : passes[pass_idx].accesses)
+		{
+			if (access.is_read && last_writers[access.resource])
+			{
+				producers[pass_idx].push_back(*last_writers[access.resource]);
+			}
+		}
+		for (const PassBuilder::Access& access : passes[pass_idx].accesses)
+		{
+			if (access.is_write)
+			{
+				last_writers[access.resource] = pass_idx;
+			}
+		}
+	}
+
+	live_passes.assign(passes.size(), false);
+	for (uint32_t pass_idx = 0; pass_idx < passes.size(); ++pass_idx)
+	{
+		live_passes[pass_idx] = passes[pass_idx].has_side_effects;
+	}
+	for (ResourceHandle resource = 0; resource < resources.size(); ++resource)
+	{
+		if (resources[resource].output_layout && last_writers[resource])
+		{
+			live_passes[*last_writers[resource]] = true;
+		}
+	}
+	// producers always come before their consumers, so a single sweep from the back is enough
+	for (uint32_t pass_idx = passes.size(); pass_idx-- > 0;)
+	{
+		if (!live_passes[pass_idx])
+		{
+			continue;
+		}
+		for (uint32_t producer : producers[pass_idx])
+		{
+			live_passes[producer] = true;
+		}
+	}
+}
+
+void RenderGraph::place_transient_images()
+{
+	// the lifetimes span the passes that were added rather than the live ones, so the placement doesn't
+	// change with the culling and images that are bound already stay valid
+	struct Lifetime
+	{
+		uint32_t first_pass = std::numeric_limits<uint32_t>::max();
+		uint32_t last_pass = 0;
+
+		bool overlaps(const Lifetime& other) const
+		{
+			return first_pass <= other.last_pass && other.first_pass <= last_pass;
+		}
+	};
+	std::vector<Lifetime> lifetimes(resources.size());
+	for (uint32_t pass_idx = 0; pass_idx < passes.size(); ++pass_idx)
+	{
+		for (const PassBuilder::Access& access : passes[pass_idx].accesses)
+		{
+			lifetimes[access.resource].first_pass = std::min(lifetimes[access.resource].first_pass, pass_idx);
+			lifetimes[access.resource].last_pass = std::max(lifetimes[access.resource].last_pass, pass_idx);
+		}
+	}
+
+	std::vector<ResourceHandle> placed;
+	std::vector<ResourceHandle> to_place;
+	transient_memory_type_bits = ~0u;
+	for (ResourceHandle resource = 0; resource < resources.size(); ++resource)
+	{
+		const auto& memory = resources[resource].transient_memory;
+		if (!memory)
+		{
+			continue;
+		}
+		transient_memory_type_bits &= memory->memory_type_bits;
+		(memory->offset ? placed : to_place).push_back(resource);
+	}
+	if (transient_memory_type_bits == 0)
+	{
+		throw std::runtime_error("RenderGraph::place_transient_images: the transient images have no memory type in common");
+	}
+
+	// the largest first, the smaller ones then fill the gaps
+	std::ranges::stable_sort(to_place, [this](ResourceHandle lhs, ResourceHandle rhs)
+	{
+		return resources[lhs].transient_memory->size > resources[rhs].transient_memory->size;
+	});
+	for (ResourceHandle resource : to_place)
+	{
+		TransientMemory& memory = *resources[resource].transient_memory;
+
+		// the lowest offset that doesn't collide with the images in use at the same time
+		std::vector<VkDeviceSize> candidates { 0 };
+		for (ResourceHandle other : placed)
+		{
+			if (lifetimes[resource].overlaps(lifetimes[other]))
+			{
+				const TransientMemory& other_memory = *resources[other].transient_memory;
+				candidates.push_back(align_up(*other_memory.offset + other_memory.size, memory.alignment));
+			}
+		}
+		std::ranges::sort(candidates);
+		for (VkDeviceSize candidate : candidates)
+		{
+			const bool collides = std::ranges::any_of(placed, [&](ResourceHandle other)
+			{
+				const TransientMemory& other_memory = *resources[other].transient_memory;
+				return lifetimes[resource].overlaps(lifetimes[other]) &&
+					candidate < *other_memory.offset + other_memory.size &&
+					*other_memory.offset < candidate + memory.size;
+			});
+			if (!collides)
+			{
+				memory.offset = candidate;
+				break;
+			}
+		}
+		placed.push_back(resource);
+	}
+
+	transient_memory_size = 0;
+	for (ResourceHandle resource : placed)
+	{
+		const TransientMemory& memory = *resources[resource].transient_memory;
+		transient_memory_size = std::max(transient_memory_size, *memory.offset + memory.size);
+	}
+}
+
+void RenderGraph::derive_barriers()
+{
+	// what the barrier before the next access of an image has to wait for
+	struct State
+	{
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags write_stages = 0;
+		VkAccessFlags write_access = 0;
+		// reads since the last write
+		VkPipelineStageFlags read_stages = 0;
+		// the stages the last write was made visible to
+		VkPipelineStageFlags visible_stages = 0;
+		bool is_accessed = false;
+	};
+
+	std::vector<State> states(resources.size());
+	for (ResourceHandle resource = 0; resource < resources.size(); ++resource)
+	{
+		if (resources[resource].transient_memory)
+		{
+			continue;
+		}
+
+		const ImportedState& imported = resources[resource].imported_state;
+		State& state = states[resource];
+		state.layout = imported.layout;
+		if (imported.access & WRITE_ACCESS_MASK)
+		{
+			state.write_stages = imported.stages;
+			state.write_access = imported.access;
+		} else
+		{
+			state.read_stages = imported.stages;
+		}
+	}
+
+	// a transient image first has to wait for the images whose memory it takes over
+	const auto get_aliased_state = [&](ResourceHandle resource)
+	{
+		const TransientMemory& memory = *resources[resource].transient_memory;
+		State aliased;
+		for (ResourceHandle other = 0; other < resources.size(); ++other)
+		{
+			const auto& other_memory = resources[other].transient_memory;
+			if (other == resource || !other_memory || !states[other].is_accessed ||
+				*memory.offset >= *other_memory->offset + other_memory->size ||
+				*other_memory->offset >= *memory.offset + memory.size)
+			{
+				continue;
+			}
+			aliased.write_stages |= states[other].write_stages | states[other].read_stages;
+			aliased.write_access |= states[other].write_access;
+		}
+
+		return aliased;
+	};
+
+	compiled_passes.clear();
+	for (uint32_t pass_idx = 0; pass_idx < passes.size(); ++pass_idx)
+	{
+		if (!live_passes[pass_idx])
+		{
+			continue;
+		}
+
+		CompiledPass& compiled_pass = compiled_passes.emplace_back(CompiledPass{ pass_idx });
+		for (const PassBuilder::Access& access : passes[pass_idx].accesses)
+		{
+			State& state = states[access.resource];
+			if (!state.is_accessed && resources[access.resource].transient_memory)
+			{
+				state = get_aliased_state(access.resource);
+			}
+			state.is_accessed = true;
+
+			const VkPipelineStageFlags stages = get_stages(access.usage);
+			const VkAccessFlags access_flags = get_access(access.usage, access.is_read, access.is_write);
+			const bool is_transition = access.layout != VK_IMAGE_LAYOUT_UNDEFINED && access.layout != state.layout;
+			// a layout transition writes the image as well
+			const bool is_write = access.is_write || is_transition;
+			const bool is_hazard = is_write ?
+				(state.write_stages | state.read_stages) != 0 :
+				state.write_stages != 0 && (stages & ~state.visible_stages) != 0;
+
+			if (is_transition || is_hazard)
+			{
+				const VkPipelineStageFlags src_stages = state.write_stages | (is_write ? state.read_stages : 0);
+				compiled_pass.barriers.push_back(Barrier{
+					access.resource,
+					src_stages ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+					state.write_access,
+					stages,
+					access_flags,
+					state.layout,
+					access.layout });
+			}
+
+			if (is_transition)
+			{
+				state.layout = access.layout;
+			}
+			if (access.is_write)
+			{
+				state.write_stages = stages;
+				state.write_access = access_flags & WRITE_ACCESS_MASK;
+				state.read_stages = 0;
+				state.visible_stages = 0;
+			} else if (is_transition)
+			{
+				// only the transition has to be waited for by the next reads in other stages
+				state.write_stages = stages;
+				state.write_access = 0;
+				state.read_stages = stages;
+				state.visible_stages = stages;
+			} else
+			{
+				state.read_stages |= stages;
+				state.visible_stages |= is_hazard ? stages : 0;
+			}
+			// the render pass of the pass transitions the image at its end
+			if (access.final_layout != VK_IMAGE_LAYOUT_UNDEFINED)
+			{
+				state.layout = access.final_layout;
+			}
+		}
+	}
+
+	final_barriers.clear();
+	for (ResourceHandle resource = 0; resource < resources.size(); ++resource)
+	{
+		const auto& output_layout = resources[resource].output_layout;
+		const State& state = states[resource];
+		if (!output_layout || *output_layout == state.layout)
+		{
+			continue;
+		}
+
+		const VkPipelineStageFlags src_stages = state.write_stages | state.read_stages;
+		final_barriers.push_back(Barrier{
+			resource,
+			src_stages ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			state.write_access,
+			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			state.layout,
+			*output_layout });
+	}
+}
+
+void RenderGraph::execute(VkCommandBuffer command_buffer) const
+{
+	const auto record_barriers = [&](const std::vector<Barrier>& barriers)
+	{
+		if (barriers.empty())
+		{
+			return;
+		}
+
+		VkPipelineStageFlags src_stages = 0;
+		VkPipelineStageFlags dst_stages = 0;
+		VkMemoryBarrier memory_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+		std::vector<VkImageMemoryBarrier> image_barriers;
+		for (const Barrier& barrier : barriers)
+		{
+			src_stages |= barrier.src_stages;
+			dst_stages |= barrier.dst_stages;
+			if (barrier.new_layout == VK_IMAGE_LAYOUT_UNDEFINED)
+			{
+				memory_barrier.srcAccessMask |= barrier.src_access;
+				memory_barrier.dstAccessMask |= barrier.dst_access;
+				continue;
+			}
+
+			const ImageInfo& info = resources[barrier.resource].info;
+			VkImageMemoryBarrier& image_barrier = image_barriers.emplace_back(VkImageMemoryBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER});
+			image_barrier.srcAccessMask = barrier.src_access;
+			image_barrier.dstAccessMask = barrier.dst_access;
+			image_barrier.oldLayout = barrier.old_layout;
+			image_barrier.newLayout = barrier.new_layout;
+			image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			image_barrier.image = info.image;
+			image_barrier.subresourceRange = { info.aspect, 0, 1, 0, info.layer_count };
+		}
+
+		const bool has_memory_barrier = memory_barrier.srcAccessMask || memory_barrier.dstAccessMask;
+		vkCmdPipelineBarrier(
+			command_buffer,
+			src_stages,
+			dst_stages,
+			0,
+			has_memory_barrier ? 1 : 0,
+			has_memory_barrier ? &memory_barrier : nullptr,
+			0,
+			nullptr,
+			image_barriers.size(),
+			image_barriers.data());
+	};
+
+	for (const CompiledPass& compiled_pass : compiled_passes)
+	{
+		record_barriers(compiled_pass.barriers);
+		if (passes[compiled_pass.pass_idx].execute)
+		{
+			passes[compiled_pass.pass_idx].execute(command_buffer);
+		}
+	}
+	record_barriers(final_barriers);
+}
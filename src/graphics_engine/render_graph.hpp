@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+// Describes the passes of a frame by the images they read and write. Compiling the graph culls the passes
+// whose results aren't used, derives the barriers and layout transitions between the passes and places
+// the transient images, i.e. the ones only used within the frame, into shared memory so the images whose
+// passes don't overlap alias each other. Passes run in the order they're added, a pass can only read
+// what the passes before it wrote. Compiling doesn't touch the device, only executing records commands
+class RenderGraph
+{
+public:
+	using ResourceHandle = uint32_t;
+
+	enum class EUsage
+	{
+		COLOR_ATTACHMENT,
+		DEPTH_ATTACHMENT,
+		SAMPLED, // in the fragment shader
+		TRANSFER_DST,
+	};
+
+	struct ImageInfo
+	{
+		VkImage image = VK_NULL_HANDLE;
+		VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		uint32_t layer_count = 1;
+	};
+
+	// how an imported image was last used before the graph
+	struct ImportedState
+	{
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		VkAccessFlags access = 0;
+	};
+
+	// the memory requirements of a transient image, see vkGetImageMemoryRequirements
+	struct TransientMemory
+	{
+		VkDeviceSize size = 0;
+		VkDeviceSize alignment = 1;
+		uint32_t memory_type_bits = ~0u;
+		// for an image that is bound already, compiling places the others around it
+		std::optional<VkDeviceSize> offset;
+	};
+
+	struct Barrier
+	{
+		ResourceHandle resource;
+		VkPipelineStageFlags src_stages;
+		VkAccessFlags src_access;
+		VkPipelineStageFlags dst_stages;
+		VkAccessFlags dst_access;
+		// no transition when both are the same, an undefined new layout means the pass discards the contents
+		// and its render pass transitions the image, so only the memory is synchronised
+		VkImageLayout old_layout;
+		VkImageLayout new_layout;
+	};
+
+	class PassBuilder
+	{
+	public:
+		// layout is the one the pass expects the image in, undefined when the pass discards its contents
+		void read(ResourceHandle resource, EUsage usage, VkImageLayout layout);
+		// final_layout is the one the pass leaves the image in, i.e. the final layout of its render pass
+		void write(ResourceHandle resource, EUsage usage, VkImageLayout layout, VkImageLayout final_layout);
+		// the pass is never culled
+		void set_side_effects() { has_side_effects = true; }
+
+	private:
+		friend class RenderGraph;
+
+		struct Access
+		{
+			ResourceHandle resource;
+			EUsage usage;
+			VkImageLayout layout;
+			VkImageLayout final_layout;
+			bool is_read = false;
+			bool is_write = false;
+		};
+
+		Access& get_access(ResourceHandle resource, EUsage usage, VkImageLayout layout);
+
+		std::vector<Access> accesses;
+		bool has_side_effects = false;
+	};
+
+	struct CompiledPass
+	{
+		uint32_t pass_idx;
+		// recorded before the pass
+		std::vector<Barrier> barriers;
+	};
+
+	ResourceHandle import_image(const std::string& name, const ImageInfo& info, const ImportedState& state);
+	ResourceHandle create_transient_image(const std::string& name, const ImageInfo& info, const TransientMemory& memory);
+	// the image is used after the graph, the passes producing it are kept and it's left in final_layout
+	void set_output(ResourceHandle resource, VkImageLayout final_layout);
+
+	// returns the index of the pass
+	uint32_t add_pass(
+		const std::string& name,
+		const std::function<void(PassBuilder&)>& setup,
+		const std::function<void(VkCommandBuffer)>& execute);
+
+	void compile();
+	// records the passes that weren't culled and the barriers between them
+	void execute(VkCommandBuffer command_buffer) const;
+
+	// in the order they're executed
+	const std::vector<CompiledPass>& get_compiled_passes() const { return compiled_passes; }
+	// recorded after the last pass, transitions the outputs into their final layouts
+	const std::vector<Barrier>& get_final_barriers() const { return final_barriers; }
+	bool is_culled(uint32_t pass_idx) const;
+
+	const std::string& get_name(ResourceHandle resource) const { return resources[resource].name; }
+	const std::string& get_pass_name(uint32_t pass_idx) const { return passes[pass_idx].name; }
+	// the offset of a transient image into the transient memory
+	VkDeviceSize get_memory_offset(ResourceHandle resource) const;
+	// what the transient images need in total, they all share one allocation
+	VkDeviceSize get_transient_memory_size() const { return transient_memory_size; }
+	uint32_t get_transient_memory_type_bits() const { return transient_memory_type_bits; }
+
+private:
+	struct Resource
+	{
+		std::string name;
+		ImageInfo info;
+		ImportedState imported_state;
+		std::optional<TransientMemory> transient_memory;
+		std::optional<VkImageLayout> output_layout;
+	};
+
+	struct Pass
+	{
+		std::string name;
+		std::vector<PassBuilder::Access> accesses;
+		bool has_side_effects;
+		std::function<void(VkCommandBuffer)> execute;
+	};
+
+	void cull_passes();
+	void place_transient_images();
+	void derive_barriers();
+
+	std::vector<Resource> resources;
+	std::vector<Pass> passes;
+
+	std::vector<bool> live_passes;
+	std::vector<CompiledPass> compiled_passes;
+	std::vector<Barrier> final_barriers;
+	VkDeviceSize transient_memory_size = 0;
+	uint32_t transient_memory_type_bits = ~0u;
+};
@@ -32,13 +32,13 @@ void GuiRenderer::allocate_per_frame_resources(VkImage presentation_image, VkIma
 	this->frame_buffers.push_back(new_frame_buffer);
 }
 
-void GuiRenderer::submit_draw_commands(VkCommandBuffer command_buffer, VkImageView presentation_image_view, uint32_t frame_index)
+void GuiRenderer::submit_draw_commands(VkCommandBuffer command_buffer, VkImageView presentation_image_view, uint32_t frame_index, uint32_t image_index)
 {
 	// starting a render pass
 	VkRenderPassBeginInfo render_pass_begin_info{};
 	render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	render_pass_begin_info.renderPass = this->render_pass;
-	render_pass_begin_info.framebuffer = this->frame_buffers[frame_index];
+	render_pass_begin_info.framebuffer = this->frame_buffers[image_index];
 	render_pass_begin_info.renderArea.offset = { 0, 0 };
 	render_pass_begin_info.renderArea.extent = this->get_extent();
 	
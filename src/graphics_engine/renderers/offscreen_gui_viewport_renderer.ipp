@@ -14,8 +14,6 @@ OffscreenGuiViewportRenderer::~OffscreenGuiViewportRenderer()
 {
 	for (auto& color_attachment : color_attachments)
 		color_attachment.destroy(get_graphics_engine().get_logical_device());
-	for (auto& depth_attachment : depth_attachments)
-		depth_attachment.destroy(get_graphics_engine().get_logical_device());
 }
 
 void OffscreenGuiViewportRenderer::allocate_per_frame_resources(VkImage, VkImageView)
@@ -40,32 +38,19 @@ void OffscreenGuiViewportRenderer::allocate_per_frame_resources(VkImage, VkImage
 		get_image_format(),
 		VK_IMAGE_ASPECT_COLOR_BIT);
 
-	RenderingAttachment depth_attachment;
-	const VkFormat depth_format = get_graphics_engine().find_depth_format();
-	get_graphics_engine().create_image(
-		extent.width,
-		extent.height,
-		depth_format,
-		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		depth_attachment.image,
-		depth_attachment.image_memory,
-		get_msaa_sample_count());
-	depth_attachment.image_view = get_graphics_engine().create_image_view(
-		depth_attachment.image, 
-		depth_format, 
-		VK_IMAGE_ASPECT_DEPTH_BIT);
+	// the depth is transient, the renderer manager allocates it, see get_transient_attachments
+	const VkImageView depth_image_view = get_graphics_engine().get_renderer_mgr().get_transient_attachment_view(
+		ETransientAttachment::OFFSCREEN_GUI_VIEWPORT_DEPTH, 
+		color_attachments.size());
 
 	color_attachments.push_back(color_attachment);
-	depth_attachments.push_back(depth_attachment);
 
 	//
 	// Create framebuffer
 	//
 	std::vector<VkImageView> attachments { 
 		color_attachment.image_view, // main attachment color image_view, that shaders write to
-		depth_attachment.image_view // depth buffer image_view
+		depth_image_view // depth buffer image_view
 	};
 
 	VkFramebufferCreateInfo frame_buffer_create_info{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
@@ -84,9 +69,31 @@ void OffscreenGuiViewportRenderer::allocate_per_frame_resources(VkImage, VkImage
 	this->frame_buffers.push_back(new_frame_buffer);
 }
 
+void OffscreenGuiViewportRenderer::free_per_frame_resources()
+{
+	for (auto& color_attachment : color_attachments)
+		color_attachment.destroy(get_logical_device());
+	color_attachments.clear();
+	Renderer::free_per_frame_resources();
+}
+
+std::vector<Renderer::TransientAttachmentInfo> OffscreenGuiViewportRenderer::get_transient_attachments()
+{
+	return {
+		{ 
+			ETransientAttachment::OFFSCREEN_GUI_VIEWPORT_DEPTH, 
+			"offscreen_gui_viewport_depth",
+			get_graphics_engine().find_depth_format(), 
+			VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+			VK_IMAGE_ASPECT_DEPTH_BIT 
+		},
+	};
+}
+
 void OffscreenGuiViewportRenderer::submit_draw_commands(VkCommandBuffer command_buffer,
 																		 VkImageView,
-																		 uint32_t frame_index)
+																		 uint32_t frame_index,
+																		 uint32_t image_index)
 {
 	const auto& graphics_objects = get_graphics_engine().get_offscreen_rendering_objects();
 	if (graphics_objects.empty())
@@ -97,7 +104,7 @@ void OffscreenGuiViewportRenderer::submit_draw_commands(VkCommandBuffer command_
 	// starting a render pass
 	VkRenderPassBeginInfo render_pass_begin_info{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
 	render_pass_begin_info.renderPass = this->render_pass;
-	render_pass_begin_info.framebuffer = this->frame_buffers[frame_index];
+	render_pass_begin_info.framebuffer = this->frame_buffers[image_index];
 	render_pass_begin_info.renderArea.offset = { 0, 0 };
 	render_pass_begin_info.renderArea.extent = get_extent();
 	
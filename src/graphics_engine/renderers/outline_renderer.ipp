@@ -0,0 +1,184 @@
+#include "renderers.hpp"
+#include "graphics_engine/graphics_engine.hpp"
+
+
+OutlineRenderer::OutlineRenderer(GraphicsEngine& engine) :
+	Renderer(engine)
+{
+	create_render_pass();
+}
+
+OutlineRenderer::~OutlineRenderer()
+{
+	get_rsrc_mgr().free_dsets(stencil_dsets);
+	for (VkImageView stencil_image_view : stencil_image_views)
+	{
+		vkDestroyImageView(get_logical_device(), stencil_image_view, nullptr);
+	}
+}
+
+VkDescriptorSetLayoutBinding OutlineRenderer::get_stencil_binding()
+{
+	VkDescriptorSetLayoutBinding binding{};
+	binding.binding = 0;
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	binding.descriptorCount = 1;
+	binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	binding.pImmutableSamplers = nullptr;
+
+	return binding;
+}
+
+void OutlineRenderer::allocate_per_frame_resources(VkImage, VkImageView presentation_image_view)
+{
+	// the stencil of the rasterization depth attachment of the same image, it's multisampled so
+	// the shader fetches its texels and the sampler is unused
+	const uint32_t image_idx = this->frame_buffers.size();
+	VkImage depth_image = get_graphics_engine().get_renderer_mgr().get_transient_attachment_image(
+		ETransientAttachment::RASTERIZATION_DEPTH,
+		image_idx);
+	const VkImageView stencil_image_view = stencil_image_views.emplace_back(get_graphics_engine().create_image_view(
+		depth_image,
+		get_graphics_engine().find_depth_format(),
+		VK_IMAGE_ASPECT_STENCIL_BIT));
+
+	const VkDescriptorSet stencil_dset = stencil_dsets.emplace_back(
+		get_rsrc_mgr().reserve_dset(get_rsrc_mgr().request_dset_layout({ get_stencil_binding() })));
+
+	VkDescriptorImageInfo image_info{};
+	image_info.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+	image_info.imageView = stencil_image_view;
+	image_info.sampler = get_graphics_engine().get_texture_mgr().fetch_sampler(ETextureSamplerType::ADDR_MODE_CLAMP_TO_EDGE);
+
+	VkWriteDescriptorSet combined_sampler_dset{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+	combined_sampler_dset.dstSet = stencil_dset;
+	combined_sampler_dset.dstBinding = 0;
+	combined_sampler_dset.dstArrayElement = 0; // offset
+	combined_sampler_dset.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	combined_sampler_dset.descriptorCount = 1;
+	combined_sampler_dset.pImageInfo = &image_info;
+
+	vkUpdateDescriptorSets(
+		get_logical_device(),
+		1,
+		&combined_sampler_dset,
+		0,
+		nullptr);
+
+	//
+	// Create framebuffer
+	//
+	const auto extent = this->get_extent();
+	std::vector<VkImageView> attachments { presentation_image_view };
+	VkFramebufferCreateInfo frame_buffer_create_info{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+	frame_buffer_create_info.renderPass = this->render_pass;
+	frame_buffer_create_info.attachmentCount = attachments.size();
+	frame_buffer_create_info.pAttachments = attachments.data();
+	frame_buffer_create_info.width = extent.width;
+	frame_buffer_create_info.height = extent.height;
+	frame_buffer_create_info.layers = 1;
+
+	VkFramebuffer new_frame_buffer;
+	if (vkCreateFramebuffer(get_logical_device(), &frame_buffer_create_info, nullptr, &new_frame_buffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create framebuffer!");
+	}
+	this->frame_buffers.push_back(new_frame_buffer);
+}
+
+void OutlineRenderer::free_per_frame_resources()
+{
+	get_rsrc_mgr().free_dsets(stencil_dsets);
+	stencil_dsets.clear();
+	for (VkImageView stencil_image_view : stencil_image_views)
+	{
+		vkDestroyImageView(get_logical_device(), stencil_image_view, nullptr);
+	}
+	stencil_image_views.clear();
+	Renderer::free_per_frame_resources();
+}
+
+void OutlineRenderer::submit_draw_commands(
+	VkCommandBuffer command_buffer,
+	VkImageView,
+	uint32_t,
+	uint32_t image_index)
+{
+	// starting a render pass
+	VkRenderPassBeginInfo render_pass_begin_info{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+	render_pass_begin_info.renderPass = this->render_pass;
+	render_pass_begin_info.framebuffer = this->frame_buffers[image_index];
+	render_pass_begin_info.renderArea.offset = { 0, 0 };
+	render_pass_begin_info.renderArea.extent = get_extent();
+	render_pass_begin_info.clearValueCount = 0;
+	render_pass_begin_info.pClearValues = nullptr;
+	vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+	const GraphicsEnginePipeline* pipeline = get_graphics_engine().get_pipeline_mgr().fetch_pipeline(
+		{ ERenderType::OUTLINE, EPipelineModifier::NONE });
+	vkCmdBindDescriptorSets(
+		command_buffer,
+		VK_PIPELINE_BIND_POINT_GRAPHICS,
+		pipeline->pipeline_layout,
+		0,
+		1,
+		&stencil_dsets[image_index],
+		0,
+		nullptr);
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->graphics_pipeline);
+
+	// a single triangle covering the screen, the fragments away from the edges of the stencil are discarded
+	vkCmdDraw(command_buffer, 3, 1, 0, 0);
+
+	vkCmdEndRenderPass(command_buffer);
+}
+
+void OutlineRenderer::create_render_pass()
+{
+	//
+	// Color Attachment
+	//
+	VkAttachmentDescription color_attachment{}; // the presentation image, drawn over
+	color_attachment.format = get_image_format();
+	color_attachment.samples = VkSampleCountFlagBits::VK_SAMPLE_COUNT_1_BIT;
+	color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+	color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	color_attachment.initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	VkAttachmentReference color_attachment_ref{};
+	color_attachment_ref.attachment = 0;
+	color_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	//
+	// Subpass
+	//
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &color_attachment_ref;
+
+	// the stencil and the presentation image are synchronised by the render graph
+	VkSubpassDependency dependency{};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.srcAccessMask = 0;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	VkRenderPassCreateInfo render_pass_create_info{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+	render_pass_create_info.attachmentCount = 1;
+	render_pass_create_info.pAttachments = &color_attachment;
+	render_pass_create_info.subpassCount = 1;
+	render_pass_create_info.pSubpasses = &subpass;
+	render_pass_create_info.dependencyCount = 1;
+	render_pass_create_info.pDependencies = &dependency;
+
+	if (vkCreateRenderPass(get_logical_device(), &render_pass_create_info, nullptr, &this->render_pass) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create render pass!");
+	}
+}
@@ -15,12 +15,16 @@ QuadRenderer::QuadRenderer(GraphicsEngine& engine) :
 
 	VkDescriptorSetLayout layout = this->get_rsrc_mgr().request_dset_layout({binding});
 
-	texture = this->get_rsrc_mgr().reserve_dset(layout);
+	for (uint32_t frame_idx = 0; frame_idx < get_num_inflight_frames(); ++frame_idx)
+	{
+		textures.push_back(this->get_rsrc_mgr().reserve_dset(layout));
+	}
+	stale_textures.resize(textures.size(), false);
 }
 
 QuadRenderer::~QuadRenderer()
 {
-	this->get_rsrc_mgr().free_dset(texture);
+	this->get_rsrc_mgr().free_dsets(textures);
 	for (auto& attachment : color_attachments)
 	{
 		attachment.destroy(get_logical_device());
@@ -77,27 +81,24 @@ void QuadRenderer::allocate_per_frame_resources(VkImage, VkImageView)
 void QuadRenderer::submit_draw_commands(
 	VkCommandBuffer command_buffer,
 	VkImageView,
-	uint32_t frame_index)
+	uint32_t frame_index,
+	uint32_t image_index)
 {
 	if (!should_render)
 	{
 		return;
 	}
 
-	if (texture_to_render)
+	// the frame is no longer in flight, so its dset isn't used anymore
+	if (stale_textures[frame_index])
 	{
-		if (texture_to_render.value().num_frames_to_render-- > 0)
-		{
-			return;
-		}
-
 		VkDescriptorImageInfo image_info{};
 		image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		image_info.imageView = texture_to_render.value().texture_view;
 		image_info.sampler = texture_to_render.value().texture_sampler;
 
 		VkWriteDescriptorSet combined_image_sampler_descriptor_set{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-		combined_image_sampler_descriptor_set.dstSet = texture;
+		combined_image_sampler_descriptor_set.dstSet = textures[frame_index];
 		combined_image_sampler_descriptor_set.dstBinding = 0;
 		combined_image_sampler_descriptor_set.dstArrayElement = 0; // offset
 		combined_image_sampler_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -111,13 +112,13 @@ void QuadRenderer::submit_draw_commands(
 			0,
 			nullptr);
 
-		texture_to_render = std::nullopt;
+		stale_textures[frame_index] = false;
 	}
 
 	// starting a render pass
 	VkRenderPassBeginInfo render_pass_begin_info{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
 	render_pass_begin_info.renderPass = this->render_pass;
-	render_pass_begin_info.framebuffer = this->frame_buffers[frame_index];
+	render_pass_begin_info.framebuffer = this->frame_buffers[image_index];
 	render_pass_begin_info.renderArea.offset = { 0, 0 };
 	render_pass_begin_info.renderArea.extent = get_extent();
 	
@@ -146,7 +147,7 @@ void QuadRenderer::submit_draw_commands(
 			{ ERenderType::QUAD, EPipelineModifier::NONE })->pipeline_layout,
 		0,
 		1,
-		&texture,
+		&textures[frame_index],
 		0,
 		nullptr);
 
@@ -170,6 +171,7 @@ void QuadRenderer::set_texture(VkImageView texture_view, VkSampler texture_sampl
 	}
 
 	texture_to_render = { texture_view, texture_sampler };
+	stale_textures.assign(stale_textures.size(), true);
 }
 
 void QuadRenderer::create_render_pass()
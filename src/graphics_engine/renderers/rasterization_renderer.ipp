@@ -15,66 +15,25 @@ RasterizationRenderer::RasterizationRenderer(GraphicsEngine& engine) :
 
 RasterizationRenderer::~RasterizationRenderer()
 {
-	for (auto& color_attachment : color_attachments)
-	{
-		color_attachment.destroy(get_graphics_engine().get_logical_device());
-	}
-	for (auto& depth_attachment : depth_attachments)
-	{
-		depth_attachment.destroy(get_graphics_engine().get_logical_device());
-	}
 	get_rsrc_mgr().free_dsets(shadow_map_dsets);
 	vkDestroySampler(this->get_logical_device(), shadow_map_sampler, nullptr);
 }
 
 void RasterizationRenderer::allocate_per_frame_resources(VkImage presentation_image, VkImageView presentation_image_view)
 {
-	//
-	// Generate attachments
-	//
-	RenderingAttachment color_attachment;
+	// the msaa attachments are transient, the renderer manager allocates them, see get_transient_attachments
+	const uint32_t image_idx = this->frame_buffers.size();
 	const auto extent = this->get_extent();
-	get_graphics_engine().create_image(
-		extent.width, 
-		extent.height,
-		get_image_format(),
-		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		color_attachment.image,
-		color_attachment.image_memory,
-		this->get_msaa_sample_count());
-	color_attachment.image_view = get_graphics_engine().create_image_view(
-		color_attachment.image, 
-		get_image_format(),
-		VK_IMAGE_ASPECT_COLOR_BIT);
-
-	RenderingAttachment depth_attachment;
-	const VkFormat depth_format = get_graphics_engine().find_depth_format();
-	get_graphics_engine().create_image(
-		extent.width,
-		extent.height,
-		depth_format,
-		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		depth_attachment.image,
-		depth_attachment.image_memory,
-		this->get_msaa_sample_count());
-	depth_attachment.image_view = get_graphics_engine().create_image_view(
-		depth_attachment.image, 
-		depth_format, 
-		VK_IMAGE_ASPECT_DEPTH_BIT);
-
-	color_attachments.push_back(color_attachment);
-	depth_attachments.push_back(depth_attachment);
+	auto& renderer_mgr = get_graphics_engine().get_renderer_mgr();
 
 	//
 	// Create framebuffer
 	//
 	std::vector<VkImageView> attachments { 
-		color_attachment.image_view, // main attachment color image_view, that shaders write to
-		depth_attachment.image_view, // depth buffer image_view
+		// main attachment color image_view, that shaders write to
+		renderer_mgr.get_transient_attachment_view(ETransientAttachment::RASTERIZATION_COLOR, image_idx),
+		// depth buffer image_view
+		renderer_mgr.get_transient_attachment_view(ETransientAttachment::RASTERIZATION_DEPTH, image_idx),
 		presentation_image_view // for presentation (msaa resolve is also applied at this step)
 	};
 
@@ -94,16 +53,38 @@ void RasterizationRenderer::allocate_per_frame_resources(VkImage presentation_im
 	this->frame_buffers.push_back(new_frame_buffer);
 }
 
+std::vector<Renderer::TransientAttachmentInfo> RasterizationRenderer::get_transient_attachments()
+{
+	return {
+		{ 
+			ETransientAttachment::RASTERIZATION_COLOR, 
+			"rasterization_color",
+			get_image_format(), 
+			VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+			VK_IMAGE_ASPECT_COLOR_BIT 
+		},
+		{ 
+			ETransientAttachment::RASTERIZATION_DEPTH, 
+			"rasterization_depth",
+			get_graphics_engine().find_depth_format(), 
+			// the outline renderer samples the stencil
+			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+			VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT 
+		},
+	};
+}
+
 void RasterizationRenderer::submit_draw_commands(
 	VkCommandBuffer command_buffer,
 	VkImageView presentation_image_view,
-	uint32_t frame_index)
+	uint32_t frame_index,
+	uint32_t image_index)
 {
 	// starting a render pass
 	VkRenderPassBeginInfo render_pass_begin_info{};
 	render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	render_pass_begin_info.renderPass = this->render_pass;
-	render_pass_begin_info.framebuffer = this->frame_buffers[frame_index];
+	render_pass_begin_info.framebuffer = this->frame_buffers[image_index];
 	render_pass_begin_info.renderArea.offset = { 0, 0 };
 	render_pass_begin_info.renderArea.extent = this->get_extent();
 	
@@ -112,31 +93,24 @@ void RasterizationRenderer::submit_draw_commands(
 	clear_values[1].depthStencil = { 1.0f, 0 };
 	render_pass_begin_info.clearValueCount = clear_values.size();
 	render_pass_begin_info.pClearValues = clear_values.data();
-	vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-	std::vector<VkDescriptorSet> per_frame_dsets = { 
-		get_rsrc_mgr().get_global_dset(frame_index)
-	};
-	vkCmdBindDescriptorSets(command_buffer,
-							VK_PIPELINE_BIND_POINT_GRAPHICS,
-							// lets assume that global descriptor objects only use the STANDARD pipeline
-							// this is a little dodgy but it seems to be working?
-							get_graphics_engine().get_pipeline_mgr().get_generic_pipeline_layout(),
-							SDS::RASTERIZATION_LOW_FREQ_SET_OFFSET,
-							per_frame_dsets.size(),
-							per_frame_dsets.data(),
-							0,
-							nullptr);
-	vkCmdBindDescriptorSets(command_buffer,
-							VK_PIPELINE_BIND_POINT_GRAPHICS,
-							// lets assume that global descriptor objects only use the STANDARD pipeline
-							// this is a little dodgy but it seems to be working?
-							get_graphics_engine().get_pipeline_mgr().get_generic_pipeline_layout(),
-							SDS::RASTERIZATION_SHADOW_MAP_SET_OFFSET,
-							1,
-							&shadow_map_dsets[frame_index],
-							0,
-							nullptr);
+	// the shadow map dset is picked by the image, so the commands are cached per frame in flight and image
+	execute_cached_commands(
+		command_buffer,
+		frame_index * CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES + image_index,
+		[&]() { return gather_objects(); },
+		[&](VkCommandBuffer cached_command_buffer, const RecordingRange& range) {
+			record_draw_commands(cached_command_buffer, range, frame_index, image_index);
+		});
+
+	vkCmdEndRenderPass(command_buffer);
+}
+
+size_t RasterizationRenderer::gather_objects()
+{
+	objects_to_record.clear();
+	stenciled_objects_to_record.clear();
 
 	const auto& graphics_objects = get_graphics_engine().get_objects();
 	const auto& stenciled_ids = get_graphics_engine().get_stenciled_object_ids();
@@ -152,21 +126,9 @@ void RasterizationRenderer::submit_draw_commands(
 		if (stenciled_ids.find(id) != stenciled_ids.end())
 			continue; // skip stenciled objects, we will render them later
 
-		const EPipelineModifier modifier = get_graphics_engine().is_wireframe_mode ? 
-			EPipelineModifier::WIREFRAME : EPipelineModifier::NONE;
-
-		for (uint32_t renderable_idx=0; renderable_idx<graphics_object.get_renderables().size(); ++renderable_idx)
-		{
-			const Renderable& renderable = graphics_object.get_renderables()[renderable_idx];
-			draw_renderable(command_buffer,
-							renderable,
-							graphics_object.get_obj_dset(frame_index),
-							graphics_object.get_renderable_dsets()[renderable_idx],
-							modifier);
-		}
+		objects_to_record.push_back(&graphics_object);
 	}
-	
-	// render stenciled objects again, for stencil effect. It's a little costly but at least it uses simpler shader
+
 	for (const auto& id : stenciled_ids)
 	{
 		const auto it_obj = graphics_objects.find(id);
@@ -180,6 +142,45 @@ void RasterizationRenderer::submit_draw_commands(
 		if (!graphics_object.get_visibility())
 			continue;
 
+		stenciled_objects_to_record.push_back(&graphics_object);
+	}
+
+	return objects_to_record.size();
+}
+
+void RasterizationRenderer::record_draw_commands(
+	VkCommandBuffer command_buffer, 
+	const RecordingRange& range, 
+	uint32_t frame_index, 
+	uint32_t image_index)
+{
+	// secondary command buffers don't inherit any state, every range binds the per frame dsets
+	std::vector<VkDescriptorSet> per_frame_dsets = { 
+		get_rsrc_mgr().get_global_dset(frame_index)
+	};
+	vkCmdBindDescriptorSets(command_buffer,
+							VK_PIPELINE_BIND_POINT_GRAPHICS,
+							// lets assume that global descriptor objects only use the STANDARD pipeline
+							// this is a little dodgy but it seems to be working?
+							get_graphics_engine().get_pipeline_mgr().get_generic_pipeline_layout(),
+							SDS::RASTERIZATION_LOW_FREQ_SET_OFFSET,
+							per_frame_dsets.size(),
+							per_frame_dsets.data(),
+							0,
+							nullptr);
+	vkCmdBindDescriptorSets(command_buffer,
+							VK_PIPELINE_BIND_POINT_GRAPHICS,
+							// lets assume that global descriptor objects only use the STANDARD pipeline
+							// this is a little dodgy but it seems to be working?
+							get_graphics_engine().get_pipeline_mgr().get_generic_pipeline_layout(),
+							SDS::RASTERIZATION_SHADOW_MAP_SET_OFFSET,
+							1,
+							&shadow_map_dsets[image_index],
+							0,
+							nullptr);
+
+	const auto draw_object = [&](const GraphicsEngineObject& graphics_object, EPipelineModifier modifier)
+	{
 		for (uint32_t renderable_idx=0; renderable_idx<graphics_object.get_renderables().size(); ++renderable_idx)
 		{
 			const Renderable& renderable = graphics_object.get_renderables()[renderable_idx];
@@ -187,35 +188,45 @@ void RasterizationRenderer::submit_draw_commands(
 							renderable,
 							graphics_object.get_obj_dset(frame_index),
 							graphics_object.get_renderable_dsets()[renderable_idx],
-							EPipelineModifier::STENCIL);
-		}	
-	}
+							modifier,
+							ERenderType::UNASSIGNED,
+							graphics_object.get_renderable_lod(renderable_idx));
+		}
+	};
 
-	for (const auto& id : stenciled_ids)
+	const EPipelineModifier modifier = get_graphics_engine().is_wireframe_mode ? 
+		EPipelineModifier::WIREFRAME : EPipelineModifier::NONE;
+	for (size_t object_idx = range.begin; object_idx < range.end; ++object_idx)
 	{
-		const auto it_obj = graphics_objects.find(id);
-		if (it_obj == graphics_objects.end())
-			continue;
+		draw_object(*objects_to_record[object_idx], modifier);
+	}
 
-		const auto& graphics_object = *it_obj->second;
-		if (graphics_object.is_marked_for_delete())
-			continue;
+	if (!range.is_last)
+	{
+		return;
+	}
 
-		if (!graphics_object.get_visibility())
-			continue;
-		
-		for (uint32_t renderable_idx=0; renderable_idx<graphics_object.get_renderables().size(); ++renderable_idx)
+	// drawn once, marking the stencil so the outline renderer outlines all of them in a single full-screen pass
+	if (get_graphics_engine().is_outline_mode)
+	{
+		for (const GraphicsEngineObject* graphics_object : stenciled_objects_to_record)
 		{
-			const Renderable& renderable = graphics_object.get_renderables()[renderable_idx];
-			draw_renderable(command_buffer,
-							renderable,
-							graphics_object.get_obj_dset(frame_index),
-							graphics_object.get_renderable_dsets()[renderable_idx],
-							EPipelineModifier::POST_STENCIL);
+			draw_object(*graphics_object, EPipelineModifier::OUTLINE_MASK);
 		}
+		return;
 	}
 
-	vkCmdEndRenderPass(command_buffer);
+	// render stenciled objects again, for stencil effect. It's a little costly but at least it uses simpler shader,
+	// they're drawn after every other object so only the last range records them
+	for (const GraphicsEngineObject* graphics_object : stenciled_objects_to_record)
+	{
+		draw_object(*graphics_object, EPipelineModifier::STENCIL);
+	}
+
+	for (const GraphicsEngineObject* graphics_object : stenciled_objects_to_record)
+	{
+		draw_object(*graphics_object, EPipelineModifier::POST_STENCIL);
+	}
 }
 
 void RasterizationRenderer::set_shadow_map_inputs(const std::vector<VkImageView>& shadow_map_inputs)
@@ -304,7 +315,8 @@ void RasterizationRenderer::create_render_pass()
 	depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 	depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	depth_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	// marks the stenciled objects for the outline renderer
+	depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
 	depth_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	depth_attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
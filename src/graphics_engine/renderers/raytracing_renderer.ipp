@@ -77,19 +77,35 @@ void RaytracingRenderer::allocate_per_frame_resources(
 	presentation_images.push_back(presentation_image);
 }
 
+void RaytracingRenderer::free_per_frame_resources()
+{
+	for (auto& color_attachment : color_attachments)
+	{
+		color_attachment.destroy(get_logical_device());
+	}
+	for (auto& depth_attachment : depth_attachments)
+	{
+		depth_attachment.destroy(get_logical_device());
+	}
+	// rt_dsets still point to the old attachments, update_rt_dsets() replaces them before they're bound again
+	color_attachments.clear();
+	depth_attachments.clear();
+	presentation_images.clear();
+	Renderer::free_per_frame_resources();
+}
+
 void RaytracingRenderer::submit_draw_commands(
 	VkCommandBuffer command_buffer,
 	VkImageView presentation_image_view,
-	uint32_t frame_index)
+	uint32_t frame_index,
+	uint32_t image_index)
 {
 	if (rt_dsets.empty()) // TODO: delete me
 	{
 		return;
 	}
 
-	// updating the tlas every frame, this could potentially be very expensive!!!
-	// TODO: figure out performance costs and whether this is acceptable
-	get_graphics_engine().get_raytracing_module().update_tlas2();
+	// the TLAS is kept up to date by GraphicsEngineRayTracing::process(), a rebuild replaces its handle
 	update_rt_dsets();
 
 	vkCmdBindPipeline(
@@ -100,7 +116,7 @@ void RaytracingRenderer::submit_draw_commands(
 
 	std::vector<VkDescriptorSet> dsets = {
 		get_rsrc_mgr().get_global_dset(frame_index),
-		rt_dsets[frame_index],
+		rt_dsets[image_index],
 		get_rsrc_mgr().get_mesh_data_dset()
 	};
 	vkCmdBindDescriptorSets(
@@ -130,14 +146,14 @@ void RaytracingRenderer::submit_draw_commands(
 
 	// prepare current swapchain image as transfer destination
 	get_graphics_engine().transition_image_layout(
-		presentation_images[frame_index],
+		presentation_images[image_index],
 		VK_IMAGE_LAYOUT_UNDEFINED,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 		command_buffer);
 
 	// prepare raytraced image as transfer source
 	get_graphics_engine().transition_image_layout(
-		color_attachments[frame_index].image,
+		color_attachments[image_index].image,
 		VK_IMAGE_LAYOUT_GENERAL,
 		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 		command_buffer);
@@ -154,9 +170,9 @@ void RaytracingRenderer::submit_draw_commands(
 
 	vkCmdBlitImage(
 		command_buffer,
-		color_attachments[frame_index].image,
+		color_attachments[image_index].image,
 		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-		presentation_images[frame_index],
+		presentation_images[image_index],
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 		1,
 		&region,
@@ -164,14 +180,14 @@ void RaytracingRenderer::submit_draw_commands(
 
 	// return current swapchain image to presentation layout
 	get_graphics_engine().transition_image_layout(
-		presentation_images[frame_index],
+		presentation_images[image_index],
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 		VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
 		command_buffer);
 
 	// return raytraced image to general layout, which is the required layout for rendering
 	get_graphics_engine().transition_image_layout(
-		color_attachments[frame_index].image,
+		color_attachments[image_index].image,
 		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 		VK_IMAGE_LAYOUT_GENERAL,
 		command_buffer);
@@ -5,11 +5,15 @@
 #include "offscreen_gui_viewport_renderer.ipp"
 #include "shadowmap_renderer.ipp"
 #include "quad_renderer.ipp"
+#include "outline_renderer.ipp"
 #include "renderer_manager.ipp"
 #include "graphics_engine/graphics_engine.hpp"
 #include "game_engine.hpp"
 #include "renderable/mesh.hpp"
 #include "entity_component_system/mesh_system.hpp"
+#include "profiler.hpp"
+
+#include <utility>
 
 
 Renderer::Renderer(GraphicsEngine& engine) :
@@ -28,6 +32,99 @@ Renderer::~Renderer()
 	{
 		vkDestroyFramebuffer(logical_device, frame_buffer, nullptr);
 	}
+	// the cached command buffers are freed with the command pools of GraphicsEngineCommandRecorder
+}
+
+void Renderer::free_per_frame_resources()
+{
+	for (auto frame_buffer : frame_buffers)
+	{
+		vkDestroyFramebuffer(get_logical_device(), frame_buffer, nullptr);
+	}
+	frame_buffers.clear();
+}
+
+Renderer::CommandCacheStatistics Renderer::take_command_cache_statistics()
+{
+	return std::exchange(command_cache_statistics, {});
+}
+
+void Renderer::execute_cached_commands(VkCommandBuffer command_buffer,
+									   uint32_t cache_slot,
+									   const std::function<size_t()>& gather_objects,
+									   const std::function<void(VkCommandBuffer, const RecordingRange&)>& record_range,
+									   size_t state_hash)
+{
+	if (cache_slot >= cached_commands.size())
+	{
+		cached_commands.resize(cache_slot + 1);
+	}
+
+	CachedCommands& cached = cached_commands[cache_slot];
+	const uint64_t scene_version = get_graphics_engine().get_scene_version();
+	if (cached.scene_version == scene_version && cached.state_hash == state_hash)
+	{
+		++command_cache_statistics.num_hits;
+		vkCmdExecuteCommands(command_buffer, cached.num_recorded, cached.command_buffers.data());
+		return;
+	}
+
+	PROFILE_SCOPE("Renderer::record_cached_commands");
+	++command_cache_statistics.num_misses;
+
+	auto& recorder = get_graphics_engine().get_command_recorder();
+	const size_t num_objects = gather_objects();
+	const uint32_t num_jobs = recorder.get_num_jobs(num_objects);
+	// sized up front, the workers only touch their own command buffer
+	cached.command_buffers.resize(recorder.get_num_workers(), VK_NULL_HANDLE);
+
+	VkCommandBufferInheritanceInfo inheritance_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+	inheritance_info.renderPass = render_pass;
+	inheritance_info.subpass = 0;
+	// left unknown, the commands are replayed into the framebuffer of whichever image is acquired
+	inheritance_info.framebuffer = VK_NULL_HANDLE;
+
+	VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+	// no ONE_TIME_SUBMIT, the commands are replayed until the scene changes
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	begin_info.pInheritanceInfo = &inheritance_info;
+
+	recorder.run(num_jobs, [&](uint32_t worker_idx)
+	{
+		PROFILE_SCOPE("Renderer::record_range");
+
+		VkCommandBuffer& cached_command_buffer = cached.command_buffers[worker_idx];
+		if (!cached_command_buffer)
+		{
+			cached_command_buffer = recorder.allocate_secondary_command_buffer(worker_idx);
+		} else
+		{
+			// only the frame that owns the slot executes it, and it was waited for before recording
+			vkResetCommandBuffer(cached_command_buffer, 0);
+		}
+
+		if (vkBeginCommandBuffer(cached_command_buffer, &begin_info) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Renderer::execute_cached_commands: failed to begin recording command buffer!");
+		}
+
+		const RecordingRange range{
+			num_objects * worker_idx / num_jobs,
+			num_objects * (worker_idx + 1) / num_jobs,
+			worker_idx == num_jobs - 1 };
+		record_range(cached_command_buffer, range);
+
+		if (vkEndCommandBuffer(cached_command_buffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Renderer::execute_cached_commands: failed to record command buffer!");
+		}
+	});
+	cached.num_recorded = num_jobs;
+	cached.scene_version = scene_version;
+	cached.state_hash = state_hash;
+
+	// executed in order, so the ranges are drawn in the order they were gathered
+	vkCmdExecuteCommands(command_buffer, cached.num_recorded, cached.command_buffers.data());
 }
 
 VkExtent2D Renderer::get_extent()
@@ -40,7 +137,9 @@ void Renderer::draw_renderable(VkCommandBuffer command_buffer,
 							   const VkDescriptorSet& object_dset,
 							   const VkDescriptorSet& renderable_dset,
 						   	   EPipelineModifier pipeline_modifier,
-						   	   ERenderType primary_pipeline_override)
+						   	   ERenderType primary_pipeline_override,
+						   	   uint32_t lod,
+						   	   uint32_t first_instance)
 {
 	const ERenderType primary_pipeline_type = primary_pipeline_override == ERenderType::UNASSIGNED ?
 		renderable.pipeline_render_type : primary_pipeline_override;
@@ -78,7 +177,7 @@ void Renderer::draw_renderable(VkCommandBuffer command_buffer,
 	vkCmdBindIndexBuffer(command_buffer,
 						 get_rsrc_mgr().get_index_buffer(),
 						 index_buffer_offset,
-						 VK_INDEX_TYPE_UINT32);
+						 mesh.has_16bit_indices() ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
 
 	// binds renderable specific dsets, i.e. material group
 	vkCmdBindDescriptorSets(command_buffer, 
@@ -90,15 +189,16 @@ void Renderer::draw_renderable(VkCommandBuffer command_buffer,
 							0,
 							nullptr);
 
+	const MeshLod mesh_lod = mesh.get_lod(std::min(lod, mesh.get_num_lods() - 1));
 	vkCmdDrawIndexed(command_buffer,
-					 mesh.get_num_vertex_indices(),
+					 mesh_lod.num_indices,
 					 1,		// instance count
-					 0,		// first index
+					 mesh_lod.first_index,	// first index, coarser LODs are stored after LOD 0
 					 0,		// first vertex index (used for offsetting and defines the lowest value of gl_VertexIndex)
-					 0);	// first instance, used as offset for instance rendering, defines the lower value of gl_InstanceIndex
+					 first_instance);	// first instance, used as offset for instance rendering, defines the lower value of gl_InstanceIndex
 };
 
 constexpr uint32_t Renderer::get_num_inflight_frames()
 {
-	return GraphicsEngine::get_num_swapchain_images();	
+	return GraphicsEngine::get_num_frames_in_flight();
 }
\ No newline at end of file
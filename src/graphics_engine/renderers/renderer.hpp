@@ -4,10 +4,16 @@
 #include "graphics_engine/vulkan_wrappers.hpp"
 #include "graphics_engine/constants.hpp"
 #include "graphics_engine/pipeline/pipeline_id.hpp"
+#include "graphics_engine/render_graph.hpp"
 #include "renderable/render_types.hpp"
 
 #include <vulkan/vulkan.hpp>
 
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
 
 enum class ERendererType
 {
@@ -18,6 +24,16 @@ enum class ERendererType
 	OFFSCREEN_GUI_VIEWPORT,
 	SHADOW_MAP,
 	QUAD,
+	OUTLINE,
+};
+
+// attachments only used within the render pass of a renderer, the RendererManager allocates them
+// so that the ones of passes that don't overlap share memory, see RenderGraph
+enum class ETransientAttachment
+{
+	RASTERIZATION_COLOR,
+	RASTERIZATION_DEPTH,
+	OFFSCREEN_GUI_VIEWPORT_DEPTH,
 };
 
 class GraphicsEngineObject;
@@ -29,32 +45,84 @@ class Renderable;
 class Renderer : public GraphicsEngineBaseModule
 {
 public:
+	// cached draw commands replayed and recorded again since the statistics were last taken
+	struct CommandCacheStatistics
+	{
+		uint32_t num_hits = 0;
+		uint32_t num_misses = 0;
+	};
+
+	struct TransientAttachmentInfo
+	{
+		ETransientAttachment type;
+		std::string name;
+		VkFormat format;
+		VkImageUsageFlags usage;
+		VkImageAspectFlags aspect;
+	};
+
 	Renderer(GraphicsEngine& engine);
 	~Renderer();
 
 	// generates framebuffers
 	virtual void allocate_per_frame_resources(VkImage presentation_image, VkImageView presentation_image_view) = 0;
+	// when the swap chain is recreated the per frame resources of the renderers that depend on it
+	// are freed and allocated again for the new images
+	virtual void free_per_frame_resources();
+	virtual bool depends_on_swap_chain() const { return true; }
+	// frame_index picks the per frame uniform dsets of the frame in flight, image_index the
+	// per frame resources allocated for the acquired swap chain image
 	virtual void submit_draw_commands(VkCommandBuffer command_buffer, 
 									  VkImageView presentation_image_view, 
-									  uint32_t frame_index) = 0;
+									  uint32_t frame_index,
+									  uint32_t image_index) = 0;
 	virtual constexpr ERendererType get_renderer_type() const = 0;
-	virtual VkImageView get_output_image_view(uint32_t frame_idx) = 0;
+	virtual VkImageView get_output_image_view(uint32_t image_idx) = 0;
+	// the image behind get_output_image_view, for the render graph to synchronise the passes sampling it
+	virtual RenderGraph::ImageInfo get_output_image(uint32_t) { return {}; }
+	// they're of the extent and sample count of the renderer, allocated before the per frame resources
+	virtual std::vector<TransientAttachmentInfo> get_transient_attachments() { return {}; }
 
 	virtual VkSampleCountFlagBits get_msaa_sample_count() const { return CSTS::MSAA_SAMPLE_COUNT; }
 	virtual VkExtent2D get_extent();
 	
 	VkRenderPass get_render_pass() { return render_pass; }
+	CommandCacheStatistics take_command_cache_statistics();
 	
 	virtual void draw_renderable(VkCommandBuffer command_buffer,
 							 	 const Renderable& renderable,
 							 	 const VkDescriptorSet& object_dset,
 							 	 const VkDescriptorSet& renderable_dset,
 							 	 EPipelineModifier pipeline_modifier,
-							 	 ERenderType primary_pipeline_override = ERenderType::UNASSIGNED);
+							 	 ERenderType primary_pipeline_override = ERenderType::UNASSIGNED,
+							 	 uint32_t lod = 0,
+							 	 // gl_InstanceIndex of the draw, the shadow map shaders read their cascade from it
+							 	 uint32_t first_instance = 0);
 
 protected:
 	static constexpr uint32_t get_num_inflight_frames();
 
+	// a contiguous range of the objects gathered for recording, see execute_cached_commands
+	struct RecordingRange
+	{
+		size_t begin;
+		size_t end;
+		// executed after every other range
+		bool is_last;
+	};
+
+	// replays the draw commands cached in the slot. When the scene changed since they were recorded,
+	// see GraphicsEngine::get_scene_version, gather_objects collects what's drawn and returns how many objects
+	// there are, they're split into ranges that record_range records in parallel, each into a secondary
+	// command buffer of its own, see GraphicsEngineCommandRecorder. The render pass has to be begun with
+	// VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS and a slot must only be used by one frame in flight.
+	// state_hash covers whatever else the gathering depends on, the commands are recorded again when it changes
+	void execute_cached_commands(VkCommandBuffer command_buffer, 
+								 uint32_t cache_slot, 
+								 const std::function<size_t()>& gather_objects,
+								 const std::function<void(VkCommandBuffer, const RecordingRange&)>& record_range,
+								 size_t state_hash = 0);
+
 protected:
 	// A render pass is a general description of steps to draw something on the screen
 	//	it's made of at least 1 subpass, which can be executed in parallel (subpasses are mostly used in mobile optimisations)
@@ -66,4 +134,19 @@ protected:
 
 	// per frame resources
 	std::vector<VkFramebuffer> frame_buffers;
+
+private:
+	struct CachedCommands
+	{
+		// secondary command buffers that continue the render pass, one per worker allocated from its pool
+		std::vector<VkCommandBuffer> command_buffers;
+		// how many of them the last recording used, in the order they're executed
+		uint32_t num_recorded = 0;
+		// scene version the commands were recorded at, none until they're first recorded
+		std::optional<uint64_t> scene_version;
+		size_t state_hash = 0;
+	};
+
+	std::vector<CachedCommands> cached_commands;
+	CommandCacheStatistics command_cache_statistics;
 };
\ No newline at end of file
@@ -2,15 +2,21 @@
 
 #include "renderer.hpp"
 #include "graphics_engine/vulkan_wrappers.hpp"
+#include "graphics_engine/render_graph.hpp"
 
 #include <map>
 #include <memory>
+#include <vector>
+
+
+struct SwapChainImage;
 
 
 class RendererManager : public GraphicsEngineBaseModule
 {
 public:
 	RendererManager(GraphicsEngine& engine);
+	~RendererManager();
 	Renderer& get_renderer(ERendererType type)
 	{
 		auto it = renderers.find(type);
@@ -37,7 +43,50 @@ public:
 	void linkup_renderers();
 	void pipe_output_to_quad_renderer(ERendererType src_renderer);
 
+	// records the passes of the renderers as a render graph, the passes whose outputs aren't used are culled
+	void record_frame(VkCommandBuffer command_buffer, const SwapChainImage& image, uint32_t frame_index);
+
+	// per swap chain image, the attachments of the passes that don't overlap share memory.
+	// allocated before the per frame resources of the renderers, which make their frame buffers with them
+	void allocate_transient_attachments();
+	void free_transient_attachments();
+	VkImageView get_transient_attachment_view(ETransientAttachment type, uint32_t image_idx) const;
+	// for the renderers viewing other aspects of it
+	VkImage get_transient_attachment_image(ETransientAttachment type, uint32_t image_idx) const;
+
 private:
+	struct FrameState
+	{
+		uint32_t image_index = 0;
+		VkImage presentation_image = VK_NULL_HANDLE;
+		VkImageView presentation_image_view = VK_NULL_HANDLE;
+		uint32_t frame_index = 0;
+		bool rtx_on = false;
+		bool has_offscreen_objects = false;
+		// stenciled objects drawn in the outline mode
+		bool has_outlines = false;
+		// declares every pass with placeholders for the images that aren't transient, 
+		// for placing the transient attachments so that they fit any frame
+		bool placement_only = false;
+	};
+
+	struct TransientAttachment
+	{
+		Renderer::TransientAttachmentInfo info;
+		VkImage image = VK_NULL_HANDLE;
+		VkImageView image_view = VK_NULL_HANDLE;
+		RenderGraph::TransientMemory memory;
+	};
+
+	const TransientAttachment& get_transient_attachment(ETransientAttachment type, uint32_t image_idx) const;
+	// returns the transient attachments of the image, in the order of transient_attachments
+	std::vector<RenderGraph::ResourceHandle> declare_passes(RenderGraph& render_graph, const FrameState& frame_state);
+
 	std::map<ERendererType, std::unique_ptr<Renderer>> renderers;
+	ERendererType quad_input = ERendererType::NONE;
+
+	// per swap chain image
+	std::vector<std::vector<TransientAttachment>> transient_attachments;
+	std::vector<VkDeviceMemory> transient_memories;
 
 	};
\ No newline at end of file
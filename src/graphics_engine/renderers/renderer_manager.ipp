@@ -1,4 +1,9 @@
 #include "renderer_manager.hpp"
+#include "renderers.hpp"
+#include "graphics_engine/graphics_engine.hpp"
+#include "utility.hpp"
+
+#include <quill/LogMacros.h>
 
 
 RendererManager::RendererManager(GraphicsEngine& engine) :
@@ -10,16 +15,24 @@ RendererManager::RendererManager(GraphicsEngine& engine) :
 	renderers[ERendererType::OFFSCREEN_GUI_VIEWPORT] = std::make_unique<OffscreenGuiViewportRenderer>(engine);
 	renderers[ERendererType::SHADOW_MAP] = std::make_unique<ShadowMapRenderer>(engine);
 	renderers[ERendererType::QUAD] = std::make_unique<QuadRenderer>(engine);
+	renderers[ERendererType::OUTLINE] = std::make_unique<OutlineRenderer>(engine);
+}
+
+RendererManager::~RendererManager()
+{
+	// the frame buffers of the renderers use the transient attachments
+	renderers.clear();
+	free_transient_attachments();
 }
 
 void RendererManager::linkup_renderers()
 {
-	// link output of shadowmap renderer to input of rasterization renderer
-	auto& shadow_map_renderer = get_renderer(ERendererType::SHADOW_MAP);
+	// link the cascades of the shadowmap renderer to the input of the rasterization renderer
+	auto& shadow_map_renderer = static_cast<ShadowMapRenderer&>(get_renderer(ERendererType::SHADOW_MAP));
 	std::vector<VkImageView> shadow_map_inputs;
-	for (int frame_idx = 0; frame_idx < CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES; ++frame_idx)
+	for (int image_idx = 0; image_idx < CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES; ++image_idx)
 	{
-		shadow_map_inputs.push_back(get_renderer(ERendererType::SHADOW_MAP).get_output_image_view(frame_idx));
+		shadow_map_inputs.push_back(shadow_map_renderer.get_cascades_image_view(image_idx));
 	}	
 	auto& rasterization_renderer = static_cast<RasterizationRenderer&>(get_renderer(ERendererType::RASTERIZATION));
 	rasterization_renderer.set_shadow_map_inputs(shadow_map_inputs);
@@ -33,6 +46,7 @@ void RendererManager::pipe_output_to_quad_renderer(ERendererType src_renderer)
 	}
 
 	auto& quad_renderer = static_cast<QuadRenderer&>(get_renderer(ERendererType::QUAD));
+	quad_input = src_renderer;
 
 	if (src_renderer == ERendererType::NONE)
 	{
@@ -47,3 +61,339 @@ void RendererManager::pipe_output_to_quad_renderer(ERendererType src_renderer)
 		get_graphics_engine().get_texture_mgr().fetch_sampler(ETextureSamplerType::ADDR_MODE_CLAMP_TO_EDGE));
 	quad_renderer.set_texture_sampling_flags(1);
 }
+
+
+void RendererManager::record_frame(VkCommandBuffer command_buffer, const SwapChainImage& image, uint32_t frame_index)
+{
+	FrameState frame_state{};
+	frame_state.image_index = image.image_index;
+	frame_state.presentation_image = image.image;
+	frame_state.presentation_image_view = image.image_view;
+	frame_state.frame_index = frame_index;
+	frame_state.rtx_on = get_graphics_engine().get_gui_manager().graphic_settings.rtx_on;
+	frame_state.has_offscreen_objects = !get_graphics_engine().get_offscreen_rendering_objects().empty();
+	frame_state.has_outlines = 
+		get_graphics_engine().is_outline_mode && !get_graphics_engine().get_stenciled_object_ids().empty();
+
+	RenderGraph render_graph;
+	declare_passes(render_graph, frame_state);
+	render_graph.compile();
+	render_graph.execute(command_buffer);
+}
+
+std::vector<RenderGraph::ResourceHandle> RendererManager::declare_passes(RenderGraph& render_graph, const FrameState& frame_state)
+{
+	const uint32_t image_idx = frame_state.image_index;
+
+	// renderers sample the outputs of image 0 whatever the image, so an image is imported once
+	std::map<VkImage, RenderGraph::ResourceHandle> imported_images;
+	const auto import_image = [&](const std::string& name, 
+								  const RenderGraph::ImageInfo& info, 
+								  const RenderGraph::ImportedState& state)
+	{
+		if (info.image == VK_NULL_HANDLE)
+		{
+			return render_graph.import_image(name, info, state);
+		}
+
+		auto it = imported_images.find(info.image);
+		if (it == imported_images.end())
+		{
+			it = imported_images.emplace(info.image, render_graph.import_image(name, info, state)).first;
+		}
+		return it->second;
+	};
+	// the outputs are sampled after their passes, so the frames before left them in that layout
+	const auto import_output = [&](const std::string& name, ERendererType type, uint32_t output_idx)
+	{
+		const RenderGraph::ImportedState sampled_state{ 
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+			VK_ACCESS_SHADER_READ_BIT };
+		return import_image(
+			name, 
+			frame_state.placement_only ? RenderGraph::ImageInfo{} : get_renderer(type).get_output_image(output_idx), 
+			sampled_state);
+	};
+
+	// the acquire semaphore is waited for at the color attachment output stage
+	const RenderGraph::ResourceHandle presentation = import_image(
+		"presentation", 
+		{ frame_state.presentation_image }, 
+		{ VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0 });
+	render_graph.set_output(presentation, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+	std::vector<RenderGraph::ResourceHandle> transients;
+	std::map<ETransientAttachment, RenderGraph::ResourceHandle> transient_handles;
+	if (image_idx < transient_attachments.size())
+	{
+		for (const TransientAttachment& attachment : transient_attachments[image_idx])
+		{
+			const RenderGraph::ResourceHandle handle = render_graph.create_transient_image(
+				attachment.info.name, 
+				{ attachment.image, attachment.info.aspect }, 
+				attachment.memory);
+			transients.push_back(handle);
+			transient_handles[attachment.info.type] = handle;
+		}
+	}
+	const auto get_transient = [&](ETransientAttachment type)
+	{
+		const auto it = transient_handles.find(type);
+		if (it == transient_handles.end())
+		{
+			throw std::runtime_error("RendererManager::declare_passes: transient attachment not allocated");
+		}
+		return it->second;
+	};
+
+	const auto add_renderer_pass = [&](const std::string& name, 
+									   ERendererType type, 
+									   const std::function<void(RenderGraph::PassBuilder&)>& setup)
+	{
+		render_graph.add_pass(name, setup, [this, type, frame_state](VkCommandBuffer command_buffer) {
+			get_renderer(type).submit_draw_commands(
+				command_buffer, frame_state.presentation_image_view, frame_state.frame_index, frame_state.image_index);
+		});
+	};
+
+	if (!frame_state.rtx_on || frame_state.placement_only)
+	{
+		const RenderGraph::ResourceHandle shadow_map = import_output("shadow_map", ERendererType::SHADOW_MAP, image_idx);
+		add_renderer_pass("shadow_map", ERendererType::SHADOW_MAP, [&](RenderGraph::PassBuilder& builder) {
+			builder.write(
+				shadow_map, 
+				RenderGraph::EUsage::DEPTH_ATTACHMENT, 
+				VK_IMAGE_LAYOUT_UNDEFINED, 
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		});
+
+		add_renderer_pass("rasterization", ERendererType::RASTERIZATION, [&](RenderGraph::PassBuilder& builder) {
+			builder.read(shadow_map, RenderGraph::EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			builder.write(
+				get_transient(ETransientAttachment::RASTERIZATION_COLOR), 
+				RenderGraph::EUsage::COLOR_ATTACHMENT, 
+				VK_IMAGE_LAYOUT_UNDEFINED, 
+				VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+			builder.write(
+				get_transient(ETransientAttachment::RASTERIZATION_DEPTH), 
+				RenderGraph::EUsage::DEPTH_ATTACHMENT, 
+				VK_IMAGE_LAYOUT_UNDEFINED, 
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+			// the msaa resolve
+			builder.write(
+				presentation, 
+				RenderGraph::EUsage::COLOR_ATTACHMENT, 
+				VK_IMAGE_LAYOUT_UNDEFINED, 
+				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		});
+
+		if (frame_state.has_outlines || frame_state.placement_only)
+		{
+			// the stenciled objects are marked in the stencil of the rasterization depth
+			add_renderer_pass("outline", ERendererType::OUTLINE, [&](RenderGraph::PassBuilder& builder) {
+				builder.read(
+					get_transient(ETransientAttachment::RASTERIZATION_DEPTH), 
+					RenderGraph::EUsage::SAMPLED, 
+					VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+				builder.read(presentation, RenderGraph::EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+				builder.write(
+					presentation, 
+					RenderGraph::EUsage::COLOR_ATTACHMENT, 
+					VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 
+					VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+			});
+		}
+
+		auto& quad_renderer = static_cast<QuadRenderer&>(get_renderer(ERendererType::QUAD));
+		if (quad_renderer.has_texture() || frame_state.placement_only)
+		{
+			// the quad renderer is handed the output of image 0, see pipe_output_to_quad_renderer
+			const RenderGraph::ResourceHandle quad_input_image = import_output("quad_input", quad_input, 0);
+			const RenderGraph::ResourceHandle quad_output = import_output("quad_output", ERendererType::QUAD, image_idx);
+			add_renderer_pass("quad", ERendererType::QUAD, [&](RenderGraph::PassBuilder& builder) {
+				builder.read(quad_input_image, RenderGraph::EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				builder.write(
+					quad_output, 
+					RenderGraph::EUsage::COLOR_ATTACHMENT, 
+					VK_IMAGE_LAYOUT_UNDEFINED, 
+					VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			});
+		}
+	}
+
+	if (frame_state.rtx_on || frame_state.placement_only)
+	{
+		// blits the traced image into the presentation image
+		add_renderer_pass("raytracing", ERendererType::RAYTRACING, [&](RenderGraph::PassBuilder& builder) {
+			builder.write(
+				presentation, 
+				RenderGraph::EUsage::TRANSFER_DST, 
+				VK_IMAGE_LAYOUT_UNDEFINED, 
+				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		});
+	}
+
+	if (frame_state.has_offscreen_objects || frame_state.placement_only)
+	{
+		const RenderGraph::ResourceHandle offscreen_color = import_output(
+			"offscreen_gui_viewport_color", ERendererType::OFFSCREEN_GUI_VIEWPORT, image_idx);
+		add_renderer_pass("offscreen_gui_viewport", ERendererType::OFFSCREEN_GUI_VIEWPORT, [&](RenderGraph::PassBuilder& builder) {
+			builder.write(
+				offscreen_color, 
+				RenderGraph::EUsage::COLOR_ATTACHMENT, 
+				VK_IMAGE_LAYOUT_UNDEFINED, 
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			builder.write(
+				get_transient(ETransientAttachment::OFFSCREEN_GUI_VIEWPORT_DEPTH), 
+				RenderGraph::EUsage::DEPTH_ATTACHMENT, 
+				VK_IMAGE_LAYOUT_UNDEFINED, 
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+		});
+	}
+
+	// the gui shows the outputs of image 0 and draws on top of the presentation image
+	const RenderGraph::ResourceHandle gui_quad_output = import_output("quad_output", ERendererType::QUAD, 0);
+	const RenderGraph::ResourceHandle gui_offscreen_color = import_output(
+		"offscreen_gui_viewport_color", ERendererType::OFFSCREEN_GUI_VIEWPORT, 0);
+	add_renderer_pass("gui", ERendererType::GUI, [&](RenderGraph::PassBuilder& builder) {
+		builder.read(gui_quad_output, RenderGraph::EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		builder.read(gui_offscreen_color, RenderGraph::EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		builder.read(presentation, RenderGraph::EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		builder.write(
+			presentation, 
+			RenderGraph::EUsage::COLOR_ATTACHMENT, 
+			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 
+			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	});
+
+	return transients;
+}
+
+void RendererManager::allocate_transient_attachments()
+{
+	const VkDevice device = get_logical_device();
+	transient_attachments.resize(CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES);
+	transient_memories.resize(CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES, VK_NULL_HANDLE);
+	for (uint32_t image_idx = 0; image_idx < CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES; ++image_idx)
+	{
+		auto& attachments = transient_attachments[image_idx];
+		VkDeviceSize unaliased_size = 0;
+		for (Renderer* renderer : get_renderers())
+		{
+			for (const Renderer::TransientAttachmentInfo& info : renderer->get_transient_attachments())
+			{
+				TransientAttachment attachment{};
+				attachment.info = info;
+
+				// bound once the render graph placed it
+				const VkExtent2D extent = renderer->get_extent();
+				VkImageCreateInfo image_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+				image_info.imageType = VK_IMAGE_TYPE_2D;
+				image_info.extent = { extent.width, extent.height, 1 };
+				image_info.mipLevels = 1;
+				image_info.arrayLayers = 1;
+				image_info.format = info.format;
+				image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+				image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				image_info.usage = info.usage;
+				image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				image_info.samples = renderer->get_msaa_sample_count();
+				if (vkCreateImage(device, &image_info, nullptr, &attachment.image) != VK_SUCCESS)
+				{
+					throw std::runtime_error("RendererManager::allocate_transient_attachments: failed to create image!");
+				}
+
+				VkMemoryRequirements memory_requirements;
+				vkGetImageMemoryRequirements(device, attachment.image, &memory_requirements);
+				attachment.memory.size = memory_requirements.size;
+				attachment.memory.alignment = memory_requirements.alignment;
+				attachment.memory.memory_type_bits = memory_requirements.memoryTypeBits;
+				unaliased_size += memory_requirements.size;
+
+				attachments.push_back(attachment);
+			}
+		}
+
+		// the lifetimes are those of a frame running every pass, so the placement fits any frame
+		FrameState frame_state{};
+		frame_state.image_index = image_idx;
+		frame_state.placement_only = true;
+		RenderGraph render_graph;
+		const std::vector<RenderGraph::ResourceHandle> transients = declare_passes(render_graph, frame_state);
+		render_graph.compile();
+
+		VkMemoryAllocateInfo alloc_info{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+		alloc_info.allocationSize = render_graph.get_transient_memory_size();
+		alloc_info.memoryTypeIndex = get_graphics_engine().find_memory_type(
+			render_graph.get_transient_memory_type_bits(), 
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (vkAllocateMemory(device, &alloc_info, nullptr, &transient_memories[image_idx]) != VK_SUCCESS)
+		{
+			throw std::runtime_error("RendererManager::allocate_transient_attachments: failed to allocate memory!");
+		}
+
+		for (uint32_t attachment_idx = 0; attachment_idx < attachments.size(); ++attachment_idx)
+		{
+			TransientAttachment& attachment = attachments[attachment_idx];
+			attachment.memory.offset = render_graph.get_memory_offset(transients[attachment_idx]);
+			vkBindImageMemory(device, attachment.image, transient_memories[image_idx], attachment.memory.offset.value());
+			attachment.image_view = get_graphics_engine().create_image_view(
+				attachment.image, 
+				attachment.info.format, 
+				attachment.info.aspect);
+		}
+
+		LOG_INFO(Utility::get_logger(), "RendererManager: transient attachments of image {} take {} of {} bytes", 
+			image_idx, alloc_info.allocationSize, unaliased_size);
+	}
+}
+
+void RendererManager::free_transient_attachments()
+{
+	const VkDevice device = get_logical_device();
+	for (auto& attachments : transient_attachments)
+	{
+		for (TransientAttachment& attachment : attachments)
+		{
+			vkDestroyImageView(device, attachment.image_view, nullptr);
+			vkDestroyImage(device, attachment.image, nullptr);
+		}
+	}
+	for (VkDeviceMemory memory : transient_memories)
+	{
+		vkFreeMemory(device, memory, nullptr);
+	}
+	transient_attachments.clear();
+	transient_memories.clear();
+}
+
+VkImageView RendererManager::get_transient_attachment_view(ETransientAttachment type, uint32_t image_idx) const
+{
+	return get_transient_attachment(type, image_idx).image_view;
+}
+
+VkImage RendererManager::get_transient_attachment_image(ETransientAttachment type, uint32_t image_idx) const
+{
+	return get_transient_attachment(type, image_idx).image;
+}
+
+const RendererManager::TransientAttachment& RendererManager::get_transient_attachment(
+	ETransientAttachment type, 
+	uint32_t image_idx) const
+{
+	if (image_idx >= transient_attachments.size())
+	{
+		throw std::runtime_error("RendererManager::get_transient_attachment: transient attachments not allocated");
+	}
+
+	for (const TransientAttachment& attachment : transient_attachments[image_idx])
+	{
+		if (attachment.info.type == type)
+		{
+			return attachment;
+		}
+	}
+
+	throw std::runtime_error("RendererManager::get_transient_attachment: transient attachment not found");
+}
\ No newline at end of file
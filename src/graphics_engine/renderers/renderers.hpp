@@ -1,6 +1,8 @@
 #pragma once
 
 #include "renderer.hpp"
+#include "shadow_cascades.hpp"
+#include "shared_data_structures.hpp"
 
 #include <optional>
 
@@ -12,9 +14,11 @@ public:
 	~RasterizationRenderer();
 
 	virtual void allocate_per_frame_resources(VkImage presentation_image, VkImageView presentation_image_view) override;
-	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView presentation_image_view, uint32_t frame_index) override;
+	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView presentation_image_view, uint32_t frame_index, uint32_t image_index) override;
 	virtual constexpr ERendererType get_renderer_type() const override { return ERendererType::RASTERIZATION; }
 	virtual VkImageView get_output_image_view(uint32_t) override { return nullptr; };
+	// the msaa color and depth, only the resolved presentation image is used after the pass
+	virtual std::vector<TransientAttachmentInfo> get_transient_attachments() override;
 	void set_shadow_map_inputs(const std::vector<VkImageView>& shadow_map_inputs);
 
 private:
@@ -24,14 +28,17 @@ private:
 
 	static constexpr VkFormat get_image_format() { return VK_FORMAT_B8G8R8A8_SRGB; }
 	void create_render_pass();
-
-	std::vector<RenderingAttachment> color_attachments;
-	std::vector<RenderingAttachment> depth_attachments;
-	// presentation attachment which is also responsible for msaa resolve, is owned by the swapchain
+	// collects the objects to draw for recording the cached commands, see Renderer::execute_cached_commands
+	size_t gather_objects();
+	void record_draw_commands(VkCommandBuffer command_buffer, const RecordingRange& range, uint32_t frame_index, uint32_t image_index);
 
 	std::vector<VkDescriptorSet> shadow_map_dsets;
 
 	VkSampler shadow_map_sampler;
+
+	// split into the recording ranges, the stenciled ones are all recorded by the last range
+	std::vector<const GraphicsEngineObject*> objects_to_record;
+	std::vector<const GraphicsEngineObject*> stenciled_objects_to_record;
 };
 
 class GuiRenderer : public Renderer
@@ -41,7 +48,7 @@ public:
 	~GuiRenderer();
 
 	virtual void allocate_per_frame_resources(VkImage presentation_image, VkImageView presentation_image_view) override;
-	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView presentation_image_view, uint32_t frame_index) override;
+	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView presentation_image_view, uint32_t frame_index, uint32_t image_index) override;
 	virtual constexpr ERendererType get_renderer_type() const override { return ERendererType::GUI; }
 	virtual VkImageView get_output_image_view(uint32_t) override { return nullptr; };
 
@@ -61,7 +68,8 @@ public:
 	~RaytracingRenderer();
 
 	virtual void allocate_per_frame_resources(VkImage presentation_image, VkImageView presentation_image_view) override;
-	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView presentation_image_view, uint32_t frame_index) override;
+	virtual void free_per_frame_resources() override;
+	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView presentation_image_view, uint32_t frame_index, uint32_t image_index) override;
 	virtual constexpr ERendererType get_renderer_type() const override { return ERendererType::RAYTRACING; }
 	virtual VkImageView get_output_image_view(uint32_t) override { return nullptr; };
 
@@ -90,9 +98,13 @@ public:
 	~OffscreenGuiViewportRenderer();
 
 	virtual void allocate_per_frame_resources(VkImage, VkImageView) override;
-	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView, uint32_t frame_index) override;
+	// its extent is relative to the swap chain's
+	virtual void free_per_frame_resources() override;
+	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView, uint32_t frame_index, uint32_t image_index) override;
 	virtual constexpr ERendererType get_renderer_type() const override { return ERendererType::OFFSCREEN_GUI_VIEWPORT; }
-	virtual VkImageView get_output_image_view(uint32_t frame_idx) override { return color_attachments[frame_idx].image_view; };
+	virtual VkImageView get_output_image_view(uint32_t image_idx) override { return color_attachments[image_idx].image_view; };
+	virtual RenderGraph::ImageInfo get_output_image(uint32_t image_idx) override { return { color_attachments[image_idx].image }; }
+	virtual std::vector<TransientAttachmentInfo> get_transient_attachments() override;
 	virtual VkExtent2D get_extent() override;
 
 private:
@@ -101,7 +113,6 @@ private:
 	void create_render_pass();
 
 	std::vector<RenderingAttachment> color_attachments;
-	std::vector<RenderingAttachment> depth_attachments;
 
 	using Renderer::get_graphics_engine;
 	using Renderer::get_rsrc_mgr;
@@ -115,12 +126,26 @@ public:
 	~ShadowMapRenderer();
 
 	virtual void allocate_per_frame_resources(VkImage, VkImageView) override;
-	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView, uint32_t frame_index) override;
+	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView, uint32_t frame_index, uint32_t image_index) override;
 	virtual constexpr ERendererType get_renderer_type() const override { return ERendererType::OFFSCREEN_GUI_VIEWPORT; }
-	virtual VkImageView get_output_image_view(uint32_t frame_idx) override { return shadow_map_attachments[frame_idx].image_view; };
+	// the closest cascade, every cascade is a layer of its own
+	virtual VkImageView get_output_image_view(uint32_t image_idx) override 
+	{ 
+		return cascade_image_views[image_idx * SDS::SHADOW_MAP_NUM_CASCADES]; 
+	};
+	virtual RenderGraph::ImageInfo get_output_image(uint32_t image_idx) override 
+	{ 
+		return { shadow_map_attachments[image_idx].image, VK_IMAGE_ASPECT_DEPTH_BIT, SDS::SHADOW_MAP_NUM_CASCADES }; 
+	}
 	virtual VkExtent2D get_extent() override { return { 1024, 1024 }; }
+	virtual bool depends_on_swap_chain() const override { return false; }
 
-	VkDescriptorSet get_shadow_map_dset(uint32_t frame_idx) { return shadow_map_dsets[frame_idx]; }
+	// all cascades as a 2d array, the layers are indexed by the cascade
+	VkImageView get_cascades_image_view(uint32_t image_idx) { return shadow_map_attachments[image_idx].image_view; }
+	VkDescriptorSet get_shadow_map_dset(uint32_t image_idx) { return shadow_map_dsets[image_idx]; }
+	// fits the cascades to the camera frustum, called before the frame is recorded
+	void update_cascades();
+	const std::vector<ShadowCascades::Cascade>& get_cascades() const { return cascades; }
 
 private:
 	static constexpr VkFormat get_image_format() { return VK_FORMAT_D32_SFLOAT; }
@@ -128,10 +153,18 @@ private:
 	void create_render_pass();
 	void create_sampler();
 	void create_shadow_map_dset(VkImageView shadow_map_view);
+	// culls the shadow casters against the cascade every frame, the cached commands are keyed on the result
+	size_t gather_objects(uint32_t cascade);
+	void record_draw_commands(VkCommandBuffer command_buffer, const RecordingRange& range, uint32_t frame_index, uint32_t cascade);
 
+	// per image, a layered image with the array view of all cascades
 	std::vector<RenderingAttachment> shadow_map_attachments;
+	// per image and cascade, the view of a single layer that is rendered into
+	std::vector<VkImageView> cascade_image_views;
 	std::vector<VkDescriptorSet> shadow_map_dsets;
 	VkSampler shadow_map_sampler;
+	std::vector<ShadowCascades::Cascade> cascades;
+	std::vector<const GraphicsEngineObject*> objects_to_record;
 
 	using Renderer::get_graphics_engine;
 	using Renderer::get_rsrc_mgr;
@@ -145,34 +178,70 @@ public:
 	~QuadRenderer();
 
 	virtual void allocate_per_frame_resources(VkImage, VkImageView) override;
-	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView, uint32_t frame_index) override;
+	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView, uint32_t frame_index, uint32_t image_index) override;
 	virtual constexpr ERendererType get_renderer_type() const override { return ERendererType::QUAD; }
-	virtual VkImageView get_output_image_view(uint32_t frame_idx) override { return color_attachments[frame_idx].image_view; };
+	virtual VkImageView get_output_image_view(uint32_t image_idx) override { return color_attachments[image_idx].image_view; };
+	virtual RenderGraph::ImageInfo get_output_image(uint32_t image_idx) override { return { color_attachments[image_idx].image }; }
 	virtual VkExtent2D get_extent() override { return { 512, 512 }; }
+	virtual bool depends_on_swap_chain() const override { return false; }
 
 	void set_texture(VkImageView texture_view, VkSampler texture_sampler);
 	void set_texture_sampling_flags(int flags) { sampling_flags = flags; }
+	// the quad isn't drawn without a texture
+	bool has_texture() const { return should_render; }
 
 private:
 	static constexpr VkFormat get_image_format() { return VK_FORMAT_B8G8R8A8_SRGB; }
 	virtual VkSampleCountFlagBits get_msaa_sample_count() const override { return VK_SAMPLE_COUNT_1_BIT; }
 	void create_render_pass();
 
-	VkDescriptorSet texture;
+	// one per frame in flight, a frame only updates its own dset so it's never updated while being used
+	std::vector<VkDescriptorSet> textures;
 	struct TextureToRender
 	{
 		VkImageView texture_view;
 		VkSampler texture_sampler;
-		int num_frames_to_render = CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES; // avoids the issue of updating a dset while it's being used
 	};
 
 	std::optional<TextureToRender> texture_to_render;
+	// frames whose dset doesn't point to the texture to render yet
+	std::vector<bool> stale_textures;
 	bool should_render = false;
 
 	int sampling_flags = 0;
 
 	std::vector<RenderingAttachment> color_attachments;
 
+	using Renderer::get_graphics_engine;
+	using Renderer::get_rsrc_mgr;
+	using Renderer::get_logical_device;
+};
+
+// draws the outlines of the stenciled objects over the presentation image, the rasterization renderer marks
+// them in its stencil so they're outlined by a single full-screen edge detect however many there are
+class OutlineRenderer : public Renderer
+{
+public:
+	OutlineRenderer(GraphicsEngine& engine);
+	~OutlineRenderer();
+
+	virtual void allocate_per_frame_resources(VkImage presentation_image, VkImageView presentation_image_view) override;
+	virtual void free_per_frame_resources() override;
+	virtual void submit_draw_commands(VkCommandBuffer command_buffer, VkImageView presentation_image_view, uint32_t frame_index, uint32_t image_index) override;
+	virtual constexpr ERendererType get_renderer_type() const override { return ERendererType::OUTLINE; }
+	virtual VkImageView get_output_image_view(uint32_t) override { return nullptr; };
+
+	static VkDescriptorSetLayoutBinding get_stencil_binding();
+
+private:
+	static constexpr VkFormat get_image_format() { return VK_FORMAT_B8G8R8A8_SRGB; }
+	virtual VkSampleCountFlagBits get_msaa_sample_count() const override { return VK_SAMPLE_COUNT_1_BIT; }
+	void create_render_pass();
+
+	// per image, the stencil aspect of the rasterization depth attachment
+	std::vector<VkImageView> stencil_image_views;
+	std::vector<VkDescriptorSet> stencil_dsets;
+
 	using Renderer::get_graphics_engine;
 	using Renderer::get_rsrc_mgr;
 	using Renderer::get_logical_device;
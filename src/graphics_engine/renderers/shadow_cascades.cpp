@@ -0,0 +1,121 @@
+#include "shadow_cascades.hpp"
+#include "maths.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+
+std::vector<float> ShadowCascades::compute_split_depths(float near_depth, float far_depth, uint32_t num_cascades)
+{
+	if (num_cascades == 0 || near_depth <= 0.0f || far_depth <= near_depth)
+	{
+		throw std::runtime_error("ShadowCascades::compute_split_depths: invalid depth range or number of cascades");
+	}
+
+	std::vector<float> split_depths(num_cascades);
+	for (uint32_t i = 0; i < num_cascades; i++)
+	{
+		const float p = float(i + 1) / float(num_cascades);
+		const float log_split = near_depth * std::pow(far_depth / near_depth, p);
+		const float uniform_split = near_depth + (far_depth - near_depth) * p;
+		split_depths[i] = SPLIT_LAMBDA * log_split + (1.0f - SPLIT_LAMBDA) * uniform_split;
+	}
+	split_depths.back() = far_depth;
+
+	return split_depths;
+}
+
+std::vector<ShadowCascades::Cascade> ShadowCascades::compute(
+	const glm::mat4& view, 
+	const glm::mat4& proj, 
+	const glm::vec3& light_dir, 
+	uint32_t num_cascades, 
+	uint32_t resolution)
+{
+	if (resolution == 0)
+	{
+		throw std::runtime_error("ShadowCascades::compute: resolution must not be 0");
+	}
+
+	// frustum corners in world space, the near plane ones first, vulkan's depth range is [0, 1]
+	const glm::mat4 inv_view_proj = glm::inverse(proj * view);
+	std::array<glm::vec3, 8> corners;
+	for (uint32_t i = 0; i < corners.size(); i++)
+	{
+		const glm::vec4 corner = inv_view_proj * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : 0.0f, 1.0f);
+		corners[i] = glm::vec3(corner) / corner.w;
+	}
+
+	// the camera is left handed, the view space depth in front of it is positive
+	const float near_depth = (view * glm::vec4(corners[0], 1.0f)).z;
+	const float far_depth = (view * glm::vec4(corners[4], 1.0f)).z;
+	const std::vector<float> split_depths = compute_split_depths(near_depth, far_depth, num_cascades);
+
+	const glm::vec3 light_up = std::abs(glm::dot(light_dir, Maths::up_vec)) > 0.99f ? Maths::forward_vec : Maths::up_vec;
+	const glm::mat4 light_rotation = glm::lookAtLH(glm::vec3(0.0f), light_dir, light_up);
+	const glm::mat4 inv_light_rotation = glm::inverse(light_rotation);
+
+	std::vector<Cascade> cascades(num_cascades);
+	float begin_depth = near_depth;
+	for (uint32_t c = 0; c < num_cascades; c++)
+	{
+		const float begin = (begin_depth - near_depth) / (far_depth - near_depth);
+		const float end = (split_depths[c] - near_depth) / (far_depth - near_depth);
+		std::array<glm::vec3, 8> slice_corners;
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			slice_corners[i] = glm::mix(corners[i], corners[i + 4], begin);
+			slice_corners[i + 4] = glm::mix(corners[i], corners[i + 4], end);
+		}
+
+		glm::vec3 center(0.0f);
+		for (const glm::vec3& corner : slice_corners)
+		{
+			center += corner / float(slice_corners.size());
+		}
+		float radius = 0.0f;
+		for (const glm::vec3& corner : slice_corners)
+		{
+			radius = std::max(radius, glm::length(corner - center));
+		}
+		// rounded up, so float noise does not change the texel size from frame to frame
+		radius = std::ceil(radius * 16.0f) / 16.0f;
+
+		// snapping the center to whole texels in light space moves the cascade in whole texels
+		const float texel_size = 2.0f * radius / float(resolution);
+		glm::vec3 light_space_center = glm::vec3(light_rotation * glm::vec4(center, 1.0f));
+		light_space_center = glm::floor(light_space_center / texel_size) * texel_size;
+		center = glm::vec3(inv_light_rotation * glm::vec4(light_space_center, 1.0f));
+
+		const glm::vec3 eye = center - light_dir * (radius + CASTER_DEPTH_MARGIN);
+		const glm::mat4 light_view = glm::lookAtLH(eye, center, light_up);
+		const glm::mat4 light_proj = glm::orthoLH(-radius, radius, -radius, radius, 0.0f, 2.0f * radius + CASTER_DEPTH_MARGIN);
+
+		cascades[c].view_proj = light_proj * light_view;
+		cascades[c].split_depth = split_depths[c];
+		begin_depth = split_depths[c];
+	}
+
+	return cascades;
+}
+
+bool ShadowCascades::intersects(const glm::mat4& view_proj, const glm::vec3& center, float radius)
+{
+	const glm::vec4 clip = view_proj * glm::vec4(center, 1.0f);
+	// an orthographic projection only rotates, scales and moves, row i scales the distances along clip axis i
+	std::array<float, 3> clip_radius;
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		clip_radius[axis] = radius * glm::length(glm::vec3(view_proj[0][axis], view_proj[1][axis], view_proj[2][axis]));
+	}
+
+	return std::abs(clip.x) <= 1.0f + clip_radius[0]
+		&& std::abs(clip.y) <= 1.0f + clip_radius[1]
+		&& clip.z >= -clip_radius[2] 
+		&& clip.z <= 1.0f + clip_radius[2];
+}
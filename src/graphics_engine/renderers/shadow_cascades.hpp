@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+// Splits the camera frustum along the view depth into cascades, each one is covered by an orthographic
+// shadow map of its own, so the shadows close to the camera get most of the texels
+namespace ShadowCascades
+{
+	// blend between logarithmic splits, which keep the texel density even, and uniform splits,
+	// which don't spend the first cascade on the first few units in front of the camera
+	constexpr float SPLIT_LAMBDA = 0.75f;
+	// casters this far behind a cascade towards the light still cast into it
+	constexpr float CASTER_DEPTH_MARGIN = 50.0f;
+
+	struct Cascade
+	{
+		glm::mat4 view_proj;
+		// view space depth at which the cascade ends
+		float split_depth;
+	};
+
+	// view space depths at which the cascades end, the last one is the far plane
+	std::vector<float> compute_split_depths(float near_depth, float far_depth, uint32_t num_cascades);
+
+	// every cascade is fitted with a bounding sphere, so its size does not change when the camera rotates,
+	// and it is moved in whole texels of a resolution sized map, so the shadow edges don't shimmer when the camera moves
+	std::vector<Cascade> compute(
+		const glm::mat4& view, 
+		const glm::mat4& proj, 
+		const glm::vec3& light_dir, 
+		uint32_t num_cascades, 
+		uint32_t resolution);
+
+	// whether a bounding sphere overlaps the box covered by an orthographic cascade
+	bool intersects(const glm::mat4& view_proj, const glm::vec3& center, float radius);
+}
@@ -1,6 +1,15 @@
 #include "renderers.hpp"
+#include "shadow_cascades.hpp"
 #include "entity_component_system/ecs.hpp"
 #include "shared_data_structures.hpp"
+#include "graphics_engine/graphics_engine.hpp"
+#include "objects/object.hpp"
+#include "renderable/mesh.hpp"
+#include "camera.hpp"
+#include "maths.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
 
 
 ShadowMapRenderer::ShadowMapRenderer(GraphicsEngine& engine) :
@@ -13,6 +22,10 @@ ShadowMapRenderer::ShadowMapRenderer(GraphicsEngine& engine) :
 ShadowMapRenderer::~ShadowMapRenderer()
 {
 	vkDestroySampler(get_logical_device(), shadow_map_sampler, nullptr);
+	for (VkImageView cascade_image_view : cascade_image_views)
+	{
+		vkDestroyImageView(get_logical_device(), cascade_image_view, nullptr);
+	}
 	for (auto& attachment : shadow_map_attachments)
 	{
 		attachment.destroy(get_logical_device());
@@ -37,41 +50,76 @@ void ShadowMapRenderer::allocate_per_frame_resources(VkImage, VkImageView)
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 		shadow_map_attachment.image,
 		shadow_map_attachment.image_memory,
-		get_msaa_sample_count());
+		get_msaa_sample_count(),
+		SDS::SHADOW_MAP_NUM_CASCADES);
 	shadow_map_attachment.image_view = get_graphics_engine().create_image_view(
 		shadow_map_attachment.image, 
 		depth_format, 
-		VK_IMAGE_ASPECT_DEPTH_BIT);
+		VK_IMAGE_ASPECT_DEPTH_BIT,
+		VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+		SDS::SHADOW_MAP_NUM_CASCADES);
 
 	create_shadow_map_dset(shadow_map_attachment.image_view);
 	shadow_map_attachments.push_back(shadow_map_attachment);
 
 	//
-	// Create framebuffer
+	// Create framebuffers, one per cascade that renders into its layer
 	//
-	std::vector<VkImageView> attachments { 
-		shadow_map_attachment.image_view,
-	};
+	for (uint32_t cascade = 0; cascade < SDS::SHADOW_MAP_NUM_CASCADES; ++cascade)
+	{
+		const VkImageView cascade_image_view = cascade_image_views.emplace_back(get_graphics_engine().create_image_view(
+			shadow_map_attachment.image, 
+			depth_format, 
+			VK_IMAGE_ASPECT_DEPTH_BIT,
+			VK_IMAGE_VIEW_TYPE_2D,
+			1,
+			cascade));
 
-	VkFramebufferCreateInfo frame_buffer_create_info{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
-	frame_buffer_create_info.renderPass = this->render_pass;
-	frame_buffer_create_info.attachmentCount = attachments.size();
-	frame_buffer_create_info.pAttachments = attachments.data();
-	frame_buffer_create_info.width = extent.width;
-	frame_buffer_create_info.height = extent.height;
-	frame_buffer_create_info.layers = 1;
+		std::vector<VkImageView> attachments { 
+			cascade_image_view,
+		};
 
-	VkFramebuffer new_frame_buffer;
-	if (vkCreateFramebuffer(get_logical_device(), &frame_buffer_create_info, nullptr, &new_frame_buffer) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to create framebuffer!");
+		VkFramebufferCreateInfo frame_buffer_create_info{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+		frame_buffer_create_info.renderPass = this->render_pass;
+		frame_buffer_create_info.attachmentCount = attachments.size();
+		frame_buffer_create_info.pAttachments = attachments.data();
+		frame_buffer_create_info.width = extent.width;
+		frame_buffer_create_info.height = extent.height;
+		frame_buffer_create_info.layers = 1;
+
+		VkFramebuffer new_frame_buffer;
+		if (vkCreateFramebuffer(get_logical_device(), &frame_buffer_create_info, nullptr, &new_frame_buffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create framebuffer!");
+		}
+		this->frame_buffers.push_back(new_frame_buffer);
 	}
-	this->frame_buffers.push_back(new_frame_buffer);
+}
+
+void ShadowMapRenderer::update_cascades()
+{
+	PROFILE_SCOPE("ShadowMapRenderer::update_cascades");
+
+	// the light is treated as a sun that shines from its position towards the origin,
+	// straight down when it's right above it
+	const ObjectID light_entity = get_graphics_engine().get_ecs().get_global_light_source();
+	const glm::vec3 light_pos = get_graphics_engine().get_object(light_entity).get_game_object().get_position();
+	const glm::vec3 light_dir = glm::length(light_pos) > Maths::ACCEPTABLE_FLOATING_PT_DIFF ? 
+		-glm::normalize(light_pos) : -Maths::up_vec;
+
+	const Camera& camera = *get_graphics_engine().get_camera();
+	cascades = ShadowCascades::compute(
+		camera.get_view(), 
+		camera.get_projection(), 
+		light_dir, 
+		SDS::SHADOW_MAP_NUM_CASCADES, 
+		get_extent().width);
 }
 
 void ShadowMapRenderer::submit_draw_commands(VkCommandBuffer command_buffer,
                                                                      VkImageView,
-                                                                     uint32_t frame_index)
+                                                                     uint32_t frame_index,
+                                                                     uint32_t image_index)
 {
 	if (get_graphics_engine().is_wireframe_mode)
 	{
@@ -82,15 +130,80 @@ void ShadowMapRenderer::submit_draw_commands(VkCommandBuffer command_buffer,
 	VkRenderPassBeginInfo render_pass_begin_info{};
 	render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	render_pass_begin_info.renderPass = this->render_pass;
-	render_pass_begin_info.framebuffer = this->frame_buffers[frame_index];
 	render_pass_begin_info.renderArea.offset = { 0, 0 };
 	render_pass_begin_info.renderArea.extent = this->get_extent();
 	
 	VkClearValue clear_value = { 1.0f, 0 };
 	render_pass_begin_info.clearValueCount = 1;
 	render_pass_begin_info.pClearValues = &clear_value;
-	vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
 
+	for (uint32_t cascade = 0; cascade < SDS::SHADOW_MAP_NUM_CASCADES; ++cascade)
+	{
+		render_pass_begin_info.framebuffer = this->frame_buffers[image_index * SDS::SHADOW_MAP_NUM_CASCADES + cascade];
+		vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+		// nothing recorded depends on the image, only the framebuffer which is inherited from the render pass.
+		// The casters are culled by where they are now and moving doesn't change the scene version, so they're
+		// gathered every frame and the commands are recorded again whenever a caster enters or leaves the cascade.
+		// The cascade matrix itself is read by the shaders, it isn't part of the commands
+		const size_t num_casters = gather_objects(cascade);
+		size_t membership_hash = 0;
+		for (const GraphicsEngineObject* graphics_object : objects_to_record)
+		{
+			membership_hash ^= std::hash<ObjectID>()(graphics_object->get_id()) + 0x9e3779b9 + (membership_hash << 6) + (membership_hash >> 2);
+		}
+		execute_cached_commands(
+			command_buffer,
+			frame_index * SDS::SHADOW_MAP_NUM_CASCADES + cascade,
+			[num_casters]() { return num_casters; },
+			[&](VkCommandBuffer cached_command_buffer, const RecordingRange& range) {
+				record_draw_commands(cached_command_buffer, range, frame_index, cascade);
+			},
+			membership_hash);
+
+		vkCmdEndRenderPass(command_buffer);
+	}
+}
+
+size_t ShadowMapRenderer::gather_objects(uint32_t cascade)
+{
+	objects_to_record.clear();
+	const glm::mat4& cascade_view_proj = cascades[cascade].view_proj;
+
+	const auto& graphics_objects = get_graphics_engine().get_objects();
+	for (const auto& it_pair : graphics_objects)
+	{
+		const auto& graphics_object = *(it_pair.second);
+		if (graphics_object.is_marked_for_delete())
+			continue;
+
+		if (!graphics_object.get_visibility())
+			continue;
+
+		if (get_graphics_engine().get_ecs().get_light_component(graphics_object.get_id()) != nullptr)
+			continue;
+
+		// bounding sphere around the origin of the object, see Mesh::get_bounding_radius
+		const Object& object = graphics_object.get_game_object();
+		const glm::vec3 scale = glm::abs(object.get_scale());
+		float bounding_radius = 0.0f;
+		for (const Renderable& renderable : graphics_object.get_renderables())
+		{
+			bounding_radius = std::max(bounding_radius, MeshSystem::get(renderable.mesh_id).get_bounding_radius());
+		}
+		bounding_radius *= std::max({ scale.x, scale.y, scale.z });
+		if (!ShadowCascades::intersects(cascade_view_proj, object.get_position(), bounding_radius))
+			continue;
+
+		objects_to_record.push_back(&graphics_object);
+	}
+
+	return objects_to_record.size();
+}
+
+void ShadowMapRenderer::record_draw_commands(VkCommandBuffer command_buffer, const RecordingRange& range, uint32_t frame_index, uint32_t cascade)
+{
+	// secondary command buffers don't inherit any state, every range binds the per frame dsets
 	std::vector<VkDescriptorSet> per_frame_dsets = { 
 		get_rsrc_mgr().get_global_dset(frame_index)
 	};
@@ -105,20 +218,9 @@ void ShadowMapRenderer::submit_draw_commands(VkCommandBuffer command_buffer,
 							0,
 							nullptr);
 
-
-	const auto& graphics_objects = get_graphics_engine().get_objects();
-	for (const auto& it_pair : graphics_objects)
+	for (size_t object_idx = range.begin; object_idx < range.end; ++object_idx)
 	{
-		const auto& graphics_object = *(it_pair.second);
-		if (graphics_object.is_marked_for_delete())
-			continue;
-
-		if (!graphics_object.get_visibility())
-			continue;
-
-		if (get_graphics_engine().get_ecs().get_light_component(graphics_object.get_id()) != nullptr)
-			continue;
-			
+		const auto& graphics_object = *objects_to_record[object_idx];
 		for (uint32_t renderable_idx=0; renderable_idx<graphics_object.get_renderables().size(); ++renderable_idx)
 		{
 			const Renderable& renderable = graphics_object.get_renderables()[renderable_idx];
@@ -130,11 +232,12 @@ void ShadowMapRenderer::submit_draw_commands(VkCommandBuffer command_buffer,
 							renderable,
 							graphics_object.get_obj_dset(frame_index),
 							graphics_object.get_renderable_dsets()[renderable_idx],
-							EPipelineModifier::SHADOW_MAP);
+							EPipelineModifier::SHADOW_MAP,
+							ERenderType::UNASSIGNED,
+							graphics_object.get_renderable_lod(renderable_idx),
+							cascade); // the shaders pick the cascade matrix by gl_InstanceIndex
 		}
 	}
-	
-	vkCmdEndRenderPass(command_buffer);
 }
 
 void ShadowMapRenderer::create_render_pass()
@@ -42,10 +42,10 @@ public: // accessors for specific descriptors/layouts
 
 private:
 	void setup_descriptor_set_layouts();
-	void allocate_global_dset(VkBuffer global_buffer, const std::vector<uint32_t>& global_buffer_offsets);
+	void allocate_global_dset(const GraphicsBufferManager& buffer_manager);
 	void allocate_mesh_data_dset(VkBuffer mapping_buffer, VkBuffer vertex_buffer, VkBuffer index_buffer);
 
-	static constexpr int MAX_LOW_FREQ_DESCRIPTOR_SETS = CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES; // for GUBO i.e. camera & lighting
+	static constexpr int MAX_LOW_FREQ_DESCRIPTOR_SETS = CSTS::MAX_FRAMES_IN_FLIGHT; // for GUBO i.e. camera & lighting
 	static constexpr int MAX_HIGH_FREQ_DESCRIPTOR_SETS = 1000; // for objects i.e. model + texture
 	static constexpr int MAX_RAY_TRACING_DESCRIPTOR_SETS = 1000; // for ray tracing
 	static constexpr int MAX_MESH_DATA_DESCRIPTOR_SETS = 1;
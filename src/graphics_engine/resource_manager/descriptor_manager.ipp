@@ -1,6 +1,8 @@
 #include "descriptor_manager.hpp"
 #include "graphics_buffer_manager.hpp"
 
+#include <array>
+
 
 static constexpr VkDescriptorSetLayoutBinding get_generic_global_binding()
 {
@@ -17,6 +19,19 @@ static constexpr VkDescriptorSetLayoutBinding get_generic_global_binding()
 	return gubo_layout_binding;
 }
 
+static constexpr VkDescriptorSetLayoutBinding get_generic_light_binding(uint32_t binding)
+{
+	// point lights and their clusters, see LightClusters
+	VkDescriptorSetLayoutBinding light_layout_binding{};
+	light_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	light_layout_binding.binding = binding;
+	light_layout_binding.descriptorCount = 1;
+	light_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	light_layout_binding.pImmutableSamplers = nullptr;
+
+	return light_layout_binding;
+}
+
 static constexpr VkDescriptorSetLayoutBinding get_generic_obj_ubo_binding()
 {
 	VkDescriptorSetLayoutBinding ubo_layout_binding{};
@@ -145,15 +160,7 @@ GraphicsDescriptorManager::GraphicsDescriptorManager(
 {
 	create_descriptor_pool();
 	setup_descriptor_set_layouts();
-	const auto get_gubo_offsets = [&buffer_manager] {
-		std::vector<uint32_t> offsets;
-		for (uint32_t frame_idx = 0; frame_idx < GraphicsEngine::get_num_swapchain_images(); ++frame_idx)
-		{
-			offsets.push_back(buffer_manager.get_global_uniform_buffer_offset(frame_idx));
-		}
-		return offsets;
-	};
-	allocate_global_dset(buffer_manager.get_global_uniform_buffer(), get_gubo_offsets());
+	allocate_global_dset(buffer_manager);
 	allocate_mesh_data_dset(
 		buffer_manager.get_mapping_buffer(), 
 		buffer_manager.get_vertex_buffer(),
@@ -219,14 +226,18 @@ void GraphicsDescriptorManager::free_dsets(std::vector<VkDescriptorSet>& dsets)
 		return;
 	}
 
-	if (vkFreeDescriptorSets(
-		get_graphics_engine().get_logical_device(), 
-		descriptor_pool, 
-		dsets.size(), 
-		dsets.data()) != VK_SUCCESS)
+	// the frames in flight may still bind them
+	get_graphics_engine().get_deletion_queue().push([this, dsets]
 	{
-		throw std::runtime_error("GraphicsDescriptorManager: failed to free descriptor sets!");
-	}
+		if (vkFreeDescriptorSets(
+			get_graphics_engine().get_logical_device(), 
+			descriptor_pool, 
+			dsets.size(), 
+			dsets.data()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("GraphicsDescriptorManager: failed to free descriptor sets!");
+		}
+	});
 }
 
 void GraphicsDescriptorManager::create_descriptor_pool()
@@ -306,7 +317,11 @@ std::vector<VkDescriptorSetLayout> GraphicsDescriptorManager::
 
 void GraphicsDescriptorManager::setup_descriptor_set_layouts()
 {
-	low_freq_dset_layout = request_dset_layout({ get_generic_global_binding() });
+	low_freq_dset_layout = request_dset_layout({ 
+		get_generic_global_binding(),
+		get_generic_light_binding(SDS::RASTERIZATION_POINT_LIGHTS_DATA_BINDING),
+		get_generic_light_binding(SDS::RASTERIZATION_LIGHT_CLUSTERS_DATA_BINDING),
+		get_generic_light_binding(SDS::RASTERIZATION_LIGHT_INDICES_DATA_BINDING) });
 	per_obj_dset_layout = request_dset_layout({ get_generic_obj_ubo_binding(), get_generic_bone_binding() });
 	renderable_dset_layout = request_dset_layout({ 
 		get_generic_material_binding(), 
@@ -321,10 +336,8 @@ void GraphicsDescriptorManager::setup_descriptor_set_layouts()
 		get_generic_raytracing_output_image_binding() });
 }
 
-void GraphicsDescriptorManager::allocate_global_dset(VkBuffer global_buffer, const std::vector<uint32_t>& global_buffer_offsets)
+void GraphicsDescriptorManager::allocate_global_dset(const GraphicsBufferManager& buffer_manager)
 {
-	assert(global_buffer_offsets.size() == MAX_LOW_FREQ_DESCRIPTOR_SETS);
-
 	std::vector<VkDescriptorSetLayout> dset_layouts(MAX_LOW_FREQ_DESCRIPTOR_SETS, low_freq_dset_layout);
 	VkDescriptorSetAllocateInfo alloc_info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
 	alloc_info.descriptorPool = descriptor_pool;
@@ -340,27 +353,54 @@ void GraphicsDescriptorManager::allocate_global_dset(VkBuffer global_buffer, con
 		throw std::runtime_error("GraphicsResourceManager: failed to allocate low freq descriptor sets!");
 	}
 
-	for (int i = 0; i < global_dsets.size(); ++i)
+	// one set per frame in flight, each points at the slots of its frame
+	for (uint32_t frame_idx = 0; frame_idx < global_dsets.size(); ++frame_idx)
 	{
-		VkDescriptorBufferInfo buffer_info{};
-		buffer_info.buffer = global_buffer;
-		buffer_info.offset = global_buffer_offsets[i];
-		buffer_info.range = sizeof(SDS::GlobalData);
-
-		VkWriteDescriptorSet dset_write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-		dset_write.dstSet = global_dsets[i];
-		dset_write.dstBinding = SDS::GLOBAL_DATA_BINDING;
-		dset_write.dstArrayElement = 0;
-		dset_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		dset_write.descriptorCount = 1;
-		dset_write.pBufferInfo = &buffer_info;
-		dset_write.pImageInfo = nullptr;
-		dset_write.pTexelBufferView = nullptr;
+		const std::array<VkDescriptorBufferInfo, 4> buffer_infos {{
+			{
+				buffer_manager.get_global_uniform_buffer(), 
+				buffer_manager.get_global_uniform_buffer_offset(frame_idx), 
+				sizeof(SDS::GlobalData)
+			},
+			{
+				buffer_manager.get_point_lights_buffer(), 
+				buffer_manager.get_point_lights_buffer_offset(frame_idx), 
+				GraphicsBufferManager::POINT_LIGHTS_SLOT_SIZE
+			},
+			{
+				buffer_manager.get_light_clusters_buffer(), 
+				buffer_manager.get_light_clusters_buffer_offset(frame_idx), 
+				GraphicsBufferManager::LIGHT_CLUSTERS_SLOT_SIZE
+			},
+			{
+				buffer_manager.get_light_indices_buffer(), 
+				buffer_manager.get_light_indices_buffer_offset(frame_idx), 
+				GraphicsBufferManager::LIGHT_INDICES_SLOT_SIZE
+			}
+		}};
+		const std::array<uint32_t, 4> bindings {
+			SDS::GLOBAL_DATA_BINDING,
+			SDS::RASTERIZATION_POINT_LIGHTS_DATA_BINDING,
+			SDS::RASTERIZATION_LIGHT_CLUSTERS_DATA_BINDING,
+			SDS::RASTERIZATION_LIGHT_INDICES_DATA_BINDING
+		};
+
+		std::array<VkWriteDescriptorSet, 4> dset_writes{};
+		for (size_t i = 0; i < dset_writes.size(); ++i)
+		{
+			dset_writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			dset_writes[i].dstSet = global_dsets[frame_idx];
+			dset_writes[i].dstBinding = bindings[i];
+			dset_writes[i].dstArrayElement = 0;
+			dset_writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			dset_writes[i].descriptorCount = 1;
+			dset_writes[i].pBufferInfo = &buffer_infos[i];
+		}
 
 		vkUpdateDescriptorSets(
 			get_logical_device(), 
-			1, 
-			&dset_write, 
+			dset_writes.size(), 
+			dset_writes.data(), 
 			0, 
 			nullptr);
 	}
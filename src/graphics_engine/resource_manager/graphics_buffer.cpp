@@ -49,16 +49,26 @@ void GraphicsBuffer::destroy(VkDevice device)
 }
 
 void GraphicsBuffer::free_slot(uint32_t slot_id)
+{
+	release_slot(retire_slot(slot_id));
+}
+
+GraphicsBuffer::Slot GraphicsBuffer::retire_slot(uint32_t slot_id)
 {
 	auto it = filled_slots.find(slot_id);
 	if (it == filled_slots.end())
 	{
-		throw std::runtime_error("GraphicsBuffer::free_slot: Slot not found!");
+		throw std::runtime_error("GraphicsBuffer::retire_slot: Slot not found!");
 	}
 
-	Slot slot = it->second;
-	slot.size = slot.capacity;
+	const Slot slot = it->second;
 	filled_slots.erase(it);
+	return slot;
+}
+
+void GraphicsBuffer::release_slot(Slot slot)
+{
+	slot.size = slot.capacity;
 	filled_capacity -= slot.capacity;
 
 	//
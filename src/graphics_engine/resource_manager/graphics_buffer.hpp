@@ -27,6 +27,10 @@ public:
 	};
 
 	void free_slot(uint32_t slot_id);
+	// frees the id straight away so it can be reserved again, the memory stays taken until the slot is released,
+	// i.e. once the GPU has stopped reading it
+	Slot retire_slot(uint32_t slot_id);
+	void release_slot(Slot slot);
 	offset_t reserve_slot(uint32_t id, uint32_t size);
 	std::byte* map_slot(uint32_t id, VkDevice device);
 	void unmap_slot(VkDevice device);
@@ -7,6 +7,9 @@
 #include "identifications.hpp"
 #include "graphics_engine/graphics_engine_object.hpp"
 
+#include <unordered_set>
+#include <vector>
+
 
 class Mesh;
 
@@ -32,6 +35,9 @@ public:
 	size_t get_buffer_offset(MaterialID id) const { return materials_buffer.get_offset(id.get_underlying()); }
 	size_t get_buffer_offset(SkeletonFrameID id) const { return bone_buffer.get_offset(id.get_underlying()); }
 	size_t get_global_uniform_buffer_offset(uint32_t id) const { return global_uniform_buffer.get_offset(id); }
+	size_t get_point_lights_buffer_offset(uint32_t frame_idx) const { return point_lights_buffer.get_offset(frame_idx); }
+	size_t get_light_clusters_buffer_offset(uint32_t frame_idx) const { return light_clusters_buffer.get_offset(frame_idx); }
+	size_t get_light_indices_buffer_offset(uint32_t frame_idx) const { return light_indices_buffer.get_offset(frame_idx); }
 
 	VkBuffer get_vertex_buffer() const { return vertex_buffer.get_buffer(); }
 	VkBuffer get_index_buffer() const { return index_buffer.get_buffer(); }
@@ -40,6 +46,9 @@ public:
 	VkBuffer get_mapping_buffer() const { return mapping_buffer.get_buffer(); }
 	VkBuffer get_global_uniform_buffer() const { return global_uniform_buffer.get_buffer(); }
 	VkBuffer get_bone_buffer() const { return bone_buffer.get_buffer(); }
+	VkBuffer get_point_lights_buffer() const { return point_lights_buffer.get_buffer(); }
+	VkBuffer get_light_clusters_buffer() const { return light_clusters_buffer.get_buffer(); }
+	VkBuffer get_light_indices_buffer() const { return light_indices_buffer.get_buffer(); }
 
 	VkDeviceMemory get_global_uniform_buffer_memory() const { return global_uniform_buffer.get_memory(); }
 
@@ -49,6 +58,12 @@ public:
 	void write_to_buffer(SkeletonFrameID id, const std::vector<SDS::Bone>& bones);
 	void write_to_uniform_buffer(EntityFrameID id, const SDS::ObjectData& ubos);
 	void write_to_global_uniform_buffer(uint32_t id, const SDS::GlobalData& ubo);
+	// the point lights and their clusters, see LightClusters
+	void write_to_light_buffers(
+		uint32_t frame_idx, 
+		const std::vector<SDS::PointLight>& point_lights, 
+		const std::vector<SDS::LightCluster>& light_clusters,
+		const std::vector<uint32_t>& light_indices);
 	void write_to_mapping_buffer(ObjectID id, const SDS::BufferMapEntry& entry);
 
 	GraphicsBuffer::Slot get_vertex_buffer_slot(MeshID id) const { return vertex_buffer.get_slot(id.get_underlying()); }
@@ -71,11 +86,13 @@ public:
 		VkBuffer& buffer,
 		VkDeviceMemory& buffer_memory);
 
+	// the copy runs on the transfer queue, the graphics and compute submissions after it wait for it
 	void stage_data_to_buffer(
 		VkBuffer destination_buffer,
 		const uint32_t destination_buffer_offset,
 		const uint32_t size,
 		const std::function<void(std::byte*)>& write_function);
+	// the layout transitions around the copy are recorded by the caller, so images are still copied on the graphics queue
 	
 	void stage_data_to_image(
 		VkImage destination_image,
@@ -85,6 +102,10 @@ public:
 		const std::function<void(std::byte*)>& write_function,
 		const uint32_t layer_count = 1); // for cubemaps
 
+	// a dedicated transfer queue releases what it wrote to the graphics family,
+	// the next command buffer on the graphics family has to acquire it before anything reads it
+	void record_pending_acquires(VkCommandBuffer command_buffer);
+
 public:
 	static constexpr size_t NUM_EXPECTED_OBJECTS = 1e3;
 	static constexpr size_t NUM_EXPECTED_FRAMES = 3;
@@ -92,19 +113,41 @@ public:
 
 	// in bytes
 	// takes average size different vertex types
-	static constexpr size_t VERTEX_BUFFER_CAPACITY = (sizeof(SDS::ColorVertex) + sizeof(SDS::TexVertex)) * 1e5;
+	static constexpr size_t VERTEX_BUFFER_CAPACITY = (sizeof(SDS::PackedColorVertex) + sizeof(SDS::PackedTexVertex)) * 1e5;
 	static constexpr size_t INDEX_BUFFER_CAPACITY = sizeof(uint32_t) * 1e6;
 	static constexpr size_t UNIFORM_BUFFER_CAPACITY = sizeof(SDS::ObjectData) * NUM_EXPECTED_OBJECTS * NUM_EXPECTED_FRAMES;
 	static constexpr size_t MATERIALS_BUFFER_CAPACITY = sizeof(SDS::MaterialData) * NUM_EXPECTED_RENDERABLES;
-	static constexpr size_t GLOBAL_UNIFORM_BUFFER_CAPACITY = sizeof(SDS::GlobalData) * CSTS::NUM_EXPECTED_SWAPCHAIN_IMAGES * 100; // 100 is here to get around the min uniform buffer alignment requirement
+	static constexpr size_t GLOBAL_UNIFORM_BUFFER_CAPACITY = sizeof(SDS::GlobalData) * CSTS::MAX_FRAMES_IN_FLIGHT * 100; // 100 is here to get around the min uniform buffer alignment requirement
 	static constexpr size_t MAPPING_BUFFER_CAPACITY = sizeof(SDS::BufferMapEntry) * NUM_EXPECTED_OBJECTS * 10;
 	static constexpr size_t BONE_BUFFER_CAPACITY = sizeof(SDS::Bone) * 500 * NUM_EXPECTED_FRAMES;
+	// a slot per frame in flight, 256 is the largest min storage buffer offset alignment allowed
+	static constexpr size_t POINT_LIGHTS_SLOT_SIZE = sizeof(SDS::PointLight) * SDS::MAX_POINT_LIGHTS;
+	static constexpr size_t LIGHT_CLUSTERS_SLOT_SIZE = sizeof(SDS::LightCluster) * 
+		SDS::LIGHT_CLUSTER_GRID_X * SDS::LIGHT_CLUSTER_GRID_Y * SDS::LIGHT_CLUSTER_GRID_Z;
+	static constexpr size_t LIGHT_INDICES_SLOT_SIZE = sizeof(uint32_t) * SDS::MAX_LIGHT_CLUSTER_INDICES;
+	static constexpr size_t POINT_LIGHTS_BUFFER_CAPACITY = (POINT_LIGHTS_SLOT_SIZE + 256) * CSTS::MAX_FRAMES_IN_FLIGHT;
+	static constexpr size_t LIGHT_CLUSTERS_BUFFER_CAPACITY = (LIGHT_CLUSTERS_SLOT_SIZE + 256) * CSTS::MAX_FRAMES_IN_FLIGHT;
+	static constexpr size_t LIGHT_INDICES_BUFFER_CAPACITY = (LIGHT_INDICES_SLOT_SIZE + 256) * CSTS::MAX_FRAMES_IN_FLIGHT;
 	static constexpr size_t INITIAL_STAGING_BUFFER_CAPACITY = 1e4; // staging buffer capacity dynamically grows
+	// uploads in flight at once, further ones wait for the oldest to finish
+	static constexpr size_t MAX_STAGING_BUFFERS = 8;
 
 private:
 	void reserve_buffer(GraphicsBuffer& buffer, uint64_t id, size_t size);
 	void free_buffer(GraphicsBuffer& buffer, uint64_t id);
 	void update_buffer_stats();
+	struct StagingBuffer
+	{
+		GraphicsBuffer buffer;
+		// the transfer queue submission reading it, 0 once nothing is
+		uint64_t transfer_value = 0;
+	};
+
+	// a staging buffer the transfer queue is done with, of at least the given size
+	StagingBuffer& get_staging_buffer(size_t size);
+	// buffers the acceleration structure builds use are shared between the graphics and compute families
+	// rather than changing owners around every build, empty for the others which stay exclusive
+	std::vector<uint32_t> get_concurrent_families(VkBufferUsageFlags usage_flags);
 
 	static constexpr VkBufferUsageFlags VERTEX_BUFFER_USAGE_FLAGS = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | 
 		VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
@@ -117,6 +160,7 @@ private:
 		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 	static constexpr VkBufferUsageFlags GLOBAL_UNIFORM_BUFFER_USAGE_FLAGS = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 	static constexpr VkBufferUsageFlags BONE_BUFFER_USAGE_FLAGS = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	static constexpr VkBufferUsageFlags LIGHT_BUFFER_USAGE_FLAGS = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 	static constexpr VkBufferUsageFlags MAPPING_BUFFER_USAGE_FLAGS = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 	static constexpr VkBufferUsageFlags STAGING_BUFFER_USAGE_FLAGS = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
@@ -127,16 +171,33 @@ private:
 	static constexpr VkMemoryPropertyFlags GLOBAL_UNIFORM_BUFFER_MEMORY_FLAGS = UNIFORM_BUFFER_MEMORY_FLAGS;
 	static constexpr VkMemoryPropertyFlags MAPPING_BUFFER_MEMORY_FLAGS = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 	static constexpr VkMemoryPropertyFlags BONE_BUFFER_MEMORY_FLAGS = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	// written every frame like the uniforms
+	static constexpr VkMemoryPropertyFlags LIGHT_BUFFER_MEMORY_FLAGS = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 	static constexpr VkMemoryPropertyFlags STAGING_BUFFER_MEMORY_FLAGS = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
+	// filled by create_buffer, so it comes before the buffers
+	std::unordered_set<VkBuffer> concurrent_buffers;
+
 	GraphicsBuffer vertex_buffer;
 	GraphicsBuffer index_buffer;
 	GraphicsBuffer uniform_buffer;
 	GraphicsBuffer materials_buffer;
 	GraphicsBuffer global_uniform_buffer;
-	GraphicsBuffer staging_buffer;
 	GraphicsBuffer bone_buffer;
+	GraphicsBuffer point_lights_buffer;
+	GraphicsBuffer light_clusters_buffer;
+	GraphicsBuffer light_indices_buffer;
 	// maps object id to starting offset in the vertex, index and uniform buffers
 	// unlike the other buffers, entries in this buffer never gets removed
 	AppendOnlyGraphicsBuffer mapping_buffer;
-};
\ No newline at end of file
+
+	std::vector<StagingBuffer> staging_buffers;
+
+	struct PendingAcquire
+	{
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		VkDeviceSize size;
+	};
+
+	std::vector<PendingAcquire> pending_acquires;
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "graphics_buffer_manager.hpp"
 #include "renderable/mesh.hpp"
 
+#include <algorithm>
 #include <numeric>
 
 
@@ -27,12 +28,29 @@ GraphicsBufferManager::GraphicsBufferManager(GraphicsEngine& engine) :
 		MAPPING_BUFFER_CAPACITY, MAPPING_BUFFER_USAGE_FLAGS, MAPPING_BUFFER_MEMORY_FLAGS), sizeof(SDS::BufferMapEntry)),
 	bone_buffer(create_buffer(
 		BONE_BUFFER_CAPACITY, BONE_BUFFER_USAGE_FLAGS, BONE_BUFFER_MEMORY_FLAGS)),
-	staging_buffer(create_buffer(INITIAL_STAGING_BUFFER_CAPACITY, STAGING_BUFFER_USAGE_FLAGS, STAGING_BUFFER_MEMORY_FLAGS))
+	point_lights_buffer(create_buffer(
+		POINT_LIGHTS_BUFFER_CAPACITY, 
+		LIGHT_BUFFER_USAGE_FLAGS, 
+		LIGHT_BUFFER_MEMORY_FLAGS,
+		engine.get_device_module().get_physical_device_properties().properties.limits.minStorageBufferOffsetAlignment)),
+	light_clusters_buffer(create_buffer(
+		LIGHT_CLUSTERS_BUFFER_CAPACITY, 
+		LIGHT_BUFFER_USAGE_FLAGS, 
+		LIGHT_BUFFER_MEMORY_FLAGS,
+		engine.get_device_module().get_physical_device_properties().properties.limits.minStorageBufferOffsetAlignment)),
+	light_indices_buffer(create_buffer(
+		LIGHT_INDICES_BUFFER_CAPACITY, 
+		LIGHT_BUFFER_USAGE_FLAGS, 
+		LIGHT_BUFFER_MEMORY_FLAGS,
+		engine.get_device_module().get_physical_device_properties().properties.limits.minStorageBufferOffsetAlignment))
 {
 	// reserve the first slot in the global uniform buffer for gubo (we only ever use 1 slot)
-	for (uint32_t frame_idx = 0; frame_idx < GraphicsEngine::get_num_swapchain_images(); ++frame_idx)
+	for (uint32_t frame_idx = 0; frame_idx < GraphicsEngine::get_num_frames_in_flight(); ++frame_idx)
 	{
 		global_uniform_buffer.reserve_slot(frame_idx, sizeof(SDS::GlobalData));
+		point_lights_buffer.reserve_slot(frame_idx, POINT_LIGHTS_SLOT_SIZE);
+		light_clusters_buffer.reserve_slot(frame_idx, LIGHT_CLUSTERS_SLOT_SIZE);
+		light_indices_buffer.reserve_slot(frame_idx, LIGHT_INDICES_SLOT_SIZE);
 	}
 }
 
@@ -45,7 +63,13 @@ GraphicsBufferManager::~GraphicsBufferManager()
 	global_uniform_buffer.destroy(get_logical_device());
 	mapping_buffer.destroy(get_logical_device());
 	bone_buffer.destroy(get_logical_device());
-	staging_buffer.destroy(get_logical_device());
+	point_lights_buffer.destroy(get_logical_device());
+	light_clusters_buffer.destroy(get_logical_device());
+	light_indices_buffer.destroy(get_logical_device());
+	for (auto& staging_buffer : staging_buffers)
+	{
+		staging_buffer.buffer.destroy(get_logical_device());
+	}
 }
 
 void GraphicsBufferManager::write_to_uniform_buffer(EntityFrameID id, const SDS::ObjectData& ubos)
@@ -62,8 +86,37 @@ void GraphicsBufferManager::write_to_global_uniform_buffer(uint32_t id, const SD
 	global_uniform_buffer.unmap_slot(get_logical_device());
 }
 
+void GraphicsBufferManager::write_to_light_buffers(
+	uint32_t frame_idx, 
+	const std::vector<SDS::PointLight>& point_lights, 
+	const std::vector<SDS::LightCluster>& light_clusters,
+	const std::vector<uint32_t>& light_indices)
+{
+	if (point_lights.size() * sizeof(point_lights[0]) > POINT_LIGHTS_SLOT_SIZE ||
+		light_clusters.size() * sizeof(light_clusters[0]) > LIGHT_CLUSTERS_SLOT_SIZE ||
+		light_indices.size() * sizeof(light_indices[0]) > LIGHT_INDICES_SLOT_SIZE)
+	{
+		throw std::runtime_error("GraphicsBufferManager::write_to_light_buffers: too many lights!");
+	}
+
+	const auto write = [this, frame_idx](GraphicsBuffer& buffer, const void* data, size_t size)
+	{
+		std::byte* mapped_memory = buffer.map_slot(frame_idx, get_logical_device());
+		std::memcpy(mapped_memory, data, size);
+		buffer.unmap_slot(get_logical_device());
+	};
+	write(point_lights_buffer, point_lights.data(), point_lights.size() * sizeof(point_lights[0]));
+	write(light_clusters_buffer, light_clusters.data(), light_clusters.size() * sizeof(light_clusters[0]));
+	write(light_indices_buffer, light_indices.data(), light_indices.size() * sizeof(light_indices[0]));
+}
+
 void GraphicsBufferManager::write_to_mapping_buffer(ObjectID id, const SDS::BufferMapEntry& entry)
 {
+	// slots are indexed by object id, which is never reused
+	if (id.get_underlying() >= mapping_buffer.get_capacity() / sizeof(entry))
+	{
+		throw std::runtime_error("GraphicsBufferManager::write_to_mapping_buffer: object id is past the end of the mapping buffer!");
+	}
 	mapping_buffer.decrease_free_capacity(sizeof(entry));
 	stage_data_to_buffer(mapping_buffer.get_buffer(), mapping_buffer.get_slot_offset(id.get_underlying()), sizeof(entry), 
 	[&entry](std::byte* destination)
@@ -107,8 +160,8 @@ void GraphicsBufferManager::write_to_buffer(MeshID id, const Mesh& mesh)
 		return;
 	}
 
-	reserve_buffer(vertex_buffer, id.get_underlying(), mesh.get_vertices_data_size());
-	reserve_buffer(index_buffer, id.get_underlying(), mesh.get_indices_data_size());
+	reserve_buffer(vertex_buffer, id.get_underlying(), mesh.get_packed_vertices_data_size());
+	reserve_buffer(index_buffer, id.get_underlying(), mesh.get_packed_indices_data_size());
 
 	const auto vertex_slot = vertex_buffer.get_slot(id.get_underlying());
 	const auto index_slot = index_buffer.get_slot(id.get_underlying());
@@ -116,13 +169,13 @@ void GraphicsBufferManager::write_to_buffer(MeshID id, const Mesh& mesh)
 	stage_data_to_buffer(vertex_buffer.get_buffer(), vertex_slot.offset, vertex_slot.size,
 	[&mesh](std::byte* destination)
 	{
-		std::memcpy(destination, mesh.get_vertices_data(), mesh.get_vertices_data_size());
+		mesh.write_packed_vertices(destination);
 	});
 
 	stage_data_to_buffer(index_buffer.get_buffer(), index_slot.offset, index_slot.size,
 	[&mesh](std::byte* destination)
 	{
-		std::memcpy(destination, mesh.get_indices_data(), mesh.get_indices_data_size());
+		mesh.write_packed_indices(destination);
 	});
 }
 
@@ -138,12 +191,27 @@ GraphicsBuffer GraphicsBufferManager::create_buffer(
 	VkBufferCreateInfo buffer_create_info{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
 	buffer_create_info.size = size;
 	buffer_create_info.usage = usage_flags;
-	buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // will only be used in graphics queue
+	buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // owned by one queue family at a time
+	const auto concurrent_families = get_concurrent_families(usage_flags);
+	if (!concurrent_families.empty())
+	{
+		buffer_create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		buffer_create_info.queueFamilyIndexCount = static_cast<uint32_t>(concurrent_families.size());
+		buffer_create_info.pQueueFamilyIndices = concurrent_families.data();
+	}
 
 	if (vkCreateBuffer(get_logical_device(), &buffer_create_info, nullptr, &buffer) != VK_SUCCESS)
 	{
 		throw std::runtime_error("GraphicsEngine::create_buffer: failed to create buffer!");
 	}
+	// a destroyed buffer's handle can be handed out again
+	if (concurrent_families.empty())
+	{
+		concurrent_buffers.erase(buffer);
+	} else
+	{
+		concurrent_buffers.insert(buffer);
+	}
 
 	VkMemoryRequirements memory_requirements;
 	vkGetBufferMemoryRequirements(get_logical_device(), buffer, &memory_requirements);
@@ -177,12 +245,26 @@ void GraphicsBufferManager::create_buffer_deprecated(size_t size,
 	VkBufferCreateInfo buffer_create_info{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
 	buffer_create_info.size = size;
 	buffer_create_info.usage = usage_flags;
-	buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // will only be used in graphics queue
+	buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // owned by one queue family at a time
+	const auto concurrent_families = get_concurrent_families(usage_flags);
+	if (!concurrent_families.empty())
+	{
+		buffer_create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		buffer_create_info.queueFamilyIndexCount = static_cast<uint32_t>(concurrent_families.size());
+		buffer_create_info.pQueueFamilyIndices = concurrent_families.data();
+	}
 
 	if (vkCreateBuffer(get_logical_device(), &buffer_create_info, nullptr, &buffer) != VK_SUCCESS)
 	{
 		throw std::runtime_error("GraphicsEngine::create_buffer: failed to create buffer!");
 	}
+	if (concurrent_families.empty())
+	{
+		concurrent_buffers.erase(buffer);
+	} else
+	{
+		concurrent_buffers.insert(buffer);
+	}
 
 	VkMemoryRequirements memory_requirements;
 	vkGetBufferMemoryRequirements(get_logical_device(), buffer, &memory_requirements);
@@ -210,32 +292,58 @@ void GraphicsBufferManager::stage_data_to_buffer(VkBuffer destination_buffer,
                                                                   const uint32_t size,
                                                                   const std::function<void(std::byte*)>& write_function)
 {
-	// TODO: this can be optimised:
-	// 1. something about using different queues https://www.reddit.com/r/vulkan/comments/pnweh0/vkcmdcopybuffer_performance_worse_on_nvidia_than/
-	if (staging_buffer.get_capacity() < size)
-	{
-		// recreate the staging buffer if it is too small
-		staging_buffer.destroy(get_logical_device());
-		new (&staging_buffer) GraphicsBuffer(create_buffer(size, STAGING_BUFFER_USAGE_FLAGS, STAGING_BUFFER_MEMORY_FLAGS));
-	}
+	// the copy runs on the transfer queue alongside the rendering rather than in between it
+	// https://www.reddit.com/r/vulkan/comments/pnweh0/vkcmdcopybuffer_performance_worse_on_nvidia_than/
+	GraphicsEngineAsyncQueue& transfer_queue = get_graphics_engine().get_transfer_queue();
+	StagingBuffer& staging_buffer = get_staging_buffer(size);
 
 	// fill the staging buffer
 	void* mapped_data;
-	vkMapMemory(get_logical_device(), staging_buffer.get_memory(), 0, size, 0, &mapped_data);
+	vkMapMemory(get_logical_device(), staging_buffer.buffer.get_memory(), 0, size, 0, &mapped_data);
 	write_function(reinterpret_cast<std::byte*>(mapped_data));
-	vkUnmapMemory(get_logical_device(), staging_buffer.get_memory());
+	vkUnmapMemory(get_logical_device(), staging_buffer.buffer.get_memory());
 
 	// issue the command to copy from staging to device
-	VkCommandBuffer command_buffer = get_graphics_engine().begin_single_time_commands();
+	VkCommandBuffer command_buffer = transfer_queue.begin_commands();
 
 	// actual copy command
 	VkBufferCopy copy_region{};
 	copy_region.srcOffset = 0;
 	copy_region.dstOffset = destination_buffer_offset;
 	copy_region.size = size;
-	vkCmdCopyBuffer(command_buffer, staging_buffer.get_buffer(), destination_buffer, 1, &copy_region);
+	vkCmdCopyBuffer(command_buffer, staging_buffer.buffer.get_buffer(), destination_buffer, 1, &copy_region);
 
-	get_graphics_engine().end_single_time_commands(command_buffer);
+	// an exclusive buffer is released to the graphics family, which acquires it with the same barrier
+	// the contents of the range before the copy don't matter, so the transfer queue never acquires it
+	const bool is_released = transfer_queue.is_dedicated() && !concurrent_buffers.contains(destination_buffer);
+	if (is_released)
+	{
+		VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+		barrier.srcQueueFamilyIndex = transfer_queue.get_family();
+		barrier.dstQueueFamilyIndex = get_graphics_engine().get_device_module().get_queue_family_indices().graphicsFamily.value();
+		barrier.buffer = destination_buffer;
+		barrier.offset = destination_buffer_offset;
+		barrier.size = size;
+		vkCmdPipelineBarrier(
+			command_buffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			0,
+			nullptr,
+			1,
+			&barrier,
+			0,
+			nullptr);
+	}
+
+	staging_buffer.transfer_value = transfer_queue.submit(command_buffer);
+	if (is_released)
+	{
+		pending_acquires.push_back({destination_buffer, destination_buffer_offset, size});
+	}
 }
 
 void GraphicsBufferManager::stage_data_to_image(
@@ -246,20 +354,13 @@ void GraphicsBufferManager::stage_data_to_image(
 	const std::function<void(std::byte*)>& write_function,
 	const uint32_t layer_count)
 {
-	// TODO: this can be optimised:
-	// 1. something about using different queues https://www.reddit.com/r/vulkan/comments/pnweh0/vkcmdcopybuffer_performance_worse_on_nvidia_than/
-	if (staging_buffer.get_capacity() < size)
-	{
-		// recreate the staging buffer if it is too small
-		staging_buffer.destroy(get_logical_device());
-		new (&staging_buffer) GraphicsBuffer(create_buffer(size, STAGING_BUFFER_USAGE_FLAGS, STAGING_BUFFER_MEMORY_FLAGS));
-	}
+	StagingBuffer& staging_buffer = get_staging_buffer(size);
 
 	// fill the staging buffer
 	void* mapped_data;
-	vkMapMemory(get_logical_device(), staging_buffer.get_memory(), 0, size, 0, &mapped_data);
+	vkMapMemory(get_logical_device(), staging_buffer.buffer.get_memory(), 0, size, 0, &mapped_data);
 	write_function(reinterpret_cast<std::byte*>(mapped_data));
-	vkUnmapMemory(get_logical_device(), staging_buffer.get_memory());
+	vkUnmapMemory(get_logical_device(), staging_buffer.buffer.get_memory());
 
 	// issue the command to copy from staging to device
 	VkCommandBuffer command_buffer = get_graphics_engine().begin_single_time_commands();
@@ -283,16 +384,115 @@ void GraphicsBufferManager::stage_data_to_image(
 
 	vkCmdCopyBufferToImage(
 		command_buffer,
-		staging_buffer.get_buffer(),
+		staging_buffer.buffer.get_buffer(),
 		destination_image,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 		1,
 		&region
 	);
 
+	// waits for the graphics queue, the staging buffer is free again after
 	get_graphics_engine().end_single_time_commands(command_buffer);
 }
 
+void GraphicsBufferManager::record_pending_acquires(VkCommandBuffer command_buffer)
+{
+	if (pending_acquires.empty())
+	{
+		return;
+	}
+
+	const auto& queue_families = get_graphics_engine().get_device_module().get_queue_family_indices();
+	std::vector<VkBufferMemoryBarrier> barriers;
+	barriers.reserve(pending_acquires.size());
+	for (const auto& acquire : pending_acquires)
+	{
+		VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		barrier.srcQueueFamilyIndex = queue_families.getTransferFamily();
+		barrier.dstQueueFamilyIndex = queue_families.graphicsFamily.value();
+		barrier.buffer = acquire.buffer;
+		barrier.offset = acquire.offset;
+		barrier.size = acquire.size;
+		barriers.push_back(barrier);
+	}
+	pending_acquires.clear();
+
+	// the submission waits for the transfer queue at all commands, which the barrier starts from
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		0,
+		0,
+		nullptr,
+		static_cast<uint32_t>(barriers.size()),
+		barriers.data(),
+		0,
+		nullptr);
+}
+
+typename GraphicsBufferManager::StagingBuffer& GraphicsBufferManager::get_staging_buffer(size_t size)
+{
+	GraphicsEngineAsyncQueue& transfer_queue = get_graphics_engine().get_transfer_queue();
+	if (staging_buffers.size() >= MAX_STAGING_BUFFERS)
+	{
+		transfer_queue.wait(std::ranges::min_element(staging_buffers, {}, &StagingBuffer::transfer_value)->transfer_value);
+	}
+
+	StagingBuffer* free_buffer = nullptr;
+	for (auto& staging_buffer : staging_buffers)
+	{
+		if (!transfer_queue.is_complete(staging_buffer.transfer_value))
+			continue;
+
+		// the smallest one that fits, otherwise any to be grown
+		const bool fits = staging_buffer.buffer.get_capacity() >= size;
+		if (!free_buffer || (fits && (free_buffer->buffer.get_capacity() < size || 
+			staging_buffer.buffer.get_capacity() < free_buffer->buffer.get_capacity())))
+		{
+			free_buffer = &staging_buffer;
+		}
+	}
+
+	if (!free_buffer)
+	{
+		staging_buffers.push_back({create_buffer(
+			std::max(size, INITIAL_STAGING_BUFFER_CAPACITY), STAGING_BUFFER_USAGE_FLAGS, STAGING_BUFFER_MEMORY_FLAGS)});
+		return staging_buffers.back();
+	}
+
+	if (free_buffer->buffer.get_capacity() < size)
+	{
+		// recreate the staging buffer if it is too small
+		free_buffer->buffer.destroy(get_logical_device());
+		new (&free_buffer->buffer) GraphicsBuffer(create_buffer(size, STAGING_BUFFER_USAGE_FLAGS, STAGING_BUFFER_MEMORY_FLAGS));
+	}
+	free_buffer->transfer_value = 0;
+
+	return *free_buffer;
+}
+
+std::vector<uint32_t> GraphicsBufferManager::get_concurrent_families(VkBufferUsageFlags usage_flags)
+{
+	const auto& queue_families = get_graphics_engine().get_device_module().get_queue_family_indices();
+	const VkBufferUsageFlags acceleration_structure_usage = 
+		VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR;
+	if (!(usage_flags & acceleration_structure_usage) || !queue_families.computeFamily.has_value())
+	{
+		return {};
+	}
+
+	std::vector<uint32_t> families{queue_families.graphicsFamily.value(), queue_families.getComputeFamily()};
+	if (queue_families.getTransferFamily() != queue_families.getComputeFamily())
+	{
+		families.push_back(queue_families.getTransferFamily());
+	}
+
+	return families;
+}
+
 void GraphicsBufferManager::reserve_buffer(GraphicsBuffer& buffer, uint64_t id, size_t size)
 {
 	buffer.reserve_slot(id, size);
@@ -306,8 +506,13 @@ void GraphicsBufferManager::free_buffer(GraphicsBuffer& buffer, uint64_t id)
 		return;
 	}
 	
-	buffer.free_slot(id);
-	update_buffer_stats();
+	// the id can be reserved again straight away, the memory is only reused once the GPU stopped reading it
+	const GraphicsBuffer::Slot slot = buffer.retire_slot(id);
+	get_graphics_engine().get_deletion_queue().push([this, &buffer, slot]
+	{
+		buffer.release_slot(slot);
+		update_buffer_stats();
+	});
 }
 
 void GraphicsBufferManager::update_buffer_stats()
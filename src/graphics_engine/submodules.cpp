@@ -1,6 +1,10 @@
 #include "graphics_engine_base_module.ipp"
+#include "graphics_engine_async_queue.ipp"
+#include "graphics_engine_command_recorder.ipp"
+#include "graphics_engine_deletion_queue.ipp"
 #include "graphics_engine_device.ipp"
 #include "graphics_engine_frame.ipp"
+#include "graphics_engine_frame_pacer.ipp"
 #include "graphics_engine_gui_manager.ipp"
 #include "graphics_engine_object.ipp"
 #include "graphics_engine_swap_chain.ipp"
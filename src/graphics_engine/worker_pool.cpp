@@ -0,0 +1,111 @@
+#include "worker_pool.hpp"
+#include "profiler.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+
+WorkerPool::WorkerPool(uint32_t num_workers, const std::string& thread_name) :
+	num_workers(std::max(num_workers, 1u))
+{
+	for (uint32_t worker_idx = 1; worker_idx < this->num_workers; worker_idx++)
+	{
+		threads.emplace_back(&WorkerPool::work, this, worker_idx, thread_name);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard lock(mutex);
+		should_stop = true;
+	}
+	job_available.notify_all();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkerPool::run(uint32_t num_jobs, const std::function<void(uint32_t worker_idx)>& job)
+{
+	PROFILE_SCOPE("WorkerPool::run");
+
+	if (num_jobs == 0 || num_jobs > num_workers)
+	{
+		throw std::runtime_error(fmt::format("WorkerPool::run: invalid number of jobs {}", num_jobs));
+	}
+
+	{
+		std::lock_guard lock(mutex);
+		this->job = &job;
+		this->num_jobs = num_jobs;
+		num_jobs_remaining = num_jobs;
+		++run_idx;
+	}
+	if (num_jobs > 1)
+	{
+		job_available.notify_all();
+	}
+
+	run_job(0);
+
+	std::unique_lock lock(mutex);
+	jobs_done.wait(lock, [&]() { return num_jobs_remaining == 0; });
+	this->job = nullptr;
+	if (job_exception)
+	{
+		std::rethrow_exception(std::exchange(job_exception, nullptr));
+	}
+}
+
+void WorkerPool::work(uint32_t worker_idx, const std::string& thread_name)
+{
+	Profiler::set_thread_name(fmt::format("{}{}", thread_name, worker_idx));
+
+	uint64_t last_run_idx = 0;
+	while (true)
+	{
+		{
+			std::unique_lock lock(mutex);
+			job_available.wait(lock, [&]() { return should_stop || run_idx != last_run_idx; });
+			if (should_stop)
+			{
+				return;
+			}
+			last_run_idx = run_idx;
+			if (worker_idx >= num_jobs)
+			{
+				continue;
+			}
+		}
+
+		run_job(worker_idx);
+	}
+}
+
+void WorkerPool::run_job(uint32_t worker_idx)
+{
+	try
+	{
+		// one zone per worker, their overlap in the trace shows how well the jobs spread over the cores
+		PROFILE_SCOPE("WorkerPool::run_job");
+		(*job)(worker_idx);
+	} catch (...)
+	{
+		std::lock_guard lock(mutex);
+		if (!job_exception)
+		{
+			job_exception = std::current_exception();
+		}
+	}
+
+	std::lock_guard lock(mutex);
+	if (--num_jobs_remaining == 0)
+	{
+		jobs_done.notify_one();
+	}
+}
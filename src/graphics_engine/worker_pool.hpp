@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Runs a job on several threads at once and waits for all of them.
+// The calling thread is worker 0, it runs the first job while the worker threads run the others
+class WorkerPool
+{
+public:
+	// the threads show up in the profiler as the name followed by their worker index
+	WorkerPool(uint32_t num_workers, const std::string& thread_name);
+	WorkerPool(const WorkerPool&) = delete;
+	~WorkerPool();
+
+	uint32_t get_num_workers() const { return num_workers; }
+
+	// runs job(worker_idx) for the first num_jobs workers and returns once all of them are done,
+	// the first exception a job throws is rethrown here
+	void run(uint32_t num_jobs, const std::function<void(uint32_t worker_idx)>& job);
+
+private:
+	void work(uint32_t worker_idx, const std::string& thread_name);
+	void run_job(uint32_t worker_idx);
+
+	const uint32_t num_workers;
+	// worker 0 is the calling thread, so there is one thread less than workers
+	std::vector<std::thread> threads;
+
+	std::mutex mutex;
+	std::condition_variable job_available;
+	std::condition_variable jobs_done;
+	const std::function<void(uint32_t)>* job = nullptr;
+	uint32_t num_jobs = 0;
+	uint32_t num_jobs_remaining = 0;
+	// bumped for every run, so a worker runs its job of a run once
+	uint64_t run_idx = 0;
+	std::exception_ptr job_exception;
+	bool should_stop = false;
+};
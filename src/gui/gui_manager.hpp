@@ -21,7 +21,8 @@ public:
 		debug(spawn_gui<GuiDebug>()),
 		photo(spawn_gui<GuiPhoto>()),
 		render_slicer(spawn_gui<GuiRenderSlicer>()),
-		animation_selector(spawn_gui<GuiAnimationSelector>())
+		animation_selector(spawn_gui<GuiAnimationSelector>()),
+		profiler(spawn_gui<GuiProfiler>())
 	{
 	}
 
@@ -38,6 +39,26 @@ public:
 		statistics.update_buffer_capacities(capacities);
 	}
 
+	void update_lod_statistics(uint32_t full_triangles, uint32_t drawn_triangles)
+	{
+		statistics.update_lod_statistics(full_triangles, drawn_triangles);
+	}
+
+	void update_acceleration_structure_statistics(uint32_t num_builds, uint32_t num_refits, float build_ms, float refit_ms)
+	{
+		statistics.update_acceleration_structure_statistics(num_builds, num_refits, build_ms, refit_ms);
+	}
+
+	void update_frame_pacing_statistics(float mean_ms, float std_dev_ms, float max_ms)
+	{
+		statistics.update_frame_pacing_statistics(mean_ms, std_dev_ms, max_ms);
+	}
+
+	void update_command_cache_statistics(uint32_t num_hits, uint32_t num_misses)
+	{
+		statistics.update_command_cache_statistics(num_hits, num_misses);
+	}
+
 	// references the GuiManager::gui_windows
 	GuiGraphicsSettings& graphic_settings;
 	GuiObjectSpawner& object_spawner;
@@ -48,6 +69,7 @@ public:
 	GuiPhoto& photo;
 	GuiRenderSlicer& render_slicer;
 	GuiAnimationSelector& animation_selector;
+	GuiProfiler& profiler;
 
 public: // for GameEngine
 	void process(GameEngine& engine)
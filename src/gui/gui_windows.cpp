@@ -21,7 +21,11 @@
 #include "gui_windows.hpp"
 
 
-GuiGraphicsSettings::GuiGraphicsSettings() = default;
+GuiGraphicsSettings::GuiGraphicsSettings()
+{
+	// the default cap is applied on the first frame
+	frame_rate_cap.changed = true;
+}
 
 void GuiGraphicsSettings::draw()
 {
@@ -43,12 +47,20 @@ void GuiGraphicsSettings::draw()
 	ImGui::SliderFloat("lighting", &light_strength, 0.0f, 1.0f);
 	rtx_on.changed = ImGui::Checkbox("RTX", &rtx_on.value);
 	wireframe_mode.changed |= ImGui::Checkbox("wireframe", &wireframe_mode.value);
+	outline_mode.changed |= ImGui::Checkbox("outline", &outline_mode.value);
 	ImGui::SetNextItemWidth(combo_width);
 	selected_camera_projection.changed |= ImGui::Combo(
 		"projection", 
 		&selected_camera_projection.value, 
 		camera_projections.data(), 
 		camera_projections.size());
+	ImGui::SetNextItemWidth(combo_width);
+	selected_present_mode.changed |= ImGui::Combo(
+		"present mode",
+		&selected_present_mode.value,
+		present_modes.data(),
+		present_modes.size());
+	frame_rate_cap.changed |= ImGui::SliderInt("frame cap", &frame_rate_cap.value, 0, 240, frame_rate_cap == 0 ? "off" : "%d");
 
 	ImGui::End();
 }
@@ -65,6 +77,12 @@ void GuiGraphicsSettings::process(GameEngine& engine)
 		engine.get_graphics_engine().enqueue_cmd(std::make_unique<ToggleWireFrameModeCmd>());
 		wireframe_mode.changed = false;
 	}
+
+	if (outline_mode.changed)
+	{
+		engine.get_graphics_engine().enqueue_cmd(std::make_unique<ToggleOutlineModeCmd>());
+		outline_mode.changed = false;
+	}
 }
 
 GuiObjectSpawner::GuiObjectSpawner()
@@ -328,6 +346,25 @@ void GuiStatistics::draw()
 		"bone buffer");
 	ImGui::SameLine(); ImGui::Text("%ukB", bone_buffer_capacity.total_capacity / 1024);
 
+	ImGui::Separator();
+	ImGui::Text("triangles drawn: %u / %u", drawn_triangles, full_triangles);
+	ImGui::Text("LOD reduction: %.1f%%", 
+		full_triangles > 0 ? 100.0f * (1.0f - float(drawn_triangles) / float(full_triangles)) : 0.0f);
+
+	ImGui::Separator();
+	ImGui::Text("AS builds: %u (%.2fms)", num_as_builds, as_build_ms);
+	ImGui::Text("AS refits: %u (%.2fms)", num_as_refits, as_refit_ms);
+
+	ImGui::Separator();
+	ImGui::Text("frame time: %.2fms (max %.2fms)", frame_time_mean_ms, frame_time_max_ms);
+	ImGui::Text("frame time std dev: %.2fms", frame_time_std_dev_ms);
+
+	ImGui::Separator();
+	const uint64_t total_command_cache_lookups = total_command_cache_hits + total_command_cache_misses;
+	ImGui::Text("draw command cache: %u hits, %u misses", command_cache_hits, command_cache_misses);
+	ImGui::Text("draw command cache hit rate: %.1f%%", 
+		total_command_cache_lookups > 0 ? 100.0f * float(total_command_cache_hits) / float(total_command_cache_lookups) : 0.0f);
+
 	ImGui::End();
 }
 
@@ -349,6 +386,35 @@ void GuiStatistics::update_buffer_capacities(
 	bone_buffer_capacity.total_capacity = buffer_capacities[5].second;
 }
 
+void GuiStatistics::update_lod_statistics(uint32_t full_triangles, uint32_t drawn_triangles)
+{
+	this->full_triangles = full_triangles;
+	this->drawn_triangles = drawn_triangles;
+}
+
+void GuiStatistics::update_acceleration_structure_statistics(uint32_t num_builds, uint32_t num_refits, float build_ms, float refit_ms)
+{
+	num_as_builds = num_builds;
+	num_as_refits = num_refits;
+	as_build_ms = build_ms;
+	as_refit_ms = refit_ms;
+}
+
+void GuiStatistics::update_frame_pacing_statistics(float mean_ms, float std_dev_ms, float max_ms)
+{
+	frame_time_mean_ms = mean_ms;
+	frame_time_std_dev_ms = std_dev_ms;
+	frame_time_max_ms = max_ms;
+}
+
+void GuiStatistics::update_command_cache_statistics(uint32_t num_hits, uint32_t num_misses)
+{
+	command_cache_hits = num_hits;
+	command_cache_misses = num_misses;
+	total_command_cache_hits += num_hits;
+	total_command_cache_misses += num_misses;
+}
+
 void GuiDebug::process(GameEngine& engine)
 {
 	// TODO: fix bone visualisers
@@ -595,3 +661,81 @@ void GuiAnimationSelector::draw()
 
 	ImGui::End();
 }
+
+
+void GuiProfiler::draw()
+{
+	ImGui::Begin("Profiler");
+
+	bool enabled = Profiler::is_enabled();
+	if (ImGui::Checkbox("record", &enabled))
+	{
+		Profiler::set_enabled(enabled);
+	}
+	ImGui::SameLine(); ImGui::Checkbox("pause", &paused);
+	ImGui::SameLine();
+	if (ImGui::Button("save trace"))
+	{
+		const auto path = Utility::get_build_path() / "profiler_trace.json";
+		try
+		{
+			Profiler::write_chrome_trace(path);
+			save_trace_status = "trace written to " + path.string();
+			LOG_INFO(Utility::get_logger(), "GuiProfiler: {}", save_trace_status);
+		} catch (const std::exception& e)
+		{
+			save_trace_status = e.what();
+			LOG_ERROR(Utility::get_logger(), "GuiProfiler: {}", save_trace_status);
+		}
+	}
+	if (!save_trace_status.empty())
+	{
+		ImGui::TextUnformatted(save_trace_status.c_str());
+	}
+
+	if (!paused)
+	{
+		timelines = Profiler::get_last_frames();
+	}
+
+	const float row_height = ImGui::GetTextLineHeightWithSpacing();
+	const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+	ImDrawList* draw_list = ImGui::GetWindowDrawList();
+	for (const auto& timeline : timelines)
+	{
+		const float frame_ns = float(std::max<uint64_t>(timeline.frame_end_ns - timeline.frame_begin_ns, 1));
+		ImGui::Text("%s %.2fms", timeline.thread_name.c_str(), frame_ns * 1e-6f);
+
+		uint32_t max_depth = 0;
+		for (const auto& zone : timeline.zones)
+		{
+			max_depth = std::max(zone.depth, max_depth);
+		}
+
+		const ImVec2 origin = ImGui::GetCursorScreenPos();
+		for (const auto& zone : timeline.zones)
+		{
+			// zones can straddle the frame boundaries, clip them to the frame
+			const float begin = std::clamp(float(int64_t(zone.begin_ns - timeline.frame_begin_ns)) / frame_ns, 0.0f, 1.0f);
+			const float end = std::clamp(float(int64_t(zone.end_ns - timeline.frame_begin_ns)) / frame_ns, 0.0f, 1.0f);
+			const ImVec2 min{ origin.x + begin * width, origin.y + zone.depth * row_height };
+			const ImVec2 max{ origin.x + std::max(end * width, begin * width + 1.0f), min.y + row_height - 1.0f };
+
+			// colour is derived from the name so that a zone keeps its colour across frames
+			const auto hash = std::hash<std::string_view>{}(zone.name);
+			const ImU32 colour = IM_COL32(80 + hash % 150, 80 + (hash >> 8) % 150, 80 + (hash >> 16) % 150, 255);
+			draw_list->AddRectFilled(min, max, colour);
+			draw_list->PushClipRect(min, max, true);
+			draw_list->AddText(ImVec2{ min.x + 2.0f, min.y }, IM_COL32_BLACK, zone.name);
+			draw_list->PopClipRect();
+
+			if (ImGui::IsMouseHoveringRect(min, max))
+			{
+				ImGui::SetTooltip("%s %.3fms", zone.name, (zone.end_ns - zone.begin_ns) * 1e-6f);
+			}
+		}
+		ImGui::Dummy(ImVec2{ width, (max_depth + 1) * row_height });
+	}
+
+	ImGui::End();
+}
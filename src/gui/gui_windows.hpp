@@ -2,6 +2,7 @@
 
 #include "maths.hpp"
 #include "identifications.hpp"
+#include "profiler.hpp"
 
 #include <map>
 #include <string>
@@ -64,6 +65,14 @@ public:
 	GuiVar<bool> rtx_on = false;
 	GuiVar<int> selected_camera_projection = 0;
 	GuiVar<bool> wireframe_mode = false;
+	// outlines the stenciled objects in screen space, see GraphicsEngine::is_outline_mode
+	GuiVar<bool> outline_mode = true;
+	// indexes present_modes, applied by the graphics engine
+	GuiVar<int> selected_present_mode = 0;
+	// frames per second, 0 leaves it to the present mode
+	GuiVar<int> frame_rate_cap = 60;
+
+	const std::vector<const char*> present_modes = { "mailbox", "fifo", "immediate" };
 
 private:
 	const std::vector<const char*> camera_projections = { "perspective", "orthographic" };
@@ -142,6 +151,14 @@ public:
 	virtual void draw() override;
 
 	void update_buffer_capacities(const std::vector<std::pair<size_t, size_t>>& buffer_capacities);
+	// triangles at LOD 0 vs triangles actually submitted this frame
+	void update_lod_statistics(uint32_t full_triangles, uint32_t drawn_triangles);
+	// acceleration structure builds vs refits/in place updates this frame and the time spent on each
+	void update_acceleration_structure_statistics(uint32_t num_builds, uint32_t num_refits, float build_ms, float refit_ms);
+	// over the last frames, between displays when the device can wait for them, otherwise between presents
+	void update_frame_pacing_statistics(float mean_ms, float std_dev_ms, float max_ms);
+	// cached draw commands replayed vs recorded again this frame, see Renderer::execute_cached_commands
+	void update_command_cache_statistics(uint32_t num_hits, uint32_t num_misses);
 
 private:
 	struct BufferCapacity
@@ -156,6 +173,24 @@ private:
 	BufferCapacity materials_buffer_capacity;
 	BufferCapacity mapping_buffer_capacity;
 	BufferCapacity bone_buffer_capacity;
+
+	uint32_t full_triangles = 0;
+	uint32_t drawn_triangles = 0;
+
+	uint32_t num_as_builds = 0;
+	uint32_t num_as_refits = 0;
+	float as_build_ms = 0.0f;
+	float as_refit_ms = 0.0f;
+
+	float frame_time_mean_ms = 0.0f;
+	float frame_time_std_dev_ms = 0.0f;
+	float frame_time_max_ms = 0.0f;
+
+	uint32_t command_cache_hits = 0;
+	uint32_t command_cache_misses = 0;
+	// since the start, a single frame only tells whether the scene just changed
+	uint64_t total_command_cache_hits = 0;
+	uint64_t total_command_cache_misses = 0;
 };
 
 class Object;
@@ -244,4 +279,17 @@ private:
 	std::string selected_animation_name = "";
 	bool loop = false;
 	bool should_play = false;
+};
+
+// flame view of the last completed frame of every profiled thread, see Profiler
+class GuiProfiler : public GuiWindow
+{
+public:
+	virtual void draw() override;
+
+private:
+	bool paused = false;
+	// result of the last "save trace"
+	std::string save_trace_status;
+	std::vector<Profiler::FrameTimeline> timelines;
 };
\ No newline at end of file
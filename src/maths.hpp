@@ -67,6 +67,28 @@ namespace Maths
 		float radius = 0.5f;
 	};
 
+	// oriented bounding box, the columns of orientation are the box's local axes
+	struct OBB
+	{
+		OBB() = default;
+		OBB(glm::vec3 center_, glm::vec3 half_extents_, const glm::mat3& orientation_ = glm::mat3(1.0f)) :
+			center(center_), half_extents(half_extents_), orientation(orientation_)
+		{}
+		glm::vec3 center = glm::vec3(0.0f);
+		glm::vec3 half_extents = glm::vec3(0.5f);
+		glm::mat3 orientation = glm::mat3(1.0f);
+	};
+
+	// sphere swept along the segment start -> end
+	struct Capsule
+	{
+		Capsule() = default;
+		Capsule(glm::vec3 start_, glm::vec3 end_, float radius_) : start(start_), end(end_), radius(radius_) {}
+		glm::vec3 start = glm::vec3(0.0f, -0.5f, 0.0f);
+		glm::vec3 end = glm::vec3(0.0f, 0.5f, 0.0f);
+		float radius = 0.5f;
+	};
+
 	struct Transform
 	{
 	public:
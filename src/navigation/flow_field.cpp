@@ -0,0 +1,160 @@
+#include "flow_field.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <array>
+
+
+namespace
+{
+	const std::array<NavGrid::Coord, 8> DIRECTIONS =
+	{
+		NavGrid::Coord(1, 0), NavGrid::Coord(0, 1), NavGrid::Coord(-1, 0), NavGrid::Coord(0, -1),
+		NavGrid::Coord(1, 1), NavGrid::Coord(-1, 1), NavGrid::Coord(-1, -1), NavGrid::Coord(1, -1),
+	};
+
+	uint8_t get_direction_index(const NavGrid::Coord& delta)
+	{
+		return uint8_t(std::find(DIRECTIONS.begin(), DIRECTIONS.end(), delta) - DIRECTIONS.begin());
+	}
+
+	struct OpenNode
+	{
+		NavGrid::Cost cost;
+		uint32_t index;
+
+		bool operator<(const OpenNode& other) const { return cost > other.cost; }
+	};
+}
+
+FlowField::FlowField(const NavGrid& grid, const NavGrid::Coord& goal) :
+	grid(&grid),
+	grid_version(grid.get_version()),
+	goal(goal),
+	origin(grid.get_origin()),
+	size(grid.get_size()),
+	costs_to_goal(grid.get_num_tiles(), NO_COST),
+	directions(grid.get_num_tiles(), NO_DIRECTION)
+{
+	PROFILE_SCOPE("FlowField::FlowField");
+	if (!grid.is_passable(goal))
+	{
+		return;
+	}
+
+	// the search runs backwards from the goal, walking from a tile onto a settled one costs entering the settled one
+	std::vector<OpenNode> open;
+	const uint32_t goal_index = grid.get_index(goal);
+	costs_to_goal[goal_index] = 0;
+	open.push_back(OpenNode{ 0, goal_index });
+	while (!open.empty())
+	{
+		std::pop_heap(open.begin(), open.end());
+		const OpenNode node = open.back();
+		open.pop_back();
+		if (node.cost > costs_to_goal[node.index])
+		{
+			continue;
+		}
+
+		const NavGrid::Cost enter_cost = grid.get_cost(node.index);
+		grid.for_each_neighbour(node.index, [&](uint32_t neighbour, const NavGrid::Coord& offset, uint32_t step_length)
+		{
+			const NavGrid::Cost cost = node.cost + step_length * enter_cost;
+			if (cost < costs_to_goal[neighbour])
+			{
+				costs_to_goal[neighbour] = cost;
+				directions[neighbour] = get_direction_index(-offset);
+				open.push_back(OpenNode{ cost, neighbour });
+				std::push_heap(open.begin(), open.end());
+			}
+		});
+	}
+}
+
+bool FlowField::contains(const NavGrid::Coord& coord) const
+{
+	const NavGrid::Coord local = coord - origin;
+	return local.x >= 0 && local.y >= 0 && local.x < size.x && local.y < size.y;
+}
+
+uint32_t FlowField::get_index(const NavGrid::Coord& coord) const
+{
+	const NavGrid::Coord local = coord - origin;
+	return uint32_t(local.y) * uint32_t(size.x) + uint32_t(local.x);
+}
+
+float FlowField::get_cost_to_goal(const NavGrid::Coord& coord) const
+{
+	return is_reachable(coord) ? NavGrid::to_tiles(costs_to_goal[get_index(coord)]) : UNREACHABLE;
+}
+
+NavGrid::Coord FlowField::get_direction(const NavGrid::Coord& coord) const
+{
+	if (!contains(coord))
+	{
+		return NavGrid::Coord(0);
+	}
+
+	const uint8_t direction = directions[get_index(coord)];
+	return direction == NO_DIRECTION ? NavGrid::Coord(0) : DIRECTIONS[direction];
+}
+
+std::vector<NavGrid::Coord> FlowField::trace(const NavGrid::Coord& start) const
+{
+	if (!is_reachable(start))
+	{
+		return {};
+	}
+
+	std::vector<NavGrid::Coord> tiles = { start };
+	while (tiles.back() != goal)
+	{
+		tiles.push_back(tiles.back() + get_direction(tiles.back()));
+	}
+
+	return tiles;
+}
+
+std::shared_ptr<const FlowField> FlowFieldCache::get(const NavGrid& grid, const NavGrid::Coord& goal)
+{
+	const uint64_t key = get_key(goal);
+	auto it = goal_to_field.find(key);
+	if (it != goal_to_field.end())
+	{
+		if ((*it->second)->is_up_to_date(grid))
+		{
+			fields.splice(fields.begin(), fields, it->second);
+			return fields.front();
+		}
+
+		fields.erase(it->second);
+		goal_to_field.erase(it);
+	}
+
+	if (capacity == 0)
+	{
+		return std::make_shared<const FlowField>(grid, goal);
+	}
+
+	if (fields.size() >= capacity)
+	{
+		goal_to_field.erase(get_key(fields.back()->get_goal()));
+		fields.pop_back();
+	}
+
+	fields.push_front(std::make_shared<const FlowField>(grid, goal));
+	goal_to_field.emplace(key, fields.begin());
+	return fields.front();
+}
+
+void FlowFieldCache::clear()
+{
+	fields.clear();
+	goal_to_field.clear();
+}
+
+uint64_t FlowFieldCache::get_key(const NavGrid::Coord& goal)
+{
+	return (uint64_t(uint32_t(goal.x)) << 32) | uint32_t(goal.y);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "nav_grid.hpp"
+
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <limits>
+
+
+//
+// cost to a single goal from every tile, and the step to take from each tile to get there
+//	built once with Dijkstra from the goal, then any number of units heading to the same goal
+//	just read the step under them instead of each running their own search
+//
+class FlowField
+{
+public:
+	static constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+
+	FlowField(const NavGrid& grid, const NavGrid::Coord& goal);
+
+	const NavGrid::Coord& get_goal() const { return goal; }
+	// the grid and its version the field was built from
+	const NavGrid* get_grid() const { return grid; }
+	uint64_t get_grid_version() const { return grid_version; }
+	bool is_up_to_date(const NavGrid& grid) const { return this->grid == &grid && grid_version == grid.get_version(); }
+
+	// in tiles, UNREACHABLE when there is no way to the goal
+	float get_cost_to_goal(const NavGrid::Coord& coord) const;
+	bool is_reachable(const NavGrid::Coord& coord) const { return contains(coord) && costs_to_goal[get_index(coord)] != NO_COST; }
+	// unit step towards the goal, zero at the goal and where it can't be reached
+	NavGrid::Coord get_direction(const NavGrid::Coord& coord) const;
+	// the tiles a unit at start walks through, empty when the goal can't be reached
+	std::vector<NavGrid::Coord> trace(const NavGrid::Coord& start) const;
+
+private:
+	static constexpr uint8_t NO_DIRECTION = 8;
+	static constexpr NavGrid::Cost NO_COST = std::numeric_limits<NavGrid::Cost>::max();
+
+	const NavGrid* grid;
+	uint64_t grid_version;
+	NavGrid::Coord goal;
+	NavGrid::Coord origin;
+	NavGrid::Coord size;
+
+	// in cost units
+	std::vector<NavGrid::Cost> costs_to_goal;
+	// index into the direction table, NO_DIRECTION at the goal and unreachable tiles
+	std::vector<uint8_t> directions;
+
+	bool contains(const NavGrid::Coord& coord) const;
+	uint32_t get_index(const NavGrid::Coord& coord) const;
+};
+
+// least recently used flow fields by goal, a group move order reuses the field of the previous one to the same tile
+//	fields are rebuilt on the next request once the grid changes
+class FlowFieldCache
+{
+public:
+	static constexpr size_t DEFAULT_CAPACITY = 16;
+
+	FlowFieldCache(size_t capacity = DEFAULT_CAPACITY) : capacity(capacity) {}
+
+	// units can keep the field they were given, it stays valid for them even after it's evicted
+	std::shared_ptr<const FlowField> get(const NavGrid& grid, const NavGrid::Coord& goal);
+
+	size_t size() const { return fields.size(); }
+	void clear();
+
+private:
+	static uint64_t get_key(const NavGrid::Coord& goal);
+
+	size_t capacity;
+	// most recently used first
+	std::list<std::shared_ptr<const FlowField>> fields;
+	std::unordered_map<uint64_t, std::list<std::shared_ptr<const FlowField>>::iterator> goal_to_field;
+};
@@ -0,0 +1,684 @@
+#include "hierarchical_pathfinder.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+
+namespace
+{
+	uint64_t get_cluster_pair_key(uint32_t start_cluster, uint32_t goal_cluster)
+	{
+		return (uint64_t(start_cluster) << 32) | goal_cluster;
+	}
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder(NavGrid& grid, int cluster_size, size_t cache_capacity) :
+	grid(grid),
+	cluster_size(cluster_size),
+	grid_version(grid.get_version()),
+	cache_capacity(cache_capacity)
+{
+	if (cluster_size < 2)
+	{
+		throw std::runtime_error("HierarchicalPathfinder::HierarchicalPathfinder: clusters must be at least 2 tiles wide");
+	}
+
+	num_clusters = (grid.get_size() + cluster_size - 1) / cluster_size;
+	clusters.resize(size_t(num_clusters.x) * size_t(num_clusters.y));
+	const NavGrid::Coord last_tile = grid.get_origin() + grid.get_size() - 1;
+	for (int y = 0; y < num_clusters.y; y++)
+	{
+		for (int x = 0; x < num_clusters.x; x++)
+		{
+			const uint32_t cluster = uint32_t(y * num_clusters.x + x);
+			clusters[cluster].min = grid.get_origin() + NavGrid::Coord(x, y) * cluster_size;
+			clusters[cluster].max = glm::min(clusters[cluster].min + cluster_size - 1, last_tile);
+			dirty_clusters.push_back(cluster);
+		}
+	}
+}
+
+void HierarchicalPathfinder::set_cost(const NavGrid::Coord& coord, uint8_t cost)
+{
+	const uint64_t version = grid.get_version();
+	grid.set_cost(coord, cost);
+	if (grid.get_version() != version)
+	{
+		invalidate(coord);
+	}
+}
+
+void HierarchicalPathfinder::invalidate(const NavGrid::Coord& coord)
+{
+	if (!grid.contains(coord))
+	{
+		return;
+	}
+
+	mark_dirty(coord);
+	grid_version = grid.get_version();
+}
+
+uint32_t HierarchicalPathfinder::get_cluster(const NavGrid::Coord& coord) const
+{
+	const NavGrid::Coord cluster = (coord - grid.get_origin()) / cluster_size;
+	return uint32_t(cluster.y * num_clusters.x + cluster.x);
+}
+
+void HierarchicalPathfinder::mark_dirty(const NavGrid::Coord& coord)
+{
+	const uint32_t cluster = get_cluster(coord);
+	if (!clusters[cluster].dirty)
+	{
+		clusters[cluster].dirty = true;
+		dirty_clusters.push_back(cluster);
+	}
+}
+
+void HierarchicalPathfinder::update()
+{
+	if (grid.get_version() != grid_version)
+	{
+		// changed behind our back, there's no telling where
+		for (uint32_t cluster = 0; cluster < clusters.size(); cluster++)
+		{
+			if (!clusters[cluster].dirty)
+			{
+				clusters[cluster].dirty = true;
+				dirty_clusters.push_back(cluster);
+			}
+		}
+		grid_version = grid.get_version();
+	}
+
+	if (dirty_clusters.empty())
+	{
+		return;
+	}
+	PROFILE_SCOPE("HierarchicalPathfinder::update");
+
+	// every border of a dirty cluster, a border is identified by the cluster below or left of it
+	std::vector<uint64_t> borders;
+	for (const uint32_t cluster : dirty_clusters)
+	{
+		const int x = int(cluster) % num_clusters.x;
+		const int y = int(cluster) / num_clusters.x;
+		if (x + 1 < num_clusters.x) borders.push_back(uint64_t(cluster) * 2);
+		if (y + 1 < num_clusters.y) borders.push_back(uint64_t(cluster) * 2 + 1);
+		if (x > 0) borders.push_back(uint64_t(cluster - 1) * 2);
+		if (y > 0) borders.push_back(uint64_t(cluster - num_clusters.x) * 2 + 1);
+
+		// its own paths may have changed even if its entrances didn't
+		clusters[cluster].intra_dirty = true;
+		clusters[cluster].dirty = false;
+	}
+	dirty_clusters.clear();
+	std::sort(borders.begin(), borders.end());
+	borders.erase(std::unique(borders.begin(), borders.end()), borders.end());
+	for (const uint64_t border : borders)
+	{
+		rebuild_border(uint32_t(border / 2), border % 2 == 1);
+	}
+
+	// cached routes through a rebuilt cluster may use nodes that are gone or have been reused
+	std::vector<uint32_t> rebuilt;
+	for (uint32_t cluster = 0; cluster < clusters.size(); cluster++)
+	{
+		if (clusters[cluster].intra_dirty)
+		{
+			rebuild_intra_edges(cluster);
+			clusters[cluster].intra_dirty = false;
+			rebuilt.push_back(cluster);
+		}
+	}
+	for (auto it = cache.begin(); it != cache.end();)
+	{
+		const bool is_stale = std::any_of(it->clusters.begin(), it->clusters.end(), [&](uint32_t cluster)
+		{
+			return std::binary_search(rebuilt.begin(), rebuilt.end(), cluster);
+		});
+		if (is_stale)
+		{
+			it = forget_route(it);
+		} else
+		{
+			++it;
+		}
+	}
+}
+
+void HierarchicalPathfinder::rebuild_border(uint32_t cluster, bool up)
+{
+	const uint32_t other = up ? cluster + uint32_t(num_clusters.x) : cluster + 1;
+	// along the border and across it
+	const NavGrid::Coord along = up ? NavGrid::Coord(1, 0) : NavGrid::Coord(0, 1);
+	const NavGrid::Coord across = up ? NavGrid::Coord(0, 1) : NavGrid::Coord(1, 0);
+	const NavGrid::Coord first = up ? NavGrid::Coord(clusters[cluster].min.x, clusters[cluster].max.y) : NavGrid::Coord(clusters[cluster].max.x, clusters[cluster].min.y);
+	const int length = up ? clusters[cluster].max.x - clusters[cluster].min.x + 1 : clusters[cluster].max.y - clusters[cluster].min.y + 1;
+
+	std::vector<Transition>& transitions = up ? clusters[cluster].up_border : clusters[cluster].right_border;
+	const std::vector<Transition> old_transitions = std::move(transitions);
+	transitions.clear();
+	for (const Transition& transition : old_transitions)
+	{
+		auto remove_edge = [](std::vector<Edge>& edges, uint32_t to)
+		{
+			edges.erase(std::find_if(edges.begin(), edges.end(), [to](const Edge& edge) { return edge.to == to; }));
+		};
+		remove_edge(nodes[transition.inside].inter_edges, transition.outside);
+		remove_edge(nodes[transition.outside].inter_edges, transition.inside);
+	}
+
+	// the new transitions are acquired before the old ones are released, so nodes that stay keep their ids
+	auto add_transition = [&](int position)
+	{
+		const NavGrid::Coord inside = first + along * position;
+		const NavGrid::Coord outside = inside + across;
+		const uint32_t inside_node = acquire_node(cluster, grid.get_index(inside));
+		const uint32_t outside_node = acquire_node(other, grid.get_index(outside));
+		nodes[inside_node].inter_edges.push_back(Edge{ outside_node, NavGrid::Cost(NavGrid::STRAIGHT_STEP) * grid.get_cost(outside) });
+		nodes[outside_node].inter_edges.push_back(Edge{ inside_node, NavGrid::Cost(NavGrid::STRAIGHT_STEP) * grid.get_cost(inside) });
+		transitions.push_back(Transition{ inside_node, outside_node });
+	};
+
+	int run_start = -1;
+	for (int position = 0; position <= length; position++)
+	{
+		const bool is_open = position < length &&
+			grid.is_passable(first + along * position) &&
+			grid.is_passable(first + along * position + across);
+		if (is_open && run_start < 0)
+		{
+			run_start = position;
+		} else if (!is_open && run_start >= 0)
+		{
+			const int run_end = position - 1;
+			if (run_end - run_start + 1 >= LONG_ENTRANCE)
+			{
+				// ends plus evenly spread ones between them, so crossing doesn't detour far to reach an entrance
+				const int run_length = run_end - run_start;
+				const int num_gaps = (run_length + ENTRANCE_SPACING - 1) / ENTRANCE_SPACING;
+				for (int gap = 0; gap <= num_gaps; gap++)
+				{
+					add_transition(run_start + run_length * gap / num_gaps);
+				}
+			} else
+			{
+				add_transition((run_start + run_end) / 2);
+			}
+			run_start = -1;
+		}
+	}
+
+	for (const Transition& transition : old_transitions)
+	{
+		release_node(transition.inside);
+		release_node(transition.outside);
+	}
+}
+
+void HierarchicalPathfinder::rebuild_intra_edges(uint32_t cluster)
+{
+	const Cluster& data = clusters[cluster];
+	for (const uint32_t node : data.nodes)
+	{
+		nodes[node].intra_edges.clear();
+	}
+
+	std::vector<uint32_t> tiles;
+	for (const uint32_t node : data.nodes)
+	{
+		tiles.push_back(nodes[node].tile);
+	}
+	for (const uint32_t from : data.nodes)
+	{
+		start_search.run(grid, data, nodes[from].tile, false, tiles);
+		for (const uint32_t to : data.nodes)
+		{
+			const NavGrid::Cost cost = start_search.get_cost(grid, nodes[to].tile);
+			if (to != from && cost != NO_COST)
+			{
+				nodes[from].intra_edges.push_back(Edge{ to, cost });
+			}
+		}
+	}
+}
+
+uint32_t HierarchicalPathfinder::acquire_node(uint32_t cluster, uint32_t tile)
+{
+	for (const uint32_t node : clusters[cluster].nodes)
+	{
+		if (nodes[node].tile == tile)
+		{
+			nodes[node].refs++;
+			return node;
+		}
+	}
+
+	uint32_t node;
+	if (free_nodes.empty())
+	{
+		node = uint32_t(nodes.size());
+		nodes.emplace_back();
+	} else
+	{
+		node = free_nodes.back();
+		free_nodes.pop_back();
+	}
+	nodes[node].tile = tile;
+	nodes[node].cluster = cluster;
+	nodes[node].refs = 1;
+	clusters[cluster].nodes.push_back(node);
+	clusters[cluster].intra_dirty = true;
+
+	return node;
+}
+
+void HierarchicalPathfinder::release_node(uint32_t node)
+{
+	Node& data = nodes[node];
+	if (--data.refs > 0)
+	{
+		return;
+	}
+
+	Cluster& cluster = clusters[data.cluster];
+	cluster.nodes.erase(std::find(cluster.nodes.begin(), cluster.nodes.end(), node));
+	cluster.intra_dirty = true;
+	data = Node{};
+	free_nodes.push_back(node);
+}
+
+void HierarchicalPathfinder::ClusterSearch::run(const NavGrid& grid, const Cluster& cluster, uint32_t source, bool backward, const std::vector<uint32_t>& targets)
+{
+	min = cluster.min;
+	max = cluster.max;
+	// everything runs on positions within the cluster, the grid index is only needed to read costs
+	const int width = max.x - min.x + 1;
+	const int height = max.y - min.y + 1;
+	const uint32_t grid_width = uint32_t(grid.get_size().x);
+	const uint32_t first_tile = grid.get_index(min);
+	auto get_tile = [&](int x, int y) { return first_tile + uint32_t(y) * grid_width + uint32_t(x); };
+	costs.assign(size_t(width) * size_t(height), NO_COST);
+	parents.assign(costs.size(), NavGrid::INVALID_INDEX);
+	is_target.assign(costs.size(), 0);
+	open.clear();
+
+	size_t num_targets = 0;
+	for (const uint32_t target : targets)
+	{
+		uint8_t& flag = is_target[get_local(grid, target)];
+		num_targets += flag == 0;
+		flag = 1;
+	}
+	// a single target is searched for with A*, several are settled by Dijkstra in whichever order they come
+	const NavGrid::Coord target_coord = targets.size() == 1 ? grid.get_coord(targets.front()) - min : NavGrid::Coord(0);
+	auto get_heuristic = [&](int x, int y)
+	{
+		return targets.size() == 1 ? NavGrid::get_octile_distance(NavGrid::Coord(x, y), target_coord) : NavGrid::Cost(0);
+	};
+
+	const uint32_t source_local = get_local(grid, source);
+	costs[source_local] = 0;
+	open.emplace_back(get_heuristic(int(source_local) % width, int(source_local) / width), source_local);
+	const auto greater = std::greater<std::pair<NavGrid::Cost, uint32_t>>();
+	while (!open.empty())
+	{
+		std::pop_heap(open.begin(), open.end(), greater);
+		const auto [f, local] = open.back();
+		open.pop_back();
+		const int x = int(local) % width;
+		const int y = int(local) / width;
+		const NavGrid::Cost g = costs[local];
+		if (f != g + get_heuristic(x, y))
+		{
+			// stale, the tile was reached more cheaply after this was pushed
+			continue;
+		}
+		if (is_target[local])
+		{
+			// settled twice can't happen, a stale entry was skipped above
+			if (--num_targets == 0)
+			{
+				break;
+			}
+		}
+
+		const uint32_t tile = get_tile(x, y);
+		const NavGrid::Cost leave_cost = grid.get_cost(tile);
+		const bool has_left = x > 0 && grid.get_cost(tile - 1) != NavGrid::BLOCKED;
+		const bool has_right = x < width - 1 && grid.get_cost(tile + 1) != NavGrid::BLOCKED;
+		const bool has_down = y > 0 && grid.get_cost(tile - grid_width) != NavGrid::BLOCKED;
+		const bool has_up = y < height - 1 && grid.get_cost(tile + grid_width) != NavGrid::BLOCKED;
+		auto relax = [&](int dx, int dy, uint32_t step_length)
+		{
+			const uint32_t neighbour_tile = get_tile(x + dx, y + dy);
+			const NavGrid::Cost enter_cost = grid.get_cost(neighbour_tile);
+			if (enter_cost == NavGrid::BLOCKED)
+			{
+				return;
+			}
+			const NavGrid::Cost cost = g + NavGrid::Cost(step_length) * (backward ? leave_cost : enter_cost);
+			const uint32_t neighbour = uint32_t((y + dy) * width + x + dx);
+			if (cost < costs[neighbour])
+			{
+				costs[neighbour] = cost;
+				parents[neighbour] = tile;
+				open.emplace_back(cost + get_heuristic(x + dx, y + dy), neighbour);
+				std::push_heap(open.begin(), open.end(), greater);
+			}
+		};
+
+		// the same moves as NavGrid::for_each_neighbour, kept inside the cluster
+		if (has_right) relax(1, 0, NavGrid::STRAIGHT_STEP);
+		if (has_up) relax(0, 1, NavGrid::STRAIGHT_STEP);
+		if (has_left) relax(-1, 0, NavGrid::STRAIGHT_STEP);
+		if (has_down) relax(0, -1, NavGrid::STRAIGHT_STEP);
+		if (has_right && has_up) relax(1, 1, NavGrid::DIAGONAL_STEP);
+		if (has_left && has_up) relax(-1, 1, NavGrid::DIAGONAL_STEP);
+		if (has_left && has_down) relax(-1, -1, NavGrid::DIAGONAL_STEP);
+		if (has_right && has_down) relax(1, -1, NavGrid::DIAGONAL_STEP);
+	}
+}
+
+uint32_t HierarchicalPathfinder::ClusterSearch::get_local(const NavGrid& grid, uint32_t tile) const
+{
+	const NavGrid::Coord local = grid.get_coord(tile) - min;
+	return uint32_t(local.y * (max.x - min.x + 1) + local.x);
+}
+
+uint32_t HierarchicalPathfinder::ClusterSearch::get_parent(const NavGrid& grid, uint32_t tile) const
+{
+	return parents[get_local(grid, tile)];
+}
+
+Path HierarchicalPathfinder::find_path(const NavGrid::Coord& start, const NavGrid::Coord& goal)
+{
+	PROFILE_SCOPE("HierarchicalPathfinder::find_path");
+	update();
+	num_expanded = 0;
+	if (!grid.is_passable(start) || !grid.is_passable(goal))
+	{
+		return {};
+	}
+
+	const uint32_t start_cluster = get_cluster(start);
+	const uint32_t goal_cluster = get_cluster(goal);
+	// how start reaches the nodes of its cluster and how those of the goal's cluster reach the goal
+	start_search.run(grid, clusters[start_cluster], grid.get_index(start), false);
+	goal_search.run(grid, clusters[goal_cluster], grid.get_index(goal), true);
+	const NavGrid::Cost direct_cost = start_cluster == goal_cluster ? start_search.get_cost(grid, grid.get_index(goal)) : NO_COST;
+
+	std::vector<uint32_t> route;
+	NavGrid::Cost cost = NO_COST;
+	if (start_cluster == goal_cluster || !use_cached_route(start, goal, start_cluster, goal_cluster, route, cost))
+	{
+		if (!search_abstract(goal, start_cluster, goal_cluster, direct_cost, route, cost))
+		{
+			return {};
+		}
+		if (!route.empty() && start_cluster != goal_cluster)
+		{
+			cache_route(start, goal, start_cluster, goal_cluster, route, cost);
+		}
+	}
+
+	return refine(start, goal, route, cost);
+}
+
+bool HierarchicalPathfinder::search_abstract(const NavGrid::Coord& goal, uint32_t start_cluster, uint32_t goal_cluster, NavGrid::Cost direct_cost, std::vector<uint32_t>& route, NavGrid::Cost& cost)
+{
+	if (generations.size() != nodes.size())
+	{
+		g_scores.resize(nodes.size());
+		parents.resize(nodes.size());
+		generations.resize(nodes.size(), 0);
+		closed_generations.resize(nodes.size(), 0);
+	}
+	generation++;
+	if (generation == 0)
+	{
+		std::fill(generations.begin(), generations.end(), 0);
+		std::fill(closed_generations.begin(), closed_generations.end(), 0);
+		generation = 1;
+	}
+	open.clear();
+
+	auto get_heuristic = [&](uint32_t node)
+	{
+		return NavGrid::get_octile_distance(grid.get_coord(nodes[node].tile), goal);
+	};
+
+	// start isn't part of the graph, its cluster's nodes are seeded with their cost from it
+	for (const uint32_t node : clusters[start_cluster].nodes)
+	{
+		const NavGrid::Cost g = start_search.get_cost(grid, nodes[node].tile);
+		if (g != NO_COST)
+		{
+			g_scores[node] = g;
+			parents[node] = INVALID;
+			generations[node] = generation;
+			open.push_back(OpenNode{ g + get_heuristic(node), g, node });
+		}
+	}
+	std::make_heap(open.begin(), open.end());
+
+	// neither is goal, the best way onto it is tracked until nothing left open can beat it
+	NavGrid::Cost best_cost = direct_cost;
+	uint32_t best_last = INVALID;
+	while (!open.empty() && open.front().f < best_cost)
+	{
+		std::pop_heap(open.begin(), open.end());
+		const OpenNode top = open.back();
+		open.pop_back();
+		if (closed_generations[top.node] == generation)
+		{
+			continue;
+		}
+		closed_generations[top.node] = generation;
+		num_expanded++;
+
+		const Node& node = nodes[top.node];
+		if (node.cluster == goal_cluster)
+		{
+			const NavGrid::Cost to_goal = goal_search.get_cost(grid, node.tile);
+			if (to_goal != NO_COST && top.g + to_goal < best_cost)
+			{
+				best_cost = top.g + to_goal;
+				best_last = top.node;
+			}
+		}
+
+		auto relax = [&](const Edge& edge)
+		{
+			if (closed_generations[edge.to] == generation)
+			{
+				return;
+			}
+			const NavGrid::Cost g = top.g + edge.cost;
+			if (generations[edge.to] == generation && g >= g_scores[edge.to])
+			{
+				return;
+			}
+			generations[edge.to] = generation;
+			g_scores[edge.to] = g;
+			parents[edge.to] = top.node;
+			open.push_back(OpenNode{ g + get_heuristic(edge.to), g, edge.to });
+			std::push_heap(open.begin(), open.end());
+		};
+		for (const Edge& edge : node.intra_edges) relax(edge);
+		for (const Edge& edge : node.inter_edges) relax(edge);
+	}
+
+	if (best_cost == NO_COST)
+	{
+		return false;
+	}
+
+	// an empty route means start walks to the goal without leaving its cluster
+	route.clear();
+	for (uint32_t node = best_last; node != INVALID; node = parents[node])
+	{
+		route.push_back(node);
+	}
+	std::reverse(route.begin(), route.end());
+	cost = best_cost;
+
+	return true;
+}
+
+bool HierarchicalPathfinder::use_cached_route(const NavGrid::Coord& start, const NavGrid::Coord& goal, uint32_t start_cluster, uint32_t goal_cluster, std::vector<uint32_t>& route, NavGrid::Cost& cost)
+{
+	// join a cached route at whichever of its nodes in the start and goal clusters is cheapest for this start and goal
+	NavGrid::Cost best_cost = NO_COST;
+	std::list<CachedRoute>::iterator best_route;
+	size_t best_first = 0;
+	size_t best_last = 0;
+	const auto [begin, end] = cluster_pair_to_route.equal_range(get_cluster_pair_key(start_cluster, goal_cluster));
+	for (auto it = begin; it != end; ++it)
+	{
+		const CachedRoute& cached = *it->second;
+		for (size_t first = 0; first < cached.nodes.size() && nodes[cached.nodes[first]].cluster == start_cluster; first++)
+		{
+			const NavGrid::Cost from_start = start_search.get_cost(grid, nodes[cached.nodes[first]].tile);
+			if (from_start == NO_COST)
+			{
+				continue;
+			}
+			for (size_t last = cached.nodes.size(); last-- > first && nodes[cached.nodes[last]].cluster == goal_cluster;)
+			{
+				const NavGrid::Cost to_goal = goal_search.get_cost(grid, nodes[cached.nodes[last]].tile);
+				if (to_goal == NO_COST)
+				{
+					continue;
+				}
+				const NavGrid::Cost total = from_start + cached.costs[last] - cached.costs[first] + to_goal;
+				// the route may lead the wrong way for this start and goal, e.g. it came from the far side of a large start cluster
+				const bool is_direct = double(total) <= cached.detour * MAX_CACHED_DETOUR * double(NavGrid::get_octile_distance(start, goal));
+				if (is_direct && total < best_cost)
+				{
+					best_cost = total;
+					best_route = it->second;
+					best_first = first;
+					best_last = last;
+				}
+			}
+		}
+	}
+
+	if (best_cost == NO_COST)
+	{
+		// start or goal may also be walled off from the cached routes in another part of a split cluster
+		return false;
+	}
+
+	route.assign(best_route->nodes.begin() + best_first, best_route->nodes.begin() + best_last + 1);
+	cost = best_cost;
+	cache.splice(cache.begin(), cache, best_route);
+	num_cache_hits++;
+
+	return true;
+}
+
+std::list<HierarchicalPathfinder::CachedRoute>::iterator HierarchicalPathfinder::forget_route(std::list<CachedRoute>::iterator route)
+{
+	const auto [begin, end] = cluster_pair_to_route.equal_range(route->key);
+	cluster_pair_to_route.erase(std::find_if(begin, end, [&](const auto& entry) { return entry.second == route; }));
+	return cache.erase(route);
+}
+
+void HierarchicalPathfinder::cache_route(const NavGrid::Coord& start, const NavGrid::Coord& goal, uint32_t start_cluster, uint32_t goal_cluster, const std::vector<uint32_t>& route, NavGrid::Cost cost)
+{
+	if (cache_capacity == 0)
+	{
+		return;
+	}
+
+	// routes already cached for the pair are kept, they suit starts or goals in other parts of the clusters
+	const uint64_t key = get_cluster_pair_key(start_cluster, goal_cluster);
+	if (cache.size() >= cache_capacity)
+	{
+		forget_route(std::prev(cache.end()));
+	}
+
+	CachedRoute cached;
+	cached.key = key;
+	cached.detour = double(cost) / double(std::max<NavGrid::Cost>(NavGrid::get_octile_distance(start, goal), 1));
+	cached.nodes = route;
+	cached.costs.push_back(0);
+	for (size_t i = 1; i < route.size(); i++)
+	{
+		// consecutive nodes were linked by the cheapest edge between them
+		NavGrid::Cost edge_cost = NO_COST;
+		for (const auto* edges : { &nodes[route[i - 1]].intra_edges, &nodes[route[i - 1]].inter_edges })
+		{
+			for (const Edge& edge : *edges)
+			{
+				if (edge.to == route[i])
+				{
+					edge_cost = std::min(edge_cost, edge.cost);
+				}
+			}
+		}
+		cached.costs.push_back(cached.costs.back() + edge_cost);
+		cached.clusters.push_back(nodes[route[i]].cluster);
+	}
+	cached.clusters.push_back(nodes[route.front()].cluster);
+	std::sort(cached.clusters.begin(), cached.clusters.end());
+	cached.clusters.erase(std::unique(cached.clusters.begin(), cached.clusters.end()), cached.clusters.end());
+
+	cache.push_front(std::move(cached));
+	cluster_pair_to_route.emplace(key, cache.begin());
+}
+
+Path HierarchicalPathfinder::refine(const NavGrid::Coord& start, const NavGrid::Coord& goal, const std::vector<uint32_t>& route, NavGrid::Cost cost)
+{
+	Path path;
+	path.cost = NavGrid::to_tiles(cost);
+	const uint32_t start_tile = grid.get_index(start);
+	const uint32_t goal_tile = grid.get_index(goal);
+
+	// start to the first node, or straight to the goal
+	const uint32_t first_tile = route.empty() ? goal_tile : nodes[route.front()].tile;
+	for (uint32_t tile = first_tile; tile != start_tile; tile = start_search.get_parent(grid, tile))
+	{
+		path.tiles.push_back(grid.get_coord(tile));
+	}
+	path.tiles.push_back(start);
+	std::reverse(path.tiles.begin(), path.tiles.end());
+	if (route.empty())
+	{
+		return path;
+	}
+
+	for (size_t i = 1; i < route.size(); i++)
+	{
+		const Node& from = nodes[route[i - 1]];
+		const Node& to = nodes[route[i]];
+		if (from.cluster != to.cluster)
+		{
+			// across a border, the nodes are next to each other
+			path.tiles.push_back(grid.get_coord(to.tile));
+			continue;
+		}
+
+		refine_search.run(grid, clusters[from.cluster], from.tile, false, { to.tile });
+		const size_t segment_begin = path.tiles.size();
+		for (uint32_t tile = to.tile; tile != from.tile; tile = refine_search.get_parent(grid, tile))
+		{
+			path.tiles.push_back(grid.get_coord(tile));
+		}
+		std::reverse(path.tiles.begin() + segment_begin, path.tiles.end());
+	}
+
+	// the backward search from the goal leads every tile of its cluster towards it
+	for (uint32_t tile = nodes[route.back()].tile; tile != goal_tile;)
+	{
+		tile = goal_search.get_parent(grid, tile);
+		path.tiles.push_back(grid.get_coord(tile));
+	}
+
+	return path;
+}
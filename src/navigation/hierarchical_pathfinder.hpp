@@ -0,0 +1,180 @@
+#pragma once
+
+#include "nav_grid.hpp"
+#include "pathfinder.hpp"
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include <limits>
+
+
+//
+// hierarchical pathfinding over a NavGrid (HPA*) [Botea, Müller and Schaeffer 2004]
+//	the grid is split into square clusters, TileSet chunks when the grid comes from one,
+//	the open stretches along each border between two clusters become entrances with a node on either side,
+//	and the nodes of a cluster are linked by the cost of the best route between them inside the cluster
+//	a long query then searches this small abstract graph and only refines the route it finds into tiles
+//	the route can only cross borders at the entrances so it isn't optimal, with uniform costs it is within a few percent
+//	but on weighted maps the cheap tiles rarely line up with an entrance, routes average around 5% over the optimal cost
+//	and a single short route can be up to 1.5x, use Pathfinder when the exact cost matters
+//
+//	changing a tile only rebuilds its cluster's borders and the clusters next to them, on the next query
+//	routes between two clusters are cached, further units going between the same clusters only search their own cluster
+//
+class HierarchicalPathfinder
+{
+public:
+	static constexpr int DEFAULT_CLUSTER_SIZE = 32;
+	static constexpr size_t DEFAULT_CACHE_CAPACITY = 256;
+	// open border stretches at least this long get an entrance at both ends instead of one in the middle,
+	// and more between the ends so entrances are at most ENTRANCE_SPACING apart
+	static constexpr int LONG_ENTRANCE = 6;
+	static constexpr int ENTRANCE_SPACING = 8;
+	// how much less direct than the query that found it a cached route may be for another start and goal
+	static constexpr double MAX_CACHED_DETOUR = 1.1;
+
+	HierarchicalPathfinder(NavGrid& grid, int cluster_size = DEFAULT_CLUSTER_SIZE, size_t cache_capacity = DEFAULT_CACHE_CAPACITY);
+
+	// changes a tile so only the clusters around it have to be rebuilt
+	void set_cost(const NavGrid::Coord& coord, uint8_t cost);
+	// for tiles changed on the grid directly, changes that are not reported rebuild everything
+	void invalidate(const NavGrid::Coord& coord);
+
+	Path find_path(const NavGrid::Coord& start, const NavGrid::Coord& goal);
+
+	int get_cluster_size() const { return cluster_size; }
+	size_t get_num_nodes() const { return nodes.size() - free_nodes.size(); }
+	// abstract nodes taken off the open set by the last search
+	size_t get_num_expanded() const { return num_expanded; }
+	size_t get_num_cache_hits() const { return num_cache_hits; }
+	size_t get_cache_size() const { return cache.size(); }
+
+private:
+	static constexpr uint32_t INVALID = std::numeric_limits<uint32_t>::max();
+	static constexpr NavGrid::Cost NO_COST = std::numeric_limits<NavGrid::Cost>::max();
+
+	struct Edge
+	{
+		uint32_t to;
+		NavGrid::Cost cost;
+	};
+
+	struct Node
+	{
+		uint32_t tile = NavGrid::INVALID_INDEX;
+		uint32_t cluster = INVALID;
+		// number of border transitions using this node, it's freed at 0
+		uint32_t refs = 0;
+		std::vector<Edge> intra_edges;
+		std::vector<Edge> inter_edges;
+	};
+
+	// a node pair on either side of a border
+	struct Transition
+	{
+		uint32_t inside;
+		uint32_t outside;
+	};
+
+	struct Cluster
+	{
+		NavGrid::Coord min;
+		// inclusive
+		NavGrid::Coord max;
+		std::vector<uint32_t> nodes;
+		// borders shared with the cluster to the right and the one above
+		std::vector<Transition> right_border;
+		std::vector<Transition> up_border;
+		bool dirty = true;
+		bool intra_dirty = true;
+	};
+
+	// Dijkstra or A* confined to one cluster, costs and parents are indexed by the tile's position in the cluster
+	struct ClusterSearch
+	{
+		NavGrid::Coord min;
+		NavGrid::Coord max;
+		std::vector<NavGrid::Cost> costs;
+		std::vector<uint32_t> parents;
+		std::vector<uint8_t> is_target;
+		// (f, position in the cluster)
+		std::vector<std::pair<NavGrid::Cost, uint32_t>> open;
+
+		// backward searches give the cost from every tile to the source rather than the other way around,
+		// the search stops once all targets are settled, it's an A* for a single one and covers the cluster without any
+		void run(const NavGrid& grid, const Cluster& cluster, uint32_t source, bool backward, const std::vector<uint32_t>& targets = {});
+		uint32_t get_local(const NavGrid& grid, uint32_t tile) const;
+		NavGrid::Cost get_cost(const NavGrid& grid, uint32_t tile) const { return costs[get_local(grid, tile)]; }
+		// the tile the search came from, towards the source
+		uint32_t get_parent(const NavGrid& grid, uint32_t tile) const;
+	};
+
+	struct CachedRoute
+	{
+		uint64_t key;
+		std::vector<uint32_t> nodes;
+		// cost from nodes.front() to every node of the route
+		std::vector<NavGrid::Cost> costs;
+		// the clusters the route passes through, sorted
+		std::vector<uint32_t> clusters;
+		// cost over octile distance of the query that found it, a reuse that comes out much less direct searches instead
+		double detour;
+	};
+
+	struct OpenNode
+	{
+		NavGrid::Cost f;
+		NavGrid::Cost g;
+		uint32_t node;
+
+		bool operator<(const OpenNode& other) const
+		{
+			return f > other.f || (f == other.f && g < other.g);
+		}
+	};
+
+	uint32_t get_cluster(const NavGrid::Coord& coord) const;
+	void mark_dirty(const NavGrid::Coord& coord);
+	void update();
+	void rebuild_border(uint32_t cluster, bool up);
+	void rebuild_intra_edges(uint32_t cluster);
+	uint32_t acquire_node(uint32_t cluster, uint32_t tile);
+	void release_node(uint32_t node);
+
+	bool search_abstract(const NavGrid::Coord& goal, uint32_t start_cluster, uint32_t goal_cluster, NavGrid::Cost direct_cost, std::vector<uint32_t>& route, NavGrid::Cost& cost);
+	bool use_cached_route(const NavGrid::Coord& start, const NavGrid::Coord& goal, uint32_t start_cluster, uint32_t goal_cluster, std::vector<uint32_t>& route, NavGrid::Cost& cost);
+	std::list<CachedRoute>::iterator forget_route(std::list<CachedRoute>::iterator route);
+	void cache_route(const NavGrid::Coord& start, const NavGrid::Coord& goal, uint32_t start_cluster, uint32_t goal_cluster, const std::vector<uint32_t>& route, NavGrid::Cost cost);
+	Path refine(const NavGrid::Coord& start, const NavGrid::Coord& goal, const std::vector<uint32_t>& route, NavGrid::Cost cost);
+
+	NavGrid& grid;
+	int cluster_size;
+	NavGrid::Coord num_clusters;
+	std::vector<Cluster> clusters;
+	std::vector<Node> nodes;
+	std::vector<uint32_t> free_nodes;
+	std::vector<uint32_t> dirty_clusters;
+	// the grid version the graph was built for
+	uint64_t grid_version;
+
+	ClusterSearch start_search;
+	ClusterSearch goal_search;
+	ClusterSearch refine_search;
+
+	// abstract search state, reset per query with a generation counter
+	std::vector<NavGrid::Cost> g_scores;
+	std::vector<uint32_t> parents;
+	std::vector<uint32_t> generations;
+	std::vector<uint32_t> closed_generations;
+	uint32_t generation = 0;
+	std::vector<OpenNode> open;
+	size_t num_expanded = 0;
+
+	size_t cache_capacity;
+	size_t num_cache_hits = 0;
+	// most recently used first, a cluster pair can have several routes when the clusters are split by walls
+	std::list<CachedRoute> cache;
+	std::unordered_multimap<uint64_t, std::list<CachedRoute>::iterator> cluster_pair_to_route;
+};
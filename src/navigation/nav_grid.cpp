@@ -0,0 +1,41 @@
+#include "nav_grid.hpp"
+
+#include <glm/glm.hpp>
+
+#include <stdexcept>
+#include <algorithm>
+
+
+NavGrid::NavGrid(const Coord& origin, const Coord& size, uint8_t cost) :
+	origin(origin),
+	size(size)
+{
+	if (size.x <= 0 || size.y <= 0)
+	{
+		throw std::runtime_error("NavGrid::NavGrid: size must be positive");
+	}
+	costs.assign(size_t(size.x) * size_t(size.y), cost);
+}
+
+void NavGrid::set_cost(const Coord& coord, uint8_t cost)
+{
+	if (!contains(coord))
+	{
+		throw std::runtime_error("NavGrid::set_cost: coordinate is outside the grid");
+	}
+
+	uint8_t& current = costs[get_index(coord)];
+	if (current != cost)
+	{
+		current = cost;
+		version++;
+	}
+}
+
+NavGrid::Cost NavGrid::get_octile_distance(const Coord& from, const Coord& to)
+{
+	const Coord delta = glm::abs(to - from);
+	const Cost diagonal = Cost(std::min(delta.x, delta.y));
+	const Cost straight = Cost(std::max(delta.x, delta.y)) - diagonal;
+	return straight * STRAIGHT_STEP + diagonal * DIAGONAL_STEP;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+
+//
+// dense rectangle of movement costs that the pathfinders search over
+//	a cost of BLOCKED is impassable, otherwise entering a tile costs its cost times the step length,
+//	movement is 8-connected and diagonals may not cut the corner of a blocked tile
+//	step lengths are fixed point so sums are exact, equal paths then tie exactly and A* can break the ties consistently
+//
+class NavGrid
+{
+public:
+	using Coord = glm::ivec2;
+	// accumulated path cost in cost units, 64 bits as a winding path over a large expensive map overflows 32
+	using Cost = uint64_t;
+
+	static constexpr uint8_t BLOCKED = 0;
+	static constexpr uint8_t DEFAULT_COST = 1;
+	// step lengths in cost units, 1000 units is one tile
+	static constexpr uint32_t STRAIGHT_STEP = 1000;
+	static constexpr uint32_t DIAGONAL_STEP = 1414;
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+	NavGrid(const Coord& origin, const Coord& size, uint8_t cost = DEFAULT_COST);
+
+	const Coord& get_origin() const { return origin; }
+	const Coord& get_size() const { return size; }
+	uint32_t get_num_tiles() const { return uint32_t(costs.size()); }
+
+	bool contains(const Coord& coord) const
+	{
+		const Coord local = coord - origin;
+		return local.x >= 0 && local.y >= 0 && local.x < size.x && local.y < size.y;
+	}
+	uint32_t get_index(const Coord& coord) const
+	{
+		const Coord local = coord - origin;
+		return uint32_t(local.y) * uint32_t(size.x) + uint32_t(local.x);
+	}
+	Coord get_coord(uint32_t index) const
+	{
+		return origin + Coord(int(index % uint32_t(size.x)), int(index / uint32_t(size.x)));
+	}
+
+	// tiles outside the grid are blocked
+	uint8_t get_cost(const Coord& coord) const { return contains(coord) ? costs[get_index(coord)] : BLOCKED; }
+	uint8_t get_cost(uint32_t index) const { return costs[index]; }
+	bool is_passable(const Coord& coord) const { return get_cost(coord) != BLOCKED; }
+	void set_cost(const Coord& coord, uint8_t cost);
+
+	// bumped by every change to the costs, caches compare it to see whether they are stale
+	uint64_t get_version() const { return version; }
+
+	// calls func(neighbour_index, offset, step_length) for every tile reachable in one step from index,
+	// offset is the step from index to the neighbour and the length is in cost units
+	template<typename Func>
+	void for_each_neighbour(uint32_t index, Func&& func) const;
+
+	// octile distance in cost units, the exact cost between two tiles on an open grid of unit costs
+	static Cost get_octile_distance(const Coord& from, const Coord& to);
+	static float to_tiles(Cost cost) { return float(cost) / float(STRAIGHT_STEP); }
+
+private:
+	Coord origin;
+	Coord size;
+	std::vector<uint8_t> costs;
+	uint64_t version = 0;
+};
+
+template<typename Func>
+void NavGrid::for_each_neighbour(uint32_t index, Func&& func) const
+{
+	const Coord local = get_coord(index) - origin;
+	const int width = size.x;
+	const bool has_left = local.x > 0 && costs[index - 1] != BLOCKED;
+	const bool has_right = local.x < size.x - 1 && costs[index + 1] != BLOCKED;
+	const bool has_down = local.y > 0 && costs[index - width] != BLOCKED;
+	const bool has_up = local.y < size.y - 1 && costs[index + width] != BLOCKED;
+
+	if (has_right) func(index + 1, Coord(1, 0), STRAIGHT_STEP);
+	if (has_up) func(index + width, Coord(0, 1), STRAIGHT_STEP);
+	if (has_left) func(index - 1, Coord(-1, 0), STRAIGHT_STEP);
+	if (has_down) func(index - width, Coord(0, -1), STRAIGHT_STEP);
+
+	// diagonals need both of the tiles they squeeze between to be open
+	if (has_right && has_up && costs[index + width + 1] != BLOCKED) func(index + width + 1, Coord(1, 1), DIAGONAL_STEP);
+	if (has_left && has_up && costs[index + width - 1] != BLOCKED) func(index + width - 1, Coord(-1, 1), DIAGONAL_STEP);
+	if (has_left && has_down && costs[index - width - 1] != BLOCKED) func(index - width - 1, Coord(-1, -1), DIAGONAL_STEP);
+	if (has_right && has_down && costs[index - width + 1] != BLOCKED) func(index - width + 1, Coord(1, -1), DIAGONAL_STEP);
+}
@@ -0,0 +1,101 @@
+#include "pathfinder.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+
+
+void Pathfinder::reset(uint32_t num_tiles)
+{
+	if (generations.size() != num_tiles)
+	{
+		g_scores.assign(num_tiles, 0);
+		parents.assign(num_tiles, NavGrid::INVALID_INDEX);
+		generations.assign(num_tiles, 0);
+		closed_generations.assign(num_tiles, 0);
+		generation = 0;
+	}
+
+	generation++;
+	if (generation == 0)
+	{
+		// wrapped around, stale stamps could now look current
+		std::fill(generations.begin(), generations.end(), 0);
+		std::fill(closed_generations.begin(), closed_generations.end(), 0);
+		generation = 1;
+	}
+
+	open.clear();
+	num_expanded = 0;
+}
+
+Path Pathfinder::find_path(const NavGrid& grid, const NavGrid::Coord& start, const NavGrid::Coord& goal)
+{
+	PROFILE_SCOPE("Pathfinder::find_path");
+	reset(grid.get_num_tiles());
+	if (!grid.is_passable(start) || !grid.is_passable(goal))
+	{
+		return {};
+	}
+
+	const uint32_t start_index = grid.get_index(start);
+	const uint32_t goal_index = grid.get_index(goal);
+	g_scores[start_index] = 0;
+	parents[start_index] = NavGrid::INVALID_INDEX;
+	generations[start_index] = generation;
+	open.push_back(OpenNode{ NavGrid::get_octile_distance(start, goal), 0, start_index });
+
+	while (!open.empty())
+	{
+		std::pop_heap(open.begin(), open.end());
+		const OpenNode node = open.back();
+		open.pop_back();
+		if (is_closed(node.index))
+		{
+			// a stale entry, the tile was reached more cheaply after this was pushed
+			continue;
+		}
+		set_closed(node.index);
+		num_expanded++;
+
+		if (node.index == goal_index)
+		{
+			break;
+		}
+
+		const NavGrid::Coord coord = grid.get_coord(node.index);
+		grid.for_each_neighbour(node.index, [&](uint32_t neighbour, const NavGrid::Coord& offset, uint32_t step_length)
+		{
+			if (is_closed(neighbour))
+			{
+				return;
+			}
+
+			const NavGrid::Cost g = node.g + NavGrid::Cost(step_length) * grid.get_cost(neighbour);
+			if (generations[neighbour] == generation && g >= g_scores[neighbour])
+			{
+				return;
+			}
+
+			generations[neighbour] = generation;
+			g_scores[neighbour] = g;
+			parents[neighbour] = node.index;
+			open.push_back(OpenNode{ g + NavGrid::get_octile_distance(coord + offset, goal), g, neighbour });
+			std::push_heap(open.begin(), open.end());
+		});
+	}
+
+	if (!is_closed(goal_index))
+	{
+		return {};
+	}
+
+	Path path;
+	path.cost = NavGrid::to_tiles(g_scores[goal_index]);
+	for (uint32_t index = goal_index; index != NavGrid::INVALID_INDEX; index = parents[index])
+	{
+		path.tiles.push_back(grid.get_coord(index));
+	}
+	std::reverse(path.tiles.begin(), path.tiles.end());
+
+	return path;
+}
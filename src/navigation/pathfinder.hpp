@@ -0,0 +1,61 @@
+#pragma once
+
+#include "nav_grid.hpp"
+
+#include <vector>
+#include <cstdint>
+
+
+// a route between two tiles, empty when there is none
+struct Path
+{
+	// from the start to the goal, both included
+	std::vector<NavGrid::Coord> tiles;
+	// in tiles, i.e. a straight step onto a tile of cost 1 adds 1
+	float cost = 0.0f;
+
+	bool found() const { return !tiles.empty(); }
+};
+
+//
+// A* over a NavGrid [Hart, Nilsson and Raphael 1968]
+//	the open set is a binary heap with lazy deletion, the closed set is a generation stamp per tile,
+//	the octile heuristic is exact on open ground so only tiles around obstacles get expanded
+//	the search buffers are kept between queries and reset in O(1) with a generation counter,
+//	so a pathfinder should be reused but not shared between threads
+//
+class Pathfinder
+{
+public:
+	Path find_path(const NavGrid& grid, const NavGrid::Coord& start, const NavGrid::Coord& goal);
+
+	// tiles taken off the open set by the last search
+	size_t get_num_expanded() const { return num_expanded; }
+
+private:
+	struct OpenNode
+	{
+		NavGrid::Cost f;
+		NavGrid::Cost g;
+		uint32_t index;
+
+		// std heaps are max heaps, lower f first and on ties the deeper node as it's closer to the goal
+		bool operator<(const OpenNode& other) const
+		{
+			return f > other.f || (f == other.f && g < other.g);
+		}
+	};
+
+	void reset(uint32_t num_tiles);
+	bool is_closed(uint32_t index) const { return closed_generations[index] == generation; }
+	void set_closed(uint32_t index) { closed_generations[index] = generation; }
+
+	std::vector<OpenNode> open;
+	std::vector<NavGrid::Cost> g_scores;
+	std::vector<uint32_t> parents;
+	// g_scores and parents are only valid where this matches the current generation
+	std::vector<uint32_t> generations;
+	std::vector<uint32_t> closed_generations;
+	uint32_t generation = 0;
+	size_t num_expanded = 0;
+};
@@ -80,6 +80,8 @@ void Object::set_transform(const glm::mat4& transform)
 		// transform doesn't get overwritten on next sync
 		relative_transform.set_mat4(glm::inverse(parent->get_transform()) * world_transform.get_mat4());
 	}
+
+	on_moved();
 }
 
 void Object::set_position(const glm::vec3& position)
@@ -93,6 +95,8 @@ void Object::set_position(const glm::vec3& position)
 		// transform doesn't get overwritten on next sync
 		relative_transform.set_mat4(glm::inverse(parent->get_transform()) * world_transform.get_mat4());
 	}
+
+	on_moved();
 }
 
 void Object::set_scale(const glm::vec3& scale)
@@ -106,6 +110,8 @@ void Object::set_scale(const glm::vec3& scale)
 		// transform doesn't get overwritten on next sync
 		relative_transform.set_mat4(glm::inverse(parent->get_transform()) * world_transform.get_mat4());
 	}
+
+	on_moved();
 }
 
 void Object::set_rotation(const glm::quat& rotation)
@@ -119,6 +125,8 @@ void Object::set_rotation(const glm::quat& rotation)
 		// transform doesn't get overwritten on next sync
 		relative_transform.set_mat4(glm::inverse(parent->get_transform()) * world_transform.get_mat4());
 	}
+
+	on_moved();
 }
 
 glm::mat4 Object::get_relative_transform() const
@@ -144,21 +152,39 @@ glm::quat Object::get_relative_rotation() const
 void Object::set_relative_transform(const glm::mat4& transform)
 {
 	relative_transform.set_mat4(transform);
+	on_moved();
 }
 
 void Object::set_relative_position(const glm::vec3& position)
 {
 	relative_transform.set_pos(position);
+	on_moved();
 }
 
 void Object::set_relative_scale(const glm::vec3& scale)
 {
 	relative_transform.set_scale(scale);
+	on_moved();
 }
 
 void Object::set_relative_rotation(const glm::quat& rotation)
 {
 	relative_transform.set_orient(rotation);
+	on_moved();
+}
+
+void Object::on_moved()
+{
+	if (moved_objects && !is_move_queued)
+	{
+		is_move_queued = true;
+		moved_objects->push_back(id);
+	}
+
+	for (auto& [child_id, child] : children)
+	{
+		child->on_moved();
+	}
 }
 
 void Object::detach_from()
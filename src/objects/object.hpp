@@ -75,6 +75,15 @@ public:
 	AABB get_aabb() const { return aabb; }
 	void set_aabb(const AABB& aabb) { this->aabb = aabb; }
 
+	// while tracked the id is queued once whenever the world transform changes, until the queued flag is
+	// cleared, used by SpatialSystem so that only the objects that moved are looked at
+	void track_moves(std::vector<ObjectID>* moved_objects) const
+	{
+		this->moved_objects = moved_objects;
+		is_move_queued = false;
+	}
+	void clear_move_queued() const { is_move_queued = false; }
+
 protected:
 	std::map<ObjectID, Object*> children;
 	Object* parent = nullptr;
@@ -97,8 +106,13 @@ private:
 	// when relative_transform updates then world transform will be outdated
 	// mutable bool bIsWorldTransformOld = false;
 	void sync_world_from_relative() const;
+	// queues this object and its children, whose world transforms follow it, see track_moves
+	void on_moved();
 	std::string name;
 
+	mutable std::vector<ObjectID>* moved_objects = nullptr;
+	mutable bool is_move_queued = false;
+
 	AABB aabb;
 	Maths::Sphere bounding_sphere;
 
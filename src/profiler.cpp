@@ -0,0 +1,299 @@
+#include "profiler.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+
+namespace
+{
+	struct ThreadBuffer
+	{
+		// power of two so the ring index is a mask
+		static constexpr uint64_t ZONE_CAPACITY = 1 << 14;
+		static constexpr uint64_t FRAME_CAPACITY = 1 << 8;
+
+		// written only by the owning thread, readers validate against the write counters afterwards
+		std::array<Profiler::Zone, ZONE_CAPACITY> zones;
+		std::atomic<uint64_t> zone_count = 0;
+		std::array<uint64_t, FRAME_CAPACITY> frame_begins;
+		std::atomic<uint64_t> frame_count = 0;
+
+		uint32_t depth = 0;
+		uint32_t thread_id = 0;
+
+		// name is only touched under the registry mutex
+		std::string thread_name;
+	};
+
+	struct Registry
+	{
+		std::mutex mutex;
+		// buffers outlive their threads so that zones can still be exported after a thread joins
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+		std::atomic<bool> enabled = true;
+		const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	};
+
+	Registry& get_registry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	ThreadBuffer& get_thread_buffer()
+	{
+		thread_local ThreadBuffer* buffer = nullptr;
+		if (!buffer)
+		{
+			auto& registry = get_registry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+			buffer = registry.buffers.back().get();
+			buffer->thread_id = static_cast<uint32_t>(registry.buffers.size());
+			buffer->thread_name = fmt::format("thread {}", buffer->thread_id);
+		}
+
+		return *buffer;
+	}
+
+	// the oldest ring entry that is intact given the write count, the writer may already be
+	// overwriting the entry before it
+	uint64_t first_intact(uint64_t count, uint64_t capacity)
+	{
+		return count >= capacity ? count - capacity + 1 : 0;
+	}
+
+	// seqlock-style validation, must be called after the entries have been copied out of the ring,
+	// entries older than the returned index may have been overwritten while they were being copied
+	uint64_t validate_ring(const std::atomic<uint64_t>& count, uint64_t capacity)
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return first_intact(count.load(std::memory_order_relaxed), capacity);
+	}
+
+	// copies the entries of a ring that have not been overwritten by the time the copy finishes,
+	// first_index is set to the write index of the first returned entry
+	template<typename T, size_t Capacity>
+	std::vector<T> copy_ring(const std::array<T, Capacity>& ring, const std::atomic<uint64_t>& count, uint64_t& first_index)
+	{
+		const uint64_t last = count.load(std::memory_order_acquire);
+		const uint64_t first = first_intact(last, Capacity);
+		std::vector<T> entries;
+		entries.reserve(last - first);
+		for (uint64_t i = first; i < last; i++)
+		{
+			entries.push_back(ring[i & (Capacity - 1)]);
+		}
+
+		first_index = std::max(first, validate_ring(count, Capacity));
+		entries.erase(entries.begin(), entries.begin() + std::min<uint64_t>(first_index - first, entries.size()));
+
+		return entries;
+	}
+
+	void append_escaped(std::string& out, const char* str)
+	{
+		for (; *str; str++)
+		{
+			if (*str == '"' || *str == '\\')
+			{
+				out += '\\';
+			}
+			out += *str;
+		}
+	}
+}
+
+Profiler::ScopedZone::ScopedZone(const char* name) :
+	name(get_registry().enabled.load(std::memory_order_relaxed) ? name : nullptr),
+	begin_ns(0)
+{
+	if (!this->name)
+	{
+		return;
+	}
+
+	get_thread_buffer().depth++;
+	begin_ns = now_ns();
+}
+
+Profiler::ScopedZone::~ScopedZone()
+{
+	if (!name)
+	{
+		return;
+	}
+
+	const uint64_t end_ns = now_ns();
+	ThreadBuffer& buffer = get_thread_buffer();
+	buffer.depth--;
+	const uint64_t idx = buffer.zone_count.load(std::memory_order_relaxed);
+	buffer.zones[idx & (ThreadBuffer::ZONE_CAPACITY - 1)] = Zone{ name, begin_ns, end_ns, buffer.depth };
+	buffer.zone_count.store(idx + 1, std::memory_order_release);
+}
+
+void Profiler::set_enabled(bool enabled)
+{
+	get_registry().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::is_enabled()
+{
+	return get_registry().enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::set_thread_name(const std::string& name)
+{
+	ThreadBuffer& buffer = get_thread_buffer();
+	std::lock_guard<std::mutex> lock(get_registry().mutex);
+	buffer.thread_name = name;
+}
+
+void Profiler::mark_frame()
+{
+	if (!is_enabled())
+	{
+		return;
+	}
+
+	ThreadBuffer& buffer = get_thread_buffer();
+	const uint64_t idx = buffer.frame_count.load(std::memory_order_relaxed);
+	buffer.frame_begins[idx & (ThreadBuffer::FRAME_CAPACITY - 1)] = now_ns();
+	buffer.frame_count.store(idx + 1, std::memory_order_release);
+}
+
+uint64_t Profiler::now_ns()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - get_registry().epoch).count());
+}
+
+std::vector<Profiler::FrameTimeline> Profiler::get_last_frames()
+{
+	auto& registry = get_registry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	std::vector<FrameTimeline> timelines;
+	for (const auto& buffer : registry.buffers)
+	{
+		// a frame is only complete once the next one has been marked
+		const uint64_t frame_count = buffer->frame_count.load(std::memory_order_acquire);
+		if (frame_count < 2)
+		{
+			continue;
+		}
+
+		FrameTimeline timeline;
+		timeline.thread_name = buffer->thread_name;
+		timeline.thread_id = buffer->thread_id;
+		timeline.frame_begin_ns = buffer->frame_begins[(frame_count - 2) & (ThreadBuffer::FRAME_CAPACITY - 1)];
+		timeline.frame_end_ns = buffer->frame_begins[(frame_count - 1) & (ThreadBuffer::FRAME_CAPACITY - 1)];
+		if (validate_ring(buffer->frame_count, ThreadBuffer::FRAME_CAPACITY) > frame_count - 2)
+		{
+			continue;
+		}
+
+		// zones are recorded in order of completion so we only need to scan back to the start of the frame,
+		// the zones are copied before being looked at since the owning thread may be overwriting them
+		const uint64_t last = buffer->zone_count.load(std::memory_order_acquire);
+		const uint64_t first = first_intact(last, ThreadBuffer::ZONE_CAPACITY);
+		std::vector<uint64_t> zone_indices;
+		for (uint64_t i = last; i > first; i--)
+		{
+			const Zone zone = buffer->zones[(i - 1) & (ThreadBuffer::ZONE_CAPACITY - 1)];
+			if (zone.end_ns < timeline.frame_begin_ns)
+			{
+				break;
+			}
+			if (zone.begin_ns <= timeline.frame_end_ns)
+			{
+				timeline.zones.push_back(zone);
+				zone_indices.push_back(i - 1);
+			}
+		}
+
+		// the zones were gathered newest first so the overwritten ones are at the back
+		const uint64_t first_valid = validate_ring(buffer->zone_count, ThreadBuffer::ZONE_CAPACITY);
+		while (!zone_indices.empty() && zone_indices.back() < first_valid)
+		{
+			zone_indices.pop_back();
+			timeline.zones.pop_back();
+		}
+		std::ranges::sort(timeline.zones, [](const Zone& a, const Zone& b) { return a.begin_ns < b.begin_ns; });
+
+		timelines.push_back(std::move(timeline));
+	}
+
+	return timelines;
+}
+
+std::string Profiler::to_chrome_trace()
+{
+	auto& registry = get_registry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first_event = true;
+	const auto begin_event = [&]()
+	{
+		if (!first_event)
+		{
+			out += ",\n";
+		}
+		first_event = false;
+	};
+
+	for (const auto& buffer : registry.buffers)
+	{
+		begin_event();
+		out += fmt::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"", buffer->thread_id);
+		append_escaped(out, buffer->thread_name.c_str());
+		out += "\"}}";
+
+		// timestamps are in microseconds
+		uint64_t first_zone = 0;
+		for (const Zone& zone : copy_ring(buffer->zones, buffer->zone_count, first_zone))
+		{
+			begin_event();
+			out += "{\"name\":\"";
+			append_escaped(out, zone.name);
+			out += fmt::format("\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"depth\":{}}}}}",
+				buffer->thread_id,
+				zone.begin_ns * 1e-3,
+				(zone.end_ns - zone.begin_ns) * 1e-3,
+				zone.depth);
+		}
+
+		uint64_t first_frame = 0;
+		const auto frame_begins = copy_ring(buffer->frame_begins, buffer->frame_count, first_frame);
+		for (uint64_t i = 0; i < frame_begins.size(); i++)
+		{
+			begin_event();
+			out += fmt::format("{{\"name\":\"frame {}\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":{},\"ts\":{:.3f}}}",
+				first_frame + i,
+				buffer->thread_id,
+				frame_begins[i] * 1e-3);
+		}
+	}
+	out += "]}\n";
+
+	return out;
+}
+
+void Profiler::write_chrome_trace(const std::filesystem::path& path)
+{
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if (!file)
+	{
+		throw std::runtime_error("Profiler::write_chrome_trace: failed to open " + path.string());
+	}
+	file << to_chrome_trace();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+
+//
+// Scoped-zone frame profiler
+//	* each thread records into its own ring buffer, recording never takes a lock
+//	* zones nest, the depth is tracked per thread
+//	* Profiler::mark_frame delimits frames per thread (i.e. one GameEngine tick, one GraphicsEngine frame)
+//	* output can be exported as Chrome trace / Perfetto JSON (chrome://tracing or ui.perfetto.dev)
+//
+// Zone names must have static storage duration (i.e. string literals), only the pointer is stored
+//
+class Profiler
+{
+public:
+	struct Zone
+	{
+		const char* name;
+		uint64_t begin_ns;
+		uint64_t end_ns;
+		uint32_t depth;
+	};
+
+	// zones that overlap the last completed frame of a thread
+	struct FrameTimeline
+	{
+		std::string thread_name;
+		uint32_t thread_id;
+		uint64_t frame_begin_ns;
+		uint64_t frame_end_ns;
+		std::vector<Zone> zones;
+	};
+
+	// RAII zone, prefer PROFILE_SCOPE
+	class ScopedZone
+	{
+	public:
+		ScopedZone(const char* name);
+		~ScopedZone();
+
+		ScopedZone(const ScopedZone&) = delete;
+		ScopedZone& operator=(const ScopedZone&) = delete;
+
+	private:
+		const char* name;
+		uint64_t begin_ns;
+	};
+
+public:
+	static void set_enabled(bool enabled);
+	static bool is_enabled();
+
+	// name shown in the trace for the calling thread
+	static void set_thread_name(const std::string& name);
+
+	// marks the beginning of a new frame on the calling thread
+	static void mark_frame();
+
+	// nanoseconds since the profiler epoch (steady_clock)
+	static uint64_t now_ns();
+
+	// one timeline per thread that has completed at least one frame
+	static std::vector<FrameTimeline> get_last_frames();
+
+	// all zones currently held in the per thread buffers in Chrome trace event format
+	static std::string to_chrome_trace();
+	static void write_chrome_trace(const std::filesystem::path& path);
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) Profiler::ScopedZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
@@ -2,13 +2,28 @@
 
 #include "shared_data_structures.hpp"
 #include "identifications.hpp"
+#include "mesh_optimizer.hpp"
+#include "vertex_quantization.hpp"
+#include "mesh_simplifier.hpp"
 
 #include <glm/glm.hpp>
 
 #include <vector>
 #include <memory>
+#include <limits>
+#include <cstring>
+#include <algorithm>
 
 
+// a detail level, a range of the mesh's index buffer that draws from the same vertices
+struct MeshLod
+{
+	uint32_t first_index = 0;
+	uint32_t num_indices = 0;
+	// geometric deviation relative to the bounding radius, see MeshSimplifier
+	float error = 0.0f;
+};
+
 struct Mesh 
 {
 public:
@@ -16,20 +31,92 @@ public:
 	MeshID get_id() const { return id; }
 
 	const std::vector<uint32_t>& get_indices() const { return indices; }
-	void set_indices(std::vector<uint32_t>&& indices) { this->indices = std::move(indices); }
+	void set_indices(std::vector<uint32_t>&& indices) { this->indices = std::move(indices); clear_lods(); }
 
 	virtual uint32_t get_num_unique_vertices() const = 0;
 	virtual uint32_t get_num_vertex_indices() const { return static_cast<uint32_t>(indices.size()); };
+	float get_bounding_radius() const { return bounding_radius; }
+
+	//
+	// LODs
+	//	LOD 0 is the mesh itself, the coarser levels are appended after it in the index buffer
+	//
+
+	uint32_t get_num_lods() const { return static_cast<uint32_t>(lods.size()) + 1; }
+	MeshLod get_lod(uint32_t lod) const
+	{
+		return lod == 0 ? MeshLod{ 0, static_cast<uint32_t>(indices.size()), 0.0f } : lods[lod - 1];
+	}
+	// must be called after optimize() since it reorders the vertices
+	virtual void generate_lods() = 0;
+
+	//
+	// GPU representation
+	//	vertices are quantised, see VertexQuantization
+	//	indices are 16 bit whenever every vertex can be addressed by one
+	//
+
+	bool has_16bit_indices() const { return get_num_unique_vertices() <= std::numeric_limits<uint16_t>::max() + 1u; }
+	size_t get_index_size() const { return has_16bit_indices() ? sizeof(uint16_t) : sizeof(uint32_t); }
+
+	virtual size_t get_packed_vertices_data_size() const = 0;
+	// every packed vertex type starts with its position as 3 floats
+	virtual size_t get_packed_vertex_size() const = 0;
+	size_t get_packed_indices_data_size() const { return (indices.size() + lod_indices.size()) * get_index_size(); }
+
+	// destination must have room for get_packed_*_data_size() bytes
+	virtual void write_packed_vertices(std::byte* destination) const = 0;
+	void write_packed_indices(std::byte* destination) const
+	{
+		if (!has_16bit_indices())
+		{
+			std::memcpy(destination, indices.data(), indices.size() * sizeof(uint32_t));
+			std::memcpy(destination + indices.size() * sizeof(uint32_t), lod_indices.data(), lod_indices.size() * sizeof(uint32_t));
+			return;
+		}
+
+		uint16_t* destination_u16 = reinterpret_cast<uint16_t*>(destination);
+		for (const uint32_t index : indices)
+		{
+			*destination_u16++ = static_cast<uint16_t>(index);
+		}
+		for (const uint32_t index : lod_indices)
+		{
+			*destination_u16++ = static_cast<uint16_t>(index);
+		}
+	}
+
+	// reorders/deduplicates vertices and indices for the GPU, see MeshOptimizer
+	virtual MeshOptimizer::Stats optimize() = 0;
+
+protected:
+	void clear_lods()
+	{
+		lods.clear();
+		lod_indices.clear();
+	}
 
-	virtual const std::byte* get_vertices_data() const = 0;
-	const std::byte* get_indices_data() const { return reinterpret_cast<const std::byte*>(indices.data()); }
-	virtual size_t get_vertices_data_size() const = 0;
-	size_t get_indices_data_size() const { return indices.size() * sizeof(uint32_t); }
+	void set_lods(std::vector<MeshSimplifier::Lod>&& chain)
+	{
+		clear_lods();
+		for (auto& lod : chain)
+		{
+			lods.push_back(MeshLod{
+				static_cast<uint32_t>(indices.size() + lod_indices.size()),
+				static_cast<uint32_t>(lod.indices.size()),
+				lod.error });
+			lod_indices.insert(lod_indices.end(), lod.indices.begin(), lod.indices.end());
+		}
+	}
 
 protected:
 	std::vector<uint32_t> indices;
+	float bounding_radius = 0.0f;
 
 private:
+	// LOD 1.. indices, concatenated
+	std::vector<uint32_t> lod_indices;
+	std::vector<MeshLod> lods;
 	const MeshID id = MeshID::generate_new_id();
 };
 
@@ -38,17 +125,20 @@ struct DerivedMesh : public Mesh
 {
 public:
 	using VertexType = VertexType_;
+	using PackedVertexType = VertexQuantization::PackedVertex<VertexType_>;
 
 	// DerivedMesh() = default;
 	DerivedMesh(const std::vector<VertexType_>& vertices, const std::vector<uint32_t>& indices) : 
 		vertices(vertices)
 	{
 		this->indices = indices;
+		compute_bounding_radius();
 	}
 	DerivedMesh(std::vector<VertexType_>&& vertices, std::vector<uint32_t>&& indices) : 
 		vertices(std::move(vertices))
 	{
 		this->indices = std::move(indices);
+		compute_bounding_radius();
 	}
 	DerivedMesh(const DerivedMesh& mesh) = delete;
 	DerivedMesh& operator=(const DerivedMesh& mesh) = default;
@@ -56,8 +146,34 @@ public:
 
 	virtual uint32_t get_num_unique_vertices() const override { return static_cast<uint32_t>(vertices.size()); }
 	const std::vector<VertexType_>& get_vertices() const { return vertices; }
-	virtual const std::byte* get_vertices_data() const override { return reinterpret_cast<const std::byte*>(vertices.data()); }
-	virtual size_t get_vertices_data_size() const override { return vertices.size() * sizeof(VertexType_); }
+	virtual size_t get_packed_vertices_data_size() const override { return vertices.size() * sizeof(PackedVertexType); }
+	virtual size_t get_packed_vertex_size() const override { return sizeof(PackedVertexType); }
+	virtual void write_packed_vertices(std::byte* destination) const override
+	{
+		PackedVertexType* packed_vertices = reinterpret_cast<PackedVertexType*>(destination);
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			packed_vertices[i] = VertexQuantization::pack(vertices[i]);
+		}
+	}
+
+	virtual MeshOptimizer::Stats optimize() override
+	{
+		clear_lods();
+		return MeshOptimizer::optimize(vertices, indices);
+	}
+
+	virtual void generate_lods() override { set_lods(MeshSimplifier::generate_lod_chain(vertices, indices)); }
+
+private:
+	void compute_bounding_radius()
+	{
+		bounding_radius = 0.0f;
+		for (const auto& vertex : vertices)
+		{
+			bounding_radius = std::max(bounding_radius, glm::length(vertex.pos));
+		}
+	}
 
 private:
 	std::vector<VertexType_> vertices;
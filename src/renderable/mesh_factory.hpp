@@ -49,6 +49,7 @@ public:
 	static MeshPtr arc(uint32_t nSegments = 10, float outer_radius = 1.0f, float inner_radius = 0.8f);
 
 private:
+	static MeshPtr optimized(MeshPtr mesh);
 	static MeshPtr generate_uv_sphere(int nVertices);
 	static MeshPtr generate_ico_sphere(int nVertices);
 };
\ No newline at end of file
@@ -0,0 +1,611 @@
+#include "mesh_optimizer.hpp"
+#include "shared_data_structures.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <limits>
+#include <cassert>
+#include <cmath>
+
+
+namespace
+{
+	// a vertex is cached if it was one of the last cache_size vertices to be inserted
+	class FifoCache
+	{
+	public:
+		FifoCache(uint32_t num_vertices, uint32_t cache_size) :
+			timestamps(num_vertices, 0),
+			cache_size(cache_size),
+			time(cache_size + 1)
+		{
+		}
+
+		// returns true on a miss
+		bool access(uint32_t vertex)
+		{
+			if (time - timestamps[vertex] > cache_size)
+			{
+				timestamps[vertex] = time++;
+				return true;
+			}
+
+			return false;
+		}
+
+		// evicts every vertex
+		void reset()
+		{
+			time += cache_size + 1;
+		}
+
+	private:
+		std::vector<uint32_t> timestamps;
+		const uint32_t cache_size;
+		uint32_t time;
+	};
+
+	// compressed vertex -> triangle adjacency
+	struct Adjacency
+	{
+		Adjacency(const std::vector<uint32_t>& indices, uint32_t num_vertices) :
+			counts(num_vertices, 0),
+			offsets(num_vertices + 1, 0),
+			triangles(indices.size())
+		{
+			for (const uint32_t index : indices)
+			{
+				counts[index]++;
+			}
+			std::inclusive_scan(counts.begin(), counts.end(), offsets.begin() + 1);
+
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (uint32_t i = 0; i < indices.size(); i++)
+			{
+				triangles[fill[indices[i]]++] = i / 3;
+			}
+		}
+
+		std::vector<uint32_t> counts;
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+	};
+
+	// depth buffered orthographic rasteriser for analyze_overdraw
+	class OverdrawRasterizer
+	{
+	public:
+		static constexpr uint32_t VIEWPORT_SIZE = 256;
+
+		OverdrawRasterizer() :
+			depth_buffer(VIEWPORT_SIZE * VIEWPORT_SIZE)
+		{
+		}
+
+		void clear()
+		{
+			std::ranges::fill(depth_buffer, std::numeric_limits<float>::max());
+		}
+
+		// the vertices are in pixel coordinates with the depth in z, smaller is closer
+		void draw_triangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2)
+		{
+			float area = edge(v0, v1, v2);
+			if (area == 0.0f)
+			{
+				return;
+			}
+			if (area < 0.0f)
+			{
+				std::swap(v1, v2);
+				area = -area;
+			}
+
+			const int min_x = std::max(int(std::floor(std::min({ v0.x, v1.x, v2.x }))), 0);
+			const int min_y = std::max(int(std::floor(std::min({ v0.y, v1.y, v2.y }))), 0);
+			const int max_x = std::min(int(std::ceil(std::max({ v0.x, v1.x, v2.x }))), int(VIEWPORT_SIZE) - 1);
+			const int max_y = std::min(int(std::ceil(std::max({ v0.y, v1.y, v2.y }))), int(VIEWPORT_SIZE) - 1);
+			for (int y = min_y; y <= max_y; y++)
+			{
+				for (int x = min_x; x <= max_x; x++)
+				{
+					const glm::vec3 pixel(float(x) + 0.5f, float(y) + 0.5f, 0.0f);
+					const float w0 = edge(v1, v2, pixel);
+					const float w1 = edge(v2, v0, pixel);
+					const float w2 = edge(v0, v1, pixel);
+					// pixels on an edge shared by two triangles must only be drawn once
+					if (!is_inside(w0, v1, v2) || !is_inside(w1, v2, v0) || !is_inside(w2, v0, v1))
+					{
+						continue;
+					}
+
+					const float depth = (w0 * v0.z + w1 * v1.z + w2 * v2.z) / area;
+					float& stored_depth = depth_buffer[y * VIEWPORT_SIZE + x];
+					if (depth < stored_depth)
+					{
+						covered += stored_depth == std::numeric_limits<float>::max();
+						stored_depth = depth;
+						shaded++;
+					}
+				}
+			}
+		}
+
+		uint32_t covered = 0;
+		uint32_t shaded = 0;
+
+	private:
+		static float edge(const glm::vec3& a, const glm::vec3& b, const glm::vec3& p)
+		{
+			return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+		}
+
+		// top-left fill rule, the triangle is counter-clockwise with y pointing up
+		static bool is_inside(float w, const glm::vec3& a, const glm::vec3& b)
+		{
+			if (w != 0.0f)
+			{
+				return w > 0.0f;
+			}
+			return (a.y == b.y && b.x < a.x) || b.y < a.y;
+		}
+
+		std::vector<float> depth_buffer;
+	};
+
+	MeshOptimizer::OverdrawStats rasterize_overdraw(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices)
+	{
+		MeshOptimizer::OverdrawStats stats;
+		if (indices.empty())
+		{
+			return stats;
+		}
+
+		glm::vec3 min(std::numeric_limits<float>::max());
+		glm::vec3 max(-std::numeric_limits<float>::max());
+		for (const uint32_t index : indices)
+		{
+			min = glm::min(min, positions[index]);
+			max = glm::max(max, positions[index]);
+		}
+		const glm::vec3 extent = max - min;
+		const float scale = float(OverdrawRasterizer::VIEWPORT_SIZE) / std::max({ extent.x, extent.y, extent.z, 1e-6f });
+
+		OverdrawRasterizer rasterizer;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			for (const float direction : { 1.0f, -1.0f })
+			{
+				// looking down -direction along the axis, the other two axes span the viewport
+				const int u_axis = (axis + 1) % 3;
+				const int v_axis = (axis + 2) % 3;
+				const auto to_viewport = [&](const glm::vec3& pos)
+				{
+					const glm::vec3 local = (pos - min) * scale;
+					return glm::vec3(local[u_axis], local[v_axis], -direction * local[axis]);
+				};
+
+				rasterizer.clear();
+				for (uint32_t i = 0; i < indices.size(); i += 3)
+				{
+					const glm::vec3& p0 = positions[indices[i]];
+					const glm::vec3& p1 = positions[indices[i + 1]];
+					const glm::vec3& p2 = positions[indices[i + 2]];
+					if (glm::cross(p1 - p0, p2 - p0)[axis] * direction <= 0.0f)
+					{
+						continue;
+					}
+					rasterizer.draw_triangle(to_viewport(p0), to_viewport(p1), to_viewport(p2));
+				}
+			}
+		}
+
+		stats.pixels_covered = rasterizer.covered;
+		stats.pixels_shaded = rasterizer.shaded;
+		stats.overdraw = stats.pixels_covered > 0 ? float(stats.pixels_shaded) / float(stats.pixels_covered) : 0.0f;
+
+		return stats;
+	}
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::analyze_vertex_cache(
+	const std::vector<uint32_t>& indices,
+	uint32_t num_vertices,
+	uint32_t cache_size)
+{
+	VertexCacheStats stats;
+	if (indices.empty() || num_vertices == 0)
+	{
+		return stats;
+	}
+
+	FifoCache cache(num_vertices, cache_size);
+	for (const uint32_t index : indices)
+	{
+		stats.cache_misses += cache.access(index);
+	}
+
+	stats.acmr = float(stats.cache_misses) / float(indices.size() / 3);
+	stats.atvr = float(stats.cache_misses) / float(num_vertices);
+
+	return stats;
+}
+
+MeshOptimizer::VertexFetchStats MeshOptimizer::analyze_vertex_fetch(
+	const std::vector<uint32_t>& indices,
+	uint32_t num_vertices,
+	size_t vertex_size)
+{
+	const size_t CACHE_LINE_SIZE = 64;
+	const uint32_t NUM_CACHE_LINES = 64;
+
+	VertexFetchStats stats;
+	if (indices.empty() || num_vertices == 0)
+	{
+		return stats;
+	}
+
+	// vertices that hit the post-transform cache are never fetched
+	FifoCache vertex_cache(num_vertices, DEFAULT_CACHE_SIZE);
+	FifoCache line_cache(static_cast<uint32_t>((num_vertices * vertex_size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE), NUM_CACHE_LINES);
+	for (const uint32_t index : indices)
+	{
+		if (!vertex_cache.access(index))
+		{
+			continue;
+		}
+
+		const size_t first_line = index * vertex_size / CACHE_LINE_SIZE;
+		const size_t last_line = ((index + 1) * vertex_size - 1) / CACHE_LINE_SIZE;
+		for (size_t line = first_line; line <= last_line; line++)
+		{
+			stats.bytes_fetched += line_cache.access(static_cast<uint32_t>(line)) ? CACHE_LINE_SIZE : 0;
+		}
+	}
+
+	stats.overfetch = float(stats.bytes_fetched) / float(num_vertices * vertex_size);
+
+	return stats;
+}
+
+template<typename VertexType>
+MeshOptimizer::OverdrawStats MeshOptimizer::analyze_overdraw(
+	const std::vector<VertexType>& vertices,
+	const std::vector<uint32_t>& indices)
+{
+	std::vector<glm::vec3> positions(vertices.size());
+	std::ranges::transform(vertices, positions.begin(), [](const VertexType& vertex) { return vertex.pos; });
+
+	return rasterize_overdraw(positions, indices);
+}
+
+void MeshOptimizer::optimize_vertex_cache(
+	std::vector<uint32_t>& indices,
+	uint32_t num_vertices,
+	uint32_t cache_size,
+	std::vector<uint32_t>* clusters)
+{
+	assert(indices.size() % 3 == 0);
+	if (clusters)
+	{
+		clusters->clear();
+	}
+	if (indices.empty())
+	{
+		return;
+	}
+
+	const uint32_t num_triangles = static_cast<uint32_t>(indices.size() / 3);
+	const Adjacency adjacency(indices, num_vertices);
+
+	// number of triangles yet to be emitted that reference the vertex
+	std::vector<uint32_t> live_triangles = adjacency.counts;
+	std::vector<uint32_t> cache_timestamps(num_vertices, 0);
+	std::vector<bool> emitted(num_triangles, false);
+	std::vector<uint32_t> dead_end_stack;
+	std::vector<uint32_t> candidates;
+	uint32_t time = cache_size + 1;
+	uint32_t cursor = 0;
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+
+	// when a fanning vertex has no live neighbours we fall back to recently used vertices, and then to the
+	// next vertex in input order which starts a new cluster
+	const auto skip_dead_end = [&]() -> int64_t
+	{
+		while (!dead_end_stack.empty())
+		{
+			const uint32_t vertex = dead_end_stack.back();
+			dead_end_stack.pop_back();
+			if (live_triangles[vertex] > 0)
+			{
+				return vertex;
+			}
+		}
+		while (cursor < num_vertices)
+		{
+			if (live_triangles[cursor] > 0)
+			{
+				if (clusters)
+				{
+					clusters->push_back(static_cast<uint32_t>(output.size() / 3));
+				}
+				return cursor;
+			}
+			cursor++;
+		}
+
+		return -1;
+	};
+
+	int64_t fanning_vertex = skip_dead_end();
+	while (fanning_vertex >= 0)
+	{
+		candidates.clear();
+		const uint32_t begin = adjacency.offsets[fanning_vertex];
+		const uint32_t end = adjacency.offsets[fanning_vertex + 1];
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const uint32_t triangle = adjacency.triangles[i];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+			emitted[triangle] = true;
+
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				const uint32_t vertex = indices[triangle * 3 + corner];
+				output.push_back(vertex);
+				dead_end_stack.push_back(vertex);
+				candidates.push_back(vertex);
+				live_triangles[vertex]--;
+				if (time - cache_timestamps[vertex] > cache_size)
+				{
+					cache_timestamps[vertex] = time++;
+				}
+			}
+		}
+
+		// prefer the candidate that will still be in the cache after all of its live triangles are emitted,
+		// and among those the one that has been in the cache the longest
+		int64_t best_vertex = -1;
+		int64_t best_priority = -1;
+		for (const uint32_t vertex : candidates)
+		{
+			if (live_triangles[vertex] == 0)
+			{
+				continue;
+			}
+
+			int64_t priority = 0;
+			if (time - cache_timestamps[vertex] + 2 * live_triangles[vertex] <= cache_size)
+			{
+				priority = time - cache_timestamps[vertex];
+			}
+			if (priority > best_priority)
+			{
+				best_priority = priority;
+				best_vertex = vertex;
+			}
+		}
+
+		fanning_vertex = best_vertex >= 0 ? best_vertex : skip_dead_end();
+	}
+
+	assert(output.size() == indices.size());
+	indices = std::move(output);
+}
+
+template<typename VertexType>
+uint32_t MeshOptimizer::deduplicate_vertices(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices)
+{
+	std::unordered_map<VertexType, uint32_t> unique_vertices;
+	unique_vertices.reserve(vertices.size());
+	std::vector<uint32_t> remap(vertices.size());
+	std::vector<VertexType> new_vertices;
+	new_vertices.reserve(vertices.size());
+	for (uint32_t i = 0; i < vertices.size(); i++)
+	{
+		const auto [it, inserted] = unique_vertices.try_emplace(vertices[i], static_cast<uint32_t>(new_vertices.size()));
+		if (inserted)
+		{
+			new_vertices.push_back(vertices[i]);
+		}
+		remap[i] = it->second;
+	}
+
+	for (uint32_t& index : indices)
+	{
+		index = remap[index];
+	}
+	vertices = std::move(new_vertices);
+
+	return static_cast<uint32_t>(vertices.size());
+}
+
+template<typename VertexType>
+void MeshOptimizer::optimize_overdraw(
+	const std::vector<VertexType>& vertices,
+	std::vector<uint32_t>& indices,
+	const std::vector<uint32_t>& clusters,
+	uint32_t cache_size,
+	float threshold)
+{
+	const uint32_t num_triangles = static_cast<uint32_t>(indices.size() / 3);
+	if (num_triangles == 0 || clusters.empty())
+	{
+		return;
+	}
+
+	FifoCache cache(static_cast<uint32_t>(vertices.size()), cache_size);
+	const auto count_misses = [&](uint32_t triangle)
+	{
+		return uint32_t(cache.access(indices[triangle * 3])) +
+			uint32_t(cache.access(indices[triangle * 3 + 1])) +
+			uint32_t(cache.access(indices[triangle * 3 + 2]));
+	};
+
+	// split the hard clusters wherever the running ACMR is already as good as the cluster as a whole,
+	// finer clusters give the sort below more freedom. Every cluster can end up after any other so the
+	// misses are counted from a cold cache at the start of each one
+	std::vector<uint32_t> soft_clusters;
+	for (uint32_t i = 0; i < clusters.size(); i++)
+	{
+		const uint32_t begin = clusters[i];
+		const uint32_t end = i + 1 < clusters.size() ? clusters[i + 1] : num_triangles;
+		uint32_t cluster_misses = 0;
+		cache.reset();
+		for (uint32_t triangle = begin; triangle < end; triangle++)
+		{
+			cluster_misses += count_misses(triangle);
+		}
+		const float cluster_threshold = threshold * float(cluster_misses) / float(end - begin);
+
+		soft_clusters.push_back(begin);
+		uint32_t running_misses = 0;
+		uint32_t running_triangles = 0;
+		cache.reset();
+		for (uint32_t triangle = begin; triangle < end - 1; triangle++)
+		{
+			running_misses += count_misses(triangle);
+			running_triangles++;
+			if (float(running_misses) <= cluster_threshold * float(running_triangles))
+			{
+				soft_clusters.push_back(triangle + 1);
+				running_misses = 0;
+				running_triangles = 0;
+				cache.reset();
+			}
+		}
+	}
+
+	// clusters that face away from the centre of the mesh are more likely to occlude the others
+	glm::vec3 mesh_centroid(0.0f);
+	float mesh_area = 0.0f;
+	struct Cluster
+	{
+		uint32_t begin;
+		uint32_t end;
+		glm::vec3 centroid;
+		glm::vec3 normal;
+		float sort_key;
+	};
+	std::vector<Cluster> sorted_clusters(soft_clusters.size());
+	for (uint32_t i = 0; i < soft_clusters.size(); i++)
+	{
+		Cluster& cluster = sorted_clusters[i];
+		cluster.begin = soft_clusters[i];
+		cluster.end = i + 1 < soft_clusters.size() ? soft_clusters[i + 1] : num_triangles;
+		cluster.centroid = glm::vec3(0.0f);
+		cluster.normal = glm::vec3(0.0f);
+
+		float cluster_area = 0.0f;
+		for (uint32_t triangle = cluster.begin; triangle < cluster.end; triangle++)
+		{
+			const glm::vec3& p0 = vertices[indices[triangle * 3]].pos;
+			const glm::vec3& p1 = vertices[indices[triangle * 3 + 1]].pos;
+			const glm::vec3& p2 = vertices[indices[triangle * 3 + 2]].pos;
+			const glm::vec3 area_normal = glm::cross(p1 - p0, p2 - p0);
+			const float area = glm::length(area_normal);
+			cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+			cluster.normal += area_normal;
+			cluster_area += area;
+		}
+
+		mesh_centroid += cluster.centroid;
+		mesh_area += cluster_area;
+		cluster.centroid = cluster_area > 0.0f ? cluster.centroid / cluster_area : cluster.centroid;
+	}
+	mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : mesh_centroid;
+
+	for (Cluster& cluster : sorted_clusters)
+	{
+		const float normal_length = glm::length(cluster.normal);
+		cluster.sort_key = normal_length > 0.0f ?
+			glm::dot(cluster.centroid - mesh_centroid, cluster.normal / normal_length) :
+			-std::numeric_limits<float>::max();
+	}
+	std::ranges::stable_sort(sorted_clusters, [](const Cluster& a, const Cluster& b) { return a.sort_key > b.sort_key; });
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (const Cluster& cluster : sorted_clusters)
+	{
+		output.insert(output.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+	}
+	indices = std::move(output);
+}
+
+template<typename VertexType>
+uint32_t MeshOptimizer::optimize_vertex_fetch(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices)
+{
+	const uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> remap(vertices.size(), UNUSED);
+	std::vector<VertexType> new_vertices;
+	new_vertices.reserve(vertices.size());
+	for (uint32_t& index : indices)
+	{
+		if (remap[index] == UNUSED)
+		{
+			remap[index] = static_cast<uint32_t>(new_vertices.size());
+			new_vertices.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices = std::move(new_vertices);
+
+	return static_cast<uint32_t>(vertices.size());
+}
+
+template<typename VertexType>
+MeshOptimizer::Stats MeshOptimizer::optimize(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices)
+{
+	Stats stats;
+	stats.vertices_before = static_cast<uint32_t>(vertices.size());
+	stats.before = analyze_vertex_cache(indices, stats.vertices_before);
+
+	if (!indices.empty())
+	{
+		deduplicate_vertices(vertices, indices);
+		std::vector<uint32_t> clusters;
+		optimize_vertex_cache(indices, static_cast<uint32_t>(vertices.size()), DEFAULT_CACHE_SIZE, &clusters);
+		optimize_overdraw(vertices, indices, clusters);
+		optimize_vertex_fetch(vertices, indices);
+	}
+
+	stats.vertices_after = static_cast<uint32_t>(vertices.size());
+	stats.after = analyze_vertex_cache(indices, stats.vertices_after);
+
+	return stats;
+}
+
+
+// instantiate the template methods
+template MeshOptimizer::OverdrawStats MeshOptimizer::analyze_overdraw<SDS::ColorVertex>(
+	const std::vector<SDS::ColorVertex>&, const std::vector<uint32_t>&);
+template uint32_t MeshOptimizer::deduplicate_vertices<SDS::ColorVertex>(std::vector<SDS::ColorVertex>&, std::vector<uint32_t>&);
+template void MeshOptimizer::optimize_overdraw<SDS::ColorVertex>(
+	const std::vector<SDS::ColorVertex>&, std::vector<uint32_t>&, const std::vector<uint32_t>&, uint32_t, float);
+template uint32_t MeshOptimizer::optimize_vertex_fetch<SDS::ColorVertex>(std::vector<SDS::ColorVertex>&, std::vector<uint32_t>&);
+template MeshOptimizer::Stats MeshOptimizer::optimize<SDS::ColorVertex>(std::vector<SDS::ColorVertex>&, std::vector<uint32_t>&);
+
+template MeshOptimizer::OverdrawStats MeshOptimizer::analyze_overdraw<SDS::TexVertex>(
+	const std::vector<SDS::TexVertex>&, const std::vector<uint32_t>&);
+template uint32_t MeshOptimizer::deduplicate_vertices<SDS::TexVertex>(std::vector<SDS::TexVertex>&, std::vector<uint32_t>&);
+template void MeshOptimizer::optimize_overdraw<SDS::TexVertex>(
+	const std::vector<SDS::TexVertex>&, std::vector<uint32_t>&, const std::vector<uint32_t>&, uint32_t, float);
+template uint32_t MeshOptimizer::optimize_vertex_fetch<SDS::TexVertex>(std::vector<SDS::TexVertex>&, std::vector<uint32_t>&);
+template MeshOptimizer::Stats MeshOptimizer::optimize<SDS::TexVertex>(std::vector<SDS::TexVertex>&, std::vector<uint32_t>&);
+
+template MeshOptimizer::OverdrawStats MeshOptimizer::analyze_overdraw<SDS::SkinnedVertex>(
+	const std::vector<SDS::SkinnedVertex>&, const std::vector<uint32_t>&);
+template uint32_t MeshOptimizer::deduplicate_vertices<SDS::SkinnedVertex>(std::vector<SDS::SkinnedVertex>&, std::vector<uint32_t>&);
+template void MeshOptimizer::optimize_overdraw<SDS::SkinnedVertex>(
+	const std::vector<SDS::SkinnedVertex>&, std::vector<uint32_t>&, const std::vector<uint32_t>&, uint32_t, float);
+template uint32_t MeshOptimizer::optimize_vertex_fetch<SDS::SkinnedVertex>(std::vector<SDS::SkinnedVertex>&, std::vector<uint32_t>&);
+template MeshOptimizer::Stats MeshOptimizer::optimize<SDS::SkinnedVertex>(std::vector<SDS::SkinnedVertex>&, std::vector<uint32_t>&);
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+//
+// Offline mesh optimisation, intended to run once at load/bake time
+//	1. vertex deduplication
+//	2. triangle reordering for the post-transform vertex cache (Tipsify [Sander et al. 2007])
+//	3. triangle cluster reordering to reduce overdraw, without significantly hurting the vertex cache
+//	4. vertex reordering in order of first use for the pre-transform vertex fetch
+//
+namespace MeshOptimizer
+{
+	// typical post-transform cache size of modern hardware
+	constexpr uint32_t DEFAULT_CACHE_SIZE = 16;
+
+	struct VertexCacheStats
+	{
+		uint32_t cache_misses = 0;
+		// average cache miss ratio, transformed vertices per triangle, 3.0 is worst, ~0.5 is best for large regular grids
+		float acmr = 0.0f;
+		// average transformed vertex ratio, transformed vertices per vertex, 1.0 is best
+		float atvr = 0.0f;
+	};
+
+	struct VertexFetchStats
+	{
+		size_t bytes_fetched = 0;
+		// bytes fetched / vertex buffer size, 1.0 is best
+		float overfetch = 0.0f;
+	};
+
+	struct OverdrawStats
+	{
+		uint32_t pixels_covered = 0;
+		uint32_t pixels_shaded = 0;
+		// shaded pixels / covered pixels averaged over the views, 1.0 is best
+		float overdraw = 0.0f;
+	};
+
+	struct Stats
+	{
+		uint32_t vertices_before = 0;
+		uint32_t vertices_after = 0;
+		VertexCacheStats before;
+		VertexCacheStats after;
+	};
+
+	// simulates a FIFO post-transform vertex cache
+	VertexCacheStats analyze_vertex_cache(
+		const std::vector<uint32_t>& indices,
+		uint32_t num_vertices,
+		uint32_t cache_size = DEFAULT_CACHE_SIZE);
+
+	// simulates fetching vertices through 64 byte cache lines
+	VertexFetchStats analyze_vertex_fetch(
+		const std::vector<uint32_t>& indices,
+		uint32_t num_vertices,
+		size_t vertex_size);
+
+	// rasterises the back face culled mesh in order from the 6 axis directions with a depth test,
+	// counting the fragments that pass i.e. the pixels an early-z GPU would shade
+	template<typename VertexType>
+	OverdrawStats analyze_overdraw(
+		const std::vector<VertexType>& vertices,
+		const std::vector<uint32_t>& indices);
+
+	// reorders the triangles, if clusters is provided it is filled with the index of the first triangle of each cluster
+	// i.e. runs of triangles that do not share vertices with the triangles emitted before them
+	void optimize_vertex_cache(
+		std::vector<uint32_t>& indices,
+		uint32_t num_vertices,
+		uint32_t cache_size = DEFAULT_CACHE_SIZE,
+		std::vector<uint32_t>* clusters = nullptr);
+
+	// merges identical vertices, returns the new number of vertices
+	template<typename VertexType>
+	uint32_t deduplicate_vertices(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices);
+
+	// reorders the clusters produced by optimize_vertex_cache so that outward facing clusters are drawn first,
+	// clusters are split further while their ACMR stays within threshold of the original
+	template<typename VertexType>
+	void optimize_overdraw(
+		const std::vector<VertexType>& vertices,
+		std::vector<uint32_t>& indices,
+		const std::vector<uint32_t>& clusters,
+		uint32_t cache_size = DEFAULT_CACHE_SIZE,
+		float threshold = 1.05f);
+
+	// reorders vertices in order of first use and drops unreferenced vertices, returns the new number of vertices
+	template<typename VertexType>
+	uint32_t optimize_vertex_fetch(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices);
+
+	// runs the full pipeline
+	template<typename VertexType>
+	Stats optimize(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices);
+}
@@ -0,0 +1,498 @@
+#include "mesh_simplifier.hpp"
+#include "mesh_optimizer.hpp"
+#include "shared_data_structures.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <queue>
+#include <unordered_map>
+#include <optional>
+#include <limits>
+#include <cmath>
+
+
+namespace
+{
+	// border edges are pinned by a plane perpendicular to their face, weighted heavily so that holes and
+	// open boundaries (i.e. the rim of a cone) keep their shape
+	constexpr double BORDER_WEIGHT = 10.0;
+	// a collapse is rejected if it rotates a remaining triangle further than ~78 degrees
+	constexpr double MIN_NORMAL_COSINE = 0.2;
+
+	// symmetric 4x4 matrix of the summed squared distances to a set of planes
+	struct Quadric
+	{
+		double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+		double b2 = 0.0, bc = 0.0, bd = 0.0;
+		double c2 = 0.0, cd = 0.0;
+		double d2 = 0.0;
+		double weight = 0.0;
+
+		void add_plane(const glm::dvec3& normal, double d, double plane_weight)
+		{
+			a2 += normal.x * normal.x * plane_weight;
+			ab += normal.x * normal.y * plane_weight;
+			ac += normal.x * normal.z * plane_weight;
+			ad += normal.x * d * plane_weight;
+			b2 += normal.y * normal.y * plane_weight;
+			bc += normal.y * normal.z * plane_weight;
+			bd += normal.y * d * plane_weight;
+			c2 += normal.z * normal.z * plane_weight;
+			cd += normal.z * d * plane_weight;
+			d2 += d * d * plane_weight;
+			weight += plane_weight;
+		}
+
+		Quadric& operator+=(const Quadric& rhs)
+		{
+			a2 += rhs.a2; ab += rhs.ab; ac += rhs.ac; ad += rhs.ad;
+			b2 += rhs.b2; bc += rhs.bc; bd += rhs.bd;
+			c2 += rhs.c2; cd += rhs.cd;
+			d2 += rhs.d2;
+			weight += rhs.weight;
+			return *this;
+		}
+
+		// weighted mean squared distance of p to the planes
+		double evaluate(const glm::dvec3& p) const
+		{
+			const double error =
+				a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x +
+				b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y +
+				c2 * p.z * p.z + 2.0 * cd * p.z +
+				d2;
+			return weight > 0.0 ? std::abs(error) / weight : 0.0;
+		}
+	};
+
+	struct Collapse
+	{
+		double cost;
+		uint32_t from;
+		uint32_t to;
+		uint32_t from_version;
+		uint32_t to_version;
+
+		bool operator>(const Collapse& rhs) const { return cost > rhs.cost; }
+	};
+
+	// vertices with identical positions are merged into a single "wedge" so that the simplification
+	// operates on the geometric topology, triangles still reference the original attribute carrying vertices
+	class Simplifier
+	{
+	public:
+		Simplifier(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, float radius) :
+			vertex_to_wedge(positions.size())
+		{
+			std::unordered_map<glm::vec3, uint32_t> position_to_wedge;
+			for (uint32_t vertex = 0; vertex < positions.size(); vertex++)
+			{
+				const auto [it, inserted] = position_to_wedge.try_emplace(positions[vertex], static_cast<uint32_t>(wedge_positions.size()));
+				if (inserted)
+				{
+					wedge_positions.push_back(glm::dvec3(positions[vertex]) / double(radius));
+				}
+				vertex_to_wedge[vertex] = it->second;
+			}
+
+			const size_t num_wedges = wedge_positions.size();
+			wedge_members.resize(num_wedges);
+			wedge_triangles.resize(num_wedges);
+			quadrics.resize(num_wedges);
+			versions.resize(num_wedges, 0);
+			collapsed.resize(num_wedges, false);
+			for (uint32_t vertex = 0; vertex < positions.size(); vertex++)
+			{
+				wedge_members[vertex_to_wedge[vertex]].push_back(vertex);
+			}
+
+			for (size_t i = 0; i + 2 < indices.size(); i += 3)
+			{
+				const std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+				const uint32_t w0 = vertex_to_wedge[triangle[0]];
+				const uint32_t w1 = vertex_to_wedge[triangle[1]];
+				const uint32_t w2 = vertex_to_wedge[triangle[2]];
+				if (w0 == w1 || w1 == w2 || w0 == w2)
+				{
+					continue; // degenerate
+				}
+
+				const uint32_t triangle_idx = static_cast<uint32_t>(triangles.size());
+				triangles.push_back(triangle);
+				alive.push_back(true);
+				for (const uint32_t wedge : { w0, w1, w2 })
+				{
+					wedge_triangles[wedge].push_back(triangle_idx);
+				}
+			}
+			num_alive_triangles = triangles.size();
+
+			compute_quadrics();
+			for (uint32_t triangle_idx = 0; triangle_idx < triangles.size(); triangle_idx++)
+			{
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					const uint32_t a = get_wedge(triangle_idx, corner);
+					const uint32_t b = get_wedge(triangle_idx, (corner + 1) % 3);
+					push_collapse(a, b);
+					push_collapse(b, a);
+				}
+			}
+		}
+
+		// returns the largest collapse error
+		double run(size_t target_triangles, double max_cost)
+		{
+			double max_collapsed_cost = 0.0;
+			while (num_alive_triangles > target_triangles && !candidates.empty())
+			{
+				const Collapse collapse = candidates.top();
+				candidates.pop();
+				if (collapsed[collapse.from] || collapsed[collapse.to] ||
+					versions[collapse.from] != collapse.from_version || versions[collapse.to] != collapse.to_version)
+				{
+					continue; // stale
+				}
+				if (collapse.cost > max_cost)
+				{
+					break;
+				}
+				if (apply_collapse(collapse.from, collapse.to))
+				{
+					max_collapsed_cost = std::max(max_collapsed_cost, collapse.cost);
+				}
+			}
+
+			return max_collapsed_cost;
+		}
+
+		std::vector<uint32_t> get_indices() const
+		{
+			std::vector<uint32_t> indices;
+			indices.reserve(num_alive_triangles * 3);
+			for (uint32_t triangle_idx = 0; triangle_idx < triangles.size(); triangle_idx++)
+			{
+				if (alive[triangle_idx])
+				{
+					indices.insert(indices.end(), triangles[triangle_idx].begin(), triangles[triangle_idx].end());
+				}
+			}
+
+			return indices;
+		}
+
+	private:
+		uint32_t get_wedge(uint32_t triangle_idx, uint32_t corner) const
+		{
+			return vertex_to_wedge[triangles[triangle_idx][corner]];
+		}
+
+		glm::dvec3 get_unnormalised_normal(uint32_t triangle_idx, uint32_t moved_wedge, const glm::dvec3& moved_position) const
+		{
+			std::array<glm::dvec3, 3> corners;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				const uint32_t wedge = get_wedge(triangle_idx, corner);
+				corners[corner] = wedge == moved_wedge ? moved_position : wedge_positions[wedge];
+			}
+
+			return glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+		}
+
+		void compute_quadrics()
+		{
+			// edge -> number of triangles using it, edges used once are on a border
+			std::unordered_map<uint64_t, uint32_t> edge_uses;
+			const auto get_edge_key = [](uint32_t a, uint32_t b)
+			{
+				return (uint64_t(std::min(a, b)) << 32) | uint64_t(std::max(a, b));
+			};
+			for (uint32_t triangle_idx = 0; triangle_idx < triangles.size(); triangle_idx++)
+			{
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					edge_uses[get_edge_key(get_wedge(triangle_idx, corner), get_wedge(triangle_idx, (corner + 1) % 3))]++;
+				}
+			}
+
+			for (uint32_t triangle_idx = 0; triangle_idx < triangles.size(); triangle_idx++)
+			{
+				const glm::dvec3 cross = get_unnormalised_normal(triangle_idx, std::numeric_limits<uint32_t>::max(), {});
+				const double double_area = glm::length(cross);
+				if (double_area <= 0.0)
+				{
+					continue;
+				}
+
+				// plane quadrics are weighted by area so that the many small triangles of a dense region don't dominate
+				const glm::dvec3 normal = cross / double_area;
+				const glm::dvec3& p0 = wedge_positions[get_wedge(triangle_idx, 0)];
+				Quadric quadric;
+				quadric.add_plane(normal, -glm::dot(normal, p0), double_area * 0.5);
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					quadrics[get_wedge(triangle_idx, corner)] += quadric;
+				}
+
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					const uint32_t a = get_wedge(triangle_idx, corner);
+					const uint32_t b = get_wedge(triangle_idx, (corner + 1) % 3);
+					if (edge_uses[get_edge_key(a, b)] != 1)
+					{
+						continue;
+					}
+
+					const glm::dvec3 edge = wedge_positions[b] - wedge_positions[a];
+					const double edge_length = glm::length(edge);
+					if (edge_length <= 0.0)
+					{
+						continue;
+					}
+					const glm::dvec3 border_normal = glm::normalize(glm::cross(edge, normal));
+					Quadric border_quadric;
+					border_quadric.add_plane(border_normal, -glm::dot(border_normal, wedge_positions[a]), edge_length * edge_length * BORDER_WEIGHT);
+					quadrics[a] += border_quadric;
+					quadrics[b] += border_quadric;
+				}
+			}
+		}
+
+		void push_collapse(uint32_t from, uint32_t to)
+		{
+			Quadric quadric = quadrics[from];
+			quadric += quadrics[to];
+			candidates.push(Collapse{ quadric.evaluate(wedge_positions[to]), from, to, versions[from], versions[to] });
+		}
+
+		// moves every triangle of wedge "from" onto wedge "to", fails if it would break an attribute seam or flip a triangle
+		bool apply_collapse(uint32_t from, uint32_t to)
+		{
+			// every vertex of the collapsed wedge must map onto the single vertex of the target wedge that it shares an edge with,
+			// otherwise the collapse would drag attributes (i.e. uvs) across a seam
+			std::vector<std::pair<uint32_t, uint32_t>> vertex_remap;
+			for (const uint32_t vertex : wedge_members[from])
+			{
+				bool referenced = false;
+				std::optional<uint32_t> target;
+				for (const uint32_t triangle_idx : wedge_triangles[from])
+				{
+					if (!alive[triangle_idx])
+					{
+						continue;
+					}
+					const auto& triangle = triangles[triangle_idx];
+					if (std::ranges::find(triangle, vertex) == triangle.end())
+					{
+						continue;
+					}
+					referenced = true;
+					for (const uint32_t other : triangle)
+					{
+						if (vertex_to_wedge[other] != to)
+						{
+							continue;
+						}
+						if (target && *target != other)
+						{
+							return false; // touches both sides of a seam in the target wedge
+						}
+						target = other;
+					}
+				}
+
+				if (referenced && !target)
+				{
+					return false;
+				}
+				if (target)
+				{
+					vertex_remap.emplace_back(vertex, *target);
+				}
+			}
+
+			// reject collapses that fold a remaining triangle over
+			const glm::dvec3& to_position = wedge_positions[to];
+			for (const uint32_t triangle_idx : wedge_triangles[from])
+			{
+				if (!alive[triangle_idx] || has_wedge(triangle_idx, to))
+				{
+					continue;
+				}
+
+				const glm::dvec3 before = get_unnormalised_normal(triangle_idx, from, wedge_positions[from]);
+				const glm::dvec3 after = get_unnormalised_normal(triangle_idx, from, to_position);
+				const double before_length = glm::length(before);
+				const double after_length = glm::length(after);
+				if (after_length <= 0.0 || glm::dot(before, after) < MIN_NORMAL_COSINE * before_length * after_length)
+				{
+					return false;
+				}
+			}
+
+			for (const uint32_t triangle_idx : wedge_triangles[from])
+			{
+				if (!alive[triangle_idx])
+				{
+					continue;
+				}
+				if (has_wedge(triangle_idx, to))
+				{
+					alive[triangle_idx] = false;
+					num_alive_triangles--;
+					continue;
+				}
+
+				for (uint32_t& vertex : triangles[triangle_idx])
+				{
+					for (const auto& [old_vertex, new_vertex] : vertex_remap)
+					{
+						if (vertex == old_vertex)
+						{
+							vertex = new_vertex;
+							break;
+						}
+					}
+				}
+				wedge_triangles[to].push_back(triangle_idx);
+			}
+
+			quadrics[to] += quadrics[from];
+			collapsed[from] = true;
+			wedge_triangles[from].clear();
+			versions[from]++;
+			versions[to]++;
+
+			// neighbouring collapse costs depend on the merged quadric
+			for (const uint32_t triangle_idx : wedge_triangles[to])
+			{
+				if (!alive[triangle_idx])
+				{
+					continue;
+				}
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					const uint32_t neighbour = get_wedge(triangle_idx, corner);
+					if (neighbour != to)
+					{
+						push_collapse(to, neighbour);
+						push_collapse(neighbour, to);
+					}
+				}
+			}
+
+			return true;
+		}
+
+		bool has_wedge(uint32_t triangle_idx, uint32_t wedge) const
+		{
+			return get_wedge(triangle_idx, 0) == wedge || get_wedge(triangle_idx, 1) == wedge || get_wedge(triangle_idx, 2) == wedge;
+		}
+
+	private:
+		std::vector<uint32_t> vertex_to_wedge;
+		std::vector<glm::dvec3> wedge_positions;
+		std::vector<std::vector<uint32_t>> wedge_members;
+		std::vector<std::vector<uint32_t>> wedge_triangles;
+		std::vector<Quadric> quadrics;
+		std::vector<uint32_t> versions;
+		std::vector<bool> collapsed;
+
+		std::vector<std::array<uint32_t, 3>> triangles;
+		std::vector<bool> alive;
+		size_t num_alive_triangles = 0;
+
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> candidates;
+	};
+}
+
+float MeshSimplifier::compute_bounding_radius(const std::vector<glm::vec3>& positions)
+{
+	float radius = 0.0f;
+	for (const auto& position : positions)
+	{
+		radius = std::max(radius, glm::length(position));
+	}
+
+	return radius;
+}
+
+std::vector<uint32_t> MeshSimplifier::simplify(
+	const std::vector<glm::vec3>& positions,
+	const std::vector<uint32_t>& indices,
+	size_t target_index_count,
+	float max_error,
+	float* result_error)
+{
+	if (result_error)
+	{
+		*result_error = 0.0f;
+	}
+	const float radius = compute_bounding_radius(positions);
+	if (indices.size() <= target_index_count || !(radius > 0.0f))
+	{
+		return indices;
+	}
+
+	Simplifier simplifier(positions, indices, radius);
+	const double max_cost = double(max_error) * double(max_error);
+	const double cost = simplifier.run(target_index_count / 3, max_cost);
+	if (result_error)
+	{
+		*result_error = static_cast<float>(std::sqrt(cost));
+	}
+
+	return simplifier.get_indices();
+}
+
+template<typename VertexType>
+std::vector<MeshSimplifier::Lod> MeshSimplifier::generate_lod_chain(
+	const std::vector<VertexType>& vertices,
+	const std::vector<uint32_t>& indices,
+	uint32_t max_lods,
+	float reduction,
+	float max_error)
+{
+	std::vector<glm::vec3> positions(vertices.size());
+	std::ranges::transform(vertices, positions.begin(), [](const VertexType& vertex) { return vertex.pos; });
+
+	std::vector<Lod> lods;
+	lods.reserve(max_lods); // source points into lods
+	const std::vector<uint32_t>* source = &indices;
+	float accumulated_error = 0.0f;
+	for (uint32_t level = 1; level <= max_lods; level++)
+	{
+		const size_t target_index_count = static_cast<size_t>(float(source->size() / 3) * reduction) * 3;
+		if (target_index_count < MIN_LOD_TRIANGLES * 3)
+		{
+			break;
+		}
+
+		// each level is simplified from the previous one, so the errors accumulate
+		float error = 0.0f;
+		std::vector<uint32_t> lod_indices = simplify(positions, *source, target_index_count, max_error - accumulated_error, &error);
+		// not worth a separate level if the error budget ran out before a meaningful reduction
+		if (float(lod_indices.size()) > float(source->size()) * (1.0f + reduction) * 0.5f)
+		{
+			break;
+		}
+
+		accumulated_error += error;
+		MeshOptimizer::optimize_vertex_cache(lod_indices, static_cast<uint32_t>(vertices.size()));
+		lods.push_back(Lod{ std::move(lod_indices), accumulated_error });
+		source = &lods.back().indices;
+	}
+
+	return lods;
+}
+
+
+// instantiate the template methods
+template std::vector<MeshSimplifier::Lod> MeshSimplifier::generate_lod_chain<SDS::ColorVertex>(
+	const std::vector<SDS::ColorVertex>&, const std::vector<uint32_t>&, uint32_t, float, float);
+template std::vector<MeshSimplifier::Lod> MeshSimplifier::generate_lod_chain<SDS::TexVertex>(
+	const std::vector<SDS::TexVertex>&, const std::vector<uint32_t>&, uint32_t, float, float);
+template std::vector<MeshSimplifier::Lod> MeshSimplifier::generate_lod_chain<SDS::SkinnedVertex>(
+	const std::vector<SDS::SkinnedVertex>&, const std::vector<uint32_t>&, uint32_t, float, float);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+//
+// Quadric error metric simplification [Garland and Heckbert 1997] used to generate LOD chains
+//	vertices are never moved or created, each collapse merges a vertex into one of its neighbours,
+//	so every LOD can index into the vertex buffer of the original mesh
+//	vertices sharing a position are collapsed together, which keeps attribute seams (uv, hard normals) intact
+//
+namespace MeshSimplifier
+{
+	constexpr uint32_t DEFAULT_MAX_LODS = 4;
+	// triangle ratio between successive LODs
+	constexpr float DEFAULT_REDUCTION = 0.5f;
+	// relative to the bounding radius, past this the silhouette is not recognisable anymore
+	constexpr float DEFAULT_MAX_ERROR = 0.1f;
+	// no point in simplifying further than this
+	constexpr uint32_t MIN_LOD_TRIANGLES = 8;
+
+	struct Lod
+	{
+		std::vector<uint32_t> indices;
+		// geometric deviation from LOD 0, relative to the bounding radius of the mesh
+		float error = 0.0f;
+	};
+
+	// furthest distance of a vertex from the mesh origin, errors are expressed relative to it
+	float compute_bounding_radius(const std::vector<glm::vec3>& positions);
+
+	// collapses edges in order of increasing quadric error until the index count drops to target_index_count
+	// or the next collapse would exceed max_error, result_error receives the largest error introduced
+	std::vector<uint32_t> simplify(
+		const std::vector<glm::vec3>& positions,
+		const std::vector<uint32_t>& indices,
+		size_t target_index_count,
+		float max_error = DEFAULT_MAX_ERROR,
+		float* result_error = nullptr);
+
+	// successively simplified detail levels, LOD 0 (the mesh itself) is not included
+	// stops early once a level can not be reduced any further within max_error
+	template<typename VertexType>
+	std::vector<Lod> generate_lod_chain(
+		const std::vector<VertexType>& vertices,
+		const std::vector<uint32_t>& indices,
+		uint32_t max_lods = DEFAULT_MAX_LODS,
+		float reduction = DEFAULT_REDUCTION,
+		float max_error = DEFAULT_MAX_ERROR);
+}
@@ -12,4 +12,5 @@ enum class ERenderType
 	LIGHTWEIGHT_OFFSCREEN_PIPELINE,
 	SKINNED, // for skinned meshes
 	QUAD,
+	OUTLINE, // full-screen edge detect of the stenciled objects
 };
\ No newline at end of file
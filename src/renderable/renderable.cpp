@@ -1,5 +1,6 @@
 #include "renderable/renderable.hpp"
 #include "renderable/material_factory.hpp"
+#include "entity_component_system/mesh_system.hpp"
 
 
 Renderable Renderable::make_default(MeshID mesh_id)
@@ -11,4 +12,24 @@ Renderable Renderable::make_default(MeshID mesh_id)
 	renderable.pipeline_render_type = ERenderType::COLOR;
 
 	return renderable;
-}
\ No newline at end of file
+}
+
+uint32_t Renderable::select_lod(float projected_radius_pixels, uint32_t current_lod) const
+{
+	const Mesh& mesh = MeshSystem::get(mesh_id);
+	uint32_t lod = 0;
+	for (uint32_t candidate = 1; candidate < mesh.get_num_lods(); candidate++)
+	{
+		// levels at or below the current one are kept until the error clearly exceeds the threshold,
+		// coarser levels are only taken once the error is clearly below it
+		const float threshold = candidate <= current_lod ?
+			LOD_ERROR_PIXELS * (1.0f + LOD_HYSTERESIS) : LOD_ERROR_PIXELS * (1.0f - LOD_HYSTERESIS);
+		if (mesh.get_lod(candidate).error * projected_radius_pixels > threshold)
+		{
+			break; // errors only grow with coarser levels
+		}
+		lod = candidate;
+	}
+
+	return lod;
+}
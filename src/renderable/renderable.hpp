@@ -19,4 +19,13 @@ struct Renderable
 	bool casts_shadow = true;
 
 	static Renderable make_default(MeshID mesh_id);
+
+	// LODs are switched once their error projects to less than a pixel
+	static constexpr float LOD_ERROR_PIXELS = 1.0f;
+	// fraction of the threshold the projected error must overshoot before switching, stops
+	// objects sitting at a transition distance from flickering between two levels
+	static constexpr float LOD_HYSTERESIS = 0.25f;
+
+	// picks the coarsest LOD of the mesh that is indistinguishable at the given projected bounding radius
+	uint32_t select_lod(float projected_radius_pixels, uint32_t current_lod) const;
 };
\ No newline at end of file
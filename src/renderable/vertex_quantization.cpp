@@ -0,0 +1,153 @@
+#include "vertex_quantization.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+
+namespace
+{
+	glm::vec2 sign_not_zero(const glm::vec2& v)
+	{
+		return glm::vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+	}
+}
+
+uint32_t VertexQuantization::encode_octahedral(const glm::vec3& normal)
+{
+	const float l1_norm = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (!(l1_norm > 0.0f)) // also catches NaN
+	{
+		return glm::packSnorm2x16(glm::vec2(0.0f));
+	}
+
+	// project onto the octahedron and fold the lower hemisphere over the upper one
+	glm::vec2 oct = glm::vec2(normal.x, normal.y) / l1_norm;
+	if (normal.z < 0.0f)
+	{
+		oct = (glm::vec2(1.0f) - glm::vec2(std::abs(oct.y), std::abs(oct.x))) * sign_not_zero(oct);
+	}
+
+	return glm::packSnorm2x16(oct);
+}
+
+glm::vec3 VertexQuantization::decode_octahedral(uint32_t encoded)
+{
+	const glm::vec2 oct = glm::unpackSnorm2x16(encoded);
+	glm::vec3 normal(oct.x, oct.y, 1.0f - std::abs(oct.x) - std::abs(oct.y));
+	if (normal.z < 0.0f)
+	{
+		const glm::vec2 folded = (glm::vec2(1.0f) - glm::vec2(std::abs(oct.y), std::abs(oct.x))) * sign_not_zero(oct);
+		normal.x = folded.x;
+		normal.y = folded.y;
+	}
+
+	return glm::normalize(normal);
+}
+
+uint32_t VertexQuantization::encode_tex_coord(const glm::vec2& tex_coord)
+{
+	return glm::packHalf2x16(tex_coord);
+}
+
+glm::vec2 VertexQuantization::decode_tex_coord(uint32_t encoded)
+{
+	return glm::unpackHalf2x16(encoded);
+}
+
+bool VertexQuantization::fits_bone_ids(const glm::vec4& bone_ids)
+{
+	return glm::all(glm::greaterThanEqual(bone_ids, glm::vec4(0.0f))) &&
+		glm::all(glm::lessThan(bone_ids, glm::vec4(float(MAX_BONES))));
+}
+
+uint32_t VertexQuantization::encode_bone_ids(const glm::vec4& bone_ids)
+{
+	assert(fits_bone_ids(bone_ids));
+	uint32_t encoded = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		encoded |= static_cast<uint32_t>(bone_ids[i] + 0.5f) << (i * 8);
+	}
+
+	return encoded;
+}
+
+glm::vec4 VertexQuantization::decode_bone_ids(uint32_t encoded)
+{
+	return glm::vec4(
+		float(encoded & 0xFF),
+		float((encoded >> 8) & 0xFF),
+		float((encoded >> 16) & 0xFF),
+		float((encoded >> 24) & 0xFF));
+}
+
+uint32_t VertexQuantization::encode_bone_weights(const glm::vec4& bone_weights)
+{
+	std::array<float, 4> weights;
+	float sum = 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		weights[i] = std::max(bone_weights[i], 0.0f);
+		sum += weights[i];
+	}
+	if (!(sum > 0.0f))
+	{
+		return 0;
+	}
+
+	// largest remainder rounding, truncate every weight and hand the remaining units to the largest fractions
+	std::array<int, 4> quantised;
+	std::array<float, 4> remainders;
+	int quantised_sum = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		const float scaled = weights[i] / sum * 255.0f;
+		quantised[i] = static_cast<int>(scaled);
+		remainders[i] = scaled - float(quantised[i]);
+		quantised_sum += quantised[i];
+	}
+	for (; quantised_sum < 255; quantised_sum++)
+	{
+		const auto largest = std::distance(remainders.begin(), std::ranges::max_element(remainders));
+		quantised[largest]++;
+		remainders[largest] = -1.0f;
+	}
+
+	uint32_t encoded = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		encoded |= static_cast<uint32_t>(std::clamp(quantised[i], 0, 255)) << (i * 8);
+	}
+
+	return encoded;
+}
+
+glm::vec4 VertexQuantization::decode_bone_weights(uint32_t encoded)
+{
+	return glm::unpackUnorm4x8(encoded);
+}
+
+SDS::PackedColorVertex VertexQuantization::pack(const SDS::ColorVertex& vertex)
+{
+	return SDS::PackedColorVertex{ vertex.pos, encode_octahedral(vertex.normal) };
+}
+
+SDS::PackedTexVertex VertexQuantization::pack(const SDS::TexVertex& vertex)
+{
+	return SDS::PackedTexVertex{ vertex.pos, encode_octahedral(vertex.normal), encode_tex_coord(vertex.texCoord) };
+}
+
+SDS::PackedSkinnedVertex VertexQuantization::pack(const SDS::SkinnedVertex& vertex)
+{
+	return SDS::PackedSkinnedVertex{
+		vertex.pos,
+		encode_octahedral(vertex.normal),
+		encode_tex_coord(vertex.texCoord),
+		encode_bone_ids(vertex.bone_ids),
+		encode_bone_weights(vertex.bone_weights)
+	};
+}
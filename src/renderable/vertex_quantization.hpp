@@ -0,0 +1,43 @@
+#pragma once
+
+#include "shared_data_structures.hpp"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+#include <utility>
+
+
+// Converts the full precision vertices used on the CPU into the compact layouts that are uploaded to the GPU
+// see the Packed*Vertex structs in shared_data_structures.txt for the exact formats
+namespace VertexQuantization
+{
+	// octahedral normal encoding into 2x snorm16, angular error stays below 0.05 degrees
+	uint32_t encode_octahedral(const glm::vec3& normal);
+	glm::vec3 decode_octahedral(uint32_t encoded);
+
+	// 2x float16
+	uint32_t encode_tex_coord(const glm::vec2& tex_coord);
+	glm::vec2 decode_tex_coord(uint32_t encoded);
+
+	// bone ids are stored in 8 bits, models with bigger skeletons are rejected when they are loaded
+	constexpr uint32_t MAX_BONES = 256;
+	bool fits_bone_ids(const glm::vec4& bone_ids);
+
+	// 4x uint8, the ids must fit, see fits_bone_ids
+	uint32_t encode_bone_ids(const glm::vec4& bone_ids);
+	glm::vec4 decode_bone_ids(uint32_t encoded);
+
+	// 4x unorm8, weights are renormalised so that the quantised weights still sum to exactly 1
+	uint32_t encode_bone_weights(const glm::vec4& bone_weights);
+	glm::vec4 decode_bone_weights(uint32_t encoded);
+
+	SDS::PackedColorVertex pack(const SDS::ColorVertex& vertex);
+	SDS::PackedTexVertex pack(const SDS::TexVertex& vertex);
+	SDS::PackedSkinnedVertex pack(const SDS::SkinnedVertex& vertex);
+
+	template<typename VertexType>
+	using PackedVertex = decltype(pack(std::declval<VertexType>()));
+}
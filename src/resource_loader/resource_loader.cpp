@@ -10,6 +10,7 @@
 #include "entity_component_system/material_system.hpp"
 #include "renderable/mesh.hpp"
 #include "renderable/material_factory.hpp"
+#include "renderable/vertex_quantization.hpp"
 #include "utility.hpp"
 
 #include <stb_image.h>
@@ -23,6 +24,7 @@
 #include <iostream>
 #include <map>
 #include <filesystem>
+#include <algorithm>
 
 
 ResourceLoader ResourceLoader::global_resource_loader;
@@ -264,6 +266,12 @@ ResourceLoader::LoadedModel ResourceLoader::load_model(const std::string_view fi
 	if (has_bones)
 	{
 		bones = load_bones(model);
+		// bone ids are uploaded as 8 bits, see VertexQuantization
+		if (bones.size() > VertexQuantization::MAX_BONES)
+		{
+			throw std::runtime_error(fmt::format("ResourceLoader::load_model: {} has {} bones, at most {} are supported",
+				file, bones.size(), VertexQuantization::MAX_BONES));
+		}
 	}
 
 	for (auto& mesh : model.meshes)
@@ -296,8 +304,15 @@ ResourceLoader::LoadedModel ResourceLoader::load_model(const std::string_view fi
 		MeshPtr new_mesh;
 		if (has_bones)
 		{
-			new_mesh = std::make_unique<SkinnedMesh>(load_vertices<SkinnedVertices>(model, primitive), std::move(indices));
-			if (!model.animations.empty())
+			auto vertices = load_vertices<SkinnedVertices>(model, primitive);
+			if (!std::ranges::all_of(vertices, [](const auto& vertex) { return VertexQuantization::fits_bone_ids(vertex.bone_ids); }))
+			{
+				throw std::runtime_error(fmt::format("ResourceLoader::load_model: {} has vertices weighted to bones outside of its skeleton", file));
+			}
+			new_mesh = std::make_unique<SkinnedMesh>(std::move(vertices), std::move(indices));
+			// the animations are shared by every skinned mesh, loading them per mesh would leave the
+			// earlier copies unreachable
+			if (!model.animations.empty() && retval.animations.empty())
 			{
 				retval.animations = load_animations(model, bones);
 			}
@@ -313,6 +328,26 @@ ResourceLoader::LoadedModel ResourceLoader::load_model(const std::string_view fi
 			renderable.pipeline_render_type = ERenderType::COLOR;
 		}
 
+		const auto stats = new_mesh->optimize();
+		LOG_INFO(Utility::get_logger(), 
+			"ResourceLoader::load_model: optimised mesh '{}', vertices {}->{}, ACMR {:.2f}->{:.2f}, ATVR {:.2f}->{:.2f}",
+			mesh.name,
+			stats.vertices_before, 
+			stats.vertices_after,
+			stats.before.acmr,
+			stats.after.acmr,
+			stats.before.atvr,
+			stats.after.atvr);
+
+		new_mesh->generate_lods();
+		const MeshLod coarsest_lod = new_mesh->get_lod(new_mesh->get_num_lods() - 1);
+		LOG_INFO(Utility::get_logger(), 
+			"ResourceLoader::load_model: generated {} LODs for mesh '{}', triangles {}->{}",
+			new_mesh->get_num_lods(),
+			mesh.name,
+			new_mesh->get_num_vertex_indices() / 3,
+			coarsest_lod.num_indices / 3);
+
 		const auto mesh_id = MeshSystem::add(std::move(new_mesh));
 		const auto mat_id = global_resource_loader.load_material(primitive, model);
 
@@ -0,0 +1,123 @@
+#include <graphics_engine/blas_refit_scheduler.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+
+namespace
+{
+	constexpr uint32_t max_refits = 4;
+	constexpr uint32_t rebuild_budget = 1;
+
+	bool is_static(ObjectID) { return false; }
+	bool is_skinned(ObjectID) { return true; }
+
+	std::vector<ObjectID> sorted(std::vector<ObjectID> ids)
+	{
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	}
+}
+
+TEST(BlasRefitScheduler, builds_new_objects_once)
+{
+	BlasRefitScheduler scheduler(max_refits, rebuild_budget);
+	const std::vector<ObjectID> traced = { ObjectID(1), ObjectID(2) };
+
+	auto updates = scheduler.update(traced, is_static);
+	ASSERT_EQ(sorted(updates.to_build), traced);
+	ASSERT_TRUE(updates.to_refit.empty());
+	ASSERT_FALSE(scheduler.is_refittable(ObjectID(1)));
+
+	updates = scheduler.update(traced, is_static);
+	ASSERT_TRUE(updates.to_build.empty());
+	ASSERT_TRUE(updates.to_refit.empty());
+	ASSERT_TRUE(updates.removed.empty());
+}
+
+TEST(BlasRefitScheduler, deformed_objects_are_refit)
+{
+	BlasRefitScheduler scheduler(max_refits, rebuild_budget);
+	const std::vector<ObjectID> traced = { ObjectID(1), ObjectID(2) };
+	scheduler.update(traced, is_skinned);
+	ASSERT_TRUE(scheduler.is_refittable(ObjectID(1)));
+
+	// only the one marked this frame
+	scheduler.mark_deformed(ObjectID(1));
+	auto updates = scheduler.update(traced, is_skinned);
+	ASSERT_TRUE(updates.to_build.empty());
+	ASSERT_EQ(updates.to_refit, std::vector<ObjectID>({ ObjectID(1) }));
+	ASSERT_EQ(scheduler.get_num_refits(ObjectID(1)), 1);
+	ASSERT_EQ(scheduler.get_num_refits(ObjectID(2)), 0);
+
+	// the marks don't carry over
+	updates = scheduler.update(traced, is_skinned);
+	ASSERT_TRUE(updates.to_refit.empty());
+}
+
+TEST(BlasRefitScheduler, static_blas_is_rebuilt_refittable)
+{
+	BlasRefitScheduler scheduler(max_refits, rebuild_budget);
+	const std::vector<ObjectID> traced = { ObjectID(1) };
+	scheduler.update(traced, is_static);
+
+	scheduler.mark_deformed(ObjectID(1));
+	auto updates = scheduler.update(traced, is_static);
+	ASSERT_EQ(updates.to_build, traced);
+	ASSERT_TRUE(updates.to_refit.empty());
+	ASSERT_TRUE(scheduler.is_refittable(ObjectID(1)));
+
+	scheduler.mark_deformed(ObjectID(1));
+	updates = scheduler.update(traced, is_static);
+	ASSERT_EQ(updates.to_refit, traced);
+}
+
+TEST(BlasRefitScheduler, worn_out_blases_are_rebuilt_within_budget)
+{
+	BlasRefitScheduler scheduler(max_refits, rebuild_budget);
+	const std::vector<ObjectID> traced = { ObjectID(1), ObjectID(2) };
+	scheduler.update(traced, is_skinned);
+
+	// object 1 starts deforming a frame earlier so it wears out first
+	scheduler.mark_deformed(ObjectID(1));
+	scheduler.update(traced, is_skinned);
+	for (uint32_t frame = 0; frame < max_refits - 1; frame++)
+	{
+		scheduler.mark_deformed(ObjectID(1));
+		scheduler.mark_deformed(ObjectID(2));
+		const auto updates = scheduler.update(traced, is_skinned);
+		ASSERT_TRUE(updates.to_build.empty());
+		ASSERT_EQ(sorted(updates.to_refit), traced);
+	}
+	ASSERT_EQ(scheduler.get_num_refits(ObjectID(1)), max_refits);
+	ASSERT_EQ(scheduler.get_num_refits(ObjectID(2)), max_refits - 1);
+
+	scheduler.mark_deformed(ObjectID(1));
+	scheduler.mark_deformed(ObjectID(2));
+	auto updates = scheduler.update(traced, is_skinned);
+	ASSERT_EQ(updates.to_build, std::vector<ObjectID>({ ObjectID(1) }));
+	ASSERT_EQ(updates.to_refit, std::vector<ObjectID>({ ObjectID(2) }));
+	ASSERT_EQ(scheduler.get_num_refits(ObjectID(1)), 0);
+
+	// both worn out now but only one rebuild a frame, the other is refit once more
+	scheduler.mark_deformed(ObjectID(1));
+	scheduler.mark_deformed(ObjectID(2));
+	updates = scheduler.update(traced, is_skinned);
+	ASSERT_EQ(updates.to_build, std::vector<ObjectID>({ ObjectID(2) }));
+	ASSERT_EQ(updates.to_refit, std::vector<ObjectID>({ ObjectID(1) }));
+}
+
+TEST(BlasRefitScheduler, untraced_objects_are_removed)
+{
+	BlasRefitScheduler scheduler(max_refits, rebuild_budget);
+	scheduler.update({ ObjectID(1), ObjectID(2) }, is_static);
+
+	auto updates = scheduler.update({ ObjectID(2) }, is_static);
+	ASSERT_EQ(updates.removed, std::vector<ObjectID>({ ObjectID(1) }));
+	ASSERT_EQ(scheduler.size(), 1);
+
+	// showing up again builds a new one
+	updates = scheduler.update({ ObjectID(1), ObjectID(2) }, is_static);
+	ASSERT_EQ(updates.to_build, std::vector<ObjectID>({ ObjectID(1) }));
+}
@@ -85,4 +85,19 @@ TEST_F(CameraTests, camera_ray_cast)
 	ray = camera.get_ray( { 0.0f, 1.0f });
 	ASSERT_TRUE(glm_equal(ray.origin, { 0.0f, 0.0f, -2.0f }));
 	ASSERT_TRUE(glm_equal(ray.direction, { 0.000000f, 0.382683f, 0.923880f }));
+}
+TEST_F(CameraTests, resize_keeps_vertical_field_of_view)
+{
+	const glm::mat4 perspective = camera.get_projection();
+	camera.on_resize(2.0f);
+	ASSERT_FLOAT_EQ(camera.get_aspect_ratio(), 2.0f);
+	ASSERT_FLOAT_EQ(camera.get_projection()[1][1], perspective[1][1]);
+	ASSERT_FLOAT_EQ(camera.get_projection()[0][0], perspective[0][0] / 2.0f);
+
+	// the orthographic view keeps its height and widens
+	camera.toggle_projection();
+	const glm::mat4 orthographic = camera.get_projection();
+	camera.on_resize(4.0f);
+	ASSERT_FLOAT_EQ(camera.get_projection()[1][1], orthographic[1][1]);
+	ASSERT_FLOAT_EQ(camera.get_projection()[0][0], orthographic[0][0] / 2.0f);
 }
\ No newline at end of file
@@ -0,0 +1,614 @@
+#include "test_helper.hpp"
+
+#include <collision/narrowphase.hpp>
+#include <collision/gjk.hpp>
+#include <collision/sweep_and_prune.hpp>
+#include <collision/collision_detector.hpp>
+#include <entity_component_system/ecs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <glm/gtx/norm.hpp>
+
+#include <random>
+#include <algorithm>
+#include <vector>
+
+
+namespace
+{
+	Maths::OBB rotated_box(const glm::vec3& center, const glm::vec3& half_extents, const glm::quat& orientation)
+	{
+		return Maths::OBB(center, half_extents, glm::mat3_cast(orientation));
+	}
+
+	glm::quat random_orientation(std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+		glm::vec3 axis(distribution(rng), distribution(rng), distribution(rng));
+		if (glm::length2(axis) < 1e-4f)
+		{
+			axis = Maths::up_vec;
+		}
+
+		return glm::angleAxis(distribution(rng) * Maths::PI, glm::normalize(axis));
+	}
+
+	bool overlaps(const AABB& bounds1, const AABB& bounds2)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (bounds1.min_bound[axis] > bounds2.max_bound[axis] || bounds2.min_bound[axis] > bounds1.max_bound[axis])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// separating the shapes along the reported normal by the reported depth should leave them just touching
+	void expect_resolved(const CollisionResult& result)
+	{
+		ASSERT_TRUE(result.bCollided);
+		EXPECT_NEAR(glm::length(result.normal), 1.0f, 1e-4f);
+		EXPECT_GE(result.penetration_depth, 0.0f);
+	}
+}
+
+TEST(Narrowphase, closest_points_between_segments)
+{
+	glm::vec3 closest1;
+	glm::vec3 closest2;
+	// crossing at right angles one unit apart
+	Narrowphase::closest_points_between_segments(
+		glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, -1.0f), glm::vec3(0.0f, 1.0f, 1.0f),
+		closest1, closest2);
+	ASSERT_TRUE(glm_equal(closest1, glm::vec3(0.0f)));
+	ASSERT_TRUE(glm_equal(closest2, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+	// the closest points are clamped to the end points
+	Narrowphase::closest_points_between_segments(
+		glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+		glm::vec3(3.0f, 1.0f, 0.0f), glm::vec3(3.0f, 2.0f, 0.0f),
+		closest1, closest2);
+	ASSERT_TRUE(glm_equal(closest1, glm::vec3(1.0f, 0.0f, 0.0f)));
+	ASSERT_TRUE(glm_equal(closest2, glm::vec3(3.0f, 1.0f, 0.0f)));
+
+	// degenerate segments are points
+	Narrowphase::closest_points_between_segments(
+		glm::vec3(0.0f), glm::vec3(0.0f),
+		glm::vec3(-1.0f, 2.0f, 0.0f), glm::vec3(1.0f, 2.0f, 0.0f),
+		closest1, closest2);
+	ASSERT_TRUE(glm_equal(closest1, glm::vec3(0.0f)));
+	ASSERT_TRUE(glm_equal(closest2, glm::vec3(0.0f, 2.0f, 0.0f)));
+}
+
+TEST(Narrowphase, sphere_sphere)
+{
+	const Maths::Sphere sphere1(glm::vec3(0.0f), 1.0f);
+	const auto result = Narrowphase::sphere_sphere(sphere1, Maths::Sphere(glm::vec3(1.5f, 0.0f, 0.0f), 1.0f));
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::right_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.5f, 1e-5f);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(0.75f, 0.0f, 0.0f)));
+
+	ASSERT_FALSE(Narrowphase::sphere_sphere(sphere1, Maths::Sphere(glm::vec3(0.0f, 2.1f, 0.0f), 1.0f)).bCollided);
+
+	// concentric spheres still get a valid normal
+	expect_resolved(Narrowphase::sphere_sphere(sphere1, Maths::Sphere(glm::vec3(0.0f), 0.5f)));
+}
+
+TEST(Narrowphase, sphere_box)
+{
+	const Maths::OBB box(glm::vec3(0.0f), glm::vec3(1.0f));
+
+	// face
+	auto result = Narrowphase::sphere_box(Maths::Sphere(glm::vec3(0.0f, 1.25f, 0.0f), 0.5f), box);
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, -Maths::up_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.25f, 1e-5f);
+
+	// corner
+	const glm::vec3 corner_offset = glm::normalize(glm::vec3(1.0f)) * 0.4f;
+	result = Narrowphase::sphere_box(Maths::Sphere(glm::vec3(1.0f) + corner_offset, 0.5f), box);
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, -glm::normalize(glm::vec3(1.0f))));
+	ASSERT_NEAR(result.penetration_depth, 0.1f, 1e-5f);
+
+	ASSERT_FALSE(Narrowphase::sphere_box(Maths::Sphere(glm::vec3(1.0f) + corner_offset * 1.5f, 0.5f), box).bCollided);
+
+	// the center is inside, it leaves through the nearest face
+	result = Narrowphase::sphere_box(Maths::Sphere(glm::vec3(0.0f, 0.0f, -0.8f), 0.5f), box);
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::forward_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.7f, 1e-5f);
+
+	// a rotated box is only hit within its own extents
+	const Maths::OBB rotated = rotated_box(glm::vec3(0.0f), glm::vec3(1.0f), glm::angleAxis(Maths::PI / 4.0f, Maths::up_vec));
+	ASSERT_TRUE(Narrowphase::sphere_box(Maths::Sphere(glm::vec3(1.6f, 0.0f, 0.0f), 0.25f), rotated).bCollided);
+	ASSERT_FALSE(Narrowphase::sphere_box(Maths::Sphere(glm::vec3(1.6f, 0.0f, 0.0f), 0.25f), box).bCollided);
+}
+
+TEST(Narrowphase, sphere_capsule)
+{
+	const Maths::Capsule capsule(glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.5f);
+
+	auto result = Narrowphase::sphere_capsule(Maths::Sphere(glm::vec3(0.75f, 0.5f, 0.0f), 0.5f), capsule);
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, -Maths::right_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.25f, 1e-5f);
+
+	// beyond the end the cap is round
+	result = Narrowphase::sphere_capsule(Maths::Sphere(glm::vec3(0.0f, 2.0f, 0.0f), 0.75f), capsule);
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, -Maths::up_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.25f, 1e-5f);
+
+	ASSERT_FALSE(Narrowphase::sphere_capsule(Maths::Sphere(glm::vec3(0.8f, 1.8f, 0.0f), 0.5f), capsule).bCollided);
+}
+
+TEST(Narrowphase, capsule_capsule)
+{
+	const Maths::Capsule capsule1(glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 0.5f);
+
+	// crossing
+	auto result = Narrowphase::capsule_capsule(capsule1, Maths::Capsule(glm::vec3(0.0f, 0.75f, -1.0f), glm::vec3(0.0f, 0.75f, 1.0f), 0.5f));
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::up_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.25f, 1e-5f);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(0.0f, 0.375f, 0.0f)));
+
+	// parallel
+	result = Narrowphase::capsule_capsule(capsule1, Maths::Capsule(glm::vec3(0.0f, 0.0f, 0.9f), glm::vec3(2.0f, 0.0f, 0.9f), 0.5f));
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::forward_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.1f, 1e-5f);
+
+	// end to end
+	ASSERT_TRUE(Narrowphase::capsule_capsule(capsule1, Maths::Capsule(glm::vec3(1.9f, 0.0f, 0.0f), glm::vec3(3.0f, 0.0f, 0.0f), 0.5f)).bCollided);
+	ASSERT_FALSE(Narrowphase::capsule_capsule(capsule1, Maths::Capsule(glm::vec3(2.1f, 0.0f, 0.0f), glm::vec3(3.0f, 0.0f, 0.0f), 0.5f)).bCollided);
+}
+
+TEST(Narrowphase, box_box_faces)
+{
+	const Maths::OBB box1(glm::vec3(0.0f), glm::vec3(1.0f));
+
+	auto result = Narrowphase::box_box(box1, Maths::OBB(glm::vec3(1.8f, 0.5f, 0.0f), glm::vec3(1.0f)));
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::right_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.2f, 1e-5f);
+	// the contact lies in the overlap region
+	ASSERT_NEAR(result.intersection.x, 0.9f, 1e-4f);
+	ASSERT_GE(result.intersection.y, -0.5f);
+	ASSERT_LE(result.intersection.y, 1.0f);
+
+	// a small box resting on a large one
+	result = Narrowphase::box_box(Maths::OBB(glm::vec3(0.0f), glm::vec3(10.0f, 1.0f, 10.0f)), Maths::OBB(glm::vec3(5.0f, 1.2f, 0.0f), glm::vec3(0.25f)));
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::up_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.05f, 1e-5f);
+	ASSERT_NEAR(result.intersection.x, 5.0f, 0.25f);
+
+	ASSERT_FALSE(Narrowphase::box_box(box1, Maths::OBB(glm::vec3(0.0f, 0.0f, -2.1f), glm::vec3(1.0f))).bCollided);
+}
+
+TEST(Narrowphase, box_box_rotated)
+{
+	const Maths::OBB box1(glm::vec3(0.0f), glm::vec3(1.0f));
+	// a 45 degree box's corner reaches out to sqrt(2)
+	const glm::quat rotation = glm::angleAxis(Maths::PI / 4.0f, Maths::up_vec);
+	auto result = Narrowphase::box_box(box1, rotated_box(glm::vec3(2.3f, 0.0f, 0.0f), glm::vec3(1.0f), rotation));
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::right_vec));
+	ASSERT_NEAR(result.penetration_depth, std::sqrt(2.0f) - 1.3f, 1e-4f);
+
+	ASSERT_FALSE(Narrowphase::box_box(box1, rotated_box(glm::vec3(2.5f, 0.0f, 0.0f), glm::vec3(1.0f), rotation)).bCollided);
+
+	// two boxes rotated about different axes are only separated by an edge-edge axis:
+	// their face axes overlap but their edges pass each other
+	const Maths::OBB edge1 = rotated_box(glm::vec3(0.0f), glm::vec3(1.0f), glm::angleAxis(Maths::PI / 4.0f, Maths::forward_vec));
+	const Maths::OBB edge2 = rotated_box(glm::vec3(0.0f, 2.0f * std::sqrt(2.0f) + 0.05f, 0.0f), glm::vec3(1.0f), glm::angleAxis(Maths::PI / 4.0f, Maths::right_vec));
+	ASSERT_FALSE(Narrowphase::box_box(edge1, edge2).bCollided);
+	const Maths::OBB edge3 = rotated_box(glm::vec3(0.0f, 2.0f * std::sqrt(2.0f) - 0.05f, 0.0f), glm::vec3(1.0f), glm::angleAxis(Maths::PI / 4.0f, Maths::right_vec));
+	result = Narrowphase::box_box(edge1, edge3);
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::up_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.05f, 1e-4f);
+}
+
+TEST(Narrowphase, box_capsule)
+{
+	const Maths::OBB box(glm::vec3(0.0f), glm::vec3(1.0f));
+
+	// lying on top of the box
+	auto result = Narrowphase::box_capsule(box, Maths::Capsule(glm::vec3(-2.0f, 1.4f, 0.0f), glm::vec3(2.0f, 1.4f, 0.0f), 0.5f));
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::up_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.1f, 1e-4f);
+
+	// touching an edge with its side
+	const glm::vec3 diagonal = glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f));
+	result = Narrowphase::box_capsule(box, Maths::Capsule(glm::vec3(1.0f, 1.0f, -3.0f) + diagonal * 0.3f, glm::vec3(1.0f, 1.0f, 3.0f) + diagonal * 0.3f, 0.5f));
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, diagonal));
+	ASSERT_NEAR(result.penetration_depth, 0.2f, 1e-4f);
+
+	ASSERT_FALSE(Narrowphase::box_capsule(box, Maths::Capsule(glm::vec3(1.0f, 1.0f, -3.0f) + diagonal * 0.6f, glm::vec3(1.0f, 1.0f, 3.0f) + diagonal * 0.6f, 0.5f)).bCollided);
+
+	// the core goes straight through the box, it is pushed out along the closest face
+	result = Narrowphase::box_capsule(box, Maths::Capsule(glm::vec3(-3.0f, 0.8f, 0.0f), glm::vec3(3.0f, 0.8f, 0.0f), 0.25f));
+	expect_resolved(result);
+	ASSERT_TRUE(glm_equal(result.normal, Maths::up_vec));
+	ASSERT_NEAR(result.penetration_depth, 0.45f, 1e-4f);
+}
+
+TEST(Narrowphase, ray_box)
+{
+	const Maths::OBB box(glm::vec3(0.0f), glm::vec3(1.0f));
+
+	auto result = Narrowphase::ray_box(Maths::Ray(glm::vec3(-5.0f, 0.5f, 0.0f), Maths::right_vec), box);
+	ASSERT_TRUE(result.bCollided);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(-1.0f, 0.5f, 0.0f)));
+	ASSERT_TRUE(glm_equal(result.normal, Maths::right_vec));
+
+	result = Narrowphase::ray_box(Maths::Ray(glm::vec3(0.0f, 5.0f, 0.0f), -Maths::up_vec), box);
+	ASSERT_TRUE(result.bCollided);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(0.0f, 1.0f, 0.0f)));
+	ASSERT_TRUE(glm_equal(result.normal, -Maths::up_vec));
+
+	// behind, beside and parallel to a face
+	ASSERT_FALSE(Narrowphase::ray_box(Maths::Ray(glm::vec3(-5.0f, 0.0f, 0.0f), -Maths::right_vec), box).bCollided);
+	ASSERT_FALSE(Narrowphase::ray_box(Maths::Ray(glm::vec3(-5.0f, 1.5f, 0.0f), Maths::right_vec), box).bCollided);
+	ASSERT_FALSE(Narrowphase::ray_box(Maths::Ray(glm::vec3(-5.0f, 0.0f, 0.0f), glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f))), box).bCollided);
+
+	// from inside
+	result = Narrowphase::ray_box(Maths::Ray(glm::vec3(0.5f), Maths::right_vec), box);
+	ASSERT_TRUE(result.bCollided);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(0.5f)));
+
+	// rotated, the corner sticks out towards the ray
+	const Maths::OBB rotated = rotated_box(glm::vec3(0.0f), glm::vec3(1.0f), glm::angleAxis(Maths::PI / 4.0f, Maths::up_vec));
+	result = Narrowphase::ray_box(Maths::Ray(glm::vec3(-5.0f, 0.0f, 0.0f), Maths::right_vec), rotated);
+	ASSERT_TRUE(result.bCollided);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(-std::sqrt(2.0f), 0.0f, 0.0f)));
+}
+
+TEST(Narrowphase, ray_capsule)
+{
+	const Maths::Capsule capsule(glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.5f);
+
+	// cylinder
+	auto result = Narrowphase::ray_capsule(Maths::Ray(glm::vec3(-5.0f, 0.5f, 0.0f), Maths::right_vec), capsule);
+	ASSERT_TRUE(result.bCollided);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(-0.5f, 0.5f, 0.0f)));
+	ASSERT_TRUE(glm_equal(result.normal, Maths::right_vec));
+
+	// caps, including along the axis where the cylinder is degenerate
+	result = Narrowphase::ray_capsule(Maths::Ray(glm::vec3(0.0f, 5.0f, 0.0f), -Maths::up_vec), capsule);
+	ASSERT_TRUE(result.bCollided);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(0.0f, 1.5f, 0.0f)));
+	result = Narrowphase::ray_capsule(Maths::Ray(glm::vec3(-5.0f, -1.25f, 0.0f), Maths::right_vec), capsule);
+	ASSERT_TRUE(result.bCollided);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(-std::sqrt(0.25f - 0.0625f), -1.25f, 0.0f)));
+
+	ASSERT_FALSE(Narrowphase::ray_capsule(Maths::Ray(glm::vec3(-5.0f, 1.6f, 0.0f), Maths::right_vec), capsule).bCollided);
+	ASSERT_FALSE(Narrowphase::ray_capsule(Maths::Ray(glm::vec3(-5.0f, 0.0f, 0.0f), -Maths::right_vec), capsule).bCollided);
+
+	result = Narrowphase::ray_capsule(Maths::Ray(glm::vec3(0.0f, 0.2f, 0.1f), Maths::right_vec), capsule);
+	ASSERT_TRUE(result.bCollided);
+	ASSERT_TRUE(glm_equal(result.intersection, glm::vec3(0.0f, 0.2f, 0.1f)));
+}
+
+TEST(GJK, box_distances)
+{
+	const GJK::Box box1(Maths::OBB(glm::vec3(0.0f), glm::vec3(1.0f)));
+
+	auto result = GJK::distance(box1, GJK::Box(Maths::OBB(glm::vec3(3.5f, 0.5f, 0.0f), glm::vec3(1.0f))));
+	ASSERT_FALSE(result.intersecting);
+	ASSERT_NEAR(result.distance, 1.5f, 1e-4f);
+	ASSERT_NEAR(result.closest_a.x, 1.0f, 1e-4f);
+	ASSERT_NEAR(result.closest_b.x, 2.5f, 1e-4f);
+
+	// corner to corner
+	result = GJK::distance(box1, GJK::Box(Maths::OBB(glm::vec3(3.0f), glm::vec3(1.0f))));
+	ASSERT_FALSE(result.intersecting);
+	ASSERT_NEAR(result.distance, std::sqrt(3.0f), 1e-4f);
+	ASSERT_TRUE(glm_equal(result.closest_a, glm::vec3(1.0f)));
+	ASSERT_TRUE(glm_equal(result.closest_b, glm::vec3(2.0f)));
+
+	ASSERT_TRUE(GJK::distance(box1, GJK::Box(Maths::OBB(glm::vec3(1.5f, 0.2f, -0.3f), glm::vec3(1.0f)))).intersecting);
+	ASSERT_TRUE(GJK::distance(box1, GJK::Point(glm::vec3(0.1f, -0.2f, 0.3f))).intersecting);
+}
+
+TEST(GJK, segment_distances)
+{
+	const GJK::Box box(Maths::OBB(glm::vec3(0.0f), glm::vec3(1.0f)));
+
+	auto result = GJK::distance(box, GJK::Segment(glm::vec3(-3.0f, 2.0f, 0.5f), glm::vec3(3.0f, 2.0f, 0.5f)));
+	ASSERT_FALSE(result.intersecting);
+	ASSERT_NEAR(result.distance, 1.0f, 1e-4f);
+	ASSERT_NEAR(result.closest_b.y, 2.0f, 1e-4f);
+	ASSERT_NEAR(result.closest_b.z, 0.5f, 1e-4f);
+
+	// diagonal past an edge
+	result = GJK::distance(box, GJK::Segment(glm::vec3(2.0f, 2.0f, -5.0f), glm::vec3(2.0f, 2.0f, 5.0f)));
+	ASSERT_NEAR(result.distance, std::sqrt(2.0f), 1e-4f);
+
+	ASSERT_TRUE(GJK::distance(box, GJK::Segment(glm::vec3(-3.0f, 0.5f, 0.5f), glm::vec3(3.0f, 0.5f, 0.5f))).intersecting);
+}
+
+TEST(GJK, agrees_with_separating_axes)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> position(-2.5f, 2.5f);
+	std::uniform_real_distribution<float> extent(0.2f, 1.2f);
+	uint32_t num_intersecting = 0;
+	for (uint32_t i = 0; i < 2000; i++)
+	{
+		const Maths::OBB box1 = rotated_box(glm::vec3(0.0f), glm::vec3(extent(rng), extent(rng), extent(rng)), random_orientation(rng));
+		const Maths::OBB box2 = rotated_box(glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(extent(rng), extent(rng), extent(rng)), random_orientation(rng));
+
+		const auto sat = Narrowphase::box_box(box1, box2);
+		const auto gjk = GJK::distance(GJK::Box(box1), GJK::Box(box2));
+		// right at the boundary the two may disagree due to rounding
+		if (!gjk.intersecting && gjk.distance < 1e-3f)
+		{
+			continue;
+		}
+
+		ASSERT_EQ(sat.bCollided, gjk.intersecting) << "pair " << i;
+		if (gjk.intersecting)
+		{
+			num_intersecting++;
+			// pushing the second box out along the normal has to separate them
+			Maths::OBB separated = box2;
+			separated.center += sat.normal * (sat.penetration_depth + 1e-3f);
+			ASSERT_FALSE(Narrowphase::box_box(box1, separated).bCollided) << "pair " << i;
+		} else
+		{
+			// the witness points lie on the boxes
+			ASSERT_LT(glm::distance(Narrowphase::closest_point_on_box(gjk.closest_a, box1), gjk.closest_a), 1e-3f);
+			ASSERT_LT(glm::distance(Narrowphase::closest_point_on_box(gjk.closest_b, box2), gjk.closest_b), 1e-3f);
+			ASSERT_NEAR(glm::distance(gjk.closest_a, gjk.closest_b), gjk.distance, 1e-3f);
+		}
+	}
+	// both outcomes are covered
+	ASSERT_GT(num_intersecting, 100);
+	ASSERT_LT(num_intersecting, 1900);
+}
+
+TEST(Colliders, transformed_data_and_bounds)
+{
+	BoxCollider box(Maths::OBB(glm::vec3(0.0f), glm::vec3(1.0f, 2.0f, 1.0f)));
+	box.set_temporary_transform(Maths::Transform(glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(2.0f), glm::angleAxis(Maths::PI / 2.0f, Maths::forward_vec)));
+	const auto obb = box.get_data();
+	ASSERT_TRUE(glm_equal(obb.center, glm::vec3(5.0f, 0.0f, 0.0f)));
+	ASSERT_TRUE(glm_equal(obb.half_extents, glm::vec3(2.0f, 4.0f, 2.0f)));
+	// the long axis now lies along x
+	const auto bounds = box.get_bounding_box();
+	ASSERT_TRUE(glm_equal(bounds.min_bound, glm::vec3(1.0f, -2.0f, -2.0f)));
+	ASSERT_TRUE(glm_equal(bounds.max_bound, glm::vec3(9.0f, 2.0f, 2.0f)));
+
+	CapsuleCollider capsule(Maths::Capsule(glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.5f));
+	capsule.set_temporary_transform(Maths::Transform(glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f), glm::angleAxis(Maths::PI / 2.0f, Maths::right_vec)));
+	const auto capsule_bounds = capsule.get_bounding_box();
+	ASSERT_TRUE(glm_equal(capsule_bounds.min_bound, glm::vec3(-0.5f, -0.5f, -0.5f)));
+	ASSERT_TRUE(glm_equal(capsule_bounds.max_bound, glm::vec3(0.5f, 0.5f, 2.5f)));
+}
+
+TEST(CollisionDetector, dispatches_both_orders)
+{
+	SphereCollider sphere(Maths::Sphere(glm::vec3(0.0f, 1.2f, 0.0f), 0.5f));
+	BoxCollider box(Maths::OBB(glm::vec3(0.0f), glm::vec3(1.0f)));
+	CapsuleCollider capsule(Maths::Capsule(glm::vec3(-1.0f, -1.3f, 0.0f), glm::vec3(1.0f, -1.3f, 0.0f), 0.5f));
+
+	const auto sphere_box = CollisionDetector::check_collision(&sphere, &box);
+	const auto box_sphere = CollisionDetector::check_collision(&box, &sphere);
+	ASSERT_TRUE(sphere_box.bCollided);
+	ASSERT_TRUE(box_sphere.bCollided);
+	ASSERT_TRUE(glm_equal(sphere_box.normal, -Maths::up_vec));
+	ASSERT_TRUE(glm_equal(box_sphere.normal, Maths::up_vec));
+	ASSERT_FLOAT_EQ(sphere_box.penetration_depth, box_sphere.penetration_depth);
+
+	ASSERT_TRUE(CollisionDetector::check_collision(&capsule, &box).bCollided);
+	ASSERT_TRUE(glm_equal(CollisionDetector::check_collision(&capsule, &box).normal, Maths::up_vec));
+	ASSERT_FALSE(CollisionDetector::check_collision(&capsule, &sphere).bCollided);
+
+	RayCollider ray(Maths::Ray(glm::vec3(0.0f, 0.0f, -5.0f), Maths::forward_vec));
+	ASSERT_TRUE(CollisionDetector::check_collision(&ray, &box).bCollided);
+	ASSERT_TRUE(CollisionDetector::check_collision(&capsule, &ray).bCollided == false);
+	// rays don't collide with each other
+	ASSERT_FALSE(CollisionDetector::check_collision(&ray, &ray).bCollided);
+}
+
+TEST(CollisionDetector, custom_detector)
+{
+	const CollisionType type{ ECollider::RAY, ECollider::RAY };
+	CollisionDetector::add_collision_detector(type, [](const Collider*, const Collider*)
+	{
+		return CollisionResult{ true, glm::vec3(0.0f), Maths::up_vec, 0.0f };
+	});
+
+	RayCollider ray(Maths::Ray(glm::vec3(0.0f), Maths::forward_vec));
+	ASSERT_TRUE(CollisionDetector::check_collision(&ray, &ray).bCollided);
+
+	CollisionDetector::remove_collision_detector(type);
+	ASSERT_FALSE(CollisionDetector::check_collision(&ray, &ray).bCollided);
+}
+
+TEST(SweepAndPrune, matches_brute_force)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> position(0.0f, 50.0f);
+	std::uniform_real_distribution<float> size(0.1f, 2.0f);
+	std::uniform_real_distribution<float> velocity(-0.5f, 0.5f);
+
+	struct Body
+	{
+		ObjectID id;
+		SweepAndPrune::ProxyID proxy;
+		AABB bounds;
+		glm::vec3 velocity;
+	};
+	SweepAndPrune broadphase;
+	std::vector<Body> bodies;
+	const auto add_body = [&]()
+	{
+		const glm::vec3 min(position(rng), position(rng), position(rng) * 0.2f);
+		const AABB bounds(min, min + glm::vec3(size(rng), size(rng), size(rng)));
+		const ObjectID id = ObjectID::generate_new_id();
+		bodies.push_back(Body{ id, broadphase.add(id, bounds), bounds, glm::vec3(velocity(rng), velocity(rng), velocity(rng)) });
+	};
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		add_body();
+	}
+
+	for (uint32_t tick = 0; tick < 30; tick++)
+	{
+		// churn, some leave and some join
+		for (uint32_t i = 0; i < 10; i++)
+		{
+			const size_t index = rng() % bodies.size();
+			broadphase.remove(bodies[index].proxy);
+			bodies.erase(bodies.begin() + index);
+			add_body();
+		}
+		for (auto& body : bodies)
+		{
+			body.bounds += body.velocity;
+			broadphase.set_bounds(body.proxy, body.bounds);
+		}
+
+		auto pairs = broadphase.update();
+		std::vector<SweepAndPrune::Pair> expected;
+		for (size_t i = 0; i < bodies.size(); i++)
+		{
+			for (size_t j = i + 1; j < bodies.size(); j++)
+			{
+				if (overlaps(bodies[i].bounds, bodies[j].bounds))
+				{
+					expected.emplace_back(std::min(bodies[i].id, bodies[j].id), std::max(bodies[i].id, bodies[j].id));
+				}
+			}
+		}
+		std::sort(pairs.begin(), pairs.end());
+		std::sort(expected.begin(), expected.end());
+		ASSERT_FALSE(expected.empty());
+		ASSERT_EQ(pairs, expected) << "tick " << tick;
+		ASSERT_EQ(broadphase.size(), bodies.size());
+	}
+	// z has the smallest spread so it is never the sort axis
+	ASSERT_NE(broadphase.get_sort_axis(), 2);
+	ASSERT_GT(broadphase.get_num_cells(), 1);
+}
+
+TEST(SweepAndPrune, follows_changing_layouts)
+{
+	// a row along x that turns into a row along z, the sort axis and the grid have to follow
+	SweepAndPrune broadphase;
+	std::vector<SweepAndPrune::ProxyID> proxies;
+	std::vector<ObjectID> ids;
+	for (uint32_t i = 0; i < 200; i++)
+	{
+		ids.push_back(ObjectID::generate_new_id());
+		const glm::vec3 min(float(i) * 0.9f, float(i % 2), 0.0f);
+		proxies.push_back(broadphase.add(ids.back(), AABB(min, min + glm::vec3(1.0f))));
+	}
+	// neighbours along the row overlap, every other one is shifted up by a unit which still touches
+	ASSERT_EQ(broadphase.update().size(), 199);
+	ASSERT_EQ(broadphase.get_sort_axis(), 0);
+
+	for (uint32_t i = 0; i < 200; i++)
+	{
+		const glm::vec3 min(0.0f, 0.0f, float(i) * 2.0f);
+		broadphase.set_bounds(proxies[i], AABB(min, min + glm::vec3(1.0f)));
+	}
+	ASSERT_TRUE(broadphase.update().empty());
+	ASSERT_EQ(broadphase.get_sort_axis(), 2);
+
+	// everything piled up in one spot
+	for (uint32_t i = 0; i < 200; i++)
+	{
+		broadphase.set_bounds(proxies[i], AABB(glm::vec3(0.0f), glm::vec3(1.0f)));
+	}
+	ASSERT_EQ(broadphase.update().size(), 200 * 199 / 2);
+}
+
+TEST(SweepAndPrune, remove_unknown_proxy)
+{
+	SweepAndPrune broadphase;
+	const auto proxy = broadphase.add(ObjectID::generate_new_id(), AABB(glm::vec3(0.0f), glm::vec3(1.0f)));
+	broadphase.remove(proxy);
+	ASSERT_THROW(broadphase.remove(proxy), std::runtime_error);
+	ASSERT_TRUE(broadphase.update().empty());
+}
+
+class ColliderECSFixture : public testing::Test
+{
+public:
+	ColliderECSFixture()
+	{
+		ecs.add_object(sphere_object);
+		ecs.add_object(box_object);
+		ecs.add_object(capsule_object);
+		ecs.add_object(ray_object);
+
+		box_object.set_position(glm::vec3(0.8f, 0.0f, 0.0f));
+		capsule_object.set_position(glm::vec3(10.0f, 0.0f, 0.0f));
+
+		ecs.add_collider(sphere_object.get_id(), std::make_unique<SphereCollider>(Maths::Sphere{}));
+		ecs.add_collider(box_object.get_id(), std::make_unique<BoxCollider>(Maths::OBB{}));
+		ecs.add_collider(capsule_object.get_id(), std::make_unique<CapsuleCollider>(Maths::Capsule{}));
+		ecs.add_collider(ray_object.get_id(), std::make_unique<RayCollider>(Maths::Ray{ glm::vec3(-5.0f, 0.0f, 0.0f), Maths::right_vec }));
+	}
+
+	ECS ecs;
+	Object sphere_object;
+	Object box_object;
+	Object capsule_object;
+	Object ray_object;
+};
+
+TEST_F(ColliderECSFixture, contacts_follow_transforms)
+{
+	ecs.update_contacts();
+	ASSERT_EQ(ecs.get_contacts().size(), 1);
+	const auto& contact = ecs.get_contacts().front();
+	ASSERT_EQ(std::min(contact.entity1, contact.entity2), std::min(sphere_object.get_id(), box_object.get_id()));
+	ASSERT_EQ(std::max(contact.entity1, contact.entity2), std::max(sphere_object.get_id(), box_object.get_id()));
+	ASSERT_NEAR(contact.result.penetration_depth, 0.2f, 1e-4f);
+	// the normal points from entity1 to entity2
+	const glm::vec3 expected_normal = contact.entity1 == sphere_object.get_id() ? Maths::right_vec : -Maths::right_vec;
+	ASSERT_TRUE(glm_equal(contact.result.normal, expected_normal));
+
+	// moving the capsule onto the box and the sphere away swaps the contact
+	capsule_object.set_position(glm::vec3(0.8f, 1.2f, 0.0f));
+	sphere_object.set_position(glm::vec3(-10.0f, 0.0f, 0.0f));
+	ecs.update_contacts();
+	ASSERT_EQ(ecs.get_contacts().size(), 1);
+	ASSERT_TRUE(ecs.get_contacts().front().entity1 == capsule_object.get_id() || ecs.get_contacts().front().entity2 == capsule_object.get_id());
+	ASSERT_TRUE(ecs.get_contacts().front().entity1 == box_object.get_id() || ecs.get_contacts().front().entity2 == box_object.get_id());
+}
+
+TEST_F(ColliderECSFixture, removed_colliders_stop_colliding)
+{
+	ecs.process(0.0f);
+	ASSERT_EQ(ecs.get_contacts().size(), 1);
+
+	ecs.remove_collider(box_object.get_id());
+	ecs.process(0.0f);
+	ASSERT_TRUE(ecs.get_contacts().empty());
+	ASSERT_EQ(ecs.get_collider(box_object.get_id()), nullptr);
+
+	// and can be added again
+	ecs.add_collider(box_object.get_id(), std::make_unique<BoxCollider>(Maths::OBB{}));
+	ecs.process(0.0f);
+	ASSERT_EQ(ecs.get_contacts().size(), 1);
+
+	ecs.remove_object(sphere_object.get_id());
+	ecs.process(0.0f);
+	ASSERT_TRUE(ecs.get_contacts().empty());
+}
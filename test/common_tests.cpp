@@ -2,9 +2,14 @@
 
 #include <shared_data_structures.hpp>
 #include <renderable/material.hpp>
+#include <entity_component_system/material_system.hpp>
+#include <entity_component_system/slot_map.hpp>
 
 #include <gtest/gtest.h>
 
+#include <numeric>
+#include <random>
+
 
 TEST(Basics, MaterialMoveCtor)
 {
@@ -16,3 +21,181 @@ TEST(Basics, MaterialMoveCtor)
 
 	ASSERT_EQ(material2.data.shininess, 2.5f);
 }
+
+TEST(SlotMap, insert_and_get)
+{
+	SlotMap<int> slot_map;
+	const auto handle1 = slot_map.insert(1);
+	const auto handle2 = slot_map.insert(2);
+
+	ASSERT_EQ(slot_map.size(), 2);
+	ASSERT_EQ(slot_map[handle1], 1);
+	ASSERT_EQ(slot_map[handle2], 2);
+	ASSERT_FALSE(slot_map.contains(SlotMap<int>::Handle{}));
+}
+
+TEST(SlotMap, stale_handle_detection)
+{
+	SlotMap<int> slot_map;
+	const auto handle1 = slot_map.insert(1);
+	ASSERT_TRUE(slot_map.erase(handle1));
+	ASSERT_FALSE(slot_map.erase(handle1));
+
+	// the slot is recycled but the old handle must not alias the new value
+	const auto handle2 = slot_map.insert(2);
+	ASSERT_EQ(handle1.index, handle2.index);
+	ASSERT_FALSE(slot_map.contains(handle1));
+	ASSERT_EQ(slot_map.get(handle1), nullptr);
+	ASSERT_EQ(*slot_map.get(handle2), 2);
+}
+
+TEST(SlotMap, contiguous_iteration)
+{
+	SlotMap<int> slot_map;
+	std::vector<SlotMap<int>::Handle> handles;
+	for (int i = 0; i < 10; i++)
+	{
+		handles.push_back(slot_map.insert(int(i)));
+	}
+	slot_map.erase(handles[0]);
+	slot_map.erase(handles[5]);
+
+	ASSERT_EQ(&*slot_map.end() - &*slot_map.begin(), 8);
+	const int sum = std::accumulate(slot_map.begin(), slot_map.end(), 0);
+	ASSERT_EQ(sum, 45 - 0 - 5);
+	for (int i = 0; i < 10; i++)
+	{
+		if (i == 0 || i == 5)
+		{
+			continue;
+		}
+		ASSERT_EQ(slot_map[handles[i]], i);
+	}
+}
+
+TEST(SlotMap, stress)
+{
+	SlotMap<uint32_t> slot_map;
+	std::vector<std::pair<SlotMap<uint32_t>::Handle, uint32_t>> live;
+	std::vector<SlotMap<uint32_t>::Handle> dead;
+	std::mt19937 rng(0);
+	for (uint32_t i = 0; i < 100000; i++)
+	{
+		if (live.empty() || rng() % 3 != 0)
+		{
+			live.emplace_back(slot_map.insert(uint32_t(i)), i);
+		} else
+		{
+			const size_t victim = rng() % live.size();
+			ASSERT_TRUE(slot_map.erase(live[victim].first));
+			dead.push_back(live[victim].first);
+			live[victim] = live.back();
+			live.pop_back();
+		}
+	}
+
+	ASSERT_EQ(slot_map.size(), live.size());
+	for (const auto& [handle, value] : live)
+	{
+		ASSERT_EQ(slot_map[handle], value);
+	}
+	for (const auto& handle : dead)
+	{
+		ASSERT_FALSE(slot_map.contains(handle));
+	}
+}
+
+TEST(CountableSystem, spawn_and_delete_storm)
+{
+	const size_t initial_size = MaterialSystem::size();
+	std::vector<MaterialID> ids;
+	for (int round = 0; round < 10; round++)
+	{
+		for (int i = 0; i < 10000; i++)
+		{
+			ids.push_back(MaterialSystem::add(std::make_unique<ColorMaterial>()));
+		}
+		ASSERT_EQ(MaterialSystem::size(), initial_size + ids.size());
+
+		for (const auto id : ids)
+		{
+			ASSERT_EQ(MaterialSystem::register_owner(id), 2);
+			ASSERT_EQ(MaterialSystem::unregister_owner(id), 1);
+			ASSERT_EQ(MaterialSystem::unregister_owner(id), 0);
+		}
+
+		// recycled slots must not resurrect deleted ids
+		for (const auto id : ids)
+		{
+			ASSERT_EQ(MaterialSystem::get_num_owners(id), 0);
+			EXPECT_THROW(MaterialSystem::get(id), std::runtime_error);
+		}
+		ids.clear();
+	}
+
+	ASSERT_EQ(MaterialSystem::size(), initial_size);
+}
+
+TEST(CountableSystem, storm_id_table_stays_bounded)
+{
+	// a long-lived material from before the storm must not pin the id table to every id since
+	const MaterialID survivor = MaterialSystem::add(std::make_unique<ColorMaterial>());
+	const size_t initial_size = MaterialSystem::size();
+	std::vector<MaterialID> ids;
+	size_t peak_table_size = 0;
+	for (int round = 0; round < 100; round++)
+	{
+		for (int i = 0; i < 1000; i++)
+		{
+			ids.push_back(MaterialSystem::add(std::make_unique<ColorMaterial>()));
+		}
+		for (const auto id : ids)
+		{
+			MaterialSystem::unregister_owner(id);
+		}
+		ids.clear();
+		peak_table_size = std::max(peak_table_size, MaterialSystem::get_id_table_size());
+	}
+
+	// 100k ids were added but never more than 1000 were live at once
+	ASSERT_LT(peak_table_size, 4 * (initial_size + 1000));
+	ASSERT_EQ(MaterialSystem::size(), initial_size);
+	ASSERT_EQ(MaterialSystem::get(survivor).get_id(), survivor);
+	ASSERT_EQ(MaterialSystem::unregister_owner(survivor), 0);
+	EXPECT_THROW(MaterialSystem::get(survivor), std::runtime_error);
+}
+
+TEST(CountableSystem, interleaved_owners)
+{
+	std::vector<MaterialID> ids;
+	for (int i = 0; i < 1000; i++)
+	{
+		ids.push_back(MaterialSystem::add(std::make_unique<ColorMaterial>()));
+	}
+
+	// delete every other material, the survivors must remain retrievable
+	for (size_t i = 0; i < ids.size(); i += 2)
+	{
+		MaterialSystem::unregister_owner(ids[i]);
+	}
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		if (i % 2 == 0)
+		{
+			EXPECT_THROW(MaterialSystem::get(ids[i]), std::runtime_error);
+		} else
+		{
+			ASSERT_EQ(MaterialSystem::get(ids[i]).get_id(), ids[i]);
+			ASSERT_EQ(MaterialSystem::get_num_owners(ids[i]), 1);
+		}
+	}
+
+	size_t num_visited = 0;
+	MaterialSystem::for_each([&num_visited](Material&) { ++num_visited; });
+	ASSERT_EQ(num_visited, MaterialSystem::size());
+
+	for (size_t i = 1; i < ids.size(); i += 2)
+	{
+		MaterialSystem::unregister_owner(ids[i]);
+	}
+}
@@ -96,4 +96,22 @@ TEST_F(GraphicsBufferFixture, alignment)
 	EXPECT_THROW(buffer2.reserve_slot(id++, 28), std::runtime_error);
 
 	ASSERT_EQ(buffer2.reserve_slot(id++, 24), 76);
+}
+
+TEST_F(GraphicsBufferFixture, retired_slot_keeps_memory_until_released)
+{
+	uint32_t id = 0;
+	ASSERT_EQ(buffer1.reserve_slot(id, 60), 0);
+
+	const GraphicsBuffer::Slot retired = buffer1.retire_slot(id);
+	EXPECT_FALSE(buffer1.has_slot(id));
+	EXPECT_EQ(buffer1.get_filled_capacity(), 60);
+
+	// the id can be reserved again, but not in the memory of the retired slot
+	ASSERT_EQ(buffer1.reserve_slot(id, 40), 60);
+	EXPECT_THROW(buffer1.reserve_slot(id + 1, 10), std::runtime_error);
+
+	buffer1.release_slot(retired);
+	EXPECT_EQ(buffer1.get_filled_capacity(), 40);
+	ASSERT_EQ(buffer1.reserve_slot(id + 1, 60), 0);
 }
\ No newline at end of file
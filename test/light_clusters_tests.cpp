@@ -0,0 +1,138 @@
+#include <graphics_engine/light_clusters.hpp>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+
+namespace
+{
+	const glm::vec3 eye(0.0f, 10.0f, -20.0f);
+	const glm::mat4 view = glm::lookAtLH(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 proj = glm::perspectiveLH(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 250.0f);
+
+	SDS::PointLight make_light(const glm::vec3& pos, float radius)
+	{
+		SDS::PointLight light{};
+		light.pos = pos;
+		light.radius = radius;
+		light.color = glm::vec3(1.0f);
+		return light;
+	}
+
+	bool lists_light(const LightClusters& light_clusters, uint32_t cluster_idx, uint32_t light_idx)
+	{
+		const SDS::LightCluster& cluster = light_clusters.get_clusters()[cluster_idx];
+		const auto begin = light_clusters.get_light_indices().begin() + cluster.offset;
+		return std::find(begin, begin + cluster.count, light_idx) != begin + cluster.count;
+	}
+
+	bool is_in_frustum(const glm::vec3& pos)
+	{
+		const glm::vec4 view_pos = view * glm::vec4(pos, 1.0f);
+		const glm::vec4 clip = proj * view_pos;
+		return view_pos.z > 0.1f && view_pos.z < 250.0f 
+			&& std::abs(clip.x / clip.w) <= 1.0f && std::abs(clip.y / clip.w) <= 1.0f;
+	}
+}
+
+TEST(LightClusters, lights_reach_every_cluster_they_light)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> position_distribution(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> radius_distribution(0.5f, 8.0f);
+	std::vector<SDS::PointLight> lights;
+	for (uint32_t i = 0; i < 200; i++)
+	{
+		lights.push_back(make_light(
+			glm::vec3(position_distribution(rng), position_distribution(rng) * 0.25f, position_distribution(rng) + 20.0f), 
+			radius_distribution(rng)));
+	}
+
+	LightClusters light_clusters;
+	light_clusters.build(view, proj, lights);
+	ASSERT_EQ(light_clusters.get_clusters().size(), LightClusters::NUM_CLUSTERS);
+
+	// every point a light reaches has to find the light in its cluster
+	std::uniform_real_distribution<float> unit_distribution(-1.0f, 1.0f);
+	uint32_t num_checked = 0;
+	for (uint32_t light_idx = 0; light_idx < lights.size(); light_idx++)
+	{
+		for (uint32_t sample = 0; sample < 100; sample++)
+		{
+			const glm::vec3 offset(unit_distribution(rng), unit_distribution(rng), unit_distribution(rng));
+			if (glm::length(offset) > 1.0f)
+			{
+				continue;
+			}
+			const glm::vec3 pos = lights[light_idx].pos + offset * lights[light_idx].radius;
+			if (!is_in_frustum(pos))
+			{
+				continue;
+			}
+
+			const uint32_t cluster_idx = light_clusters.find_cluster(pos);
+			ASSERT_LT(light_clusters.get_clusters()[cluster_idx].count, SDS::MAX_LIGHTS_PER_CLUSTER);
+			EXPECT_TRUE(lists_light(light_clusters, cluster_idx, light_idx));
+			num_checked++;
+		}
+	}
+	EXPECT_GT(num_checked, 1000);
+}
+
+TEST(LightClusters, small_lights_stay_in_few_clusters)
+{
+	LightClusters light_clusters;
+	light_clusters.build(view, proj, { make_light(glm::vec3(2.0f, 0.0f, 5.0f), 0.5f) });
+
+	uint32_t num_clusters = 0;
+	for (const SDS::LightCluster& cluster : light_clusters.get_clusters())
+	{
+		num_clusters += cluster.count;
+	}
+	EXPECT_GE(num_clusters, 1);
+	EXPECT_LE(num_clusters, 12);
+	EXPECT_TRUE(lists_light(light_clusters, light_clusters.find_cluster(glm::vec3(2.0f, 0.0f, 5.0f)), 0));
+}
+
+TEST(LightClusters, lights_outside_of_the_view_are_skipped)
+{
+	LightClusters light_clusters;
+	light_clusters.build(view, proj, { 
+		make_light(eye - glm::vec3(0.0f, 0.0f, 10.0f), 5.0f),
+		make_light(glm::vec3(500.0f, 0.0f, 0.0f), 5.0f) });
+
+	EXPECT_TRUE(light_clusters.get_light_indices().empty());
+}
+
+TEST(LightClusters, lights_per_cluster_are_capped)
+{
+	const std::vector<SDS::PointLight> lights(SDS::MAX_LIGHTS_PER_CLUSTER + 10, make_light(glm::vec3(0.0f), 2.0f));
+	LightClusters light_clusters;
+	light_clusters.build(view, proj, lights);
+
+	const SDS::LightCluster& cluster = light_clusters.get_clusters()[light_clusters.find_cluster(glm::vec3(0.0f))];
+	EXPECT_EQ(cluster.count, SDS::MAX_LIGHTS_PER_CLUSTER);
+	// the lights given first are kept
+	EXPECT_TRUE(lists_light(light_clusters, light_clusters.find_cluster(glm::vec3(0.0f)), 0));
+	EXPECT_FALSE(lists_light(light_clusters, light_clusters.find_cluster(glm::vec3(0.0f)), SDS::MAX_LIGHTS_PER_CLUSTER));
+
+	EXPECT_THROW(
+		light_clusters.build(view, proj, std::vector<SDS::PointLight>(SDS::MAX_POINT_LIGHTS + 1, make_light(glm::vec3(0.0f), 1.0f))), 
+		std::runtime_error);
+}
+
+TEST(LightClusters, slices_match_the_shaders)
+{
+	LightClusters light_clusters;
+	light_clusters.build(view, proj, {});
+
+	// slice = log(view depth / near depth) * slice scale, the last slice ends at the far plane
+	EXPECT_FLOAT_EQ(light_clusters.get_near_depth(), 0.1f);
+	EXPECT_NEAR(std::log(250.0f / 0.1f) * light_clusters.get_slice_scale(), SDS::LIGHT_CLUSTER_GRID_Z, 1e-3f);
+}
@@ -0,0 +1,257 @@
+#include <renderable/mesh_optimizer.hpp>
+#include <shared_data_structures.hpp>
+
+#include <gtest/gtest.h>
+#include <glm/gtc/constants.hpp>
+
+#include <random>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+
+namespace
+{
+	// grid of (size x size) quads, triangles are shuffled to mimic a badly ordered authoring tool export
+	void generate_shuffled_grid(uint32_t size, std::vector<SDS::ColorVertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		vertices.clear();
+		indices.clear();
+		for (uint32_t y = 0; y <= size; y++)
+		{
+			for (uint32_t x = 0; x <= size; x++)
+			{
+				vertices.push_back(SDS::ColorVertex{ glm::vec3(float(x), float(y), 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) });
+			}
+		}
+
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (uint32_t y = 0; y < size; y++)
+		{
+			for (uint32_t x = 0; x < size; x++)
+			{
+				const uint32_t i0 = y * (size + 1) + x;
+				const uint32_t i1 = i0 + 1;
+				const uint32_t i2 = i0 + size + 1;
+				const uint32_t i3 = i2 + 1;
+				triangles.push_back({ i0, i1, i2 });
+				triangles.push_back({ i1, i3, i2 });
+			}
+		}
+		std::mt19937 rng(42);
+		std::ranges::shuffle(triangles, rng);
+		for (const auto& triangle : triangles)
+		{
+			indices.insert(indices.end(), triangle.begin(), triangle.end());
+		}
+	}
+
+	// concentric UV spheres wound counter-clockwise seen from outside, the innermost is listed first so
+	// drawing in input order shades every shell that an outer one later covers
+	void generate_nested_spheres(uint32_t num_shells, uint32_t segments, std::vector<SDS::ColorVertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		vertices.clear();
+		indices.clear();
+		for (uint32_t shell = 0; shell < num_shells; shell++)
+		{
+			const float radius = float(shell + 1);
+			const uint32_t first_vertex = static_cast<uint32_t>(vertices.size());
+			for (uint32_t ring = 0; ring <= segments; ring++)
+			{
+				const float theta = glm::pi<float>() * float(ring) / float(segments);
+				for (uint32_t segment = 0; segment <= segments; segment++)
+				{
+					const float phi = 2.0f * glm::pi<float>() * float(segment) / float(segments);
+					const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+					vertices.push_back(SDS::ColorVertex{ normal * radius, normal });
+				}
+			}
+			for (uint32_t ring = 0; ring < segments; ring++)
+			{
+				for (uint32_t segment = 0; segment < segments; segment++)
+				{
+					const uint32_t i0 = first_vertex + ring * (segments + 1) + segment;
+					const uint32_t i1 = i0 + 1;
+					const uint32_t i2 = i0 + segments + 1;
+					const uint32_t i3 = i2 + 1;
+					indices.insert(indices.end(), { i0, i1, i2, i1, i3, i2 });
+				}
+			}
+		}
+	}
+
+	// triangles as position triples so that meshes can be compared regardless of vertex and triangle order
+	std::vector<std::array<float, 9>> get_sorted_triangles(
+		const std::vector<SDS::ColorVertex>& vertices,
+		const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<float, 9>> triangles;
+		for (uint32_t i = 0; i < indices.size(); i += 3)
+		{
+			std::array<float, 9> triangle;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				const auto& pos = vertices[indices[i + corner]].pos;
+				triangle[corner * 3] = pos.x;
+				triangle[corner * 3 + 1] = pos.y;
+				triangle[corner * 3 + 2] = pos.z;
+			}
+			triangles.push_back(triangle);
+		}
+		std::ranges::sort(triangles);
+
+		return triangles;
+	}
+}
+
+TEST(MeshOptimizer, analyze_single_triangle)
+{
+	const auto stats = MeshOptimizer::analyze_vertex_cache({ 0, 1, 2 }, 3);
+	ASSERT_EQ(stats.cache_misses, 3);
+	ASSERT_FLOAT_EQ(stats.acmr, 3.0f);
+	ASSERT_FLOAT_EQ(stats.atvr, 1.0f);
+}
+
+TEST(MeshOptimizer, deduplicate_vertices)
+{
+	// quad authored as two independent triangles
+	std::vector<SDS::ColorVertex> vertices = {
+		{ glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+		{ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+		{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+		{ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+		{ glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+		{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+	};
+	std::vector<uint32_t> indices = { 0, 1, 2, 3, 4, 5 };
+	const auto original = get_sorted_triangles(vertices, indices);
+
+	ASSERT_EQ(MeshOptimizer::deduplicate_vertices(vertices, indices), 4);
+	ASSERT_EQ(vertices.size(), 4);
+	ASSERT_EQ(indices, std::vector<uint32_t>({ 0, 1, 2, 1, 3, 2 }));
+	ASSERT_EQ(get_sorted_triangles(vertices, indices), original);
+}
+
+TEST(MeshOptimizer, vertex_cache_improves_acmr)
+{
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_shuffled_grid(64, vertices, indices);
+	const auto original = get_sorted_triangles(vertices, indices);
+	const auto before = MeshOptimizer::analyze_vertex_cache(indices, vertices.size());
+
+	std::vector<uint32_t> clusters;
+	MeshOptimizer::optimize_vertex_cache(indices, vertices.size(), MeshOptimizer::DEFAULT_CACHE_SIZE, &clusters);
+	const auto after = MeshOptimizer::analyze_vertex_cache(indices, vertices.size());
+
+	// a shuffled grid misses nearly every vertex, a well ordered one transforms each vertex about once
+	EXPECT_GT(before.acmr, 2.0f);
+	EXPECT_LT(after.acmr, 0.8f);
+	EXPECT_LT(after.atvr, 1.5f);
+	ASSERT_FALSE(clusters.empty());
+	ASSERT_EQ(clusters.front(), 0);
+	ASSERT_TRUE(std::ranges::is_sorted(clusters));
+	ASSERT_EQ(get_sorted_triangles(vertices, indices), original);
+}
+
+TEST(MeshOptimizer, overdraw_keeps_cache_efficiency)
+{
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_shuffled_grid(64, vertices, indices);
+	const auto original = get_sorted_triangles(vertices, indices);
+
+	std::vector<uint32_t> clusters;
+	MeshOptimizer::optimize_vertex_cache(indices, vertices.size(), MeshOptimizer::DEFAULT_CACHE_SIZE, &clusters);
+	const auto vertex_cache_optimized = MeshOptimizer::analyze_vertex_cache(indices, vertices.size());
+	MeshOptimizer::optimize_overdraw(vertices, indices, clusters);
+	const auto overdraw_optimized = MeshOptimizer::analyze_vertex_cache(indices, vertices.size());
+
+	EXPECT_LT(overdraw_optimized.acmr, vertex_cache_optimized.acmr * 1.25f);
+	ASSERT_EQ(get_sorted_triangles(vertices, indices), original);
+}
+
+TEST(MeshOptimizer, analyze_overdraw_flat_grid)
+{
+	// a single layer covers every pixel once, shared edges must not be drawn twice
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_shuffled_grid(16, vertices, indices);
+
+	const auto stats = MeshOptimizer::analyze_overdraw(vertices, indices);
+	ASSERT_GT(stats.pixels_covered, 0);
+	ASSERT_EQ(stats.pixels_shaded, stats.pixels_covered);
+	ASSERT_FLOAT_EQ(stats.overdraw, 1.0f);
+}
+
+TEST(MeshOptimizer, overdraw_reduces_depth_complexity)
+{
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_nested_spheres(4, 32, vertices, indices);
+	const auto original = get_sorted_triangles(vertices, indices);
+
+	std::vector<uint32_t> clusters;
+	MeshOptimizer::optimize_vertex_cache(indices, vertices.size(), MeshOptimizer::DEFAULT_CACHE_SIZE, &clusters);
+	const auto vertex_cache_optimized = MeshOptimizer::analyze_vertex_cache(indices, vertices.size());
+	const auto before = MeshOptimizer::analyze_overdraw(vertices, indices);
+	MeshOptimizer::optimize_overdraw(vertices, indices, clusters);
+	const auto after = MeshOptimizer::analyze_overdraw(vertices, indices);
+
+	// the shells are drawn inside out before, every pixel of the inner shells is shaded again by the outer ones,
+	// drawing the outermost shell first leaves close to one shaded fragment per pixel
+	EXPECT_GT(before.overdraw, 1.8f);
+	EXPECT_LT(after.overdraw, 1.1f);
+	EXPECT_EQ(after.pixels_covered, before.pixels_covered);
+	// the default threshold allows the ACMR to get 5% worse
+	EXPECT_LT(MeshOptimizer::analyze_vertex_cache(indices, vertices.size()).acmr, vertex_cache_optimized.acmr * 1.06f);
+	ASSERT_EQ(get_sorted_triangles(vertices, indices), original);
+}
+
+TEST(MeshOptimizer, vertex_fetch_first_use_order)
+{
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_shuffled_grid(32, vertices, indices);
+	// an unreferenced vertex should be dropped
+	vertices.push_back(SDS::ColorVertex{ glm::vec3(-1.0f), glm::vec3(0.0f) });
+	MeshOptimizer::optimize_vertex_cache(indices, vertices.size());
+	const auto original = get_sorted_triangles(vertices, indices);
+	const auto before = MeshOptimizer::analyze_vertex_fetch(indices, vertices.size(), sizeof(SDS::ColorVertex));
+
+	ASSERT_EQ(MeshOptimizer::optimize_vertex_fetch(vertices, indices), 33 * 33);
+	const auto after = MeshOptimizer::analyze_vertex_fetch(indices, vertices.size(), sizeof(SDS::ColorVertex));
+
+	uint32_t next_new_vertex = 0;
+	for (const uint32_t index : indices)
+	{
+		ASSERT_LE(index, next_new_vertex);
+		next_new_vertex = std::max(next_new_vertex, index + 1);
+	}
+	EXPECT_LT(after.overfetch, before.overfetch);
+	ASSERT_EQ(get_sorted_triangles(vertices, indices), original);
+}
+
+TEST(MeshOptimizer, full_pipeline)
+{
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_shuffled_grid(64, vertices, indices);
+	// duplicate every vertex to emulate a non-indexed export
+	std::vector<SDS::ColorVertex> unindexed_vertices;
+	for (uint32_t& index : indices)
+	{
+		unindexed_vertices.push_back(vertices[index]);
+		index = static_cast<uint32_t>(unindexed_vertices.size() - 1);
+	}
+	vertices = std::move(unindexed_vertices);
+	const auto original = get_sorted_triangles(vertices, indices);
+
+	const auto stats = MeshOptimizer::optimize(vertices, indices);
+	ASSERT_EQ(stats.vertices_before, 64 * 64 * 6);
+	ASSERT_EQ(stats.vertices_after, 65 * 65);
+	ASSERT_FLOAT_EQ(stats.before.acmr, 3.0f);
+	EXPECT_LT(stats.after.acmr, 0.8f);
+	EXPECT_LT(stats.after.atvr, 1.5f);
+	ASSERT_EQ(get_sorted_triangles(vertices, indices), original);
+}
@@ -0,0 +1,194 @@
+#include <renderable/mesh_simplifier.hpp>
+#include <renderable/mesh.hpp>
+#include <renderable/renderable.hpp>
+#include <entity_component_system/mesh_system.hpp>
+#include <shared_data_structures.hpp>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include <numbers>
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+	// uv sphere with a duplicated seam column, like MeshFactory generates
+	void generate_uv_sphere(uint32_t segments, std::vector<SDS::ColorVertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		vertices.clear();
+		indices.clear();
+		const uint32_t rings = segments / 2;
+		for (uint32_t ring = 0; ring <= rings; ring++)
+		{
+			const float theta = std::numbers::pi_v<float> * float(ring) / float(rings);
+			for (uint32_t segment = 0; segment <= segments; segment++)
+			{
+				// the seam column and the poles must match exactly, otherwise they are not treated as the same position
+				const float phi = 2.0f * std::numbers::pi_v<float> * float(segment % segments) / float(segments);
+				const glm::vec3 pos = ring == 0 || ring == rings ?
+					glm::vec3(0.0f, ring == 0 ? 1.0f : -1.0f, 0.0f) :
+					glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+				vertices.push_back(SDS::ColorVertex{ pos, pos });
+			}
+		}
+		for (uint32_t ring = 0; ring < rings; ring++)
+		{
+			for (uint32_t segment = 0; segment < segments; segment++)
+			{
+				const uint32_t i0 = ring * (segments + 1) + segment;
+				const uint32_t i1 = i0 + 1;
+				const uint32_t i2 = i0 + segments + 1;
+				const uint32_t i3 = i2 + 1;
+				indices.insert(indices.end(), { i0, i2, i1, i1, i2, i3 });
+			}
+		}
+	}
+
+	std::vector<glm::vec3> get_positions(const std::vector<SDS::ColorVertex>& vertices)
+	{
+		std::vector<glm::vec3> positions;
+		for (const auto& vertex : vertices)
+		{
+			positions.push_back(vertex.pos);
+		}
+
+		return positions;
+	}
+}
+
+TEST(MeshSimplifier, flat_grid_collapses_without_error)
+{
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+	const uint32_t size = 16;
+	for (uint32_t y = 0; y <= size; y++)
+	{
+		for (uint32_t x = 0; x <= size; x++)
+		{
+			positions.push_back(glm::vec3(float(x), float(y), 0.0f));
+		}
+	}
+	for (uint32_t y = 0; y < size; y++)
+	{
+		for (uint32_t x = 0; x < size; x++)
+		{
+			const uint32_t i0 = y * (size + 1) + x;
+			indices.insert(indices.end(), { i0, i0 + 1, i0 + size + 1, i0 + 1, i0 + size + 2, i0 + size + 1 });
+		}
+	}
+
+	float error = -1.0f;
+	const auto simplified = MeshSimplifier::simplify(positions, indices, indices.size() / 4, MeshSimplifier::DEFAULT_MAX_ERROR, &error);
+	EXPECT_LE(simplified.size(), indices.size() / 4);
+	EXPECT_NEAR(error, 0.0f, 1e-4f);
+	for (const uint32_t index : simplified)
+	{
+		ASSERT_LT(index, positions.size());
+	}
+}
+
+TEST(MeshSimplifier, sphere_lod_chain)
+{
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_uv_sphere(64, vertices, indices);
+
+	const auto lods = MeshSimplifier::generate_lod_chain(vertices, indices);
+	ASSERT_GE(lods.size(), 2);
+	size_t previous_size = indices.size();
+	float previous_error = 0.0f;
+	for (const auto& lod : lods)
+	{
+		EXPECT_LT(lod.indices.size(), previous_size);
+		EXPECT_EQ(lod.indices.size() % 3, 0);
+		EXPECT_GE(lod.error, previous_error);
+		EXPECT_LE(lod.error, MeshSimplifier::DEFAULT_MAX_ERROR);
+
+		// every remaining vertex is an original one, so the distance to the unit sphere stays 0,
+		// check that the coarse triangles still approximate it i.e. no triangle got folded through the center
+		for (size_t i = 0; i < lod.indices.size(); i += 3)
+		{
+			const glm::vec3 center = (vertices[lod.indices[i]].pos + vertices[lod.indices[i + 1]].pos + vertices[lod.indices[i + 2]].pos) / 3.0f;
+			EXPECT_GT(glm::length(center), 0.5f);
+		}
+		previous_size = lod.indices.size();
+		previous_error = lod.error;
+	}
+}
+
+TEST(MeshSimplifier, seams_are_kept)
+{
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_uv_sphere(32, vertices, indices);
+	// store the u texture coordinate in the normal, the duplicated seam column has u = 1 while column 0 has u = 0
+	const uint32_t columns = 33;
+	for (uint32_t vertex = 0; vertex < vertices.size(); vertex++)
+	{
+		vertices[vertex].normal = glm::vec3(float(vertex % columns) / float(columns - 1));
+	}
+
+	const auto simplified = MeshSimplifier::simplify(get_positions(vertices), indices, indices.size() / 4, 1.0f);
+	ASSERT_LT(simplified.size(), indices.size() / 2);
+	for (size_t i = 0; i < simplified.size(); i += 3)
+	{
+		// a triangle stitched across the seam would interpolate u over (nearly) the whole texture
+		const float u0 = vertices[simplified[i]].normal.x;
+		const float u1 = vertices[simplified[i + 1]].normal.x;
+		const float u2 = vertices[simplified[i + 2]].normal.x;
+		EXPECT_LT(std::max({ u0, u1, u2 }) - std::min({ u0, u1, u2 }), 0.5f);
+	}
+}
+
+TEST(MeshSimplifier, mesh_lod_ranges)
+{
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_uv_sphere(32, vertices, indices);
+	ColorMesh mesh(std::move(vertices), std::move(indices));
+	mesh.optimize();
+	mesh.generate_lods();
+
+	ASSERT_GT(mesh.get_num_lods(), 1);
+	ASSERT_FLOAT_EQ(mesh.get_bounding_radius(), 1.0f);
+	uint32_t expected_first_index = 0;
+	for (uint32_t lod = 0; lod < mesh.get_num_lods(); lod++)
+	{
+		ASSERT_EQ(mesh.get_lod(lod).first_index, expected_first_index);
+		expected_first_index += mesh.get_lod(lod).num_indices;
+	}
+	ASSERT_EQ(mesh.get_packed_indices_data_size(), expected_first_index * mesh.get_index_size());
+
+	// optimizing again reorders the vertices which invalidates the LODs
+	mesh.optimize();
+	ASSERT_EQ(mesh.get_num_lods(), 1);
+}
+
+TEST(MeshSimplifier, lod_selection_hysteresis)
+{
+	std::vector<SDS::ColorVertex> vertices;
+	std::vector<uint32_t> indices;
+	generate_uv_sphere(64, vertices, indices);
+	auto mesh = std::make_unique<ColorMesh>(std::move(vertices), std::move(indices));
+	mesh->generate_lods();
+	const float lod1_error = mesh->get_lod(1).error;
+	Renderable renderable;
+	renderable.mesh_id = MeshSystem::add(std::move(mesh));
+
+	// close up the full mesh is drawn, far away the coarsest one
+	ASSERT_EQ(renderable.select_lod(1e6f, 0), 0);
+	ASSERT_EQ(renderable.select_lod(1e-3f, 0), MeshSystem::get(renderable.mesh_id).get_num_lods() - 1);
+
+	// right at the threshold the current LOD is kept in both directions
+	const float threshold_radius = Renderable::LOD_ERROR_PIXELS / lod1_error;
+	ASSERT_EQ(renderable.select_lod(threshold_radius, 0), 0);
+	ASSERT_EQ(renderable.select_lod(threshold_radius, 1), 1);
+	// and only switches once clearly past it
+	ASSERT_EQ(renderable.select_lod(threshold_radius * 0.5f, 0), 1);
+	ASSERT_EQ(renderable.select_lod(threshold_radius * 2.0f, 1), 0);
+
+	MeshSystem::unregister_owner(renderable.mesh_id);
+}
@@ -0,0 +1,299 @@
+#include <navigation/nav_grid.hpp>
+#include <navigation/pathfinder.hpp>
+#include <navigation/flow_field.hpp>
+#include <navigation/hierarchical_pathfinder.hpp>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+	// scattered walls with random costs, the same seed gives the same map
+	NavGrid make_random_grid(const NavGrid::Coord& origin, int size, float blocked_ratio, uint32_t seed, int max_cost = 4)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+		std::uniform_int_distribution<int> cost(1, max_cost);
+		NavGrid grid(origin, NavGrid::Coord(size));
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				grid.set_cost(origin + NavGrid::Coord(x, y), chance(rng) < blocked_ratio ? NavGrid::BLOCKED : uint8_t(cost(rng)));
+			}
+		}
+
+		return grid;
+	}
+
+	// every step is to a passable neighbour without cutting corners, and the steps add up to the cost
+	void expect_valid_path(const NavGrid& grid, const std::vector<NavGrid::Coord>& tiles, float expected_cost)
+	{
+		float cost = 0.0f;
+		for (size_t i = 1; i < tiles.size(); i++)
+		{
+			const NavGrid::Coord step = tiles[i] - tiles[i - 1];
+			ASSERT_LE(std::abs(step.x), 1);
+			ASSERT_LE(std::abs(step.y), 1);
+			ASSERT_NE(step, NavGrid::Coord(0));
+			ASSERT_TRUE(grid.is_passable(tiles[i]));
+			if (step.x != 0 && step.y != 0)
+			{
+				ASSERT_TRUE(grid.is_passable(tiles[i - 1] + NavGrid::Coord(step.x, 0)));
+				ASSERT_TRUE(grid.is_passable(tiles[i - 1] + NavGrid::Coord(0, step.y)));
+			}
+			cost += NavGrid::to_tiles(step.x != 0 && step.y != 0 ? NavGrid::DIAGONAL_STEP : NavGrid::STRAIGHT_STEP) * float(grid.get_cost(tiles[i]));
+		}
+		EXPECT_NEAR(cost, expected_cost, 1e-3f * std::max(1.0f, expected_cost));
+	}
+}
+
+TEST(Navigation, open_grid_is_octile)
+{
+	NavGrid grid(NavGrid::Coord(-50), NavGrid::Coord(100));
+	Pathfinder pathfinder;
+	const Path path = pathfinder.find_path(grid, NavGrid::Coord(-40, -30), NavGrid::Coord(45, 10));
+	ASSERT_TRUE(path.found());
+	ASSERT_EQ(path.tiles.front(), NavGrid::Coord(-40, -30));
+	ASSERT_EQ(path.tiles.back(), NavGrid::Coord(45, 10));
+	ASSERT_NEAR(path.cost, NavGrid::to_tiles(NavGrid::get_octile_distance(NavGrid::Coord(-40, -30), NavGrid::Coord(45, 10))), 1e-3f);
+	expect_valid_path(grid, path.tiles, path.cost);
+	// the heuristic is exact on open ground, so only the tiles along one path get expanded
+	ASSERT_EQ(pathfinder.get_num_expanded(), path.tiles.size());
+
+	const Path trivial = pathfinder.find_path(grid, NavGrid::Coord(3), NavGrid::Coord(3));
+	ASSERT_EQ(trivial.tiles.size(), 1);
+	ASSERT_EQ(trivial.cost, 0.0f);
+}
+
+TEST(Navigation, walls_and_unreachable_goals)
+{
+	// a wall across the middle with a single gap at the top, diagonals can't squeeze past its end
+	NavGrid grid(NavGrid::Coord(0), NavGrid::Coord(20, 10));
+	for (int y = 0; y < 9; y++)
+	{
+		grid.set_cost(NavGrid::Coord(10, y), NavGrid::BLOCKED);
+	}
+	Pathfinder pathfinder;
+	const Path path = pathfinder.find_path(grid, NavGrid::Coord(5, 0), NavGrid::Coord(15, 0));
+	ASSERT_TRUE(path.found());
+	expect_valid_path(grid, path.tiles, path.cost);
+	ASSERT_NE(std::find(path.tiles.begin(), path.tiles.end(), NavGrid::Coord(10, 9)), path.tiles.end());
+
+	grid.set_cost(NavGrid::Coord(10, 9), NavGrid::BLOCKED);
+	ASSERT_FALSE(pathfinder.find_path(grid, NavGrid::Coord(5, 0), NavGrid::Coord(15, 0)).found());
+	ASSERT_FALSE(pathfinder.find_path(grid, NavGrid::Coord(5, 0), NavGrid::Coord(10, 0)).found());
+	ASSERT_FALSE(pathfinder.find_path(grid, NavGrid::Coord(5, 0), NavGrid::Coord(50, 0)).found());
+
+	const FlowField field(grid, NavGrid::Coord(15, 0));
+	ASSERT_FALSE(field.is_reachable(NavGrid::Coord(5, 0)));
+	ASSERT_TRUE(field.trace(NavGrid::Coord(5, 0)).empty());
+	ASSERT_EQ(field.get_direction(NavGrid::Coord(5, 0)), NavGrid::Coord(0));
+	ASSERT_TRUE(field.is_reachable(NavGrid::Coord(19, 9)));
+}
+
+TEST(Navigation, astar_and_flow_field_agree)
+{
+	const NavGrid grid = make_random_grid(NavGrid::Coord(-32, 7), 64, 0.3f, 11);
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<int> coordinate(0, 63);
+	Pathfinder pathfinder;
+	int num_found = 0;
+	for (int query = 0; query < 20; query++)
+	{
+		const NavGrid::Coord goal = grid.get_origin() + NavGrid::Coord(coordinate(rng), coordinate(rng));
+		const FlowField field(grid, goal);
+		for (int unit = 0; unit < 20; unit++)
+		{
+			const NavGrid::Coord start = grid.get_origin() + NavGrid::Coord(coordinate(rng), coordinate(rng));
+			const Path path = pathfinder.find_path(grid, start, goal);
+			ASSERT_EQ(path.found(), field.is_reachable(start));
+			if (!path.found())
+			{
+				continue;
+			}
+			num_found++;
+			expect_valid_path(grid, path.tiles, path.cost);
+			ASSERT_NEAR(path.cost, field.get_cost_to_goal(start), 1e-3f * path.cost);
+
+			const auto traced = field.trace(start);
+			ASSERT_EQ(traced.back(), goal);
+			expect_valid_path(grid, traced, field.get_cost_to_goal(start));
+		}
+	}
+	ASSERT_GT(num_found, 100);
+}
+
+TEST(Navigation, flow_field_cache)
+{
+	NavGrid grid(NavGrid::Coord(0), NavGrid::Coord(32));
+	FlowFieldCache cache(2);
+	const auto field1 = cache.get(grid, NavGrid::Coord(1));
+	ASSERT_EQ(cache.get(grid, NavGrid::Coord(1)), field1);
+
+	// changing the grid rebuilds the field on the next request, the old one stays usable by whoever holds it
+	grid.set_cost(NavGrid::Coord(5), NavGrid::BLOCKED);
+	const auto rebuilt = cache.get(grid, NavGrid::Coord(1));
+	ASSERT_NE(rebuilt, field1);
+	ASSERT_TRUE(rebuilt->is_up_to_date(grid));
+	ASSERT_FALSE(field1->is_up_to_date(grid));
+	ASSERT_TRUE(field1->is_reachable(NavGrid::Coord(5)));
+	ASSERT_FALSE(rebuilt->is_reachable(NavGrid::Coord(5)));
+
+	// the least recently used goal is evicted
+	const auto field2 = cache.get(grid, NavGrid::Coord(2));
+	ASSERT_EQ(cache.get(grid, NavGrid::Coord(1)), rebuilt);
+	cache.get(grid, NavGrid::Coord(3));
+	ASSERT_EQ(cache.size(), 2);
+	ASSERT_EQ(cache.get(grid, NavGrid::Coord(1)), rebuilt);
+	ASSERT_NE(cache.get(grid, NavGrid::Coord(2)), field2);
+}
+
+TEST(Navigation, hierarchical_matches_flat_within_tolerance)
+{
+	// uniform costs, with random ones the best route weaves between cheap tiles and rarely crosses at an entrance
+	NavGrid grid = make_random_grid(NavGrid::Coord(-40, 3), 128, 0.25f, 3, 1);
+	Pathfinder flat;
+	HierarchicalPathfinder hierarchical(grid, 16);
+	std::mt19937 rng(9);
+	std::uniform_int_distribution<int> coordinate(0, 127);
+	int num_found = 0;
+	float flat_total = 0.0f;
+	float hierarchical_total = 0.0f;
+	for (int query = 0; query < 300; query++)
+	{
+		const NavGrid::Coord start = grid.get_origin() + NavGrid::Coord(coordinate(rng), coordinate(rng));
+		const NavGrid::Coord goal = grid.get_origin() + NavGrid::Coord(coordinate(rng), coordinate(rng));
+		const Path expected = flat.find_path(grid, start, goal);
+		const Path path = hierarchical.find_path(start, goal);
+		ASSERT_EQ(path.found(), expected.found());
+		if (!path.found())
+		{
+			continue;
+		}
+		num_found++;
+		ASSERT_EQ(path.tiles.front(), start);
+		ASSERT_EQ(path.tiles.back(), goal);
+		expect_valid_path(grid, path.tiles, path.cost);
+		// never better than optimal, and the detours through entrances stay small
+		ASSERT_GE(path.cost, expected.cost * (1.0f - 1e-4f));
+		ASSERT_LE(path.cost, expected.cost * 1.3f);
+		flat_total += expected.cost;
+		hierarchical_total += path.cost;
+	}
+	ASSERT_GT(num_found, 150);
+	EXPECT_LT(hierarchical_total, flat_total * 1.05f);
+	EXPECT_GT(hierarchical.get_num_cache_hits(), 0);
+}
+
+TEST(Navigation, hierarchical_weighted_costs_within_tolerance)
+{
+	// random costs from 1 to 4, the documented bound is 1.5x for a single route and around 5% on average
+	NavGrid grid = make_random_grid(NavGrid::Coord(5, -70), 128, 0.25f, 5, 4);
+	Pathfinder flat;
+	HierarchicalPathfinder hierarchical(grid, 16);
+	std::mt19937 rng(9);
+	std::uniform_int_distribution<int> coordinate(0, 127);
+	int num_found = 0;
+	float flat_total = 0.0f;
+	float hierarchical_total = 0.0f;
+	for (int query = 0; query < 300; query++)
+	{
+		const NavGrid::Coord start = grid.get_origin() + NavGrid::Coord(coordinate(rng), coordinate(rng));
+		const NavGrid::Coord goal = grid.get_origin() + NavGrid::Coord(coordinate(rng), coordinate(rng));
+		const Path expected = flat.find_path(grid, start, goal);
+		const Path path = hierarchical.find_path(start, goal);
+		ASSERT_EQ(path.found(), expected.found());
+		if (!path.found())
+		{
+			continue;
+		}
+		num_found++;
+		expect_valid_path(grid, path.tiles, path.cost);
+		ASSERT_GE(path.cost, expected.cost * (1.0f - 1e-4f));
+		ASSERT_LE(path.cost, expected.cost * 1.5f);
+		flat_total += expected.cost;
+		hierarchical_total += path.cost;
+	}
+	ASSERT_GT(num_found, 150);
+	EXPECT_LT(hierarchical_total, flat_total * 1.08f);
+}
+
+TEST(Navigation, hierarchical_incremental_updates)
+{
+	NavGrid grid = make_random_grid(NavGrid::Coord(0), 96, 0.2f, 21);
+	HierarchicalPathfinder incremental(grid, 16);
+	std::mt19937 rng(4);
+	std::uniform_int_distribution<int> coordinate(0, 95);
+	std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+	for (int round = 0; round < 10; round++)
+	{
+		// a few reported changes, then the graph must give the same answers as one built from scratch
+		for (int change = 0; change < 20; change++)
+		{
+			const NavGrid::Coord tile(coordinate(rng), coordinate(rng));
+			incremental.set_cost(tile, chance(rng) < 0.5f ? NavGrid::BLOCKED : uint8_t(1 + round % 3));
+		}
+		HierarchicalPathfinder fresh(grid, 16, 0);
+		for (int query = 0; query < 20; query++)
+		{
+			const NavGrid::Coord start(coordinate(rng), coordinate(rng));
+			const NavGrid::Coord goal(coordinate(rng), coordinate(rng));
+			const Path path = incremental.find_path(start, goal);
+			const Path expected = fresh.find_path(start, goal);
+			ASSERT_EQ(path.found(), expected.found());
+			if (path.found())
+			{
+				expect_valid_path(grid, path.tiles, path.cost);
+				ASSERT_NEAR(path.cost, expected.cost, 1e-3f * expected.cost);
+			}
+		}
+		ASSERT_EQ(incremental.get_num_nodes(), fresh.get_num_nodes());
+	}
+
+	// cutting the map in two behind the pathfinder's back is still picked up
+	for (int y = 0; y < 96; y++)
+	{
+		grid.set_cost(NavGrid::Coord(48, y), NavGrid::BLOCKED);
+	}
+	std::vector<NavGrid::Coord> left, right;
+	for (int y = 0; y < 96; y++)
+	{
+		if (grid.is_passable(NavGrid::Coord(10, y))) left.push_back(NavGrid::Coord(10, y));
+		if (grid.is_passable(NavGrid::Coord(80, y))) right.push_back(NavGrid::Coord(80, y));
+	}
+	ASSERT_FALSE(left.empty());
+	ASSERT_FALSE(right.empty());
+	ASSERT_FALSE(incremental.find_path(left.front(), right.front()).found());
+}
+
+TEST(Navigation, hierarchical_route_cache)
+{
+	NavGrid grid(NavGrid::Coord(0), NavGrid::Coord(128));
+	HierarchicalPathfinder pathfinder(grid, 32, 4);
+	const Path first = pathfinder.find_path(NavGrid::Coord(2, 3), NavGrid::Coord(120, 100));
+	ASSERT_TRUE(first.found());
+	ASSERT_EQ(pathfinder.get_cache_size(), 1);
+	ASSERT_EQ(pathfinder.get_num_cache_hits(), 0);
+
+	// another unit between the same clusters reuses the route, skipping the abstract search
+	const Path second = pathfinder.find_path(NavGrid::Coord(5, 1), NavGrid::Coord(125, 110));
+	ASSERT_TRUE(second.found());
+	ASSERT_EQ(pathfinder.get_num_cache_hits(), 1);
+	ASSERT_EQ(pathfinder.get_num_expanded(), 0);
+	expect_valid_path(grid, second.tiles, second.cost);
+	ASSERT_EQ(second.tiles.back(), NavGrid::Coord(125, 110));
+
+	// a change on the route drops it
+	pathfinder.set_cost(second.tiles[second.tiles.size() / 2], NavGrid::BLOCKED);
+	const Path third = pathfinder.find_path(NavGrid::Coord(5, 1), NavGrid::Coord(125, 110));
+	ASSERT_TRUE(third.found());
+	ASSERT_EQ(pathfinder.get_num_cache_hits(), 1);
+	expect_valid_path(grid, third.tiles, third.cost);
+}
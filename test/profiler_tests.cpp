@@ -0,0 +1,160 @@
+#include <profiler.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+
+namespace
+{
+	const Profiler::FrameTimeline* find_timeline(const std::vector<Profiler::FrameTimeline>& timelines, const std::string& name)
+	{
+		auto it = std::ranges::find_if(timelines, [&](const auto& timeline) { return timeline.thread_name == name; });
+		return it == timelines.end() ? nullptr : &*it;
+	}
+}
+
+TEST(Profiler, nested_zones_in_frame)
+{
+	std::thread worker([]()
+	{
+		Profiler::set_thread_name("nested_zones_in_frame");
+		Profiler::mark_frame();
+		{
+			PROFILE_SCOPE("outer");
+			{
+				PROFILE_SCOPE("inner");
+			}
+			{
+				PROFILE_SCOPE("inner2");
+			}
+		}
+		Profiler::mark_frame();
+	});
+	worker.join();
+
+	const auto timelines = Profiler::get_last_frames();
+	const auto* timeline = find_timeline(timelines, "nested_zones_in_frame");
+	ASSERT_NE(timeline, nullptr);
+	ASSERT_EQ(timeline->zones.size(), 3);
+
+	// sorted by begin time, parents come before their children
+	EXPECT_STREQ(timeline->zones[0].name, "outer");
+	EXPECT_EQ(timeline->zones[0].depth, 0);
+	EXPECT_STREQ(timeline->zones[1].name, "inner");
+	EXPECT_EQ(timeline->zones[1].depth, 1);
+	EXPECT_STREQ(timeline->zones[2].name, "inner2");
+	EXPECT_EQ(timeline->zones[2].depth, 1);
+
+	for (const auto& zone : timeline->zones)
+	{
+		EXPECT_LE(zone.begin_ns, zone.end_ns);
+		EXPECT_GE(zone.begin_ns, timeline->frame_begin_ns);
+		EXPECT_LE(zone.end_ns, timeline->frame_end_ns);
+	}
+	EXPECT_LE(timeline->zones[0].begin_ns, timeline->zones[1].begin_ns);
+	EXPECT_GE(timeline->zones[0].end_ns, timeline->zones[2].end_ns);
+}
+
+TEST(Profiler, disabled_records_nothing)
+{
+	Profiler::set_enabled(false);
+	std::thread worker([]()
+	{
+		Profiler::set_thread_name("disabled_records_nothing");
+		PROFILE_SCOPE("should_not_exist");
+		Profiler::mark_frame();
+		Profiler::mark_frame();
+	});
+	worker.join();
+	Profiler::set_enabled(true);
+
+	EXPECT_EQ(find_timeline(Profiler::get_last_frames(), "disabled_records_nothing"), nullptr);
+	EXPECT_EQ(Profiler::to_chrome_trace().find("should_not_exist"), std::string::npos);
+}
+
+TEST(Profiler, ring_buffer_overflow)
+{
+	// far more zones than a thread buffer can hold, only the newest should survive
+	std::thread worker([]()
+	{
+		Profiler::set_thread_name("ring_buffer_overflow");
+		Profiler::mark_frame();
+		for (int i = 0; i < 100000; i++)
+		{
+			PROFILE_SCOPE("overflow_zone");
+		}
+		Profiler::mark_frame();
+	});
+	worker.join();
+
+	const auto* timeline = find_timeline(Profiler::get_last_frames(), "ring_buffer_overflow");
+	ASSERT_NE(timeline, nullptr);
+	EXPECT_GT(timeline->zones.size(), 0);
+	EXPECT_LT(timeline->zones.size(), 100000);
+}
+
+TEST(Profiler, reads_while_recording)
+{
+	// the reader races the owning thread lapping its rings, it must never see torn or overwritten zones
+	static constexpr const char* ZONE_NAME = "reads_while_recording_zone";
+	std::atomic<bool> done = false;
+	std::thread worker([&done]()
+	{
+		Profiler::set_thread_name("reads_while_recording");
+		while (!done.load(std::memory_order_relaxed))
+		{
+			Profiler::mark_frame();
+			for (int i = 0; i < 1000; i++)
+			{
+				PROFILE_SCOPE(ZONE_NAME);
+			}
+		}
+	});
+
+	for (int i = 0; i < 200; i++)
+	{
+		const auto timelines = Profiler::get_last_frames();
+		if (const auto* timeline = find_timeline(timelines, "reads_while_recording"))
+		{
+			EXPECT_LE(timeline->frame_begin_ns, timeline->frame_end_ns);
+			for (const auto& zone : timeline->zones)
+			{
+				ASSERT_EQ(zone.name, ZONE_NAME);
+				ASSERT_LE(zone.begin_ns, zone.end_ns);
+				ASSERT_EQ(zone.depth, 0);
+			}
+		}
+		if (i % 50 == 0)
+		{
+			const std::string trace = Profiler::to_chrome_trace();
+			ASSERT_EQ(std::ranges::count(trace, '{'), std::ranges::count(trace, '}'));
+		}
+	}
+	done = true;
+	worker.join();
+}
+
+TEST(Profiler, chrome_trace_format)
+{
+	std::thread worker([]()
+	{
+		Profiler::set_thread_name("chrome_trace_format");
+		Profiler::mark_frame();
+		PROFILE_SCOPE("trace_zone");
+	});
+	worker.join();
+
+	const std::string trace = Profiler::to_chrome_trace();
+	ASSERT_EQ(trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0);
+	EXPECT_EQ(trace.substr(trace.size() - 3), "]}\n");
+	EXPECT_NE(trace.find("\"args\":{\"name\":\"chrome_trace_format\"}"), std::string::npos);
+	EXPECT_NE(trace.find("{\"name\":\"trace_zone\",\"ph\":\"X\""), std::string::npos);
+	EXPECT_NE(trace.find("\"ph\":\"i\",\"s\":\"t\""), std::string::npos);
+
+	// braces must balance for the output to be valid json
+	EXPECT_EQ(std::ranges::count(trace, '{'), std::ranges::count(trace, '}'));
+	EXPECT_EQ(std::ranges::count(trace, '['), std::ranges::count(trace, ']'));
+}
@@ -0,0 +1,281 @@
+#include <graphics_engine/render_graph.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+	using EUsage = RenderGraph::EUsage;
+
+	const RenderGraph::ImportedState sampled_last_frame {
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT };
+	const RenderGraph::ImportedState acquired {
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0 };
+
+	RenderGraph::TransientMemory make_memory(VkDeviceSize size, VkDeviceSize alignment = 256)
+	{
+		return { size, alignment, 0b11 };
+	}
+
+	std::vector<std::string> get_compiled_pass_names(const RenderGraph& graph)
+	{
+		std::vector<std::string> names;
+		for (const auto& compiled_pass : graph.get_compiled_passes())
+		{
+			names.push_back(graph.get_pass_name(compiled_pass.pass_idx));
+		}
+		return names;
+	}
+
+	const RenderGraph::CompiledPass& get_compiled_pass(const RenderGraph& graph, const std::string& name)
+	{
+		for (const auto& compiled_pass : graph.get_compiled_passes())
+		{
+			if (graph.get_pass_name(compiled_pass.pass_idx) == name)
+			{
+				return compiled_pass;
+			}
+		}
+		throw std::runtime_error("pass not compiled");
+	}
+}
+
+TEST(RenderGraph, culls_passes_whose_results_are_unused)
+{
+	RenderGraph graph;
+	const auto shadow_map = graph.import_image("shadow_map", { VK_NULL_HANDLE, VK_IMAGE_ASPECT_DEPTH_BIT }, sampled_last_frame);
+	const auto unused = graph.import_image("unused", {}, sampled_last_frame);
+	const auto presentation = graph.import_image("presentation", {}, acquired);
+	graph.set_output(presentation, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+	graph.add_pass("shadow_map", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(shadow_map, EUsage::DEPTH_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}, nullptr);
+	graph.add_pass("unused", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(unused, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}, nullptr);
+	graph.add_pass("rasterization", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.read(shadow_map, EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		builder.write(presentation, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	}, nullptr);
+	graph.add_pass("debug", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.set_side_effects();
+	}, nullptr);
+	graph.compile();
+
+	EXPECT_EQ(get_compiled_pass_names(graph), (std::vector<std::string>{ "shadow_map", "rasterization", "debug" }));
+	EXPECT_TRUE(graph.is_culled(1));
+	EXPECT_TRUE(graph.get_final_barriers().empty());
+}
+
+TEST(RenderGraph, culls_passes_whose_writes_are_overwritten)
+{
+	RenderGraph graph;
+	const auto shadow_map = graph.import_image("shadow_map", { VK_NULL_HANDLE, VK_IMAGE_ASPECT_DEPTH_BIT }, sampled_last_frame);
+	const auto presentation = graph.import_image("presentation", {}, acquired);
+	graph.set_output(presentation, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+	graph.add_pass("shadow_map", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(shadow_map, EUsage::DEPTH_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}, nullptr);
+	graph.add_pass("rasterization", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.read(shadow_map, EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		builder.write(presentation, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	}, nullptr);
+	graph.add_pass("raytracing", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(presentation, EUsage::TRANSFER_DST, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	}, nullptr);
+	graph.add_pass("gui", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.read(presentation, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		builder.write(presentation, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	}, nullptr);
+	graph.compile();
+
+	EXPECT_EQ(get_compiled_pass_names(graph), (std::vector<std::string>{ "raytracing", "gui" }));
+}
+
+TEST(RenderGraph, derives_barriers_between_passes)
+{
+	RenderGraph graph;
+	const auto shadow_map = graph.import_image("shadow_map", { VK_NULL_HANDLE, VK_IMAGE_ASPECT_DEPTH_BIT, 3 }, sampled_last_frame);
+	const auto presentation = graph.import_image("presentation", {}, acquired);
+	graph.set_output(presentation, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+	graph.add_pass("shadow_map", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(shadow_map, EUsage::DEPTH_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}, nullptr);
+	graph.add_pass("rasterization", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.read(shadow_map, EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		builder.write(presentation, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	}, nullptr);
+	graph.add_pass("quad", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.read(shadow_map, EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		builder.set_side_effects();
+	}, nullptr);
+	graph.compile();
+
+	// the shadow map was sampled last frame, it's discarded and transitioned by the render pass
+	const auto& shadow_map_barriers = get_compiled_pass(graph, "shadow_map").barriers;
+	ASSERT_EQ(shadow_map_barriers.size(), 1);
+	EXPECT_EQ(shadow_map_barriers[0].src_stages, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	EXPECT_EQ(shadow_map_barriers[0].src_access, 0);
+	EXPECT_EQ(shadow_map_barriers[0].new_layout, VK_IMAGE_LAYOUT_UNDEFINED);
+
+	// the depth writes are made visible to the fragment shader, the layout stays
+	const auto& rasterization_barriers = get_compiled_pass(graph, "rasterization").barriers;
+	ASSERT_EQ(rasterization_barriers.size(), 2);
+	EXPECT_EQ(rasterization_barriers[0].resource, shadow_map);
+	EXPECT_EQ(rasterization_barriers[0].src_stages, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT);
+	EXPECT_EQ(rasterization_barriers[0].src_access, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+	EXPECT_EQ(rasterization_barriers[0].dst_stages, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	EXPECT_EQ(rasterization_barriers[0].dst_access, VK_ACCESS_SHADER_READ_BIT);
+	EXPECT_EQ(rasterization_barriers[0].old_layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EXPECT_EQ(rasterization_barriers[0].new_layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	// waits for the image to be acquired
+	EXPECT_EQ(rasterization_barriers[1].resource, presentation);
+	EXPECT_EQ(rasterization_barriers[1].src_stages, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+	// a second read in the same stage needs no barrier
+	EXPECT_TRUE(get_compiled_pass(graph, "quad").barriers.empty());
+
+	// the output is transitioned for presenting
+	ASSERT_EQ(graph.get_final_barriers().size(), 1);
+	EXPECT_EQ(graph.get_final_barriers()[0].resource, presentation);
+	EXPECT_EQ(graph.get_final_barriers()[0].src_stages, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	EXPECT_EQ(graph.get_final_barriers()[0].src_access, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+	EXPECT_EQ(graph.get_final_barriers()[0].old_layout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	EXPECT_EQ(graph.get_final_barriers()[0].new_layout, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+}
+
+TEST(RenderGraph, transitions_images_into_the_expected_layout)
+{
+	RenderGraph graph;
+	const auto image = graph.import_image("image", {}, acquired);
+	graph.add_pass("blit", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(image, EUsage::TRANSFER_DST, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	}, nullptr);
+	graph.add_pass("sample", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.read(image, EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		builder.set_side_effects();
+	}, nullptr);
+	graph.compile();
+
+	const auto& barriers = get_compiled_pass(graph, "sample").barriers;
+	ASSERT_EQ(barriers.size(), 1);
+	EXPECT_EQ(barriers[0].src_stages, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	EXPECT_EQ(barriers[0].src_access, VK_ACCESS_TRANSFER_WRITE_BIT);
+	EXPECT_EQ(barriers[0].old_layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	EXPECT_EQ(barriers[0].new_layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+TEST(RenderGraph, aliases_transient_images_whose_passes_dont_overlap)
+{
+	RenderGraph graph;
+	const auto presentation = graph.import_image("presentation", {}, acquired);
+	const auto offscreen = graph.import_image("offscreen", {}, sampled_last_frame);
+	const auto color = graph.create_transient_image("color", {}, make_memory(4000));
+	const auto depth = graph.create_transient_image("depth", { VK_NULL_HANDLE, VK_IMAGE_ASPECT_DEPTH_BIT }, make_memory(3000));
+	const auto offscreen_depth = graph.create_transient_image(
+		"offscreen_depth", { VK_NULL_HANDLE, VK_IMAGE_ASPECT_DEPTH_BIT }, make_memory(1000));
+	graph.set_output(presentation, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+	graph.add_pass("rasterization", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(color, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		builder.write(depth, EUsage::DEPTH_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+		builder.write(presentation, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	}, nullptr);
+	graph.add_pass("offscreen", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(offscreen, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		builder.write(offscreen_depth, EUsage::DEPTH_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+	}, nullptr);
+	graph.add_pass("gui", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.read(offscreen, EUsage::SAMPLED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		builder.read(presentation, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		builder.write(presentation, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	}, nullptr);
+	graph.compile();
+
+	// color and depth are used at the same time, the offscreen depth takes over the memory of the color
+	EXPECT_EQ(graph.get_memory_offset(color), 0);
+	EXPECT_EQ(graph.get_memory_offset(depth), 4096);
+	EXPECT_EQ(graph.get_memory_offset(offscreen_depth), 0);
+	EXPECT_EQ(graph.get_transient_memory_size(), 4096 + 3000);
+	EXPECT_EQ(graph.get_transient_memory_type_bits(), 0b11);
+
+	// and has to wait for the color writes to finish
+	const auto& barriers = get_compiled_pass(graph, "offscreen").barriers;
+	const auto aliasing_barrier = std::find_if(barriers.begin(), barriers.end(),
+		[&](const RenderGraph::Barrier& barrier) { return barrier.resource == offscreen_depth; });
+	ASSERT_NE(aliasing_barrier, barriers.end());
+	EXPECT_EQ(aliasing_barrier->src_stages, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	EXPECT_EQ(aliasing_barrier->src_access, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+	EXPECT_EQ(aliasing_barrier->new_layout, VK_IMAGE_LAYOUT_UNDEFINED);
+}
+
+TEST(RenderGraph, keeps_the_offsets_of_bound_transient_images)
+{
+	RenderGraph graph;
+	auto bound_memory = make_memory(1000);
+	bound_memory.offset = 0;
+	const auto bound = graph.create_transient_image("bound", {}, bound_memory);
+	const auto unbound = graph.create_transient_image("unbound", {}, make_memory(2000));
+	graph.add_pass("pass", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(bound, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		builder.write(unbound, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		builder.set_side_effects();
+	}, nullptr);
+	graph.compile();
+
+	EXPECT_EQ(graph.get_memory_offset(bound), 0);
+	EXPECT_EQ(graph.get_memory_offset(unbound), 1024);
+	EXPECT_EQ(graph.get_transient_memory_size(), 1024 + 2000);
+}
+
+TEST(RenderGraph, rejects_transient_images_without_a_common_memory_type)
+{
+	RenderGraph graph;
+	graph.create_transient_image("a", {}, { 1000, 256, 0b01 });
+	graph.create_transient_image("b", {}, { 1000, 256, 0b10 });
+	EXPECT_THROW(graph.compile(), std::runtime_error);
+}
+
+TEST(RenderGraph, executes_the_live_passes_in_order)
+{
+	RenderGraph graph;
+	const auto unused = graph.import_image("unused", {}, sampled_last_frame);
+	std::vector<std::string> executed;
+	graph.add_pass("first", [](RenderGraph::PassBuilder& builder) { builder.set_side_effects(); },
+		[&](VkCommandBuffer) { executed.push_back("first"); });
+	graph.add_pass("culled", [&](RenderGraph::PassBuilder& builder)
+	{
+		builder.write(unused, EUsage::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}, [&](VkCommandBuffer) { executed.push_back("culled"); });
+	graph.add_pass("second", [](RenderGraph::PassBuilder& builder) { builder.set_side_effects(); },
+		[&](VkCommandBuffer) { executed.push_back("second"); });
+	graph.compile();
+	graph.execute(VK_NULL_HANDLE);
+
+	EXPECT_EQ(executed, (std::vector<std::string>{ "first", "second" }));
+}
@@ -0,0 +1,120 @@
+#include <graphics_engine/renderers/shadow_cascades.hpp>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+
+
+namespace
+{
+	const glm::vec3 light_dir = glm::normalize(glm::vec3(0.3f, -1.0f, 0.2f));
+	constexpr uint32_t resolution = 1024;
+
+	glm::mat4 camera_proj()
+	{
+		return glm::perspectiveLH(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 250.0f);
+	}
+
+	// the position of a world point in the texels of a cascade
+	glm::vec2 to_texels(const ShadowCascades::Cascade& cascade, const glm::vec3& point)
+	{
+		const glm::vec4 clip = cascade.view_proj * glm::vec4(point, 1.0f);
+		return (glm::vec2(clip) * 0.5f + 0.5f) * float(resolution);
+	}
+}
+
+TEST(ShadowCascades, split_depths)
+{
+	const std::vector<float> split_depths = ShadowCascades::compute_split_depths(0.1f, 250.0f, 4);
+	ASSERT_EQ(split_depths.size(), 4);
+	for (size_t i = 1; i < split_depths.size(); i++)
+	{
+		EXPECT_GT(split_depths[i], split_depths[i - 1]);
+	}
+	EXPECT_GT(split_depths.front(), 0.1f);
+	EXPECT_FLOAT_EQ(split_depths.back(), 250.0f);
+	// closer to the camera than uniform splits would be
+	EXPECT_LT(split_depths.front(), 250.0f / 4.0f);
+
+	EXPECT_THROW(ShadowCascades::compute_split_depths(0.1f, 250.0f, 0), std::runtime_error);
+	EXPECT_THROW(ShadowCascades::compute_split_depths(0.0f, 250.0f, 3), std::runtime_error);
+}
+
+TEST(ShadowCascades, cascades_cover_frustum)
+{
+	const glm::mat4 view = glm::lookAtLH(glm::vec3(10.0f, 20.0f, -30.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 proj = camera_proj();
+	const std::vector<ShadowCascades::Cascade> cascades = ShadowCascades::compute(view, proj, light_dir, 3, resolution);
+	ASSERT_EQ(cascades.size(), 3);
+
+	const glm::mat4 inv_view_proj = glm::inverse(proj * view);
+	for (float depth : { 0.2f, 0.5f, 0.9f, 0.99f, 1.0f })
+	{
+		for (float x : { -1.0f, 0.0f, 1.0f })
+		{
+			const glm::vec4 point = inv_view_proj * glm::vec4(x, 1.0f, depth, 1.0f);
+			const glm::vec3 world_point = glm::vec3(point) / point.w;
+			const float view_depth = (view * glm::vec4(world_point, 1.0f)).z;
+
+			// the cascade the shaders would pick has to contain the point
+			size_t c = 0;
+			while (c + 1 < cascades.size() && view_depth > cascades[c].split_depth)
+			{
+				c++;
+			}
+			EXPECT_TRUE(ShadowCascades::intersects(cascades[c].view_proj, world_point, 0.0f));
+		}
+	}
+}
+
+TEST(ShadowCascades, stable_under_camera_movement)
+{
+	const glm::mat4 proj = camera_proj();
+	const glm::vec3 eye(10.0f, 20.0f, -30.0f);
+	const glm::vec3 forward(-0.3f, -0.6f, 1.0f);
+	const glm::mat4 view = glm::lookAtLH(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+	const std::vector<ShadowCascades::Cascade> cascades = ShadowCascades::compute(view, proj, light_dir, 3, resolution);
+
+	const glm::vec3 offset(0.37f, 0.0f, 0.21f);
+	const glm::mat4 moved_view = glm::lookAtLH(eye + offset, eye + offset + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+	const std::vector<ShadowCascades::Cascade> moved_cascades = ShadowCascades::compute(moved_view, proj, light_dir, 3, resolution);
+
+	const glm::vec3 point(3.0f, 0.0f, 5.0f);
+	for (size_t c = 0; c < cascades.size(); c++)
+	{
+		// the texel grid stays where it is, a point only moves by whole texels
+		const glm::vec2 texels = to_texels(cascades[c], point);
+		const glm::vec2 moved_texels = to_texels(moved_cascades[c], point);
+		const glm::vec2 shift = moved_texels - texels;
+		EXPECT_NEAR(shift.x, std::round(shift.x), 0.01f);
+		EXPECT_NEAR(shift.y, std::round(shift.y), 0.01f);
+	}
+
+	// rotating the camera in place does not change the size of the cascades
+	const glm::mat4 rotated_view = glm::lookAtLH(eye, eye + glm::vec3(0.5f, -0.6f, 0.8f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const std::vector<ShadowCascades::Cascade> rotated_cascades = ShadowCascades::compute(rotated_view, proj, light_dir, 3, resolution);
+	for (size_t c = 0; c < cascades.size(); c++)
+	{
+		EXPECT_FLOAT_EQ(cascades[c].view_proj[0][0], rotated_cascades[c].view_proj[0][0]);
+	}
+}
+
+TEST(ShadowCascades, intersects)
+{
+	const glm::mat4 view_proj = glm::orthoLH(-10.0f, 10.0f, -10.0f, 10.0f, 0.0f, 100.0f)
+		* glm::lookAtLH(glm::vec3(0.0f, 50.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+
+	EXPECT_TRUE(ShadowCascades::intersects(view_proj, glm::vec3(0.0f), 1.0f));
+	EXPECT_TRUE(ShadowCascades::intersects(view_proj, glm::vec3(9.5f, 0.0f, -9.5f), 0.1f));
+	// outside of the box, but close enough for the radius to reach into it
+	EXPECT_TRUE(ShadowCascades::intersects(view_proj, glm::vec3(11.0f, 0.0f, 0.0f), 1.5f));
+	EXPECT_FALSE(ShadowCascades::intersects(view_proj, glm::vec3(11.0f, 0.0f, 0.0f), 0.5f));
+	EXPECT_FALSE(ShadowCascades::intersects(view_proj, glm::vec3(0.0f, 0.0f, 20.0f), 5.0f));
+	// above the light and below the far plane
+	EXPECT_FALSE(ShadowCascades::intersects(view_proj, glm::vec3(0.0f, 60.0f, 0.0f), 5.0f));
+	EXPECT_FALSE(ShadowCascades::intersects(view_proj, glm::vec3(0.0f, -60.0f, 0.0f), 5.0f));
+	EXPECT_TRUE(ShadowCascades::intersects(view_proj, glm::vec3(0.0f, -52.0f, 0.0f), 5.0f));
+}
@@ -0,0 +1,198 @@
+#include "test_helper.hpp"
+
+#include <collision/spatial_hash.hpp>
+#include <entity_component_system/ecs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <glm/gtx/norm.hpp>
+
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
+
+
+namespace
+{
+	std::vector<ObjectID> sorted(std::vector<ObjectID> ids)
+	{
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	}
+
+	std::vector<ObjectID> brute_force_nearest(const std::unordered_map<ObjectID, glm::vec3>& positions, const glm::vec3& center, size_t k)
+	{
+		std::vector<std::pair<float, ObjectID>> candidates;
+		for (const auto& [id, position] : positions)
+		{
+			candidates.emplace_back(glm::distance2(position, center), id);
+		}
+		std::sort(candidates.begin(), candidates.end());
+		candidates.resize(std::min(k, candidates.size()));
+
+		std::vector<ObjectID> result;
+		for (const auto& [distance2, id] : candidates)
+		{
+			result.push_back(id);
+		}
+		return result;
+	}
+}
+
+TEST(SpatialHash, matches_brute_force)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> step(-3.0f, 3.0f);
+	std::uniform_real_distribution<float> radius(0.0f, 12.0f);
+
+	SpatialHash hash(4.0f);
+	std::unordered_map<ObjectID, glm::vec3> positions;
+	for (uint64_t i = 0; i < 2000; i++)
+	{
+		const glm::vec3 position(coordinate(rng), coordinate(rng), coordinate(rng));
+		hash.insert(ObjectID(i), position);
+		positions.emplace(ObjectID(i), position);
+	}
+
+	for (int tick = 0; tick < 20; tick++)
+	{
+		// move everything a little, remove some and add new ones
+		for (auto& [id, position] : positions)
+		{
+			position += glm::vec3(step(rng), step(rng), step(rng));
+			hash.update(id, position);
+		}
+		for (int i = 0; i < 50; i++)
+		{
+			const auto it = std::next(positions.begin(), rng() % positions.size());
+			hash.remove(it->first);
+			positions.erase(it);
+
+			const ObjectID id(10000 + tick * 100 + i);
+			const glm::vec3 position(coordinate(rng), coordinate(rng), coordinate(rng));
+			hash.insert(id, position);
+			positions.emplace(id, position);
+		}
+		ASSERT_EQ(hash.size(), positions.size());
+
+		for (int query = 0; query < 20; query++)
+		{
+			const glm::vec3 center(coordinate(rng), coordinate(rng), coordinate(rng));
+			const float query_radius = radius(rng);
+			std::vector<ObjectID> expected;
+			for (const auto& [id, position] : positions)
+			{
+				if (glm::distance2(position, center) <= query_radius * query_radius)
+				{
+					expected.push_back(id);
+				}
+			}
+			std::vector<ObjectID> found;
+			hash.query_radius(center, query_radius, found);
+			ASSERT_EQ(sorted(found), sorted(expected));
+
+			const AABB box(center - glm::vec3(query_radius, 2.0f, query_radius), center + glm::vec3(query_radius, 2.0f, query_radius));
+			expected.clear();
+			for (const auto& [id, position] : positions)
+			{
+				if (glm::all(glm::greaterThanEqual(position, box.min_bound)) && glm::all(glm::lessThanEqual(position, box.max_bound)))
+				{
+					expected.push_back(id);
+				}
+			}
+			found.clear();
+			hash.query_box(box, found);
+			ASSERT_EQ(sorted(found), sorted(expected));
+
+			const size_t k = 1 + rng() % 16;
+			ASSERT_EQ(hash.query_nearest(center, k), brute_force_nearest(positions, center, k));
+		}
+	}
+}
+
+TEST(SpatialHash, sparse_and_large_queries)
+{
+	SpatialHash hash(1.0f);
+	hash.insert(ObjectID(0), glm::vec3(0.0f));
+	hash.insert(ObjectID(1), glm::vec3(1000.0f, 0.0f, 0.0f));
+	hash.insert(ObjectID(2), glm::vec3(-3000.0f, 500.0f, 0.0f));
+
+	// the nearest neighbours are far more cells away than there are occupied cells
+	ASSERT_EQ(hash.query_nearest(glm::vec3(900.0f, 0.0f, 0.0f), 2), std::vector<ObjectID>({ ObjectID(1), ObjectID(0) }));
+	ASSERT_EQ(hash.query_nearest(glm::vec3(0.0f), 10).size(), 3);
+
+	std::vector<ObjectID> found;
+	hash.query_radius(glm::vec3(0.0f), 1e4f, found);
+	ASSERT_EQ(found.size(), 3);
+
+	// moving within a cell and across cells
+	hash.update(ObjectID(1), glm::vec3(1000.5f, 0.0f, 0.0f));
+	hash.update(ObjectID(1), glm::vec3(-1.5f, 0.0f, 0.0f));
+	found.clear();
+	hash.query_radius(glm::vec3(0.0f), 2.0f, found);
+	ASSERT_EQ(sorted(found), std::vector<ObjectID>({ ObjectID(0), ObjectID(1) }));
+	ASSERT_EQ(hash.get_num_cells(), 3);
+
+	ASSERT_THROW(hash.insert(ObjectID(0), glm::vec3(0.0f)), std::runtime_error);
+	hash.remove(ObjectID(0));
+	ASSERT_THROW(hash.remove(ObjectID(0)), std::runtime_error);
+	ASSERT_THROW(hash.update(ObjectID(0), glm::vec3(0.0f)), std::runtime_error);
+	ASSERT_FALSE(hash.contains(ObjectID(0)));
+	ASSERT_EQ(hash.size(), 2);
+}
+
+TEST(SpatialHash, ecs_follows_objects)
+{
+	ECS ecs;
+	Object near_object;
+	Object far_object;
+	ecs.add_object(near_object);
+	ecs.add_object(far_object);
+	far_object.set_position(glm::vec3(100.0f, 0.0f, 0.0f));
+	ecs.process(0.0f);
+
+	std::vector<EntityID> found;
+	ecs.query_radius(glm::vec3(0.0f), 1.0f, found);
+	ASSERT_EQ(found, std::vector<EntityID>({ near_object.get_id() }));
+	ASSERT_EQ(ecs.query_nearest(glm::vec3(90.0f, 0.0f, 0.0f), 1), std::vector<EntityID>({ far_object.get_id() }));
+
+	near_object.set_position(glm::vec3(99.0f, 0.0f, 0.0f));
+	ecs.process(0.0f);
+	found.clear();
+	ecs.query_box(AABB(glm::vec3(95.0f, -1.0f, -1.0f), glm::vec3(105.0f, 1.0f, 1.0f)), found);
+	ASSERT_EQ(sorted(found), sorted({ near_object.get_id(), far_object.get_id() }));
+
+	ecs.remove_object(far_object.get_id());
+	ecs.process(0.0f);
+	ASSERT_EQ(ecs.query_nearest(glm::vec3(0.0f), 10), std::vector<EntityID>({ near_object.get_id() }));
+	ecs.remove_object(near_object.get_id());
+}
+
+TEST(SpatialHash, ecs_follows_moved_parents_children)
+{
+	// the child's own transform never changes, it moves because its parent does
+	ECS ecs;
+	Object parent;
+	Object child;
+	child.set_position(glm::vec3(1.0f, 0.0f, 0.0f));
+	child.attach_to(&parent);
+	ecs.add_object(parent);
+	ecs.add_object(child);
+
+	parent.set_position(glm::vec3(50.0f, 0.0f, 0.0f));
+	ecs.process(0.0f);
+	ASSERT_EQ(ecs.query_nearest(glm::vec3(52.0f, 0.0f, 0.0f), 1), std::vector<EntityID>({ child.get_id() }));
+
+	// moving again after the queue has been drained must be picked up too
+	parent.set_position(glm::vec3(-50.0f, 0.0f, 0.0f));
+	ecs.process(0.0f);
+	std::vector<EntityID> found;
+	ecs.query_radius(glm::vec3(-50.0f, 0.0f, 0.0f), 2.0f, found);
+	ASSERT_EQ(sorted(found), sorted({ parent.get_id(), child.get_id() }));
+
+	child.detach_from();
+	ecs.remove_object(child.get_id());
+	ecs.remove_object(parent.get_id());
+}
@@ -0,0 +1,109 @@
+#include <renderable/vertex_quantization.hpp>
+#include <renderable/mesh.hpp>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include <random>
+#include <algorithm>
+#include <numbers>
+#include <stdexcept>
+
+
+TEST(VertexQuantization, packed_sizes)
+{
+	ASSERT_EQ(sizeof(SDS::PackedColorVertex), 16);
+	ASSERT_EQ(sizeof(SDS::PackedTexVertex), 20);
+	ASSERT_EQ(sizeof(SDS::PackedSkinnedVertex), 28);
+}
+
+TEST(VertexQuantization, octahedral_round_trip)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	float max_error_degrees = 0.0f;
+	for (uint32_t i = 0; i < 10000; i++)
+	{
+		glm::vec3 normal(distribution(rng), distribution(rng), distribution(rng));
+		if (glm::length(normal) < 0.01f)
+		{
+			continue;
+		}
+		normal = glm::normalize(normal);
+
+		const glm::vec3 decoded = VertexQuantization::decode_octahedral(VertexQuantization::encode_octahedral(normal));
+		const float cos_angle = std::clamp(glm::dot(normal, decoded), -1.0f, 1.0f);
+		max_error_degrees = std::max(max_error_degrees, std::acos(cos_angle) * 180.0f / std::numbers::pi_v<float>);
+	}
+	EXPECT_LT(max_error_degrees, 0.05f);
+
+	// axes and the seam of the folded lower hemisphere
+	for (const glm::vec3& normal : { glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f) })
+	{
+		const glm::vec3 decoded = VertexQuantization::decode_octahedral(VertexQuantization::encode_octahedral(normal));
+		EXPECT_GT(glm::dot(normal, decoded), 0.9999f);
+	}
+}
+
+TEST(VertexQuantization, tex_coord_round_trip)
+{
+	for (const glm::vec2& tex_coord : { glm::vec2(0.0f, 1.0f), glm::vec2(0.5f, 0.25f), glm::vec2(0.123f, 0.987f) })
+	{
+		const glm::vec2 decoded = VertexQuantization::decode_tex_coord(VertexQuantization::encode_tex_coord(tex_coord));
+		// float16 has 11 bits of precision, i.e. sub-texel accuracy up to 2048 texels
+		EXPECT_NEAR(decoded.x, tex_coord.x, 1.0f / 2048.0f);
+		EXPECT_NEAR(decoded.y, tex_coord.y, 1.0f / 2048.0f);
+	}
+}
+
+TEST(VertexQuantization, bone_ids)
+{
+	const glm::vec4 bone_ids(0.0f, 7.0f, 128.0f, 255.0f);
+	const glm::vec4 decoded = VertexQuantization::decode_bone_ids(VertexQuantization::encode_bone_ids(bone_ids));
+	for (int i = 0; i < 4; i++)
+	{
+		ASSERT_EQ(decoded[i], bone_ids[i]);
+	}
+
+	ASSERT_TRUE(VertexQuantization::fits_bone_ids(bone_ids));
+	ASSERT_FALSE(VertexQuantization::fits_bone_ids(glm::vec4(0.0f, 0.0f, 256.0f, 0.0f)));
+	ASSERT_FALSE(VertexQuantization::fits_bone_ids(glm::vec4(0.0f, -1.0f, 0.0f, 0.0f)));
+}
+
+TEST(VertexQuantization, bone_weights_sum_to_one)
+{
+	for (const glm::vec4& bone_weights : { glm::vec4(1.0f, 0.0f, 0.0f, 0.0f), glm::vec4(0.333f, 0.333f, 0.334f, 0.0f), glm::vec4(0.25f, 0.25f, 0.25f, 0.25f), glm::vec4(0.7f, 0.1f, 0.1f, 0.1f) })
+	{
+		const uint32_t encoded = VertexQuantization::encode_bone_weights(bone_weights);
+		uint32_t sum = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			sum += (encoded >> (i * 8)) & 0xFF;
+		}
+		ASSERT_EQ(sum, 255);
+
+		const glm::vec4 decoded = VertexQuantization::decode_bone_weights(encoded);
+		for (int i = 0; i < 4; i++)
+		{
+			EXPECT_NEAR(decoded[i], bone_weights[i], 1.0f / 255.0f);
+		}
+	}
+}
+
+TEST(VertexQuantization, mesh_16bit_indices)
+{
+	ColorVertices vertices(4, SDS::ColorVertex{ glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f) });
+	ColorMesh mesh(vertices, VertexIndices({ 0, 1, 2, 1, 3, 2 }));
+	ASSERT_TRUE(mesh.has_16bit_indices());
+	ASSERT_EQ(mesh.get_packed_indices_data_size(), 6 * sizeof(uint16_t));
+	ASSERT_EQ(mesh.get_packed_vertices_data_size(), 4 * sizeof(SDS::PackedColorVertex));
+
+	std::vector<uint16_t> packed_indices(6);
+	mesh.write_packed_indices(reinterpret_cast<std::byte*>(packed_indices.data()));
+	ASSERT_EQ(packed_indices, std::vector<uint16_t>({ 0, 1, 2, 1, 3, 2 }));
+
+	ColorMesh large_mesh(ColorVertices(70000, vertices.front()), VertexIndices({ 0, 1, 69999 }));
+	ASSERT_FALSE(large_mesh.has_16bit_indices());
+	ASSERT_EQ(large_mesh.get_packed_indices_data_size(), 3 * sizeof(uint32_t));
+}